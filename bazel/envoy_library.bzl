@@ -94,6 +94,7 @@ EXTENSION_CATEGORIES = [
     "envoy.transport_sockets.downstream",
     "envoy.transport_sockets.upstream",
     "envoy.tls.cert_validator",
+    "envoy.tls.key_providers",
     "envoy.upstreams",
     "envoy.wasm.runtime",
     "DELIBERATELY_OMITTED",
@@ -4,6 +4,7 @@
 #error "Linux platform file is part of non-Linux build."
 #endif
 
+#include <fcntl.h>
 #include <sched.h>
 
 #include "envoy/api/os_sys_calls_common.h"
@@ -20,6 +21,24 @@ public:
    * @see sched_getaffinity (man 2 sched_getaffinity)
    */
   virtual SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) PURE;
+
+  /**
+   * @see pipe2 (man 2 pipe2)
+   */
+  virtual SysCallIntResult pipe2(int pipefd[2], int flags) PURE;
+
+  /**
+   * @see splice (man 2 splice)
+   */
+  virtual SysCallSizeResult splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out,
+                                   size_t len, unsigned int flags) PURE;
+
+  /**
+   * Resizes a pipe.
+   * @see fcntl F_SETPIPE_SZ (man 2 fcntl)
+   * @return the new size of the pipe on success.
+   */
+  virtual SysCallIntResult setPipeSize(int fd, int size) PURE;
 };
 
 using LinuxOsSysCallsPtr = std::unique_ptr<LinuxOsSysCalls>;
@@ -10,6 +10,7 @@
 #include "envoy/common/pure.h"
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 
 namespace Envoy {
 namespace Filesystem {
@@ -45,6 +46,15 @@ public:
    */
   virtual Api::IoCallSizeResult write(absl::string_view buffer) PURE;
 
+  /**
+   * Write the buffers to the file in order, with as few system calls as the platform allows. The
+   * file must be explicitly opened before writing. As with writev(2), fewer bytes than supplied may
+   * be written, in which case the caller should write the remainder.
+   *
+   * @return ssize_t number of bytes written, or -1 for failure
+   */
+  virtual Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) PURE;
+
   /**
    * Close the file.
    *
@@ -444,6 +444,9 @@ struct Http1Settings {
   // True if this is an edge Envoy (using downstream address, no trusted hops)
   // and https:// URLs should be rejected over unencrypted connections.
   bool validate_scheme_{false};
+
+  // Parse with the SIMD scanning parser rather than http_parser.
+  bool use_simd_parser_{false};
 };
 
 /**
@@ -323,6 +323,18 @@ public:
    *  returned.
    */
   virtual absl::optional<std::chrono::milliseconds> lastRoundTripTime() const PURE;
+
+  /**
+   * Starts moving the data read from this connection to the socket of another connection, and the
+   * data read from the other connection to this one, inside the kernel with splice(). The moved
+   * data bypasses the read and write filters of both connections, but end of stream, connection
+   * events, bytes sent callbacks and stats are reported as usual. Splicing stops when either
+   * connection is closed.
+   * Note: Splicing is only supported between connected plaintext TCP connections on Linux.
+   * @param peer supplies the other connection.
+   * @return bool whether splicing started. If not, data keeps flowing through the filters.
+   */
+  virtual bool startSplice(Connection& peer) PURE;
 };
 
 using ConnectionPtr = std::unique_ptr<Connection>;
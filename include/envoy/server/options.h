@@ -204,6 +204,12 @@ public:
    */
   virtual std::chrono::milliseconds fileFlushIntervalMsec() const PURE;
 
+  /**
+   * @return bool whether access log files are flushed by a single shared thread from per-thread
+   *         ring buffers, rather than by a thread per file.
+   */
+  virtual bool fileFlushSharedThread() const PURE;
+
   /**
    * @return const std::string& the server's cluster.
    */
@@ -21,6 +21,12 @@ namespace Ssl {
  */
 class ContextConfig {
 public:
+  // The bounds of a session cache shared by all the connections of a context.
+  struct SessionCacheConfig {
+    uint32_t max_sessions_;
+    uint32_t shards_;
+  };
+
   virtual ~ContextConfig() = default;
 
   /**
@@ -89,6 +95,18 @@ public:
    * @return a callback for configuring an SSL_CTX before use.
    */
   virtual SslCtxCb sslctxCb() const PURE;
+
+  /**
+   * @return true if the record layer of established connections should be offloaded to the
+   * kernel where possible.
+   */
+  virtual bool kernelTlsOffload() const PURE;
+
+  /**
+   * @return the bounds of the shared session cache of the context, or nullopt if sessions are
+   * cached by BoringSSL for server contexts and as per maxSessionKeys() for client contexts.
+   */
+  virtual absl::optional<SessionCacheConfig> sessionCache() const PURE;
 };
 
 class ClientContextConfig : public virtual ContextConfig {
@@ -94,6 +94,15 @@ public:
    */
   virtual void addBytesSentCallback(Network::Connection::BytesSentCb cb) PURE;
 
+  /**
+   * Starts moving data between the upstream and the downstream connection inside the kernel.
+   * @see Network::Connection::startSplice
+   * @param downstream supplies the downstream connection.
+   * @return bool whether splicing started. If not, data keeps being passed to encodeData and
+   *         the upstream callbacks.
+   */
+  virtual bool startSplice(Network::Connection& downstream) PURE;
+
   /**
    * Called when an event is received on the downstream connection
    * @param event supplies the event which occurred.
@@ -711,6 +711,8 @@ public:
     static constexpr uint64_t USE_ALPN = 0x8;
     // Whether the upstream supports HTTP3. This is used when creating connection pools.
     static constexpr uint64_t HTTP3 = 0x10;
+    // Whether the HTTP/2 connections of each host are shared by all workers.
+    static constexpr uint64_t SHARED_HTTP2_CONNECTION_POOL = 0x20;
   };
 
   virtual ~ClusterInfo() = default;
@@ -1,5 +1,7 @@
 #include "common/access_log/access_log_manager_impl.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 
 #include "common/common/assert.h"
@@ -7,15 +9,30 @@
 #include "common/common/lock_guard.h"
 
 #include "absl/container/fixed_array.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 
 namespace Envoy {
 namespace AccessLog {
 
+AccessLogManagerImpl::AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec,
+                                           Api::Api& api, Event::Dispatcher& dispatcher,
+                                           Thread::BasicLockable& lock, Stats::Store& stats_store,
+                                           bool shared_flush_thread)
+    : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
+      lock_(lock), file_stats_{
+                       ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
+                                             POOL_GAUGE_PREFIX(stats_store, "filesystem."))},
+      shared_flush_thread_(shared_flush_thread) {}
+
 AccessLogManagerImpl::~AccessLogManagerImpl() {
   for (auto& [log_key, log_file_ptr] : access_logs_) {
     ENVOY_LOG(debug, "destroying access logger {}", log_key);
     log_file_ptr.reset();
   }
+  if (flusher_ != nullptr) {
+    flusher_->disableTimer();
+  }
   ENVOY_LOG(debug, "destroyed access loggers");
 }
 
@@ -30,6 +47,16 @@ AccessLogFileSharedPtr AccessLogManagerImpl::createAccessLog(const std::string&
     return access_logs_[file_name];
   }
 
+  if (shared_flush_thread_) {
+    if (flusher_ == nullptr) {
+      flusher_ = std::make_shared<AccessLogFlusher>(
+          dispatcher_, file_stats_, file_flush_interval_msec_, api_.threadFactory());
+    }
+    access_logs_[file_name] = std::make_shared<SharedFlushAccessLogFileImpl>(
+        api_.fileSystem().createFile(file_name), flusher_, lock_, file_stats_);
+    return access_logs_[file_name];
+  }
+
   access_logs_[file_name] = std::make_shared<AccessLogFileImpl>(
       api_.fileSystem().createFile(file_name), dispatcher_, lock_, file_stats_,
       file_flush_interval_msec_, api_.threadFactory());
@@ -208,5 +235,295 @@ void AccessLogFileImpl::createFlushStructures() {
                                                Thread::Options{"AccessLogFlush"});
 }
 
+AccessLogRingBuffer::AccessLogRingBuffer(uint64_t capacity)
+    : capacity_(capacity), data_(new char[capacity]) {
+  ASSERT(capacity_ > 0 && (capacity_ & (capacity_ - 1)) == 0);
+}
+
+bool AccessLogRingBuffer::write(absl::string_view data) {
+  // Only the producer updates head_ and the counters, so plain loads and stores suffice for them.
+  const uint64_t head = head_.load(std::memory_order_relaxed);
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  if (data.size() > capacity_ - (head - tail)) {
+    dropped_bytes_.store(dropped_bytes_.load(std::memory_order_relaxed) + data.size(),
+                         std::memory_order_relaxed);
+    return false;
+  }
+
+  const uint64_t offset = head & (capacity_ - 1);
+  const uint64_t first = std::min<uint64_t>(data.size(), capacity_ - offset);
+  memcpy(data_.get() + offset, data.data(), first);
+  memcpy(data_.get(), data.data() + first, data.size() - first);
+  head_.store(head + data.size(), std::memory_order_release);
+  records_.store(records_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+  return true;
+}
+
+std::array<absl::string_view, 2> AccessLogRingBuffer::readableSlices() const {
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  const uint64_t head = head_.load(std::memory_order_acquire);
+  const uint64_t offset = tail & (capacity_ - 1);
+  const uint64_t first = std::min<uint64_t>(head - tail, capacity_ - offset);
+  return {absl::string_view(data_.get() + offset, first),
+          absl::string_view(data_.get(), head - tail - first)};
+}
+
+void AccessLogRingBuffer::drain(uint64_t length) {
+  const uint64_t tail = tail_.load(std::memory_order_relaxed);
+  ASSERT(length <= head_.load(std::memory_order_acquire) - tail);
+  // Releases the drained space to the producer only after the consumer is done reading it.
+  tail_.store(tail + length, std::memory_order_release);
+}
+
+uint64_t AccessLogRingBuffer::length() const {
+  const uint64_t tail = tail_.load(std::memory_order_acquire);
+  return head_.load(std::memory_order_acquire) - tail;
+}
+
+AccessLogFlusher::AccessLogFlusher(Event::Dispatcher& dispatcher, AccessLogFileStats& stats,
+                                   std::chrono::milliseconds flush_interval_msec,
+                                   Thread::ThreadFactory& thread_factory)
+    : stats_(stats), flush_interval_msec_(flush_interval_msec),
+      flush_timer_(dispatcher.createTimer([this]() -> void {
+        stats_.flushed_by_timer_.inc();
+        wakeup();
+        flush_timer_->enableTimer(flush_interval_msec_);
+      })) {
+  flush_timer_->enableTimer(flush_interval_msec_);
+  flush_thread_ = thread_factory.createThread([this]() -> void { flushThreadFunc(); },
+                                              Thread::Options{"AccessLogFlush"});
+}
+
+AccessLogFlusher::~AccessLogFlusher() {
+  {
+    Thread::LockGuard lock(wakeup_lock_);
+    flush_thread_exit_ = true;
+    flush_event_.notifyOne();
+  }
+  flush_thread_->join();
+}
+
+void AccessLogFlusher::disableTimer() { flush_timer_.reset(); }
+
+void AccessLogFlusher::registerFile(SharedFlushAccessLogFileImpl& file) {
+  Thread::LockGuard lock(files_lock_);
+  files_.insert(&file);
+}
+
+void AccessLogFlusher::unregisterFile(SharedFlushAccessLogFileImpl& file) {
+  Thread::LockGuard lock(files_lock_);
+  files_.erase(&file);
+}
+
+void AccessLogFlusher::wakeup() {
+  // Writers call this for every record while a ring is past its threshold, so skip the exchange,
+  // and the lock, unless this is the call which makes the wakeup pending.
+  if (wakeup_pending_.load(std::memory_order_relaxed) || wakeup_pending_.exchange(true)) {
+    return;
+  }
+  Thread::LockGuard lock(wakeup_lock_);
+  flush_event_.notifyOne();
+}
+
+void AccessLogFlusher::flushThreadFunc() {
+  while (true) {
+    {
+      Thread::LockGuard lock(wakeup_lock_);
+      while (!wakeup_pending_ && !flush_thread_exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        flush_event_.wait(wakeup_lock_);
+      }
+
+      if (flush_thread_exit_) {
+        return;
+      }
+    }
+
+    // Cleared before the pass, so that data written during the pass gets another one.
+    wakeup_pending_ = false;
+    flushFiles();
+  }
+}
+
+void AccessLogFlusher::flushFiles() {
+  Thread::LockGuard lock(files_lock_);
+  uint64_t queue_depth = 0;
+  for (SharedFlushAccessLogFileImpl* file : files_) {
+    queue_depth += file->flushRings();
+  }
+  stats_.write_queue_depth_.set(queue_depth);
+}
+
+namespace {
+
+// Gives each SharedFlushAccessLogFileImpl a key for the thread local ring maps.
+std::atomic<uint64_t> next_shared_flush_file_id{};
+
+} // namespace
+
+SharedFlushAccessLogFileImpl::SharedFlushAccessLogFileImpl(
+    Filesystem::FilePtr&& file, std::shared_ptr<AccessLogFlusher> flusher,
+    Thread::BasicLockable& lock, AccessLogFileStats& stats)
+    : id_(next_shared_flush_file_id++), file_(std::move(file)), flusher_(std::move(flusher)),
+      file_lock_(lock), stats_(stats) {
+  open();
+  flusher_->registerFile(*this);
+}
+
+SharedFlushAccessLogFileImpl::~SharedFlushAccessLogFileImpl() {
+  flusher_->unregisterFile(*this);
+
+  // Flush any remaining data. If file was not opened for some reason, skip flushing part.
+  if (file_->isOpen()) {
+    {
+      Thread::LockGuard lock(flush_lock_);
+      doFlush();
+    }
+
+    const Api::IoCallBoolResult result = file_->close();
+    ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                   result.err_->getErrorDetails()));
+  }
+}
+
+void SharedFlushAccessLogFileImpl::open() {
+  const Api::IoCallBoolResult result = file_->open(AccessLogFileImpl::defaultFlags());
+  if (!result.rc_) {
+    throw EnvoyException(
+        fmt::format("unable to open file '{}': {}", file_->path(), result.err_->getErrorDetails()));
+  }
+}
+
+void SharedFlushAccessLogFileImpl::reopen() { reopen_file_ = true; }
+
+void SharedFlushAccessLogFileImpl::write(absl::string_view data) {
+  AccessLogRingBuffer& ring = threadRing();
+  ring.write(data);
+  if (ring.length() > FLUSH_THRESHOLD) {
+    flusher_->wakeup();
+  }
+}
+
+AccessLogRingBuffer& SharedFlushAccessLogFileImpl::threadRing() {
+  struct ThreadRing {
+    // Expires along with the file, which owns the ring.
+    std::weak_ptr<const bool> file_alive_;
+    AccessLogRingBuffer* ring_;
+  };
+  static thread_local absl::flat_hash_map<uint64_t, ThreadRing> thread_rings;
+  auto it = thread_rings.find(id_);
+  if (it != thread_rings.end()) {
+    return *it->second.ring_;
+  }
+
+  // Only the owning thread may touch its map, so the entries of destroyed files are pruned when
+  // the thread starts writing to a new file rather than by the file destructor.
+  absl::erase_if(thread_rings,
+                 [](const auto& entry) { return entry.second.file_alive_.expired(); });
+
+  auto ring = std::make_unique<AccessLogRingBuffer>(RING_BUFFER_SIZE);
+  AccessLogRingBuffer* ring_ptr = ring.get();
+  {
+    Thread::LockGuard lock(rings_lock_);
+    rings_.push_back(std::move(ring));
+  }
+  thread_rings.emplace(id_, ThreadRing{alive_, ring_ptr});
+  return *ring_ptr;
+}
+
+void SharedFlushAccessLogFileImpl::flush() {
+  Thread::LockGuard lock(flush_lock_);
+  doFlush();
+}
+
+uint64_t SharedFlushAccessLogFileImpl::flushRings() {
+  Thread::LockGuard lock(flush_lock_);
+  return doFlush();
+}
+
+uint64_t SharedFlushAccessLogFileImpl::doFlush() {
+  absl::InlinedVector<AccessLogRingBuffer*, 32> rings;
+  {
+    Thread::LockGuard lock(rings_lock_);
+    for (const auto& ring : rings_) {
+      rings.push_back(ring.get());
+    }
+  }
+  reported_records_.resize(rings.size());
+  reported_dropped_bytes_.resize(rings.size());
+
+  // Gather what each ring holds now. Anything written from here on is left for the next flush.
+  absl::InlinedVector<absl::string_view, 64> slices;
+  absl::InlinedVector<uint64_t, 32> lengths;
+  uint64_t total = 0;
+  for (size_t i = 0; i < rings.size(); ++i) {
+    AccessLogRingBuffer& ring = *rings[i];
+    const uint64_t records = ring.records();
+    stats_.write_buffered_.add(records - reported_records_[i]);
+    reported_records_[i] = records;
+    const uint64_t dropped_bytes = ring.droppedBytes();
+    stats_.write_dropped_bytes_.add(dropped_bytes - reported_dropped_bytes_[i]);
+    reported_dropped_bytes_[i] = dropped_bytes;
+
+    uint64_t length = 0;
+    for (const absl::string_view slice : ring.readableSlices()) {
+      if (!slice.empty()) {
+        slices.push_back(slice);
+        length += slice.size();
+      }
+    }
+    lengths.push_back(length);
+    total += length;
+  }
+
+  // if we failed to open file before, then simply ignore
+  if (file_->isOpen()) {
+    try {
+      if (reopen_file_) {
+        reopen_file_ = false;
+        const Api::IoCallBoolResult result = file_->close();
+        ASSERT(result.rc_, fmt::format("unable to close file '{}': {}", file_->path(),
+                                       result.err_->getErrorDetails()));
+        open();
+      }
+
+      if (!slices.empty()) {
+        // See AccessLogFileImpl::doWrite() for why the disk write happens under file_lock_.
+        Thread::LockGuard lock(file_lock_);
+        size_t next = 0;
+        while (next < slices.size()) {
+          const Api::IoCallSizeResult result =
+              file_->writev(absl::MakeConstSpan(slices).subspan(next));
+          if (!result.ok() || result.rc_ <= 0) {
+            // Probably disk full.
+            stats_.write_failed_.inc();
+            break;
+          }
+          // Skip past what was written, which may end in the middle of a slice.
+          uint64_t written = result.rc_;
+          while (next < slices.size() && written >= slices[next].size()) {
+            written -= slices[next].size();
+            ++next;
+          }
+          if (written > 0) {
+            slices[next].remove_prefix(written);
+          }
+        }
+        if (next == slices.size()) {
+          stats_.write_completed_.inc();
+        }
+      }
+    } catch (const EnvoyException&) {
+      stats_.reopen_failed_.inc();
+    }
+  }
+
+  // As with AccessLogFileImpl, data which failed to be written is dropped rather than retried.
+  for (size_t i = 0; i < rings.size(); ++i) {
+    rings[i]->drain(lengths[i]);
+  }
+  return total;
+}
+
 } // namespace AccessLog
 } // namespace Envoy
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <memory>
 #include <string>
 
 #include "envoy/access_log/access_log.h"
@@ -11,8 +14,10 @@
 
 #include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
+#include "common/common/non_copyable.h"
 #include "common/common/thread.h"
 
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/node_hash_map.h"
 
 namespace Envoy {
@@ -22,7 +27,9 @@ namespace Envoy {
   COUNTER(reopen_failed)                                                                           \
   COUNTER(write_buffered)                                                                          \
   COUNTER(write_completed)                                                                         \
+  COUNTER(write_dropped_bytes)                                                                     \
   COUNTER(write_failed)                                                                            \
+  GAUGE(write_queue_depth, NeverImport)                                                            \
   GAUGE(write_total_buffered, Accumulate)
 
 struct AccessLogFileStats {
@@ -31,15 +38,17 @@ struct AccessLogFileStats {
 
 namespace AccessLog {
 
+class AccessLogFlusher;
+
 class AccessLogManagerImpl : public AccessLogManager, Logger::Loggable<Logger::Id::main> {
 public:
+  /**
+   * @param shared_flush_thread if true, all files are flushed by a single thread from per-thread
+   *        ring buffers. See SharedFlushAccessLogFileImpl.
+   */
   AccessLogManagerImpl(std::chrono::milliseconds file_flush_interval_msec, Api::Api& api,
                        Event::Dispatcher& dispatcher, Thread::BasicLockable& lock,
-                       Stats::Store& stats_store)
-      : file_flush_interval_msec_(file_flush_interval_msec), api_(api), dispatcher_(dispatcher),
-        lock_(lock), file_stats_{
-                         ACCESS_LOG_FILE_STATS(POOL_COUNTER_PREFIX(stats_store, "filesystem."),
-                                               POOL_GAUGE_PREFIX(stats_store, "filesystem."))} {}
+                       Stats::Store& stats_store, bool shared_flush_thread = false);
   ~AccessLogManagerImpl() override;
 
   // AccessLog::AccessLogManager
@@ -52,6 +61,10 @@ private:
   Event::Dispatcher& dispatcher_;
   Thread::BasicLockable& lock_;
   AccessLogFileStats file_stats_;
+  const bool shared_flush_thread_;
+  // Created with the first file when shared_flush_thread_ is set. Shared with the files registered
+  // with it, which may outlive the manager.
+  std::shared_ptr<AccessLogFlusher> flusher_;
   absl::node_hash_map<std::string, AccessLogFileSharedPtr> access_logs_;
 };
 
@@ -81,15 +94,15 @@ public:
   void reopen() override;
   void flush() override;
 
+  // return default flags set which used by open
+  static Filesystem::FlagSet defaultFlags();
+
 private:
   void doWrite(Buffer::Instance& buffer);
   void flushThreadFunc();
   void open();
   void createFlushStructures();
 
-  // return default flags set which used by open
-  static Filesystem::FlagSet defaultFlags();
-
   // Minimum size before the flush thread will be told to flush.
   static const uint64_t MIN_FLUSH_SIZE = 1024 * 64;
 
@@ -136,5 +149,178 @@ private:
   AccessLogFileStats& stats_;
 };
 
+/**
+ * Fixed size, lock-free single producer single consumer byte ring. In the shared flush thread mode
+ * every thread writing to a file appends to a ring of its own, so writers never contend with each
+ * other or with the flush thread, and the flush thread writes the contents of all rings of a file
+ * with a single vectored write.
+ */
+class AccessLogRingBuffer : NonCopyable {
+public:
+  /**
+   * @param capacity supplies the size of the ring in bytes, which must be a power of two.
+   */
+  explicit AccessLogRingBuffer(uint64_t capacity);
+
+  /**
+   * Append a record. Only called by the producer.
+   * @return false if the record did not fit, in which case none of it was appended and its size is
+   *         added to droppedBytes().
+   */
+  bool write(absl::string_view data);
+
+  /**
+   * @return the readable data, which wraps around the end of the ring if the second slice is not
+   *         empty. Only called by the consumer.
+   */
+  std::array<absl::string_view, 2> readableSlices() const;
+
+  /**
+   * Release the first length bytes of the readable data. Only called by the consumer.
+   */
+  void drain(uint64_t length);
+
+  /**
+   * @return the number of readable bytes. Exact for the producer and for the consumer, a snapshot
+   *         for anyone else.
+   */
+  uint64_t length() const;
+
+  uint64_t capacity() const { return capacity_; }
+
+  /**
+   * @return the number of records and bytes dropped by write() so far. These only grow and are
+   *         published by the producer, so the consumer can turn them into counter increments.
+   */
+  uint64_t records() const { return records_.load(std::memory_order_relaxed); }
+  uint64_t droppedBytes() const { return dropped_bytes_.load(std::memory_order_relaxed); }
+
+private:
+  const uint64_t capacity_;
+  const std::unique_ptr<char[]> data_;
+  // Total bytes appended and drained since construction. Each is written by only one side, and they
+  // are kept on separate cache lines so that the producer and consumer do not share one.
+  alignas(64) std::atomic<uint64_t> head_{};
+  alignas(64) std::atomic<uint64_t> tail_{};
+  // Written by the producer only.
+  std::atomic<uint64_t> records_{};
+  std::atomic<uint64_t> dropped_bytes_{};
+};
+
+class SharedFlushAccessLogFileImpl;
+
+/**
+ * The single thread which flushes every SharedFlushAccessLogFileImpl of a manager. It runs a pass
+ * over all files whenever the flush interval elapses or a writer fills a ring past its flush
+ * threshold. It is owned by the manager and its files, so it lives as long as any of them.
+ */
+class AccessLogFlusher {
+public:
+  AccessLogFlusher(Event::Dispatcher& dispatcher, AccessLogFileStats& stats,
+                   std::chrono::milliseconds flush_interval_msec,
+                   Thread::ThreadFactory& thread_factory);
+  ~AccessLogFlusher();
+
+  /**
+   * Stop flushing on the flush interval. Called by the manager before it goes away, as the timer
+   * belongs to its dispatcher. Files left are still flushed once their rings fill up.
+   */
+  void disableTimer();
+
+  void registerFile(SharedFlushAccessLogFileImpl& file);
+
+  /**
+   * Remove a file. Once this returns the flush thread no longer touches the file.
+   */
+  void unregisterFile(SharedFlushAccessLogFileImpl& file);
+
+  /**
+   * Ask for a flush pass. Thread safe, and cheap while a pass is already pending.
+   */
+  void wakeup();
+
+private:
+  void flushThreadFunc();
+  void flushFiles();
+
+  AccessLogFileStats stats_;
+  const std::chrono::milliseconds flush_interval_msec_;
+  Event::TimerPtr flush_timer_;
+  Thread::MutexBasicLockable files_lock_; // Held for the whole of a pass, so that files are not
+                                          // removed while they are being flushed.
+  absl::flat_hash_set<SharedFlushAccessLogFileImpl*> files_ ABSL_GUARDED_BY(files_lock_);
+  Thread::MutexBasicLockable wakeup_lock_;
+  Thread::CondVar flush_event_;
+  std::atomic<bool> wakeup_pending_{};
+  bool flush_thread_exit_ ABSL_GUARDED_BY(wakeup_lock_){};
+  Thread::ThreadPtr flush_thread_;
+};
+
+/**
+ * Access log file which is flushed by the AccessLogFlusher shared by all files of the manager,
+ * instead of a thread of its own. Each writing thread appends to a ring buffer it owns, found
+ * through a thread local map, so writes take no locks once the ring exists. A record which does
+ * not fit into the ring of its thread is dropped and counted in write_dropped_bytes, as blocking
+ * the worker until the flush thread catches up is what this mode exists to avoid.
+ */
+class SharedFlushAccessLogFileImpl : public AccessLogFile {
+public:
+  SharedFlushAccessLogFileImpl(Filesystem::FilePtr&& file,
+                               std::shared_ptr<AccessLogFlusher> flusher,
+                               Thread::BasicLockable& lock, AccessLogFileStats& stats);
+  ~SharedFlushAccessLogFileImpl() override;
+
+  // AccessLog::AccessLogFile
+  void write(absl::string_view data) override;
+
+  /**
+   * Reopen file asynchronously.
+   * This only sets reopen flag, actual reopen operation is delayed until the next flush pass.
+   */
+  void reopen() override;
+  void flush() override;
+
+  /**
+   * Write out the contents of all rings. Called by the flush thread.
+   * @return the number of bytes which were queued in the rings.
+   */
+  uint64_t flushRings();
+
+  // Size of the ring of each writing thread.
+  static constexpr uint64_t RING_BUFFER_SIZE = 1024 * 64;
+  // Ring length past which a writer wakes up the flush thread.
+  static constexpr uint64_t FLUSH_THRESHOLD = RING_BUFFER_SIZE / 4;
+
+private:
+  AccessLogRingBuffer& threadRing();
+  uint64_t doFlush() ABSL_EXCLUSIVE_LOCKS_REQUIRED(flush_lock_);
+  void open();
+
+  // Identifies the file in the thread local ring maps. Unlike the address, never reused.
+  const uint64_t id_;
+  // Lets threads prune the entries of the file from their ring maps once it is destroyed.
+  const std::shared_ptr<const bool> alive_{std::make_shared<const bool>(true)};
+  Filesystem::FilePtr file_;
+  const std::shared_ptr<AccessLogFlusher> flusher_;
+
+  // These locks are always acquired in the following order if multiple locks are held:
+  //    1) flush_lock_
+  //    2) rings_lock_
+  //    3) file_lock_
+  Thread::BasicLockable& file_lock_;      // Serializes disk writes across files and processes. See
+                                          // AccessLogFileImpl.
+  Thread::MutexBasicLockable flush_lock_; // Prevents simultaneous flushes from the flush thread
+                                          // and a synchronous flush, as each ring may only have
+                                          // one consumer.
+  Thread::MutexBasicLockable rings_lock_; // Only taken to add a ring, and to list them to flush.
+  std::vector<std::unique_ptr<AccessLogRingBuffer>> rings_ ABSL_GUARDED_BY(rings_lock_);
+  std::atomic<bool> reopen_file_{};
+  // Copied from the manager, which the file may outlive.
+  AccessLogFileStats stats_;
+  // The ring totals already added to the stats, per ring. Only used under flush_lock_.
+  std::vector<uint64_t> reported_records_;
+  std::vector<uint64_t> reported_dropped_bytes_;
+};
+
 } // namespace AccessLog
 } // namespace Envoy
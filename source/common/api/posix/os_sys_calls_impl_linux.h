@@ -15,6 +15,10 @@ class LinuxOsSysCallsImpl : public LinuxOsSysCalls {
 public:
   // Api::LinuxOsSysCalls
   SysCallIntResult sched_getaffinity(pid_t pid, size_t cpusetsize, cpu_set_t* mask) override;
+  SysCallIntResult pipe2(int pipefd[2], int flags) override;
+  SysCallSizeResult splice(int fd_in, loff_t* off_in, int fd_out, loff_t* off_out, size_t len,
+                           unsigned int flags) override;
+  SysCallIntResult setPipeSize(int fd, int size) override;
 };
 
 using LinuxOsSysCallsSingleton = ThreadSafeSingleton<LinuxOsSysCallsImpl>;
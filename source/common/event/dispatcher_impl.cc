@@ -260,14 +260,8 @@ SignalEventPtr DispatcherImpl::listenForSignal(signal_t signal_num, SignalCb cb)
 }
 
 void DispatcherImpl::post(std::function<void()> callback) {
-  bool do_post;
-  {
-    Thread::LockGuard lock(post_lock_);
-    do_post = post_callbacks_.empty();
-    post_callbacks_.push_back(callback);
-  }
-
-  if (do_post) {
+  // Only the first callback queued since the last runPostCallbacks() needs to arm post_cb_.
+  if (post_callbacks_.push(std::move(callback))) {
     post_cb_->scheduleCallbackCurrentIteration();
   }
 }
@@ -307,11 +301,7 @@ void DispatcherImpl::shutdown() {
   // callbacks and dispatcher thread deletable objects.
   ASSERT(isThreadSafe());
   auto deferred_deletables_size = current_to_delete_->size();
-  std::list<std::function<void()>>::size_type post_callbacks_size;
-  {
-    Thread::LockGuard lock(post_lock_);
-    post_callbacks_size = post_callbacks_.size();
-  }
+  auto post_callbacks_size = post_callbacks_.size();
 
   std::list<DispatcherThreadDeletableConstPtr> local_deletables;
   {
@@ -357,18 +347,10 @@ void DispatcherImpl::runPostCallbacks() {
   // objects that is being deferred deleted.
   clearDeferredDeleteList();
 
-  std::list<std::function<void()>> callbacks;
-  {
-    // Take ownership of the callbacks under the post_lock_. The lock must be released before
-    // callbacks execute. Callbacks added after this transfer will re-arm post_cb_ and will execute
-    // later in the event loop.
-    Thread::LockGuard lock(post_lock_);
-    callbacks = std::move(post_callbacks_);
-    // post_callbacks_ should be empty after the move.
-    ASSERT(post_callbacks_.empty());
-  }
-  // It is important that the execution and deletion of the callback happen while post_lock_ is not
-  // held. Either the invocation or destructor of the callback can call post() on this dispatcher.
+  // Take ownership of the queued callbacks. Callbacks added after this transfer will re-arm
+  // post_cb_ and will execute later in the event loop. Either the invocation or destructor of a
+  // callback can call post() on this dispatcher.
+  PostCallbackQueue::Batch callbacks = post_callbacks_.popAll();
   while (!callbacks.empty()) {
     // Touch the watchdog before executing the callback to avoid spurious watchdog miss events when
     // executing a long list of callbacks.
@@ -377,7 +359,7 @@ void DispatcherImpl::runPostCallbacks() {
     callbacks.front()();
     // Pop the front so that the destructor of the callback that just executed runs before the next
     // callback executes.
-    callbacks.pop_front();
+    callbacks.popFront();
   }
 }
 
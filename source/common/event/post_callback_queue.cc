@@ -0,0 +1,69 @@
+#include "common/event/post_callback_queue.h"
+
+namespace Envoy {
+namespace Event {
+
+PostCallbackQueue::Batch& PostCallbackQueue::Batch::operator=(Batch&& other) noexcept {
+  if (this != &other) {
+    clear();
+    front_ = other.front_;
+    other.front_ = nullptr;
+  }
+  return *this;
+}
+
+void PostCallbackQueue::Batch::popFront() {
+  Node* node = front_;
+  front_ = node->next_;
+  delete node;
+}
+
+void PostCallbackQueue::Batch::clear() {
+  while (!empty()) {
+    popFront();
+  }
+}
+
+PostCallbackQueue::~PostCallbackQueue() {
+  // The destructor of a pending callback may post another callback, so keep draining until the
+  // queue stays empty.
+  while (head_.load(std::memory_order_acquire) != nullptr) {
+    popAll();
+  }
+}
+
+bool PostCallbackQueue::push(Callback&& callback) {
+  Node* node = new Node(std::move(callback));
+  Node* head = head_.load(std::memory_order_relaxed);
+  do {
+    node->next_ = head;
+  } while (!head_.compare_exchange_weak(head, node, std::memory_order_release,
+                                        std::memory_order_relaxed));
+  return head == nullptr;
+}
+
+PostCallbackQueue::Batch PostCallbackQueue::popAll() {
+  // Detach the stack and reverse it so that the oldest callback is at the front.
+  Node* node = head_.exchange(nullptr, std::memory_order_acquire);
+  Node* front = nullptr;
+  while (node != nullptr) {
+    Node* next = node->next_;
+    node->next_ = front;
+    front = node;
+    node = next;
+  }
+  return Batch(front);
+}
+
+size_t PostCallbackQueue::size() const {
+  // Nodes are only freed by the consumer, so walking the stack from here is safe.
+  size_t size = 0;
+  for (const Node* node = head_.load(std::memory_order_acquire); node != nullptr;
+       node = node->next_) {
+    ++size;
+  }
+  return size;
+}
+
+} // namespace Event
+} // namespace Envoy
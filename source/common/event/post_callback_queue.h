@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <utility>
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Event {
+
+/**
+ * Lock-free multiple producer, single consumer queue of callbacks posted to a dispatcher.
+ *
+ * Producers push intrusive nodes onto an atomic stack with a single CAS. The consumer detaches the
+ * whole stack with one exchange and reverses it, so callbacks run in the order they were posted.
+ * As nodes are only ever removed all at once by the consumer, the stack is free from ABA hazards
+ * and each drain only sees the callbacks which were queued when it started.
+ */
+class PostCallbackQueue : NonCopyable {
+public:
+  using Callback = std::function<void()>;
+
+private:
+  struct Node {
+    explicit Node(Callback&& callback) : callback_(std::move(callback)) {}
+
+    Node* next_{};
+    Callback callback_;
+  };
+
+public:
+  /**
+   * Callbacks detached from the queue, in the order they were pushed. Any callbacks which have not
+   * been popped are destroyed, without being run, along with the batch.
+   */
+  class Batch {
+  public:
+    Batch() = default;
+    Batch(Batch&& other) noexcept : front_(other.front_) { other.front_ = nullptr; }
+    Batch& operator=(Batch&& other) noexcept;
+    ~Batch() { clear(); }
+
+    bool empty() const { return front_ == nullptr; }
+    Callback& front() { return front_->callback_; }
+
+    /**
+     * Destroy the front callback. This happens before the next callback becomes the front so that
+     * the destructor of a callback runs before the next callback executes.
+     */
+    void popFront();
+
+  private:
+    friend class PostCallbackQueue;
+
+    explicit Batch(Node* front) : front_(front) {}
+    void clear();
+
+    Node* front_{};
+  };
+
+  ~PostCallbackQueue();
+
+  /**
+   * Add a callback to the queue. Thread safe.
+   * @param callback supplies the callback to queue.
+   * @return true if the queue was empty, in which case the caller must wake up the consumer. Any
+   *         pushes until the next popAll() return false, batching the wakeups.
+   */
+  bool push(Callback&& callback);
+
+  /**
+   * Detach all queued callbacks. Only called by the consumer.
+   * @return Batch the callbacks in the order they were pushed.
+   */
+  Batch popAll();
+
+  /**
+   * @return size_t the number of queued callbacks. Only called by the consumer, and only a
+   *         snapshot while producers are pushing concurrently.
+   */
+  size_t size() const;
+
+private:
+  // The most recently pushed node, linked to the previously pushed nodes through Node::next_.
+  std::atomic<Node*> head_{};
+};
+
+} // namespace Event
+} // namespace Envoy
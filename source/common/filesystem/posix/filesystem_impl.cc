@@ -1,8 +1,11 @@
 #include <dirent.h>
 #include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <climits>
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
@@ -17,6 +20,7 @@
 #include "common/common/utility.h"
 #include "common/filesystem/filesystem_impl.h"
 
+#include "absl/container/fixed_array.h"
 #include "absl/strings/match.h"
 #include "absl/strings/str_cat.h"
 
@@ -45,6 +49,18 @@ Api::IoCallSizeResult FileImplPosix::write(absl::string_view buffer) {
   return rc != -1 ? resultSuccess(rc) : resultFailure(rc, errno);
 };
 
+Api::IoCallSizeResult FileImplPosix::writev(absl::Span<const absl::string_view> buffers) {
+  // Anything past IOV_MAX is left to the caller, as for any other short write.
+  const size_t num_iov = std::min<size_t>(buffers.size(), IOV_MAX);
+  absl::FixedArray<iovec> iov(num_iov);
+  for (size_t i = 0; i < num_iov; ++i) {
+    iov[i].iov_base = const_cast<char*>(buffers[i].data());
+    iov[i].iov_len = buffers[i].size();
+  }
+  const ssize_t rc = ::writev(fd_, iov.data(), num_iov);
+  return rc != -1 ? resultSuccess(rc) : resultFailure(rc, errno);
+}
+
 Api::IoCallBoolResult FileImplPosix::close() {
   ASSERT(isOpen());
   int rc = ::close(fd_);
@@ -49,6 +49,27 @@ Api::IoCallSizeResult FileImplWin32::write(absl::string_view buffer) {
   return resultSuccess<ssize_t>(bytes_written);
 };
 
+Api::IoCallSizeResult FileImplWin32::writev(absl::Span<const absl::string_view> buffers) {
+  // There is no gather write for buffered file handles, so write the buffers one at a time and
+  // stop at the first short write.
+  ssize_t total = 0;
+  for (const absl::string_view buffer : buffers) {
+    DWORD bytes_written;
+    BOOL result = WriteFile(fd_, buffer.data(), buffer.length(), &bytes_written, NULL);
+    if (result == 0) {
+      if (total > 0) {
+        break;
+      }
+      return resultFailure<ssize_t>(-1, ::GetLastError());
+    }
+    total += bytes_written;
+    if (bytes_written != buffer.length()) {
+      break;
+    }
+  }
+  return resultSuccess<ssize_t>(total);
+}
+
 Api::IoCallBoolResult FileImplWin32::close() {
   ASSERT(isOpen());
 
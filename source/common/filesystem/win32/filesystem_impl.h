@@ -16,6 +16,7 @@ public:
 protected:
   Api::IoCallBoolResult open(FlagSet flag) override;
   Api::IoCallSizeResult write(absl::string_view buffer) override;
+  Api::IoCallSizeResult writev(absl::Span<const absl::string_view> buffers) override;
   Api::IoCallBoolResult close() override;
 
 private:
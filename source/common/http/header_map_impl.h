@@ -11,6 +11,7 @@
 
 #include "common/common/non_copyable.h"
 #include "common/common/utility.h"
+#include "common/http/header_node_arena.h"
 #include "common/http/headers.h"
 #include "common/runtime/runtime_features.h"
 
@@ -102,6 +103,9 @@ public:
   void dumpState(std::ostream& os, int indent_level = 0) const;
 
 protected:
+  struct HeaderEntryImpl;
+  using HeaderEntryList = std::list<HeaderEntryImpl, HeaderNodeAllocator<HeaderEntryImpl>>;
+
   struct HeaderEntryImpl : public HeaderEntry, NonCopyable {
     HeaderEntryImpl(const LowerCaseString& key);
     HeaderEntryImpl(const LowerCaseString& key, HeaderString&& value);
@@ -117,9 +121,9 @@ protected:
 
     HeaderString key_;
     HeaderString value_;
-    std::list<HeaderEntryImpl>::iterator entry_;
+    HeaderEntryList::iterator entry_;
   };
-  using HeaderNode = std::list<HeaderEntryImpl>::iterator;
+  using HeaderNode = HeaderEntryList::iterator;
 
   /**
    * This is the static lookup table that is used to determine whether a header is one of the O(1)
@@ -180,6 +184,8 @@ protected:
    * feature value (or uint32_t max value if not set), all headers are added to a map, to allow
    * fast access given a header key. Once the map is initialized, it will be used even if the number
    * of headers decreases below the threshold.
+   * When the envoy.reloadable_features.header_map_node_arena runtime feature is enabled, list nodes
+   * are allocated from a per list HeaderNodeArena instead of individually from the heap.
    *
    * Note: the internal iterators held in fields make this unsafe to copy and move, since the
    * reference to end() is not preserved across a move (see Notes in
@@ -194,7 +200,9 @@ protected:
     using HeaderLazyMap = absl::flat_hash_map<absl::string_view, HeaderNodeVector>;
 
     HeaderList()
-        : pseudo_headers_end_(headers_.end()),
+        : arena_(Runtime::runtimeFeatureEnabled("envoy.reloadable_features.header_map_node_arena")),
+          headers_(HeaderNodeAllocator<HeaderEntryImpl>(arena_)),
+          pseudo_headers_end_(headers_.end()),
           lazy_map_min_size_(static_cast<uint32_t>(Runtime::getInteger(
               "envoy.http.headermap.lazy_map_min_size", std::numeric_limits<uint32_t>::max()))) {}
 
@@ -287,12 +295,12 @@ protected:
      */
     size_t remove(absl::string_view key);
 
-    std::list<HeaderEntryImpl>::iterator begin() { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::iterator end() { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_iterator begin() const { return headers_.begin(); }
-    std::list<HeaderEntryImpl>::const_iterator end() const { return headers_.end(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
-    std::list<HeaderEntryImpl>::const_reverse_iterator rend() const { return headers_.rend(); }
+    HeaderEntryList::iterator begin() { return headers_.begin(); }
+    HeaderEntryList::iterator end() { return headers_.end(); }
+    HeaderEntryList::const_iterator begin() const { return headers_.begin(); }
+    HeaderEntryList::const_iterator end() const { return headers_.end(); }
+    HeaderEntryList::const_reverse_iterator rbegin() const { return headers_.rbegin(); }
+    HeaderEntryList::const_reverse_iterator rend() const { return headers_.rend(); }
     HeaderLazyMap::iterator mapFind(absl::string_view key) { return lazy_map_.find(key); }
     HeaderLazyMap::iterator mapEnd() { return lazy_map_.end(); }
     size_t size() const { return headers_.size(); }
@@ -304,7 +312,9 @@ protected:
     }
 
   private:
-    std::list<HeaderEntryImpl> headers_;
+    // Must be declared before headers_ so that it outlives the list nodes.
+    HeaderNodeArena arena_;
+    HeaderEntryList headers_;
     HeaderNode pseudo_headers_end_;
     // The number of headers threshold for lazy map usage.
     const uint32_t lazy_map_min_size_;
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <vector>
+
+#include "common/common/assert.h"
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Http {
+
+/**
+ * A per header map arena for the nodes of the header list. Rather than doing one heap allocation
+ * per header, nodes are carved out of geometrically growing blocks and freed nodes are recycled via
+ * a free list. Memory is returned to the heap only when the arena is destroyed, so a header map's
+ * footprint is bounded by the maximum number of headers it held at once. Nodes never move, which
+ * keeps references to header entries (and the O(1) inline header handles) stable.
+ *
+ * All allocations from an arena must be of the same size, which holds for the nodes of a single
+ * std::list. When the arena is disabled, allocations go straight to the heap.
+ */
+class HeaderNodeArena : NonCopyable {
+public:
+  explicit HeaderNodeArena(bool enabled) : enabled_(enabled) {}
+
+  ~HeaderNodeArena() {
+    for (void* block : blocks_) {
+      ::operator delete(block);
+    }
+  }
+
+  void* allocate(size_t size) {
+    if (!enabled_) {
+      return ::operator new(size);
+    }
+
+    ASSERT(node_size_ == 0 || node_size_ == size);
+    ASSERT(size >= sizeof(FreeNode));
+    node_size_ = size;
+    if (free_list_ != nullptr) {
+      FreeNode* node = free_list_;
+      free_list_ = node->next_;
+      return node;
+    }
+    if (next_in_block_ == block_capacity_) {
+      block_capacity_ = block_capacity_ == 0 ? InitialBlockNodes
+                                             : std::min(block_capacity_ * 2, MaxBlockNodes);
+      blocks_.push_back(::operator new(block_capacity_ * size));
+      next_in_block_ = 0;
+    }
+    return static_cast<uint8_t*>(blocks_.back()) + (next_in_block_++ * size);
+  }
+
+  void deallocate(void* p) {
+    if (!enabled_) {
+      ::operator delete(p);
+      return;
+    }
+
+    FreeNode* node = static_cast<FreeNode*>(p);
+    node->next_ = free_list_;
+    free_list_ = node;
+  }
+
+  bool enabled() const { return enabled_; }
+
+private:
+  struct FreeNode {
+    FreeNode* next_;
+  };
+
+  // Most requests and responses have fewer than 8 headers; larger maps grow up to 64 nodes per
+  // block.
+  static constexpr size_t InitialBlockNodes = 8;
+  static constexpr size_t MaxBlockNodes = 64;
+
+  const bool enabled_;
+  size_t node_size_{};
+  std::vector<void*> blocks_;
+  size_t block_capacity_{};
+  size_t next_in_block_{};
+  FreeNode* free_list_{};
+};
+
+/**
+ * Standard allocator adapter for HeaderNodeArena, used as the allocator of the header list.
+ */
+template <class T> class HeaderNodeAllocator {
+public:
+  using value_type = T;
+
+  explicit HeaderNodeAllocator(HeaderNodeArena& arena) : arena_(&arena) {}
+  template <class U>
+  HeaderNodeAllocator(const HeaderNodeAllocator<U>& other) : arena_(other.arena_) {}
+
+  T* allocate(size_t n) {
+    if (n != 1) {
+      return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+    return static_cast<T*>(arena_->allocate(sizeof(T)));
+  }
+
+  void deallocate(T* p, size_t n) {
+    if (n != 1) {
+      ::operator delete(p);
+      return;
+    }
+    arena_->deallocate(p);
+  }
+
+  template <class U> bool operator==(const HeaderNodeAllocator<U>& other) const {
+    return arena_ == other.arena_;
+  }
+  template <class U> bool operator!=(const HeaderNodeAllocator<U>& other) const {
+    return arena_ != other.arena_;
+  }
+
+private:
+  template <class U> friend class HeaderNodeAllocator;
+
+  HeaderNodeArena* arena_;
+};
+
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,147 @@
+#include "common/http/http1/byte_range_scanner.h"
+
+#include "common/common/assert.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define ENVOY_HTTP1_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+ByteRangeScanner::ByteRangeScanner(std::initializer_list<std::pair<uint8_t, uint8_t>> ranges)
+    : ByteRangeScanner(ranges, bestImplementation()) {}
+
+ByteRangeScanner::ByteRangeScanner(std::initializer_list<std::pair<uint8_t, uint8_t>> ranges,
+                                   Implementation implementation) {
+  ASSERT(ranges.size() > 0 && ranges.size() <= MaxRanges);
+  for (const auto& range : ranges) {
+    ASSERT(range.first <= range.second);
+    sse_ranges_[sse_ranges_length_++] = range.first;
+    sse_ranges_[sse_ranges_length_++] = range.second;
+    lows_[range_count_] = range.first;
+    widths_[range_count_] = range.second - range.first;
+    ++range_count_;
+    for (uint32_t c = range.first; c <= range.second; ++c) {
+      table_[c] = true;
+    }
+  }
+
+  implementation_ = supported(implementation) ? implementation : bestImplementation();
+  switch (implementation_) {
+  case Implementation::Avx2:
+    find_ = findAvx2;
+    break;
+  case Implementation::Sse42:
+    find_ = findSse42;
+    break;
+  case Implementation::Scalar:
+    find_ = findScalar;
+    break;
+  }
+}
+
+bool ByteRangeScanner::supported(Implementation implementation) {
+  switch (implementation) {
+  case Implementation::Scalar:
+    return true;
+#ifdef ENVOY_HTTP1_SCANNER_X86
+  case Implementation::Sse42:
+    return __builtin_cpu_supports("sse4.2");
+  case Implementation::Avx2:
+    return __builtin_cpu_supports("avx2");
+#else
+  case Implementation::Sse42:
+  case Implementation::Avx2:
+    return false;
+#endif
+  }
+  return false;
+}
+
+ByteRangeScanner::Implementation ByteRangeScanner::bestImplementation() {
+  static const Implementation best = []() {
+    if (supported(Implementation::Avx2)) {
+      return Implementation::Avx2;
+    }
+    if (supported(Implementation::Sse42)) {
+      return Implementation::Sse42;
+    }
+    return Implementation::Scalar;
+  }();
+  return best;
+}
+
+size_t ByteRangeScanner::findScalar(const ByteRangeScanner& scanner, const char* data,
+                                    size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    if (scanner.table_[static_cast<uint8_t>(data[i])]) {
+      return i;
+    }
+  }
+  return size;
+}
+
+#ifdef ENVOY_HTTP1_SCANNER_X86
+
+__attribute__((target("sse4.2"))) size_t
+ByteRangeScanner::findSse42(const ByteRangeScanner& scanner, const char* data, size_t size) {
+  const __m128i ranges = _mm_load_si128(reinterpret_cast<const __m128i*>(scanner.sse_ranges_));
+  size_t i = 0;
+  for (; i + 16 <= size; i += 16) {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+    const int index = _mm_cmpestri(ranges, scanner.sse_ranges_length_, chunk, 16,
+                                   _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+    if (index != 16) {
+      return i + index;
+    }
+  }
+  return i + findScalar(scanner, data + i, size - i);
+}
+
+__attribute__((target("avx2"))) size_t
+ByteRangeScanner::findAvx2(const ByteRangeScanner& scanner, const char* data, size_t size) {
+  // A byte c is in [low, low + width] iff (c - low) <= width when compared as unsigned bytes.
+  __m256i lows[MaxRanges];
+  __m256i widths[MaxRanges];
+  for (size_t r = 0; r < scanner.range_count_; ++r) {
+    lows[r] = _mm256_set1_epi8(static_cast<char>(scanner.lows_[r]));
+    widths[r] = _mm256_set1_epi8(static_cast<char>(scanner.widths_[r]));
+  }
+
+  size_t i = 0;
+  for (; i + 32 <= size; i += 32) {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+    __m256i matches = _mm256_setzero_si256();
+    for (size_t r = 0; r < scanner.range_count_; ++r) {
+      const __m256i offset = _mm256_sub_epi8(chunk, lows[r]);
+      matches = _mm256_or_si256(
+          matches, _mm256_cmpeq_epi8(_mm256_min_epu8(offset, widths[r]), offset));
+    }
+    const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(matches));
+    if (mask != 0) {
+      return i + __builtin_ctz(mask);
+    }
+  }
+  return i + findSse42(scanner, data + i, size - i);
+}
+
+#else
+
+// Only reachable if supported() said yes, which it never does on these platforms.
+size_t ByteRangeScanner::findSse42(const ByteRangeScanner& scanner, const char* data,
+                                   size_t size) {
+  return findScalar(scanner, data, size);
+}
+
+size_t ByteRangeScanner::findAvx2(const ByteRangeScanner& scanner, const char* data, size_t size) {
+  return findScalar(scanner, data, size);
+}
+
+#endif
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <utility>
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Finds the first byte of a buffer which falls in any of a small set of inclusive byte ranges. This
+ * is the inner loop of the SIMD HTTP/1 parser: URLs and header values are scanned for their
+ * terminating (or invalid) bytes 16 or 32 bytes at a time using SSE4.2 or AVX2 when the CPU
+ * supports it. The widest implementation available is picked once at startup; a portable scalar
+ * implementation is used everywhere else.
+ */
+class ByteRangeScanner {
+public:
+  enum class Implementation { Scalar, Sse42, Avx2 };
+
+  // SSE4.2 range comparisons take up to 8 ranges; 3 is enough for HTTP/1.
+  static constexpr size_t MaxRanges = 3;
+
+  /**
+   * @param ranges supplies up to MaxRanges inclusive [low, high] byte ranges.
+   */
+  explicit ByteRangeScanner(std::initializer_list<std::pair<uint8_t, uint8_t>> ranges);
+
+  /**
+   * @param ranges supplies up to MaxRanges inclusive [low, high] byte ranges.
+   * @param implementation supplies the implementation to use. Falls back to the best available
+   *        implementation if the requested one is not supported by the CPU.
+   */
+  ByteRangeScanner(std::initializer_list<std::pair<uint8_t, uint8_t>> ranges,
+                   Implementation implementation);
+
+  /**
+   * @param data supplies the start of the buffer.
+   * @param size supplies the size of the buffer.
+   * @return the offset of the first byte in any of the ranges, or size if there is none.
+   */
+  size_t find(const char* data, size_t size) const { return find_(*this, data, size); }
+
+  /**
+   * @return whether the byte is in any of the ranges.
+   */
+  bool contains(uint8_t c) const { return table_[c]; }
+
+  Implementation implementation() const { return implementation_; }
+
+  /**
+   * @return whether the CPU supports the given implementation.
+   */
+  static bool supported(Implementation implementation);
+
+  /**
+   * @return the widest implementation supported by the CPU.
+   */
+  static Implementation bestImplementation();
+
+private:
+  using FindFunction = size_t (*)(const ByteRangeScanner&, const char*, size_t);
+
+  static size_t findScalar(const ByteRangeScanner& scanner, const char* data, size_t size);
+  static size_t findSse42(const ByteRangeScanner& scanner, const char* data, size_t size);
+  static size_t findAvx2(const ByteRangeScanner& scanner, const char* data, size_t size);
+
+  // Range pairs laid out as expected by _mm_cmpestri, padded with zeroes.
+  alignas(16) char sse_ranges_[16]{};
+  int sse_ranges_length_{};
+  // Range lower bounds and widths, for the subtract-and-compare AVX2 formulation.
+  std::array<uint8_t, MaxRanges> lows_{};
+  std::array<uint8_t, MaxRanges> widths_{};
+  size_t range_count_{};
+  std::array<bool, 256> table_{};
+  Implementation implementation_;
+  FindFunction find_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
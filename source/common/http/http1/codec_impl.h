@@ -1,7 +1,5 @@
 #pragma once
 
-#include <http_parser.h>
-
 #include <array>
 #include <cstdint>
 #include <list>
@@ -21,6 +19,7 @@
 #include "common/http/header_map_impl.h"
 #include "common/http/http1/codec_stats.h"
 #include "common/http/http1/header_formatter.h"
+#include "common/http/http1/parser.h"
 #include "common/http/status.h"
 
 namespace Envoy {
@@ -170,11 +169,12 @@ private:
 
 /**
  * Base class for HTTP/1.1 client and server connections.
- * Handles the callbacks of http_parser with its own base routine and then
+ * Handles the callbacks of the parser with its own base routine and then
  * virtual dispatches to its subclasses.
  */
 class ConnectionImpl : public virtual Connection,
                        protected Logger::Loggable<Logger::Id::http>,
+                       public ParserCallbacks,
                        public ScopeTrackedObject {
 public:
   /**
@@ -229,40 +229,45 @@ public:
 
   bool strict1xxAnd204Headers() { return strict_1xx_and_204_headers_; }
 
-  // Codec errors found in callbacks are overridden within the http_parser library. This holds those
-  // errors to propagate them through to dispatch() where we can handle the error.
+  // Codec errors found in callbacks are overridden within the parser. This holds those errors to
+  // propagate them through to dispatch() where we can handle the error.
   Envoy::Http::Status codec_status_;
 
   // ScopeTrackedObject
   void dumpState(std::ostream& os, int indent_level) const override;
 
+  // Http1::ParserCallbacks
+  CallbackResult onMessageBegin() override {
+    return setAndCheckCallbackStatus(onMessageBeginImpl());
+  }
+  CallbackResult onUrl(const char* data, size_t length) override {
+    return setAndCheckCallbackStatus(onUrlBase(data, length));
+  }
+  CallbackResult onHeaderField(const char* data, size_t length) override {
+    return setAndCheckCallbackStatus(onHeaderFieldImpl(data, length));
+  }
+  CallbackResult onHeaderValue(const char* data, size_t length) override {
+    return setAndCheckCallbackStatus(onHeaderValueImpl(data, length));
+  }
+  CallbackResult onHeadersComplete() override {
+    return setAndCheckCallbackStatusOr(onHeadersCompleteImpl());
+  }
+  void bufferBody(const char* data, size_t length) override;
+  CallbackResult onMessageComplete() override {
+    return setAndCheckCallbackStatus(onMessageCompleteImpl());
+  }
+  void onChunkHeader(bool is_final_chunk) override;
+
 protected:
   ConnectionImpl(Network::Connection& connection, CodecStats& stats, const Http1Settings& settings,
-                 http_parser_type type, uint32_t max_headers_kb, const uint32_t max_headers_count,
+                 MessageType type, uint32_t max_headers_kb, const uint32_t max_headers_count,
                  HeaderKeyFormatterPtr&& header_key_formatter);
 
-  // The following define special return values for http_parser callbacks. See:
-  // https://github.com/nodejs/http-parser/blob/5c5b3ac62662736de9e71640a8dc16da45b32503/http_parser.h#L72
-  // These codes do not overlap with standard HTTP Status codes. They are only used for user
-  // callbacks.
-  enum class HttpParserCode {
-    // Callbacks other than on_headers_complete should return a non-zero int to indicate an error
-    // and
-    // halt execution.
-    Error = -1,
-    Success = 0,
-    // Returning '1' from on_headers_complete will tell http_parser that it should not expect a
-    // body.
-    NoBody = 1,
-    // Returning '2' from on_headers_complete will tell http_parser that it should not expect a body
-    // nor any further data on the connection.
-    NoBodyData = 2,
-  };
-  int setAndCheckCallbackStatus(Status&& status);
-  int setAndCheckCallbackStatusOr(Envoy::StatusOr<HttpParserCode>&& statusor);
+  CallbackResult setAndCheckCallbackStatus(Status&& status);
+  CallbackResult setAndCheckCallbackStatusOr(Envoy::StatusOr<CallbackResult>&& statusor);
 
   bool resetStreamCalled() { return reset_stream_called_; }
-  Status onMessageBeginBase();
+  Status onMessageBeginImpl();
 
   /**
    * Get memory used to represent HTTP headers or trailers currently being parsed.
@@ -281,7 +286,7 @@ protected:
   Network::Connection& connection_;
   CodecStats& stats_;
   const Http1Settings codec_settings_;
-  http_parser parser_;
+  ParserPtr parser_;
   Buffer::Instance* current_dispatching_buffer_{};
   Http::Code error_code_{Http::Code::BadRequest};
   const HeaderKeyFormatterPtr header_key_formatter_;
@@ -351,13 +356,6 @@ private:
    */
   Envoy::StatusOr<size_t> dispatchSlice(const char* slice, size_t len);
 
-  /**
-   * Called by the http_parser when body data is received.
-   * @param data supplies the start address.
-   * @param length supplies the length.
-   */
-  void bufferBody(const char* data, size_t length);
-
   /**
    * Push the accumulated body through the filter pipeline.
    */
@@ -367,14 +365,14 @@ private:
    * Called when a request/response is beginning. A base routine happens first then a virtual
    * dispatch is invoked.
    */
-  virtual Status onMessageBegin() PURE;
+  virtual Status onMessageBeginBase() PURE;
 
   /**
    * Called when URL data is received.
    * @param data supplies the start address.
    * @param length supplies the length.
    */
-  virtual Status onUrl(const char* data, size_t length) PURE;
+  virtual Status onUrlBase(const char* data, size_t length) PURE;
 
   /**
    * Called when header field data is received.
@@ -382,7 +380,7 @@ private:
    * @param length supplies the length.
    * @return A status representing success.
    */
-  Status onHeaderField(const char* data, size_t length);
+  Status onHeaderFieldImpl(const char* data, size_t length);
 
   /**
    * Called when header value data is received.
@@ -390,16 +388,16 @@ private:
    * @param length supplies the length.
    * @return A status representing success.
    */
-  Status onHeaderValue(const char* data, size_t length);
+  Status onHeaderValueImpl(const char* data, size_t length);
 
   /**
    * Called when headers are complete. A base routine happens first then a virtual dispatch is
    * invoked. Note that this only applies to headers and NOT trailers. End of
-   * trailers are signaled via onMessageCompleteBase().
-   * @return An error status or a HttpParserCode.
+   * trailers are signaled via onMessageCompleteImpl().
+   * @return An error status or a CallbackResult.
    */
-  Envoy::StatusOr<HttpParserCode> onHeadersCompleteBase();
-  virtual Envoy::StatusOr<HttpParserCode> onHeadersComplete() PURE;
+  Envoy::StatusOr<CallbackResult> onHeadersCompleteImpl();
+  virtual Envoy::StatusOr<CallbackResult> onHeadersCompleteBase() PURE;
 
   /**
    * Called to see if upgrade transition is allowed.
@@ -422,13 +420,8 @@ private:
    * Called when the request/response is complete.
    * @return A status representing success.
    */
-  Status onMessageCompleteBase();
-  virtual void onMessageComplete() PURE;
-
-  /**
-   * Called when accepting a chunk header.
-   */
-  void onChunkHeader(bool is_final_chunk);
+  Status onMessageCompleteImpl();
+  virtual void onMessageCompleteBase() PURE;
 
   /**
    * @see onResetStreamBase().
@@ -464,8 +457,6 @@ private:
    */
   virtual void dumpAdditionalState(std::ostream& os, int indent_level) const PURE;
 
-  static http_parser_settings settings_;
-
   HeaderParsingState header_parsing_state_{HeaderParsingState::Field};
   // Used to accumulate the HTTP message body during the current dispatch call. The accumulated body
   // is pushed through the filter pipeline either at the end of the current dispatch call, or when
@@ -507,7 +498,7 @@ protected:
   };
   absl::optional<ActiveRequest>& activeRequest() { return active_request_; }
   // ConnectionImpl
-  void onMessageComplete() override;
+  void onMessageCompleteBase() override;
   // Add the size of the request_url to the reported header size when processing request headers.
   uint32_t getHeadersSize() override;
 
@@ -516,18 +507,18 @@ private:
    * Manipulate the request's first line, parsing the url and converting to a relative path if
    * necessary. Compute Host / :authority headers based on 7230#5.7 and 7230#6
    *
-   * @param is_connect true if the request has the CONNECT method
    * @param headers the request's headers
+   * @param method the request's method
    * @return Status representing success or failure. This will fail if there is an invalid url in
    * the request line.
    */
-  Status handlePath(RequestHeaderMap& headers, unsigned int method);
+  Status handlePath(RequestHeaderMap& headers, absl::string_view method);
 
   // ConnectionImpl
   void onEncodeComplete() override;
-  Status onMessageBegin() override;
-  Status onUrl(const char* data, size_t length) override;
-  Envoy::StatusOr<HttpParserCode> onHeadersComplete() override;
+  Status onMessageBeginBase() override;
+  Status onUrlBase(const char* data, size_t length) override;
+  Envoy::StatusOr<CallbackResult> onHeadersCompleteBase() override;
   // If upgrade behavior is not allowed, the HCM will have sanitized the headers out.
   bool upgradeAllowed() const override { return true; }
   void onBody(Buffer::Instance& data) override;
@@ -608,12 +599,12 @@ private:
   // ConnectionImpl
   Http::Status dispatch(Buffer::Instance& data) override;
   void onEncodeComplete() override {}
-  Status onMessageBegin() override { return okStatus(); }
-  Status onUrl(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
-  Envoy::StatusOr<HttpParserCode> onHeadersComplete() override;
+  Status onMessageBeginBase() override { return okStatus(); }
+  Status onUrlBase(const char*, size_t) override { NOT_IMPLEMENTED_GCOVR_EXCL_LINE; }
+  Envoy::StatusOr<CallbackResult> onHeadersCompleteBase() override;
   bool upgradeAllowed() const override;
   void onBody(Buffer::Instance& data) override;
-  void onMessageComplete() override;
+  void onMessageCompleteBase() override;
   void onResetStream(StreamResetReason reason) override;
   Status sendProtocolError(absl::string_view details) override;
   void onAboveHighWatermark() override;
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <memory>
+
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Parser implementation backed by the nodejs http_parser library.
+ */
+class LegacyHttpParserImpl : public Parser {
+public:
+  LegacyHttpParserImpl(MessageType type, ParserCallbacks* data);
+  ~LegacyHttpParserImpl() override;
+
+  // Http1::Parser
+  size_t execute(const char* data, int len) override;
+  void resume() override;
+  void pause() override;
+  ParserStatus getStatus() const override;
+  uint16_t statusCode() const override;
+  bool isHttp11() const override;
+  absl::optional<uint64_t> contentLength() const override;
+  bool isChunked() const override;
+  absl::string_view methodName() const override;
+  absl::string_view errorMessage() const override;
+  bool hasTransferEncoding() const override;
+
+private:
+  // Hide the http_parser types so that users of the interface do not depend on http_parser.h.
+  class Impl;
+  std::unique_ptr<Impl> impl_;
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/common/pure.h"
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * Every parser implementation should have a corresponding parser type here.
+ */
+enum class ParserType { Legacy, Simd };
+
+enum class MessageType { Request, Response };
+
+// CallbackResult is used to send signals to the parser. See
+// https://github.com/nodejs/http-parser/blob/5c5b3ac62662736de9e71640a8dc16da45b32503/http_parser.h#L72.
+enum class CallbackResult {
+  // An error has occurred. Callbacks should return an error when there is an error in processing
+  // the message and parsing should halt.
+  Error = -1,
+  // Success. Callbacks should return Success when processing should continue.
+  Success = 0,
+  // Returning NoBody from onHeadersComplete tells the parser that it should not expect a body.
+  NoBody = 1,
+  // Returning NoBodyData from onHeadersComplete tells the parser that it should not expect a body
+  // nor any further data on the connection.
+  NoBodyData = 2,
+};
+
+enum class ParserStatus { Ok, Paused, Error };
+
+/**
+ * Callbacks invoked by a Parser as it processes the bytes of an HTTP/1 message. Data passed to
+ * the URL, header field and header value callbacks may be delivered in several pieces which must
+ * be concatenated by the receiver.
+ */
+class ParserCallbacks {
+public:
+  virtual ~ParserCallbacks() = default;
+
+  /**
+   * Called when a request/response is beginning.
+   * @return CallbackResult representing success or failure.
+   */
+  virtual CallbackResult onMessageBegin() PURE;
+
+  /**
+   * Called when URL data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   * @return CallbackResult representing success or failure.
+   */
+  virtual CallbackResult onUrl(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header field data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   * @return CallbackResult representing success or failure.
+   */
+  virtual CallbackResult onHeaderField(const char* data, size_t length) PURE;
+
+  /**
+   * Called when header value data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   * @return CallbackResult representing success or failure.
+   */
+  virtual CallbackResult onHeaderValue(const char* data, size_t length) PURE;
+
+  /**
+   * Called when headers are complete. This is not called for trailers.
+   * @return CallbackResult representing success, failure, or how to treat the body.
+   */
+  virtual CallbackResult onHeadersComplete() PURE;
+
+  /**
+   * Called when body data is received.
+   * @param data supplies the start address.
+   * @param length supplies the length.
+   */
+  virtual void bufferBody(const char* data, size_t length) PURE;
+
+  /**
+   * Called when the HTTP message has completed parsing, including any trailers.
+   * @return CallbackResult representing success or failure.
+   */
+  virtual CallbackResult onMessageComplete() PURE;
+
+  /**
+   * Called when accepting a chunk header.
+   * @param is_final_chunk supplies whether this is the zero sized chunk ending the body.
+   */
+  virtual void onChunkHeader(bool is_final_chunk) PURE;
+};
+
+/**
+ * Parser interface used by the HTTP/1 codec. A parser processes one connection's worth of
+ * messages and reports its progress through ParserCallbacks.
+ */
+class Parser {
+public:
+  virtual ~Parser() = default;
+
+  /**
+   * Executes the parser.
+   * @param slice supplies the data to parse. A zero length slice signals the end of the input.
+   * @param len supplies the length of the slice.
+   * @return the number of bytes consumed.
+   */
+  virtual size_t execute(const char* slice, int len) PURE;
+
+  /**
+   * Unpauses the parser.
+   */
+  virtual void resume() PURE;
+
+  /**
+   * Pauses the parser. May be called from within a callback, in which case the parser returns
+   * from execute() once the callback returns.
+   */
+  virtual void pause() PURE;
+
+  /**
+   * @return the status of the parser.
+   */
+  virtual ParserStatus getStatus() const PURE;
+
+  /**
+   * @return the status code of a response.
+   */
+  virtual uint16_t statusCode() const PURE;
+
+  /**
+   * @return whether the message is HTTP/1.1.
+   */
+  virtual bool isHttp11() const PURE;
+
+  /**
+   * @return the value of the Content-Length header, if any.
+   */
+  virtual absl::optional<uint64_t> contentLength() const PURE;
+
+  /**
+   * @return whether the message uses chunked transfer encoding.
+   */
+  virtual bool isChunked() const PURE;
+
+  /**
+   * @return the method of a request.
+   */
+  virtual absl::string_view methodName() const PURE;
+
+  /**
+   * @return the name of the last parsing error, if any.
+   */
+  virtual absl::string_view errorMessage() const PURE;
+
+  /**
+   * @return whether a Transfer-Encoding header was present.
+   */
+  virtual bool hasTransferEncoding() const PURE;
+};
+
+using ParserPtr = std::unique_ptr<Parser>;
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
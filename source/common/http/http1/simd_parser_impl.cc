@@ -0,0 +1,761 @@
+#include "common/http/http1/simd_parser_impl.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <limits>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_split.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+// Error names follow http_parser so that codec errors read the same with either parser.
+constexpr absl::string_view ErrorCbMessageBegin = "HPE_CB_message_begin";
+constexpr absl::string_view ErrorCbUrl = "HPE_CB_url";
+constexpr absl::string_view ErrorCbHeaderField = "HPE_CB_header_field";
+constexpr absl::string_view ErrorCbHeaderValue = "HPE_CB_header_value";
+constexpr absl::string_view ErrorCbHeadersComplete = "HPE_CB_headers_complete";
+constexpr absl::string_view ErrorCbMessageComplete = "HPE_CB_message_complete";
+constexpr absl::string_view ErrorInvalidEofState = "HPE_INVALID_EOF_STATE";
+constexpr absl::string_view ErrorHeaderOverflow = "HPE_HEADER_OVERFLOW";
+constexpr absl::string_view ErrorClosedConnection = "HPE_CLOSED_CONNECTION";
+constexpr absl::string_view ErrorInvalidVersion = "HPE_INVALID_VERSION";
+constexpr absl::string_view ErrorInvalidStatus = "HPE_INVALID_STATUS";
+constexpr absl::string_view ErrorInvalidMethod = "HPE_INVALID_METHOD";
+constexpr absl::string_view ErrorInvalidUrl = "HPE_INVALID_URL";
+constexpr absl::string_view ErrorInvalidHeaderToken = "HPE_INVALID_HEADER_TOKEN";
+constexpr absl::string_view ErrorInvalidContentLength = "HPE_INVALID_CONTENT_LENGTH";
+constexpr absl::string_view ErrorUnexpectedContentLength = "HPE_UNEXPECTED_CONTENT_LENGTH";
+constexpr absl::string_view ErrorInvalidChunkSize = "HPE_INVALID_CHUNK_SIZE";
+constexpr absl::string_view ErrorInvalidTransferEncoding = "HPE_INVALID_TRANSFER_ENCODING";
+constexpr absl::string_view ErrorLfExpected = "HPE_LF_EXPECTED";
+constexpr absl::string_view ErrorStrict = "HPE_STRICT";
+
+// The default HTTP_MAX_HEADER_SIZE of http_parser, applied to reason phrases and chunk extensions
+// which are not reported through callbacks and hence not limited by the codec.
+constexpr size_t MaxSkippedBytes = 80 * 1024;
+constexpr size_t MaxMethodLength = 32;
+// "HTTP/1.1"
+constexpr size_t VersionLength = 8;
+// The longest header name which may change message framing, "transfer-encoding".
+constexpr size_t MaxSpecialHeaderNameLength = 17;
+
+// tchar from https://tools.ietf.org/html/rfc7230#section-3.2.6.
+const std::array<bool, 256>& tokenTable() {
+  static const std::array<bool, 256> table = []() {
+    std::array<bool, 256> table{};
+    for (const char c : absl::string_view("!#$%&'*+-.^_`|~")) {
+      table[static_cast<uint8_t>(c)] = true;
+    }
+    for (uint32_t c = 0; c < 256; ++c) {
+      if (absl::ascii_isalnum(c)) {
+        table[c] = true;
+      }
+    }
+    return table;
+  }();
+  return table;
+}
+
+bool isTokenChar(char c) { return tokenTable()[static_cast<uint8_t>(c)]; }
+
+int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  c = absl::ascii_tolower(c);
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+bool parseVersion(absl::string_view version, uint8_t& major, uint8_t& minor) {
+  if (version.size() != VersionLength || !absl::StartsWith(version, "HTTP/") ||
+      !absl::ascii_isdigit(version[5]) || version[6] != '.' || !absl::ascii_isdigit(version[7])) {
+    return false;
+  }
+  major = version[5] - '0';
+  minor = version[7] - '0';
+  return true;
+}
+
+} // namespace
+
+SimdHttpParserImpl::SimdHttpParserImpl(MessageType type, ParserCallbacks* callbacks)
+    : SimdHttpParserImpl(type, callbacks, ByteRangeScanner::bestImplementation()) {}
+
+SimdHttpParserImpl::SimdHttpParserImpl(MessageType type, ParserCallbacks* callbacks,
+                                       ByteRangeScanner::Implementation implementation)
+    : type_(type), callbacks_(callbacks),
+      // A URL ends at the first space. Any other control character is invalid.
+      url_scanner_({{0x00, 0x20}, {0x7f, 0x7f}}, implementation),
+      // A header value ends at CR or LF. Any other control character but HTAB is invalid.
+      header_value_scanner_({{0x00, 0x08}, {0x0a, 0x1f}, {0x7f, 0x7f}}, implementation) {}
+
+size_t SimdHttpParserImpl::execute(const char* slice, int len) {
+  if (status_ != ParserStatus::Ok) {
+    return 0;
+  }
+  if (len == 0) {
+    onEof();
+    return 0;
+  }
+
+  const char* p = slice;
+  const char* const end = slice + len;
+  while (p < end && status_ == ParserStatus::Ok) {
+    switch (state_) {
+    case State::MessageStart:
+    case State::Dead:
+      p = parseMessageStart(p, end);
+      break;
+    case State::Method:
+      p = parseMethod(p, end);
+      break;
+    case State::Url:
+      p = parseUrl(p, end);
+      break;
+    case State::RequestVersion:
+      p = parseRequestVersion(p, end);
+      break;
+    case State::ResponseVersion:
+      p = parseResponseVersion(p, end);
+      break;
+    case State::StatusCode:
+      p = parseStatusCode(p, end);
+      break;
+    case State::ReasonPhrase:
+      p = findLineEnd(p, end);
+      if (p != end) {
+        state_ = State::HeaderFieldStart;
+        ++p;
+      }
+      break;
+    case State::HeaderFieldStart:
+      p = parseHeaderFieldStart(p, end);
+      break;
+    case State::HeaderField:
+      p = parseHeaderField(p, end);
+      break;
+    case State::HeaderValueStart:
+      p = parseHeaderValueStart(p, end);
+      break;
+    case State::HeaderValue:
+      p = parseHeaderValue(p, end);
+      break;
+    case State::HeaderValueLf:
+      p = parseLf(p, ErrorLfExpected);
+      if (status_ == ParserStatus::Ok) {
+        onHeaderComplete(p);
+      }
+      break;
+    case State::HeadersLf:
+      if (*p != '\n') {
+        setError(ErrorLfExpected);
+        break;
+      }
+      p = onEndOfHeaders(p);
+      break;
+    case State::HeadersDone:
+      ++p;
+      startBody();
+      break;
+    case State::Body:
+    case State::ChunkData:
+      p = parseBody(p, end);
+      break;
+    case State::BodyUntilEof:
+      callbacks_->bufferBody(p, end - p);
+      p = end;
+      break;
+    case State::ChunkSize:
+      p = parseChunkSize(p, end);
+      break;
+    case State::ChunkExtension:
+      p = findLineEnd(p, end);
+      if (p != end) {
+        state_ = State::ChunkSizeLf;
+      }
+      break;
+    case State::ChunkSizeLf:
+      p = parseLf(p, ErrorLfExpected);
+      if (status_ == ParserStatus::Ok) {
+        onChunkSizeComplete();
+      }
+      break;
+    case State::ChunkDataCr:
+      if (*p == '\r') {
+        state_ = State::ChunkDataLf;
+        ++p;
+      } else if (*p == '\n') {
+        state_ = State::ChunkSize;
+        ++p;
+      } else {
+        setError(ErrorStrict);
+      }
+      break;
+    case State::ChunkDataLf:
+      p = parseLf(p, ErrorStrict);
+      if (status_ == ParserStatus::Ok) {
+        state_ = State::ChunkSize;
+      }
+      break;
+    case State::Upgraded:
+      // Everything after an upgrade belongs to the upgraded protocol.
+      pause();
+      break;
+    }
+  }
+  return p - slice;
+}
+
+void SimdHttpParserImpl::resume() {
+  if (status_ == ParserStatus::Paused) {
+    status_ = ParserStatus::Ok;
+  }
+}
+
+void SimdHttpParserImpl::pause() {
+  if (status_ == ParserStatus::Ok) {
+    status_ = ParserStatus::Paused;
+  }
+}
+
+absl::string_view SimdHttpParserImpl::errorMessage() const {
+  switch (status_) {
+  case ParserStatus::Ok:
+    return "HPE_OK";
+  case ParserStatus::Paused:
+    return "HPE_PAUSED";
+  case ParserStatus::Error:
+    return error_;
+  }
+  return error_;
+}
+
+const char* SimdHttpParserImpl::parseMessageStart(const char* p, const char* end) {
+  // Like http_parser, tolerate empty lines between messages.
+  while (p < end && (*p == '\r' || *p == '\n')) {
+    ++p;
+  }
+  if (p == end) {
+    return p;
+  }
+  if (state_ == State::Dead) {
+    setError(ErrorClosedConnection);
+    return p;
+  }
+
+  resetMessage();
+  state_ = type_ == MessageType::Request ? State::Method : State::ResponseVersion;
+  check(callbacks_->onMessageBegin(), ErrorCbMessageBegin);
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseMethod(const char* p, const char* end) {
+  const char* q = p;
+  while (q < end && isTokenChar(*q)) {
+    ++q;
+  }
+  method_.append(p, q - p);
+  if (method_.size() > MaxMethodLength) {
+    setError(ErrorInvalidMethod);
+    return q;
+  }
+  if (q == end) {
+    return q;
+  }
+  if (*q != ' ' || method_.empty()) {
+    setError(ErrorInvalidMethod);
+    return q;
+  }
+  state_ = State::Url;
+  return q + 1;
+}
+
+const char* SimdHttpParserImpl::parseUrl(const char* p, const char* end) {
+  const size_t length = url_scanner_.find(p, end - p);
+  if (length > 0) {
+    url_seen_ = true;
+    if (!check(callbacks_->onUrl(p, length), ErrorCbUrl)) {
+      return p + length;
+    }
+    p += length;
+  }
+  if (p == end) {
+    return p;
+  }
+  // HTTP/0.9 requests without a version are not supported.
+  if (*p != ' ' || !url_seen_) {
+    setError(ErrorInvalidUrl);
+    return p;
+  }
+  state_ = State::RequestVersion;
+  return p + 1;
+}
+
+const char* SimdHttpParserImpl::parseRequestVersion(const char* p, const char* end) {
+  const char* lf = static_cast<const char*>(memchr(p, '\n', end - p));
+  const char* line_end = lf != nullptr ? lf : end;
+  token_.append(p, line_end - p);
+  // Allow for the version and a CR.
+  if (token_.size() > VersionLength + 1) {
+    setError(ErrorInvalidVersion);
+    return line_end;
+  }
+  if (lf == nullptr) {
+    return end;
+  }
+
+  absl::string_view version = token_;
+  if (absl::EndsWith(version, "\r")) {
+    version.remove_suffix(1);
+  }
+  if (!parseVersion(version, http_major_, http_minor_)) {
+    setError(ErrorInvalidVersion);
+    return lf;
+  }
+  token_.clear();
+  state_ = State::HeaderFieldStart;
+  return lf + 1;
+}
+
+const char* SimdHttpParserImpl::parseResponseVersion(const char* p, const char* end) {
+  for (; p < end; ++p) {
+    if (*p == ' ') {
+      if (!parseVersion(token_, http_major_, http_minor_)) {
+        setError(ErrorInvalidVersion);
+        return p;
+      }
+      token_.clear();
+      state_ = State::StatusCode;
+      return p + 1;
+    }
+    if (token_.size() == VersionLength) {
+      setError(ErrorInvalidVersion);
+      return p;
+    }
+    token_.push_back(*p);
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseStatusCode(const char* p, const char* end) {
+  for (; p < end; ++p) {
+    const char c = *p;
+    if (absl::ascii_isdigit(c)) {
+      if (token_.size() == 3) {
+        setError(ErrorInvalidStatus);
+        return p;
+      }
+      token_.push_back(c);
+      continue;
+    }
+    if (token_.empty() || (c != ' ' && c != '\r' && c != '\n')) {
+      setError(ErrorInvalidStatus);
+      return p;
+    }
+
+    uint32_t status_code;
+    absl::SimpleAtoi(token_, &status_code);
+    status_code_ = status_code;
+    token_.clear();
+    if (c == '\n') {
+      state_ = State::HeaderFieldStart;
+    } else {
+      // The reason phrase is not reported, skip it along with the line ending.
+      skipped_ = 0;
+      state_ = State::ReasonPhrase;
+    }
+    return p + 1;
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::findLineEnd(const char* p, const char* end) {
+  const char* lf = static_cast<const char*>(memchr(p, '\n', end - p));
+  if (lf == nullptr) {
+    skipped_ += end - p;
+    if (skipped_ > MaxSkippedBytes) {
+      setError(ErrorHeaderOverflow);
+    }
+    return end;
+  }
+  skipped_ = 0;
+  return lf;
+}
+
+const char* SimdHttpParserImpl::parseHeaderFieldStart(const char* p, const char*) {
+  switch (*p) {
+  case '\r':
+    state_ = State::HeadersLf;
+    return p + 1;
+  case '\n':
+    return onEndOfHeaders(p);
+  case ' ':
+  case '\t':
+    // Obsolete line folding.
+    setError(ErrorInvalidHeaderToken);
+    return p;
+  default:
+    header_name_.clear();
+    header_name_length_ = 0;
+    state_ = State::HeaderField;
+    return p;
+  }
+}
+
+const char* SimdHttpParserImpl::parseHeaderField(const char* p, const char* end) {
+  const char* q = p;
+  while (q < end && isTokenChar(*q)) {
+    ++q;
+  }
+  const size_t length = q - p;
+  if (length > 0) {
+    if (!in_trailers_ && header_name_length_ + length <= MaxSpecialHeaderNameLength) {
+      for (const char* c = p; c < q; ++c) {
+        header_name_.push_back(absl::ascii_tolower(*c));
+      }
+    }
+    header_name_length_ += length;
+    if (!check(callbacks_->onHeaderField(p, length), ErrorCbHeaderField)) {
+      return q;
+    }
+  }
+  if (q == end) {
+    return q;
+  }
+  if (*q != ':' || header_name_length_ == 0) {
+    setError(ErrorInvalidHeaderToken);
+    return q;
+  }
+
+  special_header_ = SpecialHeader::None;
+  if (!in_trailers_ && header_name_.size() == header_name_length_) {
+    if (header_name_ == "content-length") {
+      special_header_ = SpecialHeader::ContentLength;
+    } else if (header_name_ == "transfer-encoding") {
+      special_header_ = SpecialHeader::TransferEncoding;
+    } else if (header_name_ == "connection") {
+      special_header_ = SpecialHeader::Connection;
+    }
+  }
+  special_value_.clear();
+  value_seen_ = false;
+  state_ = State::HeaderValueStart;
+  return q + 1;
+}
+
+const char* SimdHttpParserImpl::parseHeaderValueStart(const char* p, const char* end) {
+  while (p < end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  if (p < end) {
+    state_ = State::HeaderValue;
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseHeaderValue(const char* p, const char* end) {
+  const size_t length = header_value_scanner_.find(p, end - p);
+  if (length > 0) {
+    value_seen_ = true;
+    if (special_header_ != SpecialHeader::None) {
+      special_value_.append(p, length);
+    }
+    if (!check(callbacks_->onHeaderValue(p, length), ErrorCbHeaderValue)) {
+      return p + length;
+    }
+    p += length;
+  }
+  if (p == end) {
+    return p;
+  }
+
+  switch (*p) {
+  case '\r':
+    state_ = State::HeaderValueLf;
+    return p + 1;
+  case '\n':
+    ++p;
+    onHeaderComplete(p);
+    return p;
+  default:
+    setError(ErrorInvalidHeaderToken);
+    return p;
+  }
+}
+
+const char* SimdHttpParserImpl::parseLf(const char* p, absl::string_view error) {
+  if (*p != '\n') {
+    setError(error);
+    return p;
+  }
+  return p + 1;
+}
+
+void SimdHttpParserImpl::onHeaderComplete(const char* p) {
+  state_ = State::HeaderFieldStart;
+
+  const absl::string_view value = absl::StripTrailingAsciiWhitespace(special_value_);
+  switch (special_header_) {
+  case SpecialHeader::None:
+    break;
+  case SpecialHeader::ContentLength: {
+    if (content_length_.has_value()) {
+      setError(ErrorUnexpectedContentLength);
+      return;
+    }
+    uint64_t content_length;
+    if (value.empty() || !std::all_of(value.begin(), value.end(), absl::ascii_isdigit) ||
+        !absl::SimpleAtoi(value, &content_length)) {
+      setError(ErrorInvalidContentLength);
+      return;
+    }
+    content_length_ = content_length;
+    break;
+  }
+  case SpecialHeader::TransferEncoding: {
+    has_transfer_encoding_ = true;
+    // Only a final "chunked" coding frames the message.
+    const size_t comma = value.rfind(',');
+    const absl::string_view last_coding = absl::StripAsciiWhitespace(
+        comma == absl::string_view::npos ? value : value.substr(comma + 1));
+    chunked_ = absl::EqualsIgnoreCase(last_coding, "chunked");
+    break;
+  }
+  case SpecialHeader::Connection:
+    for (const absl::string_view token : absl::StrSplit(value, ',')) {
+      const absl::string_view option = absl::StripAsciiWhitespace(token);
+      if (absl::EqualsIgnoreCase(option, "close")) {
+        connection_close_ = true;
+      } else if (absl::EqualsIgnoreCase(option, "keep-alive")) {
+        connection_keep_alive_ = true;
+      }
+    }
+    break;
+  }
+
+  if (!value_seen_) {
+    // http_parser reports empty header values with a zero length callback.
+    check(callbacks_->onHeaderValue(p, 0), ErrorCbHeaderValue);
+  }
+}
+
+const char* SimdHttpParserImpl::onEndOfHeaders(const char* lf) {
+  if (in_trailers_) {
+    onMessageComplete();
+    return lf + 1;
+  }
+
+  // Same as http_parser with allow_chunked_length set.
+  if (type_ == MessageType::Request && has_transfer_encoding_ && content_length_.has_value() &&
+      !chunked_) {
+    setError(ErrorUnexpectedContentLength);
+    return lf;
+  }
+
+  switch (callbacks_->onHeadersComplete()) {
+  case CallbackResult::Success:
+    break;
+  case CallbackResult::NoBodyData:
+    upgrade_ = true;
+    skip_body_ = true;
+    break;
+  case CallbackResult::NoBody:
+    skip_body_ = true;
+    break;
+  case CallbackResult::Error:
+    setError(ErrorCbHeadersComplete);
+    return lf;
+  }
+
+  if (status_ == ParserStatus::Paused) {
+    // Like http_parser, leave the final LF unconsumed so that the body starts once resumed.
+    state_ = State::HeadersDone;
+    return lf;
+  }
+  startBody();
+  return lf + 1;
+}
+
+void SimdHttpParserImpl::startBody() {
+  if (upgrade_) {
+    onMessageComplete();
+    if (status_ != ParserStatus::Error) {
+      state_ = State::Upgraded;
+      pause();
+    }
+    return;
+  }
+  if (skip_body_) {
+    onMessageComplete();
+    return;
+  }
+  // https://tools.ietf.org/html/rfc7230#section-3.3.3 bullet 3: a request with a transfer coding
+  // other than a final chunked coding cannot be framed.
+  if (type_ == MessageType::Request && has_transfer_encoding_ && !chunked_) {
+    setError(ErrorInvalidTransferEncoding);
+    return;
+  }
+  if (chunked_) {
+    chunk_size_ = 0;
+    chunk_size_seen_ = false;
+    state_ = State::ChunkSize;
+    return;
+  }
+  if (content_length_.has_value()) {
+    if (content_length_.value() == 0) {
+      onMessageComplete();
+    } else {
+      remaining_ = content_length_.value();
+      state_ = State::Body;
+    }
+    return;
+  }
+  if (type_ == MessageType::Request || status_code_ / 100 == 1 || status_code_ == 204 ||
+      status_code_ == 304) {
+    onMessageComplete();
+    return;
+  }
+  state_ = State::BodyUntilEof;
+}
+
+const char* SimdHttpParserImpl::parseBody(const char* p, const char* end) {
+  const uint64_t length = std::min<uint64_t>(remaining_, end - p);
+  remaining_ -= length;
+  callbacks_->bufferBody(p, length);
+  p += length;
+  if (remaining_ == 0) {
+    if (state_ == State::Body) {
+      onMessageComplete();
+    } else {
+      state_ = State::ChunkDataCr;
+    }
+  }
+  return p;
+}
+
+const char* SimdHttpParserImpl::parseChunkSize(const char* p, const char* end) {
+  for (; p < end; ++p) {
+    const char c = *p;
+    const int digit = hexValue(c);
+    if (digit >= 0) {
+      if (chunk_size_ > (std::numeric_limits<uint64_t>::max() >> 4)) {
+        setError(ErrorInvalidChunkSize);
+        return p;
+      }
+      chunk_size_ = (chunk_size_ << 4) | digit;
+      chunk_size_seen_ = true;
+      continue;
+    }
+    if (!chunk_size_seen_) {
+      setError(ErrorInvalidChunkSize);
+      return p;
+    }
+
+    switch (c) {
+    case ';':
+    case ' ':
+    case '\t':
+      skipped_ = 0;
+      state_ = State::ChunkExtension;
+      return p + 1;
+    case '\r':
+      state_ = State::ChunkSizeLf;
+      return p + 1;
+    case '\n':
+      onChunkSizeComplete();
+      return p + 1;
+    default:
+      setError(ErrorInvalidChunkSize);
+      return p;
+    }
+  }
+  return p;
+}
+
+void SimdHttpParserImpl::onChunkSizeComplete() {
+  const uint64_t chunk_size = chunk_size_;
+  chunk_size_ = 0;
+  chunk_size_seen_ = false;
+  if (chunk_size == 0) {
+    in_trailers_ = true;
+    state_ = State::HeaderFieldStart;
+  } else {
+    remaining_ = chunk_size;
+    state_ = State::ChunkData;
+  }
+  callbacks_->onChunkHeader(chunk_size == 0);
+}
+
+void SimdHttpParserImpl::onMessageComplete() {
+  // A message delimited by the end of the connection cannot be followed by another one.
+  const bool keep_alive = state_ != State::BodyUntilEof && shouldKeepAlive();
+  in_trailers_ = false;
+  state_ = keep_alive ? State::MessageStart : State::Dead;
+  check(callbacks_->onMessageComplete(), ErrorCbMessageComplete);
+}
+
+void SimdHttpParserImpl::onEof() {
+  switch (state_) {
+  case State::MessageStart:
+  case State::Dead:
+  case State::Upgraded:
+    return;
+  case State::BodyUntilEof:
+    onMessageComplete();
+    return;
+  default:
+    setError(ErrorInvalidEofState);
+    return;
+  }
+}
+
+void SimdHttpParserImpl::resetMessage() {
+  method_.clear();
+  token_.clear();
+  status_code_ = 0;
+  http_major_ = 0;
+  http_minor_ = 0;
+  content_length_.reset();
+  chunked_ = false;
+  has_transfer_encoding_ = false;
+  connection_close_ = false;
+  connection_keep_alive_ = false;
+  in_trailers_ = false;
+  url_seen_ = false;
+  skip_body_ = false;
+  upgrade_ = false;
+}
+
+bool SimdHttpParserImpl::shouldKeepAlive() const {
+  if (http_major_ > 0 && http_minor_ > 0) {
+    return !connection_close_;
+  }
+  return connection_keep_alive_;
+}
+
+bool SimdHttpParserImpl::check(CallbackResult result, absl::string_view error) {
+  if (result == CallbackResult::Error) {
+    setError(error);
+    return false;
+  }
+  return status_ == ParserStatus::Ok;
+}
+
+void SimdHttpParserImpl::setError(absl::string_view error) {
+  status_ = ParserStatus::Error;
+  error_ = error;
+}
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
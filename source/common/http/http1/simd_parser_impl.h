@@ -0,0 +1,144 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "common/http/http1/byte_range_scanner.h"
+#include "common/http/http1/parser.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+
+/**
+ * A self contained HTTP/1 parser which scans URLs and header values for their delimiters with
+ * ByteRangeScanner instead of inspecting one byte at a time. It follows the callback contract of
+ * http_parser (including partial URL, header field and header value callbacks across slices, pause
+ * semantics and chunked trailers) so that it can be swapped in behind the Parser interface.
+ *
+ * Deliberate differences from http_parser:
+ * - Obsolete header line folding is rejected rather than unfolded (RFC 7230 section 3.2.4).
+ * - Extension methods made of token characters are accepted, and methodName() returns the method
+ *   exactly as received.
+ */
+class SimdHttpParserImpl : public Parser {
+public:
+  SimdHttpParserImpl(MessageType type, ParserCallbacks* callbacks);
+  SimdHttpParserImpl(MessageType type, ParserCallbacks* callbacks,
+                     ByteRangeScanner::Implementation implementation);
+
+  // Http1::Parser
+  size_t execute(const char* slice, int len) override;
+  void resume() override;
+  void pause() override;
+  ParserStatus getStatus() const override { return status_; }
+  uint16_t statusCode() const override { return status_code_; }
+  bool isHttp11() const override { return http_major_ == 1 && http_minor_ == 1; }
+  absl::optional<uint64_t> contentLength() const override { return content_length_; }
+  bool isChunked() const override { return chunked_; }
+  absl::string_view methodName() const override { return method_; }
+  absl::string_view errorMessage() const override;
+  bool hasTransferEncoding() const override { return has_transfer_encoding_; }
+
+private:
+  enum class State {
+    MessageStart,
+    Method,
+    Url,
+    RequestVersion,
+    ResponseVersion,
+    StatusCode,
+    ReasonPhrase,
+    HeaderFieldStart,
+    HeaderField,
+    HeaderValueStart,
+    HeaderValue,
+    HeaderValueLf,
+    HeadersLf,
+    // Paused in onHeadersComplete() before consuming the final LF of the headers.
+    HeadersDone,
+    Body,
+    BodyUntilEof,
+    ChunkSize,
+    ChunkExtension,
+    ChunkSizeLf,
+    ChunkData,
+    ChunkDataCr,
+    ChunkDataLf,
+    Upgraded,
+    // Reached after a message which does not allow the connection to be reused.
+    Dead,
+  };
+
+  enum class SpecialHeader { None, ContentLength, TransferEncoding, Connection };
+
+  const char* parseMessageStart(const char* p, const char* end);
+  const char* parseMethod(const char* p, const char* end);
+  const char* parseUrl(const char* p, const char* end);
+  const char* parseRequestVersion(const char* p, const char* end);
+  const char* parseResponseVersion(const char* p, const char* end);
+  const char* parseStatusCode(const char* p, const char* end);
+  const char* findLineEnd(const char* p, const char* end);
+  const char* parseHeaderFieldStart(const char* p, const char* end);
+  const char* parseHeaderField(const char* p, const char* end);
+  const char* parseHeaderValueStart(const char* p, const char* end);
+  const char* parseHeaderValue(const char* p, const char* end);
+  const char* parseBody(const char* p, const char* end);
+  const char* parseChunkSize(const char* p, const char* end);
+  const char* parseLf(const char* p, absl::string_view error);
+
+  void onHeaderComplete(const char* p);
+  const char* onEndOfHeaders(const char* lf);
+  void startBody();
+  void onChunkSizeComplete();
+  void onMessageComplete();
+  void onEof();
+  void resetMessage();
+  bool shouldKeepAlive() const;
+  bool check(CallbackResult result, absl::string_view error);
+  void setError(absl::string_view error);
+
+  const MessageType type_;
+  ParserCallbacks* const callbacks_;
+  const ByteRangeScanner url_scanner_;
+  const ByteRangeScanner header_value_scanner_;
+
+  State state_{State::MessageStart};
+  ParserStatus status_{ParserStatus::Ok};
+  absl::string_view error_;
+
+  // Per message state.
+  std::string method_;
+  std::string token_;
+  uint16_t status_code_{};
+  uint8_t http_major_{};
+  uint8_t http_minor_{};
+  absl::optional<uint64_t> content_length_;
+  bool chunked_{};
+  bool has_transfer_encoding_{};
+  bool connection_close_{};
+  bool connection_keep_alive_{};
+  bool in_trailers_{};
+  bool url_seen_{};
+  bool skip_body_{};
+  bool upgrade_{};
+
+  // Per header state.
+  SpecialHeader special_header_{SpecialHeader::None};
+  // The lower cased header name while it may still name a special header.
+  std::string header_name_;
+  std::string special_value_;
+  size_t header_name_length_{};
+  bool value_seen_{};
+
+  // Body state.
+  uint64_t remaining_{};
+  uint64_t chunk_size_{};
+  bool chunk_size_seen_{};
+  // Bytes skipped in the current reason phrase or chunk extension.
+  size_t skipped_{};
+};
+
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,564 @@
+#include "common/http/http2/shared_conn_pool.h"
+
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/common/dump_state_utils.h"
+#include "common/http/header_map_impl.h"
+#include "common/http/header_utility.h"
+#include "common/network/socket_impl.h"
+#include "common/stream_info/stream_info_impl.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+namespace {
+
+// Releases a stream once the callbacks on the stack of its thread unwind.
+struct DeferredStreamRelease : public Event::DeferredDeletable {
+  explicit DeferredStreamRelease(SharedStreamSharedPtr stream) : stream_(std::move(stream)) {}
+
+  SharedStreamSharedPtr stream_;
+};
+
+SharedConnPoolThread::PoolKey
+poolKey(const Upstream::HostConstSharedPtr& host, Upstream::ResourcePriority priority,
+        const Network::ConnectionSocket::OptionsSharedPtr& options,
+        const Network::TransportSocketOptionsSharedPtr& transport_socket_options) {
+  // Separate the connections of different socket options, as the cluster manager does for the
+  // pools of a worker.
+  std::vector<uint8_t> hash_key;
+  if (options != nullptr) {
+    for (const auto& option : *options) {
+      option->hashKey(hash_key);
+    }
+  }
+  if (transport_socket_options != nullptr) {
+    transport_socket_options->hashKey(hash_key, host->transportSocketFactory());
+  }
+  return {host.get(), priority, std::move(hash_key)};
+}
+
+} // namespace
+
+SharedConnPoolThread::SharedConnPoolThread(Api::Api& api, ThreadLocal::Instance& tls,
+                                           PoolFactory pool_factory)
+    : tls_(tls), pool_factory_(std::move(pool_factory)),
+      dispatcher_(api.allocateDispatcher("shared_h2_pool")) {
+  tls_.registerThread(*dispatcher_, false);
+  thread_ = api.threadFactory().createThread([this]() { threadRoutine(); },
+                                             Thread::Options{"shared_h2_pool"});
+}
+
+SharedConnPoolThread::~SharedConnPoolThread() { shutdown(); }
+
+void SharedConnPoolThread::post(Event::PostCb callback) {
+  absl::MutexLock lock(&mutex_);
+  if (!shut_down_) {
+    dispatcher_->post(std::move(callback));
+  }
+}
+
+void SharedConnPoolThread::shutdown() {
+  {
+    absl::MutexLock lock(&mutex_);
+    if (shut_down_) {
+      return;
+    }
+    shut_down_ = true;
+    // The pools must be destroyed on the thread. Any stream left on them is reset.
+    dispatcher_->post([this]() {
+      pools_.clear();
+      draining_pools_.clear();
+      dispatcher_->clearDeferredDeleteList();
+      dispatcher_->exit();
+    });
+  }
+  thread_->join();
+}
+
+void SharedConnPoolThread::threadRoutine() {
+  dispatcher_->run(Event::Dispatcher::RunType::RunUntilExit);
+  // The pools were destroyed by shutdown(), release the thread local data along with them.
+  dispatcher_->shutdown();
+  tls_.shutdownThread();
+}
+
+SharedConnPoolThread::SharedPool& SharedConnPoolThread::attach(
+    const PoolKey& key, Upstream::HostConstSharedPtr host, Upstream::ResourcePriority priority,
+    const Network::ConnectionSocket::OptionsSharedPtr& options,
+    const Network::TransportSocketOptionsSharedPtr& transport_socket_options) {
+  ASSERT(dispatcher_->isThreadSafe());
+  std::unique_ptr<SharedPool>& shared_pool = pools_[key];
+  if (shared_pool == nullptr) {
+    ENVOY_LOG(debug, "creating shared HTTP/2 pool for {}", host->address()->asString());
+    shared_pool = std::make_unique<SharedPool>();
+    shared_pool->pool_ = pool_factory_(*dispatcher_, std::move(host), priority, options,
+                                       transport_socket_options, shared_pool->state_);
+  }
+  shared_pool->users_++;
+  return *shared_pool;
+}
+
+void SharedConnPoolThread::detach(const PoolKey& key) {
+  ASSERT(dispatcher_->isThreadSafe());
+  auto it = pools_.find(key);
+  ASSERT(it != pools_.end());
+  if (--it->second->users_ > 0) {
+    return;
+  }
+
+  // A worker may need the host again while the pool drains, which then gets a new pool.
+  SharedPool* shared_pool = it->second.get();
+  draining_pools_.emplace(shared_pool, std::move(it->second));
+  pools_.erase(it);
+  shared_pool->pool_->addDrainedCallback([this, shared_pool]() {
+    auto it = draining_pools_.find(shared_pool);
+    if (it == draining_pools_.end()) {
+      return;
+    }
+    dispatcher_->deferredDelete(std::move(it->second));
+    draining_pools_.erase(it);
+  });
+}
+
+SharedConnPoolAttachment::SharedConnPoolAttachment(Event::Dispatcher& worker_dispatcher,
+                                                   SharedConnPoolThreadSharedPtr thread,
+                                                   Upstream::HostConstSharedPtr host)
+    : worker_dispatcher_(worker_dispatcher), thread_(std::move(thread)), host_(std::move(host)),
+      stats_({ALL_SHARED_CONN_POOL_STATS(
+          POOL_COUNTER_PREFIX(host_->cluster().statsScope(), "shared_http2_pool."))}) {}
+
+void SharedConnPoolAttachment::postToPool(Event::PostCb callback) {
+  stats_.cross_thread_hops_.inc();
+  thread_->post(std::move(callback));
+}
+
+void SharedConnPoolAttachment::postToWorker(Event::PostCb callback) {
+  absl::MutexLock lock(&mutex_);
+  if (worker_detached_) {
+    return;
+  }
+  stats_.cross_thread_hops_.inc();
+  worker_dispatcher_.post(std::move(callback));
+}
+
+void SharedConnPoolAttachment::detachWorker() {
+  absl::MutexLock lock(&mutex_);
+  worker_detached_ = true;
+}
+
+SharedStream::SharedStream(SharedConnPoolImpl& parent,
+                           SharedConnPoolAttachmentSharedPtr attachment,
+                           ResponseDecoder& response_decoder, ConnectionPool::Callbacks& callbacks)
+    : attachment_(std::move(attachment)), parent_(&parent), response_decoder_(response_decoder),
+      callbacks_(&callbacks) {}
+
+void SharedStream::postToPool(std::function<void(SharedStream&)> callback) {
+  attachment_->postToPool(
+      [self = shared_from_this(), callback = std::move(callback)]() { callback(*self); });
+}
+
+void SharedStream::postToWorker(std::function<void(SharedStream&)> callback) {
+  attachment_->postToWorker([self = shared_from_this(), callback = std::move(callback)]() {
+    if (!self->worker_done_) {
+      callback(*self);
+    }
+  });
+}
+
+void SharedStream::start() {
+  postToPool([](SharedStream& stream) { stream.onPoolStart(); });
+}
+
+void SharedStream::onParentDestroyed() {
+  parent_ = nullptr;
+  if (worker_done_) {
+    return;
+  }
+  worker_done_ = true;
+  postToPool([](SharedStream& stream) {
+    stream.onPoolReset(StreamResetReason::LocalReset,
+                       Envoy::ConnectionPool::CancelPolicy::Default);
+  });
+}
+
+Status SharedStream::encodeHeaders(const RequestHeaderMap& headers, bool end_stream) {
+  // Fail as the codec would, as its result isn't known until the headers reach the thread.
+  RETURN_IF_ERROR(HeaderUtility::checkRequiredHeaders(headers));
+  // The headers stay owned by the caller, who may change them once this returns.
+  std::shared_ptr<RequestHeaderMap> copy = createHeaderMap<RequestHeaderMapImpl>(headers);
+  postToPool([headers = std::move(copy), end_stream](SharedStream& stream) {
+    if (stream.pool_encoder_ == nullptr) {
+      return;
+    }
+    if (!stream.pool_encoder_->encodeHeaders(*headers, end_stream).ok()) {
+      stream.pool_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+      return;
+    }
+    if (end_stream) {
+      stream.onPoolLocalEnd();
+    }
+  });
+  if (end_stream) {
+    onWorkerLocalEnd();
+  }
+  return okStatus();
+}
+
+void SharedStream::encodeData(Buffer::Instance& data, bool end_stream) {
+  auto buffer = std::make_shared<Buffer::OwnedImpl>();
+  buffer->move(data);
+  postToPool([buffer, end_stream](SharedStream& stream) {
+    if (stream.pool_encoder_ == nullptr) {
+      return;
+    }
+    stream.pool_encoder_->encodeData(*buffer, end_stream);
+    if (end_stream) {
+      stream.onPoolLocalEnd();
+    }
+  });
+  if (end_stream) {
+    onWorkerLocalEnd();
+  }
+}
+
+void SharedStream::encodeTrailers(const RequestTrailerMap& trailers) {
+  std::shared_ptr<RequestTrailerMap> copy = createHeaderMap<RequestTrailerMapImpl>(trailers);
+  postToPool([trailers = std::move(copy)](SharedStream& stream) {
+    if (stream.pool_encoder_ == nullptr) {
+      return;
+    }
+    stream.pool_encoder_->encodeTrailers(*trailers);
+    stream.onPoolLocalEnd();
+  });
+  onWorkerLocalEnd();
+}
+
+void SharedStream::encodeMetadata(const MetadataMapVector& metadata_map_vector) {
+  auto copy = std::make_shared<MetadataMapVector>();
+  for (const MetadataMapPtr& metadata_map : metadata_map_vector) {
+    copy->push_back(std::make_unique<MetadataMap>(*metadata_map));
+  }
+  postToPool([metadata_map_vector = std::move(copy)](SharedStream& stream) {
+    if (stream.pool_encoder_ != nullptr) {
+      stream.pool_encoder_->encodeMetadata(*metadata_map_vector);
+    }
+  });
+}
+
+void SharedStream::enableTcpTunneling() {
+  postToPool([](SharedStream& stream) {
+    if (stream.pool_encoder_ != nullptr) {
+      stream.pool_encoder_->enableTcpTunneling();
+    }
+  });
+}
+
+void SharedStream::resetStream(StreamResetReason reason) {
+  if (worker_done_) {
+    return;
+  }
+  runResetCallbacks(reason);
+  postToPool([reason](SharedStream& stream) {
+    stream.onPoolReset(reason, Envoy::ConnectionPool::CancelPolicy::Default);
+  });
+  onWorkerDone();
+}
+
+void SharedStream::readDisable(bool disable) {
+  postToPool([disable](SharedStream& stream) {
+    if (stream.pool_encoder_ != nullptr) {
+      stream.pool_encoder_->getStream().readDisable(disable);
+    }
+  });
+}
+
+void SharedStream::setFlushTimeout(std::chrono::milliseconds timeout) {
+  postToPool([timeout](SharedStream& stream) {
+    if (stream.pool_encoder_ != nullptr) {
+      stream.pool_encoder_->getStream().setFlushTimeout(timeout);
+    }
+  });
+}
+
+void SharedStream::cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  ASSERT(!worker_done_);
+  postToPool([cancel_policy](SharedStream& stream) {
+    stream.onPoolReset(StreamResetReason::LocalReset, cancel_policy);
+  });
+  onWorkerDone();
+}
+
+void SharedStream::onWorkerPoolReady(Upstream::HostDescriptionConstSharedPtr host,
+                                     const Network::Address::InstanceConstSharedPtr& local_address,
+                                     const Network::Address::InstanceConstSharedPtr& remote_address,
+                                     uint32_t buffer_limit,
+                                     absl::optional<Http::Protocol> protocol) {
+  local_address_ = local_address;
+  buffer_limit_ = buffer_limit;
+  // The connection's own stream info is used on the thread, so the worker gets a copy of its
+  // addresses. The TLS information of the connection isn't copied, as it can't be read safely
+  // while the thread uses the connection.
+  stream_info_ = std::make_unique<StreamInfo::StreamInfoImpl>(
+      parent_->dispatcher().timeSource(),
+      std::make_shared<Network::SocketAddressSetterImpl>(local_address, remote_address));
+
+  ConnectionPool::Callbacks* callbacks = callbacks_;
+  callbacks_ = nullptr;
+  callbacks->onPoolReady(*this, std::move(host), *stream_info_, protocol);
+}
+
+void SharedStream::onWorkerLocalEnd() {
+  local_end_stream_ = true;
+  if (worker_remote_end_) {
+    onWorkerDone();
+  }
+}
+
+void SharedStream::onWorkerRemoteEnd() {
+  worker_remote_end_ = true;
+  if (local_end_stream_) {
+    onWorkerDone();
+  }
+}
+
+void SharedStream::onWorkerDone() {
+  worker_done_ = true;
+  if (parent_ != nullptr) {
+    parent_->onStreamDone(*this);
+  }
+}
+
+void SharedStream::onPoolStart() {
+  ASSERT(attachment_->pool_ != nullptr);
+  pool_self_ = shared_from_this();
+  // The pool calls back right away if it has a ready connection or fails immediately.
+  pool_handle_ = attachment_->pool_->pool_->newStream(*this, *this);
+}
+
+void SharedStream::onPoolReset(StreamResetReason reason,
+                               Envoy::ConnectionPool::CancelPolicy cancel_policy) {
+  if (pool_handle_ != nullptr) {
+    ConnectionPool::Cancellable* handle = pool_handle_;
+    pool_handle_ = nullptr;
+    handle->cancel(cancel_policy);
+    onPoolDone();
+  } else if (pool_encoder_ != nullptr) {
+    // Ends the stream through onResetStream().
+    pool_encoder_->getStream().resetStream(reason);
+  }
+}
+
+void SharedStream::onPoolLocalEnd() {
+  pool_local_end_ = true;
+  if (pool_remote_end_) {
+    onPoolDone();
+  }
+}
+
+void SharedStream::onPoolRemoteEnd() {
+  pool_remote_end_ = true;
+  if (pool_local_end_) {
+    onPoolDone();
+  }
+}
+
+void SharedStream::onPoolDone() {
+  if (pool_encoder_ != nullptr) {
+    pool_encoder_->getStream().removeCallbacks(*this);
+    pool_encoder_ = nullptr;
+  }
+  if (pool_self_ != nullptr) {
+    attachment_->thread().dispatcher().deferredDelete(
+        std::make_unique<DeferredStreamRelease>(std::move(pool_self_)));
+  }
+}
+
+void SharedStream::decode100ContinueHeaders(ResponseHeaderMapPtr&& headers) {
+  // Posted callbacks must be copyable, so move-only arguments are handed over in a shared holder.
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToWorker([holder](SharedStream& stream) {
+    stream.response_decoder_.decode100ContinueHeaders(std::move(*holder));
+  });
+}
+
+void SharedStream::decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) {
+  auto holder = std::make_shared<ResponseHeaderMapPtr>(std::move(headers));
+  postToWorker([holder, end_stream](SharedStream& stream) {
+    stream.response_decoder_.decodeHeaders(std::move(*holder), end_stream);
+    if (end_stream) {
+      stream.onWorkerRemoteEnd();
+    }
+  });
+  if (end_stream) {
+    onPoolRemoteEnd();
+  }
+}
+
+void SharedStream::decodeData(Buffer::Instance& data, bool end_stream) {
+  auto buffer = std::make_shared<Buffer::OwnedImpl>();
+  buffer->move(data);
+  postToWorker([buffer, end_stream](SharedStream& stream) {
+    stream.response_decoder_.decodeData(*buffer, end_stream);
+    if (end_stream) {
+      stream.onWorkerRemoteEnd();
+    }
+  });
+  if (end_stream) {
+    onPoolRemoteEnd();
+  }
+}
+
+void SharedStream::decodeTrailers(ResponseTrailerMapPtr&& trailers) {
+  auto holder = std::make_shared<ResponseTrailerMapPtr>(std::move(trailers));
+  postToWorker([holder](SharedStream& stream) {
+    stream.response_decoder_.decodeTrailers(std::move(*holder));
+    stream.onWorkerRemoteEnd();
+  });
+  onPoolRemoteEnd();
+}
+
+void SharedStream::decodeMetadata(MetadataMapPtr&& metadata_map) {
+  auto holder = std::make_shared<MetadataMapPtr>(std::move(metadata_map));
+  postToWorker([holder](SharedStream& stream) {
+    stream.response_decoder_.decodeMetadata(std::move(*holder));
+  });
+}
+
+void SharedStream::dumpState(std::ostream& os, int indent_level) const {
+  const char* spaces = spacesForLevel(indent_level);
+  os << spaces << "SharedStream " << this << DUMP_MEMBER(pool_local_end_)
+     << DUMP_MEMBER(pool_remote_end_) << "\n";
+}
+
+void SharedStream::onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                                 absl::string_view transport_failure_reason,
+                                 Upstream::HostDescriptionConstSharedPtr host) {
+  pool_handle_ = nullptr;
+  onPoolDone();
+  postToWorker([reason, transport_failure_reason = std::string(transport_failure_reason),
+                host](SharedStream& stream) {
+    ConnectionPool::Callbacks* callbacks = stream.callbacks_;
+    stream.callbacks_ = nullptr;
+    callbacks->onPoolFailure(reason, transport_failure_reason, host);
+    stream.onWorkerDone();
+  });
+}
+
+void SharedStream::onPoolReady(RequestEncoder& encoder,
+                               Upstream::HostDescriptionConstSharedPtr host,
+                               const StreamInfo::StreamInfo& info,
+                               absl::optional<Http::Protocol> protocol) {
+  pool_handle_ = nullptr;
+  pool_encoder_ = &encoder;
+  encoder.getStream().addCallbacks(*this);
+  postToWorker([host, local_address = encoder.getStream().connectionLocalAddress(),
+                remote_address = info.downstreamAddressProvider().remoteAddress(),
+                buffer_limit = encoder.getStream().bufferLimit(),
+                protocol](SharedStream& stream) {
+    stream.onWorkerPoolReady(host, local_address, remote_address, buffer_limit, protocol);
+  });
+}
+
+void SharedStream::onResetStream(StreamResetReason reason, absl::string_view) {
+  // The stream is gone, so there are no callbacks to remove.
+  pool_encoder_ = nullptr;
+  onPoolDone();
+  postToWorker([reason](SharedStream& stream) {
+    stream.runResetCallbacks(reason);
+    stream.onWorkerDone();
+  });
+}
+
+void SharedStream::onAboveWriteBufferHighWatermark() {
+  postToWorker([](SharedStream& stream) { stream.runHighWatermarkCallbacks(); });
+}
+
+void SharedStream::onBelowWriteBufferLowWatermark() {
+  postToWorker([](SharedStream& stream) { stream.runLowWatermarkCallbacks(); });
+}
+
+SharedConnPoolImpl::SharedConnPoolImpl(
+    Event::Dispatcher& dispatcher, SharedConnPoolThreadSharedPtr thread,
+    Upstream::HostConstSharedPtr host, Upstream::ResourcePriority priority,
+    const Network::ConnectionSocket::OptionsSharedPtr& options,
+    const Network::TransportSocketOptionsSharedPtr& transport_socket_options)
+    : dispatcher_(dispatcher),
+      attachment_(std::make_shared<SharedConnPoolAttachment>(dispatcher, std::move(thread), host)),
+      key_(poolKey(host, priority, options, transport_socket_options)) {
+  attachment_->postToPool([attachment = attachment_, key = key_, host, priority, options,
+                           transport_socket_options]() {
+    attachment->pool_ =
+        &attachment->thread().attach(key, host, priority, options, transport_socket_options);
+  });
+}
+
+SharedConnPoolImpl::~SharedConnPoolImpl() {
+  for (auto& stream : streams_) {
+    stream.second->onParentDestroyed();
+  }
+  streams_.clear();
+  attachment_->detachWorker();
+  attachment_->postToPool([attachment = attachment_, key = key_]() {
+    attachment->pool_ = nullptr;
+    attachment->thread().detach(key);
+  });
+}
+
+void SharedConnPoolImpl::addDrainedCallback(DrainedCb cb) {
+  drained_callbacks_.push_back(std::move(cb));
+  checkForDrained();
+}
+
+void SharedConnPoolImpl::drainConnections() {
+  // The connections are shared, so this drains them for all workers, as when a host fails its
+  // health check.
+  attachment_->postToPool([attachment = attachment_]() {
+    if (attachment->pool_ != nullptr) {
+      attachment->pool_->pool_->drainConnections();
+    }
+  });
+}
+
+ConnectionPool::Cancellable* SharedConnPoolImpl::newStream(ResponseDecoder& response_decoder,
+                                                          ConnectionPool::Callbacks& callbacks) {
+  auto stream = std::make_shared<SharedStream>(*this, attachment_, response_decoder, callbacks);
+  attachment_->stats().rq_total_.inc();
+  streams_.emplace(stream.get(), stream);
+  stream->start();
+  return stream.get();
+}
+
+bool SharedConnPoolImpl::maybePreconnect(float preconnect_ratio) {
+  attachment_->postToPool([attachment = attachment_, preconnect_ratio]() {
+    if (attachment->pool_ != nullptr) {
+      attachment->pool_->pool_->maybePreconnect(preconnect_ratio);
+    }
+  });
+  // Whether a connection is created isn't known until the thread handles the request.
+  return false;
+}
+
+void SharedConnPoolImpl::onStreamDone(SharedStream& stream) {
+  auto it = streams_.find(&stream);
+  ASSERT(it != streams_.end());
+  dispatcher_.deferredDelete(std::make_unique<DeferredStreamRelease>(std::move(it->second)));
+  streams_.erase(it);
+  checkForDrained();
+}
+
+void SharedConnPoolImpl::checkForDrained() {
+  if (!streams_.empty()) {
+    return;
+  }
+  for (const DrainedCb& cb : drained_callbacks_) {
+    cb();
+  }
+}
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,342 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+#include "envoy/api/api.h"
+#include "envoy/common/random_generator.h"
+#include "envoy/event/deferred_deletable.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/http/codec.h"
+#include "envoy/http/conn_pool.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/stream_info/stream_info.h"
+#include "envoy/thread/thread.h"
+#include "envoy/thread_local/thread_local.h"
+#include "envoy/upstream/cluster_manager.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/common/logger.h"
+#include "common/common/thread.h"
+#include "common/http/codec_helper.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+
+/**
+ * All stats of the shared HTTP/2 connection pools of a cluster. @see stats_macros.h
+ */
+#define ALL_SHARED_CONN_POOL_STATS(COUNTER)                                                        \
+  COUNTER(cross_thread_hops)                                                                       \
+  COUNTER(rq_total)
+
+/**
+ * Struct definition for the stats of the shared HTTP/2 connection pools. @see stats_macros.h
+ */
+struct SharedConnPoolStats {
+  ALL_SHARED_CONN_POOL_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Runs the HTTP/2 connection pools shared by all workers on a dedicated thread. There is one pool
+ * per host, priority and set of socket options, which lives as long as a worker uses it. The
+ * thread is registered for thread local storage like a worker, so that the pools can use thread
+ * local stats and runtime.
+ */
+class SharedConnPoolThread : Logger::Loggable<Logger::Id::pool> {
+public:
+  using PoolFactory = std::function<ConnectionPool::InstancePtr(
+      Event::Dispatcher& dispatcher, Upstream::HostConstSharedPtr host,
+      Upstream::ResourcePriority priority,
+      const Network::ConnectionSocket::OptionsSharedPtr& options,
+      const Network::TransportSocketOptionsSharedPtr& transport_socket_options,
+      Upstream::ClusterConnectivityState& state)>;
+
+  // Connections to the same host with the same priority and socket options are shared.
+  using PoolKey = std::tuple<const Upstream::HostDescription*, Upstream::ResourcePriority,
+                             std::vector<uint8_t>>;
+
+  // A pool run by the thread.
+  struct SharedPool : public Event::DeferredDeletable {
+    // The connectivity state of the cluster is per worker and not thread safe, so the shared pool
+    // keeps its own: the preconnect and pending stream accounting of a worker doesn't include the
+    // streams it hands to the shared pool. Circuit breakers, which are atomic, still apply.
+    Upstream::ClusterConnectivityState state_;
+    ConnectionPool::InstancePtr pool_;
+    // The number of worker pools using the pool.
+    uint32_t users_{};
+  };
+
+  /**
+   * @param api supplies the API used to create the thread and its dispatcher.
+   * @param tls supplies the thread local storage the thread registers with. The thread must thus
+   *        be created on the main thread, before any thread local slot is set.
+   * @param pool_factory supplies the factory of the pools run by the thread.
+   */
+  SharedConnPoolThread(Api::Api& api, ThreadLocal::Instance& tls, PoolFactory pool_factory);
+  ~SharedConnPoolThread();
+
+  /**
+   * @return the dispatcher of the thread, on which the shared pools run.
+   */
+  Event::Dispatcher& dispatcher() { return *dispatcher_; }
+
+  /**
+   * Runs a callback on the thread. The callback is dropped if the thread was shut down.
+   */
+  void post(Event::PostCb callback);
+
+  /**
+   * Destroys the shared pools and stops the thread, after running the callbacks posted so far.
+   * The owner of the thread must call this, as the last reference to the thread may otherwise be
+   * released by a stream on the thread itself, which can't join itself. Thread local storage must
+   * be shut down globally first, as the thread releases its thread local data before exiting.
+   */
+  void shutdown();
+
+  /**
+   * Adds a user to the pool of a key, creating it if there is none. Must be called on the thread.
+   */
+  SharedPool& attach(const PoolKey& key, Upstream::HostConstSharedPtr host,
+                     Upstream::ResourcePriority priority,
+                     const Network::ConnectionSocket::OptionsSharedPtr& options,
+                     const Network::TransportSocketOptionsSharedPtr& transport_socket_options);
+
+  /**
+   * Removes a user from the pool of a key. The pool is drained and destroyed once it has no users
+   * left. Must be called on the thread.
+   */
+  void detach(const PoolKey& key);
+
+private:
+  void threadRoutine();
+
+  ThreadLocal::Instance& tls_;
+  PoolFactory pool_factory_;
+  Event::DispatcherPtr dispatcher_;
+  Thread::ThreadPtr thread_;
+  absl::Mutex mutex_;
+  bool shut_down_ ABSL_GUARDED_BY(mutex_){};
+  // Accessed on the thread only.
+  absl::flat_hash_map<PoolKey, std::unique_ptr<SharedPool>> pools_;
+  absl::flat_hash_map<SharedPool*, std::unique_ptr<SharedPool>> draining_pools_;
+};
+
+using SharedConnPoolThreadSharedPtr = std::shared_ptr<SharedConnPoolThread>;
+
+class SharedConnPoolImpl;
+
+/**
+ * The link between the pool of a worker and the shared pool it hands its streams to.
+ */
+class SharedConnPoolAttachment {
+public:
+  SharedConnPoolAttachment(Event::Dispatcher& worker_dispatcher,
+                           SharedConnPoolThreadSharedPtr thread,
+                           Upstream::HostConstSharedPtr host);
+
+  /**
+   * Runs a callback on the shared pool's thread.
+   */
+  void postToPool(Event::PostCb callback);
+
+  /**
+   * Runs a callback on the worker, unless the worker's pool was destroyed.
+   */
+  void postToWorker(Event::PostCb callback);
+
+  /**
+   * Stops callbacks from being posted to the worker. Called when the worker's pool is destroyed.
+   */
+  void detachWorker();
+
+  SharedConnPoolThread& thread() { return *thread_; }
+  const Upstream::HostConstSharedPtr& host() const { return host_; }
+  SharedConnPoolStats& stats() { return stats_; }
+
+  // The shared pool, which is only accessed on its thread.
+  SharedConnPoolThread::SharedPool* pool_{};
+
+private:
+  Event::Dispatcher& worker_dispatcher_;
+  const SharedConnPoolThreadSharedPtr thread_;
+  // Keeps the cluster, and so its stats, alive while callbacks are posted.
+  const Upstream::HostConstSharedPtr host_;
+  SharedConnPoolStats stats_;
+  absl::Mutex mutex_;
+  bool worker_detached_ ABSL_GUARDED_BY(mutex_){};
+};
+
+using SharedConnPoolAttachmentSharedPtr = std::shared_ptr<SharedConnPoolAttachment>;
+
+/**
+ * A stream of a worker which runs on a shared connection. The worker side implements the request
+ * encoder and stream handed to the worker's pool callbacks, the thread side is the response
+ * decoder and callbacks of a stream of the shared pool. Each side only runs on its own thread,
+ * and events are passed between them by posting to the other thread.
+ */
+class SharedStream : public RequestEncoder,
+                     public Stream,
+                     public StreamCallbackHelper,
+                     public ConnectionPool::Cancellable,
+                     public ResponseDecoder,
+                     public ConnectionPool::Callbacks,
+                     public StreamCallbacks,
+                     public std::enable_shared_from_this<SharedStream> {
+public:
+  SharedStream(SharedConnPoolImpl& parent, SharedConnPoolAttachmentSharedPtr attachment,
+               ResponseDecoder& response_decoder, ConnectionPool::Callbacks& callbacks);
+
+  /**
+   * Hands the stream to the shared pool. Called on the worker.
+   */
+  void start();
+
+  /**
+   * Called on the worker when its pool is destroyed with the stream still active.
+   */
+  void onParentDestroyed();
+
+  // Http::StreamEncoder
+  void encodeData(Buffer::Instance& data, bool end_stream) override;
+  Stream& getStream() override { return *this; }
+  void encodeMetadata(const MetadataMapVector& metadata_map_vector) override;
+  Http1StreamEncoderOptionsOptRef http1StreamEncoderOptions() override { return absl::nullopt; }
+
+  // Http::RequestEncoder
+  Status encodeHeaders(const RequestHeaderMap& headers, bool end_stream) override;
+  void encodeTrailers(const RequestTrailerMap& trailers) override;
+  void enableTcpTunneling() override;
+
+  // Http::Stream
+  void addCallbacks(StreamCallbacks& callbacks) override { addCallbacksHelper(callbacks); }
+  void removeCallbacks(StreamCallbacks& callbacks) override { removeCallbacksHelper(callbacks); }
+  void resetStream(StreamResetReason reason) override;
+  void readDisable(bool disable) override;
+  uint32_t bufferLimit() override { return buffer_limit_; }
+  const Network::Address::InstanceConstSharedPtr& connectionLocalAddress() override {
+    return local_address_;
+  }
+  void setFlushTimeout(std::chrono::milliseconds timeout) override;
+
+  // ConnectionPool::Cancellable
+  void cancel(Envoy::ConnectionPool::CancelPolicy cancel_policy) override;
+
+  // Http::StreamDecoder
+  void decodeData(Buffer::Instance& data, bool end_stream) override;
+  void decodeMetadata(MetadataMapPtr&& metadata_map) override;
+
+  // Http::ResponseDecoder
+  void decode100ContinueHeaders(ResponseHeaderMapPtr&& headers) override;
+  void decodeHeaders(ResponseHeaderMapPtr&& headers, bool end_stream) override;
+  void decodeTrailers(ResponseTrailerMapPtr&& trailers) override;
+  void dumpState(std::ostream& os, int indent_level) const override;
+
+  // ConnectionPool::Callbacks
+  void onPoolFailure(ConnectionPool::PoolFailureReason reason,
+                     absl::string_view transport_failure_reason,
+                     Upstream::HostDescriptionConstSharedPtr host) override;
+  void onPoolReady(RequestEncoder& encoder, Upstream::HostDescriptionConstSharedPtr host,
+                   const StreamInfo::StreamInfo& info,
+                   absl::optional<Http::Protocol> protocol) override;
+
+  // Http::StreamCallbacks
+  void onResetStream(StreamResetReason reason,
+                     absl::string_view transport_failure_reason) override;
+  void onAboveWriteBufferHighWatermark() override;
+  void onBelowWriteBufferLowWatermark() override;
+
+private:
+  // Worker side.
+  void postToPool(std::function<void(SharedStream&)> callback);
+  void onWorkerPoolReady(Upstream::HostDescriptionConstSharedPtr host,
+                         const Network::Address::InstanceConstSharedPtr& local_address,
+                         const Network::Address::InstanceConstSharedPtr& remote_address,
+                         uint32_t buffer_limit, absl::optional<Http::Protocol> protocol);
+  void onWorkerLocalEnd();
+  void onWorkerRemoteEnd();
+  void onWorkerDone();
+
+  // Thread side.
+  void postToWorker(std::function<void(SharedStream&)> callback);
+  void onPoolStart();
+  void onPoolReset(StreamResetReason reason, Envoy::ConnectionPool::CancelPolicy cancel_policy);
+  void onPoolLocalEnd();
+  void onPoolRemoteEnd();
+  void onPoolDone();
+
+  const SharedConnPoolAttachmentSharedPtr attachment_;
+
+  // Worker side, cleared once the worker's pool is destroyed.
+  SharedConnPoolImpl* parent_;
+  ResponseDecoder& response_decoder_;
+  // Set until the stream is ready or failed.
+  ConnectionPool::Callbacks* callbacks_;
+  std::unique_ptr<StreamInfo::StreamInfo> stream_info_;
+  Network::Address::InstanceConstSharedPtr local_address_;
+  uint32_t buffer_limit_{};
+  bool worker_remote_end_{};
+  // Set once the worker no longer uses the stream, after which no worker callbacks run.
+  bool worker_done_{};
+
+  // Thread side.
+  RequestEncoder* pool_encoder_{};
+  ConnectionPool::Cancellable* pool_handle_{};
+  // Keeps the stream alive while the shared pool refers to it.
+  std::shared_ptr<SharedStream> pool_self_;
+  bool pool_local_end_{};
+  bool pool_remote_end_{};
+};
+
+using SharedStreamSharedPtr = std::shared_ptr<SharedStream>;
+
+/**
+ * The HTTP/2 connection pool of a worker for a cluster with shared connections. It doesn't own any
+ * connection, but hands its streams to the pool shared by all workers for the same host.
+ */
+class SharedConnPoolImpl : public ConnectionPool::Instance {
+public:
+  SharedConnPoolImpl(Event::Dispatcher& dispatcher, SharedConnPoolThreadSharedPtr thread,
+                     Upstream::HostConstSharedPtr host, Upstream::ResourcePriority priority,
+                     const Network::ConnectionSocket::OptionsSharedPtr& options,
+                     const Network::TransportSocketOptionsSharedPtr& transport_socket_options);
+  ~SharedConnPoolImpl() override;
+
+  // ConnectionPool::Instance
+  void addDrainedCallback(DrainedCb cb) override;
+  void drainConnections() override;
+  bool hasActiveConnections() const override { return !streams_.empty(); }
+  Upstream::HostDescriptionConstSharedPtr host() const override { return attachment_->host(); }
+  ConnectionPool::Cancellable* newStream(ResponseDecoder& response_decoder,
+                                         ConnectionPool::Callbacks& callbacks) override;
+  bool maybePreconnect(float preconnect_ratio) override;
+
+  /**
+   * Called by a stream once the worker no longer uses it.
+   */
+  void onStreamDone(SharedStream& stream);
+
+  Event::Dispatcher& dispatcher() { return dispatcher_; }
+
+private:
+  void checkForDrained();
+
+  Event::Dispatcher& dispatcher_;
+  const SharedConnPoolAttachmentSharedPtr attachment_;
+  const SharedConnPoolThread::PoolKey key_;
+  absl::flat_hash_map<SharedStream*, SharedStreamSharedPtr> streams_;
+  std::list<DrainedCb> drained_callbacks_;
+};
+
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
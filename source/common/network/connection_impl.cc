@@ -18,6 +18,7 @@
 #include "common/common/enum_to_int.h"
 #include "common/common/scope_tracker.h"
 #include "common/network/address_impl.h"
+#include "common/network/io_socket_handle_impl.h"
 #include "common/network/listen_socket_impl.h"
 #include "common/network/raw_buffer_socket.h"
 #include "common/network/utility.h"
@@ -80,7 +81,7 @@ ConnectionImpl::ConnectionImpl(Event::Dispatcher& dispatcher, ConnectionSocketPt
       write_buffer_above_high_watermark_(false), detect_early_close_(true),
       enable_half_close_(false), read_end_stream_raised_(false), read_end_stream_(false),
       write_end_stream_(false), current_write_end_stream_(false), dispatch_buffered_data_(false),
-      transport_wants_read_(false) {
+      transport_wants_read_(false), splice_read_blocked_(false) {
 
   if (!connected) {
     connecting_ = true;
@@ -129,12 +130,12 @@ void ConnectionImpl::close(ConnectionCloseType type) {
     return;
   }
 
-  uint64_t data_to_write = write_buffer_->length();
+  uint64_t data_to_write = pendingWriteBytes();
   ENVOY_CONN_LOG(debug, "closing data_to_write={} type={}", *this, data_to_write, enumToInt(type));
   const bool delayed_close_timeout_set = delayed_close_timeout_.count() > 0;
   if (data_to_write == 0 || type == ConnectionCloseType::NoFlush ||
       !transport_socket_->canFlushClose()) {
-    if (data_to_write > 0) {
+    if (write_buffer_->length() > 0) {
       // We aren't going to wait to flush, but try to write as much as we can if there is pending
       // data.
       transport_socket_->doWrite(*write_buffer_, true);
@@ -253,6 +254,13 @@ void ConnectionImpl::closeSocket(ConnectionEvent close_type) {
   // connection outlasting the subscriber.
   write_buffer_->drain(write_buffer_->length());
 
+  // Stop splicing. The peer keeps its write pipe, so that it can still write the data in it.
+  if (splice_peer_ != nullptr) {
+    splice_peer_->splice_peer_ = nullptr;
+    splice_peer_ = nullptr;
+  }
+  write_pipe_.reset();
+
   connection_stats_.reset();
 
   socket_->close();
@@ -608,7 +616,8 @@ void ConnectionImpl::onReadReady() {
   // reading from the transport if the read buffer is above high watermark at the start of the
   // method.
   transport_wants_read_ = false;
-  IoResult result = transport_socket_->doRead(*read_buffer_);
+  IoResult result =
+      splice_peer_ != nullptr ? doSpliceRead() : transport_socket_->doRead(*read_buffer_);
   uint64_t new_buffer_size = read_buffer_->length();
   updateReadBufferStats(result.bytes_processed_, new_buffer_size);
 
@@ -677,9 +686,11 @@ void ConnectionImpl::onWriteReady() {
     }
   }
 
-  IoResult result = transport_socket_->doWrite(*write_buffer_, write_end_stream_);
+  IoResult result = write_pipe_ != nullptr
+                        ? doSpliceWrite()
+                        : transport_socket_->doWrite(*write_buffer_, write_end_stream_);
   ASSERT(!result.end_stream_read_); // The interface guarantees that only read operations set this.
-  uint64_t new_buffer_size = write_buffer_->length();
+  uint64_t new_buffer_size = pendingWriteBytes();
   updateWriteBufferStats(result.bytes_processed_, new_buffer_size);
 
   // NOTE: If the delayed_close_timer_ is set, it must only trigger after a delayed_close_timeout_
@@ -750,7 +761,117 @@ void ConnectionImpl::updateWriteBufferStats(uint64_t num_written, uint64_t new_s
 
 bool ConnectionImpl::bothSidesHalfClosed() {
   // If the write_buffer_ is not empty, then the end_stream has not been sent to the transport yet.
-  return read_end_stream_ && write_end_stream_ && write_buffer_->length() == 0;
+  return read_end_stream_ && write_end_stream_ && pendingWriteBytes() == 0;
+}
+
+bool ConnectionImpl::startSplice(Connection& peer) {
+  auto* peer_impl = dynamic_cast<ConnectionImpl*>(&peer);
+  if (peer_impl == nullptr || peer_impl == this || !canSplice() || !peer_impl->canSplice()) {
+    return false;
+  }
+
+  // A write pipe is bounded by the same limit as the write buffer, so that a slow reader applies
+  // back pressure to the peer as soon as it would with buffered data.
+  SplicePipePtr write_pipe = SplicePipe::create(bufferLimit());
+  SplicePipePtr peer_write_pipe = SplicePipe::create(peer_impl->bufferLimit());
+  if (write_pipe == nullptr || peer_write_pipe == nullptr) {
+    return false;
+  }
+
+  ENVOY_CONN_LOG(debug, "splicing with connection {}", *this, peer.id());
+  write_pipe_ = std::move(write_pipe);
+  splice_peer_ = peer_impl;
+  peer_impl->write_pipe_ = std::move(peer_write_pipe);
+  peer_impl->splice_peer_ = this;
+  return true;
+}
+
+bool ConnectionImpl::canSplice() const {
+  // The data must not need processing by the transport socket, and splice() needs an OS socket.
+  // Data already read must be consumed first, or it would be overtaken by the spliced data.
+  return state() == State::Open && !connecting_ && write_pipe_ == nullptr &&
+         dynamic_cast<const RawBufferSocket*>(transport_socket_.get()) != nullptr &&
+         dynamic_cast<const IoSocketHandleImpl*>(&ioHandle()) != nullptr &&
+         read_buffer_->length() == 0 && !read_end_stream_ && !write_end_stream_;
+}
+
+IoResult ConnectionImpl::doSpliceRead() {
+  SplicePipe& pipe = *splice_peer_->write_pipe_;
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  while (true) {
+    if (pipe.full()) {
+      // Not reading applies back pressure to the sender, like a read disable would.
+      splice_read_blocked_ = true;
+      break;
+    }
+    // The IoHandle was checked to be an IoSocketHandleImpl, so this is an OS socket.
+    const Api::SysCallSizeResult result = pipe.fill(ioHandle().fdDoNotUse());
+    if (result.rc_ > 0) {
+      bytes_read += result.rc_;
+      continue;
+    }
+    if (result.rc_ == 0) {
+      // Remote close.
+      end_stream = true;
+    } else if (result.errno_ == SOCKET_ERROR_AGAIN) {
+      // The pipe holds a limited number of buffers, so small reads can fill it before full() does.
+      // The socket may then still have data, so reading resumes once the peer drains the pipe.
+      splice_read_blocked_ = pipe.length() > 0;
+    } else {
+      ENVOY_CONN_LOG(trace, "splice read error: {}", *this, errorDetails(result.errno_));
+      action = PostIoAction::Close;
+    }
+    break;
+  }
+
+  if (bytes_read > 0) {
+    ENVOY_CONN_LOG(trace, "spliced {} bytes to connection {}", *this, bytes_read,
+                   splice_peer_->id());
+    stream_info_.addBytesReceived(bytes_read);
+    splice_peer_->ioHandle().activateFileEvents(Event::FileReadyType::Write);
+  }
+  return {action, bytes_read, end_stream};
+}
+
+IoResult ConnectionImpl::doSpliceWrite() {
+  // Data written to the connection before splicing started precedes the spliced data, and the end
+  // of stream follows it.
+  IoResult result =
+      transport_socket_->doWrite(*write_buffer_, write_end_stream_ && write_pipe_->length() == 0);
+  if (result.action_ == PostIoAction::Close || write_buffer_->length() > 0 ||
+      write_pipe_->length() == 0) {
+    return result;
+  }
+
+  uint64_t bytes_written = 0;
+  do {
+    const Api::SysCallSizeResult splice_result = write_pipe_->drain(ioHandle().fdDoNotUse());
+    if (splice_result.rc_ <= 0) {
+      if (splice_result.rc_ < 0 && splice_result.errno_ != SOCKET_ERROR_AGAIN) {
+        ENVOY_CONN_LOG(trace, "splice write error: {}", *this, errorDetails(splice_result.errno_));
+        result.action_ = PostIoAction::Close;
+      }
+      break;
+    }
+    bytes_written += splice_result.rc_;
+  } while (write_pipe_->length() > 0);
+
+  if (bytes_written > 0) {
+    ENVOY_CONN_LOG(trace, "wrote {} spliced bytes", *this, bytes_written);
+    stream_info_.addBytesSent(bytes_written);
+    result.bytes_processed_ += bytes_written;
+    if (splice_peer_ != nullptr && splice_peer_->splice_read_blocked_) {
+      splice_peer_->splice_read_blocked_ = false;
+      splice_peer_->setTransportSocketIsReadable();
+    }
+  }
+  if (result.action_ == PostIoAction::KeepOpen && write_end_stream_ &&
+      write_pipe_->length() == 0) {
+    result.action_ = transport_socket_->doWrite(*write_buffer_, true).action_;
+  }
+  return result;
 }
 
 absl::string_view ConnectionImpl::transportFailureReason() const {
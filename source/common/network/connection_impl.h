@@ -12,6 +12,7 @@
 #include "common/buffer/watermark_buffer.h"
 #include "common/event/libevent.h"
 #include "common/network/connection_impl_base.h"
+#include "common/network/splice_pipe.h"
 #include "common/stream_info/stream_info_impl.h"
 
 #include "absl/types/optional.h"
@@ -95,6 +96,7 @@ public:
   absl::string_view transportFailureReason() const override;
   bool startSecureTransport() override { return transport_socket_->startSecureTransport(); }
   absl::optional<std::chrono::milliseconds> lastRoundTripTime() const override;
+  bool startSplice(Connection& peer) override;
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -185,6 +187,17 @@ private:
   // Returns true iff end of stream has been both written and read.
   bool bothSidesHalfClosed();
 
+  // Returns true if data can be spliced to and from this connection.
+  bool canSplice() const;
+  // Splices data from the socket to the peer's write pipe.
+  IoResult doSpliceRead();
+  // Writes the write buffer, then the write pipe, to the socket.
+  IoResult doSpliceWrite();
+  // The number of bytes written to the connection but not yet to the socket.
+  uint64_t pendingWriteBytes() const {
+    return write_buffer_->length() + (write_pipe_ != nullptr ? write_pipe_->length() : 0);
+  }
+
   static std::atomic<uint64_t> next_global_id_;
 
   std::list<BytesSentCb> bytes_sent_callbacks_;
@@ -194,6 +207,11 @@ private:
   uint64_t last_read_buffer_size_{};
   uint64_t last_write_buffer_size_{};
   Buffer::Instance* current_write_buffer_{};
+  // Set while splicing: the connection the data read from this one is spliced to, and vice versa.
+  ConnectionImpl* splice_peer_{};
+  // Data spliced from the peer, to be written after write_buffer_. Outlives the splice_peer_, so
+  // that the data is still written once the peer is closed.
+  SplicePipePtr write_pipe_;
   uint32_t read_disable_count_{0};
   bool write_buffer_above_high_watermark_ : 1;
   bool detect_early_close_ : 1;
@@ -209,6 +227,9 @@ private:
   // read_disable_count_ == 0 to ensure that read resumption happens when remaining bytes are held
   // in transport socket internal buffers.
   bool transport_wants_read_ : 1;
+  // True if reading stopped because the peer's write pipe was full. The peer resumes reading once
+  // it has written some of the data.
+  bool splice_read_blocked_ : 1;
 };
 
 class ServerConnectionImpl : public ConnectionImpl, virtual public ServerConnection {
@@ -0,0 +1,164 @@
+#include "common/network/dns_resolver_cache_impl.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "common/common/assert.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Network {
+
+DnsResolverCacheImpl::DnsResolverCacheImpl(
+    DnsResolverSharedPtr resolver, Event::Dispatcher& dispatcher, Stats::Scope& scope,
+    const envoy::config::bootstrap::v3::DnsResolverCache& config)
+    : resolver_(std::move(resolver)), dispatcher_(dispatcher), stats_(generateStats(scope)),
+      max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 1024)),
+      max_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, max_ttl, 300000)),
+      negative_ttl_(PROTOBUF_GET_MS_OR_DEFAULT(config, negative_ttl, 5000)),
+      prefetch_(config.prefetch()) {}
+
+DnsResolverCacheImpl::~DnsResolverCacheImpl() {
+  for (auto& resolution : resolutions_) {
+    if (resolution.second.query_ != nullptr) {
+      resolution.second.query_->cancel();
+    }
+  }
+  stats_.entries_.sub(entries_.size());
+}
+
+DnsResolverCacheStats DnsResolverCacheImpl::generateStats(Stats::Scope& scope) {
+  return {ALL_DNS_RESOLVER_CACHE_STATS(POOL_COUNTER_PREFIX(scope, "dns_resolver_cache"),
+                                       POOL_GAUGE_PREFIX(scope, "dns_resolver_cache"))};
+}
+
+ActiveDnsQuery* DnsResolverCacheImpl::resolve(const std::string& dns_name,
+                                              DnsLookupFamily dns_lookup_family,
+                                              ResolveCb callback) {
+  const Key key{dns_name, dns_lookup_family};
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    const Entry& entry = *it->second;
+    if (now < entry.expiry_) {
+      entries_.splice(entries_.begin(), entries_, it->second);
+      const ResolutionStatus status = entry.status_;
+      std::list<DnsResponse> responses = responsesWithTtl(entry, now);
+      if (responses.empty()) {
+        stats_.negative_hit_.inc();
+      } else {
+        stats_.hit_.inc();
+      }
+      if (prefetch_ && !responses.empty() && now >= entry.prefetch_time_ &&
+          !resolutions_.contains(key)) {
+        ENVOY_LOG(debug, "prefetching DNS resolution of {}", dns_name);
+        stats_.prefetch_.inc();
+        startResolution(key);
+      }
+      callback(status, std::move(responses));
+      return nullptr;
+    }
+    erase(it->second);
+  }
+
+  stats_.miss_.inc();
+  auto resolution = resolutions_.find(key);
+  if (resolution != resolutions_.end()) {
+    stats_.coalesced_.inc();
+    resolution->second.waiters_.push_back(std::make_unique<Waiter>(callback));
+    return resolution->second.waiters_.back().get();
+  }
+
+  std::list<WaiterPtr>& waiters = resolutions_[key].waiters_;
+  waiters.push_back(std::make_unique<Waiter>(callback));
+  Waiter* waiter = waiters.back().get();
+  // The waiter was called back and destroyed if the name was resolved synchronously.
+  return startResolution(key) != nullptr ? waiter : nullptr;
+}
+
+ActiveDnsQuery* DnsResolverCacheImpl::startResolution(const Key& key) {
+  // Adds the resolution if no caller waits for it, as when prefetching.
+  resolutions_[key];
+  ActiveDnsQuery* query = resolver_->resolve(
+      key.first, key.second,
+      [this, key](ResolutionStatus status, std::list<DnsResponse>&& responses) -> void {
+        onResolution(key, status, std::move(responses));
+      });
+  if (query != nullptr) {
+    resolutions_[key].query_ = query;
+  }
+  return query;
+}
+
+void DnsResolverCacheImpl::onResolution(const Key& key, ResolutionStatus status,
+                                        std::list<DnsResponse>&& responses) {
+  auto it = resolutions_.find(key);
+  ASSERT(it != resolutions_.end());
+  std::list<WaiterPtr> waiters = std::move(it->second.waiters_);
+  resolutions_.erase(it);
+
+  cache(key, status, responses);
+  for (const WaiterPtr& waiter : waiters) {
+    if (!waiter->cancelled_) {
+      waiter->callback_(status, std::list<DnsResponse>(responses));
+    }
+  }
+}
+
+void DnsResolverCacheImpl::cache(const Key& key, ResolutionStatus status,
+                                 const std::list<DnsResponse>& responses) {
+  const MonotonicTime now = dispatcher_.timeSource().monotonicTime();
+  const bool positive = status == ResolutionStatus::Success && !responses.empty();
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    const Entry& entry = *it->second;
+    // A failed prefetch doesn't drop the addresses still cached.
+    if (!positive && !entry.responses_.empty() && now < entry.expiry_) {
+      return;
+    }
+    erase(it->second);
+  }
+
+  std::chrono::milliseconds ttl = negative_ttl_;
+  if (positive) {
+    ttl = max_ttl_;
+    for (const DnsResponse& response : responses) {
+      ttl = std::min<std::chrono::milliseconds>(ttl, response.ttl_);
+    }
+  }
+  if (ttl.count() <= 0) {
+    return;
+  }
+
+  entries_.push_front({key, status, responses, now + ttl, now + ttl - ttl / 10});
+  index_.emplace(key, entries_.begin());
+  stats_.entries_.inc();
+  if (entries_.size() > max_entries_) {
+    stats_.eviction_.inc();
+    erase(std::prev(entries_.end()));
+  }
+}
+
+void DnsResolverCacheImpl::erase(EntryList::iterator entry) {
+  index_.erase(entry->key_);
+  entries_.erase(entry);
+  stats_.entries_.dec();
+}
+
+std::list<DnsResponse> DnsResolverCacheImpl::responsesWithTtl(const Entry& entry,
+                                                              MonotonicTime now) const {
+  // All the records expire with the entry, which expires with the first of them.
+  const auto ttl = std::chrono::duration_cast<std::chrono::seconds>(entry.expiry_ - now);
+  std::list<DnsResponse> responses;
+  for (const DnsResponse& response : entry.responses_) {
+    responses.emplace_back(response.address_, ttl);
+  }
+  return responses;
+}
+
+} // namespace Network
+} // namespace Envoy
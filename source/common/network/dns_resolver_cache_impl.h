@@ -0,0 +1,117 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "envoy/common/time.h"
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/network/dns.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+
+#include "common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * All DNS resolver cache stats. @see stats_macros.h
+ */
+#define ALL_DNS_RESOLVER_CACHE_STATS(COUNTER, GAUGE)                                               \
+  COUNTER(coalesced)                                                                               \
+  COUNTER(eviction)                                                                                \
+  COUNTER(hit)                                                                                     \
+  COUNTER(miss)                                                                                    \
+  COUNTER(negative_hit)                                                                            \
+  COUNTER(prefetch)                                                                                \
+  GAUGE(entries, NeverImport)
+
+/**
+ * Struct definition for all DNS resolver cache stats. @see stats_macros.h
+ */
+struct DnsResolverCacheStats {
+  ALL_DNS_RESOLVER_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+/**
+ * A DnsResolver caching the responses of another resolver for the TTL of their records, failures
+ * included. Concurrent resolutions of a name are merged into a single resolution, and with
+ * prefetching a name resolved from the cache shortly before it expires is resolved again in the
+ * background. All calls and callbacks are assumed to happen on the thread that owns the
+ * dispatcher, like those of the wrapped resolver.
+ */
+class DnsResolverCacheImpl : public DnsResolver, protected Logger::Loggable<Logger::Id::upstream> {
+public:
+  DnsResolverCacheImpl(DnsResolverSharedPtr resolver, Event::Dispatcher& dispatcher,
+                       Stats::Scope& scope,
+                       const envoy::config::bootstrap::v3::DnsResolverCache& config);
+  ~DnsResolverCacheImpl() override;
+
+  static DnsResolverCacheStats generateStats(Stats::Scope& scope);
+
+  // Network::DnsResolver
+  ActiveDnsQuery* resolve(const std::string& dns_name, DnsLookupFamily dns_lookup_family,
+                          ResolveCb callback) override;
+
+private:
+  using Key = std::pair<std::string, DnsLookupFamily>;
+
+  struct Entry {
+    Key key_;
+    ResolutionStatus status_;
+    std::list<DnsResponse> responses_;
+    MonotonicTime expiry_;
+    // The time after which a hit triggers a prefetch.
+    MonotonicTime prefetch_time_;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  // A caller waiting for an in flight resolution.
+  struct Waiter : public ActiveDnsQuery {
+    Waiter(ResolveCb callback) : callback_(std::move(callback)) {}
+
+    // Network::ActiveDnsQuery
+    void cancel() override { cancelled_ = true; }
+
+    const ResolveCb callback_;
+    bool cancelled_{};
+  };
+
+  using WaiterPtr = std::unique_ptr<Waiter>;
+
+  // A resolution of the wrapped resolver, shared by all the callers resolving the name meanwhile.
+  struct Resolution {
+    ActiveDnsQuery* query_{};
+    std::list<WaiterPtr> waiters_;
+  };
+
+  // @return the query of the wrapped resolver, or nullptr if the name was resolved synchronously.
+  ActiveDnsQuery* startResolution(const Key& key);
+  void onResolution(const Key& key, ResolutionStatus status, std::list<DnsResponse>&& responses);
+  void cache(const Key& key, ResolutionStatus status, const std::list<DnsResponse>& responses);
+  void erase(EntryList::iterator entry);
+  std::list<DnsResponse> responsesWithTtl(const Entry& entry, MonotonicTime now) const;
+
+  const DnsResolverSharedPtr resolver_;
+  Event::Dispatcher& dispatcher_;
+  DnsResolverCacheStats stats_;
+  const uint32_t max_entries_;
+  const std::chrono::milliseconds max_ttl_;
+  const std::chrono::milliseconds negative_ttl_;
+  const bool prefetch_;
+  // Ordered from the most to the least recently used.
+  EntryList entries_;
+  absl::flat_hash_map<Key, EntryList::iterator> index_;
+  absl::flat_hash_map<Key, Resolution> resolutions_;
+};
+
+} // namespace Network
+} // namespace Envoy
@@ -537,7 +537,7 @@ bool IoSocketHandleImpl::supportsMmsg() const {
 }
 
 bool IoSocketHandleImpl::supportsUdpGro() const {
-  return Api::OsSysCallsSingleton::get().supportsUdpGro();
+  return !udp_gro_disabled_ && Api::OsSysCallsSingleton::get().supportsUdpGro();
 }
 
 Api::SysCallIntResult IoSocketHandleImpl::bind(Address::InstanceConstSharedPtr address) {
@@ -563,7 +563,14 @@ Api::SysCallIntResult IoSocketHandleImpl::connect(Address::InstanceConstSharedPt
 
 Api::SysCallIntResult IoSocketHandleImpl::setOption(int level, int optname, const void* optval,
                                                     socklen_t optlen) {
-  return Api::OsSysCallsSingleton::get().setsockopt(fd_, level, optname, optval, optlen);
+  const Api::SysCallIntResult result =
+      Api::OsSysCallsSingleton::get().setsockopt(fd_, level, optname, optval, optlen);
+#ifdef UDP_GRO
+  if (result.rc_ == 0 && level == SOL_UDP && optname == UDP_GRO && optlen == sizeof(int)) {
+    udp_gro_disabled_ = *static_cast<const int*>(optval) == 0;
+  }
+#endif
+  return result;
 }
 
 Api::SysCallIntResult IoSocketHandleImpl::getOption(int level, int optname, void* optval,
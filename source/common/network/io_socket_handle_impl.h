@@ -104,6 +104,9 @@ protected:
   int socket_v6only_{false};
   const absl::optional<int> domain_;
   Event::FileEventPtr file_event_{nullptr};
+  // Set if UDP GRO was explicitly disabled on the socket, in which case reads should not expect
+  // coalesced datagrams even if the platform supports them.
+  bool udp_gro_disabled_{false};
 
   // The minimum cmsg buffer size to filled in destination address, packets dropped and gso
   // size when receiving a packet. It is possible for a received packet to contain both IPv4
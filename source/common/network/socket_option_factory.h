@@ -35,7 +35,7 @@ public:
   static std::unique_ptr<Socket::Options> buildIpPacketInfoOptions();
   static std::unique_ptr<Socket::Options> buildRxQueueOverFlowOptions();
   static std::unique_ptr<Socket::Options> buildReusePortOptions();
-  static std::unique_ptr<Socket::Options> buildUdpGroOptions();
+  static std::unique_ptr<Socket::Options> buildUdpGroOptions(bool enabled);
 };
 } // namespace Network
 } // namespace Envoy
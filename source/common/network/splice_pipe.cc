@@ -0,0 +1,73 @@
+#include "common/network/splice_pipe.h"
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+
+#include "common/api/os_sys_calls_impl_linux.h"
+#endif
+
+namespace Envoy {
+namespace Network {
+
+#if defined(__linux__)
+namespace {
+
+// The capacity of a pipe whose size couldn't be set: 16 pages of at least 4KiB.
+constexpr uint64_t DefaultPipeSize = 64 * 1024;
+
+} // namespace
+
+SplicePipePtr SplicePipe::create(uint32_t size) {
+  auto& os_sys_calls = Api::LinuxOsSysCallsSingleton::get();
+  int fds[2];
+  if (os_sys_calls.pipe2(fds, O_NONBLOCK | O_CLOEXEC).rc_ != 0) {
+    return nullptr;
+  }
+  // The size is rounded up to a power of two number of pages, and may be capped for unprivileged
+  // processes by /proc/sys/fs/pipe-max-size.
+  const Api::SysCallIntResult result =
+      os_sys_calls.setPipeSize(fds[1], size > 0 ? size : DefaultPipeSize);
+  const uint64_t capacity = result.rc_ > 0 ? result.rc_ : DefaultPipeSize;
+  return SplicePipePtr{new SplicePipe(fds[0], fds[1], capacity)};
+}
+
+SplicePipe::~SplicePipe() {
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  os_sys_calls.close(read_fd_);
+  os_sys_calls.close(write_fd_);
+}
+
+Api::SysCallSizeResult SplicePipe::fill(os_fd_t fd) {
+  ASSERT(!full());
+  const Api::SysCallSizeResult result = Api::LinuxOsSysCallsSingleton::get().splice(
+      fd, nullptr, write_fd_, nullptr, capacity_ - length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (result.rc_ > 0) {
+    length_ += result.rc_;
+  }
+  return result;
+}
+
+Api::SysCallSizeResult SplicePipe::drain(os_fd_t fd) {
+  ASSERT(length_ > 0);
+  const Api::SysCallSizeResult result = Api::LinuxOsSysCallsSingleton::get().splice(
+      read_fd_, nullptr, fd, nullptr, length_, SPLICE_F_MOVE | SPLICE_F_NONBLOCK);
+  if (result.rc_ > 0) {
+    length_ -= result.rc_;
+  }
+  return result;
+}
+#else
+SplicePipePtr SplicePipe::create(uint32_t) { return nullptr; }
+
+SplicePipe::~SplicePipe() = default;
+
+Api::SysCallSizeResult SplicePipe::fill(os_fd_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+
+Api::SysCallSizeResult SplicePipe::drain(os_fd_t) { NOT_REACHED_GCOVR_EXCL_LINE; }
+#endif
+
+} // namespace Network
+} // namespace Envoy
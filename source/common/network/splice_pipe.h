@@ -0,0 +1,72 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+
+#include "envoy/api/os_sys_calls_common.h"
+#include "envoy/common/platform.h"
+
+#include "common/common/non_copyable.h"
+
+namespace Envoy {
+namespace Network {
+
+class SplicePipe;
+using SplicePipePtr = std::unique_ptr<SplicePipe>;
+
+/**
+ * A kernel pipe through which data is moved from one socket to another with splice(), without
+ * copying it to user space. Only supported on Linux.
+ */
+class SplicePipe : NonCopyable {
+public:
+  ~SplicePipe();
+
+  /**
+   * @param size supplies the requested capacity of the pipe in bytes, or 0 for the default.
+   * @return SplicePipePtr a new pipe, or nullptr if splicing is not supported on this platform or
+   *         the pipe could not be created.
+   */
+  static SplicePipePtr create(uint32_t size);
+
+  /**
+   * Moves as much data from a socket into the pipe as both allow, without blocking.
+   * @param fd supplies the socket to read from.
+   * @return the number of bytes moved, 0 at the end of the stream, or an error. An error of
+   *         SOCKET_ERROR_AGAIN means that the socket has no data, or that the pipe has no free
+   *         buffer left if it isn't empty.
+   */
+  Api::SysCallSizeResult fill(os_fd_t fd);
+
+  /**
+   * Moves as much data from the pipe into a socket as the socket allows, without blocking.
+   * @param fd supplies the socket to write to.
+   * @return the number of bytes moved, or an error. An error of SOCKET_ERROR_AGAIN means that the
+   *         socket can't take more data.
+   */
+  Api::SysCallSizeResult drain(os_fd_t fd);
+
+  /**
+   * @return uint64_t the number of bytes in the pipe.
+   */
+  uint64_t length() const { return length_; }
+
+  /**
+   * @return bool whether the pipe is at capacity, so that fill() won't move any data. As each read
+   *         takes at least one of the buffers of the pipe, a pipe filled by small reads may not
+   *         take more data before reaching its capacity.
+   */
+  bool full() const { return length_ >= capacity_; }
+
+private:
+  SplicePipe(os_fd_t read_fd, os_fd_t write_fd, uint64_t capacity)
+      : read_fd_(read_fd), write_fd_(write_fd), capacity_(capacity) {}
+
+  const os_fd_t read_fd_;
+  const os_fd_t write_fd_;
+  const uint64_t capacity_;
+  uint64_t length_{};
+};
+
+} // namespace Network
+} // namespace Envoy
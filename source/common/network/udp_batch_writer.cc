@@ -0,0 +1,243 @@
+#include "common/network/udp_batch_writer.h"
+
+#include <cerrno>
+#include <cstring>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/common/utility.h"
+#include "common/network/address_impl.h"
+#include "common/network/io_socket_error_impl.h"
+#include "common/network/udp_packet_writer_handler_impl.h"
+
+namespace Envoy {
+namespace Network {
+
+namespace {
+
+// The kernel limits a GSO message to 64 segments (UDP_MAX_SEGMENTS) and to the maximum size of an
+// IPv4 UDP payload.
+constexpr uint64_t MaxGsoSegments = 64;
+constexpr uint64_t MaxGsoBytes = 65507;
+// Bounds the memory used for buffered datagrams, which can be as large as 64KiB each.
+constexpr uint64_t MaxBufferedBytes = 1024 * 1024;
+
+// Appends a control message with data_size bytes of data to the message, whose msg_control points
+// to a buffer large enough to hold it.
+cmsghdr* appendControlMessage(msghdr& message, size_t data_size) {
+  cmsghdr* cmsg = reinterpret_cast<cmsghdr*>(static_cast<char*>(message.msg_control) +
+                                             message.msg_controllen);
+  message.msg_controllen += CMSG_SPACE(data_size);
+  cmsg->cmsg_len = CMSG_LEN(data_size);
+  return cmsg;
+}
+
+} // namespace
+
+UdpBatchWriter::UdpBatchWriter(IoHandle& io_handle, uint32_t max_buffered_datagrams)
+    : io_handle_(io_handle), max_buffered_datagrams_(max_buffered_datagrams),
+      use_gso_(Api::OsSysCallsSingleton::get().supportsUdpGso()) {
+  ASSERT(max_buffered_datagrams_ > 0);
+}
+
+bool UdpBatchWriter::Datagram::sameAddresses(const Datagram& other) const {
+  return peer_address_length_ == other.peer_address_length_ &&
+         memcmp(&peer_address_, &other.peer_address_, peer_address_length_) == 0 &&
+         local_ip_version_ == other.local_ip_version_ && local_ip_ == other.local_ip_;
+}
+
+Api::IoCallUint64Result UdpBatchWriter::writePacket(const Buffer::Instance& buffer,
+                                                    const Address::Ip* local_ip,
+                                                    const Address::Instance& peer_address) {
+  const auto* address_base = dynamic_cast<const Address::InstanceBase*>(&peer_address);
+  if (address_base == nullptr || address_base->sockAddr() == nullptr) {
+    return IoSocketError::ioResultSocketInvalidAddress();
+  }
+
+  const uint64_t length = buffer.length();
+  if (!datagrams_.empty() && data_.size() + length > MaxBufferedBytes) {
+    flush();
+  }
+
+  Datagram datagram{};
+  datagram.offset_ = data_.size();
+  datagram.length_ = length;
+  ASSERT(address_base->sockAddrLen() <= sizeof(datagram.peer_address_));
+  memcpy(&datagram.peer_address_, address_base->sockAddr(), address_base->sockAddrLen());
+  datagram.peer_address_length_ = address_base->sockAddrLen();
+  if (local_ip != nullptr) {
+    datagram.local_ip_version_ = local_ip->version();
+    datagram.local_ip_ = local_ip->version() == Address::IpVersion::v4
+                             ? local_ip->ipv4()->address()
+                             : local_ip->ipv6()->address();
+  }
+  data_.resize(datagram.offset_ + length);
+  buffer.copyOut(0, length, data_.data() + datagram.offset_);
+  datagrams_.push_back(datagram);
+
+  if (datagrams_.size() >= max_buffered_datagrams_) {
+    Api::IoCallUint64Result result = flush();
+    if (!result.ok()) {
+      return {0, std::move(result.err_)};
+    }
+  }
+  return {length, Api::IoErrorPtr(nullptr, IoSocketError::deleteIoError)};
+}
+
+Api::IoCallUint64Result UdpBatchWriter::flush() {
+  if (datagrams_.empty()) {
+    return Api::ioCallUint64ResultNoError();
+  }
+
+  auto& os_sys_calls = Api::OsSysCallsSingleton::get();
+  uint64_t bytes_sent = 0;
+  Api::IoErrorPtr error(nullptr, IoSocketError::deleteIoError);
+  buildMessages(0);
+  uint64_t next = 0;
+  while (next < messages_.size()) {
+    const Api::SysCallIntResult result = os_sys_calls.sendmmsg(
+        io_handle_.fdDoNotUse(), &messages_[next], messages_.size() - next, 0);
+    if (result.rc_ > 0) {
+      for (uint64_t i = next; i < next + result.rc_; i++) {
+        bytes_sent += messages_[i].msg_len;
+      }
+      next += result.rc_;
+      continue;
+    }
+
+    if (result.errno_ == SOCKET_ERROR_AGAIN) {
+      // The remaining datagrams are dropped rather than kept for a later flush, which may never
+      // come if nothing else is written.
+      ENVOY_LOG(trace, "dropping {} udp messages as the socket is write blocked",
+                messages_.size() - next);
+      write_blocked_ = true;
+      error = Api::IoErrorPtr(IoSocketError::getIoSocketEagainInstance(),
+                              IoSocketError::deleteIoError);
+      break;
+    }
+    if (result.errno_ == EIO && use_gso_ && messages_[next].msg_hdr.msg_iovlen > 1) {
+      ENVOY_LOG(debug, "udp GSO is not supported on the route, sending datagrams individually");
+      use_gso_ = false;
+      buildMessages(message_datagrams_[next]);
+      next = 0;
+      continue;
+    }
+    // Errors such as an oversized datagram or an unreachable peer only affect one message, so the
+    // remaining ones are still sent.
+    ENVOY_LOG(debug, "sendmmsg failed with error {}: {}", result.errno_,
+              errorDetails(result.errno_));
+    error = Api::IoErrorPtr(new IoSocketError(result.errno_), IoSocketError::deleteIoError);
+    next++;
+  }
+
+  data_.clear();
+  datagrams_.clear();
+  return {bytes_sent, std::move(error)};
+}
+
+void UdpBatchWriter::buildMessages(uint64_t first_datagram) {
+  messages_.clear();
+  message_datagrams_.clear();
+  // The messages point into these, so they must not be reallocated while the messages are built.
+  iovecs_.resize(datagrams_.size());
+  control_buffers_.resize(datagrams_.size());
+
+  uint64_t begin = first_datagram;
+  while (begin < datagrams_.size()) {
+    Datagram& datagram = datagrams_[begin];
+    uint64_t end = begin + 1;
+    // Datagrams larger than the path MTU can't be segments, as the kernel rejects a segment size
+    // which would need IP fragmentation. Only the last segment may be shorter than the others.
+    if (use_gso_ && datagram.length_ > 0 && datagram.length_ <= UdpMaxOutgoingPacketSize) {
+      uint64_t bytes = datagram.length_;
+      while (end < datagrams_.size() && end - begin < MaxGsoSegments &&
+             datagrams_[end - 1].length_ == datagram.length_ && datagrams_[end].length_ > 0 &&
+             datagrams_[end].length_ <= datagram.length_ &&
+             bytes + datagrams_[end].length_ <= MaxGsoBytes &&
+             datagrams_[end].sameAddresses(datagram)) {
+        bytes += datagrams_[end].length_;
+        end++;
+      }
+    }
+
+    for (uint64_t i = begin; i < end; i++) {
+      iovecs_[i].iov_base = data_.data() + datagrams_[i].offset_;
+      iovecs_[i].iov_len = datagrams_[i].length_;
+    }
+    msghdr& message = messages_.emplace_back().msg_hdr;
+    message.msg_name = &datagram.peer_address_;
+    message.msg_namelen = datagram.peer_address_length_;
+    message.msg_iov = &iovecs_[begin];
+    message.msg_iovlen = end - begin;
+    ControlBuffer& control_buffer = control_buffers_[messages_.size() - 1];
+    memset(control_buffer.data_, 0, sizeof(control_buffer.data_));
+    message.msg_control = control_buffer.data_;
+    message.msg_controllen = 0;
+    addLocalIpControlMessage(datagram, message);
+    if (end - begin > 1) {
+      addSegmentControlMessage(datagram.length_, message);
+    }
+    if (message.msg_controllen == 0) {
+      message.msg_control = nullptr;
+    }
+    message_datagrams_.push_back(begin);
+    begin = end;
+  }
+}
+
+void UdpBatchWriter::addLocalIpControlMessage(const Datagram& datagram, msghdr& message) {
+  if (!datagram.local_ip_version_.has_value()) {
+    return;
+  }
+  if (datagram.local_ip_version_ == Address::IpVersion::v4) {
+#ifndef IP_SENDSRCADDR
+    cmsghdr* cmsg = appendControlMessage(message, sizeof(in_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_PKTINFO;
+    auto pktinfo = reinterpret_cast<in_pktinfo*>(CMSG_DATA(cmsg));
+    pktinfo->ipi_ifindex = 0;
+#ifdef WIN32
+    pktinfo->ipi_addr.s_addr = static_cast<uint32_t>(datagram.local_ip_);
+#else
+    pktinfo->ipi_spec_dst.s_addr = static_cast<uint32_t>(datagram.local_ip_);
+#endif
+#else
+    cmsghdr* cmsg = appendControlMessage(message, sizeof(in_addr));
+    cmsg->cmsg_level = IPPROTO_IP;
+    cmsg->cmsg_type = IP_SENDSRCADDR;
+    reinterpret_cast<in_addr*>(CMSG_DATA(cmsg))->s_addr = static_cast<uint32_t>(datagram.local_ip_);
+#endif
+  } else {
+    cmsghdr* cmsg = appendControlMessage(message, sizeof(in6_pktinfo));
+    cmsg->cmsg_level = IPPROTO_IPV6;
+    cmsg->cmsg_type = IPV6_PKTINFO;
+    auto pktinfo = reinterpret_cast<in6_pktinfo*>(CMSG_DATA(cmsg));
+    pktinfo->ipi6_ifindex = 0;
+    memcpy(pktinfo->ipi6_addr.s6_addr, &datagram.local_ip_, sizeof(pktinfo->ipi6_addr.s6_addr));
+  }
+}
+
+void UdpBatchWriter::addSegmentControlMessage(uint64_t segment_size, msghdr& message) {
+#ifdef UDP_SEGMENT
+  cmsghdr* cmsg = appendControlMessage(message, sizeof(uint16_t));
+  cmsg->cmsg_level = SOL_UDP;
+  cmsg->cmsg_type = UDP_SEGMENT;
+  const uint16_t gso_size = segment_size;
+  memcpy(CMSG_DATA(cmsg), &gso_size, sizeof(gso_size));
+#else
+  UNREFERENCED_PARAMETER(segment_size);
+  UNREFERENCED_PARAMETER(message);
+  NOT_REACHED_GCOVR_EXCL_LINE;
+#endif
+}
+
+UdpPacketWriterPtr UdpBatchWriterFactory::createUdpPacketWriter(IoHandle& io_handle,
+                                                                Stats::Scope& /*scope*/) {
+  if (!io_handle.supportsMmsg()) {
+    return std::make_unique<UdpDefaultWriter>(io_handle);
+  }
+  return std::make_unique<UdpBatchWriter>(io_handle, max_buffered_datagrams_);
+}
+
+} // namespace Network
+} // namespace Envoy
@@ -0,0 +1,116 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "envoy/buffer/buffer.h"
+#include "envoy/common/platform.h"
+#include "envoy/network/io_handle.h"
+#include "envoy/network/udp_packet_writer_handler.h"
+
+#include "common/common/logger.h"
+
+#include "absl/numeric/int128.h"
+#include "absl/types/optional.h"
+
+namespace Envoy {
+namespace Network {
+
+/**
+ * UdpPacketWriter which buffers the written datagrams until it is flushed and then sends them with
+ * a single sendmmsg() call. Runs of datagrams of the same size to the same peer are coalesced into
+ * one UDP_SEGMENT (GSO) message if the platform supports it. Unlike the QUICHE based
+ * Quic::UdpGsoBatchWriter, datagrams to different peers can share a batch, which suits proxies
+ * that write to many peers per event loop iteration.
+ *
+ * Datagrams which can't be sent because the socket's send buffer is full are dropped, as they
+ * would be by UdpDefaultWriter.
+ */
+class UdpBatchWriter : public UdpPacketWriter, Logger::Loggable<Logger::Id::udp> {
+public:
+  /**
+   * @param io_handle supplies the socket to write to. It must support sendmmsg().
+   * @param max_buffered_datagrams supplies the number of datagrams after which a batch is sent
+   *        without waiting for flush().
+   */
+  UdpBatchWriter(IoHandle& io_handle, uint32_t max_buffered_datagrams);
+
+  // UdpPacketWriter
+  Api::IoCallUint64Result writePacket(const Buffer::Instance& buffer, const Address::Ip* local_ip,
+                                      const Address::Instance& peer_address) override;
+  bool isWriteBlocked() const override { return write_blocked_; }
+  void setWritable() override { write_blocked_ = false; }
+  uint64_t getMaxPacketSize(const Address::Instance& /*peer_address*/) const override {
+    return Network::UdpMaxOutgoingPacketSize;
+  }
+  bool isBatchMode() const override { return true; }
+  UdpPacketWriterBuffer getNextWriteLocation(const Address::Ip* /*local_ip*/,
+                                             const Address::Instance& /*peer_address*/) override {
+    return {nullptr, 0, nullptr};
+  }
+  Api::IoCallUint64Result flush() override;
+
+  /**
+   * @return uint64_t the number of datagrams waiting for flush().
+   */
+  uint64_t bufferedDatagrams() const { return datagrams_.size(); }
+
+private:
+  // A buffered datagram. The addresses are copied as the caller's may not outlive the write.
+  struct Datagram {
+    bool sameAddresses(const Datagram& other) const;
+
+    uint64_t offset_;
+    uint64_t length_;
+    sockaddr_storage peer_address_;
+    socklen_t peer_address_length_;
+    // The source IP of the datagram, if any. IPv4 addresses are stored in the low 32 bits.
+    absl::optional<Address::IpVersion> local_ip_version_;
+    absl::uint128 local_ip_;
+  };
+
+  // Space for the control messages of a message: its source IP and GSO segment size.
+  static constexpr size_t ControlBufferSize =
+      CMSG_SPACE(sizeof(struct in6_pktinfo)) + CMSG_SPACE(sizeof(uint16_t));
+  struct alignas(cmsghdr) ControlBuffer {
+    char data_[ControlBufferSize];
+  };
+
+  // Builds messages_ from datagrams_, starting at the given datagram.
+  void buildMessages(uint64_t first_datagram);
+  // Adds the control message selecting the source IP of the message.
+  static void addLocalIpControlMessage(const Datagram& datagram, msghdr& message);
+  // Adds the control message splitting the message into GSO segments.
+  static void addSegmentControlMessage(uint64_t segment_size, msghdr& message);
+
+  IoHandle& io_handle_;
+  const uint32_t max_buffered_datagrams_;
+  // Cleared if the kernel rejected a GSO message, e.g. as the route's device lacks checksum
+  // offload, after which datagrams are sent individually.
+  bool use_gso_;
+  bool write_blocked_{};
+  // The payload of all buffered datagrams.
+  std::vector<uint8_t> data_;
+  std::vector<Datagram> datagrams_;
+  // Scratch space for flush(), kept between calls to avoid reallocating it.
+  std::vector<mmsghdr> messages_;
+  // For each message, the index of its first datagram.
+  std::vector<uint64_t> message_datagrams_;
+  std::vector<iovec> iovecs_;
+  std::vector<ControlBuffer> control_buffers_;
+};
+
+class UdpBatchWriterFactory : public UdpPacketWriterFactory {
+public:
+  explicit UdpBatchWriterFactory(uint32_t max_buffered_datagrams)
+      : max_buffered_datagrams_(max_buffered_datagrams) {}
+
+  // UdpPacketWriterFactory
+  UdpPacketWriterPtr createUdpPacketWriter(IoHandle& io_handle, Stats::Scope& scope) override;
+
+private:
+  const uint32_t max_buffered_datagrams_;
+};
+
+} // namespace Network
+} // namespace Envoy
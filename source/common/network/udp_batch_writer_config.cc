@@ -0,0 +1,31 @@
+#include "common/network/udp_batch_writer_config.h"
+
+#include <memory>
+#include <string>
+
+#include "envoy/config/listener/v3/udp_batch_writer_config.pb.h"
+
+#include "common/network/udp_batch_writer.h"
+#include "common/protobuf/utility.h"
+
+namespace Envoy {
+namespace Network {
+
+ProtobufTypes::MessagePtr UdpBatchWriterConfigFactory::createEmptyConfigProto() {
+  return std::make_unique<envoy::config::listener::v3::UdpBatchWriterOptions>();
+}
+
+UdpPacketWriterFactoryPtr
+UdpBatchWriterConfigFactory::createUdpPacketWriterFactory(const Protobuf::Message& message) {
+  const auto& options =
+      dynamic_cast<const envoy::config::listener::v3::UdpBatchWriterOptions&>(message);
+  return std::make_unique<UdpBatchWriterFactory>(
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(options, max_buffered_datagrams, 64));
+}
+
+std::string UdpBatchWriterConfigFactory::name() const { return "udp_batch_writer"; }
+
+REGISTER_FACTORY(UdpBatchWriterConfigFactory, Network::UdpPacketWriterConfigFactory);
+
+} // namespace Network
+} // namespace Envoy
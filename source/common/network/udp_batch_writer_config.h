@@ -0,0 +1,25 @@
+#pragma once
+
+#include "envoy/network/udp_packet_writer_config.h"
+#include "envoy/network/udp_packet_writer_handler.h"
+#include "envoy/registry/registry.h"
+
+namespace Envoy {
+namespace Network {
+
+// UdpPacketWriterConfigFactory to create UdpBatchWriterFactory based on given protobuf.
+class UdpBatchWriterConfigFactory : public UdpPacketWriterConfigFactory {
+public:
+  // UdpPacketWriterConfigFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  Network::UdpPacketWriterFactoryPtr
+  createUdpPacketWriterFactory(const Protobuf::Message& message) override;
+
+  std::string name() const override;
+};
+
+DECLARE_FACTORY(UdpBatchWriterConfigFactory);
+
+} // namespace Network
+} // namespace Envoy
@@ -1254,6 +1254,26 @@ VirtualHostImpl::VirtualHostImpl(
     }
   }
 
+  if (virtual_host.compile_path_matchers()) {
+    auto path_index = std::make_unique<RoutePathIndex>();
+    for (int i = 0; i < virtual_host.routes_size(); ++i) {
+      const auto& match = virtual_host.routes(i).match();
+      const bool case_sensitive = PROTOBUF_GET_WRAPPED_OR_DEFAULT(match, case_sensitive, true);
+      switch (match.path_specifier_case()) {
+      case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPrefix:
+        path_index->addPrefix(i, match.prefix(), case_sensitive);
+        break;
+      case envoy::config::route::v3::RouteMatch::PathSpecifierCase::kPath:
+        path_index->addExact(i, match.path(), case_sensitive);
+        break;
+      default:
+        path_index->addUnindexed(i);
+        break;
+      }
+    }
+    path_index_ = std::move(path_index);
+  }
+
   for (const auto& virtual_cluster : virtual_host.virtual_clusters()) {
     virtual_clusters_.push_back(
         VirtualClusterEntry(virtual_cluster, *vcluster_scope_,
@@ -1303,28 +1323,6 @@ const RouteSpecificFilterConfig* VirtualHostImpl::perFilterConfig(const std::str
   return per_filter_configs_.get(name);
 }
 
-const VirtualHostImpl* RouteMatcher::findWildcardVirtualHost(
-    const std::string& host, const RouteMatcher::WildcardVirtualHosts& wildcard_virtual_hosts,
-    RouteMatcher::SubstringFunction substring_function) const {
-  // We do a longest wildcard match against the host that's passed in
-  // (e.g. "foo-bar.baz.com" should match "*-bar.baz.com" before matching "*.baz.com" for suffix
-  // wildcards). This is done by scanning the length => wildcards map looking for every wildcard
-  // whose size is < length.
-  for (const auto& iter : wildcard_virtual_hosts) {
-    const uint32_t wildcard_length = iter.first;
-    const auto& wildcard_map = iter.second;
-    // >= because *.foo.com shouldn't match .foo.com.
-    if (wildcard_length >= host.size()) {
-      continue;
-    }
-    const auto& match = wildcard_map.find(substring_function(host, wildcard_length));
-    if (match != wildcard_map.end()) {
-      return match->second.get();
-    }
-  }
-  return nullptr;
-}
-
 RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& route_config,
                            const ConfigImpl& global_route_config,
                            Server::Configuration::ServerFactoryContext& factory_context,
@@ -1349,13 +1347,11 @@ RouteMatcher::RouteMatcher(const envoy::config::route::v3::RouteConfiguration& r
         }
         default_virtual_host_ = virtual_host;
       } else if (!domain.empty() && '*' == domain[0]) {
-        duplicate_found = !wildcard_virtual_host_suffixes_[domain.size() - 1]
-                               .emplace(domain.substr(1), virtual_host)
-                               .second;
+        duplicate_found = !wildcard_virtual_host_suffixes_.add(
+            absl::string_view(domain).substr(1), virtual_host);
       } else if (!domain.empty() && '*' == domain[domain.size() - 1]) {
-        duplicate_found = !wildcard_virtual_host_prefixes_[domain.size() - 1]
-                               .emplace(domain.substr(0, domain.size() - 1), virtual_host)
-                               .second;
+        duplicate_found = !wildcard_virtual_host_prefixes_.add(
+            absl::string_view(domain).substr(0, domain.size() - 1), virtual_host);
       } else {
         duplicate_found = !virtual_hosts_.emplace(domain, virtual_host).second;
       }
@@ -1389,37 +1385,63 @@ RouteConstSharedPtr VirtualHostImpl::getRouteFromEntries(const RouteCallback& cb
   }
 
   // Check for a route that matches the request.
-  for (auto route = routes_.begin(); route != routes_.end(); ++route) {
-    if (!headers.Path() && !(*route)->supportsPathlessHeaders()) {
-      continue;
+  RouteConstSharedPtr route_entry;
+  if (path_index_ != nullptr && headers.Path() != nullptr) {
+    // Only routes whose path matcher can match this path need to be evaluated. Candidates are
+    // returned in configuration order, so the first match is the same as in a linear scan.
+    RoutePathIndex::CandidateList candidates;
+    path_index_->findCandidates(headers.getPathValue(), candidates);
+    for (const uint32_t position : candidates) {
+      if (evaluateRoute(position, cb, headers, stream_info, random_value, route_entry)) {
+        return route_entry;
+      }
     }
+    return nullptr;
+  }
 
-    RouteConstSharedPtr route_entry = (*route)->matches(headers, stream_info, random_value);
-    if (nullptr == route_entry) {
+  for (size_t position = 0; position < routes_.size(); ++position) {
+    if (!headers.Path() && !routes_[position]->supportsPathlessHeaders()) {
       continue;
     }
 
-    if (cb) {
-      RouteEvalStatus eval_status = (std::next(route) == routes_.end())
-                                        ? RouteEvalStatus::NoMoreRoutes
-                                        : RouteEvalStatus::HasMoreRoutes;
-      RouteMatchStatus match_status = cb(route_entry, eval_status);
-      if (match_status == RouteMatchStatus::Accept) {
-        return route_entry;
-      }
-      if (match_status == RouteMatchStatus::Continue &&
-          eval_status == RouteEvalStatus::NoMoreRoutes) {
-        return nullptr;
-      }
-      continue;
+    if (evaluateRoute(position, cb, headers, stream_info, random_value, route_entry)) {
+      return route_entry;
     }
-
-    return route_entry;
   }
 
   return nullptr;
 }
 
+bool VirtualHostImpl::evaluateRoute(size_t position, const RouteCallback& cb,
+                                    const Http::RequestHeaderMap& headers,
+                                    const StreamInfo::StreamInfo& stream_info,
+                                    uint64_t random_value, RouteConstSharedPtr& result) const {
+  RouteConstSharedPtr route_entry = routes_[position]->matches(headers, stream_info, random_value);
+  if (nullptr == route_entry) {
+    return false;
+  }
+
+  if (cb) {
+    RouteEvalStatus eval_status = (position + 1 == routes_.size())
+                                      ? RouteEvalStatus::NoMoreRoutes
+                                      : RouteEvalStatus::HasMoreRoutes;
+    RouteMatchStatus match_status = cb(route_entry, eval_status);
+    if (match_status == RouteMatchStatus::Accept) {
+      result = std::move(route_entry);
+      return true;
+    }
+    if (match_status == RouteMatchStatus::Continue &&
+        eval_status == RouteEvalStatus::NoMoreRoutes) {
+      result = nullptr;
+      return true;
+    }
+    return false;
+  }
+
+  result = std::move(route_entry);
+  return true;
+}
+
 const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMap& headers) const {
   // Fast path the case where we only have a default virtual host.
   if (virtual_hosts_.empty() && wildcard_virtual_host_suffixes_.empty() &&
@@ -1434,26 +1456,30 @@ const VirtualHostImpl* RouteMatcher::findVirtualHost(const Http::RequestHeaderMa
 
   // TODO (@rshriram) Match Origin header in WebSocket
   // request with VHost, using wildcard match
-  // Lower-case the value of the host header, as hostnames are case insensitive.
-  const std::string host = absl::AsciiStrToLower(headers.getHostValue());
+  // Lower-case the value of the host header once for all the lookups below, as hostnames are case
+  // insensitive. Hosts are nearly always lower case already, in which case no copy is made.
+  const absl::string_view host_value = headers.getHostValue();
+  std::string lower_case_host;
+  absl::string_view host = host_value;
+  if (std::any_of(host_value.begin(), host_value.end(),
+                  [](char c) { return absl::ascii_isupper(c); })) {
+    lower_case_host = absl::AsciiStrToLower(host_value);
+    host = lower_case_host;
+  }
   const auto& iter = virtual_hosts_.find(host);
   if (iter != virtual_hosts_.end()) {
     return iter->second.get();
   }
   if (!wildcard_virtual_host_suffixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_suffixes_,
-        [](const std::string& h, int l) -> std::string { return h.substr(h.size() - l); });
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_suffixes_.findLongestMatch(host);
     if (vhost != nullptr) {
-      return vhost;
+      return vhost->get();
     }
   }
   if (!wildcard_virtual_host_prefixes_.empty()) {
-    const VirtualHostImpl* vhost = findWildcardVirtualHost(
-        host, wildcard_virtual_host_prefixes_,
-        [](const std::string& h, int l) -> std::string { return h.substr(0, l); });
+    const VirtualHostSharedPtr* vhost = wildcard_virtual_host_prefixes_.findLongestMatch(host);
     if (vhost != nullptr) {
-      return vhost;
+      return vhost->get();
     }
   }
   return default_virtual_host_.get();
@@ -27,8 +27,10 @@
 #include "common/router/header_formatter.h"
 #include "common/router/header_parser.h"
 #include "common/router/metadatamatchcriteria_impl.h"
+#include "common/router/route_path_index.h"
 #include "common/router/router_ratelimit.h"
 #include "common/router/tls_context_match_criteria_impl.h"
+#include "common/router/wildcard_domain_trie.h"
 #include "common/stats/symbol_table_impl.h"
 
 #include "absl/container/node_hash_map.h"
@@ -232,11 +234,23 @@ private:
                              stat_names) {}
   };
 
+  /**
+   * Evaluates the route at the given position in routes_.
+   * @return true if route evaluation is complete, in which case result holds the selected route
+   *         (which may be nullptr).
+   */
+  bool evaluateRoute(size_t position, const RouteCallback& cb,
+                     const Http::RequestHeaderMap& headers,
+                     const StreamInfo::StreamInfo& stream_info, uint64_t random_value,
+                     RouteConstSharedPtr& result) const;
+
   static const std::shared_ptr<const SslRedirectRoute> SSL_REDIRECT_ROUTE;
 
   const Stats::StatNameManagedStorage stat_name_storage_;
   Stats::ScopePtr vcluster_scope_;
   std::vector<RouteEntryImplBaseConstSharedPtr> routes_;
+  // Only set if compile_path_matchers is enabled for the virtual host.
+  std::unique_ptr<const RoutePathIndex> path_index_;
   std::vector<VirtualClusterEntry> virtual_clusters_;
   SslRequirements ssl_requirements_;
   const RateLimitPolicyImpl rate_limit_policy_;
@@ -998,26 +1012,15 @@ public:
   const VirtualHostImpl* findVirtualHost(const Http::RequestHeaderMap& headers) const;
 
 private:
-  using WildcardVirtualHosts =
-      std::map<int64_t, absl::node_hash_map<std::string, VirtualHostSharedPtr>, std::greater<>>;
-  using SubstringFunction = std::function<std::string(const std::string&, int)>;
-  const VirtualHostImpl* findWildcardVirtualHost(const std::string& host,
-                                                 const WildcardVirtualHosts& wildcard_virtual_hosts,
-                                                 SubstringFunction substring_function) const;
+  using WildcardVirtualHosts = WildcardDomainTrie<VirtualHostSharedPtr>;
 
   Stats::ScopePtr vhost_scope_;
   absl::node_hash_map<std::string, VirtualHostSharedPtr> virtual_hosts_;
-  // std::greater as a minor optimization to iterate from more to less specific
-  //
-  // A note on using an unordered_map versus a vector of (string, VirtualHostSharedPtr) pairs:
-  //
-  // Based on local benchmarks, each vector entry costs around 20ns for recall and (string)
-  // comparison with a fixed cost of about 25ns. For unordered_map, the empty map costs about 65ns
-  // and climbs to about 110ns once there are any entries.
-  //
-  // The break-even is 4 entries.
-  WildcardVirtualHosts wildcard_virtual_host_suffixes_;
-  WildcardVirtualHosts wildcard_virtual_host_prefixes_;
+  // Wildcard domains are kept in tries so that the longest matching wildcard can be found with a
+  // single walk over the host (e.g. "foo-bar.baz.com" should match "*-bar.baz.com" before
+  // "*.baz.com" for suffix wildcards), independent of the number of configured wildcard lengths.
+  WildcardVirtualHosts wildcard_virtual_host_suffixes_{WildcardVirtualHosts::Direction::Suffix};
+  WildcardVirtualHosts wildcard_virtual_host_prefixes_{WildcardVirtualHosts::Direction::Prefix};
 
   VirtualHostSharedPtr default_virtual_host_;
 };
@@ -0,0 +1,63 @@
+#include "common/router/route_path_index.h"
+
+#include <algorithm>
+
+#include "common/http/path_utility.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Router {
+
+RoutePathIndex::RoutePathIndex() = default;
+
+void RoutePathIndex::addPrefix(uint32_t position, absl::string_view prefix, bool case_sensitive) {
+  if (case_sensitive) {
+    case_sensitive_.getOrCreate(prefix).prefix_positions_.push_back(position);
+  } else {
+    case_insensitive_.getOrCreate(absl::AsciiStrToLower(prefix))
+        .prefix_positions_.push_back(position);
+  }
+}
+
+void RoutePathIndex::addExact(uint32_t position, absl::string_view path, bool case_sensitive) {
+  if (case_sensitive) {
+    case_sensitive_.getOrCreate(path).exact_positions_.push_back(position);
+  } else {
+    case_insensitive_.getOrCreate(absl::AsciiStrToLower(path)).exact_positions_.push_back(position);
+  }
+}
+
+void RoutePathIndex::addUnindexed(uint32_t position) { unindexed_.push_back(position); }
+
+void RoutePathIndex::findCandidates(absl::string_view path, CandidateList& candidates) const {
+  candidates.clear();
+  const absl::string_view stripped_path = Http::PathUtil::removeQueryAndFragment(path);
+  collect(case_sensitive_, stripped_path, candidates);
+  if (!case_insensitive_.empty()) {
+    // Paths are usually lower case already, in which case no copy is made.
+    if (std::any_of(stripped_path.begin(), stripped_path.end(),
+                    [](char c) { return absl::ascii_isupper(c); })) {
+      collect(case_insensitive_, absl::AsciiStrToLower(stripped_path), candidates);
+    } else {
+      collect(case_insensitive_, stripped_path, candidates);
+    }
+  }
+  candidates.insert(candidates.end(), unindexed_.begin(), unindexed_.end());
+  std::sort(candidates.begin(), candidates.end());
+}
+
+void RoutePathIndex::collect(const Trie& trie, absl::string_view path,
+                             CandidateList& candidates) {
+  trie.forEachMatch(path, [&candidates](const PathRoutes& routes, bool whole_path) {
+    candidates.insert(candidates.end(), routes.prefix_positions_.begin(),
+                      routes.prefix_positions_.end());
+    if (whole_path) {
+      candidates.insert(candidates.end(), routes.exact_positions_.begin(),
+                        routes.exact_positions_.end());
+    }
+  });
+}
+
+} // namespace Router
+} // namespace Envoy
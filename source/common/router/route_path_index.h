@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "common/router/wildcard_domain_trie.h"
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * Index over the literal (prefix and exact) path matchers of an ordered route list. Routes are
+ * identified by their position in the list. For a given request path the index produces the
+ * positions of all routes whose path matcher could match, in ascending order. Routes whose path
+ * matcher cannot be indexed (regex, CONNECT, etc.) are always returned as candidates. The index
+ * never decides a match by itself: each candidate still needs to be evaluated in full, which
+ * preserves first-match semantics.
+ */
+class RoutePathIndex {
+public:
+  using CandidateList = absl::InlinedVector<uint32_t, 16>;
+
+  RoutePathIndex();
+
+  /**
+   * Add a route that matches any path starting with prefix.
+   * @param position supplies the position of the route in the route list.
+   * @param prefix supplies the path prefix.
+   * @param case_sensitive supplies whether the prefix should be compared case sensitively.
+   */
+  void addPrefix(uint32_t position, absl::string_view prefix, bool case_sensitive);
+
+  /**
+   * Add a route that matches exactly one path (ignoring query string and fragment).
+   * @param position supplies the position of the route in the route list.
+   * @param path supplies the path.
+   * @param case_sensitive supplies whether the path should be compared case sensitively.
+   */
+  void addExact(uint32_t position, absl::string_view path, bool case_sensitive);
+
+  /**
+   * Add a route that must be evaluated for every request path.
+   * @param position supplies the position of the route in the route list.
+   */
+  void addUnindexed(uint32_t position);
+
+  /**
+   * Find the routes which may match the given path.
+   * @param path supplies the request path. The query string and fragment are ignored.
+   * @param candidates supplies the list to fill with candidate route positions, in ascending order.
+   */
+  void findCandidates(absl::string_view path, CandidateList& candidates) const;
+
+private:
+  // The routes whose path matcher ends at a node of the trie.
+  struct PathRoutes {
+    std::vector<uint32_t> prefix_positions_;
+    std::vector<uint32_t> exact_positions_;
+  };
+  using Trie = WildcardDomainTrie<PathRoutes>;
+
+  static void collect(const Trie& trie, absl::string_view path, CandidateList& candidates);
+
+  Trie case_sensitive_{Trie::Direction::Prefix};
+  // Keys are lower-cased.
+  Trie case_insensitive_{Trie::Direction::Prefix};
+  std::vector<uint32_t> unindexed_;
+};
+
+} // namespace Router
+} // namespace Envoy
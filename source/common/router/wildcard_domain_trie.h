@@ -0,0 +1,151 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Router {
+
+/**
+ * A compact byte-wise trie used to find the longest wildcard domain matching a host. Suffix
+ * wildcards (e.g. "*.foo.com") are stored reversed and matched from the end of the host, prefix
+ * wildcards (e.g. "foo.*") are stored as is and matched from the start of the host. Lookups do not
+ * allocate. Matching is case sensitive: keys and hosts must both be lower-cased by the caller.
+ * RoutePathIndex also uses it to index the path matchers of routes.
+ */
+template <class Value> class WildcardDomainTrie {
+public:
+  enum class Direction { Prefix, Suffix };
+
+  explicit WildcardDomainTrie(Direction direction) : direction_(direction), nodes_(1) {}
+
+  /**
+   * Adds a wildcard domain.
+   * @param key supplies the wildcard domain without the '*', in lower case.
+   * @param value supplies the value associated with the key.
+   * @return false if a value already exists for the given key.
+   */
+  bool add(absl::string_view key, Value value) {
+    Node& node = nodes_[findOrCreateNode(key)];
+    if (node.has_value_) {
+      return false;
+    }
+    node.value_ = std::move(value);
+    node.has_value_ = true;
+    ++size_;
+    return true;
+  }
+
+  /**
+   * @param key supplies the key.
+   * @return the value associated with the key, which is default constructed if there is none.
+   */
+  Value& getOrCreate(absl::string_view key) {
+    Node& node = nodes_[findOrCreateNode(key)];
+    if (!node.has_value_) {
+      node.has_value_ = true;
+      ++size_;
+    }
+    return node.value_;
+  }
+
+  /**
+   * Finds the value of the longest key matching the host. Only keys strictly shorter than the host
+   * are considered, as "*.foo.com" should not match ".foo.com".
+   * @param host supplies the host to match, in lower case.
+   * @return the value associated with the longest matching key, or nullptr if there is none.
+   */
+  const Value* findLongestMatch(absl::string_view host) const {
+    const Value* result = nullptr;
+    uint32_t current = 0;
+    for (size_t i = 0; i + 1 < host.size(); ++i) {
+      current = findChild(current, charAt(host, i));
+      if (current == 0) {
+        break;
+      }
+      if (nodes_[current].has_value_) {
+        result = &nodes_[current].value_;
+      }
+    }
+    return result;
+  }
+
+  /**
+   * Calls the callback with the value of each key the given key starts with (or ends with, for
+   * suffix tries), from the shortest to the longest. The empty key and the given key itself are
+   * included.
+   * @param key supplies the key to match.
+   * @param callback supplies the callback, called with the value and whether its key is the whole
+   *        given key.
+   */
+  template <class Callback> void forEachMatch(absl::string_view key, Callback callback) const {
+    uint32_t current = 0;
+    for (size_t i = 0;; ++i) {
+      if (nodes_[current].has_value_) {
+        callback(nodes_[current].value_, i == key.size());
+      }
+      if (i == key.size()) {
+        return;
+      }
+      current = findChild(current, charAt(key, i));
+      if (current == 0) {
+        return;
+      }
+    }
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+
+private:
+  struct Node {
+    // Sorted by byte so that children can be binary searched.
+    std::vector<std::pair<uint8_t, uint32_t>> children_;
+    Value value_{};
+    bool has_value_{};
+  };
+
+  uint8_t charAt(absl::string_view str, size_t i) const {
+    return direction_ == Direction::Prefix ? str[i] : str[str.size() - 1 - i];
+  }
+
+  uint32_t findOrCreateNode(absl::string_view key) {
+    uint32_t current = 0;
+    for (size_t i = 0; i < key.size(); ++i) {
+      const uint8_t c = charAt(key, i);
+      uint32_t next = findChild(current, c);
+      if (next == 0) {
+        next = nodes_.size();
+        nodes_.emplace_back();
+        auto& children = nodes_[current].children_;
+        children.insert(std::lower_bound(children.begin(), children.end(),
+                                         std::make_pair(c, uint32_t(0))),
+                        std::make_pair(c, next));
+      }
+      current = next;
+    }
+    return current;
+  }
+
+  uint32_t findChild(uint32_t node, uint8_t c) const {
+    // The root node is never a child, so 0 is used to signal "no child".
+    const auto& children = nodes_[node].children_;
+    const auto it =
+        std::lower_bound(children.begin(), children.end(), std::make_pair(c, uint32_t(0)));
+    if (it == children.end() || it->first != c) {
+      return 0;
+    }
+    return it->second;
+  }
+
+  const Direction direction_;
+  std::vector<Node> nodes_;
+  size_t size_{};
+};
+
+} // namespace Router
+} // namespace Envoy
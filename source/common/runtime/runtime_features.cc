@@ -111,10 +111,18 @@ constexpr const char* disabled_runtime_features[] = {
     // Allow Envoy to upgrade or downgrade version of type url, should be removed when support for
     // v2 url is removed from codebase.
     "envoy.reloadable_features.enable_type_url_downgrade_and_upgrade",
+    // Allocate header map list nodes from a per map arena rather than individually.
+    "envoy.reloadable_features.header_map_node_arena",
+    // Parse HTTP/1 with the SIMD scanning parser rather than http_parser.
+    "envoy.reloadable_features.http1_use_simd_parser",
     // TODO(alyssawilk) flip true after the release.
     "envoy.reloadable_features.new_tcp_connection_pool",
     // TODO(asraa) flip to true in a separate PR to enable the new JSON by default.
     "envoy.reloadable_features.remove_legacy_json",
+    // Update Maglev tables from the previous table of the priority rather than rebuilding them.
+    "envoy.reloadable_features.maglev_incremental_table",
+    // Use the stride scheduler rather than EDF for weighted round robin and least request.
+    "envoy.reloadable_features.upstream_stride_scheduler",
     // Sentinel and test flag.
     "envoy.reloadable_features.test_feature_false",
 };
@@ -81,6 +81,43 @@ void HistogramStatisticsImpl::refresh(const histogram_t* new_histogram_ptr) {
   }
 }
 
+void HistogramMerger::add(const histogram_t* histogram) {
+  const int num_bins = hist_bucket_count(histogram);
+  if (num_bins == 0) {
+    return;
+  }
+  if (counts_.empty()) {
+    counts_.resize(NumBuckets);
+  }
+  for (int i = 0; i < num_bins; ++i) {
+    hist_bucket_t bucket;
+    uint64_t count;
+    hist_bucket_idx_bucket(histogram, i, &bucket, &count);
+    if (count == 0) {
+      continue;
+    }
+    uint64_t& merged_count = counts_[index(bucket)];
+    if (merged_count == 0) {
+      touched_.push_back(index(bucket));
+    }
+    merged_count += count;
+  }
+}
+
+void HistogramMerger::finish(histogram_t* target) {
+  // Histograms of latencies and sizes only have positive buckets, which are then inserted in
+  // order, each landing at the end of the bins of the target.
+  std::sort(touched_.begin(), touched_.end());
+  for (const uint32_t i : touched_) {
+    hist_bucket_t bucket;
+    bucket.val = static_cast<int8_t>(static_cast<int32_t>(i & 0xff) - 128);
+    bucket.exp = static_cast<int8_t>(static_cast<int32_t>(i >> 8) - 128);
+    hist_insert_raw(target, bucket, counts_[i]);
+    counts_[i] = 0;
+  }
+  touched_.clear();
+}
+
 HistogramSettingsImpl::HistogramSettingsImpl(const envoy::config::metrics::v3::StatsConfig& config)
     : configs_([&config]() {
         std::vector<Config> configs;
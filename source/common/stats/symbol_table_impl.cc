@@ -3,12 +3,14 @@
 #include <algorithm>
 #include <iostream>
 #include <memory>
+#include <tuple>
 #include <vector>
 
 #include "common/common/assert.h"
 #include "common/common/logger.h"
 #include "common/common/utility.h"
 
+#include "absl/hash/hash.h"
 #include "absl/strings/str_cat.h"
 
 namespace Envoy {
@@ -157,11 +159,8 @@ void SymbolTableImpl::Encoding::decodeTokens(
 std::vector<absl::string_view> SymbolTableImpl::decodeStrings(const SymbolTable::Storage array,
                                                               size_t size) const {
   std::vector<absl::string_view> strings;
-  Thread::LockGuard lock(lock_);
   Encoding::decodeTokens(
-      array, size,
-      [this, &strings](Symbol symbol)
-          ABSL_NO_THREAD_SAFETY_ANALYSIS { strings.push_back(fromSymbol(symbol)); },
+      array, size, [this, &strings](Symbol symbol) { strings.push_back(fromSymbol(symbol)); },
       [&strings](absl::string_view str) { strings.push_back(str); });
   return strings;
 }
@@ -208,18 +207,19 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
   std::vector<Symbol> symbols;
   symbols.reserve(tokens.size());
 
-  // Now take the lock and populate the Symbol objects, which involves bumping
-  // ref-counts in this.
-  {
+  recent_lookups_total_.fetch_add(1, std::memory_order_relaxed);
+  if (track_recent_lookups_.load(std::memory_order_relaxed)) {
     Thread::LockGuard lock(lock_);
     recent_lookups_.lookup(name);
-    for (auto& token : tokens) {
-      // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
-      // length below some threshold, say 4 bytes. It might be preferable not to
-      // reserve Symbols for every 3 digit number found (for example) in ipv4
-      // addresses.
-      symbols.push_back(toSymbol(token));
-    }
+  }
+
+  // Now populate the Symbol objects, which involves bumping ref-counts in this.
+  for (auto& token : tokens) {
+    // TODO(jmarantz): consider using StatNameDynamicStorage for tokens with
+    // length below some threshold, say 4 bytes. It might be preferable not to
+    // reserve Symbols for every 3 digit number found (for example) in ipv4
+    // addresses.
+    symbols.push_back(toSymbol(token));
   }
 
   // Now efficiently encode the array of 32-bit symbols into a uint8_t array.
@@ -227,9 +227,12 @@ void SymbolTableImpl::addTokensToEncoding(const absl::string_view name, Encoding
 }
 
 uint64_t SymbolTableImpl::numSymbols() const {
-  Thread::LockGuard lock(lock_);
-  ASSERT(encode_map_.size() == decode_map_.size());
-  return encode_map_.size();
+  uint64_t num_symbols = 0;
+  for (EncodeShard& shard : encode_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    num_symbols += shard.map_.size();
+  }
+  return num_symbols;
 }
 
 std::string SymbolTableImpl::toString(const StatName& stat_name) const {
@@ -240,16 +243,16 @@ void SymbolTableImpl::incRefCount(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-
-    ASSERT(decode_search != decode_map_.end(),
-           "Please see "
-           "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
-           "debugging-symbol-table-assertions");
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end(),
+    const InlineString* token = decode_table_.find(symbol);
+    ASSERT(token != nullptr, "Please see "
+                             "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
+                             "debugging-symbol-table-assertions");
+
+    EncodeShard& shard = encodeShard(token->toStringView());
+    Thread::LockGuard lock(shard.lock_);
+    auto encode_search = shard.map_.find(token->toStringView());
+    ASSERT(encode_search != shard.map_.end(),
            "Please see "
            "https://github.com/envoyproxy/envoy/blob/main/source/docs/stats.md#"
            "debugging-symbol-table-assertions");
@@ -262,13 +265,14 @@ void SymbolTableImpl::free(const StatName& stat_name) {
   // Before taking the lock, decode the array of symbols from the SymbolTable::Storage.
   const SymbolVec symbols = Encoding::decodeSymbols(stat_name.data(), stat_name.dataSize());
 
-  Thread::LockGuard lock(lock_);
   for (Symbol symbol : symbols) {
-    auto decode_search = decode_map_.find(symbol);
-    ASSERT(decode_search != decode_map_.end());
+    const InlineString* token = decode_table_.find(symbol);
+    ASSERT(token != nullptr);
 
-    auto encode_search = encode_map_.find(decode_search->second->toStringView());
-    ASSERT(encode_search != encode_map_.end());
+    EncodeShard& shard = encodeShard(token->toStringView());
+    Thread::LockGuard lock(shard.lock_);
+    auto encode_search = shard.map_.find(token->toStringView());
+    ASSERT(encode_search != shard.map_.end());
 
     // If that was the last remaining client usage of the symbol, erase the
     // current mappings and add the now-unused symbol to the reuse pool.
@@ -277,15 +281,19 @@ void SymbolTableImpl::free(const StatName& stat_name) {
     // symbol_table_speed_test.cc, relative to breaking out the decrement into a
     // separate step, likely due to the non-trivial dereferences in EXPR.
     if (--encode_search->second.ref_count_ == 0) {
-      decode_map_.erase(decode_search);
-      encode_map_.erase(encode_search);
-      pool_.push(symbol);
+      {
+        // The symbol must be out of the decode table before it can be reused,
+        // and before the token is destroyed.
+        Thread::LockGuard symbol_lock(lock_);
+        decode_table_.set(symbol, nullptr);
+        pool_.push(symbol);
+      }
+      shard.map_.erase(encode_search);
     }
   }
 }
 
 uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
-  uint64_t total = 0;
   absl::flat_hash_map<std::string, uint64_t> name_count_map;
 
   // We don't want to hold lock_ while calling the iterator, but we need it to
@@ -295,7 +303,6 @@ uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
     recent_lookups_.forEach(
         [&name_count_map](absl::string_view str, uint64_t count)
             ABSL_NO_THREAD_SAFETY_ANALYSIS { name_count_map[std::string(str)] += count; });
-    total += recent_lookups_.total();
   }
 
   // Now we have the collated name-count map data: we need to vectorize and
@@ -311,7 +318,7 @@ uint64_t SymbolTableImpl::getRecentLookups(const RecentLookupsFn& iter) const {
   for (const LookupCount& lookup_count : lookup_data) {
     iter(lookup_count.second, lookup_count.first);
   }
-  return total;
+  return recent_lookups_total_.load(std::memory_order_relaxed);
 }
 
 DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
@@ -343,11 +350,13 @@ DynamicSpans SymbolTableImpl::getDynamicSpans(StatName stat_name) const {
 void SymbolTableImpl::setRecentLookupCapacity(uint64_t capacity) {
   Thread::LockGuard lock(lock_);
   recent_lookups_.setCapacity(capacity);
+  track_recent_lookups_.store(capacity > 0, std::memory_order_relaxed);
 }
 
 void SymbolTableImpl::clearRecentLookups() {
   Thread::LockGuard lock(lock_);
   recent_lookups_.clear();
+  recent_lookups_total_.store(0, std::memory_order_relaxed);
 }
 
 uint64_t SymbolTableImpl::recentLookupCapacity() const {
@@ -361,23 +370,33 @@ StatNameSetPtr SymbolTableImpl::makeSet(absl::string_view name) {
   return stat_name_set;
 }
 
+SymbolTableImpl::EncodeShard& SymbolTableImpl::encodeShard(absl::string_view token) const {
+  // Use the top bits of the hash, as flat_hash_map uses the bottom ones to
+  // pick and match slots.
+  const size_t hash = absl::Hash<absl::string_view>()(token);
+  return encode_shards_[hash >> (sizeof(size_t) * 8 - EncodeShardBits)];
+}
+
 Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   Symbol result;
-  auto encode_find = encode_map_.find(sv);
+  EncodeShard& shard = encodeShard(sv);
+  Thread::LockGuard lock(shard.lock_);
+  auto encode_find = shard.map_.find(sv);
   // If the string segment doesn't already exist,
-  if (encode_find == encode_map_.end()) {
-    // We create the actual string, place it in the decode_map_, and then insert
-    // a string_view pointing to it in the encode_map_. This allows us to only
-    // store the string once. We use unique_ptr so copies are not made as
-    // flat_hash_map moves values around.
+  if (encode_find == shard.map_.end()) {
+    // We create the actual string, publish it in the decode_table_, and then
+    // insert a string_view pointing to it in the encode map. This allows us to
+    // only store the string once.
     InlineStringPtr str = InlineString::create(sv);
-    auto encode_insert = encode_map_.insert({str->toStringView(), SharedSymbol(next_symbol_)});
+    const absl::string_view token = str->toStringView();
+    {
+      Thread::LockGuard symbol_lock(lock_);
+      result = next_symbol_;
+      decode_table_.set(result, str.get());
+      newSymbol();
+    }
+    auto encode_insert = shard.map_.emplace(token, SharedSymbol(result, std::move(str)));
     ASSERT(encode_insert.second);
-    auto decode_insert = decode_map_.insert({next_symbol_, std::move(str)});
-    ASSERT(decode_insert.second);
-
-    result = next_symbol_;
-    newSymbol();
   } else {
     // If the insertion didn't take place, return the actual value at that location and up the
     // refcount at that location
@@ -387,11 +406,42 @@ Symbol SymbolTableImpl::toSymbol(absl::string_view sv) {
   return result;
 }
 
-absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const
-    ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
-  auto search = decode_map_.find(symbol);
-  RELEASE_ASSERT(search != decode_map_.end(), "no such symbol");
-  return search->second->toStringView();
+absl::string_view SymbolTableImpl::fromSymbol(const Symbol symbol) const {
+  const InlineString* token = decode_table_.find(symbol);
+  RELEASE_ASSERT(token != nullptr, "no such symbol");
+  return token->toStringView();
+}
+
+const InlineString* SymbolTableImpl::DecodeTable::find(Symbol symbol) const {
+  const Directory* directory = directory_.load(std::memory_order_acquire);
+  const size_t block = symbol >> BlockBits;
+  if (directory == nullptr || block >= directory->size()) {
+    return nullptr;
+  }
+  return (*(*directory)[block])[symbol & (BlockSize - 1)].load(std::memory_order_acquire);
+}
+
+void SymbolTableImpl::DecodeTable::set(Symbol symbol, const InlineString* token) {
+  const size_t block = symbol >> BlockBits;
+  if (block >= blocks_.size()) {
+    ASSERT(token != nullptr);
+    const size_t num_blocks = std::max<size_t>(block + 1, 2 * blocks_.size());
+    auto directory = std::make_unique<Directory>();
+    directory->reserve(num_blocks);
+    while (blocks_.size() < num_blocks) {
+      auto new_block = std::make_unique<Block>();
+      for (std::atomic<const InlineString*>& entry : *new_block) {
+        entry.store(nullptr, std::memory_order_relaxed);
+      }
+      blocks_.push_back(std::move(new_block));
+    }
+    for (const std::unique_ptr<Block>& existing_block : blocks_) {
+      directory->push_back(existing_block.get());
+    }
+    directory_.store(directory.get(), std::memory_order_release);
+    directories_.push_back(std::move(directory));
+  }
+  (*blocks_[block])[symbol & (BlockSize - 1)].store(token, std::memory_order_release);
 }
 
 void SymbolTableImpl::newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_) {
@@ -424,16 +474,17 @@ bool SymbolTableImpl::lessThan(const StatName& a, const StatName& b) const {
 
 #ifndef ENVOY_CONFIG_COVERAGE
 void SymbolTableImpl::debugPrint() const {
-  Thread::LockGuard lock(lock_);
-  std::vector<Symbol> symbols;
-  for (const auto& p : decode_map_) {
-    symbols.push_back(p.first);
+  std::vector<std::tuple<Symbol, std::string, uint32_t>> symbols;
+  for (EncodeShard& shard : encode_shards_) {
+    Thread::LockGuard lock(shard.lock_);
+    for (const auto& p : shard.map_) {
+      symbols.emplace_back(p.second.symbol_, std::string(p.first), p.second.ref_count_);
+    }
   }
   std::sort(symbols.begin(), symbols.end());
-  for (Symbol symbol : symbols) {
-    const InlineString& token = *decode_map_.find(symbol)->second;
-    const SharedSymbol& shared_symbol = encode_map_.find(token.toStringView())->second;
-    ENVOY_LOG_MISC(info, "{}: '{}' ({})", symbol, token.toStringView(), shared_symbol.ref_count_);
+  for (const auto& symbol : symbols) {
+    ENVOY_LOG_MISC(info, "{}: '{}' ({})", std::get<0>(symbol), std::get<1>(symbol),
+                   std::get<2>(symbol));
   }
 }
 #endif
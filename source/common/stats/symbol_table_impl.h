@@ -1,6 +1,8 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
 #include <memory>
 #include <stack>
@@ -62,6 +64,10 @@ using SymbolVec = std::vector<Symbol>;
  * that if a string is encoded, the resulting stat is destroyed, and then that
  * same string is re-encoded, it may or may not encode to the same underlying
  * symbol.
+ *
+ * Decoding symbols is lock-free, and encoding tokens that already have symbols
+ * only takes the lock of the shard of the encode map holding the token. The
+ * table-wide lock is taken to allocate and release symbols.
  */
 class SymbolTableImpl : public SymbolTable {
 public:
@@ -204,13 +210,61 @@ private:
   friend class StatNameDeathTest;
 
   struct SharedSymbol {
-    SharedSymbol(Symbol symbol) : symbol_(symbol), ref_count_(1) {}
+    SharedSymbol(Symbol symbol, InlineStringPtr&& token)
+        : symbol_(symbol), ref_count_(1), token_(std::move(token)) {}
 
     Symbol symbol_;
     uint32_t ref_count_;
+    // Owns the token. The encode map key and the decode table refer to it, and
+    // the unique_ptr keeps it in place as flat_hash_map moves values around.
+    InlineStringPtr token_;
+  };
+
+  // One shard of the encode map. Tokens are spread over the shards by hash so
+  // that threads encoding or freeing names with existing tokens rarely contend.
+  struct alignas(64) EncodeShard {
+    Thread::MutexBasicLockable lock_;
+    absl::flat_hash_map<absl::string_view, SharedSymbol> map_ ABSL_GUARDED_BY(lock_);
+  };
+  static constexpr uint32_t EncodeShardBits = 4;
+  static constexpr uint32_t NumEncodeShards = 1 << EncodeShardBits;
+
+  /**
+   * Maps symbols to their tokens. As symbols are small integers which are
+   * reused once freed, this is an array indexed by symbol, allocated in blocks
+   * which never move. Lookups are lock-free. Updates must be serialized by the
+   * caller. When the table grows, a new directory of blocks is published and
+   * the previous one is retained until destruction, as readers may still be
+   * using it; directories double in size so the retained ones take O(n) space.
+   */
+  class DecodeTable {
+  public:
+    /**
+     * @param symbol the symbol to look up.
+     * @return the token of the symbol, or nullptr if the symbol is not in use.
+     */
+    const InlineString* find(Symbol symbol) const;
+
+    /**
+     * Sets or clears the token of a symbol, growing the table if needed.
+     * @param symbol the symbol to update.
+     * @param token the token, or nullptr when the symbol is released.
+     */
+    void set(Symbol symbol, const InlineString* token);
+
+  private:
+    static constexpr uint32_t BlockBits = 8;
+    static constexpr uint32_t BlockSize = 1 << BlockBits;
+    using Block = std::array<std::atomic<const InlineString*>, BlockSize>;
+    using Directory = std::vector<Block*>;
+
+    std::atomic<const Directory*> directory_{nullptr};
+    std::vector<std::unique_ptr<Directory>> directories_;
+    std::vector<std::unique_ptr<Block>> blocks_;
   };
 
-  // This must be held during both encode() and free().
+  // This must be held while allocating or releasing symbols, and while
+  // accessing recent_lookups_.
   mutable Thread::MutexBasicLockable lock_;
 
   /**
@@ -234,7 +288,7 @@ private:
    * @param sv the individual string to be encoded as a symbol.
    * @return Symbol the encoded string.
    */
-  Symbol toSymbol(absl::string_view sv) ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  Symbol toSymbol(absl::string_view sv);
 
   /**
    * Convenience function for decode(), decoding one symbol at a time.
@@ -242,12 +296,18 @@ private:
    * @param symbol the individual symbol to be decoded.
    * @return absl::string_view the decoded string.
    */
-  absl::string_view fromSymbol(Symbol symbol) const ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+  absl::string_view fromSymbol(Symbol symbol) const;
 
   /**
    * Stages a new symbol for use. To be called after a successful insertion.
    */
-  void newSymbol();
+  void newSymbol() ABSL_EXCLUSIVE_LOCKS_REQUIRED(lock_);
+
+  /**
+   * @param token a token.
+   * @return the shard of the encode map holding the token.
+   */
+  EncodeShard& encodeShard(absl::string_view token) const;
 
   /**
    * Tokenizes name, finds or allocates symbols for each token, and adds them
@@ -270,13 +330,16 @@ private:
   // If the free pool is exhausted, we monotonically increase this counter.
   Symbol monotonic_counter_;
 
-  // Bitmap implementation.
-  // The encode map stores both the symbol and the ref count of that symbol.
-  // Using absl::string_view lets us only store the complete string once, in the decode map.
-  using EncodeMap = absl::flat_hash_map<absl::string_view, SharedSymbol>;
-  using DecodeMap = absl::flat_hash_map<Symbol, InlineStringPtr>;
-  EncodeMap encode_map_ ABSL_GUARDED_BY(lock_);
-  DecodeMap decode_map_ ABSL_GUARDED_BY(lock_);
+  // The encode map, sharded by token, stores the token, the symbol and the ref
+  // count of that symbol. The decode table refers to the tokens it owns.
+  mutable std::array<EncodeShard, NumEncodeShards> encode_shards_;
+  DecodeTable decode_table_;
+
+  // Set while recent lookups are tracked, so encoding can skip lock_ otherwise.
+  std::atomic<bool> track_recent_lookups_{false};
+
+  // The number of lookups, counted whether or not they are tracked.
+  std::atomic<uint64_t> recent_lookups_total_{0};
 
   // Free pool of symbols for re-use.
   // TODO(ambuc): There might be an optimization here relating to storing ranges of freed symbols
@@ -749,10 +749,10 @@ void ThreadLocalHistogramImpl::recordValue(uint64_t value) {
   used_ = true;
 }
 
-void ThreadLocalHistogramImpl::merge(histogram_t* target) {
-  histogram_t** other_histogram = &histograms_[otherHistogramIndex()];
-  hist_accumulate(target, other_histogram, 1);
-  hist_clear(*other_histogram);
+void ThreadLocalHistogramImpl::merge(HistogramMerger& merger) {
+  histogram_t* other_histogram = histograms_[otherHistogramIndex()];
+  merger.add(other_histogram);
+  hist_clear(other_histogram);
 }
 
 ParentHistogramImpl::ParentHistogramImpl(StatName name, Histogram::Unit unit,
@@ -837,34 +837,61 @@ bool ParentHistogramImpl::used() const {
 void ParentHistogramImpl::merge() {
   Thread::ReleasableLockGuard lock(merge_lock_);
   if (merged_ || usedLockHeld()) {
-    hist_clear(interval_histogram_);
+    // All the TLS histograms are summed in the merger, which then fills interval_histogram_
+    // with one insertion per bin, rather than each TLS histogram being accumulated into it.
     // Here we could copy all the pointers to TLS histograms in the tls_histogram_ list,
     // then release the lock before we do the actual merge. However it is not a big deal
-    // because the tls_histogram merge is not that expensive as it is a single histogram
-    // merge and adding TLS histograms is rare.
+    // because the tls_histogram merge is not that expensive and adding TLS histograms is rare.
+    HistogramMerger& merger = thread_local_store_.histogramMerger();
     for (const TlsHistogramSharedPtr& tls_histogram : tls_histograms_) {
-      tls_histogram->merge(interval_histogram_);
+      tls_histogram->merge(merger);
     }
     // Since TLS merge is done, we can release the lock here.
     lock.release();
-    hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
-    cumulative_statistics_.refresh(cumulative_histogram_);
-    interval_statistics_.refresh(interval_histogram_);
+    if (!merger.empty()) {
+      hist_clear(interval_histogram_);
+      merger.finish(interval_histogram_);
+      hist_accumulate(cumulative_histogram_, &interval_histogram_, 1);
+      cumulative_statistics_.refresh(cumulative_histogram_);
+      interval_statistics_.refresh(interval_histogram_);
+      interval_has_values_ = true;
+    } else if (interval_has_values_) {
+      // Nothing was recorded during the interval, so the cumulative statistics are unchanged,
+      // and only the interval ones need to be reset.
+      hist_clear(interval_histogram_);
+      interval_statistics_.refresh(interval_histogram_);
+      interval_has_values_ = false;
+    } else {
+      // Nothing changed since the previous merge, which is the case of most histograms on a
+      // flush, so the statistics and summaries are still valid.
+      merged_ = true;
+      return;
+    }
+    {
+      Thread::LockGuard summary_lock(merge_lock_);
+      quantile_summary_.clear();
+      bucket_summary_.clear();
+    }
     merged_ = true;
   }
 }
 
 const std::string ParentHistogramImpl::quantileSummary() const {
   if (used()) {
-    std::vector<std::string> summary;
-    const std::vector<double>& supported_quantiles_ref = interval_statistics_.supportedQuantiles();
-    summary.reserve(supported_quantiles_ref.size());
-    for (size_t i = 0; i < supported_quantiles_ref.size(); ++i) {
-      summary.push_back(fmt::format("P{:g}({},{})", 100 * supported_quantiles_ref[i],
-                                    interval_statistics_.computedQuantiles()[i],
-                                    cumulative_statistics_.computedQuantiles()[i]));
+    Thread::LockGuard lock(merge_lock_);
+    if (quantile_summary_.empty()) {
+      std::vector<std::string> summary;
+      const std::vector<double>& supported_quantiles_ref =
+          interval_statistics_.supportedQuantiles();
+      summary.reserve(supported_quantiles_ref.size());
+      for (size_t i = 0; i < supported_quantiles_ref.size(); ++i) {
+        summary.push_back(fmt::format("P{:g}({},{})", 100 * supported_quantiles_ref[i],
+                                      interval_statistics_.computedQuantiles()[i],
+                                      cumulative_statistics_.computedQuantiles()[i]));
+      }
+      quantile_summary_ = absl::StrJoin(summary, " ");
     }
-    return absl::StrJoin(summary, " ");
+    return quantile_summary_;
   } else {
     return std::string("No recorded values");
   }
@@ -872,15 +899,19 @@ const std::string ParentHistogramImpl::quantileSummary() const {
 
 const std::string ParentHistogramImpl::bucketSummary() const {
   if (used()) {
-    std::vector<std::string> bucket_summary;
-    ConstSupportedBuckets& supported_buckets = interval_statistics_.supportedBuckets();
-    bucket_summary.reserve(supported_buckets.size());
-    for (size_t i = 0; i < supported_buckets.size(); ++i) {
-      bucket_summary.push_back(fmt::format("B{:g}({},{})", supported_buckets[i],
-                                           interval_statistics_.computedBuckets()[i],
-                                           cumulative_statistics_.computedBuckets()[i]));
+    Thread::LockGuard lock(merge_lock_);
+    if (bucket_summary_.empty()) {
+      std::vector<std::string> bucket_summary;
+      ConstSupportedBuckets& supported_buckets = interval_statistics_.supportedBuckets();
+      bucket_summary.reserve(supported_buckets.size());
+      for (size_t i = 0; i < supported_buckets.size(); ++i) {
+        bucket_summary.push_back(fmt::format("B{:g}({},{})", supported_buckets[i],
+                                             interval_statistics_.computedBuckets()[i],
+                                             cumulative_statistics_.computedBuckets()[i]));
+      }
+      bucket_summary_ = absl::StrJoin(bucket_summary, " ");
     }
-    return absl::StrJoin(bucket_summary, " ");
+    return bucket_summary_;
   } else {
     return std::string("No recorded values");
   }
@@ -38,7 +38,10 @@ public:
                            const StatNameTagVector& stat_name_tags, SymbolTable& symbol_table);
   ~ThreadLocalHistogramImpl() override;
 
-  void merge(histogram_t* target);
+  /**
+   * Adds the values recorded before the last beginMerge() to the merger, and clears them.
+   */
+  void merge(HistogramMerger& merger);
 
   /**
    * Called in the beginning of merge process. Swaps the histogram used for collection so that we do
@@ -96,7 +99,8 @@ public:
    * This method is called during the main stats flush process for each of the histograms. It
    * iterates through the TLS histograms and collects the histogram data of all of them
    * in to "interval_histogram". Then the collected "interval_histogram" is merged to a
-   * "cumulative_histogram".
+   * "cumulative_histogram". The statistics are only recomputed when values were recorded since
+   * the previous merge.
    */
   void merge() override;
 
@@ -104,6 +108,7 @@ public:
   const HistogramStatistics& cumulativeStatistics() const override {
     return cumulative_statistics_;
   }
+  // The summaries are computed once per merge, on first use.
   const std::string quantileSummary() const override;
   const std::string bucketSummary() const override;
 
@@ -131,7 +136,12 @@ private:
   HistogramStatisticsImpl cumulative_statistics_;
   mutable Thread::MutexBasicLockable merge_lock_;
   std::list<TlsHistogramSharedPtr> tls_histograms_ ABSL_GUARDED_BY(merge_lock_);
+  mutable std::string quantile_summary_ ABSL_GUARDED_BY(merge_lock_);
+  mutable std::string bucket_summary_ ABSL_GUARDED_BY(merge_lock_);
   bool merged_;
+  // Whether interval_histogram_ has values, so its statistics need to be reset when a merge
+  // finds no new values.
+  bool interval_has_values_{};
   std::atomic<bool> shutting_down_{false};
   std::atomic<uint32_t> ref_count_{0};
   const uint64_t id_; // Index into TlsCache::histogram_cache_.
@@ -258,6 +268,11 @@ public:
 
   Histogram& tlsHistogram(ParentHistogramImpl& parent, uint64_t id);
 
+  /**
+   * @return the merger shared by the histogram merges, which run on the main thread.
+   */
+  HistogramMerger& histogramMerger() { return histogram_merger_; }
+
   /**
    * @return a thread synchronizer object used for controlling thread behavior in tests.
    */
@@ -498,6 +513,7 @@ private:
   std::atomic<bool> threading_ever_initialized_{};
   std::atomic<bool> shutting_down_{};
   std::atomic<bool> merge_in_progress_{};
+  HistogramMerger histogram_merger_;
   AllocatorImpl heap_allocator_;
 
   NullCounterImpl null_counter_;
@@ -128,6 +128,7 @@ Config::SharedConfig::SharedConfig(
 Config::Config(const envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy& config,
                Server::Configuration::FactoryContext& context)
     : max_connect_attempts_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_connect_attempts, 1)),
+      enable_splice_(config.enable_splice()),
       upstream_drain_manager_slot_(context.threadLocal().allocateSlot()),
       shared_config_(std::make_shared<SharedConfig>(config, context)),
       random_generator_(context.api().randomGenerator()) {
@@ -648,6 +649,13 @@ void Filter::onUpstreamEvent(Network::ConnectionEvent event) {
 
 void Filter::onUpstreamConnection() {
   connecting_ = false;
+  // Start splicing before any data is read, so that none has to be forwarded through the filter.
+  if (config_->enableSplice() && upstream_ != nullptr &&
+      upstream_->startSplice(read_callbacks_->connection())) {
+    ENVOY_CONN_LOG(debug, "splicing data to and from the upstream connection",
+                   read_callbacks_->connection());
+    config_->stats().downstream_cx_spliced_total_.inc();
+  }
   // Re-enable downstream reads now that the upstream connection is established
   // so we have a place to send downstream data to.
   read_callbacks_->connection().readDisable(false);
@@ -114,6 +114,7 @@ public:
   bool readDisable(bool disable) override;
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
+  bool startSplice(Network::Connection& downstream) override;
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
 
 private:
@@ -136,6 +137,8 @@ public:
   bool readDisable(bool disable) override;
   void encodeData(Buffer::Instance& data, bool end_stream) override;
   void addBytesSentCallback(Network::Connection::BytesSentCb cb) override;
+  // The data is carried by an HTTP stream, so it can't be spliced.
+  bool startSplice(Network::Connection&) override { return false; }
   Tcp::ConnectionPool::ConnectionData* onDownstreamEvent(Network::ConnectionEvent event) override;
 
   // Http::StreamCallbacks
@@ -12,6 +12,7 @@
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/config/core/v3/config_source.pb.h"
 #include "envoy/event/dispatcher.h"
+#include "envoy/extensions/upstreams/http/v3/http_protocol_options.pb.h"
 #include "envoy/network/dns.h"
 #include "envoy/runtime/runtime.h"
 #include "envoy/stats/scope.h"
@@ -1506,6 +1507,11 @@ Http::ConnectionPool::InstancePtr ProdClusterManagerFactory::allocateConnPool(
 
   if (protocols.size() == 1 && protocols[0] == Http::Protocol::Http2 &&
       runtime_.snapshot().featureEnabled("upstream.use_http2", 100)) {
+    if ((host->cluster().features() & ClusterInfo::Features::SHARED_HTTP2_CONNECTION_POOL) &&
+        shared_conn_pool_thread_ != nullptr) {
+      return std::make_unique<Http::Http2::SharedConnPoolImpl>(
+          dispatcher, shared_conn_pool_thread_, host, priority, options, transport_socket_options);
+    }
     return Http::Http2::allocateConnPool(dispatcher, api_.randomGenerator(), host, priority,
                                          options, transport_socket_options, state);
   }
@@ -1519,6 +1525,43 @@ Http::ConnectionPool::InstancePtr ProdClusterManagerFactory::allocateConnPool(
                                        transport_socket_options, state);
 }
 
+Http::Http2::SharedConnPoolThreadSharedPtr
+ProdClusterManagerFactory::createSharedConnPoolThread(Api::Api& api, ThreadLocal::Instance& tls) {
+  // The API outlives the thread, which the server shuts down before thread local storage.
+  Random::RandomGenerator& random_generator = api.randomGenerator();
+  return std::make_shared<Http::Http2::SharedConnPoolThread>(
+      api, tls,
+      [&random_generator](Event::Dispatcher& dispatcher, HostConstSharedPtr host,
+                          ResourcePriority priority,
+                          const Network::ConnectionSocket::OptionsSharedPtr& options,
+                          const Network::TransportSocketOptionsSharedPtr& transport_socket_options,
+                          ClusterConnectivityState& state) {
+        return Http::Http2::allocateConnPool(dispatcher, random_generator, std::move(host),
+                                             priority, options, transport_socket_options, state);
+      });
+}
+
+bool ProdClusterManagerFactory::sharesHttp2Connections(
+    const envoy::config::bootstrap::v3::Bootstrap& bootstrap) {
+  for (const auto& cluster : bootstrap.static_resources().clusters()) {
+    if (cluster.connection_pool_per_downstream_connection()) {
+      continue;
+    }
+    for (const auto& it : cluster.typed_extension_protocol_options()) {
+      if (!it.second.Is<envoy::extensions::upstreams::http::v3::HttpProtocolOptions>()) {
+        continue;
+      }
+      const auto options =
+          MessageUtil::anyConvert<envoy::extensions::upstreams::http::v3::HttpProtocolOptions>(
+              it.second);
+      if (options.shared_http2_connection_pool()) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 Tcp::ConnectionPool::InstancePtr ProdClusterManagerFactory::allocateTcpConnPool(
     Event::Dispatcher& dispatcher, HostConstSharedPtr host, ResourcePriority priority,
     const Network::ConnectionSocket::OptionsSharedPtr& options,
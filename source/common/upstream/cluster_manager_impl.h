@@ -30,6 +30,7 @@
 #include "common/config/grpc_mux_impl.h"
 #include "common/config/subscription_factory_impl.h"
 #include "common/http/async_client_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
 #include "common/upstream/load_stats_reporter.h"
 #include "common/upstream/priority_conn_pool_map.h"
 #include "common/upstream/upstream_impl.h"
@@ -52,13 +53,29 @@ public:
                             Http::Context& http_context, Grpc::Context& grpc_context,
                             Router::Context& router_context,
                             AccessLog::AccessLogManager& log_manager,
-                            Singleton::Manager& singleton_manager, const Server::Options& options)
+                            Singleton::Manager& singleton_manager, const Server::Options& options,
+                            Http::Http2::SharedConnPoolThreadSharedPtr shared_conn_pool_thread = {})
       : main_thread_dispatcher_(main_thread_dispatcher), validation_context_(validation_context),
         api_(api), http_context_(http_context), grpc_context_(grpc_context),
         router_context_(router_context), admin_(admin), runtime_(runtime), stats_(stats), tls_(tls),
         dns_resolver_(dns_resolver), ssl_context_manager_(ssl_context_manager),
         local_info_(local_info), secret_manager_(secret_manager), log_manager_(log_manager),
-        singleton_manager_(singleton_manager), options_(options) {}
+        singleton_manager_(singleton_manager), options_(options),
+        shared_conn_pool_thread_(std::move(shared_conn_pool_thread)) {}
+
+  /**
+   * Creates the thread running the HTTP/2 connections shared by all workers. Must be called on the
+   * main thread along with the creation of the workers, as the thread registers for thread local
+   * storage. The caller owns the thread and must shut it down before thread local storage.
+   */
+  static Http::Http2::SharedConnPoolThreadSharedPtr
+  createSharedConnPoolThread(Api::Api& api, ThreadLocal::Instance& tls);
+
+  /**
+   * @return whether a static cluster of the bootstrap shares its HTTP/2 connections between the
+   *         workers, i.e. whether the server needs the thread of createSharedConnPoolThread().
+   */
+  static bool sharesHttp2Connections(const envoy::config::bootstrap::v3::Bootstrap& bootstrap);
 
   // Upstream::ClusterManagerFactory
   ClusterManagerPtr
@@ -100,6 +117,8 @@ protected:
   AccessLog::AccessLogManager& log_manager_;
   Singleton::Manager& singleton_manager_;
   const Server::Options& options_;
+  // Null if the clusters can't share HTTP/2 connections across workers, e.g. when validating.
+  Http::Http2::SharedConnPoolThreadSharedPtr shared_conn_pool_thread_;
 };
 
 // For friend declaration in ClusterManagerInitHelper.
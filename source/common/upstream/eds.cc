@@ -11,6 +11,9 @@
 #include "common/config/api_version.h"
 #include "common/config/decoded_resource_impl.h"
 #include "common/config/version_converter.h"
+#include "common/config/xds_resource.h"
+
+#include "absl/container/flat_hash_set.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -27,7 +30,9 @@ EdsClusterImpl::EdsClusterImpl(
       local_info_(factory_context.localInfo()),
       cluster_name_(cluster.eds_cluster_config().service_name().empty()
                         ? cluster.name()
-                        : cluster.eds_cluster_config().service_name()) {
+                        : cluster.eds_cluster_config().service_name()),
+      endpoints_collection_(!cluster.eds_cluster_config().endpoints_resources_locator().empty()),
+      endpoints_resource_decoder_(factory_context.messageValidationVisitor(), "") {
   Event::Dispatcher& dispatcher = factory_context.dispatcher();
   assignment_timeout_ = dispatcher.createTimer([this]() -> void { onAssignmentTimeout(); });
   const auto& eds_config = cluster.eds_cluster_config().eds_config();
@@ -37,6 +42,17 @@ EdsClusterImpl::EdsClusterImpl(
   } else {
     initialize_phase_ = InitializePhase::Secondary;
   }
+  if (endpoints_collection_) {
+    subscription_ =
+        factory_context.clusterManager().subscriptionFactory().collectionSubscriptionFromUrl(
+            Config::XdsResourceIdentifier::decodeUrl(
+                cluster.eds_cluster_config().endpoints_resources_locator()),
+            eds_config,
+            Config::getResourceName<envoy::config::endpoint::v3::LocalityLbEndpoints>(
+                eds_config.resource_api_version()),
+            info_->statsScope(), *this, endpoints_resource_decoder_);
+    return;
+  }
   const auto resource_name = getResourceName();
   subscription_ =
       factory_context.clusterManager().subscriptionFactory().subscriptionFromConfigSource(
@@ -44,7 +60,13 @@ EdsClusterImpl::EdsClusterImpl(
           resource_decoder_, false);
 }
 
-void EdsClusterImpl::startPreInit() { subscription_->start({cluster_name_}); }
+void EdsClusterImpl::startPreInit() {
+  if (endpoints_collection_) {
+    subscription_->start({});
+  } else {
+    subscription_->start({cluster_name_});
+  }
+}
 
 void EdsClusterImpl::BatchUpdateHelper::batchUpdate(PrioritySet::HostUpdateCb& host_update_cb) {
   absl::flat_hash_map<std::string, HostSharedPtr> updated_hosts;
@@ -114,8 +136,49 @@ void EdsClusterImpl::BatchUpdateHelper::batchUpdate(PrioritySet::HostUpdateCb& h
   parent_.onPreInitComplete();
 }
 
+void EdsClusterImpl::EndpointsBatchUpdateHelper::batchUpdate(
+    PrioritySet::HostUpdateCb& host_update_cb) {
+  std::vector<PriorityUpdate> updates;
+  // Removals go first, so that a resource both removed and added by an update is added back.
+  for (const auto& name : removed_resources_) {
+    parent_.removeEndpointsResource(name, updates);
+  }
+  for (auto& resource : added_resources_) {
+    parent_.addEndpointsResource(resource.first, std::move(resource.second), updates);
+  }
+
+  bool cluster_rebuilt = false;
+  for (size_t priority = 0; priority < updates.size(); ++priority) {
+    if (updates[priority].updated_) {
+      parent_.updatePriorityLocalities(priority, updates[priority], host_update_cb);
+      cluster_rebuilt = true;
+    }
+  }
+
+  if (!cluster_rebuilt) {
+    parent_.info_->stats().update_no_rebuild_.inc();
+  }
+
+  parent_.onPreInitComplete();
+}
+
 void EdsClusterImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef>& resources,
                                     const std::string&) {
+  if (endpoints_collection_) {
+    // The resources missing from the collection were removed.
+    absl::flat_hash_set<absl::string_view> names;
+    for (const auto& resource : resources) {
+      names.insert(resource.get().name());
+    }
+    Protobuf::RepeatedPtrField<std::string> removed_resources;
+    for (const auto& resource : endpoints_resources_) {
+      if (!names.contains(resource.first)) {
+        *removed_resources.Add() = resource.first;
+      }
+    }
+    onEndpointsUpdate(resources, removed_resources);
+    return;
+  }
   if (!validateUpdateSize(resources.size())) {
     return;
   }
@@ -147,15 +210,197 @@ void EdsClusterImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef
   priority_set_.batchHostUpdate(helper);
 }
 
-void EdsClusterImpl::onConfigUpdate(const std::vector<Config::DecodedResourceRef>& added_resources,
-                                    const Protobuf::RepeatedPtrField<std::string>&,
-                                    const std::string&) {
+void EdsClusterImpl::onConfigUpdate(
+    const std::vector<Config::DecodedResourceRef>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources, const std::string&) {
+  if (endpoints_collection_) {
+    onEndpointsUpdate(added_resources, removed_resources);
+    return;
+  }
   if (!validateUpdateSize(added_resources.size())) {
     return;
   }
   onConfigUpdate(added_resources, added_resources[0].get().version());
 }
 
+void EdsClusterImpl::onEndpointsUpdate(
+    const std::vector<Config::DecodedResourceRef>& added_resources,
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources) {
+  // The hosts of the added resources are created before any change is made, as the validation of
+  // the endpoints may throw.
+  std::vector<std::pair<std::string, EndpointsResource>> resources;
+  for (const auto& resource : added_resources) {
+    const auto existing = endpoints_resources_.find(resource.get().name());
+    if (existing != endpoints_resources_.end() && !resource.get().version().empty() &&
+        existing->second.version_ == resource.get().version()) {
+      continue;
+    }
+    const auto& locality_lb_endpoint =
+        dynamic_cast<const envoy::config::endpoint::v3::LocalityLbEndpoints&>(
+            resource.get().resource());
+    validateEndpointsForZoneAwareRouting(locality_lb_endpoint);
+
+    EndpointsResource endpoints_resource;
+    endpoints_resource.version_ = resource.get().version();
+    endpoints_resource.priority_ = locality_lb_endpoint.priority();
+    endpoints_resource.locality_ = locality_lb_endpoint.locality();
+    if (locality_lb_endpoint.has_locality() && locality_lb_endpoint.has_load_balancing_weight()) {
+      endpoints_resource.locality_weight_ = locality_lb_endpoint.load_balancing_weight().value();
+    }
+    for (const auto& lb_endpoint : locality_lb_endpoint.lb_endpoints()) {
+      auto metadata = lb_endpoint.has_metadata()
+                          ? constMetadataSharedPool()->getObject(lb_endpoint.metadata())
+                          : nullptr;
+      endpoints_resource.hosts_.emplace_back(std::make_shared<HostImpl>(
+          info_, lb_endpoint.endpoint().hostname(),
+          resolveProtoAddress(lb_endpoint.endpoint().address()), metadata,
+          lb_endpoint.load_balancing_weight().value(), locality_lb_endpoint.locality(),
+          lb_endpoint.endpoint().health_check_config(), locality_lb_endpoint.priority(),
+          lb_endpoint.health_status(), time_source_));
+    }
+    resources.emplace_back(resource.get().name(), std::move(endpoints_resource));
+  }
+
+  EndpointsBatchUpdateHelper helper(*this, std::move(resources), removed_resources);
+  priority_set_.batchHostUpdate(helper);
+}
+
+void EdsClusterImpl::removeEndpointsResource(const std::string& name,
+                                             std::vector<PriorityUpdate>& updates) {
+  const auto it = endpoints_resources_.find(name);
+  if (it == endpoints_resources_.end()) {
+    return;
+  }
+  const EndpointsResource& resource = it->second;
+  if (updates.size() <= resource.priority_) {
+    updates.resize(resource.priority_ + 1);
+  }
+  PriorityUpdate& update = updates[resource.priority_];
+  update.updated_ = true;
+  update.hosts_removed_.insert(update.hosts_removed_.end(), resource.hosts_.begin(),
+                               resource.hosts_.end());
+
+  PriorityLocalities& localities = priority_localities_[resource.priority_];
+  const auto locality = localities.find(resource.locality_);
+  ASSERT(locality != localities.end());
+  locality->second.erase(name);
+  if (locality->second.empty()) {
+    localities.erase(locality);
+  }
+  endpoints_resources_.erase(it);
+}
+
+void EdsClusterImpl::addEndpointsResource(const std::string& name, EndpointsResource&& resource,
+                                          std::vector<PriorityUpdate>& updates) {
+  // The hosts of the previous version of the resource are updated in place when their address is
+  // unchanged, provided that the resource stays in the same priority and locality.
+  absl::flat_hash_map<std::string, HostSharedPtr> existing_hosts;
+  bool updated_in_place = false;
+  bool locality_weight_changed = false;
+  const auto existing = endpoints_resources_.find(name);
+  if (existing != endpoints_resources_.end()) {
+    if (existing->second.priority_ == resource.priority_ &&
+        LocalityEqualTo()(existing->second.locality_, resource.locality_)) {
+      for (const HostSharedPtr& host : existing->second.hosts_) {
+        existing_hosts.emplace(host->address()->asString(), host);
+      }
+      updated_in_place = true;
+      locality_weight_changed = existing->second.locality_weight_ != resource.locality_weight_;
+    } else {
+      removeEndpointsResource(name, updates);
+    }
+  }
+
+  if (updates.size() <= resource.priority_) {
+    updates.resize(resource.priority_ + 1);
+  }
+  PriorityUpdate& update = updates[resource.priority_];
+  update.updated_ |= !updated_in_place || locality_weight_changed;
+  for (HostSharedPtr& host : resource.hosts_) {
+    const auto existing_host = existing_hosts.find(host->address()->asString());
+    if (existing_host != existing_hosts.end() &&
+        (health_checker_ == nullptr ||
+         *existing_host->second->healthCheckAddress() == *host->healthCheckAddress())) {
+      update.updated_ |= updateExistingHost(*host, *existing_host->second);
+      host = existing_host->second;
+      existing_hosts.erase(existing_host);
+      continue;
+    }
+
+    // If we are depending on a health checker, we initialize to unhealthy.
+    if (health_checker_ != nullptr) {
+      host->healthFlagSet(Host::HealthFlag::FAILED_ACTIVE_HC);
+      if (info_->warmHosts()) {
+        host->healthFlagSet(Host::HealthFlag::PENDING_ACTIVE_HC);
+      }
+    }
+    update.updated_ = true;
+    update.hosts_added_.push_back(host);
+  }
+  for (const auto& existing_host : existing_hosts) {
+    update.updated_ = true;
+    update.hosts_removed_.push_back(existing_host.second);
+  }
+
+  if (priority_localities_.size() <= resource.priority_) {
+    priority_localities_.resize(resource.priority_ + 1);
+  }
+  // The resource keeps its node when updated, and so its place in the localities.
+  const EndpointsResource& added =
+      endpoints_resources_.insert_or_assign(name, std::move(resource)).first->second;
+  priority_localities_[added.priority_][added.locality_].emplace(name, &added);
+}
+
+void EdsClusterImpl::updatePriorityLocalities(uint32_t priority, PriorityUpdate& update,
+                                              PrioritySet::HostUpdateCb& host_update_cb) {
+  const PriorityLocalities& localities = priority_localities_[priority];
+  const auto& local_locality = local_info_.node().locality();
+  const bool non_empty_local_locality =
+      local_info_.node().has_locality() && localities.find(local_locality) != localities.end();
+
+  HostVectorSharedPtr hosts = std::make_shared<HostVector>();
+  std::vector<HostVector> per_locality;
+  LocalityWeightsSharedPtr locality_weights;
+  if (info_->lbConfig().has_locality_weighted_lb_config()) {
+    locality_weights = std::make_shared<LocalityWeights>();
+  }
+  const auto add_locality = [&](const LocalityResources& resources) {
+    HostVector locality_hosts;
+    absl::optional<uint32_t> locality_weight;
+    for (const auto& resource : resources) {
+      if (!locality_weight.has_value()) {
+        locality_weight = resource.second->locality_weight_;
+      }
+      locality_hosts.insert(locality_hosts.end(), resource.second->hosts_.begin(),
+                            resource.second->hosts_.end());
+    }
+    hosts->insert(hosts->end(), locality_hosts.begin(), locality_hosts.end());
+    per_locality.emplace_back(std::move(locality_hosts));
+    if (locality_weights != nullptr) {
+      locality_weights->emplace_back(locality_weight.value_or(0));
+    }
+  };
+
+  // As per HostsPerLocality::get(), the hosts of the local locality go first, followed by the
+  // other localities in lexicographic order.
+  if (non_empty_local_locality) {
+    add_locality(localities.find(local_locality)->second);
+  }
+  for (const auto& locality : localities) {
+    if (!non_empty_local_locality || !LocalityEqualTo()(local_locality, locality.first)) {
+      add_locality(locality.second);
+    }
+  }
+
+  ENVOY_LOG(debug, "EDS endpoints changed for cluster: {} priority {} added {} removed {}",
+            info_->name(), priority, update.hosts_added_.size(), update.hosts_removed_.size());
+  auto per_locality_shared =
+      std::make_shared<HostsPerLocalityImpl>(std::move(per_locality), non_empty_local_locality);
+  host_update_cb.updateHosts(priority, HostSetImpl::partitionHosts(hosts, per_locality_shared),
+                             std::move(locality_weights), update.hosts_added_,
+                             update.hosts_removed_, absl::nullopt);
+}
+
 bool EdsClusterImpl::validateUpdateSize(int num_resources) {
   if (num_resources == 0) {
     ENVOY_LOG(debug, "Missing ClusterLoadAssignment for {} in onConfigUpdate()", cluster_name_);
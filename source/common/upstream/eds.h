@@ -1,6 +1,9 @@
 #pragma once
 
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/config/core/v3/base.pb.h"
@@ -21,6 +24,9 @@
 
 #include "extensions/clusters/well_known_names.h"
 
+#include "absl/container/node_hash_map.h"
+#include "absl/types/optional.h"
+
 namespace Envoy {
 namespace Upstream {
 
@@ -56,6 +62,35 @@ private:
                               const absl::flat_hash_set<std::string>& all_new_hosts);
   bool validateUpdateSize(int num_resources);
 
+  // A resource of the endpoints collection, with the hosts of its endpoints.
+  struct EndpointsResource {
+    std::string version_;
+    uint32_t priority_{};
+    envoy::config::core::v3::Locality locality_;
+    absl::optional<uint32_t> locality_weight_;
+    HostVector hosts_;
+  };
+
+  // The resources of a locality, ordered by name for a stable order of the hosts.
+  using LocalityResources = std::map<std::string, const EndpointsResource*>;
+  using PriorityLocalities =
+      std::map<envoy::config::core::v3::Locality, LocalityResources, LocalityLess>;
+
+  // The changes made to a priority by an update of the endpoints collection.
+  struct PriorityUpdate {
+    bool updated_{};
+    HostVector hosts_added_;
+    HostVector hosts_removed_;
+  };
+
+  void onEndpointsUpdate(const std::vector<Config::DecodedResourceRef>& added_resources,
+                         const Protobuf::RepeatedPtrField<std::string>& removed_resources);
+  void removeEndpointsResource(const std::string& name, std::vector<PriorityUpdate>& updates);
+  void addEndpointsResource(const std::string& name, EndpointsResource&& resource,
+                            std::vector<PriorityUpdate>& updates);
+  void updatePriorityLocalities(uint32_t priority, PriorityUpdate& update,
+                                PrioritySet::HostUpdateCb& host_update_cb);
+
   // ClusterImplBase
   void reloadHealthyHostsHelper(const HostSharedPtr& host) override;
   void startPreInit() override;
@@ -76,6 +111,26 @@ private:
     const envoy::config::endpoint::v3::ClusterLoadAssignment& cluster_load_assignment_;
   };
 
+  // Applies an update of the endpoints collection, touching only the priorities and the hosts of
+  // the resources it adds, updates or removes.
+  class EndpointsBatchUpdateHelper : public PrioritySet::BatchUpdateCb {
+  public:
+    EndpointsBatchUpdateHelper(
+        EdsClusterImpl& parent,
+        std::vector<std::pair<std::string, EndpointsResource>>&& added_resources,
+        const Protobuf::RepeatedPtrField<std::string>& removed_resources)
+        : parent_(parent), added_resources_(std::move(added_resources)),
+          removed_resources_(removed_resources) {}
+
+    // Upstream::PrioritySet::BatchUpdateCb
+    void batchUpdate(PrioritySet::HostUpdateCb& host_update_cb) override;
+
+  private:
+    EdsClusterImpl& parent_;
+    std::vector<std::pair<std::string, EndpointsResource>> added_resources_;
+    const Protobuf::RepeatedPtrField<std::string>& removed_resources_;
+  };
+
   Config::SubscriptionPtr subscription_;
   const LocalInfo::LocalInfo& local_info_;
   const std::string cluster_name_;
@@ -83,6 +138,15 @@ private:
   HostMap all_hosts_;
   Event::TimerPtr assignment_timeout_;
   InitializePhase initialize_phase_;
+  // Set when the endpoints are read from a collection of LocalityLbEndpoints resources rather than
+  // from a ClusterLoadAssignment.
+  const bool endpoints_collection_;
+  Config::OpaqueResourceDecoderImpl<envoy::config::endpoint::v3::LocalityLbEndpoints>
+      endpoints_resource_decoder_;
+  // The resources of the endpoints collection, by name.
+  absl::node_hash_map<std::string, EndpointsResource> endpoints_resources_;
+  // The localities of each priority of the endpoints collection.
+  std::vector<PriorityLocalities> priority_localities_;
 };
 
 using EdsClusterImplSharedPtr = std::shared_ptr<EdsClusterImpl>;
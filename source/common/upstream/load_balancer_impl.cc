@@ -11,6 +11,7 @@
 
 #include "common/common/assert.h"
 #include "common/protobuf/utility.h"
+#include "common/runtime/runtime_features.h"
 
 #include "absl/container/fixed_array.h"
 
@@ -715,9 +716,16 @@ void EdfLoadBalancerBase::initialize() {
 }
 
 void EdfLoadBalancerBase::refresh(uint32_t priority) {
-  const auto add_hosts_source = [this](HostsSource source, const HostVector& hosts) {
-    // Nuke existing scheduler if it exists.
-    auto& scheduler = scheduler_[source] = Scheduler{};
+  const bool use_stride_scheduler =
+      staticHostWeights() &&
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.upstream_stride_scheduler");
+  const auto add_hosts_source = [this, use_stride_scheduler](HostsSource source,
+                                                             const HostVector& hosts) {
+    // Nuke existing scheduler if it exists, except for a stride scheduler which is updated in
+    // place below.
+    auto& scheduler = scheduler_[source];
+    std::unique_ptr<StrideScheduler<const Host>> stride = std::move(scheduler.stride_);
+    scheduler = Scheduler{};
     refreshHostSource(source);
 
     // Check if the original host weights are equal and skip EDF creation if they are. When all
@@ -728,6 +736,22 @@ void EdfLoadBalancerBase::refresh(uint32_t priority) {
       return;
     }
 
+    if (use_stride_scheduler) {
+      if (stride == nullptr) {
+        stride = std::make_unique<StrideScheduler<const Host>>();
+        // Start at an offset, as is done for EDF below, but without having to pick.
+        stride->advance(seed_);
+      }
+      // Hosts already present keep their place in the schedule, so this costs O(n) hash lookups
+      // rather than an O(n * log n) rebuild.
+      stride->update(hosts, [this](const Host& host) { return hostWeight(host); });
+      if (stride->expectedPickCost() <= MaxStridePickCost) {
+        scheduler.stride_ = std::move(stride);
+        return;
+      }
+      // The weights are too far apart for fast stride picks, so fall back to EDF.
+    }
+
     scheduler.edf_ = std::make_unique<EdfScheduler<const Host>>();
 
     // Populate scheduler with host list.
@@ -795,7 +819,9 @@ HostConstSharedPtr EdfLoadBalancerBase::peekAnotherHost(LoadBalancerContext* con
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original weights
   // of 2 or more hosts differ.
-  if (scheduler.edf_ != nullptr) {
+  if (scheduler.stride_ != nullptr) {
+    return scheduler.stride_->peekAgain([this](const Host& host) { return hostWeight(host); });
+  } else if (scheduler.edf_ != nullptr) {
     return scheduler.edf_->peekAgain([this](const Host& host) { return hostWeight(host); });
   } else {
     const HostVector& hosts_to_use = hostSourceToHosts(*hosts_source);
@@ -821,7 +847,9 @@ HostConstSharedPtr EdfLoadBalancerBase::chooseHostOnce(LoadBalancerContext* cont
   // BaseDynamicClusterImpl::updateDynamicHostList, we must do a runtime pivot here to determine
   // whether to use EDF or do unweighted (fast) selection. EDF is non-null iff the original weights
   // of 2 or more hosts differ.
-  if (scheduler.edf_ != nullptr) {
+  if (scheduler.stride_ != nullptr) {
+    return scheduler.stride_->pickAndAdd([this](const Host& host) { return hostWeight(host); });
+  } else if (scheduler.edf_ != nullptr) {
     auto host = scheduler.edf_->pickAndAdd([this](const Host& host) { return hostWeight(host); });
     return host;
   } else {
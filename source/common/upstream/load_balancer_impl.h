@@ -17,6 +17,7 @@
 #include "common/protobuf/utility.h"
 #include "common/runtime/runtime_protos.h"
 #include "common/upstream/edf_scheduler.h"
+#include "common/upstream/stride_scheduler.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -365,10 +366,11 @@ private:
  * interval. Naive implementations of weighted RR are either O(n) pick time or O(m * n) memory use,
  * where m is the weight range. We also explicitly check for the unweighted special case and use a
  * simple index to achieve O(1) scheduling in that case.
- * TODO(htuch): We use EDF at Google, but the EDF scheduler may be overkill if we don't want to
- * support large ranges of weights or arbitrary precision floating weights, we could construct an
- * explicit schedule, since m will be a small constant factor in O(m * n). This
- * could also be done on a thread aware LB, avoiding creating multiple EDF
+ * When the envoy.reloadable_features.upstream_stride_scheduler runtime feature is enabled and
+ * host weights only change on refresh, a StrideScheduler is used instead, with O(1) expected pick
+ * time for a bounded range of weights and updated in place on refresh rather than rebuilt. EDF is
+ * still used when the range of weights would make stride picks too slow.
+ * TODO(htuch): This could also be done on a thread aware LB, avoiding creating multiple EDF
  * instances.
  *
  * This base class also supports unweighted selection which derived classes can use to customize
@@ -391,6 +393,8 @@ protected:
     // host weights of 2 or more hosts differ. When not present, the
     // implementation of chooseHostOnce falls back to unweightedHostPick.
     std::unique_ptr<EdfScheduler<const Host>> edf_;
+    // StrideScheduler used instead of edf_ when enabled, see refresh().
+    std::unique_ptr<StrideScheduler<const Host>> stride_;
   };
 
   void initialize();
@@ -405,8 +409,14 @@ protected:
   const uint64_t seed_;
 
 private:
+  // The largest average number of steps of a StrideScheduler pick for it to be used over EDF.
+  static constexpr double MaxStridePickCost = 8;
+
   virtual void refreshHostSource(const HostsSource& source) PURE;
   virtual double hostWeight(const Host& host) PURE;
+  // Whether hostWeight() only changes when the hosts are refreshed, which the StrideScheduler
+  // requires.
+  virtual bool staticHostWeights() const PURE;
   virtual HostConstSharedPtr unweightedHostPeek(const HostVector& hosts_to_use,
                                                 const HostsSource& source) PURE;
   virtual HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
@@ -443,6 +453,7 @@ private:
     peekahead_index_ = 0;
   }
   double hostWeight(const Host& host) override { return host.weight(); }
+  bool staticHostWeights() const override { return true; }
   HostConstSharedPtr unweightedHostPeek(const HostVector& hosts_to_use,
                                         const HostsSource& source) override {
     auto i = rr_indexes_.find(source);
@@ -553,6 +564,7 @@ private:
     return static_cast<double>(host.weight()) /
            std::pow(host.stats().rq_active_.value() + 1, active_request_bias_);
   }
+  bool staticHostWeights() const override { return active_request_bias_ == 0.0; }
   HostConstSharedPtr unweightedHostPeek(const HostVector& hosts_to_use,
                                         const HostsSource& source) override;
   HostConstSharedPtr unweightedHostPick(const HostVector& hosts_to_use,
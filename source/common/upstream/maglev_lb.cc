@@ -1,39 +1,73 @@
 #include "common/upstream/maglev_lb.h"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <numeric>
+
 #include "envoy/config/cluster/v3/cluster.pb.h"
 
+#include "common/runtime/runtime_features.h"
+
+#include "absl/container/flat_hash_map.h"
+
 namespace Envoy {
 namespace Upstream {
 
 MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weights,
                          double max_normalized_weight, uint64_t table_size,
-                         bool use_hostname_for_hashing, MaglevLoadBalancerStats& stats)
-    : table_size_(table_size), stats_(stats) {
+                         bool use_hostname_for_hashing, MaglevLoadBalancerStats& stats,
+                         const MaglevTable* previous)
+    : table_size_(table_size), use_hostname_for_hashing_(use_hostname_for_hashing),
+      stats_(stats) {
   // We can't do anything sensible with no hosts.
   if (normalized_host_weights.empty()) {
     ENVOY_LOG(debug, "maglev: normalized hosts weights is empty, skipping building table");
     return;
   }
 
+  hosts_.reserve(normalized_host_weights.size());
+  for (const auto& host_weight : normalized_host_weights) {
+    hosts_.push_back(host_weight.first);
+  }
+
+  if (previous == nullptr || !update(normalized_host_weights, *previous)) {
+    build(normalized_host_weights, max_normalized_weight);
+  }
+
+  if (ENVOY_LOG_CHECK_LEVEL(trace)) {
+    for (uint64_t i = 0; i < table_.size(); i++) {
+      const HostConstSharedPtr& host = hosts_[table_[i]];
+      ENVOY_LOG(trace, "maglev: i={} host={}", i,
+                use_hostname_for_hashing ? host->hostname() : host->address()->asString());
+    }
+  }
+}
+
+MaglevTable::TableBuildEntry MaglevTable::buildEntry(uint32_t host_index, double weight) const {
+  const HostConstSharedPtr& host = hosts_[host_index];
+  const std::string& address =
+      use_hostname_for_hashing_ ? host->hostname() : host->address()->asString();
+  ASSERT(!address.empty());
+  return {host_index, HashUtil::xxHash64(address) % table_size_,
+          (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1, weight};
+}
+
+void MaglevTable::build(const NormalizedHostWeightVector& normalized_host_weights,
+                        double max_normalized_weight) {
   // Implementation of pseudocode listing 1 in the paper (see header file for more info).
   std::vector<TableBuildEntry> table_build_entries;
   table_build_entries.reserve(normalized_host_weights.size());
-  for (const auto& host_weight : normalized_host_weights) {
-    const auto& host = host_weight.first;
-    const std::string& address =
-        use_hostname_for_hashing ? host->hostname() : host->address()->asString();
-    ASSERT(!address.empty());
-    table_build_entries.emplace_back(host, HashUtil::xxHash64(address) % table_size_,
-                                     (HashUtil::xxHash64(address, 1) % (table_size_ - 1)) + 1,
-                                     host_weight.second);
+  for (uint32_t i = 0; i < normalized_host_weights.size(); ++i) {
+    table_build_entries.push_back(buildEntry(i, normalized_host_weights[i].second));
   }
 
-  table_.resize(table_size_);
+  table_.assign(table_size_, NoHost);
 
   // Iterate through the table build entries as many times as it takes to fill up the table.
   uint64_t table_index = 0;
   for (uint32_t iteration = 1; table_index < table_size_; ++iteration) {
-    for (uint64_t i = 0; i < table_build_entries.size() && table_index < table_size; i++) {
+    for (uint64_t i = 0; i < table_build_entries.size() && table_index < table_size_; i++) {
       TableBuildEntry& entry = table_build_entries[i];
       // To understand how target_weight_ and weight_ are used below, consider a host with weight
       // equal to max_normalized_weight. This would be picked on every single iteration. If it had
@@ -44,12 +78,12 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
       }
       entry.target_weight_ += max_normalized_weight;
       uint64_t c = permutation(entry);
-      while (table_[c] != nullptr) {
+      while (table_[c] != NoHost) {
         entry.next_++;
         c = permutation(entry);
       }
 
-      table_[c] = entry.host_;
+      table_[c] = entry.host_index_;
       entry.next_++;
       entry.count_++;
       table_index++;
@@ -64,14 +98,115 @@ MaglevTable::MaglevTable(const NormalizedHostWeightVector& normalized_host_weigh
   }
   stats_.min_entries_per_host_.set(min_entries_per_host);
   stats_.max_entries_per_host_.set(max_entries_per_host);
+}
 
-  if (ENVOY_LOG_CHECK_LEVEL(trace)) {
-    for (uint64_t i = 0; i < table_.size(); i++) {
-      ENVOY_LOG(trace, "maglev: i={} host={}", i,
-                use_hostname_for_hashing ? table_[i]->hostname()
-                                         : table_[i]->address()->asString());
+bool MaglevTable::update(const NormalizedHostWeightVector& normalized_host_weights,
+                         const MaglevTable& previous) {
+  // Every host must get an entry, which a full build handles by filling the table in order.
+  if (previous.table_.empty() || previous.table_size_ != table_size_ ||
+      hosts_.size() > table_size_) {
+    return false;
+  }
+
+  // The number of entries each host should have, in proportion to its weight but at least one,
+  // as with a full build. The rounding remainders go to the hosts with the largest fractions.
+  double total_weight = 0;
+  for (const auto& host_weight : normalized_host_weights) {
+    total_weight += host_weight.second;
+  }
+  std::vector<uint64_t> targets(hosts_.size());
+  std::vector<std::pair<double, uint32_t>> fractions;
+  fractions.reserve(hosts_.size());
+  int64_t unassigned = table_size_;
+  for (uint32_t i = 0; i < hosts_.size(); ++i) {
+    const double share = normalized_host_weights[i].second / total_weight * table_size_;
+    targets[i] = std::max<uint64_t>(1, std::floor(share));
+    unassigned -= targets[i];
+    fractions.emplace_back(share - std::floor(share), i);
+  }
+  if (unassigned > 0) {
+    std::sort(fractions.begin(), fractions.end(), std::greater<>());
+    for (uint64_t i = 0; unassigned > 0; i = (i + 1) % fractions.size(), --unassigned) {
+      ++targets[fractions[i].second];
+    }
+  } else if (unassigned < 0) {
+    // Hosts raised to one entry are paid for by the hosts with the most entries.
+    std::vector<uint32_t> by_target(hosts_.size());
+    std::iota(by_target.begin(), by_target.end(), 0);
+    std::sort(by_target.begin(), by_target.end(),
+              [&targets](uint32_t a, uint32_t b) { return targets[a] > targets[b]; });
+    for (uint32_t i = 0; unassigned < 0; ++i) {
+      const uint64_t taken = std::min<uint64_t>(targets[by_target[i]] - 1, -unassigned);
+      targets[by_target[i]] -= taken;
+      unassigned += taken;
     }
   }
+
+  // Carry over the entries of the hosts which remain, freeing those of removed hosts.
+  absl::flat_hash_map<const Host*, uint32_t> host_indices;
+  host_indices.reserve(hosts_.size());
+  for (uint32_t i = 0; i < hosts_.size(); ++i) {
+    host_indices.emplace(hosts_[i].get(), i);
+  }
+  std::vector<uint32_t> previous_to_current(previous.hosts_.size(), NoHost);
+  for (uint32_t i = 0; i < previous.hosts_.size(); ++i) {
+    auto it = host_indices.find(previous.hosts_[i].get());
+    if (it != host_indices.end()) {
+      previous_to_current[i] = it->second;
+    }
+  }
+  std::vector<uint64_t> counts(hosts_.size());
+  table_.resize(table_size_);
+  for (uint64_t i = 0; i < table_size_; ++i) {
+    table_[i] = previous_to_current[previous.table_[i]];
+    if (table_[i] != NoHost) {
+      ++counts[table_[i]];
+    }
+  }
+
+  // Free the entries of hosts above their share.
+  for (uint64_t i = 0; i < table_size_; ++i) {
+    const uint32_t host_index = table_[i];
+    if (host_index != NoHost && counts[host_index] > targets[host_index]) {
+      table_[i] = NoHost;
+      --counts[host_index];
+    }
+  }
+
+  // Hosts below their share take free entries following their permutation, one at a time in
+  // turn as in a full build. The free entries are exactly the missing ones.
+  std::vector<TableBuildEntry> table_build_entries;
+  for (uint32_t i = 0; i < hosts_.size(); ++i) {
+    if (counts[i] < targets[i]) {
+      table_build_entries.push_back(buildEntry(i, normalized_host_weights[i].second));
+    }
+  }
+  uint64_t reassigned = 0;
+  while (!table_build_entries.empty()) {
+    for (auto it = table_build_entries.begin(); it != table_build_entries.end();) {
+      TableBuildEntry& entry = *it;
+      uint64_t c = permutation(entry);
+      while (table_[c] != NoHost) {
+        entry.next_++;
+        c = permutation(entry);
+      }
+      table_[c] = entry.host_index_;
+      entry.next_++;
+      ++reassigned;
+      if (++counts[entry.host_index_] == targets[entry.host_index_]) {
+        it = table_build_entries.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  ENVOY_LOG(debug, "maglev: updated table, reassigned {} of {} entries", reassigned, table_size_);
+
+  const auto [min_entries_per_host, max_entries_per_host] =
+      std::minmax_element(counts.begin(), counts.end());
+  stats_.min_entries_per_host_.set(*min_entries_per_host);
+  stats_.max_entries_per_host_.set(*max_entries_per_host);
+  return true;
 }
 
 HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash, uint32_t attempt) const {
@@ -86,7 +221,7 @@ HostConstSharedPtr MaglevTable::chooseHost(uint64_t hash, uint32_t attempt) cons
     hash ^= ~0ULL - attempt + 1;
   }
 
-  return table_[hash % table_size_];
+  return hosts_[table_[hash % table_size_]];
 }
 
 uint64_t MaglevTable::permutation(const TableBuildEntry& entry) {
@@ -116,6 +251,29 @@ MaglevLoadBalancer::MaglevLoadBalancer(
   }
 }
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+MaglevLoadBalancer::createLoadBalancer(uint32_t priority,
+                                       const NormalizedHostWeightVector& normalized_host_weights,
+                                       double, double max_normalized_weight) {
+  if (tables_.size() <= priority) {
+    tables_.resize(priority + 1);
+  }
+  const MaglevTable* previous =
+      Runtime::runtimeFeatureEnabled("envoy.reloadable_features.maglev_incremental_table")
+          ? tables_[priority].get()
+          : nullptr;
+  tables_[priority] =
+      std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight, table_size_,
+                                    use_hostname_for_hashing_, stats_, previous);
+
+  if (hash_balance_factor_ == 0) {
+    return tables_[priority];
+  }
+
+  return std::make_shared<BoundedLoadHashingLoadBalancer>(
+      tables_[priority], std::move(normalized_host_weights), hash_balance_factor_);
+}
+
 MaglevLoadBalancerStats MaglevLoadBalancer::generateStats(Stats::Scope& scope) {
   return {ALL_MAGLEV_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
 }
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
 #include "envoy/common/random_generator.h"
 #include "envoy/config/cluster/v3/cluster.pb.h"
 #include "envoy/stats/scope.h"
@@ -30,13 +35,23 @@ struct MaglevLoadBalancerStats {
  * https://static.googleusercontent.com/media/research.google.com/en//pubs/archive/44824.pdf
  * section 3.4. Specifically, the algorithm shown in pseudocode listing 1 is implemented with a
  * fixed table size of 65537. This is the recommended table size in section 5.3.
+ *
+ * The table holds indices into the hosts rather than the hosts, which makes it 4 bytes per entry.
+ *
+ * When built from a previous table, only the entries of removed hosts and the entries needed to
+ * move the hosts to their new share of the table are assigned again, rather than running the
+ * whole algorithm. This moves fewer keys than a full build, but the resulting table depends on
+ * the previous one, so Envoys with different update histories may map keys differently.
  */
 class MaglevTable : public ThreadAwareLoadBalancerBase::HashingLoadBalancer,
                     Logger::Loggable<Logger::Id::upstream> {
 public:
+  /**
+   * @param previous supplies the table to update, or nullptr to build the table from scratch.
+   */
   MaglevTable(const NormalizedHostWeightVector& normalized_host_weights,
               double max_normalized_weight, uint64_t table_size, bool use_hostname_for_hashing,
-              MaglevLoadBalancerStats& stats);
+              MaglevLoadBalancerStats& stats, const MaglevTable* previous = nullptr);
 
   // ThreadAwareLoadBalancerBase::HashingLoadBalancer
   HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
@@ -46,10 +61,10 @@ public:
 
 private:
   struct TableBuildEntry {
-    TableBuildEntry(const HostConstSharedPtr& host, uint64_t offset, uint64_t skip, double weight)
-        : host_(host), offset_(offset), skip_(skip), weight_(weight) {}
+    TableBuildEntry(uint32_t host_index, uint64_t offset, uint64_t skip, double weight)
+        : host_index_(host_index), offset_(offset), skip_(skip), weight_(weight) {}
 
-    HostConstSharedPtr host_;
+    const uint32_t host_index_;
     const uint64_t offset_;
     const uint64_t skip_;
     const double weight_;
@@ -58,13 +73,26 @@ private:
     uint64_t count_{};
   };
 
+  // Marks an entry without a host while the table is built.
+  static constexpr uint32_t NoHost = std::numeric_limits<uint32_t>::max();
+
+  TableBuildEntry buildEntry(uint32_t host_index, double weight) const;
+  void build(const NormalizedHostWeightVector& normalized_host_weights,
+             double max_normalized_weight);
+  bool update(const NormalizedHostWeightVector& normalized_host_weights,
+              const MaglevTable& previous);
   uint64_t permutation(const TableBuildEntry& entry);
 
   const uint64_t table_size_;
-  std::vector<HostConstSharedPtr> table_;
+  const bool use_hostname_for_hashing_;
+  std::vector<HostConstSharedPtr> hosts_;
+  // Index into hosts_ for each entry of the table.
+  std::vector<uint32_t> table_;
   MaglevLoadBalancerStats& stats_;
 };
 
+using MaglevTableConstSharedPtr = std::shared_ptr<const MaglevTable>;
+
 /**
  * Thread aware load balancer implementation for Maglev.
  */
@@ -83,19 +111,8 @@ public:
 private:
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double /* min_normalized_weight */, double max_normalized_weight) override {
-    HashingLoadBalancerSharedPtr maglev_lb =
-        std::make_shared<MaglevTable>(normalized_host_weights, max_normalized_weight, table_size_,
-                                      use_hostname_for_hashing_, stats_);
-
-    if (hash_balance_factor_ == 0) {
-      return maglev_lb;
-    }
-
-    return std::make_shared<BoundedLoadHashingLoadBalancer>(
-        maglev_lb, std::move(normalized_host_weights), hash_balance_factor_);
-  }
+  createLoadBalancer(uint32_t priority, const NormalizedHostWeightVector& normalized_host_weights,
+                     double /* min_normalized_weight */, double max_normalized_weight) override;
 
   static MaglevLoadBalancerStats generateStats(Stats::Scope& scope);
 
@@ -104,6 +121,9 @@ private:
   const uint64_t table_size_;
   const bool use_hostname_for_hashing_;
   const uint32_t hash_balance_factor_;
+  // The last table of each priority, from which the next one is built when incremental updates
+  // are enabled.
+  std::vector<MaglevTableConstSharedPtr> tables_;
 };
 
 } // namespace Upstream
@@ -1,5 +1,7 @@
 #include "common/upstream/ring_hash_lb.h"
 
+#include <algorithm>
+#include <cmath>
 #include <cstdint>
 #include <iostream>
 #include <string>
@@ -10,7 +12,10 @@
 #include "common/common/assert.h"
 #include "common/upstream/load_balancer_impl.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/container/inlined_vector.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 
 namespace Envoy {
@@ -45,12 +50,30 @@ RingHashLoadBalancer::RingHashLoadBalancer(
   }
 }
 
+ThreadAwareLoadBalancerBase::HashingLoadBalancerSharedPtr
+RingHashLoadBalancer::createLoadBalancer(uint32_t priority,
+                                         const NormalizedHostWeightVector& normalized_host_weights,
+                                         double min_normalized_weight, double) {
+  // Called for each priority on every refresh, so this also drops the rings of removed priorities.
+  rings_.resize(priority_set_.hostSetsPerPriority().size());
+  rings_[priority] = std::make_shared<Ring>(normalized_host_weights, min_normalized_weight,
+                                            min_ring_size_, max_ring_size_, hash_function_,
+                                            use_hostname_for_hashing_, stats_,
+                                            rings_[priority].get());
+  if (hash_balance_factor_ == 0) {
+    return rings_[priority];
+  }
+
+  return std::make_shared<BoundedLoadHashingLoadBalancer>(
+      rings_[priority], std::move(normalized_host_weights), hash_balance_factor_);
+}
+
 RingHashLoadBalancerStats RingHashLoadBalancer::generateStats(Stats::Scope& scope) {
   return {ALL_RING_HASH_LOAD_BALANCER_STATS(POOL_GAUGE(scope))};
 }
 
 HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t attempt) const {
-  if (ring_.empty()) {
+  if (hashes_.empty()) {
     return nullptr;
   }
 
@@ -59,18 +82,18 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t a
   // NOTE: The algorithm depends on using signed integers for lowp, midp, and highp. Do not
   //       change them!
   int64_t lowp = 0;
-  int64_t highp = ring_.size();
+  int64_t highp = hashes_.size();
   int64_t midp = 0;
   while (true) {
     midp = (lowp + highp) / 2;
 
-    if (midp == static_cast<int64_t>(ring_.size())) {
+    if (midp == static_cast<int64_t>(hashes_.size())) {
       midp = 0;
       break;
     }
 
-    uint64_t midval = ring_[midp].hash_;
-    uint64_t midval1 = midp == 0 ? 0 : ring_[midp - 1].hash_;
+    uint64_t midval = hashes_[midp];
+    uint64_t midval1 = midp == 0 ? 0 : hashes_[midp - 1];
 
     if (h <= midval && h > midval1) {
       break;
@@ -89,20 +112,61 @@ HostConstSharedPtr RingHashLoadBalancer::Ring::chooseHost(uint64_t h, uint32_t a
   }
 
   // If a retry host predicate is being applied, behave as if this host was not in the ring.
-  // Note that this does not guarantee a different host: e.g., attempt == ring_.size() or
+  // Note that this does not guarantee a different host: e.g., attempt == hashes_.size() or
   // when the offset causes us to select the same host at another location in the ring.
   if (attempt > 0) {
-    midp = (midp + attempt) % ring_.size();
+    midp = (midp + attempt) % hashes_.size();
   }
 
-  return ring_[midp].host_;
+  return hosts_[host_indices_[midp]];
 }
 
+namespace {
+
 using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
+
+// Computes the hashes of a host on the ring, which are those of the keys "<address>_<i>" for
+// each i below the number of hashes of the host.
+class HostHasher {
+public:
+  HostHasher(const Host& host, bool use_hostname_for_hashing, HashFunction hash_function)
+      : hash_function_(hash_function) {
+    const std::string& address_string =
+        use_hostname_for_hashing ? host.hostname() : host.address()->asString();
+    ASSERT(!address_string.empty());
+    hash_key_buffer_.assign(address_string.begin(), address_string.end());
+    hash_key_buffer_.emplace_back('_');
+    prefix_size_ = hash_key_buffer_.size();
+  }
+
+  uint64_t hash(uint64_t i) {
+    const std::string i_str = absl::StrCat("", i);
+    hash_key_buffer_.resize(prefix_size_);
+    hash_key_buffer_.insert(hash_key_buffer_.end(), i_str.begin(), i_str.end());
+    const absl::string_view hash_key(hash_key_buffer_.data(), hash_key_buffer_.size());
+    return (hash_function_ == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
+               ? MurmurHash::murmurHash2(hash_key, MurmurHash::STD_HASH_SEED)
+               : HashUtil::xxHash64(hash_key);
+  }
+
+private:
+  const HashFunction hash_function_;
+  absl::InlinedVector<char, 196> hash_key_buffer_;
+  size_t prefix_size_;
+};
+
+// A hash on the ring and the index of its host.
+using RingEntry = std::pair<uint64_t, uint32_t>;
+
+bool hashLess(const RingEntry& lhs, const RingEntry& rhs) { return lhs.first < rhs.first; }
+
+} // namespace
+
 RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_host_weights,
                                  double min_normalized_weight, uint64_t min_ring_size,
                                  uint64_t max_ring_size, HashFunction hash_function,
-                                 bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats)
+                                 bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats,
+                                 const Ring* previous)
     : stats_(stats) {
   ENVOY_LOG(trace, "ring hash: building ring");
 
@@ -119,79 +183,118 @@ RingHashLoadBalancer::Ring::Ring(const NormalizedHostWeightVector& normalized_ho
   const double scale =
       std::min(std::ceil(min_normalized_weight * min_ring_size) / min_normalized_weight,
                static_cast<double>(max_ring_size));
-
-  // Reserve memory for the entire ring up front.
   const uint64_t ring_size = std::ceil(scale);
-  ring_.reserve(ring_size);
 
-  // Populate the hash ring by walking through the (host, weight) pairs in
-  // normalized_host_weights, and generating (scale * weight) hashes for each host. Since these
+  // Work out the number of hashes of each host by walking through the (host, weight) pairs in
+  // normalized_host_weights, aiming for (scale * weight) hashes for each host. Since these
   // aren't necessarily whole numbers, we maintain running sums -- current_hashes and
   // target_hashes -- which allows us to populate the ring in a mostly stable way.
   //
   // For example, suppose we have 4 hosts, each with a normalized weight of 0.25, and a scale of
   // 6.0 (because the max_ring_size is 6). That means we want to generate 1.5 hashes per host.
-  // We start the outer loop with current_hashes = 0 and target_hashes = 0.
-  //   - For the first host, we set target_hashes = 1.5. After one run of the inner loop,
-  //     current_hashes = 1. After another run, current_hashes = 2, so the inner loop ends.
-  //   - For the second host, target_hashes becomes 3.0, and current_hashes is 2 from before.
-  //     After only one run of the inner loop, current_hashes = 3, so the inner loop ends.
+  // We start with current_hashes = 0 and target_hashes = 0.
+  //   - For the first host, we set target_hashes = 1.5, so it gets two hashes and
+  //     current_hashes = 2.
+  //   - For the second host, target_hashes becomes 3.0, and current_hashes is 2 from before,
+  //     so it gets one hash and current_hashes = 3.
   //   - Likewise, the third host gets two hashes, and the fourth host gets one hash.
   //
   // For stats reporting, keep track of the minimum and maximum actual number of hashes per host.
   // Users should hopefully pay attention to these numbers and alert if min_hashes_per_host is too
   // low, since that implies an inaccurate request distribution.
-
-  absl::InlinedVector<char, 196> hash_key_buffer;
   double current_hashes = 0.0;
   double target_hashes = 0.0;
   uint64_t min_hashes_per_host = ring_size;
   uint64_t max_hashes_per_host = 0;
+  hosts_.reserve(normalized_host_weights.size());
+  hashes_per_host_.reserve(normalized_host_weights.size());
   for (const auto& entry : normalized_host_weights) {
-    const auto& host = entry.first;
-    const std::string& address_string =
-        use_hostname_for_hashing ? host->hostname() : host->address()->asString();
-    ASSERT(!address_string.empty());
+    hosts_.push_back(entry.first);
+    target_hashes += scale * entry.second;
+    const uint64_t hashes =
+        current_hashes < target_hashes ? std::ceil(target_hashes) - current_hashes : 0;
+    current_hashes += hashes;
+    hashes_per_host_.push_back(hashes);
+    min_hashes_per_host = std::min(hashes, min_hashes_per_host);
+    max_hashes_per_host = std::max(hashes, max_hashes_per_host);
+  }
 
-    hash_key_buffer.assign(address_string.begin(), address_string.end());
-    hash_key_buffer.emplace_back('_');
-    auto offset_start = hash_key_buffer.end();
+  // The hashes to add to the ring, and for an update the hashes to remove from the previous one.
+  // The hashes of a host only depend on its address and their number, so a host which remains
+  // keeps the hashes it has in common with the previous ring.
+  std::vector<RingEntry> added;
+  absl::flat_hash_set<RingEntry> removed;
+  std::vector<uint32_t> previous_to_current;
+  const bool update = previous != nullptr && !previous->hashes_.empty();
+  if (update) {
+    absl::flat_hash_map<const Host*, uint32_t> previous_indices;
+    previous_indices.reserve(previous->hosts_.size());
+    for (uint32_t i = 0; i < previous->hosts_.size(); ++i) {
+      previous_indices.emplace(previous->hosts_[i].get(), i);
+    }
+    previous_to_current.assign(previous->hosts_.size(), NoHost);
+    for (uint32_t i = 0; i < hosts_.size(); ++i) {
+      uint64_t previous_hashes = 0;
+      auto it = previous_indices.find(hosts_[i].get());
+      if (it != previous_indices.end()) {
+        previous_to_current[it->second] = i;
+        previous_hashes = previous->hashes_per_host_[it->second];
+      }
+      if (previous_hashes == hashes_per_host_[i]) {
+        continue;
+      }
+      HostHasher hasher(*hosts_[i], use_hostname_for_hashing, hash_function);
+      for (uint64_t j = previous_hashes; j < hashes_per_host_[i]; ++j) {
+        added.emplace_back(hasher.hash(j), i);
+      }
+      for (uint64_t j = hashes_per_host_[i]; j < previous_hashes; ++j) {
+        removed.emplace(hasher.hash(j), i);
+      }
+    }
+  } else {
+    added.reserve(current_hashes);
+    for (uint32_t i = 0; i < hosts_.size(); ++i) {
+      HostHasher hasher(*hosts_[i], use_hostname_for_hashing, hash_function);
+      for (uint64_t j = 0; j < hashes_per_host_[i]; ++j) {
+        added.emplace_back(hasher.hash(j), i);
+      }
+    }
+  }
+  std::sort(added.begin(), added.end(), hashLess);
 
-    // As noted above: maintain current_hashes and target_hashes as running sums across the entire
-    // host set. `i` is needed only to construct the hash key, and tally min/max hashes per host.
-    target_hashes += scale * entry.second;
-    uint64_t i = 0;
-    while (current_hashes < target_hashes) {
-      const std::string i_str = absl::StrCat("", i);
-      hash_key_buffer.insert(offset_start, i_str.begin(), i_str.end());
-
-      absl::string_view hash_key(static_cast<char*>(hash_key_buffer.data()),
-                                 hash_key_buffer.size());
-
-      const uint64_t hash =
-          (hash_function == HashFunction::Cluster_RingHashLbConfig_HashFunction_MURMUR_HASH_2)
-              ? MurmurHash::murmurHash2(hash_key, MurmurHash::STD_HASH_SEED)
-              : HashUtil::xxHash64(hash_key);
-
-      ENVOY_LOG(trace, "ring hash: hash_key={} hash={}", hash_key.data(), hash);
-      ring_.push_back({hash, host});
-      ++i;
-      ++current_hashes;
-      hash_key_buffer.erase(offset_start, hash_key_buffer.end());
+  // Merge the added hashes with those kept from the previous ring.
+  hashes_.reserve(current_hashes);
+  host_indices_.reserve(current_hashes);
+  auto added_it = added.begin();
+  const uint64_t previous_size = update ? previous->hashes_.size() : 0;
+  for (uint64_t i = 0; i < previous_size; ++i) {
+    const RingEntry kept{previous->hashes_[i], previous_to_current[previous->host_indices_[i]]};
+    if (kept.second == NoHost || removed.contains(kept)) {
+      continue;
     }
-    min_hashes_per_host = std::min(i, min_hashes_per_host);
-    max_hashes_per_host = std::max(i, max_hashes_per_host);
+    for (; added_it != added.end() && hashLess(*added_it, kept); ++added_it) {
+      hashes_.push_back(added_it->first);
+      host_indices_.push_back(added_it->second);
+    }
+    hashes_.push_back(kept.first);
+    host_indices_.push_back(kept.second);
+  }
+  for (; added_it != added.end(); ++added_it) {
+    hashes_.push_back(added_it->first);
+    host_indices_.push_back(added_it->second);
+  }
+  ASSERT(hashes_.size() == current_hashes);
+  if (update) {
+    ENVOY_LOG(debug, "ring hash: updated ring, computed {} of {} hashes",
+              added.size() + removed.size(), hashes_.size());
   }
 
-  std::sort(ring_.begin(), ring_.end(), [](const RingEntry& lhs, const RingEntry& rhs) -> bool {
-    return lhs.hash_ < rhs.hash_;
-  });
   if (ENVOY_LOG_CHECK_LEVEL(trace)) {
-    for (const auto& entry : ring_) {
+    for (uint64_t i = 0; i < hashes_.size(); ++i) {
+      const HostConstSharedPtr& host = hosts_[host_indices_[i]];
       ENVOY_LOG(trace, "ring hash: host={} hash={}",
-                use_hostname_for_hashing ? entry.host_->hostname()
-                                         : entry.host_->address()->asString(),
-                entry.hash_);
+                use_hostname_for_hashing ? host->hostname() : host->address()->asString(),
+                hashes_[i]);
     }
   }
 
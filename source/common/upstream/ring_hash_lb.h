@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cstdint>
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include "envoy/config/cluster/v3/cluster.pb.h"
@@ -51,39 +54,39 @@ public:
 private:
   using HashFunction = envoy::config::cluster::v3::Cluster::RingHashLbConfig::HashFunction;
 
-  struct RingEntry {
-    uint64_t hash_;
-    HostConstSharedPtr host_;
-  };
-
+  /**
+   * The ring is kept as two arrays sorted by hash: the hashes, and the index of the host of each
+   * hash. When built from a previous ring, the hashes of hosts which remain are carried over and
+   * only the hashes of new hosts and of hosts with a changed number of hashes are computed, which
+   * results in the same ring as a full build.
+   */
   struct Ring : public HashingLoadBalancer {
     Ring(const NormalizedHostWeightVector& normalized_host_weights, double min_normalized_weight,
          uint64_t min_ring_size, uint64_t max_ring_size, HashFunction hash_function,
-         bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats);
+         bool use_hostname_for_hashing, RingHashLoadBalancerStats& stats,
+         const Ring* previous = nullptr);
 
     // ThreadAwareLoadBalancerBase::HashingLoadBalancer
     HostConstSharedPtr chooseHost(uint64_t hash, uint32_t attempt) const override;
 
-    std::vector<RingEntry> ring_;
+    std::vector<HostConstSharedPtr> hosts_;
+    // The number of hashes of each host.
+    std::vector<uint64_t> hashes_per_host_;
+    // The hashes of the ring in ascending order, and the index into hosts_ of the host of each.
+    std::vector<uint64_t> hashes_;
+    std::vector<uint32_t> host_indices_;
 
     RingHashLoadBalancerStats& stats_;
+
+    // Marks the hosts of a previous ring which were removed.
+    static constexpr uint32_t NoHost = std::numeric_limits<uint32_t>::max();
   };
   using RingConstSharedPtr = std::shared_ptr<const Ring>;
 
   // ThreadAwareLoadBalancerBase
   HashingLoadBalancerSharedPtr
-  createLoadBalancer(const NormalizedHostWeightVector& normalized_host_weights,
-                     double min_normalized_weight, double /* max_normalized_weight */) override {
-    HashingLoadBalancerSharedPtr ring_hash_lb =
-        std::make_shared<Ring>(normalized_host_weights, min_normalized_weight, min_ring_size_,
-                               max_ring_size_, hash_function_, use_hostname_for_hashing_, stats_);
-    if (hash_balance_factor_ == 0) {
-      return ring_hash_lb;
-    }
-
-    return std::make_shared<BoundedLoadHashingLoadBalancer>(
-        ring_hash_lb, std::move(normalized_host_weights), hash_balance_factor_);
-  }
+  createLoadBalancer(uint32_t priority, const NormalizedHostWeightVector& normalized_host_weights,
+                     double min_normalized_weight, double /* max_normalized_weight */) override;
 
   static RingHashLoadBalancerStats generateStats(Stats::Scope& scope);
 
@@ -97,6 +100,8 @@ private:
   const HashFunction hash_function_;
   const bool use_hostname_for_hashing_;
   const uint32_t hash_balance_factor_;
+  // The last ring of each priority, from which the next one is built.
+  std::vector<RingConstSharedPtr> rings_;
 };
 
 } // namespace Upstream
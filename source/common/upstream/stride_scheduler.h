@@ -0,0 +1,215 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "common/common/assert.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Upstream {
+
+// Stride scheduler used for weighted round robin, as an alternative to the EdfScheduler when the
+// weights of the entries only change through explicit updates. Weights are scaled to integers in
+// [1, MaxWeight] relative to the largest weight. Picks walk a sequence number over the entries in
+// generations of size(): in each generation an entry is picked for a weight / MaxWeight share of
+// the generations, using an offset per entry to spread the picks of entries with equal weights.
+//
+// Picks take max_weight / mean_weight steps on average, so O(1) as long as the weights are in a
+// bounded range, see expectedPickCost(). An entry with the largest weight is picked in every
+// generation, which bounds a pick to size() steps. Adding, removing or changing the weight of an
+// entry is O(1), unless the largest weight grows, which rescales all the entries.
+template <class C> class StrideScheduler {
+public:
+  static constexpr uint32_t MaxWeight = 0xffff;
+
+  /**
+   * Returns the next pick, as peekAgain() of the EdfScheduler does. The entry is re-weighted with
+   * calculate_weight as if it had been picked.
+   */
+  std::shared_ptr<C> peekAgain(std::function<double(const C&)> calculate_weight) {
+    std::shared_ptr<C> ret = pickEntry(calculate_weight);
+    if (ret != nullptr) {
+      prepick_list_.push_back(ret);
+    }
+    return ret;
+  }
+
+  /**
+   * Picks the next entry and updates its weight using calculate_weight.
+   * @return std::shared_ptr<C> the picked entry or nullptr if there is none.
+   */
+  std::shared_ptr<C> pickAndAdd(std::function<double(const C&)> calculate_weight) {
+    while (!prepick_list_.empty()) {
+      std::shared_ptr<C> ret = prepick_list_.front().lock();
+      prepick_list_.pop_front();
+      if (ret != nullptr && index_.contains(ret.get())) {
+        return ret;
+      }
+    }
+    return pickEntry(calculate_weight);
+  }
+
+  /**
+   * Adds an entry, or updates the weight of an entry already present. An entry added for the
+   * first time starts at the current position of the schedule.
+   * @param weight floating point weight.
+   * @param entry shared pointer to the entry, which is retained until it is removed.
+   */
+  void add(double weight, std::shared_ptr<C> entry) {
+    ASSERT(weight > 0);
+    auto it = index_.find(entry.get());
+    if (it != index_.end()) {
+      setWeight(entries_[it->second], weight);
+      return;
+    }
+    index_.emplace(entry.get(), entries_.size());
+    const auto offset = static_cast<uint32_t>(order_offset_++ * OffsetStep % MaxWeight);
+    entries_.push_back({std::move(entry), 0, 0, 0, offset});
+    setWeight(entries_.back(), weight);
+  }
+
+  /**
+   * Removes an entry, if present.
+   */
+  void remove(const C& entry) {
+    auto it = index_.find(&entry);
+    if (it == index_.end()) {
+      return;
+    }
+    const size_t position = it->second;
+    index_.erase(it);
+    total_scaled_weight_ -= entries_[position].scaled_weight_;
+    if (position != entries_.size() - 1) {
+      entries_[position] = std::move(entries_.back());
+      index_[entries_[position].entry_.get()] = position;
+    }
+    entries_.pop_back();
+  }
+
+  /**
+   * Replaces the entries with the given ones. Entries already present keep their place in the
+   * schedule and get the new weight. O(n) in the number of entries.
+   */
+  template <class Container>
+  void update(const Container& entries, std::function<double(const C&)> calculate_weight) {
+    // Rescale to the new largest weight up front, rather than each time a larger weight is seen.
+    double max_weight = 0;
+    for (const auto& entry : entries) {
+      max_weight = std::max(max_weight, calculate_weight(*entry));
+    }
+    if (max_weight > 0 && max_weight != max_weight_) {
+      rescale(max_weight);
+    }
+    const uint64_t generation = ++update_generation_;
+    for (const auto& entry : entries) {
+      add(calculate_weight(*entry), entry);
+      entries_[index_[entry.get()]].update_generation_ = generation;
+    }
+    for (size_t i = 0; i < entries_.size();) {
+      if (entries_[i].update_generation_ != generation) {
+        // The last entry is moved to this position, which is then looked at again.
+        remove(*entries_[i].entry_);
+      } else {
+        ++i;
+      }
+    }
+  }
+
+  /**
+   * Moves the schedule forward, e.g. to desynchronize schedulers with the same entries.
+   */
+  void advance(uint64_t steps) { sequence_ += steps; }
+
+  /**
+   * @return double the average number of steps a pick takes.
+   */
+  double expectedPickCost() const {
+    if (entries_.empty()) {
+      return 0;
+    }
+    return static_cast<double>(MaxWeight) * entries_.size() / total_scaled_weight_;
+  }
+
+  bool empty() const { return entries_.empty(); }
+  size_t size() const { return entries_.size(); }
+
+private:
+  struct Entry {
+    std::shared_ptr<C> entry_;
+    double weight_;
+    uint32_t scaled_weight_;
+    uint64_t update_generation_;
+    // Spreads the picks of entries with the same weight over the generations. In [0, MaxWeight).
+    uint32_t offset_;
+  };
+
+  std::shared_ptr<C> pickEntry(const std::function<double(const C&)>& calculate_weight) {
+    if (entries_.empty()) {
+      return nullptr;
+    }
+    while (true) {
+      const uint64_t position = sequence_ % entries_.size();
+      const uint64_t generation = sequence_ / entries_.size();
+      ++sequence_;
+      Entry& entry = entries_[position];
+      if ((entry.scaled_weight_ * generation + entry.offset_) % MaxWeight >=
+          MaxWeight - entry.scaled_weight_) {
+        std::shared_ptr<C> ret = entry.entry_;
+        const double weight = calculate_weight(*ret);
+        if (weight != entry.weight_) {
+          setWeight(entry, weight);
+        }
+        return ret;
+      }
+    }
+  }
+
+  void setWeight(Entry& entry, double weight) {
+    ASSERT(weight > 0);
+    entry.weight_ = weight;
+    if (weight > max_weight_) {
+      rescale(weight);
+      return;
+    }
+    total_scaled_weight_ -= entry.scaled_weight_;
+    entry.scaled_weight_ = scale(weight);
+    total_scaled_weight_ += entry.scaled_weight_;
+  }
+
+  void rescale(double max_weight) {
+    max_weight_ = max_weight;
+    total_scaled_weight_ = 0;
+    for (Entry& entry : entries_) {
+      entry.scaled_weight_ = scale(entry.weight_);
+      total_scaled_weight_ += entry.scaled_weight_;
+    }
+  }
+
+  uint32_t scale(double weight) const {
+    const double scaled = std::round(std::min(weight / max_weight_, 1.0) * MaxWeight);
+    return std::max<uint32_t>(1, static_cast<uint32_t>(scaled));
+  }
+
+  // Half of MaxWeight, so entries next to each other are picked in different generations.
+  static constexpr uint32_t OffsetStep = MaxWeight / 2;
+
+  std::vector<Entry> entries_;
+  absl::flat_hash_map<const C*, size_t> index_;
+  // The largest weight seen, which is scaled to MaxWeight.
+  double max_weight_{};
+  uint64_t total_scaled_weight_{};
+  uint64_t sequence_{};
+  uint64_t order_offset_{};
+  uint64_t update_generation_{};
+  std::list<std::weak_ptr<C>> prepick_list_;
+};
+
+} // namespace Upstream
+} // namespace Envoy
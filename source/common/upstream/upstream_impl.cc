@@ -1418,6 +1418,49 @@ void PriorityStateManager::updateClusterPrioritySet(
   }
 }
 
+bool BaseDynamicClusterImpl::updateExistingHost(const Host& host, Host& existing_host) {
+  bool hosts_changed = false;
+  if (existing_host.weight() != host.weight()) {
+    existing_host.weight(host.weight());
+    if (Runtime::runtimeFeatureEnabled(
+            "envoy.reloadable_features.upstream_host_weight_change_causes_rebuild")) {
+      // We do full host set rebuilds so that load balancers can do pre-computation of data
+      // structures based on host weight. This may become a performance problem in certain
+      // deployments so it is runtime feature guarded and may also need to be configurable
+      // and/or dynamic in the future.
+      hosts_changed = true;
+    }
+  }
+
+  hosts_changed |= updateHealthFlag(host, existing_host, Host::HealthFlag::FAILED_EDS_HEALTH);
+  hosts_changed |= updateHealthFlag(host, existing_host, Host::HealthFlag::DEGRADED_EDS_HEALTH);
+
+  // Did metadata change?
+  bool metadata_changed = true;
+  if (host.metadata() && existing_host.metadata()) {
+    metadata_changed = !Protobuf::util::MessageDifferencer::Equivalent(*host.metadata(),
+                                                                       *existing_host.metadata());
+  } else if (!host.metadata() && !existing_host.metadata()) {
+    metadata_changed = false;
+  }
+
+  if (metadata_changed) {
+    // First, update the entire metadata for the endpoint.
+    existing_host.metadata(host.metadata());
+
+    // Also, given that the canary attribute of an endpoint is derived from its metadata
+    // (e.g.: from envoy.lb/canary), we do a blind update here since it's cheaper than testing
+    // to see if it actually changed. We must update this besides just updating the metadata,
+    // because it'll be used by the router filter to compute upstream stats.
+    existing_host.canary(host.canary());
+
+    // If metadata changed, we need to rebuild. See github issue #3810.
+    hosts_changed = true;
+  }
+
+  return hosts_changed;
+}
+
 bool BaseDynamicClusterImpl::updateDynamicHostList(
     const HostVector& new_hosts, HostVector& current_priority_hosts,
     HostVector& hosts_added_to_current_priority, HostVector& hosts_removed_from_current_priority,
@@ -1483,45 +1526,7 @@ bool BaseDynamicClusterImpl::updateDynamicHostList(
       if (host->weight() > max_host_weight) {
         max_host_weight = host->weight();
       }
-      if (existing_host->second->weight() != host->weight()) {
-        existing_host->second->weight(host->weight());
-        if (Runtime::runtimeFeatureEnabled(
-                "envoy.reloadable_features.upstream_host_weight_change_causes_rebuild")) {
-          // We do full host set rebuilds so that load balancers can do pre-computation of data
-          // structures based on host weight. This may become a performance problem in certain
-          // deployments so it is runtime feature guarded and may also need to be configurable
-          // and/or dynamic in the future.
-          hosts_changed = true;
-        }
-      }
-
-      hosts_changed |=
-          updateHealthFlag(*host, *existing_host->second, Host::HealthFlag::FAILED_EDS_HEALTH);
-      hosts_changed |=
-          updateHealthFlag(*host, *existing_host->second, Host::HealthFlag::DEGRADED_EDS_HEALTH);
-
-      // Did metadata change?
-      bool metadata_changed = true;
-      if (host->metadata() && existing_host->second->metadata()) {
-        metadata_changed = !Protobuf::util::MessageDifferencer::Equivalent(
-            *host->metadata(), *existing_host->second->metadata());
-      } else if (!host->metadata() && !existing_host->second->metadata()) {
-        metadata_changed = false;
-      }
-
-      if (metadata_changed) {
-        // First, update the entire metadata for the endpoint.
-        existing_host->second->metadata(host->metadata());
-
-        // Also, given that the canary attribute of an endpoint is derived from its metadata
-        // (e.g.: from envoy.lb/canary), we do a blind update here since it's cheaper than testing
-        // to see if it actually changed. We must update this besides just updating the metadata,
-        // because it'll be used by the router filter to compute upstream stats.
-        existing_host->second->canary(host->canary());
-
-        // If metadata changed, we need to rebuild. See github issue #3810.
-        hosts_changed = true;
-      }
+      hosts_changed |= updateExistingHost(*host, *existing_host->second);
 
       // Did the priority change?
       if (host->priority() != existing_host->second->priority()) {
@@ -911,6 +911,16 @@ class BaseDynamicClusterImpl : public ClusterImplBase {
 protected:
   using ClusterImplBase::ClusterImplBase;
 
+  /**
+   * Updates in place the weight, the EDS health flags and the metadata of an existing host to
+   * match the host with the same address in a new configuration.
+   *
+   * @param host the host of the new configuration.
+   * @param existing_host the host to update.
+   * @return whether the change requires the hosts of the priority to be updated.
+   */
+  static bool updateExistingHost(const Host& host, Host& existing_host);
+
   /**
    * Updates the host list of a single priority by reconciling the list of new hosts
    * with existing hosts.
@@ -156,6 +156,7 @@ EXTENSIONS = {
     "envoy.stat_sinks.dog_statsd":                      "//source/extensions/stat_sinks/dog_statsd:config",
     "envoy.stat_sinks.hystrix":                         "//source/extensions/stat_sinks/hystrix:config",
     "envoy.stat_sinks.metrics_service":                 "//source/extensions/stat_sinks/metrics_service:config",
+    "envoy.stat_sinks.prometheus_remote_write":         "//source/extensions/stat_sinks/prometheus_remote_write:config",
     "envoy.stat_sinks.statsd":                          "//source/extensions/stat_sinks/statsd:config",
     "envoy.stat_sinks.wasm":                            "//source/extensions/stat_sinks/wasm:config",
 
@@ -196,6 +197,12 @@ EXTENSIONS = {
     "envoy.transport_sockets.quic":                     "//source/extensions/quic_listeners/quiche:quic_transport_socket_factory_lib",
     "envoy.transport_sockets.starttls":                 "//source/extensions/transport_sockets/starttls:config",
 
+    #
+    # TLS private key providers
+    #
+
+    "envoy.tls.key_providers.offload":                  "//source/extensions/private_key_providers/offload:config",
+
     #
     # Retry host predicates
     #
@@ -214,7 +221,9 @@ EXTENSIONS = {
     # CacheFilter plugins
     #
 
-    "envoy.filters.http.cache.simple_http_cache":       "//source/extensions/filters/http/cache/simple_http_cache:simple_http_cache_lib",
+    "envoy.filters.http.cache.file_system_http_cache": "//source/extensions/filters/http/cache/file_system_http_cache:file_system_http_cache_lib",
+    "envoy.filters.http.cache.sharded_http_cache":       "//source/extensions/filters/http/cache/sharded_http_cache:sharded_http_cache_lib",
+    "envoy.filters.http.cache.simple_http_cache":        "//source/extensions/filters/http/cache/simple_http_cache:simple_http_cache_lib",
 
     #
     # Internal redirect predicates
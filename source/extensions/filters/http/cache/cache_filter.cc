@@ -300,7 +300,15 @@ void CacheFilter::onBody(Buffer::InstancePtr&& body) {
   ASSERT(!remaining_ranges_.empty(),
          "CacheFilter doesn't call getBody unless there's more body to get, so this is a "
          "bogus callback.");
-  ASSERT(body, "Cache said it had a body, but isn't giving it to us.");
+  if (!body) {
+    // The cache advertised a body it then failed to read, e.g. because its storage went away
+    // underneath it. The response headers have already been sent, so it can't be completed.
+    ENVOY_STREAM_LOG(debug, "CacheFilter::onBody: cache failed to provide the body",
+                     *decoder_callbacks_);
+    filter_state_ == FilterState::DecodeServingFromCache ? decoder_callbacks_->resetStream()
+                                                         : encoder_callbacks_->resetStream();
+    return;
+  }
 
   const uint64_t bytes_from_cache = body->length();
   if (bytes_from_cache < remaining_ranges_[0].length()) {
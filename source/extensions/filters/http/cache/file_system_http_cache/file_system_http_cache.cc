@@ -0,0 +1,658 @@
+#include "extensions/filters/http/cache/file_system_http_cache/file_system_http_cache.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "envoy/registry/registry.h"
+
+#include "common/common/assert.h"
+#include "common/common/fmt.h"
+#include "common/common/utility.h"
+#include "common/filesystem/directory.h"
+#include "common/http/header_map_impl.h"
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using envoy::source::extensions::filters::http::cache::CacheFileHeader;
+using envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig;
+
+constexpr uint64_t DefaultMaxSizeBytes = 1024 * 1024 * 1024;
+constexpr uint32_t DefaultIoThreads = 4;
+// The most bytes of body returned by a single read, so that large bodies are streamed rather than
+// held in memory at once.
+constexpr uint64_t MaxReadBytes = 1024 * 1024;
+// The footer of an entry file: the size of the CacheFileHeader, then FooterMagic, both as little
+// endian 32 bit integers.
+constexpr uint32_t FooterMagic = 0x31434845; // "EHC1"
+#ifdef MAP_POPULATE
+// Reads the mapped pages in while mapping them, so that they don't fault on the worker.
+constexpr int MapFlags = MAP_PRIVATE | MAP_POPULATE;
+#else
+constexpr int MapFlags = MAP_PRIVATE;
+#endif
+constexpr size_t FooterSize = 2 * sizeof(uint32_t);
+constexpr absl::string_view TempSuffix = ".tmp";
+// Entry file names are the key hash and a random generation, both as 16 hex digits, joined by a
+// dash. The generation keeps a replaced entry's file from being overwritten while it is read.
+constexpr size_t FileNameSize = 33;
+
+std::string keyHashHex(uint64_t key_hash) {
+  return absl::StrCat(absl::Hex(key_hash, absl::kZeroPad16));
+}
+
+std::string entryFileName(uint64_t key_hash, uint64_t generation) {
+  return absl::StrCat(keyHashHex(key_hash), "-", absl::Hex(generation, absl::kZeroPad16));
+}
+
+bool isEntryFileName(absl::string_view name) {
+  if (name.size() != FileNameSize || name[16] != '-') {
+    return false;
+  }
+  for (size_t i = 0; i < name.size(); ++i) {
+    if (i != 16 && !absl::ascii_isxdigit(name[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void encodeFooter(uint32_t header_size, uint8_t* footer) {
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    footer[i] = static_cast<uint8_t>(header_size >> (8 * i));
+    footer[sizeof(uint32_t) + i] = static_cast<uint8_t>(FooterMagic >> (8 * i));
+  }
+}
+
+bool decodeFooter(const uint8_t* footer, uint32_t& header_size) {
+  uint32_t magic = 0;
+  header_size = 0;
+  for (size_t i = 0; i < sizeof(uint32_t); ++i) {
+    header_size |= static_cast<uint32_t>(footer[i]) << (8 * i);
+    magic |= static_cast<uint32_t>(footer[sizeof(uint32_t) + i]) << (8 * i);
+  }
+  return magic == FooterMagic;
+}
+
+bool writeFully(int fd, absl::string_view data) {
+  while (!data.empty()) {
+    const ssize_t rc = ::write(fd, data.data(), data.size());
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    data.remove_prefix(rc);
+  }
+  return true;
+}
+
+bool preadFully(int fd, void* buffer, size_t length, uint64_t offset) {
+  uint8_t* out = static_cast<uint8_t*>(buffer);
+  while (length > 0) {
+    const ssize_t rc = ::pread(fd, out, length, offset);
+    if (rc < 0 && errno == EINTR) {
+      continue;
+    }
+    if (rc <= 0) {
+      return false;
+    }
+    out += rc;
+    length -= rc;
+    offset += rc;
+  }
+  return true;
+}
+
+// Reads the CacheFileHeader of an entry file, checking that the file is complete.
+bool readHeader(int fd, uint64_t file_size, CacheFileHeader& header) {
+  uint8_t footer[FooterSize];
+  uint32_t header_size = 0;
+  if (file_size < FooterSize || !preadFully(fd, footer, FooterSize, file_size - FooterSize) ||
+      !decodeFooter(footer, header_size) || header_size > file_size - FooterSize) {
+    return false;
+  }
+  std::string serialized_header(header_size, '\0');
+  return preadFully(fd, serialized_header.data(), header_size,
+                    file_size - FooterSize - header_size) &&
+         header.ParseFromString(serialized_header) &&
+         header.body_size() + header_size + FooterSize == file_size;
+}
+
+void headersToProto(const Http::HeaderMap& headers, envoy::config::core::v3::HeaderMap& proto) {
+  headers.iterate([&proto](const Http::HeaderEntry& header) -> Http::HeaderMap::Iterate {
+    auto* header_value = proto.add_headers();
+    header_value->set_key(std::string(header.key().getStringView()));
+    header_value->set_value(std::string(header.value().getStringView()));
+    return Http::HeaderMap::Iterate::Continue;
+  });
+}
+
+template <class HeaderMapImplType>
+std::unique_ptr<HeaderMapImplType>
+headersFromProto(const envoy::config::core::v3::HeaderMap& proto) {
+  std::unique_ptr<HeaderMapImplType> headers = HeaderMapImplType::create();
+  for (const auto& header : proto.headers()) {
+    headers->addCopy(Http::LowerCaseString(header.key()), header.value());
+  }
+  return headers;
+}
+
+int64_t toNanos(SystemTime time) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+SystemTime fromNanos(int64_t nanos) {
+  return SystemTime(
+      std::chrono::duration_cast<SystemTime::duration>(std::chrono::nanoseconds(nanos)));
+}
+
+class FileSystemLookupContext : public LookupContext {
+public:
+  FileSystemLookupContext(FileSystemHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    auto entry = cache_.lookup(request_);
+    if (entry.response_headers_ == nullptr) {
+      cb(LookupResult{});
+      return;
+    }
+    file_path_ = std::move(entry.file_path_);
+    trailers_ = std::move(entry.response_trailers_);
+    LookupResult result = request_.makeLookupResult(std::move(entry.response_headers_),
+                                                    std::move(entry.metadata_), entry.body_size_);
+    result.has_trailers_ = trailers_ != nullptr;
+    cb(std::move(result));
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(!file_path_.empty());
+    cache_.readBody(file_path_, range, std::move(cb));
+  }
+
+  void getTrailers(LookupTrailersCallback&& cb) override {
+    ASSERT(trailers_ != nullptr);
+    cb(std::move(trailers_));
+  }
+
+  const LookupRequest& request() const { return request_; }
+  void onDestroy() override {}
+
+private:
+  FileSystemHttpCache& cache_;
+  const LookupRequest request_;
+  std::string file_path_;
+  Http::ResponseTrailerMapPtr trailers_;
+};
+
+class FileSystemInsertContext : public InsertContext {
+public:
+  FileSystemInsertContext(LookupContext& lookup_context, FileSystemHttpCache& cache)
+      : key_(dynamic_cast<FileSystemLookupContext&>(lookup_context).request().key()),
+        entry_vary_headers_(
+            dynamic_cast<FileSystemLookupContext&>(lookup_context).request().getVaryHeaders()),
+        cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    headersToProto(response_headers, *header_.mutable_response_headers());
+    header_.set_response_time_ns(toNanos(metadata.response_time_));
+    header_bytes_ = header_.ByteSizeLong();
+    checkSize();
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    if (!aborted_) {
+      body_->add(chunk);
+      checkSize();
+    }
+    if (end_stream) {
+      commit();
+    } else {
+      ready_for_next_chunk(!aborted_);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap& trailers) override {
+    ASSERT(!committed_);
+    headersToProto(trailers, *header_.mutable_response_trailers());
+    header_bytes_ = header_.ByteSizeLong();
+    checkSize();
+    commit();
+  }
+
+  void onDestroy() override {}
+
+private:
+  // Gives up on responses which are too large to be cached, rather than buffering all of them.
+  void checkSize() {
+    if (header_bytes_ + body_->length() > cache_.maxEntrySizeBytes()) {
+      aborted_ = true;
+      body_->drain(body_->length());
+    }
+  }
+
+  void commit() {
+    committed_ = true;
+    if (aborted_) {
+      return;
+    }
+    header_.set_body_size(body_->length());
+
+    const auto vary_header = response_headers_->get(Http::Headers::get().Vary);
+    if (vary_header.empty()) {
+      *header_.mutable_key() = key_;
+      cache_.insert(std::move(header_), std::move(body_), true);
+      return;
+    }
+
+    // Insert the varied response.
+    *header_.mutable_key() = key_;
+    header_.mutable_key()->add_custom_fields(
+        VaryHeader::createVaryKey(vary_header, entry_vary_headers_));
+    cache_.insert(std::move(header_), std::move(body_), true);
+
+    // Add a special entry to flag that this request generates varied responses.
+    CacheFileHeader vary_marker;
+    *vary_marker.mutable_key() = key_;
+    // TODO(mattklein123): Support multiple vary headers and/or just make the vary header inline.
+    auto* vary = vary_marker.mutable_response_headers()->add_headers();
+    vary->set_key(Http::Headers::get().Vary.get());
+    vary->set_value(std::string(vary_header[0]->value().getStringView()));
+    cache_.insert(std::move(vary_marker), std::make_unique<Buffer::OwnedImpl>(), false);
+  }
+
+  Key key_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  CacheFileHeader header_;
+  // The serialized size of header_ without the key and body size, which are only set on commit.
+  uint64_t header_bytes_{};
+  const Http::RequestHeaderMap& entry_vary_headers_;
+  FileSystemHttpCache& cache_;
+  Buffer::InstancePtr body_{std::make_unique<Buffer::OwnedImpl>()};
+  bool committed_ = false;
+  bool aborted_ = false;
+};
+} // namespace
+
+FileSystemHttpCache::FileSystemHttpCache(const FileSystemHttpCacheConfig& config,
+                                         Thread::ThreadFactory& thread_factory)
+    : cache_path_(config.cache_path()),
+      max_size_bytes_(config.max_size_bytes() > 0 ? config.max_size_bytes()
+                                                  : DefaultMaxSizeBytes),
+      max_entry_size_bytes_(config.max_entry_size_bytes() > 0 ? config.max_entry_size_bytes()
+                                                              : max_size_bytes_ / 8),
+      use_mmap_(config.use_mmap()),
+      io_threads_(thread_factory, config.io_threads() > 0 ? config.io_threads() : DefaultIoThreads,
+                  "HttpCacheIo") {
+  if (cache_path_.empty()) {
+    throw EnvoyException("file system http cache: cache_path must be set");
+  }
+  if (::mkdir(cache_path_.c_str(), 0700) != 0 && errno != EEXIST) {
+    throw EnvoyException(fmt::format("file system http cache: unable to create {}: {}", cache_path_,
+                                     errorDetails(errno)));
+  }
+  io_threads_.post([this]() { loadEntries(); });
+}
+
+LookupContextPtr FileSystemHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<FileSystemLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr FileSystemHttpCache::makeInsertContext(LookupContextPtr&& lookup_context) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<FileSystemInsertContext>(*lookup_context, *this);
+}
+
+void FileSystemHttpCache::updateHeaders(const LookupContext&, const Http::ResponseHeaderMap&,
+                                        const ResponseMetadata&) {
+  // TODO(toddmgreer): Support updating headers.
+}
+
+FileSystemHttpCache::Entry FileSystemHttpCache::lookup(const LookupRequest& request) {
+  Entry entry = find(request.key());
+  if (entry.response_headers_ == nullptr || !VaryHeader::hasVary(*entry.response_headers_)) {
+    return entry;
+  }
+
+  // The entry under the request key only records that the response varies. The response itself is
+  // stored under a key extended with the values of the varied request headers.
+  const auto vary_header = entry.response_headers_->get(Http::Headers::get().Vary);
+  Key varied_request_key = request.key();
+  varied_request_key.add_custom_fields(
+      VaryHeader::createVaryKey(vary_header, request.getVaryHeaders()));
+  return find(varied_request_key);
+}
+
+FileSystemHttpCache::Entry FileSystemHttpCache::find(const Key& key) {
+  absl::MutexLock lock(&mutex_);
+  auto iter = index_.find(MessageUtil::hash(key));
+  if (iter == index_.end() || !MessageUtil()(iter->second.key_, key)) {
+    return Entry{};
+  }
+  IndexEntry& entry = iter->second;
+  recency_.splice(recency_.end(), recency_, entry.recency_);
+  return Entry{Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*entry.response_headers_),
+               entry.response_trailers_ != nullptr
+                   ? Http::createHeaderMap<Http::ResponseTrailerMapImpl>(*entry.response_trailers_)
+                   : nullptr,
+               entry.metadata_, entry.body_size_, filePath(entry.file_name_)};
+}
+
+void FileSystemHttpCache::readBody(const std::string& file_path, const AdjustedByteRange& range,
+                                   LookupBodyCallback&& cb) {
+  io_threads_.post(
+      [this, file_path, range, cb = std::move(cb)]() { cb(readRange(file_path, range)); });
+}
+
+Buffer::InstancePtr FileSystemHttpCache::readRange(const std::string& file_path,
+                                                   const AdjustedByteRange& range) {
+  // The body starts at the beginning of the file.
+  const uint64_t begin = range.begin();
+  const uint64_t length = std::min(range.length(), MaxReadBytes);
+  auto buffer = std::make_unique<Buffer::OwnedImpl>();
+  if (length == 0) {
+    return buffer;
+  }
+
+  const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    ENVOY_LOG(debug, "file system http cache: unable to open {}: {}", file_path,
+              errorDetails(errno));
+    return nullptr;
+  }
+
+  if (use_mmap_) {
+    // Entry files are never modified once complete, so the mapping stays valid even if the file is
+    // evicted and unlinked while the buffer is in use.
+    static const uint64_t page_size = ::sysconf(_SC_PAGESIZE);
+    const uint64_t map_begin = begin - begin % page_size;
+    const uint64_t map_length = begin + length - map_begin;
+    void* map = ::mmap(nullptr, map_length, PROT_READ, MapFlags, fd, map_begin);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+      ENVOY_LOG(debug, "file system http cache: unable to map {}: {}", file_path,
+                errorDetails(errno));
+      return nullptr;
+    }
+    // The mapping is lazy, so any page not populated yet would fault, and possibly wait for the
+    // disk, on the worker. Touch every page to take those faults here, on the IO thread.
+    const volatile uint8_t* pages = static_cast<const uint8_t*>(map);
+    for (uint64_t offset = 0; offset < map_length; offset += page_size) {
+      static_cast<void>(pages[offset]);
+    }
+    auto* fragment = new Buffer::BufferFragmentImpl(
+        static_cast<const uint8_t*>(map) + (begin - map_begin), length,
+        [map, map_length](const void*, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
+          ::munmap(map, map_length);
+          delete this_fragment;
+        });
+    buffer->addBufferFragment(*fragment);
+    return buffer;
+  }
+
+  std::unique_ptr<uint8_t[]> data(new uint8_t[length]);
+  const bool read = preadFully(fd, data.get(), length, begin);
+  ::close(fd);
+  if (!read) {
+    ENVOY_LOG(debug, "file system http cache: unable to read {}", file_path);
+    return nullptr;
+  }
+  auto* fragment = new Buffer::BufferFragmentImpl(
+      data.release(), length,
+      [](const void* data, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
+        delete[] static_cast<const uint8_t*>(data);
+        delete this_fragment;
+      });
+  buffer->addBufferFragment(*fragment);
+  return buffer;
+}
+
+void FileSystemHttpCache::insert(CacheFileHeader&& header, Buffer::InstancePtr&& body,
+                                 bool replace) {
+  ASSERT(header.body_size() == body->length());
+  if (!replace) {
+    absl::MutexLock lock(&mutex_);
+    if (index_.contains(MessageUtil::hash(header.key()))) {
+      return;
+    }
+  }
+  // std::function requires copyable captures.
+  auto shared_header = std::make_shared<const CacheFileHeader>(std::move(header));
+  auto shared_body = std::shared_ptr<const Buffer::Instance>(std::move(body));
+  io_threads_.post([this, shared_header, shared_body, replace]() {
+    writeEntry(*shared_header, *shared_body, replace);
+  });
+}
+
+void FileSystemHttpCache::writeEntry(const CacheFileHeader& header, const Buffer::Instance& body,
+                                     bool replace) {
+  const std::string file_name = entryFileName(MessageUtil::hash(header.key()), random_.random());
+  const std::string file_path = filePath(file_name);
+  const std::string temp_path = absl::StrCat(file_path, TempSuffix);
+
+  const std::string serialized_header = header.SerializeAsString();
+  uint8_t footer[FooterSize];
+  encodeFooter(serialized_header.size(), footer);
+
+  const int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    ENVOY_LOG(debug, "file system http cache: unable to create {}: {}", temp_path,
+              errorDetails(errno));
+    return;
+  }
+  bool written = true;
+  for (const Buffer::RawSlice& slice : body.getRawSlices()) {
+    written = written && writeFully(fd, {static_cast<const char*>(slice.mem_), slice.len_});
+  }
+  written = written && writeFully(fd, serialized_header) &&
+            writeFully(fd, {reinterpret_cast<const char*>(footer), FooterSize});
+  written = (::close(fd) == 0) && written;
+  // The rename publishes the complete file atomically, so neither readers nor a restarted Envoy
+  // ever see a partially written entry.
+  if (!written || ::rename(temp_path.c_str(), file_path.c_str()) != 0) {
+    ENVOY_LOG(debug, "file system http cache: unable to write {}: {}", file_path,
+              errorDetails(errno));
+    ::unlink(temp_path.c_str());
+    return;
+  }
+
+  std::vector<std::string> obsolete_files;
+  addToIndex(header, file_name, body.length() + serialized_header.size() + FooterSize, replace,
+             true, obsolete_files);
+  removeFiles(obsolete_files);
+}
+
+void FileSystemHttpCache::addToIndex(const CacheFileHeader& header, const std::string& file_name,
+                                     uint64_t file_size, bool replace, bool most_recent,
+                                     std::vector<std::string>& obsolete_files) {
+  const uint64_t key_hash = MessageUtil::hash(header.key());
+  absl::MutexLock lock(&mutex_);
+  auto iter = index_.find(key_hash);
+  if (iter != index_.end()) {
+    if (!replace) {
+      obsolete_files.push_back(file_name);
+      return;
+    }
+    obsolete_files.push_back(iter->second.file_name_);
+    size_bytes_ -= iter->second.file_size_;
+    recency_.erase(iter->second.recency_);
+    index_.erase(iter);
+  }
+
+  IndexEntry& entry = index_[key_hash];
+  entry.key_ = header.key();
+  entry.response_headers_ =
+      headersFromProto<Http::ResponseHeaderMapImpl>(header.response_headers());
+  if (header.has_response_trailers()) {
+    entry.response_trailers_ =
+        headersFromProto<Http::ResponseTrailerMapImpl>(header.response_trailers());
+  }
+  entry.metadata_.response_time_ = fromNanos(header.response_time_ns());
+  entry.body_size_ = header.body_size();
+  entry.file_name_ = file_name;
+  entry.file_size_ = file_size;
+  entry.recency_ = recency_.insert(most_recent ? recency_.end() : recency_.begin(), key_hash);
+  size_bytes_ += file_size;
+  evict(obsolete_files);
+}
+
+void FileSystemHttpCache::evict(std::vector<std::string>& obsolete_files) {
+  while (size_bytes_ > max_size_bytes_ && !recency_.empty()) {
+    auto iter = index_.find(recency_.front());
+    ASSERT(iter != index_.end());
+    obsolete_files.push_back(iter->second.file_name_);
+    size_bytes_ -= iter->second.file_size_;
+    recency_.pop_front();
+    index_.erase(iter);
+  }
+}
+
+void FileSystemHttpCache::removeFiles(const std::vector<std::string>& file_names) {
+  for (const std::string& file_name : file_names) {
+    ::unlink(filePath(file_name).c_str());
+  }
+}
+
+void FileSystemHttpCache::loadEntries() {
+  std::vector<std::string> file_names;
+  std::vector<std::string> obsolete_files;
+  try {
+    for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(cache_path_)) {
+      if (entry.type_ != Filesystem::FileType::Regular) {
+        continue;
+      }
+      if (isEntryFileName(entry.name_)) {
+        file_names.push_back(entry.name_);
+      } else if (absl::EndsWith(entry.name_, TempSuffix) &&
+                 isEntryFileName(absl::string_view(entry.name_)
+                                     .substr(0, entry.name_.size() - TempSuffix.size()))) {
+        // Left behind by a write which never completed.
+        obsolete_files.push_back(entry.name_);
+      }
+    }
+  } catch (const EnvoyException& e) {
+    ENVOY_LOG(warn, "file system http cache: unable to list {}: {}", cache_path_, e.what());
+    return;
+  }
+
+  uint64_t loaded = 0;
+  for (const std::string& file_name : file_names) {
+    const std::string file_path = filePath(file_name);
+    const int fd = ::open(file_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+      continue;
+    }
+    struct stat file_stat;
+    CacheFileHeader header;
+    const bool valid = ::fstat(fd, &file_stat) == 0 &&
+                       readHeader(fd, file_stat.st_size, header) &&
+                       file_name.substr(0, 16) == keyHashHex(MessageUtil::hash(header.key()));
+    ::close(fd);
+    if (!valid) {
+      ENVOY_LOG(debug, "file system http cache: removing invalid entry file {}", file_path);
+      obsolete_files.push_back(file_name);
+      continue;
+    }
+    // Entries inserted since startup are newer than the ones found on disk.
+    addToIndex(header, file_name, file_stat.st_size, false, false, obsolete_files);
+    ++loaded;
+  }
+  removeFiles(obsolete_files);
+  ENVOY_LOG(info, "file system http cache: loaded {} entries from {}", loaded, cache_path_);
+}
+
+std::string FileSystemHttpCache::filePath(absl::string_view file_name) const {
+  return absl::StrCat(cache_path_, "/", file_name);
+}
+
+uint64_t FileSystemHttpCache::sizeBytes() const {
+  absl::MutexLock lock(&mutex_);
+  return size_bytes_;
+}
+
+uint64_t FileSystemHttpCache::entryCount() const {
+  absl::MutexLock lock(&mutex_);
+  return index_.size();
+}
+
+void FileSystemHttpCache::waitForIoForTest() { io_threads_.waitForIdle(); }
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.file_system";
+
+CacheInfo FileSystemHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  return cache_info;
+}
+
+class FileSystemHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<FileSystemHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  HttpCache& getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+                      Server::Configuration::FactoryContext& context) override {
+    FileSystemHttpCacheConfig file_system_config;
+    MessageUtil::unpackTo(config.typed_config(), file_system_config);
+
+    // Filters configured with the same cache directory share one cache, which must then be
+    // configured the same way.
+    absl::MutexLock lock(&mutex_);
+    auto iter = caches_.find(file_system_config.cache_path());
+    if (iter == caches_.end()) {
+      auto cache = std::make_unique<FileSystemHttpCache>(file_system_config,
+                                                         context.api().threadFactory());
+      iter = caches_
+                 .emplace(file_system_config.cache_path(),
+                          std::make_pair(file_system_config, std::move(cache)))
+                 .first;
+    } else if (!MessageUtil()(iter->second.first, file_system_config)) {
+      throw EnvoyException(
+          fmt::format("file system http cache: {} is already used with a different configuration",
+                      file_system_config.cache_path()));
+    }
+    return *iter->second.second;
+  }
+
+private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string,
+                      std::pair<FileSystemHttpCacheConfig, std::unique_ptr<FileSystemHttpCache>>>
+      caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+static Registry::RegisterFactory<FileSystemHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
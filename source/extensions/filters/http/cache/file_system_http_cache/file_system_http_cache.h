@@ -0,0 +1,163 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/thread/thread.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+#include "common/common/random_generator.h"
+
+#include "source/extensions/filters/http/cache/file_system_http_cache/cache_file.pb.h"
+#include "source/extensions/filters/http/cache/file_system_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/file_system_http_cache/io_thread_pool.h"
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Cache backend which stores each entry in a file of a local directory, so that the cache can hold
+ * far more than fits in memory and survives restarts.
+ *
+ * An entry file holds the response body, followed by a CacheFileHeader with the key, headers and
+ * trailers, followed by a fixed size footer locating the CacheFileHeader. Files are written under
+ * a temporary name and renamed into place once complete, and are never modified afterwards, so a
+ * file can be memory mapped or read while it is being replaced or evicted.
+ *
+ * The headers of every entry are indexed in memory, so lookups don't touch the disk. Bodies are
+ * read, and entries written, evicted and loaded at startup, by a dedicated pool of threads so that
+ * workers never block on the file system. Body read results are delivered from the pool threads.
+ */
+class FileSystemHttpCache : public HttpCache, Logger::Loggable<Logger::Id::cache_filter> {
+public:
+  /**
+   * Result of an index lookup. response_headers_ is null on a miss.
+   */
+  struct Entry {
+    Http::ResponseHeaderMapPtr response_headers_;
+    Http::ResponseTrailerMapPtr response_trailers_;
+    ResponseMetadata metadata_;
+    uint64_t body_size_{};
+    std::string file_path_;
+  };
+
+  /**
+   * Creates the cache directory if needed and starts loading the entries found in it.
+   * @throw EnvoyException if the cache directory can't be created.
+   */
+  FileSystemHttpCache(
+      const envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig& config,
+      Thread::ThreadFactory& thread_factory);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata) override;
+  CacheInfo cacheInfo() const override;
+
+  Entry lookup(const LookupRequest& request);
+
+  /**
+   * Reads part of a body from an entry file on the IO threads.
+   * @param file_path the entry file, from Entry::file_path_.
+   * @param range the part of the body to read. Fewer bytes may be returned, in which case the
+   *        rest has to be requested again.
+   * @param cb called from an IO thread with the body, or with nullptr if the file could not be
+   *        read, e.g. because the entry has been evicted since it was looked up.
+   */
+  void readBody(const std::string& file_path, const AdjustedByteRange& range,
+                LookupBodyCallback&& cb);
+
+  /**
+   * Writes an entry to disk on the IO threads and adds it to the index once it is complete.
+   * @param header everything but the body.
+   * @param body the body, which must be header.body_size() bytes long.
+   * @param replace if false, an existing entry with the same key is kept.
+   */
+  void insert(envoy::source::extensions::filters::http::cache::CacheFileHeader&& header,
+              Buffer::InstancePtr&& body, bool replace);
+
+  /**
+   * @return uint64_t the maximum size of an entry, including headers and trailers.
+   */
+  uint64_t maxEntrySizeBytes() const { return max_entry_size_bytes_; }
+
+  /**
+   * @return uint64_t the total size of the indexed entry files.
+   */
+  uint64_t sizeBytes() const;
+
+  /**
+   * @return uint64_t the number of indexed entries.
+   */
+  uint64_t entryCount() const;
+
+  /**
+   * Blocks until the tasks posted to the IO threads so far, including loading the existing
+   * entries, have finished. For tests.
+   */
+  void waitForIoForTest();
+
+private:
+  struct IndexEntry {
+    Key key_;
+    Http::ResponseHeaderMapPtr response_headers_;
+    Http::ResponseTrailerMapPtr response_trailers_;
+    ResponseMetadata metadata_;
+    uint64_t body_size_;
+    std::string file_name_;
+    uint64_t file_size_;
+    // Position of the entry's key hash in recency_.
+    std::list<uint64_t>::iterator recency_;
+  };
+
+  // Looks up a single key, without following vary markers.
+  Entry find(const Key& key);
+  void writeEntry(const envoy::source::extensions::filters::http::cache::CacheFileHeader& header,
+                  const Buffer::Instance& body, bool replace);
+  Buffer::InstancePtr readRange(const std::string& file_path, const AdjustedByteRange& range);
+  void loadEntries();
+  // Adds an entry to the index. If most_recent is false, the entry is added as the least recently
+  // used one. Names of files to delete are added to obsolete_files.
+  void addToIndex(const envoy::source::extensions::filters::http::cache::CacheFileHeader& header,
+                  const std::string& file_name, uint64_t file_size, bool replace,
+                  bool most_recent, std::vector<std::string>& obsolete_files);
+  void evict(std::vector<std::string>& obsolete_files) ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+  void removeFiles(const std::vector<std::string>& file_names);
+  std::string filePath(absl::string_view file_name) const;
+
+  const std::string cache_path_;
+  const uint64_t max_size_bytes_;
+  const uint64_t max_entry_size_bytes_;
+  const bool use_mmap_;
+  Random::RandomGeneratorImpl random_;
+
+  mutable absl::Mutex mutex_;
+  // Entries by the hash of their key. An entry whose key hash collides with another's replaces it.
+  absl::flat_hash_map<uint64_t, IndexEntry> index_ ABSL_GUARDED_BY(mutex_);
+  // Key hashes of index_ in eviction order: the front is the least recently used entry.
+  std::list<uint64_t> recency_ ABSL_GUARDED_BY(mutex_);
+  uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_){};
+
+  // Declared last so that the threads are joined before the index is destroyed.
+  IoThreadPool io_threads_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,77 @@
+#include "extensions/filters/http/cache/file_system_http_cache/io_thread_pool.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+IoThreadPool::IoThreadPool(Thread::ThreadFactory& thread_factory, uint32_t threads,
+                           const std::string& name) {
+  ASSERT(threads > 0);
+  threads_.reserve(threads);
+  for (uint32_t i = 0; i < threads; ++i) {
+    threads_.push_back(
+        thread_factory.createThread([this]() -> void { threadRoutine(); }, Thread::Options{name}));
+  }
+}
+
+IoThreadPool::~IoThreadPool() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    task_posted_.notifyAll();
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+void IoThreadPool::post(Task&& task) {
+  Thread::LockGuard lock(lock_);
+  tasks_.push_back(std::move(task));
+  task_posted_.notifyOne();
+}
+
+void IoThreadPool::waitForIdle() {
+  Thread::LockGuard lock(lock_);
+  while (!tasks_.empty() || running_tasks_ > 0) {
+    idle_.wait(lock_);
+  }
+}
+
+void IoThreadPool::threadRoutine() {
+  while (true) {
+    Task task;
+    {
+      Thread::LockGuard lock(lock_);
+      while (tasks_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        task_posted_.wait(lock_);
+      }
+      if (tasks_.empty()) {
+        // Only reached on exit, once every posted task has been taken.
+        return;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+      ++running_tasks_;
+    }
+
+    task();
+    // Destroy the task before it counts as finished.
+    task = nullptr;
+
+    Thread::LockGuard lock(lock_);
+    if (--running_tasks_ == 0 && tasks_.empty()) {
+      idle_.notifyAll();
+    }
+  }
+}
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "envoy/thread/thread.h"
+
+#include "common/common/non_copyable.h"
+#include "common/common/thread.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * Fixed size pool of threads running blocking file system operations on behalf of the workers.
+ * Tasks start in the order they are posted, but may run concurrently with each other.
+ */
+class IoThreadPool : NonCopyable {
+public:
+  using Task = std::function<void()>;
+
+  /**
+   * @param thread_factory creates the threads.
+   * @param threads the number of threads, at least one.
+   * @param name the name of the threads.
+   */
+  IoThreadPool(Thread::ThreadFactory& thread_factory, uint32_t threads, const std::string& name);
+
+  /**
+   * Runs the tasks already posted, then joins the threads.
+   */
+  ~IoThreadPool();
+
+  /**
+   * Queue a task to run on one of the threads. Thread safe.
+   */
+  void post(Task&& task);
+
+  /**
+   * Blocks until no tasks are queued or running.
+   */
+  void waitForIdle();
+
+private:
+  void threadRoutine();
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar task_posted_;
+  Thread::CondVar idle_;
+  std::list<Task> tasks_ ABSL_GUARDED_BY(lock_);
+  uint32_t running_tasks_ ABSL_GUARDED_BY(lock_){};
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "envoy/config/typed_config.h"
 #include "envoy/extensions/filters/http/cache/v3alpha/cache.pb.h"
 #include "envoy/http/header_map.h"
+#include "envoy/server/factory_context.h"
 
 #include "common/common/assert.h"
 #include "common/common/logger.h"
@@ -374,9 +375,11 @@ public:
   std::string category() const override { return "envoy.http.cache"; }
 
   // Returns an HttpCache that will remain valid indefinitely (at least as long
-  // as the calling CacheFilter).
+  // as the calling CacheFilter). Called when the filter is configured; context
+  // supplies the server facilities (e.g. threads) a storage plugin may need.
   virtual HttpCache&
-  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config) PURE;
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext& context) PURE;
   ~HttpCacheFactory() override = default;
 
 private:
@@ -0,0 +1,350 @@
+#include "extensions/filters/http/cache/sharded_http_cache/sharded_http_cache.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/assert.h"
+#include "common/http/header_map_impl.h"
+
+#include "source/extensions/filters/http/cache/sharded_http_cache/config.pb.h"
+
+#include "absl/container/flat_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+constexpr uint64_t DefaultMaxSizeBytes = 64 * 1024 * 1024;
+constexpr uint32_t DefaultShards = 16;
+constexpr uint32_t MaxShards = 1u << 16;
+
+// Rounds the configured number of shards up to a power of two.
+uint32_t shardCount(uint32_t shards) {
+  uint32_t count = 1;
+  while (count < shards && count < MaxShards) {
+    count <<= 1;
+  }
+  return count;
+}
+
+class ShardedLookupContext : public LookupContext {
+public:
+  ShardedLookupContext(ShardedHttpCache& cache, LookupRequest&& request)
+      : cache_(cache), request_(std::move(request)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override {
+    auto entry = cache_.lookup(request_);
+    body_ = std::move(entry.body_);
+    cb(entry.response_headers_ ? request_.makeLookupResult(std::move(entry.response_headers_),
+                                                           std::move(entry.metadata_),
+                                                           body_->size())
+                               : LookupResult{});
+  }
+
+  void getBody(const AdjustedByteRange& range, LookupBodyCallback&& cb) override {
+    ASSERT(body_ != nullptr);
+    ASSERT(range.end() <= body_->length(), "Attempt to read past end of body.");
+    auto buffer = std::make_unique<Buffer::OwnedImpl>();
+    if (range.length() > 0) {
+      // Reference the cached body rather than copying it. The fragment keeps the body alive
+      // after the entry is evicted, until the buffer is drained.
+      auto* fragment = new Buffer::BufferFragmentImpl(
+          body_->data() + range.begin(), range.length(),
+          [body = body_](const void*, size_t, const Buffer::BufferFragmentImpl* this_fragment) {
+            delete this_fragment;
+          });
+      buffer->addBufferFragment(*fragment);
+    }
+    cb(std::move(buffer));
+  }
+
+  void getTrailers(LookupTrailersCallback&&) override {
+    // TODO(toddmgreer): Support trailers.
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE;
+  }
+
+  const LookupRequest& request() const { return request_; }
+  void onDestroy() override {}
+
+private:
+  ShardedHttpCache& cache_;
+  const LookupRequest request_;
+  std::shared_ptr<const std::string> body_;
+};
+
+class ShardedInsertContext : public InsertContext {
+public:
+  ShardedInsertContext(LookupContext& lookup_context, ShardedHttpCache& cache)
+      : key_(dynamic_cast<ShardedLookupContext&>(lookup_context).request().key()),
+        entry_vary_headers_(
+            dynamic_cast<ShardedLookupContext&>(lookup_context).request().getVaryHeaders()),
+        cache_(cache) {}
+
+  void insertHeaders(const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata, bool end_stream) override {
+    ASSERT(!committed_);
+    response_headers_ = Http::createHeaderMap<Http::ResponseHeaderMapImpl>(response_headers);
+    metadata_ = metadata;
+    if (end_stream) {
+      commit();
+    }
+  }
+
+  void insertBody(const Buffer::Instance& chunk, InsertCallback ready_for_next_chunk,
+                  bool end_stream) override {
+    ASSERT(!committed_);
+    ASSERT(ready_for_next_chunk || end_stream);
+
+    body_.add(chunk);
+    if (end_stream) {
+      commit();
+    } else {
+      ready_for_next_chunk(true);
+    }
+  }
+
+  void insertTrailers(const Http::ResponseTrailerMap&) override {
+    NOT_IMPLEMENTED_GCOVR_EXCL_LINE; // TODO(toddmgreer): support trailers
+  }
+
+  void onDestroy() override {}
+
+private:
+  void commit() {
+    committed_ = true;
+    if (VaryHeader::hasVary(*response_headers_)) {
+      cache_.varyInsert(key_, std::move(response_headers_), std::move(metadata_), body_.toString(),
+                        entry_vary_headers_);
+    } else {
+      cache_.insert(key_, std::move(response_headers_), std::move(metadata_), body_.toString());
+    }
+  }
+
+  Key key_;
+  Http::ResponseHeaderMapPtr response_headers_;
+  ResponseMetadata metadata_;
+  const Http::RequestHeaderMap& entry_vary_headers_;
+  ShardedHttpCache& cache_;
+  Buffer::OwnedImpl body_;
+  bool committed_ = false;
+};
+} // namespace
+
+ShardedHttpCache::ShardedHttpCache(uint64_t max_size_bytes, uint32_t shards,
+                                   EvictionPolicy eviction_policy)
+    : eviction_policy_(eviction_policy), shard_budget_bytes_(max_size_bytes / shardCount(shards)),
+      shard_mask_(shardCount(shards) - 1),
+      shards_(std::make_unique<Shard[]>(shardCount(shards))) {}
+
+LookupContextPtr ShardedHttpCache::makeLookupContext(LookupRequest&& request) {
+  return std::make_unique<ShardedLookupContext>(*this, std::move(request));
+}
+
+InsertContextPtr ShardedHttpCache::makeInsertContext(LookupContextPtr&& lookup_context) {
+  ASSERT(lookup_context != nullptr);
+  return std::make_unique<ShardedInsertContext>(*lookup_context, *this);
+}
+
+void ShardedHttpCache::updateHeaders(const LookupContext&, const Http::ResponseHeaderMap&,
+                                     const ResponseMetadata&) {
+  // TODO(toddmgreer): Support updating headers.
+}
+
+ShardedHttpCache::Shard& ShardedHttpCache::shardFor(const Key& key) const {
+  return shards_[(MessageUtil::hash(key) >> 32) & shard_mask_];
+}
+
+ShardedHttpCache::Entry ShardedHttpCache::lookup(const LookupRequest& request) {
+  Entry entry = find(request.key());
+  if (entry.response_headers_ == nullptr || !VaryHeader::hasVary(*entry.response_headers_)) {
+    return entry;
+  }
+
+  // The entry under the request key only records that the response varies. The response itself is
+  // stored under a key extended with the values of the varied request headers, which may live in
+  // another shard.
+  const auto vary_header = entry.response_headers_->get(Http::Headers::get().Vary);
+  Key varied_request_key = request.key();
+  varied_request_key.add_custom_fields(
+      VaryHeader::createVaryKey(vary_header, request.getVaryHeaders()));
+  return find(varied_request_key);
+}
+
+ShardedHttpCache::Entry ShardedHttpCache::find(const Key& key) {
+  Shard& shard = shardFor(key);
+  const auto copy = [](const StoredEntry& entry) {
+    ASSERT(entry.response_headers_);
+    return Entry{Http::createHeaderMap<Http::ResponseHeaderMapImpl>(*entry.response_headers_),
+                 entry.metadata_, entry.body_};
+  };
+
+  if (eviction_policy_ == EvictionPolicy::Clock) {
+    absl::ReaderMutexLock lock(&shard.mutex_);
+    auto iter = shard.map_.find(key);
+    if (iter == shard.map_.end()) {
+      return Entry{};
+    }
+    iter->second.referenced_.store(true, std::memory_order_relaxed);
+    return copy(iter->second);
+  }
+
+  absl::WriterMutexLock lock(&shard.mutex_);
+  auto iter = shard.map_.find(key);
+  if (iter == shard.map_.end()) {
+    return Entry{};
+  }
+  shard.recency_.splice(shard.recency_.end(), shard.recency_, iter->second.recency_);
+  return copy(iter->second);
+}
+
+void ShardedHttpCache::insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+                              ResponseMetadata&& metadata, std::string&& body) {
+  store(key, std::move(response_headers), std::move(metadata), std::move(body), true);
+}
+
+void ShardedHttpCache::varyInsert(const Key& request_key,
+                                  Http::ResponseHeaderMapPtr&& response_headers,
+                                  ResponseMetadata&& metadata, std::string&& body,
+                                  const Http::RequestHeaderMap& request_vary_headers) {
+  const auto vary_header = response_headers->get(Http::Headers::get().Vary);
+  ASSERT(!vary_header.empty());
+
+  // TODO(mattklein123): Support multiple vary headers and/or just make the vary header inline.
+  Http::ResponseHeaderMapPtr vary_only_map = Http::createHeaderMap<Http::ResponseHeaderMapImpl>({});
+  vary_only_map->setCopy(Http::Headers::get().Vary, vary_header[0]->value().getStringView());
+
+  // Insert the varied response.
+  Key varied_request_key = request_key;
+  varied_request_key.add_custom_fields(
+      VaryHeader::createVaryKey(vary_header, request_vary_headers));
+  store(varied_request_key, std::move(response_headers), std::move(metadata), std::move(body),
+        true);
+
+  // Add a special entry to flag that this request generates varied responses. If it is evicted
+  // before the varied responses, lookups miss until one of them is inserted again.
+  store(request_key, std::move(vary_only_map), {}, "", false);
+}
+
+void ShardedHttpCache::store(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+                             ResponseMetadata&& metadata, std::string&& body, bool replace) {
+  const uint64_t charge = key.ByteSizeLong() + response_headers->byteSize() + body.size();
+  if (charge > shard_budget_bytes_) {
+    return;
+  }
+  auto shared_body = std::make_shared<const std::string>(std::move(body));
+
+  Shard& shard = shardFor(key);
+  ReleasedBodies released;
+  absl::WriterMutexLock lock(&shard.mutex_);
+  if (shard.map_.contains(key)) {
+    if (!replace) {
+      return;
+    }
+    remove(shard, key, released);
+  }
+  evict(shard, charge, released);
+
+  auto result = shard.map_.try_emplace(key, std::move(response_headers), std::move(metadata),
+                                       std::move(shared_body), charge);
+  ASSERT(result.second);
+  result.first->second.recency_ = shard.recency_.insert(shard.recency_.end(), &result.first->first);
+  shard.size_bytes_ += charge;
+}
+
+void ShardedHttpCache::evict(Shard& shard, uint64_t charge, ReleasedBodies& released) {
+  // Each CLOCK pass over the recency list clears the reference bits it passes, so this terminates
+  // after at most two passes.
+  while (shard.size_bytes_ + charge > shard_budget_bytes_ && !shard.recency_.empty()) {
+    const Key& candidate = *shard.recency_.front();
+    StoredEntry& entry = shard.map_.find(candidate)->second;
+    if (eviction_policy_ == EvictionPolicy::Clock &&
+        entry.referenced_.exchange(false, std::memory_order_relaxed)) {
+      shard.recency_.splice(shard.recency_.end(), shard.recency_, entry.recency_);
+      continue;
+    }
+    remove(shard, candidate, released);
+  }
+}
+
+void ShardedHttpCache::remove(Shard& shard, const Key& key, ReleasedBodies& released) {
+  auto iter = shard.map_.find(key);
+  ASSERT(iter != shard.map_.end());
+  shard.size_bytes_ -= iter->second.charge_;
+  shard.recency_.erase(iter->second.recency_);
+  released.push_back(std::move(iter->second.body_));
+  shard.map_.erase(iter);
+}
+
+uint64_t ShardedHttpCache::sizeBytes() const {
+  uint64_t size_bytes = 0;
+  for (uint64_t i = 0; i <= shard_mask_; ++i) {
+    absl::ReaderMutexLock lock(&shards_[i].mutex_);
+    size_bytes += shards_[i].size_bytes_;
+  }
+  return size_bytes;
+}
+
+uint64_t ShardedHttpCache::entryCount() const {
+  uint64_t entries = 0;
+  for (uint64_t i = 0; i <= shard_mask_; ++i) {
+    absl::ReaderMutexLock lock(&shards_[i].mutex_);
+    entries += shards_[i].map_.size();
+  }
+  return entries;
+}
+
+constexpr absl::string_view Name = "envoy.extensions.http.cache.sharded";
+
+CacheInfo ShardedHttpCache::cacheInfo() const {
+  CacheInfo cache_info;
+  cache_info.name_ = Name;
+  return cache_info;
+}
+
+class ShardedHttpCacheFactory : public HttpCacheFactory {
+public:
+  // From UntypedFactory
+  std::string name() const override { return std::string(Name); }
+  // From TypedFactory
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override {
+    return std::make_unique<
+        envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig>();
+  }
+  // From HttpCacheFactory
+  HttpCache&
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig& config,
+           Server::Configuration::FactoryContext&) override {
+    envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig sharded_config;
+    MessageUtil::unpackTo(config.typed_config(), sharded_config);
+
+    // Filters configured with the same cache settings share one cache.
+    absl::MutexLock lock(&mutex_);
+    std::unique_ptr<ShardedHttpCache>& cache = caches_[sharded_config];
+    if (cache == nullptr) {
+      cache = std::make_unique<ShardedHttpCache>(
+          sharded_config.max_size_bytes() > 0 ? sharded_config.max_size_bytes()
+                                              : DefaultMaxSizeBytes,
+          sharded_config.shards() > 0 ? sharded_config.shards() : DefaultShards,
+          sharded_config.eviction_policy() ==
+                  envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig::CLOCK
+              ? ShardedHttpCache::EvictionPolicy::Clock
+              : ShardedHttpCache::EvictionPolicy::Lru);
+    }
+    return *cache;
+  }
+
+private:
+  absl::Mutex mutex_;
+  absl::flat_hash_map<envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig,
+                      std::unique_ptr<ShardedHttpCache>, MessageUtil, MessageUtil>
+      caches_ ABSL_GUARDED_BY(mutex_);
+};
+
+static Registry::RegisterFactory<ShardedHttpCacheFactory, HttpCacheFactory> register_;
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,128 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/filters/http/cache/http_cache.h"
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/node_hash_map.h"
+#include "absl/synchronization/mutex.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+
+/**
+ * In-memory cache backend which bounds its size and evicts entries when it is full.
+ *
+ * Entries are spread over independently locked shards by the hash of their key, so lookups and
+ * inserts of different keys rarely contend. Each shard owns an equal part of the byte budget and
+ * evicts its own entries with either LRU or CLOCK. Bodies are immutable once inserted and shared
+ * with the buffers handed out by getBody(), so hits don't copy the body.
+ */
+class ShardedHttpCache : public HttpCache {
+public:
+  enum class EvictionPolicy { Lru, Clock };
+
+  struct Entry {
+    Http::ResponseHeaderMapPtr response_headers_;
+    ResponseMetadata metadata_;
+    std::shared_ptr<const std::string> body_;
+  };
+
+  /**
+   * @param max_size_bytes the budget for keys, headers and bodies of all shards.
+   * @param shards the number of shards, rounded up to a power of two.
+   * @param eviction_policy how each shard picks the entries to evict.
+   */
+  ShardedHttpCache(uint64_t max_size_bytes, uint32_t shards, EvictionPolicy eviction_policy);
+
+  // HttpCache
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override;
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override;
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata) override;
+  CacheInfo cacheInfo() const override;
+
+  Entry lookup(const LookupRequest& request);
+  void insert(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+              ResponseMetadata&& metadata, std::string&& body);
+
+  // Inserts a response that has been varied on certain headers.
+  void varyInsert(const Key& request_key, Http::ResponseHeaderMapPtr&& response_headers,
+                  ResponseMetadata&& metadata, std::string&& body,
+                  const Http::RequestHeaderMap& request_vary_headers);
+
+  /**
+   * @return uint64_t the bytes currently charged against the budget, summed over all shards.
+   */
+  uint64_t sizeBytes() const;
+
+  /**
+   * @return uint64_t the number of entries held, including the entries which mark varied
+   *         responses.
+   */
+  uint64_t entryCount() const;
+
+private:
+  struct StoredEntry {
+    StoredEntry(Http::ResponseHeaderMapPtr&& response_headers, ResponseMetadata&& metadata,
+                std::shared_ptr<const std::string>&& body, uint64_t charge)
+        : response_headers_(std::move(response_headers)), metadata_(std::move(metadata)),
+          body_(std::move(body)), charge_(charge) {}
+
+    const Http::ResponseHeaderMapPtr response_headers_;
+    const ResponseMetadata metadata_;
+    std::shared_ptr<const std::string> body_;
+    const uint64_t charge_;
+    // Position of the entry's key in Shard::recency_.
+    std::list<const Key*>::iterator recency_;
+    // CLOCK reference bit. Set by hits holding the shard lock shared.
+    std::atomic<bool> referenced_{false};
+  };
+
+  struct Shard {
+    mutable absl::Mutex mutex_;
+    // A node map, so that the keys referenced from recency_ don't move on rehash.
+    absl::node_hash_map<Key, StoredEntry, MessageUtil, MessageUtil> map_ ABSL_GUARDED_BY(mutex_);
+    // Keys of map_ in eviction order: the front is the next candidate for eviction.
+    std::list<const Key*> recency_ ABSL_GUARDED_BY(mutex_);
+    uint64_t size_bytes_ ABSL_GUARDED_BY(mutex_){};
+  };
+  using ReleasedBodies = std::vector<std::shared_ptr<const std::string>>;
+
+  Shard& shardFor(const Key& key) const;
+  // Looks up a single key, without following vary markers.
+  Entry find(const Key& key);
+  // Stores an entry under key. If replace is false and the key is already present the existing
+  // entry is kept.
+  void store(const Key& key, Http::ResponseHeaderMapPtr&& response_headers,
+             ResponseMetadata&& metadata, std::string&& body, bool replace);
+  // Evicts entries until charge more bytes fit into the shard's budget. The bodies of evicted
+  // entries are moved to released so that they are freed after the shard lock is dropped.
+  void evict(Shard& shard, uint64_t charge, ReleasedBodies& released)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+  void remove(Shard& shard, const Key& key, ReleasedBodies& released)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const EvictionPolicy eviction_policy_;
+  const uint64_t shard_budget_bytes_;
+  // Shards are indexed by the upper half of the key hash, as the shard maps bucket and filter on
+  // the lower bits.
+  const uint64_t shard_mask_;
+  const std::unique_ptr<Shard[]> shards_;
+};
+
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -218,7 +218,8 @@ public:
   }
   // From HttpCacheFactory
   HttpCache&
-  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&) override {
+  getCache(const envoy::extensions::filters::http::cache::v3alpha::CacheConfig&,
+           Server::Configuration::FactoryContext&) override {
     return cache_;
   }
 
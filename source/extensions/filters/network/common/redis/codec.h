@@ -27,9 +27,19 @@ enum class RespType { Null, SimpleString, BulkString, Integer, Error, Array, Com
 /**
  * A variant implementation of a RESP value optimized for performance. A C++11 union is used for
  * the underlying type so that no unnecessary allocations/constructions are needed.
+ *
+ * A BulkString may reference a buffer instead of holding its bytes in a string, see
+ * bulkStringBuffer(). This is how large values are decoded, so that they are forwarded without
+ * being copied.
  */
 class RespValue {
 public:
+  /**
+   * Holds the bytes of a BulkString. The buffer is shared by the copies of the value and by the
+   * buffers it is encoded to, which reference its slices, so it must not be modified.
+   */
+  using BulkStringBufferSharedPtr = std::shared_ptr<const Buffer::Instance>;
+
   RespValue() : type_(RespType::Null) {}
 
   RespValue(std::shared_ptr<RespValue> base_array, const RespValue& command, const uint64_t start,
@@ -119,6 +129,7 @@ public:
    */
   std::vector<RespValue>& asArray();
   const std::vector<RespValue>& asArray() const;
+  // For a BulkString referencing a buffer, the bytes are copied to the string on first use.
   std::string& asString();
   const std::string& asString() const;
   int64_t& asInteger();
@@ -133,17 +144,39 @@ public:
   RespType type() const { return type_; }
   void type(RespType type);
 
+  /**
+   * Sets the bytes of a BulkString to the content of a buffer, which is referenced rather than
+   * copied. Encoding the value then references the slices of the buffer too.
+   * @param buffer supplies the bytes of the value.
+   */
+  void bulkStringBuffer(BulkStringBufferSharedPtr buffer);
+
+  /**
+   * @return the buffer holding the bytes of a BulkString, or nullptr if they are held by the
+   *         string returned by asString().
+   */
+  const BulkStringBufferSharedPtr& bulkStringBuffer() const { return bulk_string_buffer_; }
+
+  /**
+   * @return the length of a SimpleString, BulkString or Error, without copying the bytes of a
+   *         BulkString referencing a buffer.
+   */
+  uint64_t stringLength() const;
+
 private:
   union {
     std::vector<RespValue> array_;
-    std::string string_;
+    // Mutable so that the const asString() can copy the bytes of bulk_string_buffer_.
+    mutable std::string string_;
     int64_t integer_;
     CompositeArray composite_array_;
   };
 
   void cleanup();
+  void materializeBulkString() const;
 
   RespType type_{};
+  mutable BulkStringBufferSharedPtr bulk_string_buffer_;
 };
 
 using RespValuePtr = std::unique_ptr<RespValue>;
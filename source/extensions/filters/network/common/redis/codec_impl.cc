@@ -18,6 +18,28 @@ namespace Extensions {
 namespace NetworkFilters {
 namespace Common {
 namespace Redis {
+namespace {
+
+/**
+ * References a slice of the buffer of a BulkString from an encoded buffer, keeping the buffer
+ * alive until the encoded buffer is done with the slice.
+ */
+class BulkStringFragment : public Buffer::BufferFragment {
+public:
+  BulkStringFragment(RespValue::BulkStringBufferSharedPtr buffer, const Buffer::RawSlice& slice)
+      : buffer_(std::move(buffer)), slice_(slice) {}
+
+  // Buffer::BufferFragment
+  const void* data() const override { return slice_.mem_; }
+  size_t size() const override { return slice_.len_; }
+  void done() override { delete this; }
+
+private:
+  const RespValue::BulkStringBufferSharedPtr buffer_;
+  const Buffer::RawSlice slice_;
+};
+
+} // namespace
 
 std::string RespValue::toString() const {
   switch (type_) {
@@ -45,7 +67,9 @@ std::string RespValue::toString() const {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error:
-    return fmt::format("\"{}\"", asString());
+    // Doesn't use asString(), which would keep a copy of the bytes of a buffer.
+    return fmt::format("\"{}\"",
+                       bulk_string_buffer_ ? bulk_string_buffer_->toString() : string_);
   case RespType::Null:
     return "null";
   case RespType::Integer:
@@ -68,15 +92,36 @@ const std::vector<RespValue>& RespValue::asArray() const {
 std::string& RespValue::asString() {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  materializeBulkString();
   return string_;
 }
 
 const std::string& RespValue::asString() const {
   ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
          type_ == RespType::SimpleString);
+  materializeBulkString();
   return string_;
 }
 
+void RespValue::materializeBulkString() const {
+  if (bulk_string_buffer_ != nullptr) {
+    string_ = bulk_string_buffer_->toString();
+    bulk_string_buffer_.reset();
+  }
+}
+
+void RespValue::bulkStringBuffer(BulkStringBufferSharedPtr buffer) {
+  ASSERT(type_ == RespType::BulkString);
+  string_.clear();
+  bulk_string_buffer_ = std::move(buffer);
+}
+
+uint64_t RespValue::stringLength() const {
+  ASSERT(type_ == RespType::BulkString || type_ == RespType::Error ||
+         type_ == RespType::SimpleString);
+  return bulk_string_buffer_ ? bulk_string_buffer_->length() : string_.size();
+}
+
 int64_t& RespValue::asInteger() {
   ASSERT(type_ == RespType::Integer);
   return integer_;
@@ -112,6 +157,7 @@ void RespValue::cleanup() {
   case RespType::BulkString:
   case RespType::Error: {
     string_.~basic_string<char>();
+    bulk_string_buffer_.reset();
     break;
   }
   case RespType::Null:
@@ -162,7 +208,9 @@ RespValue::RespValue(const RespValue& other) : type_(RespType::Null) {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
-    asString() = other.asString();
+    // The buffer of a BulkString is shared rather than copied.
+    string_ = other.string_;
+    bulk_string_buffer_ = other.bulk_string_buffer_;
     break;
   }
   case RespType::Integer: {
@@ -188,6 +236,7 @@ RespValue::RespValue(RespValue&& other) noexcept : type_(other.type_) {
   case RespType::BulkString:
   case RespType::Error: {
     new (&string_) std::string(std::move(other.string_));
+    bulk_string_buffer_ = std::move(other.bulk_string_buffer_);
     break;
   }
   case RespType::Integer: {
@@ -216,7 +265,9 @@ RespValue& RespValue::operator=(const RespValue& other) {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
-    asString() = other.asString();
+    // The buffer of a BulkString is shared rather than copied.
+    string_ = other.string_;
+    bulk_string_buffer_ = other.bulk_string_buffer_;
     break;
   }
   case RespType::Integer: {
@@ -248,6 +299,7 @@ RespValue& RespValue::operator=(RespValue&& other) noexcept {
   case RespType::BulkString:
   case RespType::Error: {
     string_ = std::move(other.string_);
+    bulk_string_buffer_ = std::move(other.bulk_string_buffer_);
     break;
   }
   case RespType::Integer: {
@@ -278,7 +330,14 @@ bool RespValue::operator==(const RespValue& other) const {
   case RespType::SimpleString:
   case RespType::BulkString:
   case RespType::Error: {
-    result = (asString() == other.asString());
+    if (bulk_string_buffer_ == nullptr && other.bulk_string_buffer_ == nullptr) {
+      result = (string_ == other.string_);
+    } else {
+      result = (stringLength() == other.stringLength() &&
+                (bulk_string_buffer_ ? bulk_string_buffer_->toString() : string_) ==
+                    (other.bulk_string_buffer_ ? other.bulk_string_buffer_->toString()
+                                               : other.string_));
+    }
     break;
   }
   case RespType::Integer: {
@@ -330,14 +389,26 @@ RespValue::CompositeArray::CompositeArrayConstIterator::empty() {
 }
 
 void DecoderImpl::decode(Buffer::Instance& data) {
-  for (const Buffer::RawSlice& slice : data.getRawSlices()) {
-    parseSlice(slice);
-  }
+  while (data.length() > 0) {
+    if (pending_bulk_string_ != nullptr) {
+      // The body of a large BulkString is moved out of data. Only the partial slices at its ends
+      // are copied.
+      ASSERT(state_ == State::BulkStringBody);
+      const uint64_t length = std::min(pending_integer_.integer_, data.length());
+      pending_bulk_string_->move(data, length);
+      pending_integer_.integer_ -= length;
+      if (pending_integer_.integer_ == 0) {
+        pending_value_stack_.front().value_->bulkStringBuffer(std::move(pending_bulk_string_));
+        state_ = State::CR;
+      }
+      continue;
+    }
 
-  data.drain(data.length());
+    data.drain(parseSlice(data.frontSlice()));
+  }
 }
 
-void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
+uint64_t DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
   const char* buffer = reinterpret_cast<const char*>(slice.mem_);
   uint64_t remaining = slice.len_;
 
@@ -460,6 +531,11 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
         if (!pending_integer_.negative_) {
           // TODO(mattklein123): reserve and define max length since we don't stream currently.
           state_ = State::BulkStringBody;
+          if (pending_integer_.integer_ >= MinBufferedBulkStringLength) {
+            // Let decode() move the body out of the input buffer.
+            pending_bulk_string_ = std::make_shared<Buffer::OwnedImpl>();
+            return slice.len_ - remaining;
+          }
         } else {
           // Null bulk string. Switch type to null and move to value complete.
           current_value.value_->type(RespType::Null);
@@ -547,6 +623,8 @@ void DecoderImpl::parseSlice(const Buffer::RawSlice& slice) {
     }
     }
   }
+
+  return slice.len_;
 }
 
 void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
@@ -564,7 +642,11 @@ void EncoderImpl::encode(const RespValue& value, Buffer::Instance& out) {
     break;
   }
   case RespType::BulkString: {
-    encodeBulkString(value.asString(), out);
+    if (value.bulkStringBuffer() != nullptr) {
+      encodeBulkStringBuffer(value.bulkStringBuffer(), out);
+    } else {
+      encodeBulkString(value.asString(), out);
+    }
     break;
   }
   case RespType::Error: {
@@ -621,6 +703,23 @@ void EncoderImpl::encodeBulkString(const std::string& string, Buffer::Instance&
   out.add("\r\n", 2);
 }
 
+void EncoderImpl::encodeBulkStringBuffer(const RespValue::BulkStringBufferSharedPtr& buffer,
+                                         Buffer::Instance& out) {
+  char header[32];
+  char* current = header;
+  *current++ = '$';
+  current += StringUtil::itoa(current, 21, buffer->length());
+  *current++ = '\r';
+  *current++ = '\n';
+  out.add(header, current - header);
+  // The slices are referenced rather than copied, as the value may be encoded again, e.g. when a
+  // request is redirected.
+  for (const Buffer::RawSlice& slice : buffer->getRawSlices()) {
+    out.addBufferFragment(*new BulkStringFragment(buffer, slice));
+  }
+  out.add("\r\n", 2);
+}
+
 void EncoderImpl::encodeError(const std::string& string, Buffer::Instance& out) {
   out.add("-", 1);
   out.add(string);
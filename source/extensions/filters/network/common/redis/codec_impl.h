@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 
+#include "common/buffer/buffer_impl.h"
 #include "common/common/logger.h"
 
 #include "extensions/filters/network/common/redis/codec.h"
@@ -19,11 +20,16 @@ namespace Redis {
  * Decoder implementation of https://redis.io/topics/protocol
  *
  * This implementation buffers when needed and will always consume all bytes passed for decoding.
+ * The body of a BulkString of at least MinBufferedBulkStringLength bytes is moved out of the
+ * decoded buffer rather than copied, see RespValue::bulkStringBuffer().
  */
 class DecoderImpl : public Decoder, Logger::Loggable<Logger::Id::redis> {
 public:
   DecoderImpl(DecoderCallbacks& callbacks) : callbacks_(callbacks) {}
 
+  // Below a read slice, moving a value would copy its bytes anyway, as partial slices are copied.
+  static constexpr uint64_t MinBufferedBulkStringLength = 16 * 1024;
+
   // RedisProxy::Decoder
   void decode(Buffer::Instance& data) override;
 
@@ -56,13 +62,20 @@ private:
     uint64_t current_array_element_;
   };
 
-  void parseSlice(const Buffer::RawSlice& slice);
+  /**
+   * Parses the bytes of a slice.
+   * @return the number of bytes parsed, which is less than the length of the slice when the body
+   *         of a large BulkString starts.
+   */
+  uint64_t parseSlice(const Buffer::RawSlice& slice);
 
   DecoderCallbacks& callbacks_;
   State state_{State::ValueRootStart};
   PendingInteger pending_integer_;
   RespValuePtr pending_value_root_;
   std::forward_list<PendingValue> pending_value_stack_;
+  // The body of the large BulkString being decoded.
+  std::shared_ptr<Buffer::OwnedImpl> pending_bulk_string_;
 };
 
 /**
@@ -88,6 +101,8 @@ private:
   void encodeArray(const std::vector<RespValue>& array, Buffer::Instance& out);
   void encodeCompositeArray(const RespValue::CompositeArray& array, Buffer::Instance& out);
   void encodeBulkString(const std::string& string, Buffer::Instance& out);
+  void encodeBulkStringBuffer(const RespValue::BulkStringBufferSharedPtr& buffer,
+                              Buffer::Instance& out);
   void encodeError(const std::string& string, Buffer::Instance& out);
   void encodeInteger(int64_t integer, Buffer::Instance& out);
   void encodeSimpleString(const std::string& string, Buffer::Instance& out);
@@ -53,6 +53,11 @@ struct SupportedCommands {
    */
   static const std::string& auth() { CONSTRUCT_ON_FIRST_USE(std::string, "auth"); }
 
+  /**
+   * @return get command
+   */
+  static const std::string& get() { CONSTRUCT_ON_FIRST_USE(std::string, "get"); }
+
   /**
    * @return mget command
    */
@@ -68,6 +73,11 @@ struct SupportedCommands {
    */
   static const std::string& ping() { CONSTRUCT_ON_FIRST_USE(std::string, "ping"); }
 
+  /**
+   * @return set command
+   */
+  static const std::string& set() { CONSTRUCT_ON_FIRST_USE(std::string, "set"); }
+
   /**
    * @return commands which alters the state of redis
    */
@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "envoy/common/pure.h"
+
+#include "extensions/filters/network/common/redis/codec.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * A cache of the values read from the upstream hosts of a connection pool, local to a worker. The
+ * cache is kept coherent by the invalidation messages the hosts send when keys are written to.
+ */
+class ClientCache {
+public:
+  virtual ~ClientCache() = default;
+
+  /**
+   * Looks up the cached value of a key.
+   * @param key supplies the key, as sent upstream.
+   * @return the cached value, or nullptr if the key isn't cached. The value is only valid until the
+   *         next call to the cache.
+   */
+  virtual const Common::Redis::RespValue* lookup(const std::string& key) PURE;
+
+  /**
+   * Called before reading a key from upstream, so that the value read can be cached. If the key is
+   * invalidated before the value is read, the value is not cached.
+   * @param key supplies the key, as sent upstream.
+   * @return an id to pass to fill() or cancelFill(), or 0 if the value can't be cached.
+   */
+  virtual uint64_t startFill(const std::string& key) PURE;
+
+  /**
+   * Caches the value read for a key, unless it was invalidated since startFill().
+   * @param key supplies the key, as sent upstream.
+   * @param fill_id supplies the id returned by startFill().
+   * @param value supplies the value read, which is only cached if it is a bulk string or null.
+   */
+  virtual void fill(const std::string& key, uint64_t fill_id,
+                    const Common::Redis::RespValue& value) PURE;
+
+  /**
+   * Called instead of fill() when reading a key failed or was canceled.
+   * @param key supplies the key, as sent upstream.
+   * @param fill_id supplies the id returned by startFill().
+   */
+  virtual void cancelFill(const std::string& key, uint64_t fill_id) PURE;
+};
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
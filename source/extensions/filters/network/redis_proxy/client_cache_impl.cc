@@ -0,0 +1,373 @@
+#include "extensions/filters/network/redis_proxy/client_cache_impl.h"
+
+#include <iterator>
+
+#include "common/protobuf/utility.h"
+
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+namespace {
+
+// The channel the invalidation messages are published to with RESP2.
+constexpr absl::string_view InvalidationChannel = "__redis__:invalidate";
+
+bool isBulkString(const Common::Redis::RespValue& value, absl::string_view string) {
+  return value.type() == Common::Redis::RespType::BulkString && value.asString() == string;
+}
+
+// Returns whether the value is a message of a subscribed connection, e.g. "message", the channel
+// and the payload.
+bool isPubSubMessage(const Common::Redis::RespValue& value, absl::string_view kind) {
+  return value.type() == Common::Redis::RespType::Array && value.asArray().size() == 3 &&
+         isBulkString(value.asArray()[0], kind) &&
+         isBulkString(value.asArray()[1], InvalidationChannel);
+}
+
+} // namespace
+
+ClientCacheConfig::ClientCacheConfig(
+    const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::ClientSideCache&
+        config)
+    : max_entries_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_entries, 10000)),
+      max_ttl_(PROTOBUF_GET_MS_REQUIRED(config, max_ttl)),
+      max_value_bytes_(PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_value_bytes, 16384)),
+      prefixes_(config.prefixes().begin(), config.prefixes().end()) {}
+
+bool ClientCacheConfig::cacheable(const std::string& key) const {
+  if (prefixes_.empty()) {
+    return true;
+  }
+  for (const std::string& prefix : prefixes_) {
+    if (absl::StartsWith(key, prefix)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+TrackingClient::TrackingClient(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
+                               const ClientCacheConfig& config, ClientCacheStats& stats,
+                               TrackingCallbacks& callbacks, const std::string& auth_username,
+                               const std::string& auth_password)
+    : host_(std::move(host)), dispatcher_(dispatcher), config_(config), stats_(stats),
+      callbacks_(callbacks), auth_username_(auth_username), auth_password_(auth_password),
+      connect_timer_(dispatcher.createTimer([this]() {
+        ENVOY_LOG(debug, "tracking connection to {} timed out", host_->address()->asString());
+        close();
+      })),
+      reconnect_timer_(dispatcher.createTimer([this]() { connect(); })) {
+  connect();
+}
+
+TrackingClient::~TrackingClient() {
+  if (ready_) {
+    stats_.tracking_cx_ready_.dec();
+  }
+  if (connection_ != nullptr) {
+    // The cache is already dropping its values, so the callbacks don't need to be called.
+    connection_->removeConnectionCallbacks(*this);
+    connection_->close(Network::ConnectionCloseType::NoFlush);
+  }
+}
+
+void TrackingClient::connect() {
+  ASSERT(connection_ == nullptr);
+  stats_.tracking_cx_total_.inc();
+  decoder_ = std::make_unique<Common::Redis::DecoderImpl>(*this);
+  expected_replies_.clear();
+  connection_ = host_->createConnection(dispatcher_, nullptr, nullptr).connection_;
+  connection_->addConnectionCallbacks(*this);
+  connection_->addReadFilter(std::make_shared<UpstreamReadFilter>(*this));
+  connection_->connect();
+  connection_->noDelay(true);
+  // The timeout covers the commands turning on tracking too.
+  connect_timer_->enableTimer(host_->cluster().connectTimeout());
+
+  if (!auth_username_.empty()) {
+    send({"auth", auth_username_, auth_password_}, Reply::Auth);
+  } else if (!auth_password_.empty()) {
+    send({"auth", auth_password_}, Reply::Auth);
+  }
+  // The messages are redirected to this connection, so its id is needed to turn on tracking.
+  send({"client", "id"}, Reply::ClientId);
+}
+
+void TrackingClient::close() { connection_->close(Network::ConnectionCloseType::NoFlush); }
+
+void TrackingClient::send(const std::vector<std::string>& command, Reply reply) {
+  Common::Redis::RespValue request;
+  request.type(Common::Redis::RespType::Array);
+  request.asArray().resize(command.size());
+  for (uint64_t i = 0; i < command.size(); i++) {
+    request.asArray()[i].type(Common::Redis::RespType::BulkString);
+    request.asArray()[i].asString() = command[i];
+  }
+  encoder_.encode(request, encoder_buffer_);
+  connection_->write(encoder_buffer_, false);
+  expected_replies_.push_back(reply);
+}
+
+void TrackingClient::onEvent(Network::ConnectionEvent event) {
+  if (event != Network::ConnectionEvent::RemoteClose &&
+      event != Network::ConnectionEvent::LocalClose) {
+    return;
+  }
+
+  ENVOY_LOG(debug, "tracking connection to {} closed", host_->address()->asString());
+  stats_.tracking_cx_failure_.inc();
+  connect_timer_->disableTimer();
+  dispatcher_.deferredDelete(std::move(connection_));
+  reconnect_timer_->enableTimer(ReconnectInterval);
+  if (ready_) {
+    ready_ = false;
+    stats_.tracking_cx_ready_.dec();
+    callbacks_.onTrackingLost();
+  }
+}
+
+void TrackingClient::onData(Buffer::Instance& data) {
+  try {
+    decoder_->decode(data);
+  } catch (Common::Redis::ProtocolError&) {
+    if (connection_ != nullptr) {
+      close();
+    }
+  }
+}
+
+void TrackingClient::onRespValue(Common::Redis::RespValuePtr&& value) {
+  if (connection_ == nullptr) {
+    // The connection was closed by a previous value of the same read.
+    return;
+  }
+  if (!expected_replies_.empty()) {
+    onReply(std::move(value));
+  } else {
+    onMessage(*value);
+  }
+}
+
+void TrackingClient::onReply(Common::Redis::RespValuePtr&& value) {
+  const Reply reply = expected_replies_.front();
+  expected_replies_.pop_front();
+
+  switch (reply) {
+  case Reply::Auth:
+  case Reply::Tracking:
+    if (value->type() != Common::Redis::RespType::SimpleString || value->asString() != "OK") {
+      ENVOY_LOG(debug, "tracking connection to {} failed: '{}'", host_->address()->asString(),
+                value->toString());
+      close();
+    }
+    break;
+  case Reply::ClientId: {
+    if (value->type() != Common::Redis::RespType::Integer) {
+      ENVOY_LOG(debug, "tracking connection to {} failed: '{}'", host_->address()->asString(),
+                value->toString());
+      close();
+      break;
+    }
+    // Broadcasting mode sends the invalidation messages of all the keys written to, rather than
+    // of the keys read by this connection, so the values may be read on any connection.
+    std::vector<std::string> tracking{
+        "client", "tracking", "on", "redirect", absl::StrCat(value->asInteger()), "bcast"};
+    for (const std::string& prefix : config_.prefixes()) {
+      tracking.push_back("prefix");
+      tracking.push_back(prefix);
+    }
+    send(tracking, Reply::Tracking);
+    send({"subscribe", std::string(InvalidationChannel)}, Reply::Subscribe);
+    break;
+  }
+  case Reply::Subscribe:
+    if (!isPubSubMessage(*value, "subscribe")) {
+      ENVOY_LOG(debug, "tracking connection to {} failed: '{}'", host_->address()->asString(),
+                value->toString());
+      close();
+      break;
+    }
+    connect_timer_->disableTimer();
+    ready_ = true;
+    stats_.tracking_cx_ready_.inc();
+    callbacks_.onTrackingReady();
+    break;
+  }
+}
+
+void TrackingClient::onMessage(const Common::Redis::RespValue& value) {
+  if (!isPubSubMessage(value, "message")) {
+    // Values could be stale if an unexpected message was an invalidation.
+    ENVOY_LOG(debug, "unexpected message on tracking connection: '{}'", value.toString());
+    callbacks_.onInvalidationOfAllKeys();
+    return;
+  }
+
+  const Common::Redis::RespValue& keys = value.asArray()[2];
+  switch (keys.type()) {
+  case Common::Redis::RespType::Array:
+    for (const Common::Redis::RespValue& key : keys.asArray()) {
+      if (key.type() == Common::Redis::RespType::BulkString) {
+        callbacks_.onInvalidation(key.asString());
+      }
+    }
+    break;
+  case Common::Redis::RespType::BulkString:
+    callbacks_.onInvalidation(keys.asString());
+    break;
+  default:
+    // A null payload is sent when the database is flushed.
+    callbacks_.onInvalidationOfAllKeys();
+    break;
+  }
+}
+
+ClientCacheImpl::ClientCacheImpl(ClientCacheConfigSharedPtr config, Event::Dispatcher& dispatcher,
+                                 const ClientCacheStats& stats)
+    : config_(std::move(config)), dispatcher_(dispatcher), stats_(stats) {}
+
+ClientCacheImpl::~ClientCacheImpl() { stats_.entries_.sub(entries_.size()); }
+
+void ClientCacheImpl::addHost(Upstream::HostConstSharedPtr host, const std::string& auth_username,
+                              const std::string& auth_password) {
+  // The host may own keys which were cached, and which aren't tracked until it is ready.
+  flush();
+  TrackingClientPtr& client = tracking_clients_[host];
+  if (client == nullptr) {
+    client = std::make_unique<TrackingClient>(host, dispatcher_, *config_, stats_, *this,
+                                              auth_username, auth_password);
+  }
+}
+
+void ClientCacheImpl::removeHost(const Upstream::HostConstSharedPtr& host) {
+  auto it = tracking_clients_.find(host);
+  if (it == tracking_clients_.end()) {
+    return;
+  }
+  if (it->second->ready()) {
+    ASSERT(num_ready_ > 0);
+    num_ready_--;
+  }
+  tracking_clients_.erase(it);
+  // The keys of the host are now owned by other hosts.
+  flush();
+}
+
+void ClientCacheImpl::removeAllHosts() {
+  tracking_clients_.clear();
+  num_ready_ = 0;
+  flush();
+}
+
+const Common::Redis::RespValue* ClientCacheImpl::lookup(const std::string& key) {
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    stats_.miss_.inc();
+    return nullptr;
+  }
+  const EntryList::iterator entry = it->second;
+  if (entry->expiry_ <= dispatcher_.approximateMonotonicTime()) {
+    stats_.expiration_.inc();
+    stats_.miss_.inc();
+    erase(entry);
+    return nullptr;
+  }
+  stats_.hit_.inc();
+  entries_.splice(entries_.begin(), entries_, entry);
+  return &entry->value_;
+}
+
+uint64_t ClientCacheImpl::startFill(const std::string& key) {
+  if (!ready() || !config_->cacheable(key)) {
+    return 0;
+  }
+  // A key read several times at once is only cached by the last read.
+  const uint64_t fill_id = next_fill_id_++;
+  pending_fills_[key] = fill_id;
+  return fill_id;
+}
+
+void ClientCacheImpl::fill(const std::string& key, uint64_t fill_id,
+                           const Common::Redis::RespValue& value) {
+  auto pending = pending_fills_.find(key);
+  if (pending == pending_fills_.end() || pending->second != fill_id) {
+    // The key was invalidated, or read again, since the read started.
+    return;
+  }
+  pending_fills_.erase(pending);
+
+  if (value.type() != Common::Redis::RespType::Null &&
+      (value.type() != Common::Redis::RespType::BulkString ||
+       value.stringLength() > config_->maxValueBytes())) {
+    return;
+  }
+
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    erase(it->second);
+  }
+  entries_.emplace_front(key, value, dispatcher_.approximateMonotonicTime() + config_->maxTtl());
+  index_.emplace(entries_.front().key_, entries_.begin());
+  stats_.fill_.inc();
+  stats_.entries_.inc();
+
+  if (entries_.size() > config_->maxEntries()) {
+    stats_.eviction_.inc();
+    erase(std::prev(entries_.end()));
+  }
+}
+
+void ClientCacheImpl::cancelFill(const std::string& key, uint64_t fill_id) {
+  auto pending = pending_fills_.find(key);
+  if (pending != pending_fills_.end() && pending->second == fill_id) {
+    pending_fills_.erase(pending);
+  }
+}
+
+void ClientCacheImpl::onTrackingReady() {
+  num_ready_++;
+  ASSERT(num_ready_ <= tracking_clients_.size());
+}
+
+void ClientCacheImpl::onTrackingLost() {
+  ASSERT(num_ready_ > 0);
+  num_ready_--;
+  flush();
+}
+
+void ClientCacheImpl::onInvalidation(const std::string& key) {
+  stats_.invalidation_.inc();
+  pending_fills_.erase(key);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    erase(it->second);
+  }
+}
+
+void ClientCacheImpl::onInvalidationOfAllKeys() { flush(); }
+
+void ClientCacheImpl::erase(EntryList::iterator entry) {
+  index_.erase(entry->key_);
+  entries_.erase(entry);
+  stats_.entries_.dec();
+}
+
+void ClientCacheImpl::flush() {
+  pending_fills_.clear();
+  if (entries_.empty()) {
+    return;
+  }
+  stats_.flush_.inc();
+  stats_.entries_.sub(entries_.size());
+  index_.clear();
+  entries_.clear();
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
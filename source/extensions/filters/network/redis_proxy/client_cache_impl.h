@@ -0,0 +1,261 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/event/timer.h"
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+#include "envoy/network/connection.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/upstream.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/common/logger.h"
+#include "common/network/filter_impl.h"
+
+#include "extensions/filters/network/common/redis/codec_impl.h"
+#include "extensions/filters/network/redis_proxy/client_cache.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+/**
+ * All client side cache stats. @see stats_macros.h
+ */
+#define ALL_CLIENT_CACHE_STATS(COUNTER, GAUGE)                                                     \
+  COUNTER(eviction)                                                                                \
+  COUNTER(expiration)                                                                              \
+  COUNTER(fill)                                                                                    \
+  COUNTER(flush)                                                                                   \
+  COUNTER(hit)                                                                                     \
+  COUNTER(invalidation)                                                                            \
+  COUNTER(miss)                                                                                    \
+  COUNTER(tracking_cx_failure)                                                                     \
+  COUNTER(tracking_cx_total)                                                                       \
+  GAUGE(entries, Accumulate)                                                                       \
+  GAUGE(tracking_cx_ready, Accumulate)
+
+/**
+ * Struct definition for all client side cache stats. @see stats_macros.h
+ */
+struct ClientCacheStats {
+  ALL_CLIENT_CACHE_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT)
+};
+
+class ClientCacheConfig {
+public:
+  ClientCacheConfig(
+      const envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::ClientSideCache&
+          config);
+
+  uint32_t maxEntries() const { return max_entries_; }
+  std::chrono::milliseconds maxTtl() const { return max_ttl_; }
+  uint64_t maxValueBytes() const { return max_value_bytes_; }
+  const std::vector<std::string>& prefixes() const { return prefixes_; }
+
+  /**
+   * @return whether a key may be cached, i.e. whether it matches one of the prefixes.
+   */
+  bool cacheable(const std::string& key) const;
+
+private:
+  const uint32_t max_entries_;
+  const std::chrono::milliseconds max_ttl_;
+  const uint64_t max_value_bytes_;
+  const std::vector<std::string> prefixes_;
+};
+
+using ClientCacheConfigSharedPtr = std::shared_ptr<const ClientCacheConfig>;
+
+/**
+ * Callbacks of the tracking connections.
+ */
+class TrackingCallbacks {
+public:
+  virtual ~TrackingCallbacks() = default;
+
+  /**
+   * Called once the upstream host sends invalidation messages.
+   */
+  virtual void onTrackingReady() PURE;
+
+  /**
+   * Called when the tracking connection of a ready client is closed, as invalidation messages may
+   * then have been missed.
+   */
+  virtual void onTrackingLost() PURE;
+
+  /**
+   * Called when a key was written to upstream.
+   */
+  virtual void onInvalidation(const std::string& key) PURE;
+
+  /**
+   * Called when all the keys may have been written to upstream, e.g. on FLUSHALL.
+   */
+  virtual void onInvalidationOfAllKeys() PURE;
+};
+
+/**
+ * A connection to an upstream host, which receives the invalidation messages of the host. The
+ * connection turns on tracking in broadcasting mode, redirecting the messages to itself, and
+ * subscribes to them. This works with RESP2, which the codec implements, whereas RESP3 push
+ * messages would have to be told apart from responses. The connection is reopened when closed.
+ */
+class TrackingClient : public Common::Redis::DecoderCallbacks,
+                       public Network::ConnectionCallbacks,
+                       public Logger::Loggable<Logger::Id::redis> {
+public:
+  TrackingClient(Upstream::HostConstSharedPtr host, Event::Dispatcher& dispatcher,
+                 const ClientCacheConfig& config, ClientCacheStats& stats,
+                 TrackingCallbacks& callbacks, const std::string& auth_username,
+                 const std::string& auth_password);
+  ~TrackingClient() override;
+
+  bool ready() const { return ready_; }
+
+  // Network::ConnectionCallbacks
+  void onEvent(Network::ConnectionEvent event) override;
+  void onAboveWriteBufferHighWatermark() override {}
+  void onBelowWriteBufferLowWatermark() override {}
+
+  // Common::Redis::DecoderCallbacks
+  void onRespValue(Common::Redis::RespValuePtr&& value) override;
+
+  // The interval at which a closed connection is reopened.
+  static constexpr std::chrono::milliseconds ReconnectInterval{1000};
+
+private:
+  struct UpstreamReadFilter : public Network::ReadFilterBaseImpl {
+    UpstreamReadFilter(TrackingClient& parent) : parent_(parent) {}
+
+    // Network::ReadFilter
+    Network::FilterStatus onData(Buffer::Instance& data, bool) override {
+      parent_.onData(data);
+      return Network::FilterStatus::Continue;
+    }
+
+    TrackingClient& parent_;
+  };
+
+  // The responses expected to the commands sent before the connection is ready.
+  enum class Reply { Auth, ClientId, Tracking, Subscribe };
+
+  void connect();
+  void close();
+  void onData(Buffer::Instance& data);
+  void onReply(Common::Redis::RespValuePtr&& value);
+  void onMessage(const Common::Redis::RespValue& value);
+  void send(const std::vector<std::string>& command, Reply reply);
+
+  const Upstream::HostConstSharedPtr host_;
+  Event::Dispatcher& dispatcher_;
+  const ClientCacheConfig& config_;
+  ClientCacheStats& stats_;
+  TrackingCallbacks& callbacks_;
+  const std::string auth_username_;
+  const std::string auth_password_;
+  Network::ClientConnectionPtr connection_;
+  Common::Redis::EncoderImpl encoder_;
+  // Recreated with each connection, as a closed connection may leave a value partially decoded.
+  Common::Redis::DecoderPtr decoder_;
+  Buffer::OwnedImpl encoder_buffer_;
+  std::list<Reply> expected_replies_;
+  Event::TimerPtr connect_timer_;
+  Event::TimerPtr reconnect_timer_;
+  bool ready_{};
+};
+
+using TrackingClientPtr = std::unique_ptr<TrackingClient>;
+
+/**
+ * A least recently used cache, with a tracking connection to each upstream host of the
+ * connection pool owning it. Values are only cached while all the tracking connections are ready,
+ * and all the values are dropped when the hosts change or a tracking connection is lost.
+ */
+class ClientCacheImpl : public ClientCache,
+                        public TrackingCallbacks,
+                        public Logger::Loggable<Logger::Id::redis> {
+public:
+  ClientCacheImpl(ClientCacheConfigSharedPtr config, Event::Dispatcher& dispatcher,
+                  const ClientCacheStats& stats);
+  ~ClientCacheImpl() override;
+
+  /**
+   * Opens a tracking connection to a host added to the connection pool.
+   */
+  void addHost(Upstream::HostConstSharedPtr host, const std::string& auth_username,
+               const std::string& auth_password);
+
+  /**
+   * Closes the tracking connection to a host removed from the connection pool.
+   */
+  void removeHost(const Upstream::HostConstSharedPtr& host);
+
+  /**
+   * Closes all the tracking connections, e.g. when the cluster is removed.
+   */
+  void removeAllHosts();
+
+  // ClientCache
+  const Common::Redis::RespValue* lookup(const std::string& key) override;
+  uint64_t startFill(const std::string& key) override;
+  void fill(const std::string& key, uint64_t fill_id,
+            const Common::Redis::RespValue& value) override;
+  void cancelFill(const std::string& key, uint64_t fill_id) override;
+
+  // TrackingCallbacks
+  void onTrackingReady() override;
+  void onTrackingLost() override;
+  void onInvalidation(const std::string& key) override;
+  void onInvalidationOfAllKeys() override;
+
+private:
+  struct Entry {
+    Entry(const std::string& key, const Common::Redis::RespValue& value, MonotonicTime expiry)
+        : key_(key), value_(value), expiry_(expiry) {}
+
+    const std::string key_;
+    const Common::Redis::RespValue value_;
+    const MonotonicTime expiry_;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  bool ready() const {
+    return !tracking_clients_.empty() && num_ready_ == tracking_clients_.size();
+  }
+  void erase(EntryList::iterator entry);
+  void flush();
+
+  const ClientCacheConfigSharedPtr config_;
+  Event::Dispatcher& dispatcher_;
+  ClientCacheStats stats_;
+  // Ordered from the most to the least recently used.
+  EntryList entries_;
+  // Indexed by the keys of entries_.
+  absl::flat_hash_map<absl::string_view, EntryList::iterator> index_;
+  // The ids of the values being read, by key.
+  absl::flat_hash_map<std::string, uint64_t> pending_fills_;
+  uint64_t next_fill_id_{1};
+  absl::node_hash_map<Upstream::HostConstSharedPtr, TrackingClientPtr> tracking_clients_;
+  uint64_t num_ready_{};
+};
+
+using ClientCacheImplPtr = std::unique_ptr<ClientCacheImpl>;
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
@@ -4,6 +4,8 @@
 
 #include "extensions/filters/network/common/redis/supported_commands.h"
 
+#include "absl/strings/match.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -148,14 +150,31 @@ SplitRequestPtr SimpleRequest::create(Router& router,
   const auto route = router.upstreamPool(incoming_request->asArray()[1].asString());
   if (route) {
     Common::Redis::RespValueSharedPtr base_request = std::move(incoming_request);
-    request_ptr->handle_ =
-        makeSingleServerRequest(route, base_request->asArray()[0].asString(),
-                                base_request->asArray()[1].asString(), base_request, *request_ptr);
+    const std::string& key = base_request->asArray()[1].asString();
+    ClientCache* cache = route->upstream()->clientCache();
+    if (cache != nullptr && base_request->asArray().size() == 2 &&
+        absl::EqualsIgnoreCase(base_request->asArray()[0].asString(),
+                               Common::Redis::SupportedCommands::get())) {
+      const Common::Redis::RespValue* value = cache->lookup(key);
+      if (value != nullptr) {
+        request_ptr->updateStats(true);
+        callbacks.onResponse(std::make_unique<Common::Redis::RespValue>(*value));
+        return nullptr;
+      }
+      request_ptr->fill_id_ = cache->startFill(key);
+      if (request_ptr->fill_id_ != 0) {
+        request_ptr->cache_ = cache;
+        request_ptr->cached_request_ = base_request;
+      }
+    }
+    request_ptr->handle_ = makeSingleServerRequest(route, base_request->asArray()[0].asString(),
+                                                   key, base_request, *request_ptr);
   } else {
     ENVOY_LOG(debug, "route not found: '{}'", incoming_request->toString());
   }
 
   if (!request_ptr->handle_) {
+    request_ptr->cancelFill();
     command_stats.error_.inc();
     callbacks.onResponse(Common::Redis::Utility::makeError(Response::get().NoUpstreamHost));
     return nullptr;
@@ -164,6 +183,31 @@ SplitRequestPtr SimpleRequest::create(Router& router,
   return request_ptr;
 }
 
+void SimpleRequest::onResponse(Common::Redis::RespValuePtr&& response) {
+  if (cache_ != nullptr) {
+    cache_->fill(cached_request_->asArray()[1].asString(), fill_id_, *response);
+    cache_ = nullptr;
+  }
+  SingleServerRequest::onResponse(std::move(response));
+}
+
+void SimpleRequest::onFailure() {
+  cancelFill();
+  SingleServerRequest::onFailure();
+}
+
+void SimpleRequest::cancel() {
+  cancelFill();
+  SingleServerRequest::cancel();
+}
+
+void SimpleRequest::cancelFill() {
+  if (cache_ != nullptr) {
+    cache_->cancelFill(cached_request_->asArray()[1].asString(), fill_id_);
+    cache_ = nullptr;
+  }
+}
+
 SplitRequestPtr EvalRequest::create(Router& router, Common::Redis::RespValuePtr&& incoming_request,
                                     SplitCallbacks& callbacks, CommandStats& command_stats,
                                     TimeSource& time_source, bool delay_command_latency) {
@@ -231,17 +275,32 @@ SplitRequestPtr MGETRequest::create(Router& router, Common::Redis::RespValuePtr&
   request_ptr->pending_response_->asArray().swap(responses);
 
   Common::Redis::RespValueSharedPtr base_request = std::move(incoming_request);
+  request_ptr->base_request_ = base_request;
   for (uint32_t i = 1; i < base_request->asArray().size(); i++) {
     request_ptr->pending_requests_.emplace_back(*request_ptr, i - 1);
     PendingRequest& pending_request = request_ptr->pending_requests_.back();
 
     const auto route = router.upstreamPool(base_request->asArray()[i].asString());
     if (route) {
+      const std::string& key = base_request->asArray()[i].asString();
+      ClientCache* cache = route->upstream()->clientCache();
+      if (cache != nullptr) {
+        const Common::Redis::RespValue* value = cache->lookup(key);
+        if (value != nullptr) {
+          pending_request.onResponse(std::make_unique<Common::Redis::RespValue>(*value));
+          continue;
+        }
+        pending_request.fill_id_ = cache->startFill(key);
+        if (pending_request.fill_id_ != 0) {
+          pending_request.cache_ = cache;
+        }
+      }
+
       // Create composite array for a single get.
       const Common::Redis::RespValue single_mget(
           base_request, Common::Redis::Utility::GetRequest::instance(), i, i);
-      pending_request.handle_ = makeFragmentedRequest(
-          route, "get", base_request->asArray()[i].asString(), single_mget, pending_request);
+      pending_request.handle_ =
+          makeFragmentedRequest(route, "get", key, single_mget, pending_request);
     }
 
     if (!pending_request.handle_) {
@@ -256,8 +315,24 @@ SplitRequestPtr MGETRequest::create(Router& router, Common::Redis::RespValuePtr&
   return nullptr;
 }
 
+void MGETRequest::cancel() {
+  for (PendingRequest& request : pending_requests_) {
+    if (request.cache_ != nullptr) {
+      request.cache_->cancelFill(base_request_->asArray()[request.index_ + 1].asString(),
+                                 request.fill_id_);
+      request.cache_ = nullptr;
+    }
+  }
+  FragmentedRequest::cancel();
+}
+
 void MGETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) {
-  pending_requests_[index].handle_ = nullptr;
+  PendingRequest& request = pending_requests_[index];
+  request.handle_ = nullptr;
+  if (request.cache_ != nullptr) {
+    request.cache_->fill(base_request_->asArray()[index + 1].asString(), request.fill_id_, *value);
+    request.cache_ = nullptr;
+  }
 
   pending_response_->asArray()[index].type(value->type());
   switch (value->type()) {
@@ -275,7 +350,8 @@ void MGETRequest::onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t
     FALLTHRU;
   }
   case Common::Redis::RespType::BulkString: {
-    pending_response_->asArray()[index].asString().swap(value->asString());
+    // Moves the whole value, as a large BulkString references a buffer rather than a string.
+    pending_response_->asArray()[index] = std::move(*value);
     break;
   }
   case Common::Redis::RespType::Null:
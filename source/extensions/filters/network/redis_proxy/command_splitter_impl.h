@@ -168,7 +168,8 @@ private:
 };
 
 /**
- * SimpleRequest hashes the first argument as the key.
+ * SimpleRequest hashes the first argument as the key. GET requests are served by the client side
+ * cache of the upstream if it has one.
  */
 class SimpleRequest : public SingleServerRequest {
 public:
@@ -176,10 +177,24 @@ public:
                                 SplitCallbacks& callbacks, CommandStats& command_stats,
                                 TimeSource& time_source, bool delay_command_latency);
 
+  // ConnPool::PoolCallbacks
+  void onResponse(Common::Redis::RespValuePtr&& response) override;
+  void onFailure() override;
+
+  // RedisProxy::CommandSplitter::SplitRequest
+  void cancel() override;
+
 private:
   SimpleRequest(SplitCallbacks& callbacks, CommandStats& command_stats, TimeSource& time_source,
                 bool delay_command_latency)
       : SingleServerRequest(callbacks, command_stats, time_source, delay_command_latency) {}
+
+  void cancelFill();
+
+  // Only set for a GET whose response is cached.
+  ClientCache* cache_{};
+  uint64_t fill_id_{};
+  Common::Redis::RespValueConstSharedPtr cached_request_;
 };
 
 /**
@@ -227,6 +242,9 @@ protected:
     FragmentedRequest& parent_;
     const uint32_t index_;
     Common::Redis::Client::PoolRequest* handle_{};
+    // Only set for a key whose value is cached.
+    ClientCache* cache_{};
+    uint64_t fill_id_{};
   };
 
   virtual void onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) PURE;
@@ -242,7 +260,8 @@ protected:
 
 /**
  * MGETRequest takes each key from the command and sends a GET for each to the appropriate Redis
- * server. The response contains the result from each command.
+ * server. The response contains the result from each command. The keys cached by the client side
+ * cache of their upstream aren't sent.
  */
 class MGETRequest : public FragmentedRequest {
 public:
@@ -250,6 +269,9 @@ public:
                                 SplitCallbacks& callbacks, CommandStats& command_stats,
                                 TimeSource& time_source, bool delay_command_latency);
 
+  // RedisProxy::CommandSplitter::SplitRequest
+  void cancel() override;
+
 private:
   MGETRequest(SplitCallbacks& callbacks, CommandStats& command_stats, TimeSource& time_source,
               bool delay_command_latency)
@@ -257,6 +279,9 @@ private:
 
   // RedisProxy::CommandSplitter::FragmentedRequest
   void onChildResponse(Common::Redis::RespValuePtr&& value, uint32_t index) override;
+
+  // Holds the keys of the values being cached.
+  Common::Redis::RespValueConstSharedPtr base_request_;
 };
 
 /**
@@ -8,6 +8,7 @@
 
 #include "extensions/filters/network/common/redis/client.h"
 #include "extensions/filters/network/common/redis/codec.h"
+#include "extensions/filters/network/redis_proxy/client_cache.h"
 
 #include "absl/types/variant.h"
 
@@ -62,6 +63,12 @@ public:
    */
   virtual Common::Redis::Client::PoolRequest*
   makeRequest(const std::string& hash_key, RespVariant&& request, PoolCallbacks& callbacks) PURE;
+
+  /**
+   * @return ClientCache* the cache of the values read by the calling worker, or nullptr if client
+   *         side caching is disabled.
+   */
+  virtual ClientCache* clientCache() PURE;
 };
 
 using InstanceSharedPtr = std::shared_ptr<Instance>;
@@ -15,8 +15,11 @@
 #include "common/common/logger.h"
 #include "common/stats/utility.h"
 
+#include "extensions/filters/network/common/redis/supported_commands.h"
 #include "extensions/filters/network/redis_proxy/config.h"
 
+#include "absl/strings/match.h"
+
 namespace Envoy {
 namespace Extensions {
 namespace NetworkFilters {
@@ -34,6 +37,22 @@ const Common::Redis::RespValue& getRequest(const RespVariant& request) {
     return *(absl::get<Common::Redis::RespValueConstSharedPtr>(request));
   }
 }
+
+// Appends the arguments of a request, i.e. its values but the command, to a batch.
+void appendArguments(const Common::Redis::RespValue& request,
+                     std::vector<Common::Redis::RespValue>& batch) {
+  if (request.type() == Common::Redis::RespType::Array) {
+    batch.insert(batch.end(), request.asArray().begin() + 1, request.asArray().end());
+    return;
+  }
+  bool command = true;
+  for (const Common::Redis::RespValue& value : request.asCompositeArray()) {
+    if (!command) {
+      batch.push_back(value);
+    }
+    command = false;
+  }
+}
 } // namespace
 
 InstanceImpl::InstanceImpl(
@@ -47,9 +66,22 @@ InstanceImpl::InstanceImpl(
     : cluster_name_(cluster_name), cm_(cm), client_factory_(client_factory),
       tls_(tls.allocateSlot()), config_(new Common::Redis::Client::ConfigImpl(config)), api_(api),
       stats_scope_(std::move(stats_scope)),
-      redis_command_stats_(redis_command_stats), redis_cluster_stats_{REDIS_CLUSTER_STATS(
-                                                     POOL_COUNTER(*stats_scope_))},
-      refresh_manager_(std::move(refresh_manager)) {}
+      redis_command_stats_(redis_command_stats),
+      redis_cluster_stats_{
+          REDIS_CLUSTER_STATS(POOL_COUNTER(*stats_scope_), POOL_HISTOGRAM(*stats_scope_))},
+      refresh_manager_(std::move(refresh_manager)),
+      max_batch_size_(config.has_command_batching()
+                          ? PROTOBUF_GET_WRAPPED_OR_DEFAULT(config.command_batching(),
+                                                            max_batch_size, 100)
+                          : 0),
+      batch_window_(PROTOBUF_GET_MS_OR_DEFAULT(config.command_batching(), window, 0)) {
+  if (config.has_client_side_cache()) {
+    client_cache_config_ = std::make_shared<ClientCacheConfig>(config.client_side_cache());
+    client_cache_stats_ = std::make_unique<ClientCacheStats>(
+        ClientCacheStats{ALL_CLIENT_CACHE_STATS(POOL_COUNTER_PREFIX(*stats_scope_, "client_cache"),
+                                                POOL_GAUGE_PREFIX(*stats_scope_, "client_cache"))});
+  }
+}
 
 void InstanceImpl::init() {
   // Note: `this` and `cluster_name` have a a lifetime of the filter.
@@ -73,6 +105,12 @@ InstanceImpl::makeRequest(const std::string& key, RespVariant&& request, PoolCal
   return tls_->getTyped<ThreadLocalPool>().makeRequest(key, std::move(request), callbacks);
 }
 
+// This method is always called from a InstanceSharedPtr we don't have to worry about tls_->getTyped
+// failing due to InstanceImpl going away.
+ClientCache* InstanceImpl::clientCache() {
+  return tls_->getTyped<ThreadLocalPool>().client_cache_.get();
+}
+
 // This method is always called from a InstanceSharedPtr we don't have to worry about tls_->getTyped
 // failing due to InstanceImpl going away.
 Common::Redis::Client::PoolRequest*
@@ -90,7 +128,15 @@ InstanceImpl::ThreadLocalPool::ThreadLocalPool(std::shared_ptr<InstanceImpl> par
       is_redis_cluster_(false), client_factory_(parent->client_factory_), config_(parent->config_),
       stats_scope_(parent->stats_scope_), redis_command_stats_(parent->redis_command_stats_),
       redis_cluster_stats_(parent->redis_cluster_stats_),
-      refresh_manager_(parent->refresh_manager_) {
+      refresh_manager_(parent->refresh_manager_), max_batch_size_(parent->max_batch_size_),
+      batch_window_(parent->batch_window_) {
+  if (parent->client_cache_config_ != nullptr) {
+    client_cache_ = std::make_unique<ClientCacheImpl>(parent->client_cache_config_, dispatcher,
+                                                      *parent->client_cache_stats_);
+  }
+  if (max_batch_size_ > 0) {
+    batch_timer_ = dispatcher.createTimer([this]() -> void { sendBatches(); });
+  }
   cluster_update_handle_ = parent->cm_.addThreadLocalClusterUpdateCallbacks(*this);
   Upstream::ThreadLocalCluster* cluster = parent->cm_.getThreadLocalCluster(cluster_name_);
   if (cluster != nullptr) {
@@ -142,6 +188,9 @@ void InstanceImpl::ThreadLocalPool::onClusterAddOrUpdateNonVirtual(
   for (const auto& i : cluster_->prioritySet().hostSetsPerPriority()) {
     for (auto& host : i->hosts()) {
       host_address_map_[host->address()->asString()] = host;
+      if (client_cache_ != nullptr) {
+        client_cache_->addHost(host, auth_username_, auth_password_);
+      }
     }
   }
 
@@ -164,6 +213,7 @@ void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_
   // Treat cluster removal as a removal of all hosts. Close all connections and fail all pending
   // requests.
   host_set_member_update_cb_handle_ = nullptr;
+  sendBatches();
   while (!client_map_.empty()) {
     client_map_.begin()->second->redis_client_->close();
   }
@@ -173,6 +223,9 @@ void InstanceImpl::ThreadLocalPool::onClusterRemoval(const std::string& cluster_
 
   cluster_ = nullptr;
   host_address_map_.clear();
+  if (client_cache_ != nullptr) {
+    client_cache_->removeAllHosts();
+  }
 }
 
 void InstanceImpl::ThreadLocalPool::onHostsAdded(
@@ -181,6 +234,9 @@ void InstanceImpl::ThreadLocalPool::onHostsAdded(
     std::string host_address = host->address()->asString();
     // Insert new host into address map, possibly overwriting a previous host's entry.
     host_address_map_[host_address] = host;
+    if (client_cache_ != nullptr) {
+      client_cache_->addHost(host, auth_username_, auth_password_);
+    }
     for (const auto& created_host : created_via_redirect_hosts_) {
       if (created_host->address()->asString() == host_address) {
         // Remove our "temporary" host created in makeRequestToHost().
@@ -195,6 +251,11 @@ void InstanceImpl::ThreadLocalPool::onHostsAdded(
 void InstanceImpl::ThreadLocalPool::onHostsRemoved(
     const std::vector<Upstream::HostSharedPtr>& hosts_removed) {
   for (const auto& host : hosts_removed) {
+    if (client_cache_ != nullptr) {
+      client_cache_->removeHost(host);
+    }
+    // The batch is then drained with the other requests to the host.
+    sendBatch(host);
     auto it = client_map_.find(host);
     if (it != client_map_.end()) {
       if (it->second->redis_client_->active()) {
@@ -259,8 +320,39 @@ InstanceImpl::ThreadLocalPool::makeRequest(const std::string& key, RespVariant&&
     ENVOY_LOG(debug, "host not found: '{}'", key);
     return nullptr;
   }
+  absl::optional<BatchType> type;
+  uint64_t slot = 0;
+  if (max_batch_size_ > 0) {
+    type = batchType(getRequest(request));
+    slot = is_redis_cluster_ ? lb_context.computeHashKey().value() % Clusters::Redis::MaxSlot : 0;
+    auto it = open_batches_.find(host);
+    if (it != open_batches_.end() &&
+        (!type.has_value() || it->second->type_ != type.value() || it->second->slot_ != slot ||
+         it->second->entries_.size() == max_batch_size_)) {
+      // The requests to a host are sent in order, so the batch is sent before this request. It is
+      // sent before this request is added to pending_requests_, as a failure to send it completes
+      // its requests right away. The request itself is never sent here, so that its callbacks
+      // aren't called before it is returned.
+      sendBatch(host);
+    }
+  }
+
   pending_requests_.emplace_back(*this, std::move(request), callbacks);
   PendingRequest& pending_request = pending_requests_.back();
+
+  if (type.has_value()) {
+    auto it = open_batches_.find(host);
+    if (it == open_batches_.end()) {
+      it = open_batches_.emplace(host, std::make_unique<Batch>(*this, host, type.value(), slot))
+               .first;
+      if (!batch_timer_->enabled()) {
+        batch_timer_->enableTimer(batch_window_);
+      }
+    }
+    pending_request.request_handler_ = &it->second->add(pending_request);
+    return &pending_request;
+  }
+
   ThreadLocalActiveClientPtr& client = this->threadLocalActiveClient(host);
   pending_request.request_handler_ = client->redis_client_->makeRequest(
       getRequest(pending_request.incoming_request_), pending_request);
@@ -337,6 +429,9 @@ Common::Redis::Client::PoolRequest* InstanceImpl::ThreadLocalPool::makeRequestTo
     it = host_address_map_.find(host_address_map_key);
   }
 
+  // The requests to a host are sent in order, so a redirected request doesn't overtake the batch
+  // waiting for more requests to the host.
+  sendBatch(it->second);
   ThreadLocalActiveClientPtr& client = threadLocalActiveClient(it->second);
 
   return client->redis_client_->makeRequest(request, callbacks);
@@ -352,6 +447,133 @@ void InstanceImpl::ThreadLocalPool::onRequestCompleted() {
   }
 }
 
+absl::optional<InstanceImpl::BatchType>
+InstanceImpl::batchType(const Common::Redis::RespValue& request) {
+  const Common::Redis::RespValue* command;
+  uint64_t size;
+  if (request.type() == Common::Redis::RespType::Array && !request.asArray().empty()) {
+    command = &request.asArray()[0];
+    size = request.asArray().size();
+  } else if (request.type() == Common::Redis::RespType::CompositeArray) {
+    command = request.asCompositeArray().command();
+    size = request.asCompositeArray().size();
+  } else {
+    return absl::nullopt;
+  }
+
+  // SETs with options aren't merged, as MSET doesn't take any.
+  if (size == 2 &&
+      absl::EqualsIgnoreCase(command->asString(), Common::Redis::SupportedCommands::get())) {
+    return BatchType::Get;
+  }
+  if (size == 3 &&
+      absl::EqualsIgnoreCase(command->asString(), Common::Redis::SupportedCommands::set())) {
+    return BatchType::Set;
+  }
+  return absl::nullopt;
+}
+
+void InstanceImpl::ThreadLocalPool::sendBatch(Upstream::HostConstSharedPtr host) {
+  auto it = open_batches_.find(host);
+  if (it == open_batches_.end()) {
+    return;
+  }
+  BatchPtr batch = std::move(it->second);
+  open_batches_.erase(it);
+  LinkedList::moveIntoListBack(std::move(batch), sent_batches_);
+  sent_batches_.back()->send();
+}
+
+void InstanceImpl::ThreadLocalPool::sendBatches() {
+  while (!open_batches_.empty()) {
+    sendBatch(open_batches_.begin()->first);
+  }
+}
+
+void InstanceImpl::Batch::send() {
+  parent_.redis_cluster_stats_.batch_size_.recordValue(entries_.size());
+  Common::Redis::Client::ClientPtr& client = parent_.threadLocalActiveClient(host_)->redis_client_;
+  // A lone request is sent as is, as the batch gains nothing.
+  if (entries_.size() == 1) {
+    if (client->makeRequest(getRequest(entries_.front().incoming_request_), *this) == nullptr) {
+      onFailure();
+    }
+    return;
+  }
+
+  Common::Redis::RespValue request;
+  request.type(Common::Redis::RespType::Array);
+  std::vector<Common::Redis::RespValue>& arguments = request.asArray();
+  arguments.reserve(1 + entries_.size() * (type_ == BatchType::Get ? 1 : 2));
+  arguments.emplace_back();
+  arguments.back().type(Common::Redis::RespType::BulkString);
+  arguments.back().asString() = type_ == BatchType::Get ? Common::Redis::SupportedCommands::mget()
+                                                        : Common::Redis::SupportedCommands::mset();
+  // The canceled requests are sent too, as they would have been if they weren't merged.
+  for (const Entry& entry : entries_) {
+    appendArguments(getRequest(entry.incoming_request_), arguments);
+  }
+
+  if (client->makeRequest(request, *this) == nullptr) {
+    onFailure();
+  }
+}
+
+void InstanceImpl::Batch::complete() {
+  parent_.dispatcher_.deferredDelete(removeFromList(parent_.sent_batches_));
+}
+
+void InstanceImpl::Batch::onResponse(Common::Redis::RespValuePtr&& response) {
+  // Each GET of a MGET gets its value. Otherwise, e.g. for the OK acknowledging the SETs, an error
+  // or the response to a lone request, each request gets the whole response.
+  const bool demultiplex = entries_.size() > 1 && type_ == BatchType::Get &&
+                           response->type() == Common::Redis::RespType::Array &&
+                           response->asArray().size() == entries_.size();
+  for (uint64_t i = 0; i < entries_.size(); i++) {
+    PendingRequest* request = entries_[i].request_;
+    if (request == nullptr) {
+      continue;
+    }
+    entries_[i].request_ = nullptr;
+    if (demultiplex) {
+      request->onResponse(
+          std::make_unique<Common::Redis::RespValue>(std::move(response->asArray()[i])));
+    } else {
+      request->onResponse(std::make_unique<Common::Redis::RespValue>(*response));
+    }
+  }
+  complete();
+}
+
+void InstanceImpl::Batch::onFailure() {
+  for (Entry& entry : entries_) {
+    PendingRequest* request = entry.request_;
+    if (request != nullptr) {
+      entry.request_ = nullptr;
+      request->onFailure();
+    }
+  }
+  complete();
+}
+
+bool InstanceImpl::Batch::onRedirection(Common::Redis::RespValuePtr&& value,
+                                        const std::string& host_address, bool ask_redirection) {
+  // All the keys are in the same slot, so each request is redirected on its own.
+  parent_.redis_cluster_stats_.batch_redirected_.inc();
+  bool redirected = true;
+  for (Entry& entry : entries_) {
+    PendingRequest* request = entry.request_;
+    if (request != nullptr) {
+      entry.request_ = nullptr;
+      redirected = request->onRedirection(std::make_unique<Common::Redis::RespValue>(*value),
+                                          host_address, ask_redirection) &&
+                   redirected;
+    }
+  }
+  complete();
+  return redirected;
+}
+
 void InstanceImpl::ThreadLocalActiveClient::onEvent(Network::ConnectionEvent event) {
   if (event == Network::ConnectionEvent::RemoteClose ||
       event == Network::ConnectionEvent::LocalClose) {
@@ -2,17 +2,20 @@
 
 #include <chrono>
 #include <cstdint>
+#include <deque>
 #include <list>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "envoy/event/deferred_deletable.h"
 #include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
 #include "envoy/stats/stats_macros.h"
 #include "envoy/thread_local/thread_local.h"
 #include "envoy/upstream/cluster_manager.h"
 
 #include "common/buffer/buffer_impl.h"
+#include "common/common/linked_object.h"
 #include "common/network/address_impl.h"
 #include "common/network/filter_impl.h"
 #include "common/protobuf/utility.h"
@@ -27,6 +30,7 @@
 #include "extensions/filters/network/common/redis/client_impl.h"
 #include "extensions/filters/network/common/redis/codec_impl.h"
 #include "extensions/filters/network/common/redis/utility.h"
+#include "extensions/filters/network/redis_proxy/client_cache_impl.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
 
 #include "absl/container/node_hash_map.h"
@@ -40,12 +44,14 @@ namespace ConnPool {
 // TODO(mattklein123): Circuit breaking
 // TODO(rshriram): Fault injection
 
-#define REDIS_CLUSTER_STATS(COUNTER)                                                               \
+#define REDIS_CLUSTER_STATS(COUNTER, HISTOGRAM)                                                    \
+  COUNTER(batch_redirected)                                                                        \
   COUNTER(upstream_cx_drained)                                                                     \
-  COUNTER(max_upstream_unknown_connections_reached)
+  COUNTER(max_upstream_unknown_connections_reached)                                                \
+  HISTOGRAM(batch_size, Unspecified)
 
 struct RedisClusterStats {
-  REDIS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT)
+  REDIS_CLUSTER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_HISTOGRAM_STRUCT)
 };
 
 class DoNothingPoolCallbacks : public PoolCallbacks {
@@ -67,6 +73,7 @@ public:
   // RedisProxy::ConnPool::Instance
   Common::Redis::Client::PoolRequest* makeRequest(const std::string& key, RespVariant&& request,
                                                   PoolCallbacks& callbacks) override;
+  ClientCache* clientCache() override;
   /**
    * Makes a redis request based on IP address and TCP port of the upstream host (e.g.,
    * moved/ask cluster redirection). This is now only kept mostly for testing.
@@ -125,6 +132,60 @@ private:
     PoolCallbacks& pool_callbacks_;
   };
 
+  // The commands which can be merged into a batch.
+  enum class BatchType { Get, Set };
+
+  /**
+   * A MGET or MSET sent upstream in place of several GET or SET requests. The response is
+   * demultiplexed to the requests. A batch of a single request sends the request itself.
+   */
+  struct Batch : public Common::Redis::Client::ClientCallbacks,
+                 public Event::DeferredDeletable,
+                 public LinkedObject<Batch> {
+    // The handle of a request merged into the batch.
+    struct Entry : public Common::Redis::Client::PoolRequest {
+      Entry(PendingRequest& request)
+          : request_(&request), incoming_request_(request.incoming_request_) {}
+
+      // PoolRequest
+      void cancel() override { request_ = nullptr; }
+
+      // Reset once the request is canceled or completed.
+      PendingRequest* request_;
+      // Outlives the request if it is canceled.
+      const RespVariant incoming_request_;
+    };
+
+    Batch(ThreadLocalPool& parent, Upstream::HostConstSharedPtr host, BatchType type,
+          uint64_t slot)
+        : parent_(parent), host_(std::move(host)), type_(type), slot_(slot) {}
+
+    Entry& add(PendingRequest& request) { return entries_.emplace_back(request); }
+    void send();
+    void complete();
+
+    // Common::Redis::Client::ClientCallbacks
+    void onResponse(Common::Redis::RespValuePtr&& response) override;
+    void onFailure() override;
+    bool onRedirection(Common::Redis::RespValuePtr&& value, const std::string& host_address,
+                       bool ask_redirection) override;
+
+    ThreadLocalPool& parent_;
+    const Upstream::HostConstSharedPtr host_;
+    const BatchType type_;
+    // The Redis Cluster slot of the keys, or 0 if not using Redis Cluster.
+    const uint64_t slot_;
+    // A deque, as the requests reference their entry.
+    std::deque<Entry> entries_;
+  };
+
+  using BatchPtr = std::unique_ptr<Batch>;
+
+  /**
+   * @return the type of the batches a request may be merged into, if any.
+   */
+  static absl::optional<BatchType> batchType(const Common::Redis::RespValue& request);
+
   struct ThreadLocalPool : public ThreadLocal::ThreadLocalObject,
                            public Upstream::ClusterUpdateCallbacks,
                            public Logger::Loggable<Logger::Id::redis> {
@@ -150,6 +211,8 @@ private:
     void onClusterRemoval(const std::string& cluster_name) override;
 
     void onRequestCompleted();
+    void sendBatch(Upstream::HostConstSharedPtr host);
+    void sendBatches();
 
     std::weak_ptr<InstanceImpl> parent_;
     Event::Dispatcher& dispatcher_;
@@ -179,6 +242,16 @@ private:
     Common::Redis::RedisCommandStatsSharedPtr redis_command_stats_;
     RedisClusterStats redis_cluster_stats_;
     const Extensions::Common::Redis::ClusterRefreshManagerSharedPtr refresh_manager_;
+    // Only set if client side caching is enabled.
+    ClientCacheImplPtr client_cache_;
+    // 0 if command batching is disabled.
+    const uint32_t max_batch_size_;
+    const std::chrono::milliseconds batch_window_;
+    // The batches waiting for more requests, by host.
+    absl::node_hash_map<Upstream::HostConstSharedPtr, BatchPtr> open_batches_;
+    // The batches waiting for their response.
+    std::list<BatchPtr> sent_batches_;
+    Event::TimerPtr batch_timer_;
   };
 
   const std::string cluster_name_;
@@ -191,6 +264,11 @@ private:
   Common::Redis::RedisCommandStatsSharedPtr redis_command_stats_;
   RedisClusterStats redis_cluster_stats_;
   const Extensions::Common::Redis::ClusterRefreshManagerSharedPtr refresh_manager_;
+  // Only set if client side caching is enabled.
+  ClientCacheConfigSharedPtr client_cache_config_;
+  std::unique_ptr<ClientCacheStats> client_cache_stats_;
+  const uint32_t max_batch_size_;
+  const std::chrono::milliseconds batch_window_;
 };
 
 } // namespace ConnPool
@@ -9,6 +9,14 @@ namespace Extensions {
 namespace UdpFilters {
 namespace UdpProxy {
 
+namespace {
+
+// The number of datagrams buffered for an upstream host before they are sent without waiting for
+// the end of the event loop iteration.
+constexpr uint32_t MaxBatchedDatagrams = 64;
+
+} // namespace
+
 UdpProxyFilter::UdpProxyFilter(Network::UdpReadFilterCallbacks& callbacks,
                                const UdpProxyFilterConfigSharedPtr& config)
     : UdpListenerReadFilter(callbacks), config_(config),
@@ -72,7 +80,13 @@ UdpProxyFilter::ClusterInfo::ClusterInfo(UdpProxyFilter& filter,
                 host_to_sessions_.erase(host_sessions_it);
               }
             }
-          })) {}
+          })) {
+  if (filter_.config_->batchUpstreamWrites()) {
+    flush_sessions_cb_ =
+        filter_.read_callbacks_->udpListener().dispatcher().createSchedulableCallback(
+            [this] { flushSessions(); });
+  }
+}
 
 UdpProxyFilter::ClusterInfo::~ClusterInfo() {
   // Sanity check the session accounting. This is not as fast as a straight teardown, but this is
@@ -138,6 +152,26 @@ UdpProxyFilter::ClusterInfo::createSession(Network::UdpRecvData::LocalPeerAddres
   return new_session_ptr;
 }
 
+void UdpProxyFilter::ClusterInfo::scheduleFlush(ActiveSession& session) {
+  if (sessions_to_flush_.empty()) {
+    flush_sessions_cb_->scheduleCallbackCurrentIteration();
+  }
+  sessions_to_flush_.insert(&session);
+}
+
+void UdpProxyFilter::ClusterInfo::cancelFlush(ActiveSession& session) {
+  if (sessions_to_flush_.erase(&session) > 0 && sessions_to_flush_.empty()) {
+    flush_sessions_cb_->cancel();
+  }
+}
+
+void UdpProxyFilter::ClusterInfo::flushSessions() {
+  for (ActiveSession* session : sessions_to_flush_) {
+    session->flush();
+  }
+  sessions_to_flush_.clear();
+}
+
 void UdpProxyFilter::ClusterInfo::removeSession(const ActiveSession* session) {
   // First remove from the host to sessions map.
   ASSERT(host_to_sessions_[&session->host()].count(session) == 1);
@@ -161,7 +195,11 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
           [this] { onIdleTimer(); })),
       // NOTE: The socket call can only fail due to memory/fd exhaustion. No local ephemeral port
       //       is bound until the first packet is sent to the upstream host.
-      socket_(cluster.filter_.createSocket(host)) {
+      socket_(cluster.filter_.createSocket(host)),
+      batch_writer_(cluster.filter_.config_->batchUpstreamWrites()
+                        ? std::make_unique<Network::UdpBatchWriter>(socket_->ioHandle(),
+                                                                    MaxBatchedDatagrams)
+                        : nullptr) {
 
   socket_->ioHandle().initializeFileEvent(
       cluster.filter_.read_callbacks_->udpListener().dispatcher(),
@@ -196,6 +234,10 @@ UdpProxyFilter::ActiveSession::ActiveSession(ClusterInfo& cluster,
 }
 
 UdpProxyFilter::ActiveSession::~ActiveSession() {
+  if (batch_writer_ != nullptr) {
+    cluster_.cancelFlush(*this);
+    flush();
+  }
   ENVOY_LOG(debug, "deleting the session: downstream={} local={} upstream={}",
             addresses_.peer_->asStringView(), addresses_.local_->asStringView(),
             host_->address()->asStringView());
@@ -247,7 +289,13 @@ void UdpProxyFilter::ActiveSession::write(const Buffer::Instance& buffer) {
   //       use_original_src_ip_ is not set, else use downstream peer IP as local IP.
   const Network::Address::Ip* local_ip = use_original_src_ip_ ? addresses_.peer_->ip() : nullptr;
   Api::IoCallUint64Result rc =
-      Network::Utility::writeToSocket(socket_->ioHandle(), buffer, local_ip, *host_->address());
+      batch_writer_ != nullptr
+          ? batch_writer_->writePacket(buffer, local_ip, *host_->address())
+          : Network::Utility::writeToSocket(socket_->ioHandle(), buffer, local_ip,
+                                            *host_->address());
+  if (batch_writer_ != nullptr && batch_writer_->bufferedDatagrams() > 0) {
+    cluster_.scheduleFlush(*this);
+  }
   if (!rc.ok()) {
     cluster_.cluster_stats_.sess_tx_errors_.inc();
   } else {
@@ -256,6 +304,14 @@ void UdpProxyFilter::ActiveSession::write(const Buffer::Instance& buffer) {
   }
 }
 
+void UdpProxyFilter::ActiveSession::flush() {
+  // Datagrams are counted as sent when they are buffered, so only the failure is counted here.
+  const Api::IoCallUint64Result rc = batch_writer_->flush();
+  if (!rc.ok()) {
+    cluster_.cluster_stats_.sess_tx_errors_.inc();
+  }
+}
+
 void UdpProxyFilter::ActiveSession::processPacket(Network::Address::InstanceConstSharedPtr,
                                                   Network::Address::InstanceConstSharedPtr,
                                                   Buffer::InstancePtr buffer, MonotonicTime) {
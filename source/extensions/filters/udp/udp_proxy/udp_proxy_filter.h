@@ -1,6 +1,7 @@
 #pragma once
 
 #include "envoy/event/file_event.h"
+#include "envoy/event/schedulable_cb.h"
 #include "envoy/event/timer.h"
 #include "envoy/extensions/filters/udp/udp_proxy/v3/udp_proxy.pb.h"
 #include "envoy/network/filter.h"
@@ -9,6 +10,7 @@
 #include "common/api/os_sys_calls_impl.h"
 #include "common/network/socket_impl.h"
 #include "common/network/socket_interface.h"
+#include "common/network/udp_batch_writer.h"
 #include "common/network/utility.h"
 #include "common/upstream/load_balancer_impl.h"
 
@@ -69,6 +71,8 @@ public:
       : cluster_manager_(cluster_manager), time_source_(time_source), cluster_(config.cluster()),
         session_timeout_(PROTOBUF_GET_MS_OR_DEFAULT(config, idle_timeout, 60 * 1000)),
         use_original_src_ip_(config.use_original_src_ip()),
+        batch_upstream_writes_(config.batch_upstream_writes() &&
+                               Api::OsSysCallsSingleton::get().supportsMmsg()),
         stats_(generateStats(config.stat_prefix(), root_scope)) {
     if (use_original_src_ip_ && !Api::OsSysCallsSingleton::get().supportsIpTransparent()) {
       ExceptionUtil::throwEnvoyException(
@@ -84,6 +88,7 @@ public:
   Upstream::ClusterManager& clusterManager() const { return cluster_manager_; }
   std::chrono::milliseconds sessionTimeout() const { return session_timeout_; }
   bool usingOriginalSrcIp() const { return use_original_src_ip_; }
+  bool batchUpstreamWrites() const { return batch_upstream_writes_; }
   const Udp::HashPolicy* hashPolicy() const { return hash_policy_.get(); }
   UdpProxyDownstreamStats& stats() const { return stats_; }
   TimeSource& timeSource() const { return time_source_; }
@@ -101,6 +106,7 @@ private:
   const std::string cluster_;
   const std::chrono::milliseconds session_timeout_;
   const bool use_original_src_ip_;
+  const bool batch_upstream_writes_;
   std::unique_ptr<const HashPolicyImpl> hash_policy_;
   mutable UdpProxyDownstreamStats stats_;
 };
@@ -155,6 +161,8 @@ private:
     const Network::UdpRecvData::LocalPeerAddresses& addresses() const { return addresses_; }
     const Upstream::Host& host() const { return *host_; }
     void write(const Buffer::Instance& buffer);
+    // Sends the datagrams buffered by write() if upstream writes are batched.
+    void flush();
 
   private:
     void onIdleTimer();
@@ -185,6 +193,9 @@ private:
     // packets from the upstream host. Note that a a local ephemeral port is bound on the first
     // write to the upstream host.
     const Network::SocketPtr socket_;
+    // Buffers the datagrams written to the upstream host until the end of the event loop
+    // iteration if upstream writes are batched, otherwise nullptr.
+    const std::unique_ptr<Network::UdpBatchWriter> batch_writer_;
   };
 
   using ActiveSessionPtr = std::unique_ptr<ActiveSession>;
@@ -236,6 +247,9 @@ private:
     ~ClusterInfo();
     void onData(Network::UdpRecvData& data);
     void removeSession(const ActiveSession* session);
+    // Flushes the session at the end of the current event loop iteration.
+    void scheduleFlush(ActiveSession& session);
+    void cancelFlush(ActiveSession& session);
 
     UdpProxyFilter& filter_;
     Upstream::ThreadLocalCluster& cluster_;
@@ -249,7 +263,12 @@ private:
       return {ALL_UDP_PROXY_UPSTREAM_STATS(POOL_COUNTER_PREFIX(scope, final_prefix))};
     }
 
+    void flushSessions();
+
     Envoy::Common::CallbackHandlePtr member_update_cb_handle_;
+    // Only created if upstream writes are batched.
+    Event::SchedulableCallbackPtr flush_sessions_cb_;
+    absl::flat_hash_set<ActiveSession*> sessions_to_flush_;
     absl::flat_hash_set<ActiveSessionPtr, HeterogeneousActiveSessionHash,
                         HeterogeneousActiveSessionEqual>
         sessions_;
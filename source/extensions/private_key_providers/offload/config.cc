@@ -0,0 +1,32 @@
+#include "extensions/private_key_providers/offload/config.h"
+
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/private_key_providers/offload/offload_private_key_provider.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Offload {
+
+Ssl::PrivateKeyMethodProviderSharedPtr
+OffloadPrivateKeyMethodFactory::createPrivateKeyMethodProviderInstance(
+    const envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context) {
+  OffloadPrivateKeyMethodConfig offload_config;
+  MessageUtil::anyConvertAndValidate(config.typed_config(), offload_config,
+                                     factory_context.messageValidationVisitor());
+  return std::make_shared<OffloadPrivateKeyMethodProvider>(offload_config, factory_context);
+}
+
+/**
+ * Static registration for the offload private key provider. @see RegisterFactory.
+ */
+REGISTER_FACTORY(OffloadPrivateKeyMethodFactory, Ssl::PrivateKeyMethodProviderInstanceFactory);
+
+} // namespace Offload
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,372 @@
+#include "extensions/private_key_providers/offload/offload_private_key_provider.h"
+
+#include <chrono>
+#include <memory>
+
+#include "envoy/common/exception.h"
+
+#include "common/common/assert.h"
+#include "common/common/lock_guard.h"
+#include "common/common/macros.h"
+#include "common/config/datasource.h"
+#include "common/protobuf/utility.h"
+
+#include "openssl/err.h"
+#include "openssl/evp.h"
+#include "openssl/pem.h"
+#include "openssl/rsa.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Offload {
+
+namespace {
+
+constexpr uint32_t DefaultThreadCount = 2;
+constexpr uint32_t DefaultMaxQueueDepth = 1024;
+
+OffloadPrivateKeyConnection* getConnection(SSL* ssl, int index) {
+  return static_cast<OffloadPrivateKeyConnection*>(SSL_get_ex_data(ssl, index));
+}
+
+ssl_private_key_result_t privateKeySign(SSL* ssl, uint8_t* out, size_t* out_len, size_t max_out,
+                                        uint16_t signature_algorithm, const uint8_t* in,
+                                        size_t in_len, int index) {
+  OffloadPrivateKeyConnection* connection = getConnection(ssl, index);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(OffloadOperation::Type::Sign, out, out_len, max_out,
+                           signature_algorithm, in, in_len);
+}
+
+ssl_private_key_result_t privateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                            size_t max_out, int index) {
+  OffloadPrivateKeyConnection* connection = getConnection(ssl, index);
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->complete(out, out_len, max_out);
+}
+
+ssl_private_key_result_t rsaPrivateKeySign(SSL* ssl, uint8_t* out, size_t* out_len,
+                                           size_t max_out, uint16_t signature_algorithm,
+                                           const uint8_t* in, size_t in_len) {
+  return privateKeySign(ssl, out, out_len, max_out, signature_algorithm, in, in_len,
+                        OffloadPrivateKeyMethodProvider::rsaConnectionIndex());
+}
+
+ssl_private_key_result_t rsaPrivateKeyDecrypt(SSL* ssl, uint8_t* out, size_t* out_len,
+                                              size_t max_out, const uint8_t* in, size_t in_len) {
+  OffloadPrivateKeyConnection* connection =
+      getConnection(ssl, OffloadPrivateKeyMethodProvider::rsaConnectionIndex());
+  if (connection == nullptr) {
+    return ssl_private_key_failure;
+  }
+  return connection->start(OffloadOperation::Type::Decrypt, out, out_len, max_out, 0, in, in_len);
+}
+
+ssl_private_key_result_t rsaPrivateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                               size_t max_out) {
+  return privateKeyComplete(ssl, out, out_len, max_out,
+                            OffloadPrivateKeyMethodProvider::rsaConnectionIndex());
+}
+
+ssl_private_key_result_t ecdsaPrivateKeySign(SSL* ssl, uint8_t* out, size_t* out_len,
+                                             size_t max_out, uint16_t signature_algorithm,
+                                             const uint8_t* in, size_t in_len) {
+  return privateKeySign(ssl, out, out_len, max_out, signature_algorithm, in, in_len,
+                        OffloadPrivateKeyMethodProvider::ecdsaConnectionIndex());
+}
+
+ssl_private_key_result_t ecdsaPrivateKeyDecrypt(SSL*, uint8_t*, size_t*, size_t, const uint8_t*,
+                                                size_t) {
+  // Key exchanges which decrypt with the private key only exist for RSA.
+  return ssl_private_key_failure;
+}
+
+ssl_private_key_result_t ecdsaPrivateKeyComplete(SSL* ssl, uint8_t* out, size_t* out_len,
+                                                 size_t max_out) {
+  return privateKeyComplete(ssl, out, out_len, max_out,
+                            OffloadPrivateKeyMethodProvider::ecdsaConnectionIndex());
+}
+
+int createIndex() {
+  int index = SSL_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+  RELEASE_ASSERT(index >= 0, "Failed to get SSL user data index.");
+  return index;
+}
+
+} // namespace
+
+OffloadOperation::OffloadOperation(Type type, EVP_PKEY* pkey, uint16_t signature_algorithm,
+                                   const uint8_t* in, size_t in_len)
+    : type_(type), pkey_(bssl::UpRef(pkey)), signature_algorithm_(signature_algorithm),
+      input_(in, in + in_len) {}
+
+bool OffloadOperation::run() {
+  output_.clear();
+  if (type_ == Type::Decrypt) {
+    RSA* rsa = EVP_PKEY_get0_RSA(pkey_.get());
+    if (rsa == nullptr) {
+      return false;
+    }
+    output_.resize(RSA_size(rsa));
+    size_t out_len;
+    // The padding is checked by BoringSSL, so that the check happens in constant time.
+    if (!RSA_decrypt(rsa, &out_len, output_.data(), output_.size(), input_.data(), input_.size(),
+                     RSA_NO_PADDING)) {
+      // Don't leave the error on the queue of the thread, which may not be the handshake's.
+      ERR_clear_error();
+      return false;
+    }
+    output_.resize(out_len);
+    return true;
+  }
+
+  const EVP_MD* md = SSL_get_signature_algorithm_digest(signature_algorithm_);
+  if (md == nullptr ||
+      SSL_get_signature_algorithm_key_type(signature_algorithm_) != EVP_PKEY_id(pkey_.get())) {
+    return false;
+  }
+  bssl::ScopedEVP_MD_CTX ctx;
+  EVP_PKEY_CTX* pkey_ctx;
+  size_t out_len = EVP_PKEY_size(pkey_.get());
+  output_.resize(out_len);
+  if (!EVP_DigestSignInit(ctx.get(), &pkey_ctx, md, nullptr, pkey_.get()) ||
+      (SSL_is_signature_algorithm_rsa_pss(signature_algorithm_) &&
+       (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+        !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) ||
+      !EVP_DigestSign(ctx.get(), output_.data(), &out_len, input_.data(), input_.size())) {
+    ERR_clear_error();
+    return false;
+  }
+  output_.resize(out_len);
+  return true;
+}
+
+OffloadPrivateKeyConnection::OffloadPrivateKeyConnection(OffloadPrivateKeyMethodProvider& provider,
+                                                         Ssl::PrivateKeyConnectionCallbacks& cb,
+                                                         Event::Dispatcher& dispatcher)
+    : provider_(provider), cb_(cb), dispatcher_(dispatcher) {}
+
+OffloadPrivateKeyConnection::~OffloadPrivateKeyConnection() { cancel(); }
+
+ssl_private_key_result_t OffloadPrivateKeyConnection::start(OffloadOperation::Type type,
+                                                            uint8_t* out, size_t* out_len,
+                                                            size_t max_out,
+                                                            uint16_t signature_algorithm,
+                                                            const uint8_t* in, size_t in_len) {
+  cancel();
+  OffloadPrivateKeyProviderStats& stats = provider_.stats();
+  if (type == OffloadOperation::Type::Sign) {
+    stats.sign_.inc();
+  } else {
+    stats.decrypt_.inc();
+  }
+
+  operation_ = std::make_shared<OffloadOperation>(type, provider_.privateKey(),
+                                                  signature_algorithm, in, in_len);
+  operation_->callbacks_ = &cb_;
+  operation_->queued_time_ = provider_.timeSource().monotonicTime();
+  {
+    Thread::LockGuard lock(operation_->lock_);
+    operation_->dispatcher_ = &dispatcher_;
+  }
+  if (provider_.post(operation_)) {
+    return ssl_private_key_retry;
+  }
+
+  // The pool is saturated: rather than queueing without bound, slow this worker down by performing
+  // the operation here.
+  stats.queue_overflow_.inc();
+  operation_->ok_ = operation_->run();
+  operation_->done_ = true;
+  return complete(out, out_len, max_out);
+}
+
+ssl_private_key_result_t OffloadPrivateKeyConnection::complete(uint8_t* out, size_t* out_len,
+                                                               size_t max_out) {
+  if (operation_ == nullptr) {
+    return ssl_private_key_failure;
+  }
+  if (!operation_->done_) {
+    return ssl_private_key_retry;
+  }
+
+  OffloadOperationSharedPtr operation = std::move(operation_);
+  OffloadPrivateKeyProviderStats& stats = provider_.stats();
+  stats.queue_time_.recordValue(std::chrono::duration_cast<std::chrono::microseconds>(
+                                    provider_.timeSource().monotonicTime() -
+                                    operation->queued_time_)
+                                    .count());
+  if (!operation->ok_ || operation->output_.size() > max_out) {
+    stats.failed_.inc();
+    return ssl_private_key_failure;
+  }
+  std::copy(operation->output_.begin(), operation->output_.end(), out);
+  *out_len = operation->output_.size();
+  return ssl_private_key_success;
+}
+
+void OffloadPrivateKeyConnection::cancel() {
+  if (operation_ == nullptr) {
+    return;
+  }
+  operation_->callbacks_ = nullptr;
+  operation_->cancelled_ = true;
+  Thread::LockGuard lock(operation_->lock_);
+  operation_->dispatcher_ = nullptr;
+}
+
+OffloadPrivateKeyMethodProvider::OffloadPrivateKeyMethodProvider(
+    const OffloadPrivateKeyMethodConfig& config,
+    Server::Configuration::TransportSocketFactoryContext& factory_context)
+    : stats_({ALL_OFFLOAD_PRIVATE_KEY_PROVIDER_STATS(
+          POOL_COUNTER_PREFIX(factory_context.scope(), "private_key_provider.offload."),
+          POOL_GAUGE_PREFIX(factory_context.scope(), "private_key_provider.offload."),
+          POOL_HISTOGRAM_PREFIX(factory_context.scope(), "private_key_provider.offload."))}),
+      time_source_(factory_context.api().timeSource()),
+      max_queue_depth_(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_queue_depth, DefaultMaxQueueDepth)) {
+  const std::string private_key =
+      Config::DataSource::read(config.private_key(), false, factory_context.api());
+  bssl::UniquePtr<BIO> bio(BIO_new_mem_buf(private_key.data(), private_key.size()));
+  pkey_.reset(PEM_read_bio_PrivateKey(bio.get(), nullptr, nullptr, nullptr));
+  if (pkey_ == nullptr) {
+    throw EnvoyException("Failed to load private key of the offload private key provider.");
+  }
+
+  method_ = std::make_shared<SSL_PRIVATE_KEY_METHOD>();
+  switch (EVP_PKEY_id(pkey_.get())) {
+  case EVP_PKEY_RSA:
+    method_->sign = rsaPrivateKeySign;
+    method_->decrypt = rsaPrivateKeyDecrypt;
+    method_->complete = rsaPrivateKeyComplete;
+    break;
+  case EVP_PKEY_EC:
+    method_->sign = ecdsaPrivateKeySign;
+    method_->decrypt = ecdsaPrivateKeyDecrypt;
+    method_->complete = ecdsaPrivateKeyComplete;
+    break;
+  default:
+    throw EnvoyException("The offload private key provider only supports RSA and ECDSA keys.");
+  }
+
+  const uint32_t thread_count =
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, thread_count, DefaultThreadCount);
+  threads_.reserve(thread_count);
+  for (uint32_t i = 0; i < thread_count; ++i) {
+    threads_.push_back(factory_context.api().threadFactory().createThread(
+        [this]() -> void { threadRoutine(); }, Thread::Options{"tls_key_offload"}));
+  }
+}
+
+OffloadPrivateKeyMethodProvider::~OffloadPrivateKeyMethodProvider() {
+  {
+    Thread::LockGuard lock(lock_);
+    exit_ = true;
+    // Connections hold a reference to their provider, so nothing waits for the queued operations.
+    stats_.queue_depth_.sub(queue_.size());
+    queue_.clear();
+    operation_posted_.notifyAll();
+  }
+  for (Thread::ThreadPtr& thread : threads_) {
+    thread->join();
+  }
+}
+
+bool OffloadPrivateKeyMethodProvider::post(const OffloadOperationSharedPtr& operation) {
+  Thread::LockGuard lock(lock_);
+  if (queue_.size() >= max_queue_depth_) {
+    return false;
+  }
+  queue_.push_back(operation);
+  // Incremented before a thread can take the operation and decrement it.
+  stats_.queue_depth_.inc();
+  operation_posted_.notifyOne();
+  return true;
+}
+
+void OffloadPrivateKeyMethodProvider::threadRoutine() {
+  while (true) {
+    OffloadOperationSharedPtr operation;
+    {
+      Thread::LockGuard lock(lock_);
+      while (queue_.empty() && !exit_) {
+        // CondVar::wait() does not throw, so it's safe to pass the mutex rather than the guard.
+        operation_posted_.wait(lock_);
+      }
+      if (exit_) {
+        return;
+      }
+      operation = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    // The operation is skipped if its connection went away while it was queued.
+    const bool ok = !operation->cancelled_ && operation->run();
+    stats_.queue_depth_.dec();
+
+    Thread::LockGuard lock(operation->lock_);
+    if (operation->dispatcher_ != nullptr) {
+      operation->dispatcher_->post([operation, ok]() -> void {
+        operation->ok_ = ok;
+        operation->done_ = true;
+        // Resumes the handshake, which calls OffloadPrivateKeyConnection::complete().
+        if (operation->callbacks_ != nullptr) {
+          operation->callbacks_->onPrivateKeyMethodComplete();
+        }
+      });
+    }
+  }
+}
+
+void OffloadPrivateKeyMethodProvider::registerPrivateKeyMethod(
+    SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb, Event::Dispatcher& dispatcher) {
+  const int index = connectionIndex();
+  if (SSL_get_ex_data(ssl, index) != nullptr) {
+    throw EnvoyException(
+        "Can't distinguish between two registered providers for the same SSL object.");
+  }
+  SSL_set_ex_data(ssl, index, new OffloadPrivateKeyConnection(*this, cb, dispatcher));
+}
+
+void OffloadPrivateKeyMethodProvider::unregisterPrivateKeyMethod(SSL* ssl) {
+  const int index = connectionIndex();
+  OffloadPrivateKeyConnection* connection = getConnection(ssl, index);
+  SSL_set_ex_data(ssl, index, nullptr);
+  delete connection;
+}
+
+bool OffloadPrivateKeyMethodProvider::checkFips() {
+  if (EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA) {
+    RSA* rsa_private_key = EVP_PKEY_get0_RSA(pkey_.get());
+    return rsa_private_key != nullptr && RSA_check_fips(rsa_private_key);
+  }
+  const EC_KEY* ecdsa_private_key = EVP_PKEY_get0_EC_KEY(pkey_.get());
+  return ecdsa_private_key != nullptr && EC_KEY_check_fips(ecdsa_private_key);
+}
+
+Ssl::BoringSslPrivateKeyMethodSharedPtr
+OffloadPrivateKeyMethodProvider::getBoringSslPrivateKeyMethod() {
+  return method_;
+}
+
+int OffloadPrivateKeyMethodProvider::connectionIndex() const {
+  return EVP_PKEY_id(pkey_.get()) == EVP_PKEY_RSA ? rsaConnectionIndex() : ecdsaConnectionIndex();
+}
+
+int OffloadPrivateKeyMethodProvider::rsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+int OffloadPrivateKeyMethodProvider::ecdsaConnectionIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, createIndex());
+}
+
+} // namespace Offload
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
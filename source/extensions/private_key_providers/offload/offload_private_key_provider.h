@@ -0,0 +1,172 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <vector>
+
+#include "envoy/common/time.h"
+#include "envoy/event/dispatcher.h"
+#include "envoy/extensions/private_key_providers/offload/v3alpha/offload.pb.h"
+#include "envoy/server/transport_socket_config.h"
+#include "envoy/ssl/private_key/private_key.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/thread.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Offload {
+
+using OffloadPrivateKeyMethodConfig =
+    envoy::extensions::private_key_providers::offload::v3alpha::OffloadPrivateKeyMethodConfig;
+
+/**
+ * All offload private key provider stats. @see stats_macros.h
+ */
+#define ALL_OFFLOAD_PRIVATE_KEY_PROVIDER_STATS(COUNTER, GAUGE, HISTOGRAM)                          \
+  COUNTER(decrypt)                                                                                 \
+  COUNTER(failed)                                                                                  \
+  COUNTER(queue_overflow)                                                                          \
+  COUNTER(sign)                                                                                    \
+  GAUGE(queue_depth, Accumulate)                                                                   \
+  HISTOGRAM(queue_time, Microseconds)
+
+/**
+ * Struct definition for all offload private key provider stats. @see stats_macros.h
+ */
+struct OffloadPrivateKeyProviderStats {
+  ALL_OFFLOAD_PRIVATE_KEY_PROVIDER_STATS(GENERATE_COUNTER_STRUCT, GENERATE_GAUGE_STRUCT,
+                                         GENERATE_HISTOGRAM_STRUCT)
+};
+
+/**
+ * A private key operation of a handshake. It is created on the worker running the handshake,
+ * performed on a pool thread and completed back on the worker.
+ */
+class OffloadOperation {
+public:
+  enum class Type { Sign, Decrypt };
+
+  OffloadOperation(Type type, EVP_PKEY* pkey, uint16_t signature_algorithm, const uint8_t* in,
+                   size_t in_len);
+
+  /**
+   * Performs the operation, storing its result in output_. Thread safe.
+   * @return bool whether the operation succeeded.
+   */
+  bool run();
+
+  const Type type_;
+  const bssl::UniquePtr<EVP_PKEY> pkey_;
+  const uint16_t signature_algorithm_;
+  const std::vector<uint8_t> input_;
+  std::vector<uint8_t> output_;
+  MonotonicTime queued_time_;
+
+  // The following are accessed on the worker only.
+  bool done_{};
+  bool ok_{};
+  // Cleared once the handshake no longer waits for the operation.
+  Ssl::PrivateKeyConnectionCallbacks* callbacks_{};
+
+  // Guards the delivery of the result to the worker, which must not happen once the connection is
+  // gone, as the worker's dispatcher may be too.
+  Thread::MutexBasicLockable lock_;
+  Event::Dispatcher* dispatcher_ ABSL_GUARDED_BY(lock_){};
+  // Set once the result is no longer needed, so that pool threads can skip the operation.
+  std::atomic<bool> cancelled_{};
+};
+
+using OffloadOperationSharedPtr = std::shared_ptr<OffloadOperation>;
+
+class OffloadPrivateKeyMethodProvider;
+
+/**
+ * The per connection state of the provider, attached to the SSL object of the connection.
+ */
+class OffloadPrivateKeyConnection {
+public:
+  OffloadPrivateKeyConnection(OffloadPrivateKeyMethodProvider& provider,
+                              Ssl::PrivateKeyConnectionCallbacks& cb,
+                              Event::Dispatcher& dispatcher);
+  ~OffloadPrivateKeyConnection();
+
+  ssl_private_key_result_t start(OffloadOperation::Type type, uint8_t* out, size_t* out_len,
+                                 size_t max_out, uint16_t signature_algorithm, const uint8_t* in,
+                                 size_t in_len);
+  ssl_private_key_result_t complete(uint8_t* out, size_t* out_len, size_t max_out);
+
+private:
+  void cancel();
+
+  OffloadPrivateKeyMethodProvider& provider_;
+  Ssl::PrivateKeyConnectionCallbacks& cb_;
+  Event::Dispatcher& dispatcher_;
+  OffloadOperationSharedPtr operation_;
+};
+
+/**
+ * Private key provider performing the signing and decryption of handshakes on its own pool of
+ * threads, so that RSA and ECDSA operations don't block the workers. The handshake waits for the
+ * result and is resumed on its worker through the dispatcher. If more operations are waiting for
+ * a thread than the configured limit, further ones are performed on the worker instead.
+ */
+class OffloadPrivateKeyMethodProvider : public virtual Ssl::PrivateKeyMethodProvider {
+public:
+  OffloadPrivateKeyMethodProvider(
+      const OffloadPrivateKeyMethodConfig& config,
+      Server::Configuration::TransportSocketFactoryContext& factory_context);
+
+  /**
+   * Waits for the operations being performed, dropping the queued ones, and joins the threads.
+   */
+  ~OffloadPrivateKeyMethodProvider() override;
+
+  // Ssl::PrivateKeyMethodProvider
+  void registerPrivateKeyMethod(SSL* ssl, Ssl::PrivateKeyConnectionCallbacks& cb,
+                                Event::Dispatcher& dispatcher) override;
+  void unregisterPrivateKeyMethod(SSL* ssl) override;
+  bool checkFips() override;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr getBoringSslPrivateKeyMethod() override;
+
+  /**
+   * Queues an operation for the pool threads. Called on workers.
+   * @return bool false if the queue is full, in which case the caller must perform the operation.
+   */
+  bool post(const OffloadOperationSharedPtr& operation);
+
+  EVP_PKEY* privateKey() { return pkey_.get(); }
+  OffloadPrivateKeyProviderStats& stats() { return stats_; }
+  TimeSource& timeSource() { return time_source_; }
+
+  static int rsaConnectionIndex();
+  static int ecdsaConnectionIndex();
+
+private:
+  void threadRoutine();
+  int connectionIndex() const;
+
+  bssl::UniquePtr<EVP_PKEY> pkey_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  OffloadPrivateKeyProviderStats stats_;
+  TimeSource& time_source_;
+  const uint32_t max_queue_depth_;
+
+  Thread::MutexBasicLockable lock_;
+  Thread::CondVar operation_posted_;
+  std::list<OffloadOperationSharedPtr> queue_ ABSL_GUARDED_BY(lock_);
+  bool exit_ ABSL_GUARDED_BY(lock_){};
+  std::vector<Thread::ThreadPtr> threads_;
+};
+
+} // namespace Offload
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -93,6 +93,7 @@ public:
   absl::string_view transportFailureReason() const override { return transport_failure_reason_; }
   bool startSecureTransport() override { return false; }
   absl::optional<std::chrono::milliseconds> lastRoundTripTime() const override { return {}; }
+  bool startSplice(Network::Connection&) override { return false; }
 
   // Network::FilterManagerConnection
   void rawWrite(Buffer::Instance& data, bool end_stream) override;
@@ -0,0 +1,48 @@
+#include "extensions/stat_sinks/prometheus_remote_write/config.h"
+
+#include <memory>
+
+#include "envoy/extensions/stat_sinks/prometheus_remote_write/v3/prometheus_remote_write.pb.h"
+#include "envoy/extensions/stat_sinks/prometheus_remote_write/v3/prometheus_remote_write.pb.validate.h"
+#include "envoy/registry/registry.h"
+
+#include "common/protobuf/utility.h"
+
+#include "extensions/stat_sinks/prometheus_remote_write/remote_write_sink.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+
+Stats::SinkPtr PrometheusRemoteWriteSinkFactory::createStatsSink(
+    const Protobuf::Message& config, Server::Configuration::ServerFactoryContext& server) {
+  const auto& sink_config = MessageUtil::downcastAndValidate<
+      const envoy::extensions::stat_sinks::prometheus_remote_write::v3::PrometheusRemoteWrite&>(
+      config, server.messageValidationContext().staticValidationVisitor());
+  return std::make_unique<PrometheusRemoteWriteSink>(
+      server.clusterManager(), server.scope(), sink_config.http_uri(),
+      PROTOBUF_GET_WRAPPED_OR_DEFAULT(sink_config, max_samples_per_request, 5000),
+      std::chrono::milliseconds(
+          PROTOBUF_GET_MS_OR_DEFAULT(sink_config, resend_interval, 4 * 60 * 1000)));
+}
+
+ProtobufTypes::MessagePtr PrometheusRemoteWriteSinkFactory::createEmptyConfigProto() {
+  return std::make_unique<
+      envoy::extensions::stat_sinks::prometheus_remote_write::v3::PrometheusRemoteWrite>();
+}
+
+std::string PrometheusRemoteWriteSinkFactory::name() const {
+  return StatsSinkNames::get().PrometheusRemoteWrite;
+}
+
+/**
+ * Static registration for the Prometheus remote write sink factory. @see RegisterFactory.
+ */
+REGISTER_FACTORY(PrometheusRemoteWriteSinkFactory, Server::Configuration::StatsSinkFactory);
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
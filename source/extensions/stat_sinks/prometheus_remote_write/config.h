@@ -0,0 +1,34 @@
+#pragma once
+
+#include <string>
+
+#include "envoy/server/instance.h"
+
+#include "server/configuration_impl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+
+/**
+ * Config registration for the Prometheus remote write stats sink. @see StatsSinkFactory.
+ */
+class PrometheusRemoteWriteSinkFactory : Logger::Loggable<Logger::Id::config>,
+                                         public Server::Configuration::StatsSinkFactory {
+public:
+  // StatsSinkFactory
+  Stats::SinkPtr createStatsSink(const Protobuf::Message& config,
+                                 Server::Configuration::ServerFactoryContext& server) override;
+
+  ProtobufTypes::MessagePtr createEmptyConfigProto() override;
+
+  std::string name() const override;
+};
+
+DECLARE_FACTORY(PrometheusRemoteWriteSinkFactory);
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,249 @@
+#include "extensions/stat_sinks/prometheus_remote_write/remote_write_sink.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "common/common/enum_to_int.h"
+#include "common/http/codes.h"
+#include "common/http/headers.h"
+#include "common/http/utility.h"
+#include "common/protobuf/utility.h"
+
+#include "server/admin/prometheus_stats.h"
+
+#include "extensions/stat_sinks/prometheus_remote_write/snappy.h"
+
+#include "absl/strings/ascii.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace {
+
+const Http::LowerCaseString& remoteWriteVersionHeader() {
+  CONSTRUCT_ON_FIRST_USE(Http::LowerCaseString, "x-prometheus-remote-write-version");
+}
+
+constexpr absl::string_view RemoteWriteVersion = "0.1.0";
+constexpr absl::string_view SnappyEncoding = "snappy";
+
+// Protobuf wire types.
+constexpr uint32_t VarintType = 0;
+constexpr uint32_t Fixed64Type = 1;
+constexpr uint32_t LengthDelimitedType = 2;
+
+void appendVarint(uint64_t value, std::string& output) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+size_t varintSize(uint64_t value) {
+  size_t size = 1;
+  while (value >= 0x80) {
+    value >>= 7;
+    ++size;
+  }
+  return size;
+}
+
+void appendKey(uint32_t field, uint32_t wire_type, std::string& output) {
+  appendVarint((field << 3) | wire_type, output);
+}
+
+void appendBytes(uint32_t field, absl::string_view bytes, std::string& output) {
+  appendKey(field, LengthDelimitedType, output);
+  appendVarint(bytes.size(), output);
+  output.append(bytes.data(), bytes.size());
+}
+
+// Appends a Label message, as field 1 of a TimeSeries.
+void appendLabel(absl::string_view name, absl::string_view value, std::string& output) {
+  appendKey(1, LengthDelimitedType, output);
+  appendVarint(2 + varintSize(name.size()) + name.size() + varintSize(value.size()) + value.size(),
+               output);
+  appendBytes(1, name, output);
+  appendBytes(2, value, output);
+}
+
+std::string sanitizeLabelName(absl::string_view name) {
+  // Label names must match [a-zA-Z_][a-zA-Z0-9_]*, see
+  // https://prometheus.io/docs/concepts/data_model/.
+  std::string sanitized(name);
+  for (char& c : sanitized) {
+    if (!absl::ascii_isalnum(c) && c != '_') {
+      c = '_';
+    }
+  }
+  if (!sanitized.empty() && absl::ascii_isdigit(sanitized[0])) {
+    sanitized.insert(0, "_");
+  }
+  return sanitized;
+}
+
+} // namespace
+
+void WriteRequestEncoder::addSeries(absl::string_view name,
+                                    std::vector<std::pair<std::string, std::string>>& labels,
+                                    double value, int64_t timestamp_ms) {
+  // The labels of a series must be sorted by name. "__name__" sorts before sanitized names
+  // starting with a lower case letter, but not necessarily before the others.
+  labels.emplace_back("__name__", std::string(name));
+  std::sort(labels.begin(), labels.end());
+
+  series_.clear();
+  for (const auto& label : labels) {
+    appendLabel(label.first, label.second, series_);
+  }
+  labels.pop_back();
+
+  // The Sample message, as field 2 of the TimeSeries.
+  std::string sample;
+  appendKey(1, Fixed64Type, sample);
+  uint64_t value_bits;
+  memcpy(&value_bits, &value, sizeof(value_bits));
+  for (int i = 0; i < 8; ++i) {
+    sample.push_back(static_cast<char>(value_bits >> (8 * i)));
+  }
+  appendKey(2, VarintType, sample);
+  appendVarint(static_cast<uint64_t>(timestamp_ms), sample);
+  appendBytes(2, sample, series_);
+
+  // The TimeSeries, as field 1 of the WriteRequest.
+  appendBytes(1, series_, data_);
+  ++num_series_;
+}
+
+PrometheusRemoteWriteSink::PrometheusRemoteWriteSink(
+    Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
+    const envoy::config::core::v3::HttpUri& http_uri, uint32_t max_samples_per_request,
+    std::chrono::milliseconds resend_interval)
+    : cluster_manager_(cluster_manager), http_uri_(http_uri),
+      max_samples_per_request_(max_samples_per_request),
+      resend_interval_ms_(resend_interval.count()),
+      stats_{ALL_PROMETHEUS_REMOTE_WRITE_STATS(
+          POOL_COUNTER_PREFIX(scope, "prometheus_remote_write."))} {}
+
+PrometheusRemoteWriteSink::~PrometheusRemoteWriteSink() {
+  // Canceling a request doesn't call the callbacks, so the set isn't modified while iterating.
+  for (const Http::AsyncClient::Request* request : active_requests_) {
+    const_cast<Http::AsyncClient::Request*>(request)->cancel();
+  }
+}
+
+void PrometheusRemoteWriteSink::flush(Stats::MetricSnapshot& snapshot) {
+  const int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                             snapshot.snapshotTime().time_since_epoch())
+                             .count();
+  const bool resend = resend_all_;
+  resend_all_ = false;
+  ++flushes_;
+
+  for (const auto& counter : snapshot.counters()) {
+    if (counter.counter_.get().used()) {
+      addMetric(counter.counter_.get(), counter.counter_.get().value(), now_ms, resend);
+    }
+  }
+  for (const auto& gauge : snapshot.gauges()) {
+    if (gauge.get().used()) {
+      addMetric(gauge.get(), gauge.get().value(), now_ms, resend);
+    }
+  }
+  send();
+
+  // Forgets the metrics which were deleted, or are no longer used.
+  absl::erase_if(sent_metrics_,
+                 [this](const auto& entry) { return entry.second.flush_ != flushes_; });
+}
+
+void PrometheusRemoteWriteSink::addMetric(const Stats::Metric& metric, double value,
+                                          int64_t now_ms, bool resend) {
+  const uint64_t name_hash = metric.statName().hash();
+  auto result = sent_metrics_.try_emplace(&metric);
+  SentMetric& sent = result.first->second;
+  const bool changed = result.second || sent.name_hash_ != name_hash || sent.value_ != value;
+  sent.flush_ = flushes_;
+  if (!changed && !resend && now_ms - sent.sent_ms_ < resend_interval_ms_) {
+    stats_.samples_unchanged_.inc();
+    return;
+  }
+  sent.name_hash_ = name_hash;
+  sent.value_ = value;
+  sent.sent_ms_ = now_ms;
+
+  labels_.clear();
+  for (const Stats::Tag& tag : metric.tags()) {
+    labels_.emplace_back(sanitizeLabelName(tag.name_), tag.value_);
+  }
+  encoder_.addSeries(Server::PrometheusStatsFormatter::metricName(metric.tagExtractedName()),
+                     labels_, value, now_ms);
+  if (encoder_.numSeries() >= max_samples_per_request_) {
+    send();
+  }
+}
+
+void PrometheusRemoteWriteSink::send() {
+  if (encoder_.numSeries() == 0) {
+    return;
+  }
+  stats_.samples_sent_.add(encoder_.numSeries());
+  stats_.requests_sent_.inc();
+
+  Http::RequestMessagePtr message = Http::Utility::prepareHeaders(http_uri_);
+  message->headers().setReferenceMethod(Http::Headers::get().MethodValues.Post);
+  message->headers().setReferenceContentType(Http::Headers::get().ContentTypeValues.Protobuf);
+  message->headers().addReferenceKey(Http::CustomHeaders::get().ContentEncoding, SnappyEncoding);
+  message->headers().addReferenceKey(remoteWriteVersionHeader(), RemoteWriteVersion);
+  std::string body;
+  Snappy::compress(encoder_.data(), body);
+  message->body().add(body);
+  encoder_.clear();
+
+  const auto thread_local_cluster = cluster_manager_.getThreadLocalCluster(http_uri_.cluster());
+  if (thread_local_cluster == nullptr) {
+    ENVOY_LOG(debug, "prometheus remote write: unknown cluster {}", http_uri_.cluster());
+    stats_.requests_failed_.inc();
+    resend_all_ = true;
+    return;
+  }
+  Http::AsyncClient::Request* request = thread_local_cluster->httpAsyncClient().send(
+      std::move(message), *this,
+      Http::AsyncClient::RequestOptions().setTimeout(
+          std::chrono::milliseconds(DurationUtil::durationToMilliseconds(http_uri_.timeout()))));
+  // The request is null if it failed inline.
+  if (request != nullptr) {
+    active_requests_.insert(request);
+  }
+}
+
+void PrometheusRemoteWriteSink::onSuccess(const Http::AsyncClient::Request& request,
+                                          Http::ResponseMessagePtr&& response) {
+  const uint64_t status_code = Http::Utility::getResponseStatus(response->headers());
+  if (Http::CodeUtility::is2xx(status_code)) {
+    active_requests_.erase(&request);
+    return;
+  }
+  ENVOY_LOG(debug, "prometheus remote write: response status code {}", status_code);
+  onRequestFailed(request);
+}
+
+void PrometheusRemoteWriteSink::onFailure(const Http::AsyncClient::Request& request,
+                                          Http::AsyncClient::FailureReason reason) {
+  ENVOY_LOG(debug, "prometheus remote write: request failed {}", enumToInt(reason));
+  onRequestFailed(request);
+}
+
+void PrometheusRemoteWriteSink::onRequestFailed(const Http::AsyncClient::Request& request) {
+  active_requests_.erase(&request);
+  stats_.requests_failed_.inc();
+  // The receiver may have missed changes, which are only sent once.
+  resend_all_ = true;
+}
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#include "envoy/config/core/v3/http_uri.pb.h"
+#include "envoy/http/async_client.h"
+#include "envoy/stats/scope.h"
+#include "envoy/stats/sink.h"
+#include "envoy/stats/stats_macros.h"
+#include "envoy/upstream/cluster_manager.h"
+
+#include "common/common/logger.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+
+/**
+ * All Prometheus remote write sink stats. @see stats_macros.h
+ */
+#define ALL_PROMETHEUS_REMOTE_WRITE_STATS(COUNTER)                                                 \
+  COUNTER(requests_sent)                                                                           \
+  COUNTER(requests_failed)                                                                         \
+  COUNTER(samples_sent)                                                                            \
+  COUNTER(samples_unchanged)
+
+/**
+ * Struct definition for all Prometheus remote write sink stats. @see stats_macros.h
+ */
+struct PrometheusRemoteWriteStats {
+  ALL_PROMETHEUS_REMOTE_WRITE_STATS(GENERATE_COUNTER_STRUCT)
+};
+
+/**
+ * Encodes samples as a Prometheus remote write WriteRequest protobuf message, see
+ * https://github.com/prometheus/prometheus/blob/main/prompb/remote.proto. The series are encoded
+ * directly in the wire format, as a WriteRequest is only a list of TimeSeries.
+ */
+class WriteRequestEncoder {
+public:
+  /**
+   * Adds a series with one sample.
+   * @param name the metric name, which is sent as the __name__ label.
+   * @param labels the other labels of the series, with sanitized names.
+   * @param value the value of the sample.
+   * @param timestamp_ms the time of the sample in milliseconds since the epoch.
+   */
+  void addSeries(absl::string_view name, std::vector<std::pair<std::string, std::string>>& labels,
+                 double value, int64_t timestamp_ms);
+
+  /**
+   * @return the encoded WriteRequest.
+   */
+  const std::string& data() const { return data_; }
+
+  uint64_t numSeries() const { return num_series_; }
+
+  void clear() {
+    data_.clear();
+    num_series_ = 0;
+  }
+
+private:
+  std::string data_;
+  // Holds a series while it is encoded, as its length comes first.
+  std::string series_;
+  uint64_t num_series_{};
+};
+
+/**
+ * Stats sink pushing counters and gauges to a Prometheus remote write endpoint. Each flush only
+ * sends the metrics whose value changed since they were last sent, or which weren't sent for
+ * resend_interval. The value last sent for a metric is kept until the metric is no longer in a
+ * snapshot. When a request fails, all the metrics are sent again on the next flush.
+ */
+class PrometheusRemoteWriteSink : public Stats::Sink,
+                                  public Http::AsyncClient::Callbacks,
+                                  Logger::Loggable<Logger::Id::stats> {
+public:
+  PrometheusRemoteWriteSink(Upstream::ClusterManager& cluster_manager, Stats::Scope& scope,
+                            const envoy::config::core::v3::HttpUri& http_uri,
+                            uint32_t max_samples_per_request,
+                            std::chrono::milliseconds resend_interval);
+  ~PrometheusRemoteWriteSink() override;
+
+  // Stats::Sink
+  void flush(Stats::MetricSnapshot& snapshot) override;
+  void onHistogramComplete(const Stats::Histogram&, uint64_t) override {}
+
+  // Http::AsyncClient::Callbacks
+  void onSuccess(const Http::AsyncClient::Request& request,
+                 Http::ResponseMessagePtr&& response) override;
+  void onFailure(const Http::AsyncClient::Request& request,
+                 Http::AsyncClient::FailureReason reason) override;
+  void onBeforeFinalizeUpstreamSpan(Tracing::Span&, const Http::ResponseHeaderMap*) override {}
+
+private:
+  struct SentMetric {
+    // Tells a metric from one allocated at the same address after it was deleted.
+    uint64_t name_hash_;
+    double value_;
+    int64_t sent_ms_;
+    // The flush the metric was last seen in, to forget the metrics no longer in snapshots.
+    uint64_t flush_;
+  };
+
+  void addMetric(const Stats::Metric& metric, double value, int64_t now_ms, bool resend);
+  void send();
+  void onRequestFailed(const Http::AsyncClient::Request& request);
+
+  Upstream::ClusterManager& cluster_manager_;
+  const envoy::config::core::v3::HttpUri http_uri_;
+  const uint32_t max_samples_per_request_;
+  const int64_t resend_interval_ms_;
+  PrometheusRemoteWriteStats stats_;
+
+  absl::flat_hash_map<const Stats::Metric*, SentMetric> sent_metrics_;
+  uint64_t flushes_{};
+  bool resend_all_{};
+  WriteRequestEncoder encoder_;
+  std::vector<std::pair<std::string, std::string>> labels_;
+  absl::flat_hash_set<const Http::AsyncClient::Request*> active_requests_;
+};
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,133 @@
+#include "extensions/stat_sinks/prometheus_remote_write/snappy.h"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace Snappy {
+namespace {
+
+constexpr size_t FragmentSize = 1 << 16;
+constexpr uint32_t HashBits = 14;
+// Matches are only looked for this far from the end of a fragment, so 4 byte loads stay in it.
+constexpr size_t InputMargin = 4;
+
+enum Tag : uint8_t { Literal = 0, Copy1ByteOffset = 1, Copy2ByteOffset = 2 };
+
+uint32_t load32(const char* data) {
+  uint32_t value;
+  memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+uint32_t hash(uint32_t bytes) { return (bytes * 0x1e35a7bd) >> (32 - HashBits); }
+
+void appendVarint(uint64_t value, std::string& output) {
+  while (value >= 0x80) {
+    output.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  output.push_back(static_cast<char>(value));
+}
+
+void appendLiteral(absl::string_view literal, std::string& output) {
+  if (literal.empty()) {
+    return;
+  }
+  const size_t n = literal.size() - 1;
+  if (n < 60) {
+    output.push_back(static_cast<char>(Literal | (n << 2)));
+  } else {
+    // Tags 60 to 63 are followed by the length in 1 to 4 little endian bytes.
+    uint32_t num_bytes = 1;
+    while (num_bytes < 4 && (n >> (8 * num_bytes)) != 0) {
+      ++num_bytes;
+    }
+    output.push_back(static_cast<char>(Literal | ((59 + num_bytes) << 2)));
+    for (uint32_t i = 0; i < num_bytes; ++i) {
+      output.push_back(static_cast<char>(n >> (8 * i)));
+    }
+  }
+  output.append(literal.data(), literal.size());
+}
+
+// Appends a copy of at most 64 bytes.
+void appendShortCopy(size_t offset, size_t length, std::string& output) {
+  if (length < 12 && offset < 2048) {
+    output.push_back(
+        static_cast<char>(Copy1ByteOffset | ((length - 4) << 2) | ((offset >> 8) << 5)));
+    output.push_back(static_cast<char>(offset));
+  } else {
+    output.push_back(static_cast<char>(Copy2ByteOffset | ((length - 1) << 2)));
+    output.push_back(static_cast<char>(offset));
+    output.push_back(static_cast<char>(offset >> 8));
+  }
+}
+
+void appendCopy(size_t offset, size_t length, std::string& output) {
+  // Splits long copies so the last one is at least 4 bytes, which the 1 byte offset form needs.
+  while (length >= 68) {
+    appendShortCopy(offset, 64, output);
+    length -= 64;
+  }
+  if (length > 64) {
+    appendShortCopy(offset, 60, output);
+    length -= 60;
+  }
+  appendShortCopy(offset, length, output);
+}
+
+void compressFragment(absl::string_view fragment, std::array<uint16_t, 1 << HashBits>& table,
+                      std::string& output) {
+  const char* base = fragment.data();
+  size_t literal_start = 0;
+  if (fragment.size() >= InputMargin + 1) {
+    table.fill(0);
+    const size_t limit = fragment.size() - InputMargin;
+    // Position 0 can't be told apart from an empty table entry, so matching starts at 1.
+    size_t position = 1;
+    uint32_t misses = 0;
+    while (position < limit) {
+      const uint32_t bytes = load32(base + position);
+      uint16_t& entry = table[hash(bytes)];
+      const size_t candidate = entry;
+      entry = static_cast<uint16_t>(position);
+      if (candidate == 0 || load32(base + candidate) != bytes) {
+        // Skips ahead faster in data that doesn't compress.
+        position += 1 + (misses++ >> 5);
+        continue;
+      }
+      misses = 0;
+      size_t length = 4;
+      while (position + length < fragment.size() &&
+             base[candidate + length] == base[position + length]) {
+        ++length;
+      }
+      appendLiteral(fragment.substr(literal_start, position - literal_start), output);
+      appendCopy(position - candidate, length, output);
+      position += length;
+      literal_start = position;
+    }
+  }
+  appendLiteral(fragment.substr(literal_start), output);
+}
+
+} // namespace
+
+void compress(absl::string_view input, std::string& output) {
+  appendVarint(input.size(), output);
+  std::array<uint16_t, 1 << HashBits> table;
+  for (size_t start = 0; start < input.size(); start += FragmentSize) {
+    compressFragment(input.substr(start, FragmentSize), table, output);
+  }
+}
+
+} // namespace Snappy
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
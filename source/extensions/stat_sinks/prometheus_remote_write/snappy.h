@@ -0,0 +1,27 @@
+#pragma once
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace Snappy {
+
+/**
+ * Compresses data in the snappy block format, which the Prometheus remote write protocol requires
+ * for request bodies. See https://github.com/google/snappy/blob/master/format_description.txt.
+ * Like the reference implementation, the input is compressed in independent 64KiB fragments,
+ * with a hash table of 4 byte sequences to find matches.
+ * @param input the data to compress.
+ * @param output the string to append the compressed data to.
+ */
+void compress(absl::string_view input, std::string& output);
+
+} // namespace Snappy
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -22,6 +22,8 @@ public:
   const std::string MetricsService = "envoy.stat_sinks.metrics_service";
   // Hystrix sink
   const std::string Hystrix = "envoy.stat_sinks.hystrix";
+  // Prometheus remote write sink
+  const std::string PrometheusRemoteWrite = "envoy.stat_sinks.prometheus_remote_write";
   // WebAssembly sink
   const std::string Wasm = "envoy.stat_sinks.wasm";
 };
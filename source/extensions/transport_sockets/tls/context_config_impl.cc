@@ -180,7 +180,8 @@ ContextConfigImpl::ContextConfigImpl(
       min_protocol_version_(tlsVersionFromProto(config.tls_params().tls_minimum_protocol_version(),
                                                 default_min_protocol_version)),
       max_protocol_version_(tlsVersionFromProto(config.tls_params().tls_maximum_protocol_version(),
-                                                default_max_protocol_version)) {
+                                                default_max_protocol_version)),
+      kernel_tls_offload_(config.kernel_tls_offload()) {
   if (certificate_validation_context_provider_ != nullptr) {
     if (default_cvc_) {
       // We need to validate combined certificate validation context.
@@ -290,6 +291,12 @@ Ssl::HandshakerFactoryCb ContextConfigImpl::createHandshaker() const {
   return handshaker_factory_cb_;
 }
 
+absl::optional<Ssl::ContextConfig::SessionCacheConfig> ContextConfigImpl::sessionCacheFromProto(
+    const envoy::extensions::transport_sockets::tls::v3::TlsSessionCache& config) {
+  return SessionCacheConfig{PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, max_sessions, 10240),
+                            PROTOBUF_GET_WRAPPED_OR_DEFAULT(config, shards, 16)};
+}
+
 unsigned ContextConfigImpl::tlsVersionFromProto(
     const envoy::extensions::transport_sockets::tls::v3::TlsParameters::TlsProtocol& version,
     unsigned default_version) {
@@ -343,6 +350,9 @@ ClientContextConfigImpl::ClientContextConfigImpl(
   if (server_name_indication_.find('\0') != std::string::npos) {
     throw EnvoyException("SNI names containing NULL-byte are not allowed");
   }
+  if (config.has_session_cache() && max_session_keys_ > 0) {
+    session_cache_ = sessionCacheFromProto(config.session_cache());
+  }
   // TODO(PiotrSikora): Support multiple TLS certificates.
   if ((config.common_tls_context().tls_certificates().size() +
        config.common_tls_context().tls_certificate_sds_secret_configs().size()) > 1) {
@@ -415,6 +425,9 @@ ServerContextConfigImpl::ServerContextConfigImpl(
     session_timeout_ =
         std::chrono::seconds(DurationUtil::durationToSeconds(config.session_timeout()));
   }
+  if (config.has_session_cache()) {
+    session_cache_ = sessionCacheFromProto(config.session_cache());
+  }
 }
 
 void ServerContextConfigImpl::setSecretUpdateCallback(std::function<void()> callback) {
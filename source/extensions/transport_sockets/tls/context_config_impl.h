@@ -56,6 +56,8 @@ public:
   Ssl::HandshakerFactoryCb createHandshaker() const override;
   Ssl::HandshakerCapabilities capabilities() const override { return capabilities_; }
   Ssl::SslCtxCb sslctxCb() const override { return sslctx_cb_; }
+  bool kernelTlsOffload() const override { return kernel_tls_offload_; }
+  absl::optional<SessionCacheConfig> sessionCache() const override { return session_cache_; }
 
   Ssl::CertificateValidationContextConfigPtr getCombinedValidationContextConfig(
       const envoy::extensions::transport_sockets::tls::v3::CertificateValidationContext&
@@ -67,7 +69,12 @@ protected:
                     const unsigned default_max_protocol_version,
                     const std::string& default_cipher_suites, const std::string& default_curves,
                     Server::Configuration::TransportSocketFactoryContext& factory_context);
+  static absl::optional<SessionCacheConfig> sessionCacheFromProto(
+      const envoy::extensions::transport_sockets::tls::v3::TlsSessionCache& config);
+
   Api::Api& api_;
+  // Set by the client and server configs, whose protos hold the session cache settings.
+  absl::optional<SessionCacheConfig> session_cache_;
 
 private:
   static unsigned tlsVersionFromProto(
@@ -95,6 +102,7 @@ private:
   Envoy::Common::CallbackHandlePtr cvc_validation_callback_handle_;
   const unsigned min_protocol_version_;
   const unsigned max_protocol_version_;
+  const bool kernel_tls_offload_;
 
   Ssl::HandshakerFactoryCb handshaker_factory_cb_;
   Ssl::HandshakerCapabilities capabilities_;
@@ -28,6 +28,7 @@
 
 #include "absl/container/node_hash_set.h"
 #include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/str_join.h"
 #include "openssl/evp.h"
 #include "openssl/hmac.h"
@@ -76,7 +77,8 @@ ContextImpl::ContextImpl(Stats::Scope& scope, const Envoy::Ssl::ContextConfig& c
       ssl_ciphers_(stat_name_set_->add("ssl.ciphers")),
       ssl_versions_(stat_name_set_->add("ssl.versions")),
       ssl_curves_(stat_name_set_->add("ssl.curves")),
-      ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()) {
+      ssl_sigalgs_(stat_name_set_->add("ssl.sigalgs")), capabilities_(config.capabilities()),
+      kernel_tls_offload_(config.kernelTlsOffload()) {
 
   auto cert_validator_name = getCertValidatorName(config.certificateValidationContext());
   auto cert_validator_factory =
@@ -581,6 +583,10 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
   }
 
   if (max_session_keys_ > 0) {
+    if (config.sessionCache().has_value()) {
+      session_cache_ = std::make_unique<SessionCache>(config.sessionCache()->max_sessions_,
+                                                      config.sessionCache()->shards_);
+    }
     SSL_CTX_set_session_cache_mode(tls_contexts_[0].ssl_ctx_.get(), SSL_SESS_CACHE_CLIENT);
     SSL_CTX_sess_set_new_cb(
         tls_contexts_[0].ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
@@ -588,11 +594,23 @@ ClientContextImpl::ClientContextImpl(Stats::Scope& scope,
               static_cast<ContextImpl*>(SSL_CTX_get_app_data(SSL_get_SSL_CTX(ssl)));
           ClientContextImpl* client_context_impl = dynamic_cast<ClientContextImpl*>(context_impl);
           RELEASE_ASSERT(client_context_impl != nullptr, ""); // for Coverity
-          return client_context_impl->newSessionKey(session);
+          return client_context_impl->newSessionKey(ssl, session);
         });
   }
 }
 
+int ClientContextImpl::sessionCacheKeyIndex() {
+  CONSTRUCT_ON_FIRST_USE(int, []() -> int {
+    int index = SSL_get_ex_new_index(
+        0, nullptr, nullptr, nullptr,
+        [](void*, void* ptr, CRYPTO_EX_DATA*, int, long, void*) -> void {
+          delete static_cast<std::string*>(ptr);
+        });
+    RELEASE_ASSERT(index >= 0, "");
+    return index;
+  }());
+}
+
 bool ContextImpl::parseAndSetAlpn(const std::vector<std::string>& alpn, SSL& ssl) {
   std::vector<uint8_t> parsed_alpn = parseAlpnProtocols(absl::StrJoin(alpn, ","));
   if (!parsed_alpn.empty()) {
@@ -645,7 +663,7 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl(const Network::TransportSocketOpt
     SSL_set_renegotiate_mode(ssl_con.get(), ssl_renegotiate_freely);
   }
 
-  if (max_session_keys_ > 0) {
+  if (max_session_keys_ > 0 && session_cache_ == nullptr) {
     if (session_keys_single_use_) {
       // Stored single-use session keys, use write/write locks.
       absl::WriterMutexLock l(&session_keys_mu_);
@@ -674,7 +692,38 @@ bssl::UniquePtr<SSL> ClientContextImpl::newSsl(const Network::TransportSocketOpt
   return ssl_con;
 }
 
-int ClientContextImpl::newSessionKey(SSL_SESSION* session) {
+void ClientContextImpl::resumeSession(SSL* ssl, const Network::Address::Instance& remote_address) {
+  if (session_cache_ == nullptr) {
+    return;
+  }
+  // Sessions are specific to the server which issued them, which may serve several names.
+  const char* server_name = SSL_get_servername(ssl, TLSEXT_NAMETYPE_host_name);
+  auto* key = new std::string(
+      absl::StrCat(remote_address.asStringView(), "/", server_name != nullptr ? server_name : ""));
+  SSL_set_ex_data(ssl, sessionCacheKeyIndex(), key);
+
+  const uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                           time_source_.systemTime().time_since_epoch())
+                           .count();
+  bssl::UniquePtr<SSL_SESSION> session = session_cache_->lookup(*key, now);
+  if (session != nullptr) {
+    stats_.session_cache_hit_.inc();
+    SSL_set_session(ssl, session.get());
+  } else {
+    stats_.session_cache_miss_.inc();
+  }
+}
+
+int ClientContextImpl::newSessionKey(SSL* ssl, SSL_SESSION* session) {
+  if (session_cache_ != nullptr) {
+    const auto* key = static_cast<const std::string*>(SSL_get_ex_data(ssl, sessionCacheKeyIndex()));
+    if (key == nullptr) {
+      return 0;
+    }
+    session_cache_->insert(*key, bssl::UniquePtr<SSL_SESSION>(session));
+    return 1;
+  }
+
   // In case we ever store single-use session key (TLS 1.3),
   // we need to switch to using write/write locks.
   if (SSL_SESSION_should_be_single_use(session)) {
@@ -701,12 +750,27 @@ uint16_t ClientContextImpl::parseSigningAlgorithmsForTest(const std::string& sig
   return 0;
 }
 
+namespace {
+
+ServerContextImpl* serverContext(SSL_CTX* ssl_ctx) {
+  ContextImpl* context_impl = static_cast<ContextImpl*>(SSL_CTX_get_app_data(ssl_ctx));
+  ServerContextImpl* server_context_impl = dynamic_cast<ServerContextImpl*>(context_impl);
+  RELEASE_ASSERT(server_context_impl != nullptr, ""); // for Coverity
+  return server_context_impl;
+}
+
+} // namespace
+
 ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
                                      const Envoy::Ssl::ServerContextConfig& config,
                                      const std::vector<std::string>& server_names,
                                      TimeSource& time_source)
     : ContextImpl(scope, config, time_source), session_ticket_keys_(config.sessionTicketKeys()),
       ocsp_staple_policy_(config.ocspStaplePolicy()) {
+  if (config.sessionCache().has_value() && !config.capabilities().handles_session_resumption) {
+    session_cache_ = std::make_unique<SessionCache>(config.sessionCache()->max_sessions_,
+                                                    config.sessionCache()->shards_);
+  }
   if (config.tlsCertificates().empty() && !config.capabilities().provides_certificates) {
     throw EnvoyException("Server TlsCertificates must have a certificate specified");
   }
@@ -766,6 +830,26 @@ ServerContextImpl::ServerContextImpl(Stats::Scope& scope,
           });
     }
 
+    if (session_cache_ != nullptr) {
+      SSL_CTX_set_session_cache_mode(ctx.ssl_ctx_.get(),
+                                     SSL_SESS_CACHE_SERVER | SSL_SESS_CACHE_NO_INTERNAL);
+      SSL_CTX_sess_set_new_cb(ctx.ssl_ctx_.get(), [](SSL* ssl, SSL_SESSION* session) -> int {
+        return serverContext(SSL_get_SSL_CTX(ssl))->newSession(session);
+      });
+      SSL_CTX_sess_set_get_cb(
+          ctx.ssl_ctx_.get(),
+          [](SSL* ssl, const uint8_t* id, int id_len, int* out_copy) -> SSL_SESSION* {
+            // The returned reference is handed over to BoringSSL.
+            *out_copy = 0;
+            return serverContext(SSL_get_SSL_CTX(ssl))
+                ->getSession(absl::string_view(reinterpret_cast<const char*>(id), id_len))
+                .release();
+          });
+      SSL_CTX_sess_set_remove_cb(ctx.ssl_ctx_.get(), [](SSL_CTX* ssl_ctx, SSL_SESSION* session) {
+        serverContext(ssl_ctx)->removeSession(session);
+      });
+    }
+
     if (config.sessionTimeout() && !config.capabilities().handles_session_resumption) {
       auto timeout = config.sessionTimeout().value().count();
       SSL_CTX_set_timeout(ctx.ssl_ctx_.get(), uint32_t(timeout));
@@ -899,6 +983,36 @@ ServerContextImpl::generateHashForSessionContextId(const std::vector<std::string
   return session_id;
 }
 
+int ServerContextImpl::newSession(SSL_SESSION* session) {
+  unsigned int id_length;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_length);
+  if (id_length == 0) {
+    return 0;
+  }
+  session_cache_->insert(absl::string_view(reinterpret_cast<const char*>(id), id_length),
+                         bssl::UniquePtr<SSL_SESSION>(session));
+  return 1; // Tell BoringSSL that we took ownership of the session.
+}
+
+bssl::UniquePtr<SSL_SESSION> ServerContextImpl::getSession(absl::string_view session_id) {
+  const uint64_t now = std::chrono::duration_cast<std::chrono::seconds>(
+                           time_source_.systemTime().time_since_epoch())
+                           .count();
+  bssl::UniquePtr<SSL_SESSION> session = session_cache_->lookup(session_id, now);
+  if (session != nullptr) {
+    stats_.session_cache_hit_.inc();
+  } else {
+    stats_.session_cache_miss_.inc();
+  }
+  return session;
+}
+
+void ServerContextImpl::removeSession(SSL_SESSION* session) {
+  unsigned int id_length;
+  const uint8_t* id = SSL_SESSION_get_id(session, &id_length);
+  session_cache_->remove(absl::string_view(reinterpret_cast<const char*>(id), id_length));
+}
+
 int ServerContextImpl::sessionTicketProcess(SSL*, uint8_t* key_name, uint8_t* iv,
                                             EVP_CIPHER_CTX* ctx, HMAC_CTX* hmac_ctx, int encrypt) {
   const EVP_MD* hmac = EVP_sha256();
@@ -20,6 +20,7 @@
 #include "extensions/transport_sockets/tls/cert_validator/cert_validator.h"
 #include "extensions/transport_sockets/tls/context_manager_impl.h"
 #include "extensions/transport_sockets/tls/ocsp/ocsp.h"
+#include "extensions/transport_sockets/tls/session_cache.h"
 #include "extensions/transport_sockets/tls/stats.h"
 
 #include "absl/synchronization/mutex.h"
@@ -67,6 +68,20 @@ public:
 
   SslStats& stats() { return stats_; }
 
+  /**
+   * @return true if the record layer of connections using this context should be offloaded to the
+   * kernel once their handshake completes.
+   */
+  virtual bool kernelTlsOffload() const { return kernel_tls_offload_; }
+
+  /**
+   * Offers a session cached for the peer of a client connection for resumption. Called once the
+   * connection's remote address is known, before its handshake starts.
+   * @param ssl supplies the connection.
+   * @param remote_address supplies the address of the upstream host.
+   */
+  virtual void resumeSession(SSL*, const Network::Address::Instance&) {}
+
   /**
    * The global SSL-library index used for storing a pointer to the SslExtendedSocketInfo
    * class in the SSL instance, for retrieval in callbacks.
@@ -125,6 +140,7 @@ protected:
   const Stats::StatName ssl_curves_;
   const Stats::StatName ssl_sigalgs_;
   const Ssl::HandshakerCapabilities capabilities_;
+  const bool kernel_tls_offload_;
 };
 
 using ContextImplSharedPtr = std::shared_ptr<ContextImpl>;
@@ -135,9 +151,17 @@ public:
                     TimeSource& time_source);
 
   bssl::UniquePtr<SSL> newSsl(const Network::TransportSocketOptions* options) override;
+  // BoringSSL can't renegotiate a connection whose records are handled by the kernel.
+  bool kernelTlsOffload() const override {
+    return ContextImpl::kernelTlsOffload() && !allow_renegotiation_;
+  }
+  void resumeSession(SSL* ssl, const Network::Address::Instance& remote_address) override;
 
 private:
-  int newSessionKey(SSL_SESSION* session);
+  // The SSL-library index of the key of a connection's sessions in session_cache_.
+  static int sessionCacheKeyIndex();
+
+  int newSessionKey(SSL* ssl, SSL_SESSION* session);
   uint16_t parseSigningAlgorithmsForTest(const std::string& sigalgs);
 
   const std::string server_name_indication_;
@@ -146,6 +170,8 @@ private:
   absl::Mutex session_keys_mu_;
   std::deque<bssl::UniquePtr<SSL_SESSION>> session_keys_ ABSL_GUARDED_BY(session_keys_mu_);
   bool session_keys_single_use_{false};
+  // If set, replaces session_keys_ with sessions keyed by upstream host.
+  std::unique_ptr<SessionCache> session_cache_;
 };
 
 enum class OcspStapleAction { Staple, NoStaple, Fail, ClientNotCapable };
@@ -173,8 +199,14 @@ private:
 
   SessionContextID generateHashForSessionContextId(const std::vector<std::string>& server_names);
 
+  // Callbacks of the session ID cache, replacing BoringSSL's internal one.
+  int newSession(SSL_SESSION* session);
+  bssl::UniquePtr<SSL_SESSION> getSession(absl::string_view session_id);
+  void removeSession(SSL_SESSION* session);
+
   const std::vector<Envoy::Ssl::ServerContextConfig::SessionTicketKey> session_ticket_keys_;
   const Ssl::ServerContextConfig::OcspStaplePolicy ocsp_staple_policy_;
+  std::unique_ptr<SessionCache> session_cache_;
 };
 
 } // namespace Tls
@@ -0,0 +1,239 @@
+#include "extensions/transport_sockets/tls/kernel_tls.h"
+
+#include <cstring>
+#include <vector>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/common/assert.h"
+#include "common/network/io_socket_error_impl.h"
+
+#include "openssl/mem.h"
+#include "openssl/nid.h"
+
+#if defined(__linux__) && __has_include(<linux/tls.h>)
+#include <linux/tls.h>
+#include <netinet/tcp.h>
+#define ENVOY_KERNEL_TLS 1
+#else
+#define ENVOY_KERNEL_TLS 0
+#endif
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+#if ENVOY_KERNEL_TLS
+
+#ifndef TCP_ULP
+#define TCP_ULP 31
+#endif
+#ifndef SOL_TLS
+#define SOL_TLS 282
+#endif
+
+namespace {
+
+constexpr uint8_t RecordTypeAlert = 21;
+constexpr uint8_t AlertLevelWarning = 1;
+constexpr uint8_t AlertCloseNotify = 0;
+
+// The key and fixed IV sizes of the supported ciphers, from the TLS 1.2 key block.
+struct CipherSizes {
+  size_t key_size_;
+  size_t iv_size_;
+};
+
+bool cipherSizes(int cipher_nid, CipherSizes& sizes) {
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    sizes = {TLS_CIPHER_AES_GCM_128_KEY_SIZE, TLS_CIPHER_AES_GCM_128_SALT_SIZE};
+    return true;
+  case NID_aes_256_gcm:
+    sizes = {TLS_CIPHER_AES_GCM_256_KEY_SIZE, TLS_CIPHER_AES_GCM_256_SALT_SIZE};
+    return true;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  case NID_chacha20_poly1305:
+    sizes = {TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE};
+    return true;
+#endif
+  default:
+    return false;
+  }
+}
+
+union CryptoInfo {
+  tls12_crypto_info_aes_gcm_128 aes_gcm_128_;
+  tls12_crypto_info_aes_gcm_256 aes_gcm_256_;
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  tls12_crypto_info_chacha20_poly1305 chacha20_poly1305_;
+#endif
+};
+
+void writeSequence(uint64_t sequence, unsigned char* out) {
+  for (int i = 7; i >= 0; i--) {
+    out[i] = sequence & 0xff;
+    sequence >>= 8;
+  }
+}
+
+// Builds the kernel parameters of one direction of the connection and returns their size.
+// BoringSSL uses the record sequence number as the explicit part of the AES-GCM nonce, which the
+// kernel continues from the iv field.
+socklen_t buildCryptoInfo(int cipher_nid, const uint8_t* key, const uint8_t* iv,
+                          uint64_t sequence, CryptoInfo& info) {
+  memset(&info, 0, sizeof(info));
+  switch (cipher_nid) {
+  case NID_aes_128_gcm:
+    info.aes_gcm_128_.info.version = TLS_1_2_VERSION;
+    info.aes_gcm_128_.info.cipher_type = TLS_CIPHER_AES_GCM_128;
+    memcpy(info.aes_gcm_128_.key, key, TLS_CIPHER_AES_GCM_128_KEY_SIZE);
+    memcpy(info.aes_gcm_128_.salt, iv, TLS_CIPHER_AES_GCM_128_SALT_SIZE);
+    writeSequence(sequence, info.aes_gcm_128_.iv);
+    writeSequence(sequence, info.aes_gcm_128_.rec_seq);
+    return sizeof(info.aes_gcm_128_);
+  case NID_aes_256_gcm:
+    info.aes_gcm_256_.info.version = TLS_1_2_VERSION;
+    info.aes_gcm_256_.info.cipher_type = TLS_CIPHER_AES_GCM_256;
+    memcpy(info.aes_gcm_256_.key, key, TLS_CIPHER_AES_GCM_256_KEY_SIZE);
+    memcpy(info.aes_gcm_256_.salt, iv, TLS_CIPHER_AES_GCM_256_SALT_SIZE);
+    writeSequence(sequence, info.aes_gcm_256_.iv);
+    writeSequence(sequence, info.aes_gcm_256_.rec_seq);
+    return sizeof(info.aes_gcm_256_);
+#ifdef TLS_CIPHER_CHACHA20_POLY1305
+  case NID_chacha20_poly1305:
+    info.chacha20_poly1305_.info.version = TLS_1_2_VERSION;
+    info.chacha20_poly1305_.info.cipher_type = TLS_CIPHER_CHACHA20_POLY1305;
+    memcpy(info.chacha20_poly1305_.key, key, TLS_CIPHER_CHACHA20_POLY1305_KEY_SIZE);
+    memcpy(info.chacha20_poly1305_.iv, iv, TLS_CIPHER_CHACHA20_POLY1305_IV_SIZE);
+    writeSequence(sequence, info.chacha20_poly1305_.rec_seq);
+    return sizeof(info.chacha20_poly1305_);
+#endif
+  default:
+    NOT_REACHED_GCOVR_EXCL_LINE;
+  }
+}
+
+} // namespace
+
+bool KernelTls::isSupported(const SSL* ssl) {
+  const SSL_CIPHER* cipher = SSL_get_current_cipher(ssl);
+  CipherSizes sizes;
+  return SSL_version(ssl) == TLS1_2_VERSION && cipher != nullptr &&
+         cipherSizes(SSL_CIPHER_get_cipher_nid(cipher), sizes) &&
+         static_cast<size_t>(SSL_get_key_block_len(ssl)) == 2 * (sizes.key_size_ + sizes.iv_size_);
+}
+
+KernelTls::Offload KernelTls::enable(SSL* ssl, Network::IoHandle& io_handle, bool rx) {
+  ASSERT(isSupported(ssl));
+  Offload offload;
+  const int cipher_nid = SSL_CIPHER_get_cipher_nid(SSL_get_current_cipher(ssl));
+  CipherSizes sizes;
+  cipherSizes(cipher_nid, sizes);
+
+  // With AEAD ciphers the key block holds the client and server write keys, followed by the client
+  // and server fixed IVs.
+  std::vector<uint8_t> key_block(SSL_get_key_block_len(ssl));
+  if (!SSL_generate_key_block(ssl, key_block.data(), key_block.size())) {
+    return offload;
+  }
+  const uint8_t* client_key = key_block.data();
+  const uint8_t* server_key = client_key + sizes.key_size_;
+  const uint8_t* client_iv = server_key + sizes.key_size_;
+  const uint8_t* server_iv = client_iv + sizes.iv_size_;
+  const bool is_server = SSL_is_server(ssl);
+
+  static constexpr char Ulp[] = "tls";
+  if (io_handle.setOption(IPPROTO_TCP, TCP_ULP, Ulp, sizeof(Ulp)).rc_ != 0) {
+    // The tls module isn't loaded or the kernel predates kTLS.
+    OPENSSL_cleanse(key_block.data(), key_block.size());
+    return offload;
+  }
+
+  CryptoInfo info;
+  socklen_t info_size = buildCryptoInfo(cipher_nid, is_server ? server_key : client_key,
+                                        is_server ? server_iv : client_iv,
+                                        SSL_get_write_sequence(ssl), info);
+  offload.tx_ = io_handle.setOption(SOL_TLS, TLS_TX, &info, info_size).rc_ == 0;
+  if (offload.tx_ && rx) {
+    info_size = buildCryptoInfo(cipher_nid, is_server ? client_key : server_key,
+                                is_server ? client_iv : server_iv, SSL_get_read_sequence(ssl),
+                                info);
+    // Receive offload needs Linux 4.17, and ChaCha20-Poly1305 needs Linux 5.11.
+    offload.rx_ = io_handle.setOption(SOL_TLS, TLS_RX, &info, info_size).rc_ == 0;
+  }
+  OPENSSL_cleanse(&info, sizeof(info));
+  OPENSSL_cleanse(key_block.data(), key_block.size());
+  return offload;
+}
+
+KernelTls::ControlRecord KernelTls::readControlRecord(Network::IoHandle& io_handle) {
+  uint8_t data[2];
+  iovec iov{data, sizeof(data)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().recvmsg(io_handle.fdDoNotUse(), &message, 0);
+  if (result.rc_ < 0) {
+    return result.errno_ == SOCKET_ERROR_AGAIN ? ControlRecord::Again : ControlRecord::Error;
+  }
+  const cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  // Renegotiation and any alert other than close_notify end the connection.
+  if (cmsg == nullptr || cmsg->cmsg_level != SOL_TLS || cmsg->cmsg_type != TLS_GET_RECORD_TYPE ||
+      *CMSG_DATA(cmsg) != RecordTypeAlert || static_cast<size_t>(result.rc_) != sizeof(data) ||
+      data[1] != AlertCloseNotify) {
+    return ControlRecord::Error;
+  }
+  return ControlRecord::CloseNotify;
+}
+
+Api::IoCallUint64Result KernelTls::sendCloseNotify(Network::IoHandle& io_handle) {
+  uint8_t data[] = {AlertLevelWarning, AlertCloseNotify};
+  iovec iov{data, sizeof(data)};
+  alignas(cmsghdr) char control[CMSG_SPACE(sizeof(uint8_t))];
+  msghdr message{};
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+  cmsg->cmsg_level = SOL_TLS;
+  cmsg->cmsg_type = TLS_SET_RECORD_TYPE;
+  cmsg->cmsg_len = CMSG_LEN(sizeof(uint8_t));
+  *CMSG_DATA(cmsg) = RecordTypeAlert;
+
+  const Api::SysCallSizeResult result =
+      Api::OsSysCallsSingleton::get().sendmsg(io_handle.fdDoNotUse(), &message, 0);
+  if (result.rc_ < 0) {
+    return {0, Api::IoErrorPtr(new Network::IoSocketError(result.errno_),
+                               Network::IoSocketError::deleteIoError)};
+  }
+  return {static_cast<uint64_t>(result.rc_),
+          Api::IoErrorPtr(nullptr, Network::IoSocketError::deleteIoError)};
+}
+
+#else
+bool KernelTls::isSupported(const SSL*) { return false; }
+
+KernelTls::Offload KernelTls::enable(SSL*, Network::IoHandle&, bool) {
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+KernelTls::ControlRecord KernelTls::readControlRecord(Network::IoHandle&) {
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+
+Api::IoCallUint64Result KernelTls::sendCloseNotify(Network::IoHandle&) {
+  NOT_REACHED_GCOVR_EXCL_LINE;
+}
+#endif
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
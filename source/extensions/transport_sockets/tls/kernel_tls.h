@@ -0,0 +1,73 @@
+#pragma once
+
+#include "envoy/api/io_error.h"
+#include "envoy/network/io_handle.h"
+
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * Offloads the record layer of an established TLS connection to the kernel (kTLS). Once the
+ * session keys are handed to the kernel, plaintext is written to and read from the socket directly
+ * and BoringSSL must no longer read or write records on the connection.
+ *
+ * Only TLS 1.2 connections using AES-GCM or ChaCha20-Poly1305 can be offloaded, as BoringSSL
+ * doesn't export the traffic keys of TLS 1.3 connections.
+ */
+class KernelTls {
+public:
+  // The directions of a connection handled by the kernel.
+  struct Offload {
+    bool tx_{};
+    bool rx_{};
+  };
+
+  // The outcome of reading a record other than application data.
+  enum class ControlRecord {
+    // The peer sent a close_notify alert.
+    CloseNotify,
+    // No record could be read yet.
+    Again,
+    // Any other record or error, after which the connection can't be used.
+    Error,
+  };
+
+  /**
+   * @param ssl supplies a connection which completed its handshake.
+   * @return bool whether the negotiated protocol version and cipher can be offloaded.
+   */
+  static bool isSupported(const SSL* ssl);
+
+  /**
+   * Hands the session keys of a connection to the kernel. Nothing may be buffered in BoringSSL's
+   * write path, and if rx is set, nothing may be buffered in its read path.
+   * @param ssl supplies a connection for which isSupported() returned true.
+   * @param io_handle supplies the TCP socket of the connection.
+   * @param rx supplies whether to offload the receive direction as well as the transmit one.
+   * @return Offload the directions which were offloaded. Nothing is offloaded if the kernel lacks
+   *         kTLS support, and only transmission is if the kernel can't offload reception.
+   */
+  static Offload enable(SSL* ssl, Network::IoHandle& io_handle, bool rx);
+
+  /**
+   * Reads the next record if it isn't application data, which read() fails on once the receive
+   * direction is offloaded.
+   * @param io_handle supplies a socket with an offloaded receive direction.
+   */
+  static ControlRecord readControlRecord(Network::IoHandle& io_handle);
+
+  /**
+   * Sends a close_notify alert through the kernel.
+   * @param io_handle supplies a socket with an offloaded transmit direction.
+   */
+  static Api::IoCallUint64Result sendCloseNotify(Network::IoHandle& io_handle);
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
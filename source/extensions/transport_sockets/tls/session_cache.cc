@@ -0,0 +1,88 @@
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "common/common/assert.h"
+
+#include "absl/hash/hash.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+SessionCache::SessionCache(uint32_t max_sessions, uint32_t shards)
+    : max_sessions_per_shard_(std::max<uint32_t>(1, (max_sessions + shards - 1) / shards)),
+      shards_(shards) {
+  ASSERT(shards > 0);
+}
+
+SessionCache::Shard& SessionCache::shard(absl::string_view key) {
+  return shards_[absl::Hash<absl::string_view>()(key) % shards_.size()];
+}
+
+void SessionCache::erase(Shard& shard, EntryList::iterator it) {
+  shard.index_.erase(it->key_);
+  shard.lru_.erase(it);
+}
+
+void SessionCache::insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto existing = shard.index_.find(key);
+  if (existing != shard.index_.end()) {
+    erase(shard, existing->second);
+  }
+  while (shard.lru_.size() >= max_sessions_per_shard_) {
+    erase(shard, std::prev(shard.lru_.end()));
+  }
+  shard.lru_.push_front(Entry{std::string(key), std::move(session)});
+  // The index refers to the key owned by the entry, which doesn't move within the list.
+  shard.index_.emplace(shard.lru_.front().key_, shard.lru_.begin());
+}
+
+bssl::UniquePtr<SSL_SESSION> SessionCache::lookup(absl::string_view key, uint64_t now) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it == shard.index_.end()) {
+    return nullptr;
+  }
+  EntryList::iterator entry = it->second;
+  SSL_SESSION* session = entry->session_.get();
+  if (SSL_SESSION_get_time(session) + SSL_SESSION_get_timeout(session) <= now) {
+    erase(shard, entry);
+    return nullptr;
+  }
+  if (SSL_SESSION_should_be_single_use(session)) {
+    bssl::UniquePtr<SSL_SESSION> result = std::move(entry->session_);
+    erase(shard, entry);
+    return result;
+  }
+  shard.lru_.splice(shard.lru_.begin(), shard.lru_, entry);
+  return bssl::UpRef(session);
+}
+
+void SessionCache::remove(absl::string_view key) {
+  Shard& shard = this->shard(key);
+  absl::MutexLock lock(&shard.mutex_);
+  auto it = shard.index_.find(key);
+  if (it != shard.index_.end()) {
+    erase(shard, it->second);
+  }
+}
+
+size_t SessionCache::size() {
+  size_t size = 0;
+  for (Shard& shard : shards_) {
+    absl::MutexLock lock(&shard.mutex_);
+    size += shard.lru_.size();
+  }
+  return size;
+}
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "common/common/non_copyable.h"
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+
+/**
+ * A bounded cache of TLS sessions, shared by the connections of a context on all workers. The
+ * cache is split into shards with their own lock and LRU list, so that concurrent handshakes on
+ * different workers rarely contend. Server contexts key sessions by session ID, client contexts by
+ * the upstream host they were established with.
+ */
+class SessionCache : NonCopyable {
+public:
+  /**
+   * @param max_sessions supplies the number of sessions after which the least recently used ones
+   *        are evicted. It is spread evenly across the shards.
+   * @param shards supplies the number of shards, at least one.
+   */
+  SessionCache(uint32_t max_sessions, uint32_t shards);
+
+  /**
+   * Stores a session, replacing any other session of the key.
+   */
+  void insert(absl::string_view key, bssl::UniquePtr<SSL_SESSION> session);
+
+  /**
+   * @param key supplies the key of the session.
+   * @param now supplies the current time in seconds since the epoch. Expired sessions are removed
+   *        rather than returned.
+   * @return a reference to the session of the key, or nullptr if there is none. Sessions which
+   *         must only be used once, e.g. TLS 1.3 client sessions, are removed from the cache.
+   */
+  bssl::UniquePtr<SSL_SESSION> lookup(absl::string_view key, uint64_t now);
+
+  /**
+   * Removes the session of the key, if any.
+   */
+  void remove(absl::string_view key);
+
+  /**
+   * @return the number of cached sessions.
+   */
+  size_t size();
+
+private:
+  struct Entry {
+    std::string key_;
+    bssl::UniquePtr<SSL_SESSION> session_;
+  };
+  using EntryList = std::list<Entry>;
+
+  struct Shard {
+    absl::Mutex mutex_;
+    // Most recently used first.
+    EntryList lru_ ABSL_GUARDED_BY(mutex_);
+    absl::flat_hash_map<absl::string_view, EntryList::iterator> index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  Shard& shard(absl::string_view key);
+  static void erase(Shard& shard, EntryList::iterator it)
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(shard.mutex_);
+
+  const uint32_t max_sessions_per_shard_;
+  std::vector<Shard> shards_;
+};
+
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -9,6 +9,7 @@
 #include "common/runtime/runtime_features.h"
 
 #include "extensions/transport_sockets/tls/io_handle_bio.h"
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 #include "extensions/transport_sockets/tls/ssl_handshaker.h"
 #include "extensions/transport_sockets/tls/utility.h"
 
@@ -72,6 +73,10 @@ void SslSocket::setTransportSocketCallbacks(Network::TransportSocketCallbacks& c
     provider->registerPrivateKeyMethod(rawSsl(), *this, callbacks_->connection().dispatcher());
   }
 
+  if (!SSL_is_server(rawSsl())) {
+    ctx_->resumeSession(rawSsl(), *callbacks_->connection().addressProvider().remoteAddress());
+  }
+
   BIO* bio;
   if (Runtime::runtimeFeatureEnabled("envoy.reloadable_features.tls_use_io_handle_bio")) {
     // Use custom BIO that reads from/writes to IoHandle
@@ -114,6 +119,9 @@ Network::IoResult SslSocket::doRead(Buffer::Instance& read_buffer) {
       return {action, 0, false};
     }
   }
+  if (kernel_tls_rx_) {
+    return doKernelTlsRead(read_buffer);
+  }
 
   bool keep_reading = true;
   bool end_stream = false;
@@ -186,9 +194,79 @@ Network::Connection& SslSocket::connection() const { return callbacks_->connecti
 
 void SslSocket::onSuccess(SSL* ssl) {
   ctx_->logHandshake(ssl);
+  // This must happen before the connected event, which may write data.
+  enableKernelTls();
   callbacks_->raiseEvent(Network::ConnectionEvent::Connected);
 }
 
+void SslSocket::enableKernelTls() {
+  if (!ctx_->kernelTlsOffload()) {
+    return;
+  }
+  if (!KernelTls::isSupported(rawSsl())) {
+    ctx_->stats().ktls_unsupported_.inc();
+    return;
+  }
+  // Records which BoringSSL read along with the end of the handshake can only be decrypted by it,
+  // so the receive direction stays in user space if there are any.
+  const KernelTls::Offload offload =
+      KernelTls::enable(rawSsl(), callbacks_->ioHandle(), !SSL_has_pending(rawSsl()));
+  ENVOY_CONN_LOG(debug, "kernel TLS offload: tx={} rx={}", callbacks_->connection(), offload.tx_,
+                 offload.rx_);
+  if (offload.tx_) {
+    kernel_tls_tx_ = true;
+    ctx_->stats().ktls_tx_offloaded_.inc();
+  }
+  if (offload.rx_) {
+    kernel_tls_rx_ = true;
+    ctx_->stats().ktls_rx_offloaded_.inc();
+  }
+}
+
+Network::IoResult SslSocket::doKernelTlsRead(Buffer::Instance& read_buffer) {
+  PostIoAction action = PostIoAction::KeepOpen;
+  uint64_t bytes_read = 0;
+  bool end_stream = false;
+  while (true) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().read(read_buffer, absl::nullopt);
+    if (result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls read returns: {}", callbacks_->connection(), result.rc_);
+      if (result.rc_ == 0) {
+        // Non-graceful shutdown by closing the underlying socket.
+        end_stream = true;
+        break;
+      }
+      bytes_read += result.rc_;
+      if (callbacks_->shouldDrainReadBuffer()) {
+        callbacks_->setTransportSocketIsReadable();
+        break;
+      }
+      continue;
+    }
+    if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+      break;
+    }
+    // read() fails on records other than application data, which have to be read separately.
+    switch (KernelTls::readControlRecord(callbacks_->ioHandle())) {
+    case KernelTls::ControlRecord::CloseNotify:
+      end_stream = true;
+      break;
+    case KernelTls::ControlRecord::Again:
+      break;
+    case KernelTls::ControlRecord::Error:
+      ENVOY_CONN_LOG(debug, "ktls read error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      ctx_->stats().connection_error_.inc();
+      action = PostIoAction::Close;
+      break;
+    }
+    break;
+  }
+
+  ENVOY_CONN_LOG(trace, "ktls read {} bytes", callbacks_->connection(), bytes_read);
+  return {action, bytes_read, end_stream};
+}
+
 void SslSocket::onFailure() { drainErrorQueue(); }
 
 PostIoAction SslSocket::doHandshake() { return info_->doHandshake(); }
@@ -231,6 +309,9 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
       return {action, 0, false};
     }
   }
+  if (kernel_tls_tx_) {
+    return doKernelTlsWrite(write_buffer, end_stream);
+  }
 
   uint64_t bytes_to_write;
   if (bytes_to_retry_) {
@@ -282,6 +363,30 @@ Network::IoResult SslSocket::doWrite(Buffer::Instance& write_buffer, bool end_st
   return {PostIoAction::KeepOpen, total_bytes_written, false};
 }
 
+Network::IoResult SslSocket::doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream) {
+  // The kernel splits the data into records, so the buffer is written without linearizing it.
+  uint64_t total_bytes_written = 0;
+  while (write_buffer.length() > 0) {
+    Api::IoCallUint64Result result = callbacks_->ioHandle().write(write_buffer);
+    if (!result.ok()) {
+      ENVOY_CONN_LOG(trace, "ktls write error: {}", callbacks_->connection(),
+                     result.err_->getErrorDetails());
+      if (result.err_->getErrorCode() == Api::IoError::IoErrorCode::Again) {
+        break;
+      }
+      return {PostIoAction::Close, total_bytes_written, false};
+    }
+    ENVOY_CONN_LOG(trace, "ktls write returns: {}", callbacks_->connection(), result.rc_);
+    total_bytes_written += result.rc_;
+  }
+
+  if (write_buffer.length() == 0 && end_stream) {
+    shutdownSsl();
+  }
+
+  return {PostIoAction::KeepOpen, total_bytes_written, false};
+}
+
 void SslSocket::onConnected() { ASSERT(info_->state() == Ssl::SocketState::PreHandshake); }
 
 Ssl::ConnectionInfoConstSharedPtr SslSocket::ssl() const { return info_; }
@@ -290,6 +395,13 @@ void SslSocket::shutdownSsl() {
   ASSERT(info_->state() != Ssl::SocketState::PreHandshake);
   if (info_->state() != Ssl::SocketState::ShutdownSent &&
       callbacks_->connection().state() != Network::Connection::State::Closed) {
+    if (kernel_tls_tx_) {
+      // BoringSSL's record state is stale, so the close_notify alert is sent by the kernel.
+      const Api::IoCallUint64Result result = KernelTls::sendCloseNotify(callbacks_->ioHandle());
+      ENVOY_CONN_LOG(debug, "kTLS shutdown: rc={}", callbacks_->connection(), result.rc_);
+      info_->setState(Ssl::SocketState::ShutdownSent);
+      return;
+    }
     int rc = SSL_shutdown(rawSsl());
     if constexpr (Event::PlatformDefaultTriggerType == Event::FileTriggerType::EmulatedEdge) {
       // Windows operate under `EmulatedEdge`. These are level events that are artificially
@@ -83,6 +83,12 @@ private:
   };
   ReadResult sslReadIntoSlice(Buffer::RawSlice& slice);
 
+  // Offloads the record layer to the kernel once the handshake completes, if configured.
+  void enableKernelTls();
+  // Read and write paths once the kernel handles the records of the connection.
+  Network::IoResult doKernelTlsRead(Buffer::Instance& read_buffer);
+  Network::IoResult doKernelTlsWrite(Buffer::Instance& write_buffer, bool end_stream);
+
   Network::PostIoAction doHandshake();
   void drainErrorQueue();
   void shutdownSsl();
@@ -96,6 +102,10 @@ private:
   ContextImplSharedPtr ctx_;
   uint64_t bytes_to_retry_{};
   std::string failure_reason_;
+  // Set once the kernel encrypts or decrypts the records of the connection, after which BoringSSL
+  // must not handle them in that direction.
+  bool kernel_tls_tx_{};
+  bool kernel_tls_rx_{};
 
   SslHandshakerImplSharedPtr info_;
 };
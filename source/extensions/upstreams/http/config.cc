@@ -72,6 +72,10 @@ uint64_t ProtocolOptionsConfigImpl::parseFeatures(const envoy::config::cluster::
   if (options.use_alpn_) {
     features |= Upstream::ClusterInfo::Features::USE_ALPN;
   }
+  if (options.shared_http2_connection_pool_ &&
+      !config.connection_pool_per_downstream_connection()) {
+    features |= Upstream::ClusterInfo::Features::SHARED_HTTP2_CONNECTION_POOL;
+  }
   if (config.close_connections_on_host_health_failure()) {
     features |= Upstream::ClusterInfo::Features::CLOSE_CONNECTIONS_ON_HOST_HEALTH_FAILURE;
   }
@@ -88,7 +92,8 @@ ProtocolOptionsConfigImpl::ProtocolOptionsConfigImpl(
           options.has_upstream_http_protocol_options()
               ? absl::make_optional<envoy::config::core::v3::UpstreamHttpProtocolOptions>(
                     options.upstream_http_protocol_options())
-              : absl::nullopt) {
+              : absl::nullopt),
+      shared_http2_connection_pool_(options.shared_http2_connection_pool()) {
   if (http3_options_.has_value()) {
     use_http3_ = true;
   }
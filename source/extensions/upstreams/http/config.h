@@ -50,6 +50,7 @@ public:
   bool use_http2_{};
   bool use_http3_{};
   bool use_alpn_{};
+  bool shared_http2_connection_pool_{};
 };
 
 class ProtocolOptionsConfigFactory : public Server::Configuration::ProtocolOptionsFactory {
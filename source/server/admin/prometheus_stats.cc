@@ -1,17 +1,23 @@
 #include "server/admin/prometheus_stats.h"
 
-#include "common/common/empty_string.h"
+#include <iterator>
+
 #include "common/common/macros.h"
 #include "common/stats/histogram_impl.h"
+#include "common/stats/symbol_table_impl.h"
+
+#include "server/admin/utils.h"
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
 
 namespace Envoy {
 namespace Server {
 
 namespace {
 
-const std::regex& promRegex() { CONSTRUCT_ON_FIRST_USE(std::regex, "[^a-zA-Z0-9_]"); }
 const std::regex& namespaceRegex() {
   CONSTRUCT_ON_FIRST_USE(std::regex, "^[a-zA-Z_][a-zA-Z0-9]*$");
 }
@@ -19,11 +25,17 @@ const std::regex& namespaceRegex() {
 /**
  * Take a string and sanitize it according to Prometheus conventions.
  */
-std::string sanitizeName(const std::string& name) {
+std::string sanitizeName(absl::string_view name) {
   // The name must match the regex [a-zA-Z_][a-zA-Z0-9_]* as required by
   // prometheus. Refer to https://prometheus.io/docs/concepts/data_model/.
   // The initial [a-zA-Z_] constraint is always satisfied by the namespace prefix.
-  return std::regex_replace(name, promRegex(), "_");
+  std::string sanitized(name);
+  for (char& c : sanitized) {
+    if (!absl::ascii_isalnum(c) && c != '_') {
+      c = '_';
+    }
+  }
+  return sanitized;
 }
 
 /*
@@ -48,25 +60,73 @@ struct MetricLessThan {
   }
 };
 
+/**
+ * Formats the tags of metrics, caching the formatted tag for each tag name and value. Many
+ * metrics share tags, e.g. the name of a cluster, so this decodes and sanitizes each of them once
+ * rather than once per metric.
+ */
+class TagFormatter {
+public:
+  explicit TagFormatter(const Stats::SymbolTable& symbol_table) : symbol_table_(symbol_table) {}
+
+  /**
+   * Appends the tags of the metric as a comma-separated list of <tag_name>="<tag_value>" pairs.
+   */
+  void appendTags(const Stats::Metric& metric, std::string& out) {
+    bool first = true;
+    metric.iterateTagStatNames([this, &out, &first](Stats::StatName name, Stats::StatName value) {
+      if (!first) {
+        out.push_back(',');
+      }
+      first = false;
+      out.append(formattedTag(name, value));
+      return true;
+    });
+  }
+
+private:
+  const std::string& formattedTag(Stats::StatName name, Stats::StatName value) {
+    const auto key = std::make_pair(name, value);
+    auto it = formatted_tags_.find(key);
+    if (it != formatted_tags_.end()) {
+      return it->second;
+    }
+    auto name_it = sanitized_names_.find(name);
+    if (name_it == sanitized_names_.end()) {
+      name_it = sanitized_names_.emplace(name, sanitizeName(symbol_table_.toString(name))).first;
+    }
+    return formatted_tags_
+        .emplace(key, absl::StrCat(name_it->second, "=\"", symbol_table_.toString(value), "\""))
+        .first->second;
+  }
+
+  const Stats::SymbolTable& symbol_table_;
+  Stats::StatNameHashMap<std::string> sanitized_names_;
+  absl::flat_hash_map<std::pair<Stats::StatName, Stats::StatName>, std::string> formatted_tags_;
+};
+
 /**
  * Processes a stat type (counter, gauge, histogram) by generating all output lines, sorting
  * them by tag-extracted metric name, and then outputting them in the correct sorted order into
  * response.
  *
- * @param response The buffer to put the output into.
+ * @param writer The writer to put the output into.
  * @param used_only Whether to only output stats that are used.
  * @param regex A filter on which stats to output.
  * @param metrics The metrics to output stats for. This must contain all stats of the given type
  *        to be included in the same output.
- * @param generate_output A function which returns the output text for this metric.
+ * @param generate_output A function which writes the output text for this metric, given its
+ *        formatted tags.
  * @param type The name of the prometheus metric type for used in TYPE annotations.
  */
 template <class StatType>
 uint64_t outputStatType(
-    Buffer::Instance& response, const bool used_only, const absl::optional<std::regex>& regex,
+    Utility::PagedResponseWriter& writer, const bool used_only,
+    const absl::optional<std::regex>& regex,
     const std::vector<Stats::RefcountPtr<StatType>>& metrics,
-    const std::function<std::string(
-        const StatType& metric, const std::string& prefixed_tag_extracted_name)>& generate_output,
+    const std::function<void(const StatType& metric, const std::string& prefixed_tag_extracted_name,
+                             const std::string& tags, Utility::PagedResponseWriter& writer)>&
+        generate_output,
     absl::string_view type) {
 
   /*
@@ -112,10 +172,12 @@ uint64_t outputStatType(
     groups[metric->tagExtractedStatName()].push_back(metric.get());
   }
 
+  TagFormatter tag_formatter(global_symbol_table);
+  std::string tags;
   for (auto& group : groups) {
     const std::string prefixed_tag_extracted_name =
         PrometheusStatsFormatter::metricName(global_symbol_table.toString(group.first));
-    response.add(fmt::format("# TYPE {0} {1}\n", prefixed_tag_extracted_name, type));
+    writer.append("# TYPE ", prefixed_tag_extracted_name, " ", type, "\n");
 
     // Sort before producing the final output to satisfy the "preferred" ordering from the
     // prometheus spec: metrics will be sorted by their tags' textual representation, which will
@@ -123,37 +185,37 @@ uint64_t outputStatType(
     std::sort(group.second.begin(), group.second.end(), MetricLessThan());
 
     for (const auto& metric : group.second) {
-      response.add(generate_output(*metric, prefixed_tag_extracted_name));
+      tags.clear();
+      tag_formatter.appendTags(*metric, tags);
+      generate_output(*metric, prefixed_tag_extracted_name, tags, writer);
     }
-    response.add("\n");
+    writer.append("\n");
   }
   return groups.size();
 }
 
 /*
- * Return the prometheus output for a numeric Stat (Counter or Gauge).
+ * Writes the prometheus output for a numeric Stat (Counter or Gauge).
  */
 template <class StatType>
-std::string generateNumericOutput(const StatType& metric,
-                                  const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(metric.tags());
-  return fmt::format("{0}{{{1}}} {2}\n", prefixed_tag_extracted_name, tags, metric.value());
+void generateNumericOutput(const StatType& metric, const std::string& prefixed_tag_extracted_name,
+                           const std::string& tags, Utility::PagedResponseWriter& writer) {
+  writer.append(prefixed_tag_extracted_name, "{", tags, "} ", metric.value(), "\n");
 }
 
 /*
- * Returns the prometheus output for a histogram. The output is a multi-line string (with embedded
- * newlines) that contains all the individual bucket counts and sum/count for a single histogram
- * (metric_name plus all tags).
+ * Writes the prometheus output for a histogram. The output is multiple lines that contain all the
+ * individual bucket counts and sum/count for a single histogram (metric_name plus all tags).
  */
-std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
-                                    const std::string& prefixed_tag_extracted_name) {
-  const std::string tags = PrometheusStatsFormatter::formattedTags(histogram.tags());
-  const std::string hist_tags = histogram.tags().empty() ? EMPTY_STRING : (tags + ",");
+void generateHistogramOutput(const Stats::ParentHistogram& histogram,
+                             const std::string& prefixed_tag_extracted_name,
+                             const std::string& tags, Utility::PagedResponseWriter& writer) {
+  const absl::string_view hist_tags_separator = tags.empty() ? "" : ",";
 
   const Stats::HistogramStatistics& stats = histogram.cumulativeStatistics();
   Stats::ConstSupportedBuckets& supported_buckets = stats.supportedBuckets();
   const std::vector<uint64_t>& computed_buckets = stats.computedBuckets();
-  std::string output;
+  auto out = std::back_inserter(writer.page());
   for (size_t i = 0; i < supported_buckets.size(); ++i) {
     double bucket = supported_buckets[i];
     uint64_t value = computed_buckets[i];
@@ -162,18 +224,17 @@ std::string generateHistogramOutput(const Stats::ParentHistogram& histogram,
     // 'g' operator which prints the number in general fixed point format or scientific format
     // with precision 50 to round the number up to 32 significant digits in fixed point format
     // which should cover pretty much all cases
-    output.append(fmt::format("{0}_bucket{{{1}le=\"{2:.32g}\"}} {3}\n", prefixed_tag_extracted_name,
-                              hist_tags, bucket, value));
+    fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"{3:.32g}\"}} {4}\n", prefixed_tag_extracted_name,
+                   tags, hist_tags_separator, bucket, value);
   }
 
-  output.append(fmt::format("{0}_bucket{{{1}le=\"+Inf\"}} {2}\n", prefixed_tag_extracted_name,
-                            hist_tags, stats.sampleCount()));
-  output.append(fmt::format("{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleSum()));
-  output.append(fmt::format("{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
-                            stats.sampleCount()));
-
-  return output;
+  fmt::format_to(out, "{0}_bucket{{{1}{2}le=\"+Inf\"}} {3}\n", prefixed_tag_extracted_name, tags,
+                 hist_tags_separator, stats.sampleCount());
+  fmt::format_to(out, "{0}_sum{{{1}}} {2:.32g}\n", prefixed_tag_extracted_name, tags,
+                 stats.sampleSum());
+  fmt::format_to(out, "{0}_count{{{1}}} {2}\n", prefixed_tag_extracted_name, tags,
+                 stats.sampleCount());
+  writer.pageUpdated();
 };
 
 absl::flat_hash_set<std::string>& prometheusNamespaces() {
@@ -214,15 +275,16 @@ uint64_t PrometheusStatsFormatter::statsAsPrometheus(
     const std::vector<Stats::ParentHistogramSharedPtr>& histograms, Buffer::Instance& response,
     const bool used_only, const absl::optional<std::regex>& regex) {
 
+  Utility::PagedResponseWriter writer(response);
   uint64_t metric_name_count = 0;
   metric_name_count += outputStatType<Stats::Counter>(
-      response, used_only, regex, counters, generateNumericOutput<Stats::Counter>, "counter");
+      writer, used_only, regex, counters, generateNumericOutput<Stats::Counter>, "counter");
 
-  metric_name_count += outputStatType<Stats::Gauge>(response, used_only, regex, gauges,
+  metric_name_count += outputStatType<Stats::Gauge>(writer, used_only, regex, gauges,
                                                     generateNumericOutput<Stats::Gauge>, "gauge");
 
   metric_name_count += outputStatType<Stats::ParentHistogram>(
-      response, used_only, regex, histograms, generateHistogramOutput, "histogram");
+      writer, used_only, regex, histograms, generateHistogramOutput, "histogram");
 
   return metric_name_count;
 }
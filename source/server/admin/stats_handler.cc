@@ -1,5 +1,9 @@
 #include "server/admin/stats_handler.h"
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 #include "envoy/admin/v3/mutex_stats.pb.h"
 
 #include "common/common/empty_string.h"
@@ -15,6 +19,20 @@ namespace Server {
 
 const uint64_t RecentLookupsCapacity = 100;
 
+namespace {
+
+// Sorts stats by name. As when inserting them into a map, the first stat with a name wins.
+template <class Value>
+void sortAndRemoveDuplicates(std::vector<std::pair<std::string, Value>>& stats) {
+  std::stable_sort(stats.begin(), stats.end(),
+                   [](const auto& a, const auto& b) { return a.first < b.first; });
+  stats.erase(std::unique(stats.begin(), stats.end(),
+                          [](const auto& a, const auto& b) { return a.first == b.first; }),
+              stats.end());
+}
+
+} // namespace
+
 StatsHandler::StatsHandler(Server::Instance& server) : HandlerContextBase(server) {}
 
 Http::Code StatsHandler::handlerResetCounters(absl::string_view, Http::ResponseHeaderMap&,
@@ -84,32 +102,36 @@ Http::Code StatsHandler::handlerStats(absl::string_view url,
     return Http::Code::BadRequest;
   }
 
-  std::map<std::string, uint64_t> all_stats;
+  // The names are rendered once, into a vector rather than a map to save a node per stat, and
+  // the output is written directly to the response in pages.
+  std::vector<std::pair<std::string, uint64_t>> all_stats;
   for (const Stats::CounterSharedPtr& counter : server_.stats().counters()) {
     if (shouldShowMetric(*counter, used_only, regex)) {
-      all_stats.emplace(counter->name(), counter->value());
+      all_stats.emplace_back(counter->name(), counter->value());
     }
   }
 
   for (const Stats::GaugeSharedPtr& gauge : server_.stats().gauges()) {
     if (shouldShowMetric(*gauge, used_only, regex)) {
       ASSERT(gauge->importMode() != Stats::Gauge::ImportMode::Uninitialized);
-      all_stats.emplace(gauge->name(), gauge->value());
+      all_stats.emplace_back(gauge->name(), gauge->value());
     }
   }
+  sortAndRemoveDuplicates(all_stats);
 
-  std::map<std::string, std::string> text_readouts;
+  std::vector<std::pair<std::string, std::string>> text_readouts;
   for (const auto& text_readout : server_.stats().textReadouts()) {
     if (shouldShowMetric(*text_readout, used_only, regex)) {
-      text_readouts.emplace(text_readout->name(), text_readout->value());
+      text_readouts.emplace_back(text_readout->name(), text_readout->value());
     }
   }
+  sortAndRemoveDuplicates(text_readouts);
 
   if (const auto format_value = Utility::formatParam(params)) {
     if (format_value.value() == "json") {
       response_headers.setReferenceContentType(Http::Headers::get().ContentTypeValues.Json);
-      response.add(
-          statsAsJson(all_stats, text_readouts, server_.stats().histograms(), used_only, regex));
+      statsAsJson(all_stats, text_readouts, server_.stats().histograms(), used_only, regex,
+                  response);
     } else if (format_value.value() == "prometheus") {
       return handlerPrometheusStats(url, response_headers, response, admin_stream);
     } else {
@@ -118,12 +140,13 @@ Http::Code StatsHandler::handlerStats(absl::string_view url,
       rc = Http::Code::NotFound;
     }
   } else { // Display plain stats if format query param is not there.
+    Utility::PagedResponseWriter writer(response);
     for (const auto& text_readout : text_readouts) {
-      response.add(fmt::format("{}: \"{}\"\n", text_readout.first,
-                               Html::Utility::sanitize(text_readout.second)));
+      writer.append(text_readout.first, ": \"", Html::Utility::sanitize(text_readout.second),
+                    "\"\n");
     }
     for (const auto& stat : all_stats) {
-      response.add(fmt::format("{}: {}\n", stat.first, stat.second));
+      writer.append(stat.first, ": ", stat.second, "\n");
     }
     std::map<std::string, std::string> all_histograms;
     for (const Stats::ParentHistogramSharedPtr& histogram : server_.stats().histograms()) {
@@ -133,7 +156,7 @@ Http::Code StatsHandler::handlerStats(absl::string_view url,
       }
     }
     for (const auto& histogram : all_histograms) {
-      response.add(fmt::format("{}: {}\n", histogram.first, histogram.second));
+      writer.append(histogram.first, ": ", histogram.second, "\n");
     }
   }
   return rc;
@@ -175,85 +198,120 @@ Http::Code StatsHandler::handlerContention(absl::string_view,
   return Http::Code::OK;
 }
 
-std::string
-StatsHandler::statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                          const std::map<std::string, std::string>& text_readouts,
-                          const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                          const bool used_only, const absl::optional<std::regex> regex,
-                          const bool pretty_print) {
+namespace {
+
+// Appends a JSON string, escaping the characters which must be escaped.
+void appendJsonString(Utility::PagedResponseWriter& writer, absl::string_view value) {
+  std::string& page = writer.page();
+  page.push_back('"');
+  for (const char c : value) {
+    switch (c) {
+    case '"':
+      page.append("\\\"");
+      break;
+    case '\\':
+      page.append("\\\\");
+      break;
+    default:
+      if (static_cast<unsigned char>(c) < 0x20) {
+        fmt::format_to(std::back_inserter(page), "\\u{:04x}", static_cast<int>(c));
+      } else {
+        page.push_back(c);
+      }
+    }
+  }
+  page.push_back('"');
+  writer.pageUpdated();
+}
+
+// Appends a JSON number, or null for values which JSON can't represent.
+void appendJsonNumber(Utility::PagedResponseWriter& writer, double value) {
+  if (std::isfinite(value)) {
+    fmt::format_to(std::back_inserter(writer.page()), "{}", value);
+    writer.pageUpdated();
+  } else {
+    writer.append("null");
+  }
+}
+
+} // namespace
+
+void StatsHandler::statsAsJson(
+    const std::vector<std::pair<std::string, uint64_t>>& all_stats,
+    const std::vector<std::pair<std::string, std::string>>& text_readouts,
+    const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms, const bool used_only,
+    const absl::optional<std::regex>& regex, Buffer::Instance& response) {
+  // The document is written as it is rendered, rather than built as a ProtobufWkt::Struct and
+  // then serialized, which for large numbers of stats takes many times the size of the output.
+  Utility::PagedResponseWriter writer(response);
+  writer.append("{\"stats\":[");
+  bool first = true;
+  const auto separator = [&writer, &first]() {
+    if (!first) {
+      writer.append(",");
+    }
+    first = false;
+  };
 
-  ProtobufWkt::Struct document;
-  std::vector<ProtobufWkt::Value> stats_array;
   for (const auto& text_readout : text_readouts) {
-    ProtobufWkt::Struct stat_obj;
-    auto* stat_obj_fields = stat_obj.mutable_fields();
-    (*stat_obj_fields)["name"] = ValueUtil::stringValue(text_readout.first);
-    (*stat_obj_fields)["value"] = ValueUtil::stringValue(text_readout.second);
-    stats_array.push_back(ValueUtil::structValue(stat_obj));
+    separator();
+    writer.append("{\"name\":");
+    appendJsonString(writer, text_readout.first);
+    writer.append(",\"value\":");
+    appendJsonString(writer, text_readout.second);
+    writer.append("}");
   }
   for (const auto& stat : all_stats) {
-    ProtobufWkt::Struct stat_obj;
-    auto* stat_obj_fields = stat_obj.mutable_fields();
-    (*stat_obj_fields)["name"] = ValueUtil::stringValue(stat.first);
-    (*stat_obj_fields)["value"] = ValueUtil::numberValue(stat.second);
-    stats_array.push_back(ValueUtil::structValue(stat_obj));
+    separator();
+    writer.append("{\"name\":");
+    appendJsonString(writer, stat.first);
+    writer.append(",\"value\":", stat.second, "}");
   }
 
-  ProtobufWkt::Struct histograms_obj;
-  auto* histograms_obj_fields = histograms_obj.mutable_fields();
-
-  ProtobufWkt::Struct histograms_obj_container;
-  auto* histograms_obj_container_fields = histograms_obj_container.mutable_fields();
-  std::vector<ProtobufWkt::Value> computed_quantile_array;
-
   bool found_used_histogram = false;
   for (const Stats::ParentHistogramSharedPtr& histogram : all_histograms) {
-    if (shouldShowMetric(*histogram, used_only, regex)) {
-      if (!found_used_histogram) {
-        // It is not possible for the supported quantiles to differ across histograms, so it is ok
-        // to send them once.
-        Stats::HistogramStatisticsImpl empty_statistics;
-        std::vector<ProtobufWkt::Value> supported_quantile_array;
-        for (double quantile : empty_statistics.supportedQuantiles()) {
-          supported_quantile_array.push_back(ValueUtil::numberValue(quantile * 100));
+    if (!shouldShowMetric(*histogram, used_only, regex)) {
+      continue;
+    }
+    if (!found_used_histogram) {
+      // It is not possible for the supported quantiles to differ across histograms, so it is ok
+      // to send them once.
+      separator();
+      writer.append("{\"histograms\":{\"supported_quantiles\":[");
+      Stats::HistogramStatisticsImpl empty_statistics;
+      bool first_quantile = true;
+      for (double quantile : empty_statistics.supportedQuantiles()) {
+        if (!first_quantile) {
+          writer.append(",");
         }
-        (*histograms_obj_fields)["supported_quantiles"] =
-            ValueUtil::listValue(supported_quantile_array);
-        found_used_histogram = true;
+        first_quantile = false;
+        appendJsonNumber(writer, quantile * 100);
       }
+      writer.append("],\"computed_quantiles\":[");
+      found_used_histogram = true;
+    } else {
+      writer.append(",");
+    }
 
-      ProtobufWkt::Struct computed_quantile;
-      auto* computed_quantile_fields = computed_quantile.mutable_fields();
-      (*computed_quantile_fields)["name"] = ValueUtil::stringValue(histogram->name());
-
-      std::vector<ProtobufWkt::Value> computed_quantile_value_array;
-      for (size_t i = 0; i < histogram->intervalStatistics().supportedQuantiles().size(); ++i) {
-        ProtobufWkt::Struct computed_quantile_value;
-        auto* computed_quantile_value_fields = computed_quantile_value.mutable_fields();
-        const auto& interval = histogram->intervalStatistics().computedQuantiles()[i];
-        const auto& cumulative = histogram->cumulativeStatistics().computedQuantiles()[i];
-        (*computed_quantile_value_fields)["interval"] =
-            std::isnan(interval) ? ValueUtil::nullValue() : ValueUtil::numberValue(interval);
-        (*computed_quantile_value_fields)["cumulative"] =
-            std::isnan(cumulative) ? ValueUtil::nullValue() : ValueUtil::numberValue(cumulative);
-
-        computed_quantile_value_array.push_back(ValueUtil::structValue(computed_quantile_value));
-      }
-      (*computed_quantile_fields)["values"] = ValueUtil::listValue(computed_quantile_value_array);
-      computed_quantile_array.push_back(ValueUtil::structValue(computed_quantile));
+    writer.append("{\"name\":");
+    appendJsonString(writer, histogram->name());
+    writer.append(",\"values\":[");
+    const Stats::HistogramStatistics& interval_statistics = histogram->intervalStatistics();
+    const Stats::HistogramStatistics& cumulative_statistics = histogram->cumulativeStatistics();
+    for (size_t i = 0; i < interval_statistics.supportedQuantiles().size(); ++i) {
+      writer.append(i == 0 ? "{\"interval\":" : ",{\"interval\":");
+      appendJsonNumber(writer, interval_statistics.computedQuantiles()[i]);
+      writer.append(",\"cumulative\":");
+      appendJsonNumber(writer, cumulative_statistics.computedQuantiles()[i]);
+      writer.append("}");
     }
+    writer.append("]}");
   }
-
   if (found_used_histogram) {
-    (*histograms_obj_fields)["computed_quantiles"] = ValueUtil::listValue(computed_quantile_array);
-    (*histograms_obj_container_fields)["histograms"] = ValueUtil::structValue(histograms_obj);
-    stats_array.push_back(ValueUtil::structValue(histograms_obj_container));
+    writer.append("]}}");
   }
 
-  auto* document_fields = document.mutable_fields();
-  (*document_fields)["stats"] = ValueUtil::listValue(stats_array);
-
-  return MessageUtil::getJsonStringFromMessageOrDie(document, pretty_print, true);
+  writer.append("]}");
 }
 
 } // namespace Server
@@ -2,6 +2,8 @@
 
 #include <regex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "envoy/buffer/buffer.h"
 #include "envoy/http/codes.h"
@@ -58,12 +60,16 @@ private:
 
   friend class AdminStatsTest;
 
-  static std::string statsAsJson(const std::map<std::string, uint64_t>& all_stats,
-                                 const std::map<std::string, std::string>& text_readouts,
-                                 const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
-                                 bool used_only,
-                                 const absl::optional<std::regex> regex = absl::nullopt,
-                                 bool pretty_print = false);
+  /**
+   * Writes the stats as a JSON document.
+   * @param all_stats the names and values of the counters and gauges, sorted by name.
+   * @param text_readouts the names and values of the text readouts, sorted by name.
+   */
+  static void statsAsJson(const std::vector<std::pair<std::string, uint64_t>>& all_stats,
+                          const std::vector<std::pair<std::string, std::string>>& text_readouts,
+                          const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
+                          bool used_only, const absl::optional<std::regex>& regex,
+                          Buffer::Instance& response);
 };
 
 } // namespace Server
@@ -1,14 +1,18 @@
 #pragma once
 
 #include <regex>
+#include <string>
 
 #include "envoy/admin/v3/server_info.pb.h"
+#include "envoy/buffer/buffer.h"
 #include "envoy/init/manager.h"
 
 #include "common/http/codes.h"
 #include "common/http/header_map_impl.h"
 #include "common/http/utility.h"
 
+#include "absl/strings/str_cat.h"
+
 namespace Envoy {
 namespace Server {
 namespace Utility {
@@ -26,6 +30,66 @@ absl::optional<std::string> formatParam(const Http::Utility::QueryParams& params
 absl::optional<std::string> queryParam(const Http::Utility::QueryParams& params,
                                        const std::string& key);
 
+/**
+ * Renders output into a page which is moved to the response each time it fills up, so large
+ * outputs need neither a temporary string per line nor one holding the whole output. The rest of
+ * the output is moved to the response when the writer is destroyed.
+ */
+class PagedResponseWriter {
+public:
+  static constexpr uint64_t PageSize = 64 * 1024;
+
+  explicit PagedResponseWriter(Buffer::Instance& response) : response_(response) {
+    page_.reserve(PageSize);
+  }
+  ~PagedResponseWriter() { flush(); }
+
+  /**
+   * Appends the pieces to the page, as absl::StrAppend() does.
+   */
+  template <class... Pieces> void append(const Pieces&... pieces) {
+    absl::StrAppend(&page_, pieces...);
+    pageUpdated();
+  }
+
+  /**
+   * @return std::string& the page, for formatting into it directly. pageUpdated() must be called
+   *         once done.
+   */
+  std::string& page() { return page_; }
+  void pageUpdated() {
+    if (page_.size() >= PageSize) {
+      flush();
+      page_.reserve(PageSize);
+    }
+  }
+
+  void flush() {
+    if (!page_.empty()) {
+      response_.addBufferFragment(*new Page(std::move(page_)));
+      page_.clear();
+    }
+  }
+
+private:
+  // A page handed over to the response, which releases it once drained.
+  class Page : public Buffer::BufferFragment {
+  public:
+    explicit Page(std::string&& data) : data_(std::move(data)) {}
+
+    // Buffer::BufferFragment
+    const void* data() const override { return data_.data(); }
+    size_t size() const override { return data_.size(); }
+    void done() override { delete this; }
+
+  private:
+    const std::string data_;
+  };
+
+  Buffer::Instance& response_;
+  std::string page_;
+};
+
 } // namespace Utility
 } // namespace Server
 } // namespace Envoy
@@ -3,6 +3,7 @@
 #include "envoy/config/core/v3/base.pb.h"
 #include "envoy/config/listener/v3/listener.pb.h"
 #include "envoy/config/listener/v3/listener_components.pb.h"
+#include "envoy/config/listener/v3/udp_gso_batch_writer_config.pb.h"
 #include "envoy/extensions/filters/listener/proxy_protocol/v3/proxy_protocol.pb.h"
 #include "envoy/network/exception.h"
 #include "envoy/network/udp_packet_writer_config.h"
@@ -412,8 +413,11 @@ void ListenerImpl::buildUdpListenerFactory(Network::Socket::Type socket_type,
 void ListenerImpl::buildUdpWriterFactory(Network::Socket::Type socket_type) {
   if (socket_type == Network::Socket::Type::Datagram) {
     auto udp_writer_config = config_.udp_writer_config();
-    if (!Api::OsSysCallsSingleton::get().supportsUdpGso() ||
-        udp_writer_config.typed_config().type_url().empty()) {
+    // The batch writer only uses GSO where it is supported, but the QUICHE GSO writer requires it.
+    if (udp_writer_config.typed_config().type_url().empty() ||
+        (!Api::OsSysCallsSingleton::get().supportsUdpGso() &&
+         udp_writer_config.typed_config()
+             .Is<envoy::config::listener::v3::UdpGsoBatchWriterOptions>())) {
       const std::string default_type_url =
           "type.googleapis.com/envoy.config.listener.v3.UdpDefaultWriterOptions";
       udp_writer_config.mutable_typed_config()->set_type_url(default_type_url);
@@ -451,10 +455,11 @@ void ListenerImpl::buildListenSocketOptions(Network::Socket::Type socket_type) {
     addListenSocketOptions(Network::SocketOptionFactory::buildIpPacketInfoOptions());
     // Needed to return receive buffer overflown indicator.
     addListenSocketOptions(Network::SocketOptionFactory::buildRxQueueOverFlowOptions());
-    // TODO(yugant) : Add a config option for UDP_GRO
     if (Api::OsSysCallsSingleton::get().supportsUdpGro()) {
-      // Needed to receive gso_size option
-      addListenSocketOptions(Network::SocketOptionFactory::buildUdpGroOptions());
+      // Needed to receive gso_size option. When GRO is not preferred it is explicitly disabled so
+      // that datagrams are read with recvmmsg() instead.
+      addListenSocketOptions(Network::SocketOptionFactory::buildUdpGroOptions(
+          PROTOBUF_GET_WRAPPED_OR_DEFAULT(config_.udp_listener_config(), prefer_gro, true)));
     }
   }
 }
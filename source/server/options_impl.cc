@@ -126,6 +126,9 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   TCLAP::ValueArg<uint32_t> file_flush_interval_msec("", "file-flush-interval-msec",
                                                      "Interval for log flushing in msec", false,
                                                      10000, "uint32_t", cmd);
+  TCLAP::SwitchArg file_flush_shared_thread(
+      "", "file-flush-shared-thread",
+      "Flush all log files from per-thread ring buffers with a single thread", cmd, false);
   TCLAP::ValueArg<uint32_t> drain_time_s("", "drain-time-s",
                                          "Hot restart and LDS removal drain time in seconds", false,
                                          600, "uint32_t", cmd);
@@ -257,6 +260,7 @@ OptionsImpl::OptionsImpl(std::vector<std::string> args,
   service_node_ = service_node.getValue();
   service_zone_ = service_zone.getValue();
   file_flush_interval_msec_ = std::chrono::milliseconds(file_flush_interval_msec.getValue());
+  file_flush_shared_thread_ = file_flush_shared_thread.getValue();
   drain_time_ = std::chrono::seconds(drain_time_s.getValue());
   parent_shutdown_time_ = std::chrono::seconds(parent_shutdown_time_s.getValue());
   socket_path_ = socket_path.getValue();
@@ -385,6 +389,7 @@ Server::CommandLineOptionsPtr OptionsImpl::toCommandLineOptions() const {
   }
   command_line_options->mutable_file_flush_interval()->MergeFrom(
       Protobuf::util::TimeUtil::MillisecondsToDuration(fileFlushIntervalMsec().count()));
+  command_line_options->set_file_flush_shared_thread(fileFlushSharedThread());
 
   command_line_options->mutable_drain_time()->MergeFrom(
       Protobuf::util::TimeUtil::SecondsToDuration(drainTime().count()));
@@ -413,11 +418,11 @@ OptionsImpl::OptionsImpl(const std::string& service_cluster, const std::string&
       local_address_ip_version_(Network::Address::IpVersion::v4), log_level_(log_level),
       log_format_(Logger::Logger::DEFAULT_LOG_FORMAT), log_format_escaped_(false),
       restart_epoch_(0u), service_cluster_(service_cluster), service_node_(service_node),
-      service_zone_(service_zone), file_flush_interval_msec_(10000), drain_time_(600),
-      parent_shutdown_time_(900), drain_strategy_(Server::DrainStrategy::Gradual),
-      mode_(Server::Mode::Serve), hot_restart_disabled_(false), signal_handling_enabled_(true),
-      mutex_tracing_enabled_(false), cpuset_threads_(false), socket_path_("@envoy_domain_socket"),
-      socket_mode_(0) {}
+      service_zone_(service_zone), file_flush_interval_msec_(10000),
+      file_flush_shared_thread_(false), drain_time_(600), parent_shutdown_time_(900),
+      drain_strategy_(Server::DrainStrategy::Gradual), mode_(Server::Mode::Serve),
+      hot_restart_disabled_(false), signal_handling_enabled_(true), mutex_tracing_enabled_(false),
+      cpuset_threads_(false), socket_path_("@envoy_domain_socket"), socket_mode_(0) {}
 
 void OptionsImpl::disableExtensions(const std::vector<std::string>& names) {
   for (const auto& name : names) {
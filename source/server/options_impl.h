@@ -78,6 +78,9 @@ public:
   void setFileFlushIntervalMsec(std::chrono::milliseconds file_flush_interval_msec) {
     file_flush_interval_msec_ = file_flush_interval_msec;
   }
+  void setFileFlushSharedThread(bool file_flush_shared_thread) {
+    file_flush_shared_thread_ = file_flush_shared_thread;
+  }
   void setServiceClusterName(const std::string& service_cluster) {
     service_cluster_ = service_cluster;
   }
@@ -140,6 +143,7 @@ public:
   std::chrono::milliseconds fileFlushIntervalMsec() const override {
     return file_flush_interval_msec_;
   }
+  bool fileFlushSharedThread() const override { return file_flush_shared_thread_; }
   const std::string& serviceClusterName() const override { return service_cluster_; }
   const std::string& serviceNodeName() const override { return service_node_; }
   const std::string& serviceZone() const override { return service_zone_; }
@@ -193,6 +197,7 @@ private:
   std::string service_node_;
   std::string service_zone_;
   std::chrono::milliseconds file_flush_interval_msec_;
+  bool file_flush_shared_thread_;
   std::chrono::seconds drain_time_;
   std::chrono::seconds parent_shutdown_time_;
   Server::DrainStrategy drain_strategy_;
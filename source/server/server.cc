@@ -36,6 +36,7 @@
 #include "common/local_info/local_info_impl.h"
 #include "common/memory/stats.h"
 #include "common/network/address_impl.h"
+#include "common/network/dns_resolver_cache_impl.h"
 #include "common/network/socket_interface.h"
 #include "common/network/socket_interface_impl.h"
 #include "common/network/tcp_listener_impl.h"
@@ -83,7 +84,7 @@ InstanceImpl::InstanceImpl(
       handler_(new ConnectionHandlerImpl(*dispatcher_, absl::nullopt)),
       listener_component_factory_(*this), worker_factory_(thread_local_, *api_, hooks),
       access_log_manager_(options.fileFlushIntervalMsec(), *api_, *dispatcher_, access_log_lock,
-                          store),
+                          store, options.fileFlushSharedThread()),
       terminated_(false),
       mutex_tracer_(options.mutexTracingEnabled() ? &Envoy::MutexTracerImpl::getOrCreateTracer()
                                                   : nullptr),
@@ -481,6 +482,13 @@ void InstanceImpl::initialize(const Options& options,
   listener_manager_ = std::make_unique<ListenerManagerImpl>(
       *this, listener_component_factory_, worker_factory_, bootstrap_.enable_dispatcher_stats());
 
+  // The thread of the HTTP/2 connections shared by the workers registers along with them, so it
+  // can't be started later on for clusters added by CDS.
+  if (Upstream::ProdClusterManagerFactory::sharesHttp2Connections(bootstrap_)) {
+    shared_conn_pool_thread_ =
+        Upstream::ProdClusterManagerFactory::createSharedConnPoolThread(*api_, thread_local_);
+  }
+
   // The main thread is also registered for thread local updates so that code that does not care
   // whether it runs on the main thread or on workers can still use TLS.
   thread_local_.registerThread(*dispatcher_, true);
@@ -537,12 +545,16 @@ void InstanceImpl::initialize(const Options& options,
 
   const bool use_tcp_for_dns_lookups = bootstrap_.use_tcp_for_dns_lookups();
   dns_resolver_ = dispatcher_->createDnsResolver({}, use_tcp_for_dns_lookups);
+  if (bootstrap_.has_dns_resolver_cache()) {
+    dns_resolver_ = std::make_shared<Network::DnsResolverCacheImpl>(
+        dns_resolver_, *dispatcher_, stats_store_, bootstrap_.dns_resolver_cache());
+  }
 
   cluster_manager_factory_ = std::make_unique<Upstream::ProdClusterManagerFactory>(
       *admin_, Runtime::LoaderSingleton::get(), stats_store_, thread_local_, dns_resolver_,
       *ssl_context_manager_, *dispatcher_, *local_info_, *secret_manager_,
       messageValidationContext(), *api_, http_context_, grpc_context_, router_context_,
-      access_log_manager_, *singleton_manager_, options_);
+      access_log_manager_, *singleton_manager_, options_, shared_conn_pool_thread_);
 
   // Now the configuration gets parsed. The configuration may start setting
   // thread local data per above. See MainImpl::initialize() for why ConfigImpl
@@ -799,6 +811,12 @@ void InstanceImpl::terminate() {
     listener_manager_->stopWorkers();
   }
 
+  // The shared connections are destroyed once the workers no longer use them, and before the
+  // thread local storage they use.
+  if (shared_conn_pool_thread_ != nullptr) {
+    shared_conn_pool_thread_->shutdown();
+  }
+
   // Only flush if we have not been hot restarted.
   if (stat_flush_timer_) {
     flushStats();
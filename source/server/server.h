@@ -30,6 +30,7 @@
 #include "common/grpc/async_client_manager_impl.h"
 #include "common/grpc/context_impl.h"
 #include "common/http/context_impl.h"
+#include "common/http/http2/shared_conn_pool.h"
 #include "common/init/manager_impl.h"
 #include "common/memory/heap_shrinker.h"
 #include "common/protobuf/message_validator_impl.h"
@@ -351,6 +352,7 @@ private:
   ProdListenerComponentFactory listener_component_factory_;
   ProdWorkerFactory worker_factory_;
   std::unique_ptr<ListenerManager> listener_manager_;
+  Http::Http2::SharedConnPoolThreadSharedPtr shared_conn_pool_thread_;
   absl::node_hash_map<Stage, LifecycleNotifierCallbacks> stage_callbacks_;
   absl::node_hash_map<Stage, LifecycleNotifierCompletionCallbacks> stage_completable_callbacks_;
   Configuration::MainImpl config_;
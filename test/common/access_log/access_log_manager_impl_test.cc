@@ -1,4 +1,7 @@
 #include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "common/access_log/access_log_manager_impl.h"
 #include "common/filesystem/file_shared_impl.h"
@@ -11,6 +14,7 @@
 #include "test/test_common/test_time.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -517,6 +521,309 @@ TEST_F(AccessLogManagerImplTest, ReopenAllFiles) {
       .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
 }
 
+TEST(AccessLogRingBufferTest, WrapsAround) {
+  AccessLogRingBuffer ring(16);
+  EXPECT_TRUE(ring.write("0123456789"));
+  EXPECT_EQ(10, ring.length());
+  EXPECT_EQ("0123456789", ring.readableSlices()[0]);
+  EXPECT_EQ("", ring.readableSlices()[1]);
+  ring.drain(10);
+
+  // Fits into the space freed by the drain, but crosses the end of the ring.
+  EXPECT_TRUE(ring.write("abcdefghij"));
+  EXPECT_EQ("abcdef", ring.readableSlices()[0]);
+  EXPECT_EQ("ghij", ring.readableSlices()[1]);
+  EXPECT_EQ(2, ring.records());
+  EXPECT_EQ(0, ring.droppedBytes());
+
+  // Records are appended whole or not at all.
+  EXPECT_FALSE(ring.write("0123456789"));
+  EXPECT_TRUE(ring.write("012345"));
+  EXPECT_EQ(16, ring.length());
+  EXPECT_EQ(3, ring.records());
+  EXPECT_EQ(10, ring.droppedBytes());
+
+  ring.drain(16);
+  EXPECT_EQ(0, ring.length());
+  EXPECT_EQ("", ring.readableSlices()[0]);
+}
+
+// The consumer sees exactly the bytes of the records which were appended, in order.
+TEST(AccessLogRingBufferTest, ConcurrentProducerAndConsumer) {
+  constexpr uint64_t Records = 10000;
+  AccessLogRingBuffer ring(256);
+
+  std::thread producer([&ring]() {
+    for (uint64_t i = 0; i < Records;) {
+      const std::string record = absl::StrCat(i, "\n");
+      if (ring.write(record)) {
+        ++i;
+      }
+    }
+  });
+
+  std::string consumed;
+  std::string expected;
+  for (uint64_t i = 0; i < Records; ++i) {
+    absl::StrAppend(&expected, i, "\n");
+  }
+  while (consumed.size() < expected.size()) {
+    uint64_t length = 0;
+    for (const absl::string_view slice : ring.readableSlices()) {
+      consumed.append(slice.data(), slice.size());
+      length += slice.size();
+    }
+    ring.drain(length);
+  }
+  producer.join();
+
+  EXPECT_EQ(expected, consumed);
+  EXPECT_EQ(Records, ring.records());
+}
+
+class SharedFlushAccessLogManagerImplTest : public testing::Test {
+protected:
+  SharedFlushAccessLogManagerImplTest()
+      : file_(new NiceMock<Filesystem::MockFile>), thread_factory_(Thread::threadFactoryForTest()),
+        access_log_manager_(timeout_40ms_, api_, dispatcher_, lock_, store_, true) {
+    EXPECT_CALL(file_system_, createFile("foo"))
+        .WillOnce(Return(ByMove(std::unique_ptr<NiceMock<Filesystem::MockFile>>(file_))));
+
+    EXPECT_CALL(api_, fileSystem()).WillRepeatedly(ReturnRef(file_system_));
+    EXPECT_CALL(api_, threadFactory()).WillRepeatedly(ReturnRef(thread_factory_));
+  }
+
+  void waitForCounterEq(const std::string& name, uint64_t value) {
+    TestUtility::waitForCounterEq(store_, name, value, time_system_);
+  }
+
+  void waitForWrites(Filesystem::MockFile& file, size_t writes) {
+    Thread::LockGuard lock(file.write_mutex_);
+    while (file.num_writes_ != writes) {
+      file.write_event_.wait(file.write_mutex_);
+    }
+  }
+
+  NiceMock<Api::MockApi> api_;
+  NiceMock<Filesystem::MockInstance> file_system_;
+  NiceMock<Filesystem::MockFile>* file_;
+  const std::chrono::milliseconds timeout_40ms_{40};
+  Stats::TestUtil::TestStore store_;
+  Thread::ThreadFactory& thread_factory_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Thread::MutexBasicLockable lock_;
+  AccessLogManagerImpl access_log_manager_;
+  Event::TestRealTimeSystem time_system_;
+};
+
+// Records written by different threads are flushed with one vectored write per pass.
+TEST_F(SharedFlushAccessLogManagerImplTest, FlushAllThreadsOnTimer) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  log_file->write("main\n");
+  std::thread worker([&log_file]() {
+    log_file->write("worker1\n");
+    log_file->write("worker2\n");
+  });
+  worker.join();
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("main\nworker1\nworker2\n"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*timer, enableTimer(timeout_40ms_, _));
+  timer->invokeCallback();
+  waitForWrites(*file_, 1);
+
+  waitForCounterEq("filesystem.write_completed", 1);
+  EXPECT_EQ(1UL, store_.counter("filesystem.flushed_by_timer").value());
+  EXPECT_EQ(3UL, store_.counter("filesystem.write_buffered").value());
+  EXPECT_EQ(0UL, store_.counter("filesystem.write_dropped_bytes").value());
+  // Set once the pass is over, after the write.
+  EXPECT_TRUE(
+      TestUtility::waitForGaugeEq(store_, "filesystem.write_queue_depth", 21, time_system_));
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+TEST_F(SharedFlushAccessLogManagerImplTest, FlushOnDemand) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("test"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("test");
+  log_file->flush();
+  EXPECT_EQ(1U, file_->num_writes_);
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_completed").value());
+
+  // Nothing is left to write.
+  log_file->flush();
+  EXPECT_EQ(1U, file_->num_writes_);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// A short write is completed by writing the remainder, and an error ends the flush.
+TEST_F(SharedFlushAccessLogManagerImplTest, ShortWritesAndErrors) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  Sequence sq;
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("0123456789"));
+        return Filesystem::resultSuccess<ssize_t>(4);
+      }));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("456789"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write("0123456789");
+  log_file->flush();
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_completed").value());
+
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultFailure<ssize_t>(-1, ENOSPC))));
+  log_file->write("lost");
+  log_file->flush();
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_failed").value());
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_completed").value());
+
+  // The failed data was dropped.
+  log_file->flush();
+  EXPECT_EQ(3U, file_->num_writes_);
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+// Records which do not fit into the ring of their thread are dropped and counted.
+TEST_F(SharedFlushAccessLogManagerImplTest, DropsWhenRingIsFull) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  const std::string too_big(SharedFlushAccessLogFileImpl::RING_BUFFER_SIZE + 1, 'a');
+  log_file->write(too_big);
+  log_file->write("kept");
+
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("kept"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->flush();
+  EXPECT_EQ(too_big.size(), store_.counter("filesystem.write_dropped_bytes").value());
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_buffered").value());
+
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+TEST_F(SharedFlushAccessLogManagerImplTest, FilledRingShouldBeFlushedWithoutTimer) {
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  const std::string big_string(SharedFlushAccessLogFileImpl::FLUSH_THRESHOLD + 1, 'b');
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([&big_string](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare(big_string));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  log_file->write(big_string);
+  waitForWrites(*file_, 1);
+
+  EXPECT_EQ(0UL, store_.counter("filesystem.flushed_by_timer").value());
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+}
+
+TEST_F(SharedFlushAccessLogManagerImplTest, ReopenFileOnFlushPass) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  Sequence sq;
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, write_(_))
+      .InSequence(sq)
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("reopened"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+
+  access_log_manager_.reopen();
+  log_file->write("reopened");
+  timer->invokeCallback();
+  waitForWrites(*file_, 1);
+}
+
+TEST_F(SharedFlushAccessLogManagerImplTest, ReopenThrows) {
+  NiceMock<Event::MockTimer>* timer = new NiceMock<Event::MockTimer>(&dispatcher_);
+
+  Sequence sq;
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager_.createAccessLog("foo");
+
+  EXPECT_CALL(*file_, close_())
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  EXPECT_CALL(*file_, open_(_))
+      .InSequence(sq)
+      .WillOnce(Return(ByMove(Filesystem::resultFailure<bool>(false, 0))));
+
+  log_file->reopen();
+  log_file->write("this is to force reopen");
+  timer->invokeCallback();
+
+  waitForCounterEq("filesystem.reopen_failed", 1);
+  EXPECT_EQ(0U, file_->num_writes_);
+}
+
+// A file may outlive its manager, as access loggers hold it. It keeps the flush thread running,
+// and still flushes its data on destruction.
+TEST_F(SharedFlushAccessLogManagerImplTest, FileOutlivesManager) {
+  auto access_log_manager = std::make_unique<AccessLogManagerImpl>(timeout_40ms_, api_, dispatcher_,
+                                                                   lock_, store_, true);
+  EXPECT_CALL(*file_, open_(_)).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  AccessLogFileSharedPtr log_file = access_log_manager->createAccessLog("foo");
+  log_file->write("before\n");
+  access_log_manager.reset();
+
+  log_file->write("after\n");
+  EXPECT_CALL(*file_, write_(_))
+      .WillOnce(Invoke([](absl::string_view data) -> Api::IoCallSizeResult {
+        EXPECT_EQ(0, data.compare("before\nafter\n"));
+        return Filesystem::resultSuccess<ssize_t>(static_cast<ssize_t>(data.length()));
+      }));
+  EXPECT_CALL(*file_, close_()).WillOnce(Return(ByMove(Filesystem::resultSuccess<bool>(true))));
+  log_file.reset();
+  EXPECT_EQ(1UL, store_.counter("filesystem.write_completed").value());
+  EXPECT_EQ(2UL, store_.counter("filesystem.write_buffered").value());
+}
+
 } // namespace
 } // namespace AccessLog
 } // namespace Envoy
@@ -0,0 +1,90 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <array>
+#include <cstdint>
+#include <memory>
+
+#include "envoy/event/dispatcher.h"
+#include "envoy/thread/thread.h"
+
+#include "common/common/assert.h"
+
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Event {
+
+// A dispatcher running on its own thread, which the benchmark threads post to.
+class PostSpeedTest {
+public:
+  PostSpeedTest() : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test")) {
+    thread_ = api_->threadFactory().createThread(
+        [this]() { dispatcher_->run(Dispatcher::RunType::RunUntilExit); });
+  }
+
+  ~PostSpeedTest() {
+    dispatcher_->exit();
+    thread_->join();
+  }
+
+  // Waits for every callback posted so far to run.
+  void drain() {
+    absl::Notification drained;
+    dispatcher_->post([&drained]() { drained.Notify(); });
+    drained.WaitForNotification();
+  }
+
+  Api::ApiPtr api_;
+  DispatcherPtr dispatcher_;
+  Thread::ThreadPtr thread_;
+  // Only accessed from the dispatcher thread.
+  uint64_t runs_{};
+};
+
+// Shared by the benchmark threads. Created by thread 0 before the timed loop starts, and destroyed
+// by it after all threads have left the loop.
+static std::unique_ptr<PostSpeedTest> context;
+
+// Each benchmark thread posts a callback small enough for the small buffer of std::function.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_PostSmallCallback(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    context = std::make_unique<PostSpeedTest>();
+  }
+  for (auto _ : state) {
+    PostSpeedTest* test = context.get();
+    test->dispatcher_->post([test]() { ++test->runs_; });
+  }
+  if (state.thread_index == 0) {
+    context->drain();
+    RELEASE_ASSERT(context->runs_ > 0, "");
+    context.reset();
+  }
+}
+BENCHMARK(BM_PostSmallCallback)->ThreadRange(1, 64)->UseRealTime();
+
+// Each benchmark thread posts a callback which std::function has to allocate storage for.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_PostLargeCallback(benchmark::State& state) {
+  if (state.thread_index == 0) {
+    context = std::make_unique<PostSpeedTest>();
+  }
+  const std::array<uint64_t, 8> payload{};
+  for (auto _ : state) {
+    PostSpeedTest* test = context.get();
+    test->dispatcher_->post([test, payload]() { test->runs_ += payload[0] + 1; });
+  }
+  if (state.thread_index == 0) {
+    context->drain();
+    RELEASE_ASSERT(context->runs_ > 0, "");
+    context.reset();
+  }
+}
+BENCHMARK(BM_PostLargeCallback)->ThreadRange(1, 64)->UseRealTime();
+
+} // namespace Event
+} // namespace Envoy
@@ -1,4 +1,5 @@
 #include <functional>
+#include <vector>
 
 #include "envoy/common/scope_tracker.h"
 #include "envoy/thread/thread.h"
@@ -468,7 +469,7 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
     // Block dispatcher first to ensure that both posted events below are handled
     // by a single call to runPostCallbacks().
     //
-    // This also ensures that the post_lock_ is not held while callbacks are called,
+    // This also ensures that no lock is held while callbacks are called,
     // or else this would deadlock.
     Thread::LockGuard lock(mu_);
     dispatcher_->post([this]() { Thread::LockGuard lock(mu_); });
@@ -491,6 +492,44 @@ TEST_F(DispatcherImplTest, RunPostCallbacksLocking) {
   }
 }
 
+// Callbacks posted concurrently from several threads all run, and each thread's callbacks run in
+// the order it posted them.
+TEST_F(DispatcherImplTest, PostFromManyThreads) {
+  constexpr int Threads = 8;
+  constexpr int PostsPerThread = 1000;
+  // Only accessed from the dispatcher thread.
+  std::vector<int> next(Threads, 0);
+  int remaining = Threads * PostsPerThread;
+  bool in_order = true;
+
+  std::vector<Thread::ThreadPtr> threads;
+  for (int thread = 0; thread < Threads; ++thread) {
+    threads.push_back(api_->threadFactory().createThread([&, thread]() {
+      for (int i = 0; i < PostsPerThread; ++i) {
+        dispatcher_->post([&, thread, i]() {
+          in_order &= (next[thread]++ == i);
+          if (--remaining == 0) {
+            {
+              Thread::LockGuard lock(mu_);
+              work_finished_ = true;
+            }
+            cv_.notifyOne();
+          }
+        });
+      }
+    }));
+  }
+  for (Thread::ThreadPtr& thread : threads) {
+    thread->join();
+  }
+
+  Thread::LockGuard lock(mu_);
+  while (!work_finished_) {
+    cv_.wait(mu_);
+  }
+  EXPECT_TRUE(in_order);
+}
+
 TEST_F(DispatcherImplTest, DispatcherThreadDeleted) {
   dispatcher_->deleteInDispatcherThread(std::make_unique<TestDispatcherThreadDeletable>(
       [this, id = api_->threadFactory().currentThreadId()]() {
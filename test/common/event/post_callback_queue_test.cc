@@ -0,0 +1,147 @@
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "common/event/post_callback_queue.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Event {
+namespace {
+
+// Runs the supplied function when destroyed.
+class RunOnDestroy {
+public:
+  explicit RunOnDestroy(std::function<void()> on_destroy) : on_destroy_(std::move(on_destroy)) {}
+  ~RunOnDestroy() { on_destroy_(); }
+
+private:
+  std::function<void()> on_destroy_;
+};
+
+void runAll(PostCallbackQueue::Batch& batch) {
+  while (!batch.empty()) {
+    batch.front()();
+    batch.popFront();
+  }
+}
+
+TEST(PostCallbackQueueTest, RunsInPushOrder) {
+  PostCallbackQueue queue;
+  std::vector<int> order;
+  EXPECT_TRUE(queue.push([&order]() { order.push_back(1); }));
+  EXPECT_FALSE(queue.push([&order]() { order.push_back(2); }));
+  EXPECT_FALSE(queue.push([&order]() { order.push_back(3); }));
+  EXPECT_EQ(3, queue.size());
+
+  PostCallbackQueue::Batch batch = queue.popAll();
+  EXPECT_EQ(0, queue.size());
+  runAll(batch);
+  EXPECT_THAT(order, testing::ElementsAre(1, 2, 3));
+
+  // The queue is empty again, so the next push needs a wakeup.
+  EXPECT_TRUE(queue.push([]() {}));
+}
+
+// Callbacks pushed while a batch is running are left for the next batch.
+TEST(PostCallbackQueueTest, BatchIsSnapshot) {
+  PostCallbackQueue queue;
+  std::vector<int> order;
+  queue.push([&]() {
+    order.push_back(1);
+    EXPECT_TRUE(queue.push([&order]() { order.push_back(3); }));
+  });
+  queue.push([&order]() { order.push_back(2); });
+
+  PostCallbackQueue::Batch batch = queue.popAll();
+  runAll(batch);
+  EXPECT_THAT(order, testing::ElementsAre(1, 2));
+
+  batch = queue.popAll();
+  runAll(batch);
+  EXPECT_THAT(order, testing::ElementsAre(1, 2, 3));
+}
+
+// The callback is destroyed by popFront(), before the next callback runs.
+TEST(PostCallbackQueueTest, PopFrontDestroysCallback) {
+  PostCallbackQueue queue;
+  std::vector<std::string> events;
+  auto first = std::make_shared<RunOnDestroy>([&events]() { events.push_back("destroy 1"); });
+  queue.push([&events, first]() { events.push_back("run 1"); });
+  first.reset();
+  queue.push([&events]() { events.push_back("run 2"); });
+
+  PostCallbackQueue::Batch batch = queue.popAll();
+  runAll(batch);
+  EXPECT_THAT(events, testing::ElementsAre("run 1", "destroy 1", "run 2"));
+}
+
+// Callbacks which never ran are destroyed with the batch or the queue, including callbacks posted
+// from the destructor of another callback.
+TEST(PostCallbackQueueTest, DestroysPendingCallbacks) {
+  int destroyed = 0;
+  {
+    PostCallbackQueue queue;
+    auto on_destroy = std::make_shared<RunOnDestroy>([&]() {
+      ++destroyed;
+      auto nested = std::make_shared<RunOnDestroy>([&destroyed]() { ++destroyed; });
+      queue.push([nested]() {});
+    });
+    queue.push([on_destroy]() {});
+    on_destroy.reset();
+
+    auto in_batch = std::make_shared<RunOnDestroy>([&destroyed]() { ++destroyed; });
+    queue.push([in_batch]() {});
+    in_batch.reset();
+    {
+      PostCallbackQueue::Batch batch = queue.popAll();
+    }
+    EXPECT_EQ(2, destroyed);
+    EXPECT_EQ(1, queue.size());
+
+    auto in_queue = std::make_shared<RunOnDestroy>([&destroyed]() { ++destroyed; });
+    queue.push([in_queue]() {});
+    in_queue.reset();
+  }
+  EXPECT_EQ(4, destroyed);
+}
+
+// Each producer's callbacks run in the order that producer pushed them, and none are lost.
+TEST(PostCallbackQueueTest, ConcurrentProducers) {
+  constexpr int Producers = 8;
+  constexpr int PushesPerProducer = 10000;
+  PostCallbackQueue queue;
+  std::vector<int> next(Producers, 0);
+  bool in_order = true;
+
+  std::vector<std::thread> producers;
+  for (int producer = 0; producer < Producers; ++producer) {
+    producers.emplace_back([&, producer]() {
+      for (int i = 0; i < PushesPerProducer; ++i) {
+        queue.push([&, producer, i]() { in_order &= (next[producer]++ == i); });
+      }
+    });
+  }
+
+  int total = 0;
+  while (total < Producers * PushesPerProducer) {
+    PostCallbackQueue::Batch batch = queue.popAll();
+    while (!batch.empty()) {
+      batch.front()();
+      batch.popFront();
+      ++total;
+    }
+  }
+  for (std::thread& producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_TRUE(in_order);
+  EXPECT_THAT(next, testing::Each(PushesPerProducer));
+}
+
+} // namespace
+} // namespace Event
+} // namespace Envoy
@@ -1,6 +1,8 @@
 #include "common/http/header_map_impl.h"
 #include "common/http/headers.h"
 
+#include "test/test_common/test_runtime.h"
+
 #include "benchmark/benchmark.h"
 
 namespace Envoy {
@@ -295,5 +297,34 @@ static void headerMapImplRemovePrefix(benchmark::State& state) {
 }
 BENCHMARK(headerMapImplRemovePrefix)->Arg(0)->Arg(1)->Arg(5)->Arg(10)->Arg(50);
 
+/**
+ * Measure the full lifetime of a request header map with a varying number of headers: create,
+ * populate, iterate, look up, remove and destroy. The second benchmark argument selects whether
+ * list nodes are allocated from the per map arena.
+ */
+static void headerMapImplLifecycle(benchmark::State& state) {
+  TestScopedRuntime runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.header_map_node_arena", state.range(1) ? "true" : "false"}});
+  const LowerCaseString key("dummy-key-0");
+  size_t num_callbacks = 0;
+  auto counting_callback = [&num_callbacks](const HeaderEntry&) -> HeaderMap::Iterate {
+    num_callbacks++;
+    return HeaderMap::Iterate::Continue;
+  };
+  for (auto _ : state) { // NOLINT
+    auto headers = Http::RequestHeaderMapImpl::create();
+    headers->setReferenceMethod(Headers::get().MethodValues.Get);
+    headers->setReferencePath("/");
+    addDummyHeaders(*headers, state.range(0));
+    headers->iterate(counting_callback);
+    benchmark::DoNotOptimize(headers->get(key));
+    headers->remove(key);
+    benchmark::DoNotOptimize(headers->size());
+  }
+  benchmark::DoNotOptimize(num_callbacks);
+}
+BENCHMARK(headerMapImplLifecycle)->RangeMultiplier(4)->Ranges({{1, 64}, {0, 1}});
+
 } // namespace Http
 } // namespace Envoy
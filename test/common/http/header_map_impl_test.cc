@@ -360,23 +360,28 @@ Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::Request
 Http::RegisterCustomInlineHeader<Http::CustomInlineHeaderRegistry::Type::RequestHeaders>
     custom_header_1_copy(Http::LowerCaseString{"foo_custom_header"});
 
-class HeaderMapImplTest : public testing::TestWithParam<uint32_t> {
+class HeaderMapImplTest : public testing::TestWithParam<std::tuple<uint32_t, bool>> {
 public:
   HeaderMapImplTest() {
-    // Set the lazy map threshold using the test parameter.
+    // Set the lazy map threshold and the node arena usage using the test parameters.
     Runtime::LoaderSingleton::getExisting()->mergeValues(
-        {{"envoy.http.headermap.lazy_map_min_size", absl::StrCat(GetParam())}});
+        {{"envoy.http.headermap.lazy_map_min_size", absl::StrCat(std::get<0>(GetParam()))},
+         {"envoy.reloadable_features.header_map_node_arena",
+          std::get<1>(GetParam()) ? "true" : "false"}});
   }
 
-  static std::string testParamsToString(const ::testing::TestParamInfo<uint32_t>& params) {
-    return absl::StrCat(params.param);
+  static std::string
+  testParamsToString(const ::testing::TestParamInfo<std::tuple<uint32_t, bool>>& params) {
+    return absl::StrCat(std::get<0>(params.param), std::get<1>(params.param) ? "_arena" : "");
   }
 
   TestScopedRuntime runtime;
 };
 
 INSTANTIATE_TEST_SUITE_P(HeaderMapThreshold, HeaderMapImplTest,
-                         testing::Values(0, 1, std::numeric_limits<uint32_t>::max()),
+                         testing::Combine(testing::Values(0, 1,
+                                                          std::numeric_limits<uint32_t>::max()),
+                                          testing::Bool()),
                          HeaderMapImplTest::testParamsToString);
 
 // Make sure that the same header registered twice points to the same location.
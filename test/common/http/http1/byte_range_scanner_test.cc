@@ -0,0 +1,81 @@
+#include <random>
+#include <string>
+
+#include "common/http/http1/byte_range_scanner.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+using Implementation = ByteRangeScanner::Implementation;
+
+class ByteRangeScannerTest : public testing::TestWithParam<Implementation> {};
+
+std::string implementationToString(const testing::TestParamInfo<Implementation>& info) {
+  switch (info.param) {
+  case Implementation::Scalar:
+    return "Scalar";
+  case Implementation::Sse42:
+    return "Sse42";
+  case Implementation::Avx2:
+    return "Avx2";
+  }
+  return "Unknown";
+}
+
+INSTANTIATE_TEST_SUITE_P(Implementations, ByteRangeScannerTest,
+                         testing::Values(Implementation::Scalar, Implementation::Sse42,
+                                         Implementation::Avx2),
+                         implementationToString);
+
+TEST_P(ByteRangeScannerTest, Find) {
+  const ByteRangeScanner scanner({{0x00, 0x20}, {0x7f, 0x7f}}, GetParam());
+  EXPECT_TRUE(ByteRangeScanner::supported(scanner.implementation()));
+
+  EXPECT_EQ(0, scanner.find("", 0));
+  EXPECT_EQ(3, scanner.find("abc", 3));
+  EXPECT_EQ(3, scanner.find("abc def", 7));
+  EXPECT_EQ(0, scanner.find("\x7f", 1));
+
+  // Matches in every position of inputs spanning several vector widths.
+  for (size_t size = 1; size < 100; ++size) {
+    for (size_t position = 0; position < size; ++position) {
+      std::string input(size, 'x');
+      input[position] = '\n';
+      EXPECT_EQ(position, scanner.find(input.data(), input.size()));
+    }
+    const std::string no_match(size, 'x');
+    EXPECT_EQ(size, scanner.find(no_match.data(), no_match.size()));
+  }
+}
+
+TEST_P(ByteRangeScannerTest, MatchesScalar) {
+  const ByteRangeScanner scanner({{0x00, 0x08}, {0x0a, 0x1f}, {0x7f, 0x7f}}, GetParam());
+  const ByteRangeScanner scalar({{0x00, 0x08}, {0x0a, 0x1f}, {0x7f, 0x7f}},
+                                Implementation::Scalar);
+
+  std::mt19937 random(0);
+  for (uint32_t c = 0; c < 256; ++c) {
+    EXPECT_EQ(scalar.contains(c), scanner.contains(c));
+    // Each byte value, including those with the high bit set, behind a run of plain bytes.
+    std::string input(40, 'a');
+    input[37] = static_cast<char>(c);
+    EXPECT_EQ(scalar.find(input.data(), input.size()), scanner.find(input.data(), input.size()));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    std::string input(random() % 200, 0);
+    for (char& c : input) {
+      // Mostly printable bytes, as in real headers.
+      c = static_cast<char>(random() % 20 == 0 ? random() % 256 : 0x20 + random() % 0x5f);
+    }
+    EXPECT_EQ(scalar.find(input.data(), input.size()), scanner.find(input.data(), input.size()));
+  }
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -475,6 +475,56 @@ TEST_F(Http1ServerConnectionImplTest, ChunkedBody) {
   EXPECT_EQ(0U, buffer.length());
 }
 
+// Verify that the SIMD parser delivers the same headers and body when every callback is split
+// across single byte slices.
+TEST_F(Http1ServerConnectionImplTest, ChunkedBodySimdParserFragmentedBuffer) {
+  codec_settings_.use_simd_parser_ = true;
+  initialize();
+
+  InSequence sequence;
+
+  MockRequestDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+
+  TestRequestHeaderMapImpl expected_headers{
+      {":authority", "envoyproxy.io"},
+      {":path", "/hello?world=1"},
+      {":method", "POST"},
+      {"x-request-id", "d7ff9a4c-1e5f-4c0b-8b4e-5a6b7c8d9e0f"},
+      {"transfer-encoding", "chunked"},
+  };
+  EXPECT_CALL(decoder, decodeHeaders_(HeaderMapEqual(&expected_headers), false));
+  Buffer::OwnedImpl expected_data("Hello World");
+  EXPECT_CALL(decoder, decodeData(BufferEqual(&expected_data), false));
+  Buffer::OwnedImpl empty("");
+  EXPECT_CALL(decoder, decodeData(BufferEqual(&empty), true));
+
+  Buffer::OwnedImpl buffer = createBufferWithNByteSlices(
+      "POST /hello?world=1 HTTP/1.1\r\nHost: envoyproxy.io\r\n"
+      "X-Request-Id:  d7ff9a4c-1e5f-4c0b-8b4e-5a6b7c8d9e0f \r\ntransfer-encoding: chunked\r\n\r\n"
+      "6\r\nHello \r\n"
+      "5\r\nWorld\r\n"
+      "0\r\n\r\n",
+      1);
+  auto status = codec_->dispatch(buffer);
+  EXPECT_TRUE(status.ok());
+  EXPECT_EQ(0U, buffer.length());
+}
+
+// The SIMD parser rejects obsolete line folding rather than unfolding it.
+TEST_F(Http1ServerConnectionImplTest, SimdParserRejectsObsoleteLineFolding) {
+  codec_settings_.use_simd_parser_ = true;
+  initialize();
+
+  MockRequestDecoder decoder;
+  EXPECT_CALL(callbacks_, newStream(_, _)).WillOnce(ReturnRef(decoder));
+
+  Buffer::OwnedImpl buffer("GET / HTTP/1.1\r\nfoo: bar\r\n baz\r\n\r\n");
+  EXPECT_CALL(decoder, sendLocalReply(_, _, _, _, _, _));
+  auto status = codec_->dispatch(buffer);
+  EXPECT_TRUE(isCodecProtocolError(status));
+}
+
 // Verify dispatch behavior when dispatching an incomplete chunk, and resumption of the parse via a
 // second dispatch.
 TEST_F(Http1ServerConnectionImplTest, ChunkedBodySplitOverTwoDispatches) {
@@ -2517,6 +2567,30 @@ TEST_F(Http1ClientConnectionImplTest, ResponseWithTrailers) {
   EXPECT_TRUE(status.ok());
 }
 
+TEST_F(Http1ClientConnectionImplTest, ResponseWithTrailersSimdParser) {
+  codec_settings_.enable_trailers_ = true;
+  codec_settings_.use_simd_parser_ = true;
+  initialize();
+
+  NiceMock<MockResponseDecoder> response_decoder;
+  Http::RequestEncoder& request_encoder = codec_->newStream(response_decoder);
+  TestRequestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  EXPECT_TRUE(request_encoder.encodeHeaders(headers, true).ok());
+
+  TestResponseHeaderMapImpl expected_headers{{":status", "200"}, {"transfer-encoding", "chunked"}};
+  Buffer::OwnedImpl expected_data("Hello World");
+  TestResponseTrailerMapImpl expected_trailers{{"hello", "world"}, {"second", "header"}};
+  EXPECT_CALL(response_decoder, decodeHeaders_(HeaderMapEqual(&expected_headers), false));
+  EXPECT_CALL(response_decoder, decodeData(BufferEqual(&expected_data), false));
+  EXPECT_CALL(response_decoder, decodeTrailers_(HeaderMapEqual(&expected_trailers)));
+
+  Buffer::OwnedImpl response("HTTP/1.1 200 OK\r\ntransfer-encoding: chunked\r\n\r\nb\r\nHello "
+                             "World\r\n0\r\nhello: world\r\nsecond: header\r\n\r\n");
+  auto status = codec_->dispatch(response);
+  EXPECT_EQ(0UL, response.length());
+  EXPECT_TRUE(status.ok());
+}
+
 TEST_F(Http1ClientConnectionImplTest, GiantPath) {
   initialize();
 
@@ -0,0 +1,338 @@
+#include <string>
+#include <vector>
+
+#include "common/http/http1/legacy_parser_impl.h"
+#include "common/http/http1/simd_parser_impl.h"
+
+#include "absl/strings/str_cat.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Http {
+namespace Http1 {
+namespace {
+
+using testing::ElementsAre;
+
+// Records parser callbacks as a list of events. Consecutive data callbacks of the same kind are
+// merged so that the transcript does not depend on how the input was sliced.
+class RecordingCallbacks : public ParserCallbacks {
+public:
+  CallbackResult onMessageBegin() override {
+    record("begin");
+    return CallbackResult::Success;
+  }
+  CallbackResult onUrl(const char* data, size_t length) override {
+    recordData("url=", data, length);
+    return CallbackResult::Success;
+  }
+  CallbackResult onHeaderField(const char* data, size_t length) override {
+    recordData("field=", data, length);
+    return CallbackResult::Success;
+  }
+  CallbackResult onHeaderValue(const char* data, size_t length) override {
+    recordData("value=", data, length);
+    return CallbackResult::Success;
+  }
+  CallbackResult onHeadersComplete() override {
+    record("headers_complete");
+    if (pause_on_headers_complete_) {
+      parser_->pause();
+    }
+    return headers_complete_result_;
+  }
+  void bufferBody(const char* data, size_t length) override { recordData("body=", data, length); }
+  CallbackResult onMessageComplete() override {
+    record("message_complete");
+    if (pause_on_message_complete_) {
+      parser_->pause();
+    }
+    return CallbackResult::Success;
+  }
+  void onChunkHeader(bool is_final_chunk) override {
+    record(is_final_chunk ? "final_chunk" : "chunk");
+  }
+
+  void record(absl::string_view event) {
+    events_.emplace_back(event);
+    last_data_prefix_.clear();
+  }
+  void recordData(absl::string_view prefix, const char* data, size_t length) {
+    if (last_data_prefix_ != prefix) {
+      events_.emplace_back(prefix);
+      last_data_prefix_ = std::string(prefix);
+    }
+    events_.back().append(data, length);
+  }
+
+  Parser* parser_{};
+  std::vector<std::string> events_;
+  std::string last_data_prefix_;
+  CallbackResult headers_complete_result_{CallbackResult::Success};
+  bool pause_on_headers_complete_{};
+  bool pause_on_message_complete_{};
+};
+
+class ParserImplTest : public testing::TestWithParam<ParserType> {
+protected:
+  void createParser(MessageType type) {
+    switch (GetParam()) {
+    case ParserType::Legacy:
+      parser_ = std::make_unique<LegacyHttpParserImpl>(type, &callbacks_);
+      break;
+    case ParserType::Simd:
+      parser_ = std::make_unique<SimdHttpParserImpl>(type, &callbacks_);
+      break;
+    }
+    callbacks_.parser_ = parser_.get();
+  }
+
+  // Parses the whole input, resuming the parser whenever it pauses.
+  size_t parseAll(absl::string_view input) {
+    size_t consumed = 0;
+    while (consumed < input.size() && parser_->getStatus() != ParserStatus::Error) {
+      parser_->resume();
+      const size_t rc = parser_->execute(input.data() + consumed, input.size() - consumed);
+      consumed += rc;
+      if (rc == 0 && parser_->getStatus() == ParserStatus::Ok) {
+        break;
+      }
+    }
+    return consumed;
+  }
+
+  // Parses the input one byte at a time.
+  void parseByteByByte(absl::string_view input) {
+    for (const char c : input) {
+      parser_->resume();
+      ASSERT_EQ(1, parser_->execute(&c, 1));
+      ASSERT_NE(ParserStatus::Error, parser_->getStatus());
+    }
+  }
+
+  RecordingCallbacks callbacks_;
+  ParserPtr parser_;
+};
+
+std::string parserTypeToString(const testing::TestParamInfo<ParserType>& info) {
+  return info.param == ParserType::Legacy ? "Legacy" : "Simd";
+}
+
+INSTANTIATE_TEST_SUITE_P(Parsers, ParserImplTest,
+                         testing::Values(ParserType::Legacy, ParserType::Simd),
+                         parserTypeToString);
+
+TEST_P(ParserImplTest, SimpleRequest) {
+  createParser(MessageType::Request);
+  const std::string request = "GET /foo?bar=baz HTTP/1.1\r\nHost: example.com\r\n"
+                              "User-Agent:  curl/7.64 \r\nEmpty:\r\n\r\n";
+  EXPECT_EQ(request.size(), parseAll(request));
+  EXPECT_NE(ParserStatus::Error, parser_->getStatus());
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url=/foo?bar=baz", "field=Host", "value=example.com",
+                          "field=User-Agent", "value=curl/7.64 ", "field=Empty", "value=",
+                          "headers_complete", "message_complete"));
+  EXPECT_EQ("GET", parser_->methodName());
+  EXPECT_TRUE(parser_->isHttp11());
+  EXPECT_FALSE(parser_->contentLength().has_value());
+  EXPECT_FALSE(parser_->isChunked());
+  EXPECT_FALSE(parser_->hasTransferEncoding());
+}
+
+TEST_P(ParserImplTest, RequestWithContentLength) {
+  createParser(MessageType::Request);
+  const std::string request = "POST / HTTP/1.0\r\nContent-Length: 5\r\n\r\nhello";
+  EXPECT_EQ(request.size(), parseAll(request));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url=/", "field=Content-Length", "value=5",
+                          "headers_complete", "body=hello", "message_complete"));
+  EXPECT_EQ("POST", parser_->methodName());
+  EXPECT_FALSE(parser_->isHttp11());
+  EXPECT_EQ(5, parser_->contentLength().value());
+}
+
+TEST_P(ParserImplTest, ChunkedRequestWithTrailers) {
+  createParser(MessageType::Request);
+  const std::string request = "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n"
+                              "5;ext=1\r\nhello\r\nA\r\n0123456789\r\n0\r\ntrailer: value\r\n\r\n";
+  EXPECT_EQ(request.size(), parseAll(request));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url=/", "field=Transfer-Encoding", "value=chunked",
+                          "headers_complete", "chunk", "body=hello", "chunk", "body=0123456789",
+                          "final_chunk", "field=trailer", "value=value", "message_complete"));
+  EXPECT_TRUE(parser_->isChunked());
+  EXPECT_TRUE(parser_->hasTransferEncoding());
+}
+
+TEST_P(ParserImplTest, Response) {
+  createParser(MessageType::Response);
+  const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 2\r\n\r\nok";
+  EXPECT_EQ(response.size(), parseAll(response));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "field=Content-Length", "value=2", "headers_complete",
+                          "body=ok", "message_complete"));
+  EXPECT_EQ(200, parser_->statusCode());
+}
+
+TEST_P(ParserImplTest, ResponseWithoutBody) {
+  createParser(MessageType::Response);
+  const std::string response = "HTTP/1.1 204 No Content\r\n\r\n";
+  EXPECT_EQ(response.size(), parseAll(response));
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "headers_complete", "message_complete"));
+  EXPECT_EQ(204, parser_->statusCode());
+}
+
+TEST_P(ParserImplTest, ResponseReadUntilEof) {
+  createParser(MessageType::Response);
+  const std::string response = "HTTP/1.1 200 OK\r\n\r\nuntil eof";
+  EXPECT_EQ(response.size(), parseAll(response));
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "headers_complete", "body=until eof"));
+  EXPECT_EQ(0, parser_->execute(nullptr, 0));
+  EXPECT_EQ(ParserStatus::Ok, parser_->getStatus());
+  EXPECT_EQ("message_complete", callbacks_.events_.back());
+}
+
+TEST_P(ParserImplTest, HeadersCompleteNoBody) {
+  // For example a response to a HEAD request.
+  createParser(MessageType::Response);
+  callbacks_.headers_complete_result_ = CallbackResult::NoBody;
+  const std::string response = "HTTP/1.1 200 OK\r\nContent-Length: 20\r\n\r\n";
+  EXPECT_EQ(response.size(), parseAll(response));
+  EXPECT_THAT(callbacks_.events_, ElementsAre("begin", "field=Content-Length", "value=20",
+                                              "headers_complete", "message_complete"));
+}
+
+TEST_P(ParserImplTest, PauseOnMessageComplete) {
+  createParser(MessageType::Request);
+  callbacks_.pause_on_message_complete_ = true;
+  const std::string first = "GET /first HTTP/1.1\r\n\r\n";
+  const std::string requests = first + "GET /second HTTP/1.1\r\n\r\n";
+
+  EXPECT_EQ(first.size(), parser_->execute(requests.data(), requests.size()));
+  EXPECT_EQ(ParserStatus::Paused, parser_->getStatus());
+  EXPECT_EQ(0, parser_->execute(requests.data() + first.size(), requests.size() - first.size()));
+
+  parser_->resume();
+  EXPECT_EQ(requests.size() - first.size(),
+            parser_->execute(requests.data() + first.size(), requests.size() - first.size()));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url=/first", "headers_complete", "message_complete", "begin",
+                          "url=/second", "headers_complete", "message_complete"));
+}
+
+TEST_P(ParserImplTest, PauseOnHeadersComplete) {
+  createParser(MessageType::Request);
+  callbacks_.pause_on_headers_complete_ = true;
+  const std::string request = "POST / HTTP/1.1\r\nContent-Length: 2\r\n\r\nhi";
+  EXPECT_EQ(request.size(), parseAll(request));
+  EXPECT_THAT(callbacks_.events_,
+              ElementsAre("begin", "url=/", "field=Content-Length", "value=2",
+                          "headers_complete", "body=hi", "message_complete"));
+}
+
+TEST_P(ParserImplTest, Upgrade) {
+  createParser(MessageType::Request);
+  callbacks_.headers_complete_result_ = CallbackResult::NoBodyData;
+  callbacks_.pause_on_message_complete_ = true;
+  const std::string headers = "GET / HTTP/1.1\r\nConnection: upgrade\r\nUpgrade: foo\r\n\r\n";
+  const std::string request = headers + "upgraded payload";
+  EXPECT_EQ(headers.size(), parser_->execute(request.data(), request.size()));
+  EXPECT_EQ(ParserStatus::Paused, parser_->getStatus());
+  EXPECT_EQ("message_complete", callbacks_.events_.back());
+}
+
+TEST_P(ParserImplTest, ByteByByte) {
+  const std::string request =
+      "POST /some/long/path?query=string HTTP/1.1\r\nHost: example.com\r\n"
+      "Transfer-Encoding: chunked\r\nX-Empty:\r\n\r\n4\r\nbody\r\n0\r\nx-trailer: t\r\n\r\n";
+  createParser(MessageType::Request);
+  EXPECT_EQ(request.size(), parseAll(request));
+  const std::vector<std::string> expected = callbacks_.events_;
+
+  callbacks_.events_.clear();
+  callbacks_.last_data_prefix_.clear();
+  createParser(MessageType::Request);
+  parseByteByByte(request);
+  EXPECT_EQ(expected, callbacks_.events_);
+}
+
+TEST_P(ParserImplTest, InvalidMethod) {
+  createParser(MessageType::Request);
+  parseAll("G@T / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_INVALID_METHOD", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, InvalidContentLength) {
+  createParser(MessageType::Request);
+  parseAll("POST / HTTP/1.1\r\nContent-Length: 1x\r\n\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_INVALID_CONTENT_LENGTH", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, DuplicateContentLength) {
+  createParser(MessageType::Request);
+  parseAll("POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_UNEXPECTED_CONTENT_LENGTH", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, InvalidChunkSize) {
+  createParser(MessageType::Request);
+  parseAll("POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_INVALID_CHUNK_SIZE", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, InvalidHeaderValue) {
+  createParser(MessageType::Request);
+  parseAll(absl::StrCat("GET / HTTP/1.1\r\nfoo: b", std::string(1, '\x01'), "r\r\n\r\n"));
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_INVALID_HEADER_TOKEN", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, EofInHeaders) {
+  createParser(MessageType::Request);
+  parseAll("GET / HTTP/1.1\r\nHost: ");
+  parser_->execute(nullptr, 0);
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_INVALID_EOF_STATE", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, DataAfterConnectionClose) {
+  createParser(MessageType::Request);
+  parseAll("GET / HTTP/1.1\r\nConnection: close\r\n\r\nGET / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_CLOSED_CONNECTION", parser_->errorMessage());
+}
+
+TEST_P(ParserImplTest, CallbackError) {
+  createParser(MessageType::Request);
+  callbacks_.headers_complete_result_ = CallbackResult::Error;
+  parseAll("GET / HTTP/1.1\r\n\r\n");
+  EXPECT_EQ(ParserStatus::Error, parser_->getStatus());
+  EXPECT_EQ("HPE_CB_headers_complete", parser_->errorMessage());
+}
+
+// Every scanner implementation supported by the CPU yields the same callbacks.
+TEST(SimdHttpParserImplTest, AllScannerImplementations) {
+  const std::string request = absl::StrCat("GET /", std::string(100, 'a'), " HTTP/1.1\r\nfoo: ",
+                                           std::string(100, 'b'), "\r\n\r\n");
+  for (const auto implementation :
+       {ByteRangeScanner::Implementation::Scalar, ByteRangeScanner::Implementation::Sse42,
+        ByteRangeScanner::Implementation::Avx2}) {
+    RecordingCallbacks callbacks;
+    SimdHttpParserImpl parser(MessageType::Request, &callbacks, implementation);
+    EXPECT_EQ(request.size(), parser.execute(request.data(), request.size()));
+    EXPECT_THAT(callbacks.events_,
+                ElementsAre("begin", absl::StrCat("url=/", std::string(100, 'a')), "field=foo",
+                            absl::StrCat("value=", std::string(100, 'b')), "headers_complete",
+                            "message_complete"));
+  }
+}
+
+} // namespace
+} // namespace Http1
+} // namespace Http
+} // namespace Envoy
@@ -0,0 +1,309 @@
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "common/http/http2/shared_conn_pool.h"
+#include "common/stats/allocator_impl.h"
+#include "common/stats/symbol_table_impl.h"
+#include "common/stats/thread_local_store.h"
+#include "common/thread_local/thread_local_impl.h"
+
+#include "test/common/http/common.h"
+#include "test/mocks/http/conn_pool.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/stream_info/mocks.h"
+#include "test/mocks/upstream/host.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/mutex.h"
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Http {
+namespace Http2 {
+namespace {
+
+class MockCancellable : public ConnectionPool::Cancellable {
+public:
+  MOCK_METHOD(void, cancel, (Envoy::ConnectionPool::CancelPolicy cancel_policy));
+};
+
+class SharedConnPoolTest : public testing::Test {
+public:
+  SharedConnPoolTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        host_(std::make_shared<NiceMock<Upstream::MockHost>>()) {
+    tls_.registerThread(*dispatcher_, true);
+    thread_ = std::make_shared<SharedConnPoolThread>(
+        *api_, tls_,
+        [this](Event::Dispatcher&, Upstream::HostConstSharedPtr, Upstream::ResourcePriority,
+               const Network::ConnectionSocket::OptionsSharedPtr&,
+               const Network::TransportSocketOptionsSharedPtr&,
+               Upstream::ClusterConnectivityState&) {
+          auto pool = std::make_unique<NiceMock<ConnectionPool::MockInstance>>();
+          shared_pool_ = pool.get();
+          EXPECT_CALL(*shared_pool_, newStream(_, _))
+              .WillRepeatedly(Invoke([this](ResponseDecoder& decoder,
+                                            ConnectionPool::Callbacks& callbacks) {
+                shared_decoder_ = &decoder;
+                shared_callbacks_ = &callbacks;
+                absl::MutexLock lock(&mutex_);
+                new_streams_++;
+                new_stream_cond_.SignalAll();
+                return &handle_;
+              }));
+          return pool;
+        });
+    ON_CALL(shared_encoder_.stream_, bufferLimit()).WillByDefault(Return(1024));
+  }
+
+  ~SharedConnPoolTest() override {
+    // Destroys the shared pools while the mocks they use are alive.
+    tls_.shutdownGlobalThreading();
+    thread_->shutdown();
+    tls_.shutdownThread();
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  // Waits until the shared pool was asked for a number of streams.
+  void waitForNewStreams(int count) {
+    absl::MutexLock lock(&mutex_);
+    while (new_streams_ < count) {
+      new_stream_cond_.Wait(&mutex_);
+    }
+  }
+
+  // Runs a callback on the shared pool's thread and waits for it.
+  void runOnPoolThread(std::function<void()> callback) {
+    absl::Notification done;
+    thread_->dispatcher().post([&callback, &done]() {
+      callback();
+      done.Notify();
+    });
+    done.WaitForNotification();
+  }
+
+  // Runs the worker's event loop until the condition holds.
+  void runWorkerUntil(std::function<bool()> condition) {
+    for (int i = 0; i < 10000 && !condition(); i++) {
+      dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    ASSERT_TRUE(condition());
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(host_->cluster_.stats_store_, name)->value();
+  }
+
+  void readyStream(ConnPoolCallbacks& callbacks, int count = 1) {
+    waitForNewStreams(count);
+    EXPECT_CALL(callbacks.pool_ready_, ready());
+    runOnPoolThread([this]() {
+      shared_callbacks_->onPoolReady(shared_encoder_, host_, stream_info_, Protocol::Http2);
+    });
+    runWorkerUntil([&callbacks]() { return callbacks.outer_encoder_ != nullptr; });
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  ThreadLocal::InstanceImpl tls_;
+  std::shared_ptr<NiceMock<Upstream::MockHost>> host_;
+  SharedConnPoolThreadSharedPtr thread_;
+  // Accessed on the shared pool's thread.
+  NiceMock<ConnectionPool::MockInstance>* shared_pool_{};
+  ResponseDecoder* shared_decoder_{};
+  ConnectionPool::Callbacks* shared_callbacks_{};
+  NiceMock<MockRequestEncoder> shared_encoder_;
+  NiceMock<StreamInfo::MockStreamInfo> stream_info_;
+  NiceMock<MockCancellable> handle_;
+  absl::Mutex mutex_;
+  absl::CondVar new_stream_cond_;
+  int new_streams_ ABSL_GUARDED_BY(mutex_){};
+};
+
+// A request and its response are handed between the worker and the shared pool.
+TEST_F(SharedConnPoolTest, RequestResponse) {
+  auto pool = std::make_unique<SharedConnPoolImpl>(*dispatcher_, thread_, host_,
+                                                   Upstream::ResourcePriority::Default, nullptr,
+                                                   nullptr);
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, pool->newStream(decoder, callbacks));
+  EXPECT_TRUE(pool->hasActiveConnections());
+  readyStream(callbacks);
+  EXPECT_EQ(1024, callbacks.outer_encoder_->getStream().bufferLimit());
+
+  absl::Notification headers_encoded;
+  EXPECT_CALL(shared_encoder_, encodeHeaders(_, false))
+      .WillOnce(Invoke([](const RequestHeaderMap& headers, bool) -> Status {
+        EXPECT_EQ("/", headers.getPathValue());
+        return okStatus();
+      }));
+  EXPECT_CALL(shared_encoder_, encodeData(_, true))
+      .WillOnce(Invoke([&headers_encoded](Buffer::Instance& data, bool) {
+        EXPECT_EQ("body", data.toString());
+        headers_encoded.Notify();
+      }));
+  TestRequestHeaderMapImpl headers{{":method", "GET"}, {":path", "/"}, {":authority", "host"}};
+  EXPECT_TRUE(callbacks.outer_encoder_->encodeHeaders(headers, false).ok());
+  Buffer::OwnedImpl body("body");
+  callbacks.outer_encoder_->encodeData(body, true);
+  EXPECT_EQ(0, body.length());
+  headers_encoded.WaitForNotification();
+
+  bool response_done = false;
+  EXPECT_CALL(decoder, decodeHeaders_(_, false));
+  EXPECT_CALL(decoder, decodeData(_, true)).WillOnce(Invoke([&](Buffer::Instance& data, bool) {
+    EXPECT_EQ("response", data.toString());
+    response_done = true;
+  }));
+  EXPECT_CALL(shared_encoder_.stream_, removeCallbacks(_));
+  runOnPoolThread([this]() {
+    shared_decoder_->decodeHeaders(
+        ResponseHeaderMapPtr{new TestResponseHeaderMapImpl{{":status", "200"}}}, false);
+    Buffer::OwnedImpl response("response");
+    shared_decoder_->decodeData(response, true);
+  });
+  runWorkerUntil([&response_done]() { return response_done; });
+
+  EXPECT_FALSE(pool->hasActiveConnections());
+  ReadyWatcher drained;
+  EXPECT_CALL(drained, ready());
+  pool->addDrainedCallback([&drained]() { drained.ready(); });
+
+  EXPECT_EQ(1, counter("shared_http2_pool.rq_total"));
+  // Attaching, the stream, ready, request headers and body, and response headers and body.
+  EXPECT_EQ(7, counter("shared_http2_pool.cross_thread_hops"));
+
+  // The shared pool is drained once no worker uses it.
+  absl::Notification shared_pool_drained;
+  EXPECT_CALL(*shared_pool_, addDrainedCallback(_))
+      .WillOnce(Invoke([&shared_pool_drained](Envoy::ConnectionPool::Instance::DrainedCb cb) {
+        cb();
+        shared_pool_drained.Notify();
+      }));
+  pool.reset();
+  shared_pool_drained.WaitForNotification();
+}
+
+// Missing request headers fail on the worker, as they would with a pool of its own.
+TEST_F(SharedConnPoolTest, MissingRequiredHeaders) {
+  SharedConnPoolImpl pool(*dispatcher_, thread_, host_, Upstream::ResourcePriority::Default,
+                          nullptr, nullptr);
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  pool.newStream(decoder, callbacks);
+  readyStream(callbacks);
+
+  TestRequestHeaderMapImpl headers{{":method", "GET"}};
+  EXPECT_FALSE(callbacks.outer_encoder_->encodeHeaders(headers, true).ok());
+  callbacks.outer_encoder_->getStream().resetStream(StreamResetReason::LocalReset);
+  EXPECT_FALSE(pool.hasActiveConnections());
+}
+
+// Canceling a pending stream cancels it on the shared pool.
+TEST_F(SharedConnPoolTest, Cancel) {
+  SharedConnPoolImpl pool(*dispatcher_, thread_, host_, Upstream::ResourcePriority::Default,
+                          nullptr, nullptr);
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  ConnectionPool::Cancellable* handle = pool.newStream(decoder, callbacks);
+  waitForNewStreams(1);
+
+  absl::Notification canceled;
+  EXPECT_CALL(handle_, cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess))
+      .WillOnce(Invoke([&canceled](Envoy::ConnectionPool::CancelPolicy) { canceled.Notify(); }));
+  handle->cancel(Envoy::ConnectionPool::CancelPolicy::CloseExcess);
+  EXPECT_FALSE(pool.hasActiveConnections());
+  canceled.WaitForNotification();
+}
+
+// Pool failures and stream resets of the shared pool reach the worker.
+TEST_F(SharedConnPoolTest, FailureAndReset) {
+  SharedConnPoolImpl pool(*dispatcher_, thread_, host_, Upstream::ResourcePriority::Default,
+                          nullptr, nullptr);
+  NiceMock<MockResponseDecoder> decoder;
+  ConnPoolCallbacks callbacks;
+  pool.newStream(decoder, callbacks);
+  waitForNewStreams(1);
+
+  bool failed = false;
+  EXPECT_CALL(callbacks.pool_failure_, ready()).WillOnce(Invoke([&failed]() { failed = true; }));
+  runOnPoolThread([this]() {
+    shared_callbacks_->onPoolFailure(ConnectionPool::PoolFailureReason::Timeout, "", host_);
+  });
+  runWorkerUntil([&failed]() { return failed; });
+  EXPECT_EQ(ConnectionPool::PoolFailureReason::Timeout, callbacks.reason_);
+  EXPECT_FALSE(pool.hasActiveConnections());
+
+  ConnPoolCallbacks callbacks2;
+  pool.newStream(decoder, callbacks2);
+  readyStream(callbacks2, 2);
+  NiceMock<MockStreamCallbacks> stream_callbacks;
+  callbacks2.outer_encoder_->getStream().addCallbacks(stream_callbacks);
+
+  bool above_watermark = false;
+  EXPECT_CALL(stream_callbacks, onAboveWriteBufferHighWatermark())
+      .WillOnce(Invoke([&above_watermark]() { above_watermark = true; }));
+  runOnPoolThread([this]() { shared_encoder_.stream_.runHighWatermarkCallbacks(); });
+  runWorkerUntil([&above_watermark]() { return above_watermark; });
+
+  bool reset = false;
+  EXPECT_CALL(stream_callbacks, onResetStream(StreamResetReason::RemoteReset, _))
+      .WillOnce(Invoke([&reset](StreamResetReason, absl::string_view) { reset = true; }));
+  runOnPoolThread([this]() {
+    for (StreamCallbacks* callbacks : shared_encoder_.stream_.callbacks_) {
+      callbacks->onResetStream(StreamResetReason::RemoteReset, "");
+    }
+  });
+  runWorkerUntil([&reset]() { return reset; });
+  EXPECT_FALSE(pool.hasActiveConnections());
+}
+
+// The thread is registered for thread local storage, so the stats created lazily by the shared
+// pools land in its thread local cache, as they would on a worker.
+TEST(SharedConnPoolThreadTest, ThreadLocalStats) {
+  Api::ApiPtr api = Api::createApiForTest();
+  Event::DispatcherPtr dispatcher = api->allocateDispatcher("test_thread");
+  ThreadLocal::InstanceImpl tls;
+  Stats::SymbolTableImpl symbol_table;
+  Stats::AllocatorImpl alloc(symbol_table);
+  Stats::ThreadLocalStoreImpl store(alloc);
+
+  // This is the same order as InstanceImpl::initialize in source/server/server.cc.
+  auto thread = std::make_shared<SharedConnPoolThread>(*api, tls, nullptr);
+  tls.registerThread(*dispatcher, true);
+  store.initializeThreading(*dispatcher, tls);
+  Stats::ScopePtr scope = store.createScope("cluster.shared.");
+
+  absl::Notification done;
+  thread->post([&scope, &done]() {
+    scope->counterFromString("upstream_rq_total").inc();
+    scope->counterFromString("upstream_rq_total").inc();
+    done.Notify();
+  });
+  done.WaitForNotification();
+  EXPECT_EQ(2, TestUtility::findCounter(store, "cluster.shared.upstream_rq_total")->value());
+
+  // This is the same order as InstanceImpl::terminate in source/server/server.cc.
+  tls.shutdownGlobalThreading();
+  store.shutdownThreading();
+  thread->shutdown();
+  tls.shutdownThread();
+  scope.reset();
+  dispatcher->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+} // namespace
+} // namespace Http2
+} // namespace Http
+} // namespace Envoy
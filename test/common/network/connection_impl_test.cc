@@ -896,6 +896,166 @@ TEST_P(ConnectionImplTest, HalfClose) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+#if defined(__linux__)
+// Test that spliced data is moved between the connections in both directions, bypassing their
+// read filters, followed by the end of stream.
+TEST_P(ConnectionImplTest, Splice) {
+  setUpBasicConnection();
+  connect();
+
+  std::shared_ptr<MockReadFilter> client_read_filter(new NiceMock<MockReadFilter>());
+  client_connection_->enableHalfClose(true);
+  client_connection_->addReadFilter(client_read_filter);
+  server_connection_->enableHalfClose(true);
+
+  // Connect a second client, and splice its server connection with the first one.
+  NiceMock<MockConnectionCallbacks> client2_callbacks;
+  ClientConnectionPtr client2 = dispatcher_->createClientConnection(
+      socket_->addressProvider().localAddress(), source_address_,
+      Network::Test::createRawBufferSocket(), nullptr);
+  std::shared_ptr<MockReadFilter> client2_read_filter(new NiceMock<MockReadFilter>());
+  client2->addConnectionCallbacks(client2_callbacks);
+  client2->enableHalfClose(true);
+  client2->addReadFilter(client2_read_filter);
+  StreamInfo::StreamInfoImpl stream_info2(time_system_, nullptr);
+  std::shared_ptr<MockReadFilter> server2_read_filter(new NiceMock<MockReadFilter>());
+  NiceMock<MockConnectionCallbacks> server2_callbacks;
+  ServerConnectionPtr server2;
+  EXPECT_CALL(listener_callbacks_, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server2 = dispatcher_->createServerConnection(
+            std::move(socket), Network::Test::createRawBufferSocket(), stream_info2);
+        server2->addConnectionCallbacks(server2_callbacks);
+        server2->enableHalfClose(true);
+        server2->addReadFilter(server2_read_filter);
+        dispatcher_->exit();
+      }));
+  client2->connect();
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  // Only connection implementations can be spliced, and only once.
+  NiceMock<MockConnection> mock_connection;
+  EXPECT_FALSE(server_connection_->startSplice(mock_connection));
+  EXPECT_TRUE(server_connection_->startSplice(*server2));
+  EXPECT_FALSE(server2->startSplice(*server_connection_));
+
+  EXPECT_CALL(*read_filter_, onData(_, false)).Times(0);
+  EXPECT_CALL(*server2_read_filter, onData(_, false)).Times(0);
+
+  Buffer::OwnedImpl request("hello");
+  client_connection_->write(request, false);
+  EXPECT_CALL(*client2_read_filter, onData(BufferStringEqual("hello"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, bool) -> FilterStatus {
+        buffer.drain(buffer.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  Buffer::OwnedImpl response("world!");
+  client2->write(response, false);
+  EXPECT_CALL(*client_read_filter, onData(BufferStringEqual("world!"), false))
+      .WillOnce(Invoke([&](Buffer::Instance& buffer, bool) -> FilterStatus {
+        buffer.drain(buffer.length());
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  // The end of stream is still delivered to the read filters, which forward it.
+  EXPECT_CALL(*read_filter_, onData(BufferStringEqual(""), true))
+      .WillOnce(InvokeWithoutArgs([&]() -> FilterStatus {
+        Buffer::OwnedImpl empty_buffer;
+        server2->write(empty_buffer, true);
+        return FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(*client2_read_filter, onData(BufferStringEqual(""), true))
+      .WillOnce(InvokeWithoutArgs([&]() -> FilterStatus {
+        dispatcher_->exit();
+        return FilterStatus::StopIteration;
+      }));
+  Buffer::OwnedImpl empty_buffer;
+  client_connection_->write(empty_buffer, true);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(5, server_connection_->streamInfo().bytesReceived());
+  EXPECT_EQ(6, server_connection_->streamInfo().bytesSent());
+  EXPECT_EQ(6, server2->streamInfo().bytesReceived());
+  EXPECT_EQ(5, server2->streamInfo().bytesSent());
+
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  server2->close(ConnectionCloseType::NoFlush);
+  client2->close(ConnectionCloseType::NoFlush);
+  server_connection_->close(ConnectionCloseType::NoFlush);
+  client_connection_->close(ConnectionCloseType::NoFlush);
+}
+
+// Test that many small writes, totalling more than the size of the pipe, are all spliced. Each read
+// takes at least one of the buffers of the pipe, so the pipe can fill up before reaching its size.
+TEST_P(ConnectionImplTest, SpliceManySmallWrites) {
+  setUpBasicConnection();
+  connect();
+
+  NiceMock<MockConnectionCallbacks> client2_callbacks;
+  ClientConnectionPtr client2 = dispatcher_->createClientConnection(
+      socket_->addressProvider().localAddress(), source_address_,
+      Network::Test::createRawBufferSocket(), nullptr);
+  std::shared_ptr<MockReadFilter> client2_read_filter(new NiceMock<MockReadFilter>());
+  client2->addConnectionCallbacks(client2_callbacks);
+  client2->addReadFilter(client2_read_filter);
+  StreamInfo::StreamInfoImpl stream_info2(time_system_, nullptr);
+  ServerConnectionPtr server2;
+  EXPECT_CALL(listener_callbacks_, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server2 = dispatcher_->createServerConnection(
+            std::move(socket), Network::Test::createRawBufferSocket(), stream_info2);
+        dispatcher_->exit();
+      }));
+  client2->connect();
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  // The pipe to server2 is a single page, which holds a single buffer.
+  server2->setBufferLimits(4096);
+  EXPECT_TRUE(server_connection_->startSplice(*server2));
+
+  // The writes are queued in the socket while reading is disabled, so that they are spliced
+  // together.
+  constexpr uint64_t num_writes = 64;
+  constexpr uint64_t write_size = 128;
+  server_connection_->readDisable(true);
+  client_connection_->noDelay(true);
+  for (uint64_t i = 0; i < num_writes; ++i) {
+    Buffer::OwnedImpl data(std::string(write_size, 'a'));
+    client_connection_->write(data, false);
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+  }
+
+  uint64_t bytes_received = 0;
+  EXPECT_CALL(*client2_read_filter, onData(_, false))
+      .WillRepeatedly(Invoke([&](Buffer::Instance& buffer, bool) -> FilterStatus {
+        bytes_received += buffer.length();
+        buffer.drain(buffer.length());
+        if (bytes_received == num_writes * write_size) {
+          dispatcher_->exit();
+        }
+        return FilterStatus::StopIteration;
+      }));
+  server_connection_->readDisable(false);
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+  EXPECT_EQ(num_writes * write_size, server_connection_->streamInfo().bytesReceived());
+  EXPECT_EQ(num_writes * write_size, server2->streamInfo().bytesSent());
+
+  EXPECT_CALL(server_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  EXPECT_CALL(client_callbacks_, onEvent(ConnectionEvent::LocalClose));
+  server2->close(ConnectionCloseType::NoFlush);
+  client2->close(ConnectionCloseType::NoFlush);
+  server_connection_->close(ConnectionCloseType::NoFlush);
+  client_connection_->close(ConnectionCloseType::NoFlush);
+}
+#endif
+
 // Test that connections do not detect early close when half-close is enabled
 TEST_P(ConnectionImplTest, HalfCloseNoEarlyCloseDetection) {
   setUpBasicConnection();
@@ -0,0 +1,325 @@
+#include <chrono>
+#include <list>
+#include <memory>
+#include <string>
+
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+
+#include "common/network/dns_resolver_cache_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class DnsResolverCacheImplTest : public testing::Test, public Event::TestUsingSimulatedTime {
+public:
+  // The outcome of a resolution through the cache.
+  struct Result {
+    bool called_{};
+    DnsResolver::ResolutionStatus status_{};
+    std::list<DnsResponse> responses_;
+  };
+
+  ~DnsResolverCacheImplTest() override {
+    cache_.reset();
+    EXPECT_EQ(0, TestUtility::findGauge(store_, "dns_resolver_cache.entries")->value());
+  }
+
+  void initialize() {
+    cache_ = std::make_unique<DnsResolverCacheImpl>(resolver_, dispatcher_, store_, config_);
+  }
+
+  ActiveDnsQuery* resolve(const std::string& dns_name, Result& result) {
+    return cache_->resolve(dns_name, DnsLookupFamily::V4Only,
+                           [&result](DnsResolver::ResolutionStatus status,
+                                     std::list<DnsResponse>&& responses) -> void {
+                             EXPECT_FALSE(result.called_);
+                             result.called_ = true;
+                             result.status_ = status;
+                             result.responses_ = std::move(responses);
+                           });
+  }
+
+  // Expects a resolution by the wrapped resolver, whose callback is saved to resolve_cb_.
+  void expectResolution(const std::string& dns_name) {
+    EXPECT_CALL(*resolver_, resolve(dns_name, DnsLookupFamily::V4Only, _))
+        .WillOnce(DoAll(SaveArg<2>(&resolve_cb_), Return(&resolver_->active_query_)));
+  }
+
+  void checkResult(const Result& result, const std::string& address, uint64_t ttl) {
+    EXPECT_TRUE(result.called_);
+    EXPECT_EQ(DnsResolver::ResolutionStatus::Success, result.status_);
+    ASSERT_EQ(1, result.responses_.size());
+    EXPECT_EQ(address, result.responses_.front().address_->ip()->addressAsString());
+    EXPECT_EQ(std::chrono::seconds(ttl), result.responses_.front().ttl_);
+  }
+
+  void checkStats(uint64_t hit, uint64_t miss, uint64_t negative_hit, uint64_t coalesced,
+                  uint64_t prefetch, uint64_t eviction, uint64_t entries) {
+    const auto counter_value = [this](const std::string& name) {
+      return TestUtility::findCounter(store_, "dns_resolver_cache." + name)->value();
+    };
+
+    EXPECT_EQ(hit, counter_value("hit"));
+    EXPECT_EQ(miss, counter_value("miss"));
+    EXPECT_EQ(negative_hit, counter_value("negative_hit"));
+    EXPECT_EQ(coalesced, counter_value("coalesced"));
+    EXPECT_EQ(prefetch, counter_value("prefetch"));
+    EXPECT_EQ(eviction, counter_value("eviction"));
+    EXPECT_EQ(entries, TestUtility::findGauge(store_, "dns_resolver_cache.entries")->value());
+  }
+
+  envoy::config::bootstrap::v3::DnsResolverCache config_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  std::shared_ptr<MockDnsResolver> resolver_{std::make_shared<MockDnsResolver>()};
+  Stats::IsolatedStoreImpl store_;
+  std::unique_ptr<DnsResolverCacheImpl> cache_;
+  DnsResolver::ResolveCb resolve_cb_;
+};
+
+// A name is resolved from the cache for the TTL of its records.
+TEST_F(DnsResolverCacheImplTest, Hit) {
+  initialize();
+
+  Result result1;
+  expectResolution("foo.com");
+  EXPECT_NE(nullptr, resolve("foo.com", result1));
+  EXPECT_FALSE(result1.called_);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  checkResult(result1, "10.0.0.1", 60);
+  checkStats(0 /* hit */, 1 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+
+  // The TTL is the time left before the name expires.
+  simTime().advanceTimeWait(std::chrono::seconds(20));
+  Result result2;
+  EXPECT_EQ(nullptr, resolve("foo.com", result2));
+  checkResult(result2, "10.0.0.1", 40);
+  checkStats(1 /* hit */, 1 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+
+  // The name expired.
+  simTime().advanceTimeWait(std::chrono::seconds(40));
+  Result result3;
+  expectResolution("foo.com");
+  EXPECT_NE(nullptr, resolve("foo.com", result3));
+  checkStats(1 /* hit */, 2 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 0 /* entries */);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.2"}, std::chrono::seconds(60)));
+  checkResult(result3, "10.0.0.2", 60);
+}
+
+// The TTL of the records is bounded by max_ttl, and records without a TTL aren't cached.
+TEST_F(DnsResolverCacheImplTest, Ttl) {
+  config_.mutable_max_ttl()->set_seconds(10);
+  initialize();
+
+  Result result1;
+  expectResolution("foo.com");
+  resolve("foo.com", result1);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  Result result2;
+  EXPECT_EQ(nullptr, resolve("foo.com", result2));
+  checkResult(result2, "10.0.0.1", 10);
+
+  Result result3;
+  expectResolution("bar.com");
+  resolve("bar.com", result3);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success, TestUtility::makeDnsResponse({"10.0.0.2"}));
+  checkResult(result3, "10.0.0.2", 0);
+  Result result4;
+  expectResolution("bar.com");
+  EXPECT_NE(nullptr, resolve("bar.com", result4));
+  checkStats(1 /* hit */, 3 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+}
+
+// Failures are cached for negative_ttl.
+TEST_F(DnsResolverCacheImplTest, NegativeHit) {
+  initialize();
+
+  Result result1;
+  expectResolution("foo.com");
+  resolve("foo.com", result1);
+  resolve_cb_(DnsResolver::ResolutionStatus::Failure, {});
+  EXPECT_TRUE(result1.called_);
+  EXPECT_EQ(DnsResolver::ResolutionStatus::Failure, result1.status_);
+
+  Result result2;
+  EXPECT_EQ(nullptr, resolve("foo.com", result2));
+  EXPECT_TRUE(result2.called_);
+  EXPECT_EQ(DnsResolver::ResolutionStatus::Failure, result2.status_);
+  EXPECT_TRUE(result2.responses_.empty());
+  checkStats(0 /* hit */, 1 /* miss */, 1 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+
+  simTime().advanceTimeWait(std::chrono::seconds(5));
+  Result result3;
+  expectResolution("foo.com");
+  EXPECT_NE(nullptr, resolve("foo.com", result3));
+}
+
+// Failures aren't cached with a negative_ttl of 0.
+TEST_F(DnsResolverCacheImplTest, NegativeCachingDisabled) {
+  config_.mutable_negative_ttl();
+  initialize();
+
+  Result result1;
+  expectResolution("foo.com");
+  resolve("foo.com", result1);
+  resolve_cb_(DnsResolver::ResolutionStatus::Failure, {});
+
+  Result result2;
+  expectResolution("foo.com");
+  EXPECT_NE(nullptr, resolve("foo.com", result2));
+  checkStats(0 /* hit */, 2 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 0 /* entries */);
+}
+
+// Concurrent resolutions of a name are merged.
+TEST_F(DnsResolverCacheImplTest, Coalesced) {
+  initialize();
+
+  Result result1, result2, result3;
+  expectResolution("foo.com");
+  EXPECT_NE(nullptr, resolve("foo.com", result1));
+  ActiveDnsQuery* query2 = resolve("foo.com", result2);
+  EXPECT_NE(nullptr, query2);
+  EXPECT_NE(nullptr, resolve("foo.com", result3));
+  checkStats(0 /* hit */, 3 /* miss */, 0 /* negative hit */, 2 /* coalesced */, 0 /* prefetch */,
+             0 /* eviction */, 0 /* entries */);
+
+  query2->cancel();
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  checkResult(result1, "10.0.0.1", 60);
+  EXPECT_FALSE(result2.called_);
+  checkResult(result3, "10.0.0.1", 60);
+}
+
+// A name resolved in the last tenth of its TTL is resolved again in the background.
+TEST_F(DnsResolverCacheImplTest, Prefetch) {
+  config_.set_prefetch(true);
+  initialize();
+
+  Result result1;
+  expectResolution("foo.com");
+  resolve("foo.com", result1);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(100)));
+
+  simTime().advanceTimeWait(std::chrono::seconds(89));
+  Result result2;
+  EXPECT_EQ(nullptr, resolve("foo.com", result2));
+  checkResult(result2, "10.0.0.1", 11);
+
+  simTime().advanceTimeWait(std::chrono::seconds(1));
+  Result result3, result4;
+  expectResolution("foo.com");
+  EXPECT_EQ(nullptr, resolve("foo.com", result3));
+  checkResult(result3, "10.0.0.1", 10);
+  // A single prefetch is in flight.
+  EXPECT_EQ(nullptr, resolve("foo.com", result4));
+  checkResult(result4, "10.0.0.1", 10);
+  checkStats(3 /* hit */, 1 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 1 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+
+  // A failed prefetch doesn't drop the name.
+  resolve_cb_(DnsResolver::ResolutionStatus::Failure, {});
+  Result result5;
+  expectResolution("foo.com");
+  EXPECT_EQ(nullptr, resolve("foo.com", result5));
+  checkResult(result5, "10.0.0.1", 10);
+
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.2"}, std::chrono::seconds(100)));
+  Result result6;
+  EXPECT_EQ(nullptr, resolve("foo.com", result6));
+  checkResult(result6, "10.0.0.2", 100);
+  checkStats(5 /* hit */, 1 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 2 /* prefetch */,
+             0 /* eviction */, 1 /* entries */);
+}
+
+// The least recently used names are dropped beyond max_entries.
+TEST_F(DnsResolverCacheImplTest, Eviction) {
+  config_.mutable_max_entries()->set_value(2);
+  initialize();
+
+  for (const std::string& name : {"a.com", "b.com"}) {
+    Result result;
+    expectResolution(name);
+    resolve(name, result);
+    resolve_cb_(DnsResolver::ResolutionStatus::Success,
+                TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  }
+  Result result1;
+  EXPECT_EQ(nullptr, resolve("a.com", result1));
+
+  Result result2;
+  expectResolution("c.com");
+  resolve("c.com", result2);
+  resolve_cb_(DnsResolver::ResolutionStatus::Success,
+              TestUtility::makeDnsResponse({"10.0.0.1"}, std::chrono::seconds(60)));
+  checkStats(1 /* hit */, 3 /* miss */, 0 /* negative hit */, 0 /* coalesced */, 0 /* prefetch */,
+             1 /* eviction */, 2 /* entries */);
+
+  Result result3;
+  EXPECT_EQ(nullptr, resolve("a.com", result3));
+  Result result4;
+  expectResolution("b.com");
+  EXPECT_NE(nullptr, resolve("b.com", result4));
+}
+
+// The wrapped resolver may resolve a name synchronously.
+TEST_F(DnsResolverCacheImplTest, SynchronousResolution) {
+  initialize();
+
+  EXPECT_CALL(*resolver_, resolve("localhost", DnsLookupFamily::V4Only, _))
+      .WillOnce(Invoke([](const std::string&, DnsLookupFamily,
+                          DnsResolver::ResolveCb callback) -> ActiveDnsQuery* {
+        callback(DnsResolver::ResolutionStatus::Success,
+                 TestUtility::makeDnsResponse({"127.0.0.1"}, std::chrono::seconds(60)));
+        return nullptr;
+      }));
+  Result result1;
+  EXPECT_EQ(nullptr, resolve("localhost", result1));
+  checkResult(result1, "127.0.0.1", 60);
+
+  Result result2;
+  EXPECT_EQ(nullptr, resolve("localhost", result2));
+  checkResult(result2, "127.0.0.1", 60);
+}
+
+// The resolutions in flight are canceled when the cache is destroyed.
+TEST_F(DnsResolverCacheImplTest, CancelOnDestruction) {
+  initialize();
+
+  Result result;
+  expectResolution("foo.com");
+  resolve("foo.com", result);
+  EXPECT_CALL(resolver_->active_query_, cancel());
+  cache_.reset();
+  EXPECT_FALSE(result.called_);
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
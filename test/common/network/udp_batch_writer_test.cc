@@ -0,0 +1,256 @@
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#include "common/api/os_sys_calls_impl.h"
+#include "common/buffer/buffer_impl.h"
+#include "common/network/address_impl.h"
+#include "common/network/socket_impl.h"
+#include "common/network/udp_batch_writer.h"
+
+#include "test/mocks/api/mocks.h"
+#include "test/mocks/network/io_handle.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/network_utility.h"
+#include "test/test_common/threadsafe_singleton_injector.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+
+namespace Envoy {
+namespace Network {
+namespace {
+
+class UdpBatchWriterIntegrationTest : public testing::TestWithParam<Address::IpVersion> {};
+
+INSTANTIATE_TEST_SUITE_P(IpVersions, UdpBatchWriterIntegrationTest,
+                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                         TestUtility::ipTestParamsToString);
+
+// Datagrams of mixed sizes are all delivered, in order, after a flush.
+TEST_P(UdpBatchWriterIntegrationTest, SendsBufferedDatagrams) {
+  Test::UdpSyncPeer peer(GetParam());
+  SocketImpl socket(Socket::Type::Datagram, peer.localAddress(), nullptr);
+  UdpBatchWriter writer(socket.ioHandle(), 64);
+
+  const std::vector<std::string> payloads{"aaaa", "bbbb", "cccc", "dd", "eeeeee"};
+  for (const std::string& payload : payloads) {
+    Buffer::OwnedImpl buffer(payload);
+    const Api::IoCallUint64Result result =
+        writer.writePacket(buffer, nullptr, *peer.localAddress());
+    EXPECT_TRUE(result.ok());
+    EXPECT_EQ(payload.size(), result.rc_);
+  }
+  EXPECT_EQ(payloads.size(), writer.bufferedDatagrams());
+
+  const Api::IoCallUint64Result result = writer.flush();
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(20, result.rc_);
+  EXPECT_EQ(0, writer.bufferedDatagrams());
+
+  for (const std::string& payload : payloads) {
+    UdpRecvData datagram;
+    peer.recv(datagram);
+    EXPECT_EQ(payload, datagram.buffer_->toString());
+  }
+}
+
+class OverrideOsSysCallsImpl : public Api::MockOsSysCalls {
+public:
+  MOCK_METHOD(bool, supportsUdpGso, (), (const));
+};
+
+class UdpBatchWriterTest : public testing::Test {
+public:
+  UdpBatchWriterTest()
+      : peer_("10.0.0.1", 1000), other_peer_("10.0.0.2", 1000), local_ip_("10.0.0.3") {
+    ON_CALL(io_handle_, fdDoNotUse()).WillByDefault(Return(42));
+  }
+
+  void createWriter(bool gso, uint32_t max_buffered_datagrams = 64) {
+    EXPECT_CALL(os_sys_calls_, supportsUdpGso()).WillOnce(Return(gso));
+    writer_ = std::make_unique<UdpBatchWriter>(io_handle_, max_buffered_datagrams);
+  }
+
+  void write(const std::string& payload, const Address::Instance& peer,
+             const Address::Ip* local_ip = nullptr) {
+    Buffer::OwnedImpl buffer(payload);
+    EXPECT_TRUE(writer_->writePacket(buffer, local_ip, peer).ok());
+  }
+
+  static std::string messagePayload(const msghdr& message) {
+    std::string payload;
+    for (size_t i = 0; i < message.msg_iovlen; i++) {
+      payload.append(static_cast<const char*>(message.msg_iov[i].iov_base),
+                     message.msg_iov[i].iov_len);
+    }
+    return payload;
+  }
+
+  // Returns the data of the control message of the given type, or nullptr.
+  static const cmsghdr* controlMessage(msghdr& message, int level, int type) {
+    if (message.msg_control == nullptr) {
+      return nullptr;
+    }
+    for (cmsghdr* cmsg = CMSG_FIRSTHDR(&message); cmsg != nullptr;
+         cmsg = CMSG_NXTHDR(&message, cmsg)) {
+      if (cmsg->cmsg_level == level && cmsg->cmsg_type == type) {
+        return cmsg;
+      }
+    }
+    return nullptr;
+  }
+
+  static uint16_t segmentSize(msghdr& message) {
+    const cmsghdr* cmsg = controlMessage(message, SOL_UDP, UDP_SEGMENT);
+    if (cmsg == nullptr) {
+      return 0;
+    }
+    uint16_t segment_size;
+    memcpy(&segment_size, CMSG_DATA(cmsg), sizeof(segment_size));
+    return segment_size;
+  }
+
+  // Completes every message in a sendmmsg() call.
+  static Api::SysCallIntResult sendAll(os_fd_t, mmsghdr* messages, unsigned int count, int) {
+    for (unsigned int i = 0; i < count; i++) {
+      messages[i].msg_len = messagePayload(messages[i].msg_hdr).size();
+    }
+    return {static_cast<int>(count), 0};
+  }
+
+  NiceMock<OverrideOsSysCallsImpl> os_sys_calls_;
+  TestThreadsafeSingletonInjector<Api::OsSysCallsImpl> os_calls_{&os_sys_calls_};
+  NiceMock<MockIoHandle> io_handle_;
+  const Address::Ipv4Instance peer_;
+  const Address::Ipv4Instance other_peer_;
+  const Address::Ipv4Instance local_ip_;
+  std::unique_ptr<UdpBatchWriter> writer_;
+};
+
+// Runs of datagrams of the same size to the same peer are sent as one GSO message, and all
+// messages are sent with a single sendmmsg() call.
+TEST_F(UdpBatchWriterTest, CoalescesSegments) {
+  createWriter(true);
+  write("aaaa", peer_);
+  write("bbbb", peer_);
+  write("cccc", peer_);
+  // The last segment may be shorter.
+  write("dd", peer_);
+  // A shorter datagram ends the run.
+  write("eeee", peer_);
+  write("ffff", other_peer_);
+  write("gggg", other_peer_, local_ip_.ip());
+
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 4, 0))
+      .WillOnce(Invoke([](os_fd_t fd, mmsghdr* messages, unsigned int count, int flags) {
+        EXPECT_EQ("aaaabbbbccccdd", messagePayload(messages[0].msg_hdr));
+        EXPECT_EQ(4, segmentSize(messages[0].msg_hdr));
+        EXPECT_EQ("eeee", messagePayload(messages[1].msg_hdr));
+        EXPECT_EQ(nullptr, messages[1].msg_hdr.msg_control);
+        EXPECT_EQ("ffff", messagePayload(messages[2].msg_hdr));
+        // A different source IP also ends the run.
+        EXPECT_EQ("gggg", messagePayload(messages[3].msg_hdr));
+        EXPECT_EQ(0, segmentSize(messages[3].msg_hdr));
+        EXPECT_NE(nullptr, controlMessage(messages[3].msg_hdr, IPPROTO_IP, IP_PKTINFO));
+        return sendAll(fd, messages, count, flags);
+      }));
+  const Api::IoCallUint64Result result = writer_->flush();
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(26, result.rc_);
+  EXPECT_EQ(0, writer_->bufferedDatagrams());
+
+  // Nothing is sent if nothing is buffered.
+  EXPECT_TRUE(writer_->flush().ok());
+}
+
+// Without GSO every datagram is a message of its own.
+TEST_F(UdpBatchWriterTest, NoGso) {
+  createWriter(false);
+  write("aaaa", peer_);
+  write("bbbb", peer_);
+
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0))
+      .WillOnce(Invoke([](os_fd_t fd, mmsghdr* messages, unsigned int count, int flags) {
+        EXPECT_EQ("aaaa", messagePayload(messages[0].msg_hdr));
+        EXPECT_EQ("bbbb", messagePayload(messages[1].msg_hdr));
+        return sendAll(fd, messages, count, flags);
+      }));
+  EXPECT_TRUE(writer_->flush().ok());
+}
+
+// Once the kernel rejects a GSO message, the datagrams are sent individually.
+TEST_F(UdpBatchWriterTest, GsoNotSupportedByRoute) {
+  createWriter(true);
+  write("aaaa", peer_);
+  write("bbbb", peer_);
+
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 1, 0))
+      .WillOnce(Return(Api::SysCallIntResult{-1, EIO}));
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0)).WillOnce(Invoke(sendAll));
+  const Api::IoCallUint64Result result = writer_->flush();
+  EXPECT_TRUE(result.ok());
+  EXPECT_EQ(8, result.rc_);
+
+  write("cccc", peer_);
+  write("dddd", peer_);
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0)).WillOnce(Invoke(sendAll));
+  EXPECT_TRUE(writer_->flush().ok());
+}
+
+// A failing message doesn't prevent the following ones from being sent.
+TEST_F(UdpBatchWriterTest, MessageError) {
+  createWriter(false);
+  write("aaaa", peer_);
+  write("bbbb", other_peer_);
+  write("cccc", peer_);
+
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 3, 0))
+      .WillOnce(Invoke([](os_fd_t, mmsghdr* messages, unsigned int, int) {
+        messages[0].msg_len = 4;
+        return Api::SysCallIntResult{1, 0};
+      }));
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0))
+      .WillOnce(Return(Api::SysCallIntResult{-1, ECONNREFUSED}));
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 1, 0)).WillOnce(Invoke(sendAll));
+  const Api::IoCallUint64Result result = writer_->flush();
+  EXPECT_FALSE(result.ok());
+  EXPECT_EQ(8, result.rc_);
+  EXPECT_FALSE(writer_->isWriteBlocked());
+}
+
+// Datagrams which don't fit in the socket's send buffer are dropped.
+TEST_F(UdpBatchWriterTest, WriteBlocked) {
+  createWriter(false);
+  write("aaaa", peer_);
+  write("bbbb", peer_);
+
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0))
+      .WillOnce(Return(Api::SysCallIntResult{-1, EAGAIN}));
+  const Api::IoCallUint64Result result = writer_->flush();
+  EXPECT_EQ(Api::IoError::IoErrorCode::Again, result.err_->getErrorCode());
+  EXPECT_TRUE(writer_->isWriteBlocked());
+  EXPECT_EQ(0, writer_->bufferedDatagrams());
+
+  writer_->setWritable();
+  EXPECT_FALSE(writer_->isWriteBlocked());
+}
+
+// The batch is sent without waiting for a flush once it is full.
+TEST_F(UdpBatchWriterTest, FlushWhenFull) {
+  createWriter(false, 2);
+  write("aaaa", peer_);
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0)).WillOnce(Invoke(sendAll));
+  write("bbbb", peer_);
+  EXPECT_EQ(0, writer_->bufferedDatagrams());
+}
+
+} // namespace
+} // namespace Network
+} // namespace Envoy
@@ -60,7 +60,7 @@ public:
     server_socket_->addOptions(SocketOptionFactory::buildIpPacketInfoOptions());
     server_socket_->addOptions(SocketOptionFactory::buildRxQueueOverFlowOptions());
     if (Api::OsSysCallsSingleton::get().supportsUdpGro()) {
-      server_socket_->addOptions(SocketOptionFactory::buildUdpGroOptions());
+      server_socket_->addOptions(SocketOptionFactory::buildUdpGroOptions(true));
     }
     listener_ = std::make_unique<UdpListenerImpl>(
         dispatcherImpl(), server_socket_, listener_callbacks_, dispatcherImpl().timeSource());
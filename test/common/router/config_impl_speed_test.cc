@@ -39,12 +39,14 @@ static Http::TestRequestHeaderMapImpl genRequestHeaders(int route_num) {
  * Generates the route config for the type of matcher being tested.
  */
 static RouteConfiguration genRouteConfig(benchmark::State& state,
-                                         RouteMatch::PathSpecifierCase match_type) {
+                                         RouteMatch::PathSpecifierCase match_type,
+                                         bool compile_path_matchers) {
   // Create the base route config.
   RouteConfiguration route_config;
   VirtualHost* v_host = route_config.add_virtual_hosts();
   v_host->set_name("default");
   v_host->add_domains("*");
+  v_host->set_compile_path_matchers(compile_path_matchers);
 
   // Create `n` regex routes. The last route will be the only one matched.
   for (int i = 0; i < state.range(0); ++i) {
@@ -85,7 +87,8 @@ static RouteConfiguration genRouteConfig(benchmark::State& state,
  * We then time how long it takes for the request to be matched against the
  * last route.
  */
-static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type) {
+static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierCase match_type,
+                             bool compile_path_matchers = false) {
   // Setup router for benchmarking.
   Api::ApiPtr api = Api::createApiForTest();
   NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
@@ -93,7 +96,7 @@ static void bmRouteTableSize(benchmark::State& state, RouteMatch::PathSpecifierC
   ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
 
   // Create router config.
-  ConfigImpl config(genRouteConfig(state, match_type), factory_context,
+  ConfigImpl config(genRouteConfig(state, match_type, compile_path_matchers), factory_context,
                     ProtobufMessage::getNullValidationVisitor(), true);
 
   for (auto _ : state) { // NOLINT
@@ -136,9 +139,67 @@ static void bmRouteTableSizeWithRegexMatch(benchmark::State& state) {
   bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kSafeRegex);
 }
 
+/**
+ * Same as bmRouteTableSizeWithPathPrefixMatch, with the virtual host's path matchers compiled into
+ * a prefix trie.
+ */
+static void bmRouteTableSizeWithCompiledPathPrefixMatch(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPrefix, true);
+}
+
+/**
+ * Same as bmRouteTableSizeWithExactPathMatch, with the virtual host's path matchers compiled into
+ * a prefix trie.
+ */
+static void bmRouteTableSizeWithCompiledExactPathMatch(benchmark::State& state) {
+  bmRouteTableSize(state, RouteMatch::PathSpecifierCase::kPath, true);
+}
+
+/**
+ * Measure the speed of selecting a virtual host among `n` suffix wildcard domains of varying
+ * lengths in the form of:
+ * - *.domain_0.example.com
+ * - *-1.domain_1.example.com
+ * - etc.
+ */
+static void bmWildcardVirtualHostLookup(benchmark::State& state) {
+  Api::ApiPtr api = Api::createApiForTest();
+  NiceMock<Server::Configuration::MockServerFactoryContext> factory_context;
+  NiceMock<Envoy::StreamInfo::MockStreamInfo> stream_info;
+  ON_CALL(factory_context, api()).WillByDefault(ReturnRef(*api));
+
+  RouteConfiguration route_config;
+  for (int i = 0; i < state.range(0); ++i) {
+    VirtualHost* v_host = route_config.add_virtual_hosts();
+    v_host->set_name(absl::StrCat("vhost_", i));
+    v_host->add_domains(absl::StrCat(std::string(i % 8 == 0 ? "*." : "*-"), i % 8, ".domain_", i,
+                                     ".example.com"));
+    Route* route = v_host->add_routes();
+    route->mutable_match()->set_prefix("/");
+    route->mutable_direct_response()->set_status(200);
+  }
+
+  ConfigImpl config(route_config, factory_context, ProtobufMessage::getNullValidationVisitor(),
+                    true);
+  const int last_domain_num = state.range(0) - 1;
+  Http::TestRequestHeaderMapImpl headers{
+      {":authority", absl::StrCat("host-", last_domain_num % 8, ".domain_", last_domain_num,
+                                  ".example.com")},
+      {":method", "GET"},
+      {":path", "/"},
+      {"x-forwarded-proto", "http"}};
+
+  for (auto _ : state) { // NOLINT
+    RELEASE_ASSERT(config.route(headers, stream_info, 0) != nullptr, "");
+  }
+}
+
 BENCHMARK(bmRouteTableSizeWithPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
 BENCHMARK(bmRouteTableSizeWithRegexMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmRouteTableSizeWithCompiledPathPrefixMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmRouteTableSizeWithCompiledExactPathMatch)->RangeMultiplier(2)->Ranges({{1, 2 << 13}});
+BENCHMARK(bmWildcardVirtualHostLookup)->RangeMultiplier(10)->Ranges({{10, 10000}});
 
 } // namespace
 } // namespace Router
@@ -1292,6 +1292,58 @@ virtual_hosts:
             config.route(genHeaders("example.com", "/", "GET"), 0)->routeEntry()->clusterName());
 }
 
+// Verify that compiling the path matchers into an index preserves first-match semantics across
+// prefix, exact, case insensitive, regex and header constrained routes.
+TEST_F(RouteMatcherTest, CompiledPathMatchers) {
+  const std::string yaml = R"EOF(
+virtual_hosts:
+  - name: compiled
+    domains: ["*"]
+    compile_path_matchers: true
+    routes:
+      - match: { prefix: "/foo/bar", headers: [{ name: x-bar, exact_match: "true" }] }
+        route: { cluster: "foo_bar_header" }
+      - match: { path: "/foo/bar" }
+        route: { cluster: "foo_bar_exact" }
+      - match:
+          safe_regex:
+            google_re2: {}
+            regex: "/foo/[0-9]+"
+        route: { cluster: "foo_regex" }
+      - match: { prefix: "/FOO", case_sensitive: false }
+        route: { cluster: "foo_insensitive" }
+      - match: { prefix: "/foo" }
+        route: { cluster: "foo_prefix" }
+      - match: { prefix: "/" }
+        route: { cluster: "default" }
+  )EOF";
+
+  factory_context_.cluster_manager_.initializeClusters(
+      {"foo_bar_header", "foo_bar_exact", "foo_regex", "foo_insensitive", "foo_prefix", "default"},
+      {});
+  TestConfigImpl config(parseRouteConfigurationFromYaml(yaml), factory_context_, true);
+
+  EXPECT_EQ("foo_bar_exact", config.route(genHeaders("www.lyft.com", "/foo/bar?baz", "GET"), 0)
+                                 ->routeEntry()
+                                 ->clusterName());
+  {
+    Http::TestRequestHeaderMapImpl headers = genHeaders("www.lyft.com", "/foo/bar", "GET");
+    headers.addCopy("x-bar", "true");
+    EXPECT_EQ("foo_bar_header", config.route(headers, 0)->routeEntry()->clusterName());
+  }
+  EXPECT_EQ("foo_regex", config.route(genHeaders("www.lyft.com", "/foo/123", "GET"), 0)
+                             ->routeEntry()
+                             ->clusterName());
+  EXPECT_EQ("foo_insensitive", config.route(genHeaders("www.lyft.com", "/Foo/bar/baz", "GET"), 0)
+                                   ->routeEntry()
+                                   ->clusterName());
+  EXPECT_EQ("foo_insensitive", config.route(genHeaders("www.lyft.com", "/foo/abc", "GET"), 0)
+                                   ->routeEntry()
+                                   ->clusterName());
+  EXPECT_EQ("default",
+            config.route(genHeaders("www.lyft.com", "/fo", "GET"), 0)->routeEntry()->clusterName());
+}
+
 // When deprecating regex: this test can be removed.
 TEST_F(RouteMatcherTest, DEPRECATED_FEATURE_TEST(TestRoutesWithInvalidRegexLegacy)) {
   TestDeprecatedV2Api _deprecated_v2_api;
@@ -0,0 +1,85 @@
+#include "common/router/route_path_index.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using testing::ElementsAre;
+using testing::IsEmpty;
+
+RoutePathIndex::CandidateList candidatesFor(const RoutePathIndex& index, absl::string_view path) {
+  RoutePathIndex::CandidateList candidates;
+  index.findCandidates(path, candidates);
+  return candidates;
+}
+
+TEST(RoutePathIndexTest, Empty) {
+  RoutePathIndex index;
+  EXPECT_THAT(candidatesFor(index, "/foo"), IsEmpty());
+}
+
+TEST(RoutePathIndexTest, PrefixMatches) {
+  RoutePathIndex index;
+  index.addPrefix(0, "/foo/bar", true);
+  index.addPrefix(1, "/foo", true);
+  index.addPrefix(2, "/", true);
+  index.addPrefix(3, "", true);
+  index.addPrefix(4, "/baz", true);
+
+  EXPECT_THAT(candidatesFor(index, "/foo/bar/baz"), ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(candidatesFor(index, "/foo"), ElementsAre(1, 2, 3));
+  EXPECT_THAT(candidatesFor(index, "/fo"), ElementsAre(2, 3));
+  EXPECT_THAT(candidatesFor(index, "/baz"), ElementsAre(2, 3, 4));
+  EXPECT_THAT(candidatesFor(index, ""), ElementsAre(3));
+}
+
+TEST(RoutePathIndexTest, ExactMatches) {
+  RoutePathIndex index;
+  index.addExact(0, "/foo", true);
+  index.addExact(1, "/foo/bar", true);
+  index.addExact(2, "/foo", true);
+
+  EXPECT_THAT(candidatesFor(index, "/foo"), ElementsAre(0, 2));
+  EXPECT_THAT(candidatesFor(index, "/foo/bar"), ElementsAre(1));
+  EXPECT_THAT(candidatesFor(index, "/foo/"), IsEmpty());
+  EXPECT_THAT(candidatesFor(index, "/fo"), IsEmpty());
+}
+
+TEST(RoutePathIndexTest, QueryAndFragmentIgnored) {
+  RoutePathIndex index;
+  index.addExact(0, "/foo", true);
+  index.addPrefix(1, "/foo?", true);
+
+  EXPECT_THAT(candidatesFor(index, "/foo?bar=baz"), ElementsAre(0));
+  EXPECT_THAT(candidatesFor(index, "/foo#frag"), ElementsAre(0));
+}
+
+TEST(RoutePathIndexTest, CaseInsensitive) {
+  RoutePathIndex index;
+  index.addPrefix(0, "/FOO", false);
+  index.addExact(1, "/foo/BAR", false);
+  index.addPrefix(2, "/FOO", true);
+
+  EXPECT_THAT(candidatesFor(index, "/foo/bar"), ElementsAre(0, 1));
+  EXPECT_THAT(candidatesFor(index, "/FOO/bar"), ElementsAre(0, 1, 2));
+  EXPECT_THAT(candidatesFor(index, "/Foo/Bar/baz"), ElementsAre(0));
+}
+
+TEST(RoutePathIndexTest, UnindexedAlwaysCandidates) {
+  RoutePathIndex index;
+  index.addUnindexed(3);
+  index.addPrefix(0, "/foo", true);
+  index.addUnindexed(1);
+  index.addExact(2, "/bar", true);
+
+  EXPECT_THAT(candidatesFor(index, "/foo"), ElementsAre(0, 1, 3));
+  EXPECT_THAT(candidatesFor(index, "/bar"), ElementsAre(1, 2, 3));
+  EXPECT_THAT(candidatesFor(index, "/baz"), ElementsAre(1, 3));
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -0,0 +1,83 @@
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/router/wildcard_domain_trie.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Router {
+namespace {
+
+using StringPtr = std::shared_ptr<std::string>;
+using Trie = WildcardDomainTrie<StringPtr>;
+
+std::string findLongestMatch(const Trie& trie, absl::string_view host) {
+  const StringPtr* value = trie.findLongestMatch(host);
+  return value == nullptr ? "" : **value;
+}
+
+TEST(WildcardDomainTrieTest, Empty) {
+  Trie trie(Trie::Direction::Suffix);
+  EXPECT_TRUE(trie.empty());
+  EXPECT_EQ(nullptr, trie.findLongestMatch("foo.com"));
+}
+
+TEST(WildcardDomainTrieTest, Suffix) {
+  Trie trie(Trie::Direction::Suffix);
+  EXPECT_TRUE(trie.add(".baz.com", std::make_shared<std::string>("dot")));
+  EXPECT_TRUE(trie.add("-bar.baz.com", std::make_shared<std::string>("dash")));
+  EXPECT_FALSE(trie.add(".baz.com", std::make_shared<std::string>("duplicate")));
+  EXPECT_EQ(2, trie.size());
+
+  EXPECT_EQ("dash", findLongestMatch(trie, "foo-bar.baz.com"));
+  EXPECT_EQ("dot", findLongestMatch(trie, "foo.baz.com"));
+  // The host is lower-cased by the caller.
+  EXPECT_EQ("", findLongestMatch(trie, "foo.BAZ.com"));
+  // A wildcard must match at least one character.
+  EXPECT_EQ("", findLongestMatch(trie, ".baz.com"));
+  EXPECT_EQ("dot", findLongestMatch(trie, "-bar.baz.com"));
+  EXPECT_EQ("", findLongestMatch(trie, "foo.bar.com"));
+}
+
+TEST(WildcardDomainTrieTest, Prefix) {
+  Trie trie(Trie::Direction::Prefix);
+  EXPECT_TRUE(trie.add("foo.", std::make_shared<std::string>("foo")));
+  EXPECT_TRUE(trie.add("foo.bar.", std::make_shared<std::string>("foo_bar")));
+
+  EXPECT_EQ("foo_bar", findLongestMatch(trie, "foo.bar.com"));
+  EXPECT_EQ("foo", findLongestMatch(trie, "foo.baz.com"));
+  EXPECT_EQ("foo", findLongestMatch(trie, "foo.bar."));
+  EXPECT_EQ("", findLongestMatch(trie, "foo."));
+  EXPECT_EQ("", findLongestMatch(trie, "bar.foo.com"));
+}
+
+TEST(WildcardDomainTrieTest, ForEachMatch) {
+  WildcardDomainTrie<std::string> trie(WildcardDomainTrie<std::string>::Direction::Suffix);
+  trie.getOrCreate("") = "empty";
+  trie.getOrCreate(".com") = "com";
+  trie.getOrCreate(".com") += "_again";
+  trie.getOrCreate("foo.com") = "foo";
+  EXPECT_EQ(3, trie.size());
+
+  std::vector<std::pair<std::string, bool>> matches;
+  trie.forEachMatch("foo.com", [&matches](const std::string& value, bool whole_key) {
+    matches.emplace_back(value, whole_key);
+  });
+  EXPECT_EQ((std::vector<std::pair<std::string, bool>>{
+                {"empty", false}, {"com_again", false}, {"foo", true}}),
+            matches);
+
+  matches.clear();
+  trie.forEachMatch("bar.com", [&matches](const std::string& value, bool whole_key) {
+    matches.emplace_back(value, whole_key);
+  });
+  EXPECT_EQ((std::vector<std::pair<std::string, bool>>{{"empty", false}, {"com_again", false}}),
+            matches);
+}
+
+} // namespace
+} // namespace Router
+} // namespace Envoy
@@ -95,5 +95,73 @@ TEST_F(HistogramSettingsImplTest, Priority) {
   EXPECT_EQ(settings_->buckets("abcd"), ConstSupportedBuckets({1, 2}));
 }
 
+// Test that merging with HistogramMerger gives the same histogram as hist_accumulate().
+TEST(HistogramMergerTest, SameAsAccumulate) {
+  TestRandomGenerator random;
+  HistogramMerger merger;
+  for (int round = 0; round < 3; ++round) {
+    std::vector<histogram_t*> sources;
+    for (int i = 0; i < 8; ++i) {
+      sources.push_back(hist_alloc());
+      for (int j = 0; j < 100; ++j) {
+        hist_insert_intscale(sources.back(), random.random() % (1 << (random.random() % 24)), 0,
+                             1);
+      }
+      merger.add(sources.back());
+    }
+    // Empty histograms are skipped.
+    histogram_t* empty = hist_alloc();
+    merger.add(empty);
+    EXPECT_FALSE(merger.empty());
+
+    histogram_t* accumulated = hist_alloc();
+    hist_accumulate(accumulated, sources.data(), static_cast<int>(sources.size()));
+    histogram_t* merged = hist_alloc();
+    merger.finish(merged);
+    EXPECT_TRUE(merger.empty());
+
+    ASSERT_EQ(hist_bucket_count(accumulated), hist_bucket_count(merged));
+    for (int i = 0; i < hist_bucket_count(merged); ++i) {
+      hist_bucket_t accumulated_bucket, merged_bucket;
+      uint64_t accumulated_count, merged_count;
+      hist_bucket_idx_bucket(accumulated, i, &accumulated_bucket, &accumulated_count);
+      hist_bucket_idx_bucket(merged, i, &merged_bucket, &merged_count);
+      EXPECT_EQ(accumulated_bucket.val, merged_bucket.val);
+      EXPECT_EQ(accumulated_bucket.exp, merged_bucket.exp);
+      EXPECT_EQ(accumulated_count, merged_count);
+    }
+    HistogramStatisticsImpl accumulated_statistics(accumulated);
+    HistogramStatisticsImpl merged_statistics(merged);
+    EXPECT_EQ(accumulated_statistics.quantileSummary(), merged_statistics.quantileSummary());
+    EXPECT_EQ(accumulated_statistics.bucketSummary(), merged_statistics.bucketSummary());
+
+    for (histogram_t* source : sources) {
+      hist_free(source);
+    }
+    hist_free(empty);
+    hist_free(accumulated);
+    hist_free(merged);
+  }
+}
+
+// Test that buckets of negative and fractional values are merged too.
+TEST(HistogramMergerTest, NegativeAndFractionalValues) {
+  histogram_t* source = hist_alloc();
+  for (const double value : {-250.0, -0.5, 0.0, 0.001, 3.0, 1e10}) {
+    hist_insert(source, value, 2);
+  }
+  HistogramMerger merger;
+  merger.add(source);
+  merger.add(source);
+  histogram_t* merged = hist_alloc();
+  merger.finish(merged);
+
+  EXPECT_EQ(hist_bucket_count(source), hist_bucket_count(merged));
+  EXPECT_EQ(24, hist_sample_count(merged));
+  EXPECT_DOUBLE_EQ(2 * hist_approx_sum(source), hist_approx_sum(merged));
+  hist_free(source);
+  hist_free(merged);
+}
+
 } // namespace Stats
 } // namespace Envoy
@@ -231,7 +231,6 @@ TEST_F(StatNameTest, TestSuccessfulDecode) {
 class StatNameDeathTest : public StatNameTest {
 public:
   void decodeSymbolVec(const SymbolVec& symbol_vec) {
-    Thread::LockGuard lock(table_.lock_);
     for (Symbol symbol : symbol_vec) {
       table_.fromSymbol(symbol);
     }
@@ -552,6 +551,36 @@ TEST_F(StatNameTest, RacingSymbolCreation) {
   }
 }
 
+// Decoding doesn't take locks, so validates that names decode correctly while
+// other threads allocate, release and reuse symbols, growing the decode table.
+TEST_F(StatNameTest, DecodeDuringSymbolChurn) {
+  Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
+  StatNameManagedStorage stable("stable.name.to.decode", table_);
+  constexpr int num_threads = 8;
+  std::vector<Thread::ThreadPtr> threads;
+  threads.reserve(num_threads);
+  ConditionalInitializer start;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.push_back(thread_factory.createThread([this, i, &start, &stable]() {
+      start.wait();
+      for (int count = 0; count < 1000; ++count) {
+        if (i % 2 == 0) {
+          const std::string name = absl::StrCat("churn.", i, ".", count);
+          StatNameManagedStorage churn(name, table_);
+          EXPECT_EQ(name, table_.toString(churn.statName()));
+        } else {
+          EXPECT_EQ("stable.name.to.decode", table_.toString(stable.statName()));
+        }
+      }
+    }));
+  }
+  start.setReady();
+  for (auto& thread : threads) {
+    thread->join();
+  }
+  EXPECT_EQ(4, table_.numSymbols());
+}
+
 TEST_F(StatNameTest, MutexContentionOnExistingSymbols) {
   Thread::ThreadFactory& thread_factory = Thread::threadFactoryForTest();
   MutexTracerImpl& mutex_tracer = MutexTracerImpl::getOrCreateTracer();
@@ -682,6 +711,16 @@ TEST_F(StatNameTest, RecentLookups) {
   EXPECT_EQ(0, num_calls);
 }
 
+// Lookups are counted even when they aren't tracked, as the total is reported by the admin
+// endpoint regardless of the capacity.
+TEST_F(StatNameTest, RecentLookupsTotalWithoutTracking) {
+  encodeDecode("direct.stat");
+  encodeDecode("direct.stat");
+  uint32_t num_calls = 0;
+  EXPECT_EQ(2, table_.getRecentLookups([&num_calls](absl::string_view, uint64_t) { ++num_calls; }));
+  EXPECT_EQ(0, num_calls);
+}
+
 TEST_F(StatNameTest, StatNameEmptyEquivalent) {
   StatName empty1;
   StatName empty2 = makeStat("");
@@ -12,6 +12,7 @@
 #include "test/common/stats/make_elements_helper.h"
 #include "test/test_common/utility.h"
 
+#include "absl/strings/str_cat.h"
 #include "absl/synchronization/blocking_counter.h"
 #include "benchmark/benchmark.h"
 
@@ -61,6 +62,54 @@ static void bmCreateRace(benchmark::State& state) {
 }
 BENCHMARK(bmCreateRace)->Unit(::benchmark::kMillisecond);
 
+// Measures encoding, decoding and freeing names whose tokens all have symbols
+// already, from state.range(0) threads at once. These only take the locks of
+// the encode map shards holding the tokens, so they scale with the threads.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void bmEncodeExistingConcurrent(benchmark::State& state) {
+  const int num_threads = state.range(0);
+  Envoy::Thread::ThreadFactory& thread_factory = Envoy::Thread::threadFactoryForTest();
+  Envoy::Stats::SymbolTableImpl table;
+  std::vector<std::string> names;
+  std::vector<Envoy::Stats::StatNameStorage> initial;
+  for (int i = 0; i < 100; ++i) {
+    names.push_back(absl::StrCat("cluster.cluster_", i, ".upstream_rq_total"));
+    initial.emplace_back(names.back(), table);
+  }
+
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    std::vector<Envoy::Thread::ThreadPtr> threads;
+    threads.reserve(num_threads);
+    Envoy::ConditionalInitializer access;
+    for (int i = 0; i < num_threads; ++i) {
+      threads.push_back(thread_factory.createThread([&access, &names, &table, i]() {
+        access.wait();
+        for (int count = 0; count < 10000; ++count) {
+          const std::string& name = names[(count + i) % names.size()];
+          Envoy::Stats::StatNameStorage stat_name(name, table);
+          RELEASE_ASSERT(table.toString(stat_name.statName()) == name, "");
+          stat_name.free(table);
+        }
+      }));
+    }
+    access.setReady();
+    for (auto& thread : threads) {
+      thread->join();
+    }
+  }
+
+  for (Envoy::Stats::StatNameStorage& stat_name : initial) {
+    stat_name.free(table);
+  }
+}
+BENCHMARK(bmEncodeExistingConcurrent)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Unit(::benchmark::kMillisecond)
+    ->UseRealTime();
+
 // NOLINTNEXTLINE(readability-identifier-naming)
 static void bmJoinStatNames(benchmark::State& state) {
   Envoy::Stats::SymbolTableImpl symbol_table;
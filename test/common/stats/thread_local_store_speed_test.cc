@@ -53,6 +53,21 @@ public:
     }
   }
 
+  void recordHistograms(uint64_t value) {
+    for (auto& stat_name_storage : stat_names_) {
+      store_
+          .histogramFromStatName(stat_name_storage->statName(), Stats::Histogram::Unit::Unspecified)
+          .recordValue(value);
+    }
+  }
+
+  void mergeHistograms() {
+    bool merged = false;
+    store_.mergeHistograms([&merged]() { merged = true; });
+    dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+    RELEASE_ASSERT(merged, "histogram merge did not complete");
+  }
+
   void initThreading() {
     if (!Envoy::Event::Libevent::Global::initialized()) {
       Envoy::Event::Libevent::Global::initialize();
@@ -103,5 +118,38 @@ static void BM_StatsWithTls(benchmark::State& state) {
 }
 BENCHMARK(BM_StatsWithTls);
 
+// Tests merging histograms which had values recorded since the previous merge.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HistogramMerge(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+
+  uint64_t value = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    for (uint32_t i = 0; i < 10; ++i) {
+      context.recordHistograms(++value * 97 % 100000);
+    }
+    state.ResumeTiming();
+    context.mergeHistograms();
+  }
+}
+BENCHMARK(BM_HistogramMerge)->Unit(benchmark::kMillisecond);
+
+// Tests merging histograms which had no values recorded since the previous merge, which is the
+// case of most histograms on a flush.
+// NOLINTNEXTLINE(readability-identifier-naming)
+static void BM_HistogramMergeIdle(benchmark::State& state) {
+  Envoy::ThreadLocalStorePerf context;
+  context.initThreading();
+  context.recordHistograms(42);
+  context.mergeHistograms();
+
+  for (auto _ : state) {
+    context.mergeHistograms();
+  }
+}
+BENCHMARK(BM_HistogramMergeIdle)->Unit(benchmark::kMillisecond);
+
 // TODO(jmarantz): add multi-threaded variant of this test, that aggressively
 // looks up stats in multiple threads to try to trigger contention issues.
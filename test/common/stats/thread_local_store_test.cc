@@ -1434,6 +1434,44 @@ TEST_F(HistogramTest, ParentHistogramBucketSummary) {
             parent_histogram->bucketSummary());
 }
 
+// Validates that the cached summaries follow the merges, including the ones without new values.
+TEST_F(HistogramTest, ParentHistogramSummaryAcrossIdleMerges) {
+  Histogram& histogram =
+      store_->histogramFromString("histogram", Stats::Histogram::Unit::Unspecified);
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), 10));
+  histogram.recordValue(10);
+  store_->mergeHistograms([]() -> void {});
+  ParentHistogramSharedPtr parent_histogram = store_->histograms()[0];
+  EXPECT_EQ("B0.5(0,0) B1(0,0) B5(0,0) B10(0,0) B25(1,1) B50(1,1) B100(1,1) "
+            "B250(1,1) B500(1,1) B1000(1,1) B2500(1,1) B5000(1,1) B10000(1,1) "
+            "B30000(1,1) B60000(1,1) B300000(1,1) B600000(1,1) B1.8e+06(1,1) "
+            "B3.6e+06(1,1)",
+            parent_histogram->bucketSummary());
+  EXPECT_EQ(1, parent_histogram->intervalStatistics().sampleCount());
+
+  // The interval is reset by a merge without new values, while the cumulative values are kept.
+  for (int i = 0; i < 2; ++i) {
+    store_->mergeHistograms([]() -> void {});
+    EXPECT_EQ("B0.5(0,0) B1(0,0) B5(0,0) B10(0,0) B25(0,1) B50(0,1) B100(0,1) "
+              "B250(0,1) B500(0,1) B1000(0,1) B2500(0,1) B5000(0,1) B10000(0,1) "
+              "B30000(0,1) B60000(0,1) B300000(0,1) B600000(0,1) B1.8e+06(0,1) "
+              "B3.6e+06(0,1)",
+              parent_histogram->bucketSummary());
+    EXPECT_EQ(0, parent_histogram->intervalStatistics().sampleCount());
+    EXPECT_EQ(1, parent_histogram->cumulativeStatistics().sampleCount());
+  }
+
+  EXPECT_CALL(sink_, onHistogramComplete(Ref(histogram), 1));
+  histogram.recordValue(1);
+  store_->mergeHistograms([]() -> void {});
+  EXPECT_EQ("B0.5(0,0) B1(0,0) B5(1,1) B10(1,1) B25(1,2) B50(1,2) B100(1,2) "
+            "B250(1,2) B500(1,2) B1000(1,2) B2500(1,2) B5000(1,2) B10000(1,2) "
+            "B30000(1,2) B60000(1,2) B300000(1,2) B600000(1,2) B1.8e+06(1,2) "
+            "B3.6e+06(1,2)",
+            parent_histogram->bucketSummary());
+  EXPECT_EQ(2, parent_histogram->cumulativeStatistics().sampleCount());
+}
+
 class ThreadLocalRealThreadsTestBase : public ThreadLocalStoreNoMocksTestBase {
 protected:
   static constexpr uint32_t NumScopes = 1000;
@@ -53,6 +53,7 @@ using ::testing::DoAll;
 using ::testing::Invoke;
 using ::testing::InvokeWithoutArgs;
 using ::testing::NiceMock;
+using ::testing::Ref;
 using ::testing::Return;
 using ::testing::ReturnPointee;
 using ::testing::ReturnRef;
@@ -170,6 +171,40 @@ TEST_F(TcpProxyTest, HalfCloseProxy) {
   upstream_callbacks_->onEvent(Network::ConnectionEvent::RemoteClose);
 }
 
+// Tests that the connections are spliced when splicing is enabled.
+TEST_F(TcpProxyTest, Splice) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_enable_splice(true);
+  setup(1, config);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(Ref(filter_callbacks_.connection_)))
+      .WillOnce(Return(true));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(1U, config_->stats().downstream_cx_spliced_total_.value());
+}
+
+// Tests that data is proxied as usual if the connections can't be spliced.
+TEST_F(TcpProxyTest, SpliceNotPossible) {
+  envoy::extensions::filters::network::tcp_proxy::v3::TcpProxy config = defaultConfig();
+  config.set_enable_splice(true);
+  setup(1, config);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(_)).WillOnce(Return(false));
+  raiseEventUpstreamConnected(0);
+  EXPECT_EQ(0U, config_->stats().downstream_cx_spliced_total_.value());
+
+  Buffer::OwnedImpl buffer("hello");
+  EXPECT_CALL(*upstream_connections_.at(0), write(BufferEqual(&buffer), false));
+  filter_->onData(buffer, false);
+}
+
+TEST_F(TcpProxyTest, SpliceDisabledByDefault) {
+  setup(1);
+
+  EXPECT_CALL(*upstream_connections_.at(0), startSplice(_)).Times(0);
+  raiseEventUpstreamConnected(0);
+}
+
 // Test with an explicitly configured upstream.
 TEST_F(TcpProxyTest, ExplicitFactory) {
   // Explicitly configure an HTTP upstream, to test factory creation.
@@ -40,7 +40,7 @@ namespace Upstream {
 
 class EdsSpeedTest {
 public:
-  EdsSpeedTest(State& state, bool v2_config)
+  EdsSpeedTest(State& state, bool v2_config, bool endpoints_collection = false)
       : state_(state), v2_config_(v2_config),
         type_url_(v2_config_
                       ? "type.googleapis.com/envoy.api.v2.ClusterLoadAssignment"
@@ -52,7 +52,22 @@ public:
             *Protobuf::DescriptorPool::generated_pool()->FindMethodByName(
                 "envoy.service.endpoint.v3.EndpointDiscoveryService.StreamEndpoints"),
             envoy::config::core::v3::ApiVersion::AUTO, random_, stats_, {}, true)) {
-    resetCluster(R"EOF(
+    if (endpoints_collection) {
+      resetCluster(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      eds_cluster_config:
+        endpoints_resources_locator: xdstp://test/envoy.config.endpoint.v3.LocalityLbEndpoints/fare
+        eds_config:
+          resource_api_version: V3
+          api_config_source:
+            api_type: AGGREGATED_DELTA_GRPC
+            transport_api_version: V3
+    )EOF",
+                   Envoy::Upstream::Cluster::InitializePhase::Secondary);
+    } else {
+      resetCluster(R"EOF(
       name: name
       connect_timeout: 0.25s
       type: EDS
@@ -64,7 +79,8 @@ public:
             - eds
             refresh_delay: 1s
     )EOF",
-                 Envoy::Upstream::Cluster::InitializePhase::Secondary);
+                   Envoy::Upstream::Cluster::InitializePhase::Secondary);
+    }
 
     EXPECT_CALL(*cm_.subscription_factory_.subscription_, start(_));
     cluster_->initialize([this] { initialized_ = true; });
@@ -100,27 +116,7 @@ public:
     cluster_load_assignment.set_cluster_name("fare");
 
     // Add a whole bunch of hosts in a single place:
-    auto* endpoints = cluster_load_assignment.add_endpoints();
-    endpoints->set_priority(1);
-    auto* locality = endpoints->mutable_locality();
-    locality->set_region("region");
-    locality->set_zone("zone");
-    locality->set_sub_zone("sub_zone");
-    endpoints->mutable_load_balancing_weight()->set_value(1);
-
-    uint32_t port = 1000;
-    for (size_t i = 0; i < num_hosts; ++i) {
-      auto* lb_endpoint = endpoints->add_lb_endpoints();
-      if (healthy) {
-        lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
-      } else {
-        lb_endpoint->set_health_status(envoy::config::core::v3::UNHEALTHY);
-      }
-      auto* socket_address =
-          lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
-      socket_address->set_address("10.0.1." + std::to_string(i / 60000));
-      socket_address->set_port_value((port + i) % 60000);
-    }
+    addEndpoints(*cluster_load_assignment.add_endpoints(), 0, num_hosts, healthy);
 
     // this is what we're actually testing:
     validation_visitor_.setSkipValidation(ignore_unknown_dynamic_fields);
@@ -142,6 +138,90 @@ public:
            num_hosts);
   }
 
+  // Add the endpoints of the hosts [first_host, first_host + num_hosts) to a single locality.
+  static void addEndpoints(envoy::config::endpoint::v3::LocalityLbEndpoints& endpoints,
+                           size_t first_host, size_t num_hosts, bool healthy) {
+    endpoints.set_priority(1);
+    auto* locality = endpoints.mutable_locality();
+    locality->set_region("region");
+    locality->set_zone("zone");
+    locality->set_sub_zone("sub_zone");
+    endpoints.mutable_load_balancing_weight()->set_value(1);
+
+    uint32_t port = 1000;
+    for (size_t i = first_host; i < first_host + num_hosts; ++i) {
+      auto* lb_endpoint = endpoints.add_lb_endpoints();
+      if (healthy) {
+        lb_endpoint->set_health_status(envoy::config::core::v3::HEALTHY);
+      } else {
+        lb_endpoint->set_health_status(envoy::config::core::v3::UNHEALTHY);
+      }
+      auto* socket_address =
+          lb_endpoint->mutable_endpoint()->mutable_address()->mutable_socket_address();
+      socket_address->set_address("10.0.1." + std::to_string(i / 60000));
+      socket_address->set_port_value((port + i) % 60000);
+    }
+  }
+
+  // Send num_hosts hosts, with the port of the first one changing with each update, either as a
+  // ClusterLoadAssignment or as resources of an endpoints collection holding hosts_per_resource
+  // hosts each. Only the resource of the first host is sent again by the later updates of the
+  // collection. The update is only timed when timed is set, and its decoding never is.
+  void singleHostUpdateHelper(size_t num_hosts, bool endpoints_collection, bool timed) {
+    state_.PauseTiming();
+
+    const size_t hosts_per_resource = 100;
+    const uint32_t first_port = 60000 + version_ % 2;
+    Config::DecodedResourcesWrapper decoded_resources;
+    if (endpoints_collection) {
+      Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> resources;
+      const size_t num_resources = version_ == 0 ? (num_hosts + hosts_per_resource - 1) /
+                                                       hosts_per_resource
+                                                 : 1;
+      for (size_t i = 0; i < num_resources; ++i) {
+        envoy::config::endpoint::v3::LocalityLbEndpoints endpoints;
+        const size_t first_host = i * hosts_per_resource;
+        addEndpoints(endpoints, first_host,
+                     std::min(hosts_per_resource, num_hosts - first_host), true);
+        if (i == 0) {
+          endpoints.mutable_lb_endpoints(0)
+              ->mutable_endpoint()
+              ->mutable_address()
+              ->mutable_socket_address()
+              ->set_port_value(first_port);
+        }
+        auto* resource = resources.Add();
+        resource->set_name(fmt::format("endpoints-{}", i));
+        resource->set_version(fmt::format("version-{}", version_));
+        resource->mutable_resource()->PackFrom(endpoints);
+      }
+      decoded_resources =
+          TestUtility::decodeResources<envoy::config::endpoint::v3::LocalityLbEndpoints>(
+              resources);
+    } else {
+      envoy::config::endpoint::v3::ClusterLoadAssignment cluster_load_assignment;
+      cluster_load_assignment.set_cluster_name("fare");
+      addEndpoints(*cluster_load_assignment.add_endpoints(), 0, num_hosts, true);
+      cluster_load_assignment.mutable_endpoints(0)
+          ->mutable_lb_endpoints(0)
+          ->mutable_endpoint()
+          ->mutable_address()
+          ->mutable_socket_address()
+          ->set_port_value(first_port);
+      decoded_resources = TestUtility::decodeResources({cluster_load_assignment}, "cluster_name");
+    }
+    const std::string version = fmt::format("version-{}", version_++);
+
+    if (timed) {
+      state_.ResumeTiming();
+    }
+    eds_callbacks_->onConfigUpdate(decoded_resources.refvec_, {}, version);
+    if (!timed) {
+      state_.ResumeTiming();
+    }
+    ASSERT(cluster_->prioritySet().hostSetsPerPriority()[1]->hosts().size() == num_hosts);
+  }
+
   TestDeprecatedV2Api _deprecated_v2_api_;
   State& state_;
   const bool v2_config_;
@@ -223,3 +303,21 @@ static void healthOnlyUpdate(State& state) {
 }
 
 BENCHMARK(healthOnlyUpdate)->Range(1, 100000)->Unit(benchmark::kMillisecond);
+
+static void singleHostUpdate(State& state) {
+  Envoy::Thread::MutexBasicLockable lock;
+  Envoy::Logger::Context logging_state(spdlog::level::warn,
+                                       Envoy::Logger::Logger::DEFAULT_LOG_FORMAT, lock, false);
+  for (auto _ : state) {
+    Envoy::Upstream::EdsSpeedTest speed_test(state, false, state.range(0));
+    uint32_t endpoints = skipExpensiveBenchmarks() ? 1 : state.range(1);
+
+    // Only the update of a single host is timed, with the hosts loaded beforehand.
+    speed_test.singleHostUpdateHelper(endpoints, state.range(0), false);
+    speed_test.singleHostUpdateHelper(endpoints, state.range(0), true);
+  }
+}
+
+BENCHMARK(singleHostUpdate)
+    ->Ranges({{false, true}, {1, 100000}})
+    ->Unit(benchmark::kMillisecond);
@@ -7,6 +7,7 @@
 #include "envoy/service/discovery/v3/discovery.pb.h"
 #include "envoy/stats/scope.h"
 
+#include "common/config/decoded_resource_impl.h"
 #include "common/config/utility.h"
 #include "common/singleton/manager_impl.h"
 #include "common/upstream/eds.h"
@@ -15,6 +16,7 @@
 
 #include "test/common/stats/stat_test_utility.h"
 #include "test/common/upstream/utility.h"
+#include "test/mocks/common.h"
 #include "test/mocks/local_info/mocks.h"
 #include "test/mocks/protobuf/mocks.h"
 #include "test/mocks/runtime/mocks.h"
@@ -28,6 +30,7 @@
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "xds/core/v3/collection_entry.pb.h"
 
 using testing::_;
 
@@ -2203,6 +2206,231 @@ TEST_F(EdsAssignmentTimeoutTest, AssignmentLeaseExpired) {
   }
 }
 
+class EdsEndpointsCollectionTest : public EdsTest {
+public:
+  EdsEndpointsCollectionTest() { resetEndpointsCollectionCluster(""); }
+
+  void resetEndpointsCollectionCluster(const std::string& common_lb_config) {
+    resetCluster(fmt::format(R"EOF(
+      name: name
+      connect_timeout: 0.25s
+      type: EDS
+      lb_policy: ROUND_ROBIN
+      {}
+      eds_cluster_config:
+        endpoints_resources_locator: xdstp://test/envoy.config.endpoint.v3.LocalityLbEndpoints/fare
+        eds_config:
+          resource_api_version: V3
+          api_config_source:
+            api_type: AGGREGATED_DELTA_GRPC
+            transport_api_version: V3
+    )EOF",
+                             common_lb_config),
+                 Cluster::InitializePhase::Secondary);
+  }
+
+  static envoy::config::endpoint::v3::LocalityLbEndpoints
+  makeEndpoints(uint32_t priority, const std::string& zone, const std::vector<uint32_t>& ports) {
+    envoy::config::endpoint::v3::LocalityLbEndpoints endpoints;
+    endpoints.set_priority(priority);
+    endpoints.mutable_locality()->set_zone(zone);
+    for (const uint32_t port : ports) {
+      auto* socket_address = endpoints.add_lb_endpoints()
+                                 ->mutable_endpoint()
+                                 ->mutable_address()
+                                 ->mutable_socket_address();
+      socket_address->set_address("1.2.3.4");
+      socket_address->set_port_value(port);
+    }
+    return endpoints;
+  }
+
+  void deltaUpdate(
+      const std::vector<std::pair<std::string, envoy::config::endpoint::v3::LocalityLbEndpoints>>&
+          added,
+      const std::vector<std::string>& removed, const std::string& version = "") {
+    Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> resources;
+    for (const auto& endpoints : added) {
+      auto* resource = resources.Add();
+      resource->set_name(endpoints.first);
+      resource->set_version(version);
+      resource->mutable_resource()->PackFrom(endpoints.second);
+    }
+    Protobuf::RepeatedPtrField<std::string> removed_resources;
+    for (const auto& name : removed) {
+      *removed_resources.Add() = name;
+    }
+    const auto decoded_resources =
+        TestUtility::decodeResources<envoy::config::endpoint::v3::LocalityLbEndpoints>(resources);
+    VERBOSE_EXPECT_NO_THROW(
+        eds_callbacks_->onConfigUpdate(decoded_resources.refvec_, removed_resources, version));
+  }
+
+  std::vector<uint32_t> ports(uint32_t priority) const {
+    std::vector<uint32_t> ports;
+    for (const auto& host : cluster_->prioritySet().hostSetsPerPriority()[priority]->hosts()) {
+      ports.push_back(host->address()->ip()->port());
+    }
+    return ports;
+  }
+};
+
+// Validate that the resources of the endpoints collection are added, updated and removed.
+TEST_F(EdsEndpointsCollectionTest, AddUpdateRemove) {
+  initialize();
+  EXPECT_FALSE(initialized_);
+  deltaUpdate(
+      {{"a", makeEndpoints(0, "zone_a", {80, 81})}, {"b", makeEndpoints(1, "zone_b", {90})}}, {});
+  EXPECT_TRUE(initialized_);
+  EXPECT_EQ(std::vector<uint32_t>({80, 81}), ports(0));
+  EXPECT_EQ(std::vector<uint32_t>({90}), ports(1));
+
+  // The host kept by the update of a resource is updated in place.
+  const HostSharedPtr host_81 = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[1];
+  auto endpoints_a = makeEndpoints(0, "zone_a", {81, 82});
+  endpoints_a.mutable_lb_endpoints(0)->mutable_load_balancing_weight()->set_value(5);
+  endpoints_a.mutable_lb_endpoints(0)->set_health_status(envoy::config::core::v3::UNHEALTHY);
+  deltaUpdate({{"a", endpoints_a}}, {});
+  EXPECT_EQ(std::vector<uint32_t>({81, 82}), ports(0));
+  EXPECT_EQ(host_81, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+  EXPECT_EQ(5, host_81->weight());
+  EXPECT_TRUE(host_81->healthFlagGet(Host::HealthFlag::FAILED_EDS_HEALTH));
+  EXPECT_EQ(1, cluster_->prioritySet().hostSetsPerPriority()[0]->healthyHosts().size());
+  EXPECT_EQ(std::vector<uint32_t>({90}), ports(1));
+
+  deltaUpdate({}, {"b", "unknown"});
+  EXPECT_EQ(std::vector<uint32_t>({81, 82}), ports(0));
+  EXPECT_TRUE(ports(1).empty());
+  EXPECT_EQ(0UL, stats_.counter("cluster.name.update_no_rebuild").value());
+}
+
+// Validate that the priorities and the hosts untouched by an update are left alone.
+TEST_F(EdsEndpointsCollectionTest, UntouchedPriorities) {
+  initialize();
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80})}, {"b", makeEndpoints(1, "zone_b", {90})}},
+              {});
+
+  ReadyWatcher membership_updated;
+  auto priority_update_cb = cluster_->prioritySet().addPriorityUpdateCb(
+      [&](uint32_t priority, const HostVector& hosts_added, const HostVector& hosts_removed) {
+        EXPECT_EQ(1, priority);
+        EXPECT_EQ(1, hosts_added.size());
+        EXPECT_TRUE(hosts_removed.empty());
+        membership_updated.ready();
+      });
+  EXPECT_CALL(membership_updated, ready());
+  deltaUpdate({{"c", makeEndpoints(1, "zone_b", {91})}}, {});
+  EXPECT_EQ(std::vector<uint32_t>({90, 91}), ports(1));
+
+  // An update changing nothing doesn't rebuild the cluster.
+  deltaUpdate({{"c", makeEndpoints(1, "zone_b", {91})}}, {});
+  EXPECT_EQ(1UL, stats_.counter("cluster.name.update_no_rebuild").value());
+}
+
+// Validate that a resource moved to another priority moves its hosts.
+TEST_F(EdsEndpointsCollectionTest, ResourceMovedToNewPriority) {
+  initialize();
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80})}, {"b", makeEndpoints(0, "zone_a", {81})}},
+              {});
+  EXPECT_EQ(std::vector<uint32_t>({80, 81}), ports(0));
+
+  deltaUpdate({{"b", makeEndpoints(1, "zone_a", {81})}}, {});
+  EXPECT_EQ(std::vector<uint32_t>({80}), ports(0));
+  EXPECT_EQ(std::vector<uint32_t>({81}), ports(1));
+  EXPECT_EQ(1, cluster_->prioritySet().hostSetsPerPriority()[1]->hosts()[0]->priority());
+}
+
+// Validate that the state of the world updates of a collection remove the missing resources and
+// skip the resources with an unchanged version.
+TEST_F(EdsEndpointsCollectionTest, StateOfTheWorldUpdate) {
+  initialize();
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80})}, {"b", makeEndpoints(0, "zone_b", {81})}},
+              {}, "1");
+
+  xds::core::v3::CollectionEntry::InlineEntry entry;
+  entry.set_name("a");
+  entry.set_version("1");
+  entry.mutable_resource()->PackFrom(makeEndpoints(0, "zone_a", {80}));
+  TestUtility::TestOpaqueResourceDecoderImpl<envoy::config::endpoint::v3::LocalityLbEndpoints>
+      resource_decoder("name");
+  Config::DecodedResourceImpl decoded_resource(resource_decoder, entry);
+  const HostSharedPtr host_80 = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0];
+  eds_callbacks_->onConfigUpdate({decoded_resource}, "2");
+  EXPECT_EQ(std::vector<uint32_t>({80}), ports(0));
+  EXPECT_EQ(host_80, cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0]);
+
+  eds_callbacks_->onConfigUpdate({}, "3");
+  EXPECT_TRUE(ports(0).empty());
+}
+
+// Validate that the hosts of the local locality go first and that the locality weights are set.
+TEST_F(EdsEndpointsCollectionTest, LocalityWeights) {
+  resetEndpointsCollectionCluster("common_lb_config: {locality_weighted_lb_config: {}}");
+  initialize();
+  auto endpoints_a = makeEndpoints(0, "zone_a", {80});
+  endpoints_a.mutable_load_balancing_weight()->set_value(10);
+  auto endpoints_local = makeEndpoints(0, "us-east-1a", {81});
+  endpoints_local.mutable_load_balancing_weight()->set_value(20);
+  deltaUpdate({{"a", endpoints_a}, {"local", endpoints_local}}, {});
+
+  const auto& host_set = *cluster_->prioritySet().hostSetsPerPriority()[0];
+  EXPECT_TRUE(host_set.hostsPerLocality().hasLocalLocality());
+  ASSERT_EQ(2, host_set.hostsPerLocality().get().size());
+  EXPECT_EQ(81, host_set.hostsPerLocality().get()[0][0]->address()->ip()->port());
+  EXPECT_EQ(80, host_set.hostsPerLocality().get()[1][0]->address()->ip()->port());
+  EXPECT_EQ(LocalityWeights({20, 10}), *host_set.localityWeights());
+
+  endpoints_a.mutable_load_balancing_weight()->set_value(30);
+  deltaUpdate({{"a", endpoints_a}}, {});
+  EXPECT_EQ(LocalityWeights({20, 30}),
+            *cluster_->prioritySet().hostSetsPerPriority()[0]->localityWeights());
+}
+
+// Validate that the hosts added with a health checker wait for their first health check.
+TEST_F(EdsEndpointsCollectionTest, HealthCheckedHosts) {
+  auto health_checker = std::make_shared<MockHealthChecker>();
+  EXPECT_CALL(*health_checker, start());
+  EXPECT_CALL(*health_checker, addHostCheckCompleteCb(_)).Times(2);
+  cluster_->setHealthChecker(health_checker);
+  initialize();
+
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80})}}, {});
+  const HostSharedPtr host_80 = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts()[0];
+  EXPECT_TRUE(host_80->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC));
+  host_80->healthFlagClear(Host::HealthFlag::FAILED_ACTIVE_HC);
+
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80, 81})}}, {});
+  const auto& hosts = cluster_->prioritySet().hostSetsPerPriority()[0]->hosts();
+  EXPECT_FALSE(hosts[0]->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC));
+  EXPECT_TRUE(hosts[1]->healthFlagGet(Host::HealthFlag::FAILED_ACTIVE_HC));
+}
+
+// Validate that an update with an invalid endpoint is rejected without any change.
+TEST_F(EdsEndpointsCollectionTest, MalformedIP) {
+  initialize();
+  deltaUpdate({{"a", makeEndpoints(0, "zone_a", {80})}}, {});
+
+  auto endpoints = makeEndpoints(0, "zone_b", {81});
+  endpoints.mutable_lb_endpoints(0)
+      ->mutable_endpoint()
+      ->mutable_address()
+      ->mutable_socket_address()
+      ->set_address("foo.bar.com");
+  Protobuf::RepeatedPtrField<envoy::service::discovery::v3::Resource> resources;
+  resources.Add()->mutable_resource()->PackFrom(endpoints);
+  resources[0].set_name("b");
+  const auto decoded_resources =
+      TestUtility::decodeResources<envoy::config::endpoint::v3::LocalityLbEndpoints>(resources);
+  Protobuf::RepeatedPtrField<std::string> removed_resources;
+  *removed_resources.Add() = "a";
+  EXPECT_THROW_WITH_MESSAGE(
+      eds_callbacks_->onConfigUpdate(decoded_resources.refvec_, removed_resources, ""),
+      EnvoyException,
+      "malformed IP address: foo.bar.com. Consider setting resolver_name or "
+      "setting cluster type to 'STRICT_DNS' or 'LOGICAL_DNS'");
+  EXPECT_EQ(std::vector<uint32_t>({80}), ports(0));
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
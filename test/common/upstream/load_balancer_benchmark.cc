@@ -15,6 +15,7 @@
 #include "test/common/upstream/utility.h"
 #include "test/mocks/upstream/cluster_info.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 
 #include "benchmark/benchmark.h"
 
@@ -57,6 +58,21 @@ public:
                                     {}, hosts, {}, absl::nullopt);
   }
 
+  // Replaces a host with a new one of the same weight, as an EDS update would.
+  void replaceHost(uint64_t i) {
+    HostVector hosts = priority_set_.hostSetsPerPriority()[0]->hosts();
+    const uint64_t index = i % hosts.size();
+    HostVector hosts_removed{hosts[index]};
+    hosts[index] =
+        makeTestHost(info_, fmt::format("tcp://10.1.{}.{}:6379", (i / 256) % 256, i % 256),
+                     simTime(), hosts_removed[0]->weight());
+    HostVector hosts_added{hosts[index]};
+    HostVectorConstSharedPtr updated_hosts = std::make_shared<HostVector>(hosts);
+    HostsPerLocalityConstSharedPtr hosts_per_locality = makeHostsPerLocality({hosts});
+    priority_set_.updateHosts(0, HostSetImpl::partitionHosts(updated_hosts, hosts_per_locality), {},
+                              hosts_added, hosts_removed, absl::nullopt);
+  }
+
   Envoy::Thread::MutexBasicLockable lock_;
   // Reduce default log level to warn while running this benchmark to avoid problems due to
   // excessive debug logging in upstream_impl.cc
@@ -76,14 +92,20 @@ public:
 
 class RoundRobinTester : public BaseTester {
 public:
-  RoundRobinTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0)
-      : BaseTester(num_hosts, weighted_subset_percent, weight) {}
+  RoundRobinTester(uint64_t num_hosts, uint32_t weighted_subset_percent = 0, uint32_t weight = 0,
+                   bool use_stride_scheduler = false)
+      : BaseTester(num_hosts, weighted_subset_percent, weight) {
+    Runtime::LoaderSingleton::getExisting()->mergeValues(
+        {{"envoy.reloadable_features.upstream_stride_scheduler",
+          use_stride_scheduler ? "true" : "false"}});
+  }
 
   void initialize() {
     lb_ = std::make_unique<RoundRobinLoadBalancer>(priority_set_, &local_priority_set_, stats_,
                                                    runtime_, random_, common_config_);
   }
 
+  TestScopedRuntime scoped_runtime_;
   std::unique_ptr<RoundRobinLoadBalancer> lb_;
 };
 
@@ -147,6 +169,58 @@ BENCHMARK(benchmarkRoundRobinLoadBalancerBuild)
     ->Args({50000, 100, 50})
     ->Unit(::benchmark::kMillisecond);
 
+void benchmarkRoundRobinLoadBalancerChooseHost(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t weighted_subset_percent = state.range(1);
+  const uint64_t weight = state.range(2);
+  const bool use_stride_scheduler = state.range(3);
+
+  RoundRobinTester tester(num_hosts, weighted_subset_percent, weight, use_stride_scheduler);
+  tester.initialize();
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    benchmark::DoNotOptimize(tester.lb_->chooseHost(nullptr));
+  }
+}
+BENCHMARK(benchmarkRoundRobinLoadBalancerChooseHost)
+    ->Args({500, 0, 1, 0})
+    ->Args({500, 50, 50, 0})
+    ->Args({500, 50, 50, 1})
+    ->Args({5000, 0, 1, 0})
+    ->Args({5000, 50, 50, 0})
+    ->Args({5000, 50, 50, 1})
+    ->Args({50000, 0, 1, 0})
+    ->Args({50000, 50, 50, 0})
+    ->Args({50000, 50, 50, 1});
+
+// Measures a host set update replacing one host, which refreshes the schedulers. This includes
+// partitioning the hosts, which costs the same for both schedulers.
+void benchmarkRoundRobinLoadBalancerHostChurn(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t weighted_subset_percent = state.range(1);
+  const uint64_t weight = state.range(2);
+  const bool use_stride_scheduler = state.range(3);
+
+  if (benchmark::skipExpensiveBenchmarks() && num_hosts > 10000) {
+    state.SkipWithError("Skipping expensive benchmark");
+    return;
+  }
+
+  RoundRobinTester tester(num_hosts, weighted_subset_percent, weight, use_stride_scheduler);
+  tester.initialize();
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    tester.replaceHost(i++);
+  }
+}
+BENCHMARK(benchmarkRoundRobinLoadBalancerHostChurn)
+    ->Args({500, 50, 50, 0})
+    ->Args({500, 50, 50, 1})
+    ->Args({5000, 50, 50, 0})
+    ->Args({5000, 50, 50, 1})
+    ->Args({50000, 50, 50, 0})
+    ->Args({50000, 50, 50, 1})
+    ->Unit(::benchmark::kMicrosecond);
+
 class RingHashTester : public BaseTester {
 public:
   RingHashTester(uint64_t num_hosts, uint64_t min_ring_size) : BaseTester(num_hosts) {
@@ -229,6 +303,56 @@ BENCHMARK(benchmarkMaglevLoadBalancerBuildTable)
     ->Arg(500)
     ->Unit(::benchmark::kMillisecond);
 
+// Measures rebuilding the ring after a host is replaced. The memory counter is the size of the
+// load balancer after the initial build.
+void benchmarkRingHashLoadBalancerHostChurn(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const uint64_t min_ring_size = state.range(1);
+  RingHashTester tester(num_hosts, min_ring_size);
+  const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+  tester.ring_hash_lb_->initialize();
+  const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+  state.counters["memory"] = end_mem - start_mem;
+
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    tester.replaceHost(i++);
+  }
+}
+BENCHMARK(benchmarkRingHashLoadBalancerHostChurn)
+    ->Args({100, 65536})
+    ->Args({500, 65536})
+    ->Args({100, 256000})
+    ->Args({500, 256000})
+    ->Unit(::benchmark::kMillisecond);
+
+// Measures rebuilding the table after a host is replaced, with and without incremental updates.
+// The memory counter is the size of the load balancer after the initial build.
+void benchmarkMaglevLoadBalancerHostChurn(::benchmark::State& state) {
+  const uint64_t num_hosts = state.range(0);
+  const bool incremental_table = state.range(1);
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.maglev_incremental_table",
+        incremental_table ? "true" : "false"}});
+  MaglevTester tester(num_hosts);
+  const size_t start_mem = Memory::Stats::totalCurrentlyAllocated();
+  tester.maglev_lb_->initialize();
+  const size_t end_mem = Memory::Stats::totalCurrentlyAllocated();
+  state.counters["memory"] = end_mem - start_mem;
+
+  uint64_t i = 0;
+  for (auto _ : state) { // NOLINT: Silences warning about dead store
+    tester.replaceHost(i++);
+  }
+}
+BENCHMARK(benchmarkMaglevLoadBalancerHostChurn)
+    ->Args({100, 0})
+    ->Args({100, 1})
+    ->Args({500, 0})
+    ->Args({500, 1})
+    ->Unit(::benchmark::kMillisecond);
+
 class TestLoadBalancerContext : public LoadBalancerContextBase {
 public:
   // Upstream::LoadBalancerContext
@@ -21,6 +21,7 @@
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/test_runtime.h"
 
+#include "absl/container/flat_hash_map.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 
@@ -970,6 +971,70 @@ TEST_P(RoundRobinLoadBalancerTest, WeightedSeed) {
   EXPECT_EQ(hostSet().healthy_hosts_[1], lb_->chooseHost(nullptr));
 }
 
+// Validate the stride scheduler respects weights and is updated in place on host changes.
+TEST_P(RoundRobinLoadBalancerTest, WeightedStrideScheduler) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.upstream_stride_scheduler", "true"}});
+  hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime(), 1),
+                              makeTestHost(info_, "tcp://127.0.0.1:81", simTime(), 2),
+                              makeTestHost(info_, "tcp://127.0.0.1:82", simTime(), 3)};
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+
+  const auto pick_counts = [this](uint32_t picks) {
+    absl::flat_hash_map<HostConstSharedPtr, uint32_t> counts;
+    for (uint32_t i = 0; i < picks; ++i) {
+      ++counts[lb_->chooseHost(nullptr)];
+    }
+    return counts;
+  };
+  auto counts = pick_counts(6000);
+  EXPECT_NEAR(1000, counts[hostSet().healthy_hosts_[0]], 20);
+  EXPECT_NEAR(2000, counts[hostSet().healthy_hosts_[1]], 20);
+  EXPECT_NEAR(3000, counts[hostSet().healthy_hosts_[2]], 20);
+
+  // Peeked hosts are picked next.
+  const HostConstSharedPtr peeked = lb_->peekAnotherHost(nullptr);
+  EXPECT_EQ(peeked, lb_->chooseHost(nullptr));
+
+  // Remove the first host and add one with a different weight.
+  HostVector removed_hosts = {hostSet().hosts_[0]};
+  hostSet().healthy_hosts_.erase(hostSet().healthy_hosts_.begin());
+  hostSet().healthy_hosts_.push_back(makeTestHost(info_, "tcp://127.0.0.1:83", simTime(), 5));
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  hostSet().runCallbacks({hostSet().healthy_hosts_.back()}, removed_hosts);
+  counts = pick_counts(10000);
+  EXPECT_EQ(0, counts[removed_hosts[0]]);
+  EXPECT_NEAR(2000, counts[hostSet().healthy_hosts_[0]], 20);
+  EXPECT_NEAR(3000, counts[hostSet().healthy_hosts_[1]], 20);
+  EXPECT_NEAR(5000, counts[hostSet().healthy_hosts_[2]], 20);
+}
+
+// Validate weights are respected when they are too far apart for the stride scheduler, which
+// falls back to EDF.
+TEST_P(RoundRobinLoadBalancerTest, WeightedStrideSchedulerWideWeightRange) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.upstream_stride_scheduler", "true"}});
+  for (uint32_t i = 0; i < 20; ++i) {
+    hostSet().healthy_hosts_.push_back(
+        makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 80 + i), simTime(), 1));
+  }
+  hostSet().healthy_hosts_.push_back(makeTestHost(info_, "tcp://127.0.0.1:100", simTime(), 100));
+  hostSet().hosts_ = hostSet().healthy_hosts_;
+  init(false);
+
+  absl::flat_hash_map<HostConstSharedPtr, uint32_t> counts;
+  for (uint32_t i = 0; i < 1200; ++i) {
+    ++counts[lb_->chooseHost(nullptr)];
+  }
+  for (uint32_t i = 0; i < 20; ++i) {
+    EXPECT_NEAR(10, counts[hostSet().healthy_hosts_[i]], 1);
+  }
+  EXPECT_NEAR(1000, counts[hostSet().healthy_hosts_[20]], 2);
+}
+
 TEST_P(RoundRobinLoadBalancerTest, MaxUnhealthyPanic) {
   hostSet().healthy_hosts_ = {makeTestHost(info_, "tcp://127.0.0.1:80", simTime()),
                               makeTestHost(info_, "tcp://127.0.0.1:81", simTime())};
@@ -10,6 +10,7 @@
 #include "test/mocks/upstream/host_set.h"
 #include "test/mocks/upstream/priority_set.h"
 #include "test/test_common/simulated_time_system.h"
+#include "test/test_common/test_runtime.h"
 
 namespace Envoy {
 namespace Upstream {
@@ -436,6 +437,93 @@ TEST_F(MaglevLoadBalancerTest, LocalityWeightedLopsided) {
   EXPECT_EQ(MaglevTable::DefaultTableSize - 1023, counts[0]);
 }
 
+// With incremental updates, removing a host only moves the keys of that host, and adding a host
+// only moves keys to it.
+TEST_F(MaglevLoadBalancerTest, IncrementalUpdate) {
+  TestScopedRuntime scoped_runtime;
+  Runtime::LoaderSingleton::getExisting()->mergeValues(
+      {{"envoy.reloadable_features.maglev_incremental_table", "true"}});
+
+  constexpr uint64_t table_size = 1021;
+  for (uint32_t i = 0; i < 6; ++i) {
+    host_set_.hosts_.push_back(
+        makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 90 + i), simTime()));
+  }
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  init(table_size);
+
+  const auto assignments = [this]() {
+    LoadBalancerPtr lb = lb_->factory()->create();
+    std::vector<HostConstSharedPtr> hosts;
+    for (uint32_t i = 0; i < table_size; ++i) {
+      TestLoadBalancerContext context(i);
+      hosts.push_back(lb->chooseHost(&context));
+    }
+    return hosts;
+  };
+  const std::vector<HostConstSharedPtr> initial = assignments();
+
+  HostSharedPtr removed = host_set_.hosts_[2];
+  host_set_.hosts_.erase(host_set_.hosts_.begin() + 2);
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {removed});
+  EXPECT_EQ(204, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(205, lb_->stats().max_entries_per_host_.value());
+
+  const std::vector<HostConstSharedPtr> after_removal = assignments();
+  for (uint32_t i = 0; i < table_size; ++i) {
+    if (initial[i] != removed) {
+      EXPECT_EQ(initial[i], after_removal[i]);
+    }
+  }
+
+  HostSharedPtr added = makeTestHost(info_, "tcp://127.0.0.1:96", simTime());
+  host_set_.hosts_.push_back(added);
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({added}, {});
+  EXPECT_EQ(170, lb_->stats().min_entries_per_host_.value());
+  EXPECT_EQ(171, lb_->stats().max_entries_per_host_.value());
+
+  const std::vector<HostConstSharedPtr> after_addition = assignments();
+  uint32_t moved = 0;
+  for (uint32_t i = 0; i < table_size; ++i) {
+    if (after_removal[i] != after_addition[i]) {
+      EXPECT_EQ(added, after_addition[i]);
+      ++moved;
+    }
+  }
+  EXPECT_LE(moved, 171);
+  EXPECT_GE(moved, 170);
+}
+
+// Without incremental updates, the table only depends on the current hosts.
+TEST_F(MaglevLoadBalancerTest, FullRebuildIsHistoryIndependent) {
+  for (uint32_t i = 0; i < 6; ++i) {
+    host_set_.hosts_.push_back(
+        makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 90 + i), simTime()));
+  }
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {});
+  init(7);
+
+  HostSharedPtr removed = host_set_.hosts_.back();
+  host_set_.hosts_.pop_back();
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({}, {removed});
+  host_set_.hosts_.push_back(removed);
+  host_set_.healthy_hosts_ = host_set_.hosts_;
+  host_set_.runCallbacks({removed}, {});
+
+  // Same as the Basic test.
+  LoadBalancerPtr lb = lb_->factory()->create();
+  const std::vector<uint32_t> expected_assignments{2, 4, 0, 1, 5, 0, 3};
+  for (uint32_t i = 0; i < expected_assignments.size(); ++i) {
+    TestLoadBalancerContext context(i);
+    EXPECT_EQ(host_set_.hosts_[expected_assignments[i]], lb->chooseHost(&context));
+  }
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
@@ -792,6 +792,41 @@ TEST_P(RingHashLoadBalancerTest, LopsidedWeightSmallScale) {
   }
 }
 
+// Given hosts which are added, removed and re-weighted, expect the ring built from the previous
+// ring to map keys as a ring built from scratch does.
+TEST_P(RingHashLoadBalancerTest, IncrementalUpdateMatchesFullBuild) {
+  for (uint32_t i = 0; i < 6; ++i) {
+    hostSet().hosts_.push_back(
+        makeTestHost(info_, fmt::format("tcp://127.0.0.1:{}", 90 + i), simTime(), i + 1));
+  }
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({}, {});
+
+  config_ = envoy::config::cluster::v3::Cluster::RingHashLbConfig();
+  config_.value().mutable_minimum_ring_size()->set_value(1024);
+  init();
+
+  HostSharedPtr removed = hostSet().hosts_[1];
+  HostSharedPtr added = makeTestHost(info_, "tcp://127.0.0.1:96", simTime(), 2);
+  hostSet().hosts_.erase(hostSet().hosts_.begin() + 1);
+  hostSet().hosts_.push_back(added);
+  hostSet().hosts_[0]->weight(4);
+  hostSet().hosts_[3]->weight(1);
+  hostSet().healthy_hosts_ = hostSet().hosts_;
+  hostSet().runCallbacks({added}, {removed});
+  LoadBalancerPtr lb = lb_->factory()->create();
+
+  RingHashLoadBalancer full_lb(priority_set_, stats_, stats_store_, runtime_, random_, config_,
+                               common_config_);
+  full_lb.initialize();
+  LoadBalancerPtr full = full_lb.factory()->create();
+
+  for (uint32_t i = 0; i < 10000; ++i) {
+    TestLoadBalancerContext context(i * (std::numeric_limits<uint64_t>::max() / 10000));
+    EXPECT_EQ(full->chooseHost(&context), lb->chooseHost(&context));
+  }
+}
+
 } // namespace
 } // namespace Upstream
 } // namespace Envoy
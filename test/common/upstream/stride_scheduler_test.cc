@@ -0,0 +1,157 @@
+#include "common/upstream/stride_scheduler.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Upstream {
+namespace {
+
+TEST(StrideSchedulerTest, Empty) {
+  StrideScheduler<uint32_t> sched;
+  EXPECT_TRUE(sched.empty());
+  EXPECT_EQ(nullptr, sched.peekAgain([](const double&) { return 0; }));
+  EXPECT_EQ(nullptr, sched.pickAndAdd([](const double&) { return 0; }));
+  EXPECT_EQ(0, sched.expectedPickCost());
+}
+
+// Validate we get regular RR behavior when all weights are the same.
+TEST(StrideSchedulerTest, Unweighted) {
+  StrideScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 128;
+  std::shared_ptr<uint32_t> entries[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(1, entries[i]);
+  }
+  EXPECT_EQ(1, sched.expectedPickCost());
+
+  for (uint32_t rounds = 0; rounds < 128; ++rounds) {
+    for (uint32_t i = 0; i < num_entries; ++i) {
+      auto peek = sched.peekAgain([](const double&) { return 1; });
+      auto p = sched.pickAndAdd([](const double&) { return 1; });
+      EXPECT_EQ(i, *p);
+      EXPECT_EQ(*peek, *p);
+    }
+  }
+}
+
+// Validate we get weighted RR behavior when weights are distinct.
+TEST(StrideSchedulerTest, Weighted) {
+  StrideScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 16;
+  std::shared_ptr<uint32_t> entries[num_entries];
+  uint32_t pick_count[num_entries];
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries[i] = std::make_shared<uint32_t>(i);
+    sched.add(i + 1, entries[i]);
+    pick_count[i] = 0;
+  }
+  EXPECT_NEAR(16.0 / 8.5, sched.expectedPickCost(), 0.01);
+
+  constexpr uint32_t rounds = 1000;
+  for (uint32_t i = 0; i < rounds * (num_entries * (1 + num_entries)) / 2; ++i) {
+    auto peek = sched.peekAgain([](const double& orig) { return orig + 1; });
+    auto p = sched.pickAndAdd([](const double& orig) { return orig + 1; });
+    EXPECT_EQ(*p, *peek);
+    ++pick_count[*p];
+  }
+
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    EXPECT_NEAR(rounds * (i + 1), pick_count[i], rounds * 0.01 * (i + 1));
+  }
+}
+
+// Validate that the weight of a picked entry is updated.
+TEST(StrideSchedulerTest, WeightChangeOnPick) {
+  StrideScheduler<uint32_t> sched;
+  auto first = std::make_shared<uint32_t>(0);
+  auto second = std::make_shared<uint32_t>(1);
+  sched.add(1, first);
+  sched.add(1, second);
+
+  // The first entry gets a weight of 3 when picked.
+  const auto calculate_weight = [](const uint32_t& entry) { return entry == 0 ? 3 : 1; };
+  uint32_t pick_count[2] = {0, 0};
+  for (uint32_t i = 0; i < 4000; ++i) {
+    ++pick_count[*sched.pickAndAdd(calculate_weight)];
+  }
+  EXPECT_NEAR(3000, pick_count[0], 30);
+  EXPECT_NEAR(1000, pick_count[1], 30);
+}
+
+// Validate that update() adds, removes and re-weights entries in place.
+TEST(StrideSchedulerTest, Update) {
+  StrideScheduler<uint32_t> sched;
+  constexpr uint32_t num_entries = 8;
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    entries.push_back(std::make_shared<uint32_t>(i));
+  }
+  const auto calculate_weight = [](const uint32_t& entry) { return entry + 1; };
+  sched.update(entries, calculate_weight);
+  EXPECT_EQ(num_entries, sched.size());
+
+  // Remove the odd entries.
+  std::vector<std::shared_ptr<uint32_t>> even_entries;
+  for (uint32_t i = 0; i < num_entries; i += 2) {
+    even_entries.push_back(entries[i]);
+  }
+  sched.update(even_entries, calculate_weight);
+  EXPECT_EQ(num_entries / 2, sched.size());
+
+  uint32_t pick_count[num_entries] = {};
+  constexpr uint32_t rounds = 1000;
+  // The weights of the even entries add up to 16.
+  for (uint32_t i = 0; i < rounds * 16; ++i) {
+    ++pick_count[*sched.pickAndAdd(calculate_weight)];
+  }
+  for (uint32_t i = 0; i < num_entries; ++i) {
+    if (i % 2 == 0) {
+      EXPECT_NEAR(rounds * (i + 1), pick_count[i], rounds * 0.01 * (i + 1));
+    } else {
+      EXPECT_EQ(0, pick_count[i]);
+    }
+  }
+
+  sched.remove(*entries[0]);
+  sched.remove(*entries[1]);
+  EXPECT_EQ(num_entries / 2 - 1, sched.size());
+  for (uint32_t i = 0; i < 100; ++i) {
+    EXPECT_NE(0, *sched.pickAndAdd(calculate_weight));
+  }
+}
+
+// Validate that entries removed after being peeked aren't picked.
+TEST(StrideSchedulerTest, RemoveAfterPeek) {
+  StrideScheduler<uint32_t> sched;
+  auto first = std::make_shared<uint32_t>(0);
+  auto second = std::make_shared<uint32_t>(1);
+  sched.add(1, first);
+  sched.add(1, second);
+
+  EXPECT_EQ(0, *sched.peekAgain([](const double&) { return 1; }));
+  sched.remove(*first);
+  EXPECT_EQ(1, *sched.pickAndAdd([](const double&) { return 1; }));
+}
+
+// Validate that the expected pick cost grows with the range of the weights.
+TEST(StrideSchedulerTest, ExpectedPickCost) {
+  StrideScheduler<uint32_t> sched;
+  std::vector<std::shared_ptr<uint32_t>> entries;
+  for (uint32_t i = 0; i < 100; ++i) {
+    entries.push_back(std::make_shared<uint32_t>(i));
+    sched.add(i == 0 ? 100 : 1, entries.back());
+  }
+  EXPECT_NEAR(100.0 * 100 / 199, sched.expectedPickCost(), 0.1);
+
+  sched.remove(*entries[0]);
+  sched.update(std::vector<std::shared_ptr<uint32_t>>(entries.begin() + 1, entries.end()),
+               [](const uint32_t&) { return 1; });
+  EXPECT_EQ(1, sched.expectedPickCost());
+}
+
+} // namespace
+} // namespace Upstream
+} // namespace Envoy
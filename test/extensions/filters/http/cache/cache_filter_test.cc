@@ -18,6 +18,40 @@ namespace HttpFilters {
 namespace Cache {
 namespace {
 
+// Finds responses in a SimpleHttpCache, but then fails to read their bodies, as a cache whose
+// storage is removed underneath it would.
+class BodylessLookupContext : public LookupContext {
+public:
+  explicit BodylessLookupContext(LookupContextPtr&& context) : context_(std::move(context)) {}
+
+  void getHeaders(LookupHeadersCallback&& cb) override { context_->getHeaders(std::move(cb)); }
+  void getBody(const AdjustedByteRange&, LookupBodyCallback&& cb) override { cb(nullptr); }
+  void getTrailers(LookupTrailersCallback&& cb) override { context_->getTrailers(std::move(cb)); }
+  void onDestroy() override { context_->onDestroy(); }
+
+  LookupContextPtr context_;
+};
+
+class BodylessHttpCache : public HttpCache {
+public:
+  LookupContextPtr makeLookupContext(LookupRequest&& request) override {
+    return std::make_unique<BodylessLookupContext>(cache_.makeLookupContext(std::move(request)));
+  }
+  InsertContextPtr makeInsertContext(LookupContextPtr&& lookup_context) override {
+    return cache_.makeInsertContext(
+        std::move(dynamic_cast<BodylessLookupContext&>(*lookup_context).context_));
+  }
+  void updateHeaders(const LookupContext& lookup_context,
+                     const Http::ResponseHeaderMap& response_headers,
+                     const ResponseMetadata& metadata) override {
+    cache_.updateHeaders(lookup_context, response_headers, metadata);
+  }
+  CacheInfo cacheInfo() const override { return cache_.cacheInfo(); }
+
+private:
+  SimpleHttpCache cache_;
+};
+
 class CacheFilterTest : public ::testing::Test {
 protected:
   // The filter has to be created as a shared_ptr to enable shared_from_this() which is used in the
@@ -245,6 +279,42 @@ TEST_F(CacheFilterTest, CacheHitWithBody) {
   }
 }
 
+TEST_F(CacheFilterTest, CacheHitWithUnreadableBody) {
+  request_headers_.setHost("CacheHitWithUnreadableBody");
+  const std::string body = "abc";
+  BodylessHttpCache cache;
+
+  {
+    // Create filter for request 1.
+    CacheFilterSharedPtr filter = makeFilter(cache);
+
+    testDecodeRequestMiss(filter);
+
+    // Encode response.
+    Buffer::OwnedImpl buffer(body);
+    response_headers_.setContentLength(body.size());
+    EXPECT_EQ(filter->encodeHeaders(response_headers_, false), Http::FilterHeadersStatus::Continue);
+    EXPECT_EQ(filter->encodeData(buffer, true), Http::FilterDataStatus::Continue);
+
+    filter->onDestroy();
+  }
+  waitBeforeSecondRequest();
+  {
+    // Create filter for request 2. The cached headers are served, but as the body can't be read
+    // the stream is reset.
+    CacheFilterSharedPtr filter = makeFilter(cache);
+    EXPECT_CALL(decoder_callbacks_, encodeHeaders_(IsSupersetOfHeaders(response_headers_), false));
+    EXPECT_CALL(decoder_callbacks_, encodeData).Times(0);
+    EXPECT_CALL(decoder_callbacks_, resetStream());
+
+    EXPECT_EQ(filter->decodeHeaders(request_headers_, true),
+              Http::FilterHeadersStatus::StopAllIterationAndWatermark);
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+
+    filter->onDestroy();
+  }
+}
+
 TEST_F(CacheFilterTest, SuccessfulValidation) {
   request_headers_.setHost("SuccessfulValidation");
   const std::string body = "abc";
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "envoy/http/header_map.h"
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/filesystem/directory.h"
+
+#include "source/extensions/filters/http/cache/file_system_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/cache_headers_utils.h"
+#include "extensions/filters/http/cache/file_system_http_cache/file_system_http_cache.h"
+#include "extensions/filters/http/cache/file_system_http_cache/io_thread_pool.h"
+
+#include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using envoy::source::extensions::filters::http::cache::FileSystemHttpCacheConfig;
+using testing::NiceMock;
+using testing::ReturnRef;
+
+envoy::extensions::filters::http::cache::v3alpha::CacheConfig getConfig() {
+  // Allows 'accept' to be varied in the tests.
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  const auto& add_accept = config.mutable_allowed_vary_headers()->Add();
+  add_accept->set_exact("accept");
+  return config;
+}
+
+std::vector<std::string> listFiles(const std::string& path) {
+  std::vector<std::string> files;
+  for (const Filesystem::DirectoryEntry& entry : Filesystem::Directory(path)) {
+    if (entry.type_ == Filesystem::FileType::Regular) {
+      files.push_back(entry.name_);
+    }
+  }
+  return files;
+}
+
+class FileSystemHttpCacheTest : public testing::Test {
+protected:
+  FileSystemHttpCacheTest() : vary_allow_list_(getConfig().allowed_vary_headers()) {
+    TestEnvironment::removePath(cache_path_);
+    config_.set_cache_path(cache_path_);
+    config_.set_io_threads(2);
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCopy(Http::CustomHeaders::get().CacheControl, "max-age=3600");
+    response_headers_ = Http::TestResponseHeaderMapImpl{
+        {"date", formatter_.fromTime(current_time_)}, {"cache-control", "public,max-age=3600"}};
+  }
+
+  ~FileSystemHttpCacheTest() override {
+    cache_.reset();
+    TestEnvironment::removePath(cache_path_);
+  }
+
+  // (Re)creates the cache from config_, and waits for it to load the existing entries.
+  void createCache() {
+    cache_.reset();
+    cache_ = std::make_unique<FileSystemHttpCache>(config_, Thread::threadFactoryForTest());
+    cache_->waitForIoForTest();
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    LookupRequest request = makeLookupRequest(request_path);
+    LookupContextPtr context = cache_->makeLookupContext(std::move(request));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a value into the cache, and waits for it to be written.
+  void insert(LookupContextPtr lookup, const Http::TestResponseHeaderMapImpl& response_headers,
+              const absl::string_view response_body) {
+    InsertContextPtr inserter = cache_->makeInsertContext(move(lookup));
+    const ResponseMetadata metadata = {current_time_};
+    inserter->insertHeaders(response_headers, metadata, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+    cache_->waitForIoForTest();
+  }
+
+  void insert(absl::string_view request_path, const absl::string_view response_body) {
+    insert(lookup(request_path), response_headers_, response_body);
+  }
+
+  // Reads a body range, waiting for the IO threads. Returns nullptr if the read failed.
+  Buffer::InstancePtr getBodyBuffer(LookupContext& context, uint64_t start, uint64_t end) {
+    absl::Notification done;
+    Buffer::InstancePtr body;
+    context.getBody(AdjustedByteRange(start, end), [&](Buffer::InstancePtr&& data) {
+      body = std::move(data);
+      done.Notify();
+    });
+    done.WaitForNotification();
+    return body;
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    Buffer::InstancePtr body = getBodyBuffer(context, start, end);
+    EXPECT_NE(body, nullptr);
+    return body ? body->toString() : "";
+  }
+
+  LookupRequest makeLookupRequest(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    return LookupRequest(request_headers_, current_time_, vary_allow_list_);
+  }
+
+  AssertionResult expectLookupSuccessWithBody(LookupContext* lookup_context,
+                                              absl::string_view body) {
+    if (lookup_result_.cache_entry_status_ != CacheEntryStatus::Ok) {
+      return AssertionFailure() << "Expected: lookup_result_.cache_entry_status == "
+                                   "CacheEntryStatus::Ok\n  Actual: "
+                                << lookup_result_.cache_entry_status_;
+    }
+    if (!lookup_result_.headers_) {
+      return AssertionFailure() << "Expected nonnull lookup_result_.headers";
+    }
+    if (!lookup_context) {
+      return AssertionFailure() << "Expected nonnull lookup_context";
+    }
+    const std::string actual_body = getBody(*lookup_context, 0, body.size());
+    if (body != actual_body) {
+      return AssertionFailure() << "Expected body == " << body << "\n  Actual:  " << actual_body;
+    }
+    return AssertionSuccess();
+  }
+
+  bool cached(absl::string_view request_path) {
+    lookup(request_path);
+    return lookup_result_.cache_entry_status_ == CacheEntryStatus::Ok;
+  }
+
+  const std::string cache_path_{TestEnvironment::temporaryPath("file_system_http_cache")};
+  FileSystemHttpCacheConfig config_;
+  std::unique_ptr<FileSystemHttpCache> cache_;
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+  Http::TestResponseHeaderMapImpl response_headers_;
+  Event::SimulatedTimeSystem time_source_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  VaryHeader vary_allow_list_;
+};
+
+// Simple flow of putting in an item, getting it, replacing it.
+TEST_F(FileSystemHttpCacheTest, PutGet) {
+  createCache();
+  const std::string RequestPath1("Name");
+  LookupContextPtr name_lookup_context = lookup(RequestPath1);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  const std::string Body1("Value");
+  insert(move(name_lookup_context), response_headers_, Body1);
+  name_lookup_context = lookup(RequestPath1);
+  EXPECT_TRUE(expectLookupSuccessWithBody(name_lookup_context.get(), Body1));
+
+  const std::string& RequestPath2("Another Name");
+  LookupContextPtr another_name_lookup_context = lookup(RequestPath2);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  const std::string NewBody1("NewValue");
+  insert(move(name_lookup_context), response_headers_, NewBody1);
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup(RequestPath1).get(), NewBody1));
+
+  // The replaced entry's file is removed.
+  EXPECT_EQ(1, cache_->entryCount());
+  EXPECT_EQ(1, listFiles(cache_path_).size());
+}
+
+TEST_F(FileSystemHttpCacheTest, Miss) {
+  createCache();
+  LookupContextPtr name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+}
+
+TEST_F(FileSystemHttpCacheTest, StreamingPut) {
+  createCache();
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("request_path"));
+  const ResponseMetadata metadata = {current_time_};
+  inserter->insertHeaders(response_headers_, metadata, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  cache_->waitForIoForTest();
+
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_NE(nullptr, lookup_result_.headers_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("Hello, World!", getBody(*name_lookup_context, 0, 13));
+  EXPECT_EQ("World", getBody(*name_lookup_context, 7, 12));
+}
+
+TEST_F(FileSystemHttpCacheTest, Trailers) {
+  createCache();
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("/"));
+  inserter->insertHeaders(response_headers_, ResponseMetadata{current_time_}, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("body"), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertTrailers(Http::TestResponseTrailerMapImpl{{"grpc-status", "0"}});
+  cache_->waitForIoForTest();
+
+  LookupContextPtr context = lookup("/");
+  ASSERT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_TRUE(lookup_result_.has_trailers_);
+  EXPECT_EQ("body", getBody(*context, 0, 4));
+  Http::ResponseTrailerMapPtr trailers;
+  context->getTrailers(
+      [&trailers](Http::ResponseTrailerMapPtr&& result) { trailers = std::move(result); });
+  ASSERT_NE(nullptr, trailers);
+  Http::TestResponseTrailerMapImpl expected_trailers{{"grpc-status", "0"}};
+  EXPECT_THAT(*trailers, HeaderMapEqualRef(&expected_trailers));
+}
+
+TEST_F(FileSystemHttpCacheTest, VaryResponses) {
+  createCache();
+  // Responses will vary on accept.
+  const std::string RequestPath("some-resource");
+  Http::TestResponseHeaderMapImpl response_headers{{"date", formatter_.fromTime(current_time_)},
+                                                   {"cache-control", "public,max-age=3600"},
+                                                   {"vary", "accept"}};
+
+  // First request.
+  request_headers_.setCopy(Http::LowerCaseString("accept"), "image/*");
+  LookupContextPtr first_value_vary = lookup(RequestPath);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  const std::string Body1("accept is image/*");
+  insert(move(first_value_vary), response_headers, Body1);
+  first_value_vary = lookup(RequestPath);
+  EXPECT_TRUE(expectLookupSuccessWithBody(first_value_vary.get(), Body1));
+
+  // Second request with a different value for the varied header.
+  request_headers_.setCopy(Http::LowerCaseString("accept"), "text/html");
+  LookupContextPtr second_value_vary = lookup(RequestPath);
+  // Should miss because we don't have this version of the response saved yet.
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  // Add second version and make sure we receive the correct one..
+  const std::string Body2("accept is text/html");
+  insert(move(second_value_vary), response_headers, Body2);
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup(RequestPath).get(), Body2));
+
+  // Looks up first version again to be sure it wasn't replaced with the second one.
+  EXPECT_TRUE(expectLookupSuccessWithBody(first_value_vary.get(), Body1));
+
+  // One marker entry and two varied responses.
+  EXPECT_EQ(3, cache_->entryCount());
+}
+
+TEST_F(FileSystemHttpCacheTest, MmapBodies) {
+  config_.set_use_mmap(true);
+  createCache();
+  std::string body(10000, 'a');
+  body[5000] = 'b';
+  insert("/", body);
+
+  LookupContextPtr context = lookup("/");
+  EXPECT_TRUE(expectLookupSuccessWithBody(context.get(), body));
+  // A range which doesn't start on a page boundary.
+  EXPECT_EQ("ab", getBody(*context, 4999, 5001));
+}
+
+// Large bodies are read in parts, so that they aren't held in memory at once.
+TEST_F(FileSystemHttpCacheTest, LargeBodyIsReadInParts) {
+  config_.set_max_entry_size_bytes(4 * 1024 * 1024);
+  createCache();
+  const std::string body(3 * 1024 * 1024, 'a');
+  insert("/", body);
+
+  LookupContextPtr context = lookup("/");
+  ASSERT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  uint64_t read = 0;
+  int reads = 0;
+  while (read < body.size()) {
+    Buffer::InstancePtr part = getBodyBuffer(*context, read, body.size());
+    ASSERT_NE(nullptr, part);
+    ASSERT_GT(part->length(), 0);
+    read += part->length();
+    ++reads;
+  }
+  EXPECT_EQ(body.size(), read);
+  EXPECT_GT(reads, 1);
+}
+
+// Entries written by a previous instance, e.g. before a hot restart, are served.
+TEST_F(FileSystemHttpCacheTest, EntriesSurviveRestart) {
+  createCache();
+  insert("/a", "body a");
+  insert("/b", "body b");
+  const uint64_t size_bytes = cache_->sizeBytes();
+
+  createCache();
+  EXPECT_EQ(2, cache_->entryCount());
+  EXPECT_EQ(size_bytes, cache_->sizeBytes());
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup("/a").get(), "body a"));
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup("/b").get(), "body b"));
+}
+
+// Incomplete and corrupt entry files are removed at startup. Other files are left alone.
+TEST_F(FileSystemHttpCacheTest, RemovesInvalidFilesAtStartup) {
+  createCache();
+  insert("/a", "body a");
+  ASSERT_EQ(1, listFiles(cache_path_).size());
+  const std::string entry_file = listFiles(cache_path_)[0];
+  const std::string contents =
+      TestEnvironment::readFileToStringForTest(absl::StrCat(cache_path_, "/", entry_file));
+  cache_.reset();
+
+  const std::string truncated = "0123456789abcdef-0123456789abcdef";
+  TestEnvironment::writeStringToFileForTest(absl::StrCat(cache_path_, "/", truncated),
+                                            contents.substr(0, contents.size() - 1), true);
+  const std::string temporary = absl::StrCat(entry_file.substr(0, 17), "0000000000000000.tmp");
+  TestEnvironment::writeStringToFileForTest(absl::StrCat(cache_path_, "/", temporary), contents,
+                                            true);
+  TestEnvironment::writeStringToFileForTest(absl::StrCat(cache_path_, "/other"), "other", true);
+
+  createCache();
+  EXPECT_EQ(1, cache_->entryCount());
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup("/a").get(), "body a"));
+  std::vector<std::string> files = listFiles(cache_path_);
+  std::sort(files.begin(), files.end());
+  EXPECT_THAT(files, testing::ElementsAre(entry_file, "other"));
+}
+
+TEST_F(FileSystemHttpCacheTest, EvictsLeastRecentlyUsed) {
+  createCache();
+  const std::string body(1000, 'a');
+  insert("/a", body);
+  const uint64_t entry_size = cache_->sizeBytes();
+
+  config_.set_max_size_bytes(3 * entry_size);
+  config_.set_max_entry_size_bytes(entry_size);
+  createCache();
+  insert("/b", body);
+  insert("/c", body);
+
+  // Using /a makes /b the least recently used entry.
+  EXPECT_TRUE(cached("/a"));
+  insert("/d", body);
+  EXPECT_FALSE(cached("/b"));
+  EXPECT_TRUE(cached("/a"));
+  EXPECT_TRUE(cached("/c"));
+  EXPECT_TRUE(cached("/d"));
+  EXPECT_EQ(3 * entry_size, cache_->sizeBytes());
+  EXPECT_EQ(3, listFiles(cache_path_).size());
+}
+
+TEST_F(FileSystemHttpCacheTest, TooLargeEntryIsNotCached) {
+  config_.set_max_entry_size_bytes(1000);
+  createCache();
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("/"));
+  inserter->insertHeaders(response_headers_, ResponseMetadata{current_time_}, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl(std::string(1000, 'a')), [](bool ready) { EXPECT_FALSE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("a"), nullptr, true);
+  cache_->waitForIoForTest();
+
+  EXPECT_FALSE(cached("/"));
+  EXPECT_EQ(0, listFiles(cache_path_).size());
+}
+
+// A body whose entry was replaced after the lookup can't be read any more.
+TEST_F(FileSystemHttpCacheTest, ReadAfterReplaceFails) {
+  createCache();
+  insert("/", "old");
+  LookupContextPtr context = lookup("/");
+  ASSERT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  insert("/", "new");
+  EXPECT_EQ(nullptr, getBodyBuffer(*context, 0, 3));
+}
+
+TEST(IoThreadPoolTest, RunsAllTasksBeforeDestruction) {
+  std::atomic<int> runs{0};
+  {
+    IoThreadPool pool(Thread::threadFactoryForTest(), 3, "test");
+    for (int i = 0; i < 1000; ++i) {
+      pool.post([&runs]() { ++runs; });
+    }
+    pool.waitForIdle();
+    EXPECT_EQ(1000, runs);
+    for (int i = 0; i < 1000; ++i) {
+      pool.post([&runs]() { ++runs; });
+    }
+  }
+  EXPECT_EQ(2000, runs);
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.FileSystemHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  ON_CALL(factory_context.api_, threadFactory())
+      .WillByDefault(ReturnRef(Thread::threadFactoryForTest()));
+
+  FileSystemHttpCacheConfig file_system_config;
+  file_system_config.set_cache_path(TestEnvironment::temporaryPath("file_system_http_cache_reg"));
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(file_system_config);
+  HttpCache& cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache.cacheInfo().name_, "envoy.extensions.http.cache.file_system");
+  EXPECT_EQ(&cache, &factory->getCache(config, factory_context));
+
+  // A directory can't be shared by differently configured caches.
+  file_system_config.set_max_size_bytes(1);
+  config.mutable_typed_config()->PackFrom(file_system_config);
+  EXPECT_THROW_WITH_REGEX(factory->getCache(config, factory_context), EnvoyException,
+                          "already used with a different configuration");
+
+  config.mutable_typed_config()->PackFrom(FileSystemHttpCacheConfig());
+  EXPECT_THROW_WITH_MESSAGE(factory->getCache(config, factory_context), EnvoyException,
+                            "file system http cache: cache_path must be set");
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
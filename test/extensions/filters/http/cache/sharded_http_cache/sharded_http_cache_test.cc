@@ -0,0 +1,382 @@
+#include <thread>
+#include <vector>
+
+#include "envoy/http/header_map.h"
+#include "envoy/registry/registry.h"
+
+#include "common/buffer/buffer_impl.h"
+
+#include "source/extensions/filters/http/cache/sharded_http_cache/config.pb.h"
+
+#include "extensions/filters/http/cache/cache_headers_utils.h"
+#include "extensions/filters/http/cache/sharded_http_cache/sharded_http_cache.h"
+
+#include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/server/factory_context.h"
+#include "test/test_common/simulated_time_system.h"
+#include "test/test_common/utility.h"
+
+#include "absl/strings/str_cat.h"
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace HttpFilters {
+namespace Cache {
+namespace {
+
+using testing::NiceMock;
+
+envoy::extensions::filters::http::cache::v3alpha::CacheConfig getConfig() {
+  // Allows 'accept' to be varied in the tests.
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  const auto& add_accept = config.mutable_allowed_vary_headers()->Add();
+  add_accept->set_exact("accept");
+  return config;
+}
+
+class ShardedHttpCacheTest : public testing::Test {
+protected:
+  ShardedHttpCacheTest() : vary_allow_list_(getConfig().allowed_vary_headers()) {
+    request_headers_.setMethod("GET");
+    request_headers_.setHost("example.com");
+    request_headers_.setForwardedProto("https");
+    request_headers_.setCopy(Http::CustomHeaders::get().CacheControl, "max-age=3600");
+    response_headers_ = Http::TestResponseHeaderMapImpl{
+        {"date", formatter_.fromTime(current_time_)}, {"cache-control", "public,max-age=3600"}};
+  }
+
+  void resetCache(uint64_t max_size_bytes, uint32_t shards,
+                  ShardedHttpCache::EvictionPolicy eviction_policy) {
+    cache_ = std::make_unique<ShardedHttpCache>(max_size_bytes, shards, eviction_policy);
+  }
+
+  // Performs a cache lookup.
+  LookupContextPtr lookup(absl::string_view request_path) {
+    LookupRequest request = makeLookupRequest(request_path);
+    LookupContextPtr context = cache_->makeLookupContext(std::move(request));
+    context->getHeaders([this](LookupResult&& result) { lookup_result_ = std::move(result); });
+    return context;
+  }
+
+  // Inserts a value into the cache.
+  void insert(LookupContextPtr lookup, const Http::TestResponseHeaderMapImpl& response_headers,
+              const absl::string_view response_body) {
+    InsertContextPtr inserter = cache_->makeInsertContext(move(lookup));
+    const ResponseMetadata metadata = {current_time_};
+    inserter->insertHeaders(response_headers, metadata, false);
+    inserter->insertBody(Buffer::OwnedImpl(response_body), nullptr, true);
+  }
+
+  void insert(absl::string_view request_path, const absl::string_view response_body) {
+    insert(lookup(request_path), response_headers_, response_body);
+  }
+
+  Buffer::InstancePtr getBodyBuffer(LookupContext& context, uint64_t start, uint64_t end) {
+    AdjustedByteRange range(start, end);
+    Buffer::InstancePtr body;
+    context.getBody(range, [&body](Buffer::InstancePtr&& data) { body = std::move(data); });
+    EXPECT_NE(body, nullptr);
+    return body;
+  }
+
+  std::string getBody(LookupContext& context, uint64_t start, uint64_t end) {
+    Buffer::InstancePtr body = getBodyBuffer(context, start, end);
+    return body ? body->toString() : "";
+  }
+
+  LookupRequest makeLookupRequest(absl::string_view request_path) {
+    request_headers_.setPath(request_path);
+    return LookupRequest(request_headers_, current_time_, vary_allow_list_);
+  }
+
+  AssertionResult expectLookupSuccessWithBody(LookupContext* lookup_context,
+                                              absl::string_view body) {
+    if (lookup_result_.cache_entry_status_ != CacheEntryStatus::Ok) {
+      return AssertionFailure() << "Expected: lookup_result_.cache_entry_status == "
+                                   "CacheEntryStatus::Ok\n  Actual: "
+                                << lookup_result_.cache_entry_status_;
+    }
+    if (!lookup_result_.headers_) {
+      return AssertionFailure() << "Expected nonnull lookup_result_.headers";
+    }
+    if (!lookup_context) {
+      return AssertionFailure() << "Expected nonnull lookup_context";
+    }
+    const std::string actual_body = getBody(*lookup_context, 0, body.size());
+    if (body != actual_body) {
+      return AssertionFailure() << "Expected body == " << body << "\n  Actual:  " << actual_body;
+    }
+    return AssertionSuccess();
+  }
+
+  bool cached(absl::string_view request_path) {
+    lookup(request_path);
+    return lookup_result_.cache_entry_status_ == CacheEntryStatus::Ok;
+  }
+
+  // Returns the bytes charged for an entry with the given path and body.
+  uint64_t entryCharge(absl::string_view request_path, absl::string_view response_body) {
+    auto cache =
+        std::make_unique<ShardedHttpCache>(1024 * 1024, 1, ShardedHttpCache::EvictionPolicy::Lru);
+    std::swap(cache, cache_);
+    insert(request_path, response_body);
+    std::swap(cache, cache_);
+    return cache->sizeBytes();
+  }
+
+  std::unique_ptr<ShardedHttpCache> cache_{std::make_unique<ShardedHttpCache>(
+      1024 * 1024, 4, ShardedHttpCache::EvictionPolicy::Lru)};
+  LookupResult lookup_result_;
+  Http::TestRequestHeaderMapImpl request_headers_;
+  Http::TestResponseHeaderMapImpl response_headers_;
+  Event::SimulatedTimeSystem time_source_;
+  SystemTime current_time_ = time_source_.systemTime();
+  DateFormatter formatter_{"%a, %d %b %Y %H:%M:%S GMT"};
+  VaryHeader vary_allow_list_;
+};
+
+// Simple flow of putting in an item, getting it, replacing it.
+TEST_F(ShardedHttpCacheTest, PutGet) {
+  const std::string RequestPath1("Name");
+  LookupContextPtr name_lookup_context = lookup(RequestPath1);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  const std::string Body1("Value");
+  insert(move(name_lookup_context), response_headers_, Body1);
+  name_lookup_context = lookup(RequestPath1);
+  EXPECT_TRUE(expectLookupSuccessWithBody(name_lookup_context.get(), Body1));
+
+  const std::string& RequestPath2("Another Name");
+  LookupContextPtr another_name_lookup_context = lookup(RequestPath2);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+
+  const std::string NewBody1("NewValue");
+  insert(move(name_lookup_context), response_headers_, NewBody1);
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup(RequestPath1).get(), NewBody1));
+  EXPECT_EQ(1, cache_->entryCount());
+}
+
+TEST_F(ShardedHttpCacheTest, Miss) {
+  LookupContextPtr name_lookup_context = lookup("Name");
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+}
+
+TEST_F(ShardedHttpCacheTest, StreamingPut) {
+  InsertContextPtr inserter = cache_->makeInsertContext(lookup("request_path"));
+  const ResponseMetadata metadata = {current_time_};
+  inserter->insertHeaders(response_headers_, metadata, false);
+  inserter->insertBody(
+      Buffer::OwnedImpl("Hello, "), [](bool ready) { EXPECT_TRUE(ready); }, false);
+  inserter->insertBody(Buffer::OwnedImpl("World!"), nullptr, true);
+  LookupContextPtr name_lookup_context = lookup("request_path");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_NE(nullptr, lookup_result_.headers_);
+  ASSERT_EQ(13, lookup_result_.content_length_);
+  EXPECT_EQ("Hello, World!", getBody(*name_lookup_context, 0, 13));
+  EXPECT_EQ("World", getBody(*name_lookup_context, 7, 12));
+}
+
+TEST_F(ShardedHttpCacheTest, EmptyBody) {
+  insert("/", "");
+  LookupContextPtr context = lookup("/");
+  EXPECT_EQ(CacheEntryStatus::Ok, lookup_result_.cache_entry_status_);
+  EXPECT_EQ(0, lookup_result_.content_length_);
+  EXPECT_EQ("", getBody(*context, 0, 0));
+}
+
+TEST_F(ShardedHttpCacheTest, VaryResponses) {
+  // Responses will vary on accept.
+  const std::string RequestPath("some-resource");
+  Http::TestResponseHeaderMapImpl response_headers{{"date", formatter_.fromTime(current_time_)},
+                                                   {"cache-control", "public,max-age=3600"},
+                                                   {"vary", "accept"}};
+
+  // First request.
+  request_headers_.setCopy(Http::LowerCaseString("accept"), "image/*");
+  LookupContextPtr first_value_vary = lookup(RequestPath);
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  const std::string Body1("accept is image/*");
+  insert(move(first_value_vary), response_headers, Body1);
+  first_value_vary = lookup(RequestPath);
+  EXPECT_TRUE(expectLookupSuccessWithBody(first_value_vary.get(), Body1));
+
+  // Second request with a different value for the varied header.
+  request_headers_.setCopy(Http::LowerCaseString("accept"), "text/html");
+  LookupContextPtr second_value_vary = lookup(RequestPath);
+  // Should miss because we don't have this version of the response saved yet.
+  EXPECT_EQ(CacheEntryStatus::Unusable, lookup_result_.cache_entry_status_);
+  // Add second version and make sure we receive the correct one..
+  const std::string Body2("accept is text/html");
+  insert(move(second_value_vary), response_headers, Body2);
+  EXPECT_TRUE(expectLookupSuccessWithBody(lookup(RequestPath).get(), Body2));
+
+  // Looks up first version again to be sure it wasn't replaced with the second one.
+  EXPECT_TRUE(expectLookupSuccessWithBody(first_value_vary.get(), Body1));
+
+  // One marker entry and two varied responses.
+  EXPECT_EQ(3, cache_->entryCount());
+}
+
+// Hits return buffers which reference the cached body instead of copying it, and which stay valid
+// after the entry is evicted.
+TEST_F(ShardedHttpCacheTest, BodyIsSharedAndOutlivesEviction) {
+  const std::string Body(1000, 'a');
+  resetCache(entryCharge("/a", Body), 1, ShardedHttpCache::EvictionPolicy::Lru);
+  insert("/a", Body);
+
+  LookupContextPtr first = lookup("/a");
+  LookupContextPtr second = lookup("/a");
+  Buffer::InstancePtr first_body = getBodyBuffer(*first, 0, Body.size());
+  Buffer::InstancePtr second_body = getBodyBuffer(*second, 0, Body.size());
+  ASSERT_EQ(1, first_body->getRawSlices().size());
+  ASSERT_EQ(1, second_body->getRawSlices().size());
+  EXPECT_EQ(first_body->getRawSlices()[0].mem_, second_body->getRawSlices()[0].mem_);
+
+  // Replacing the entry evicts it from the cache, but not from the buffers handed out.
+  insert("/b", Body);
+  EXPECT_FALSE(cached("/a"));
+  first.reset();
+  second.reset();
+  EXPECT_EQ(Body, first_body->toString());
+  EXPECT_EQ(Body, second_body->toString());
+}
+
+TEST_F(ShardedHttpCacheTest, StaysWithinBudget) {
+  const std::string Body(1000, 'a');
+  const uint64_t charge = entryCharge("/0", Body);
+  resetCache(4 * charge, 4, ShardedHttpCache::EvictionPolicy::Lru);
+  for (int i = 0; i < 10; ++i) {
+    insert(absl::StrCat("/", i), Body);
+    EXPECT_LE(cache_->sizeBytes(), 4 * charge);
+  }
+  EXPECT_GT(cache_->entryCount(), 0);
+  EXPECT_LE(cache_->entryCount(), 4);
+}
+
+TEST_F(ShardedHttpCacheTest, EntryLargerThanShardIsNotInserted) {
+  const std::string Body(1000, 'a');
+  resetCache(entryCharge("/a", Body) - 1, 1, ShardedHttpCache::EvictionPolicy::Lru);
+  insert("/a", Body);
+  EXPECT_FALSE(cached("/a"));
+  EXPECT_EQ(0, cache_->sizeBytes());
+}
+
+TEST_F(ShardedHttpCacheTest, LruEvictsLeastRecentlyUsed) {
+  const std::string Body(1000, 'a');
+  resetCache(3 * entryCharge("/a", Body), 1, ShardedHttpCache::EvictionPolicy::Lru);
+  insert("/a", Body);
+  insert("/b", Body);
+  insert("/c", Body);
+
+  // Using /a makes /b the least recently used entry.
+  EXPECT_TRUE(cached("/a"));
+  insert("/d", Body);
+  EXPECT_FALSE(cached("/b"));
+  EXPECT_TRUE(cached("/c"));
+  EXPECT_TRUE(cached("/a"));
+  EXPECT_TRUE(cached("/d"));
+
+  // The lookups above leave /c as the least recently used entry.
+  insert("/e", Body);
+  EXPECT_FALSE(cached("/c"));
+  EXPECT_EQ(3, cache_->entryCount());
+}
+
+TEST_F(ShardedHttpCacheTest, ClockGivesReferencedEntriesSecondChance) {
+  const std::string Body(1000, 'a');
+  resetCache(3 * entryCharge("/a", Body), 1, ShardedHttpCache::EvictionPolicy::Clock);
+  insert("/a", Body);
+  insert("/b", Body);
+  insert("/c", Body);
+
+  // Without references the oldest entry is evicted.
+  insert("/d", Body);
+  EXPECT_EQ(3, cache_->entryCount());
+
+  // /b and /c were referenced by the lookups, so /d is evicted next even though it is newer.
+  EXPECT_TRUE(cached("/b"));
+  EXPECT_TRUE(cached("/c"));
+  insert("/e", Body);
+  EXPECT_TRUE(cached("/b"));
+  EXPECT_TRUE(cached("/c"));
+  EXPECT_FALSE(cached("/d"));
+  EXPECT_TRUE(cached("/e"));
+  EXPECT_FALSE(cached("/a"));
+}
+
+// Every entry was referenced, so eviction clears all reference bits before evicting the oldest.
+TEST_F(ShardedHttpCacheTest, ClockEvictsWhenAllReferenced) {
+  const std::string Body(1000, 'a');
+  resetCache(2 * entryCharge("/a", Body), 1, ShardedHttpCache::EvictionPolicy::Clock);
+  insert("/a", Body);
+  insert("/b", Body);
+  EXPECT_TRUE(cached("/a"));
+  EXPECT_TRUE(cached("/b"));
+  insert("/c", Body);
+  EXPECT_FALSE(cached("/a"));
+  EXPECT_TRUE(cached("/b"));
+  EXPECT_TRUE(cached("/c"));
+}
+
+TEST_F(ShardedHttpCacheTest, ConcurrentLookupsAndInserts) {
+  const std::string Body(100, 'a');
+  const uint64_t max_size_bytes = 20 * entryCharge("/0-0", Body);
+  resetCache(max_size_bytes, 4, ShardedHttpCache::EvictionPolicy::Clock);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([this, t, &Body]() {
+      Http::TestRequestHeaderMapImpl request_headers{{":method", "GET"},
+                                                     {":authority", "example.com"},
+                                                     {"x-forwarded-proto", "https"}};
+      for (int i = 0; i < 1000; ++i) {
+        request_headers.setPath(absl::StrCat("/", t, "-", i % 50));
+        LookupContextPtr context = cache_->makeLookupContext(
+            LookupRequest(request_headers, current_time_, vary_allow_list_));
+        bool hit = false;
+        context->getHeaders([&hit](LookupResult&& result) {
+          hit = result.cache_entry_status_ == CacheEntryStatus::Ok;
+        });
+        if (hit) {
+          context->getBody(AdjustedByteRange(0, Body.size()), [&Body](Buffer::InstancePtr&& data) {
+            EXPECT_EQ(Body, data->toString());
+          });
+          continue;
+        }
+        InsertContextPtr inserter = cache_->makeInsertContext(std::move(context));
+        inserter->insertHeaders(response_headers_, ResponseMetadata{current_time_}, false);
+        inserter->insertBody(Buffer::OwnedImpl(Body), nullptr, true);
+      }
+    });
+  }
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  EXPECT_LE(cache_->sizeBytes(), max_size_bytes);
+}
+
+TEST(Registration, GetFactory) {
+  HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
+      "envoy.source.extensions.filters.http.cache.ShardedHttpCacheConfig");
+  ASSERT_NE(factory, nullptr);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
+  envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
+  config.mutable_typed_config()->PackFrom(*factory->createEmptyConfigProto());
+  HttpCache& cache = factory->getCache(config, factory_context);
+  EXPECT_EQ(cache.cacheInfo().name_, "envoy.extensions.http.cache.sharded");
+
+  // The same settings share a cache, different settings get their own.
+  EXPECT_EQ(&cache, &factory->getCache(config, factory_context));
+  envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig sharded_config;
+  sharded_config.set_eviction_policy(
+      envoy::source::extensions::filters::http::cache::ShardedHttpCacheConfig::CLOCK);
+  config.mutable_typed_config()->PackFrom(sharded_config);
+  EXPECT_NE(&cache, &factory->getCache(config, factory_context));
+}
+
+} // namespace
+} // namespace Cache
+} // namespace HttpFilters
+} // namespace Extensions
+} // namespace Envoy
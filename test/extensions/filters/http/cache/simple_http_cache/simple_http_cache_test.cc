@@ -7,6 +7,7 @@
 #include "extensions/filters/http/cache/simple_http_cache/simple_http_cache.h"
 
 #include "test/extensions/filters/http/cache/common.h"
+#include "test/mocks/server/factory_context.h"
 #include "test/test_common/simulated_time_system.h"
 #include "test/test_common/utility.h"
 
@@ -18,6 +19,8 @@ namespace HttpFilters {
 namespace Cache {
 namespace {
 
+using testing::NiceMock;
+
 const std::string EpochDate = "Thu, 01 Jan 1970 00:00:00 GMT";
 
 envoy::extensions::filters::http::cache::v3alpha::CacheConfig getConfig() {
@@ -222,9 +225,11 @@ TEST(Registration, GetFactory) {
   HttpCacheFactory* factory = Registry::FactoryRegistry<HttpCacheFactory>::getFactoryByType(
       "envoy.source.extensions.filters.http.cache.SimpleHttpCacheConfig");
   ASSERT_NE(factory, nullptr);
+  NiceMock<Server::Configuration::MockFactoryContext> factory_context;
   envoy::extensions::filters::http::cache::v3alpha::CacheConfig config;
   config.mutable_typed_config()->PackFrom(*factory->createEmptyConfigProto());
-  EXPECT_EQ(factory->getCache(config).cacheInfo().name_, "envoy.extensions.http.cache.simple");
+  EXPECT_EQ(factory->getCache(config, factory_context).cacheInfo().name_,
+            "envoy.extensions.http.cache.simple");
 }
 
 TEST_F(SimpleHttpCacheTest, VaryResponses) {
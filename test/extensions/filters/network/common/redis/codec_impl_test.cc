@@ -276,6 +276,69 @@ TEST_F(RedisEncoderDecoderImplTest, BulkString) {
   EXPECT_EQ(0UL, buffer_.length());
 }
 
+// Large bulk strings are decoded into a buffer referencing the slices of the input, which are
+// then referenced again when the value is encoded.
+TEST_F(RedisEncoderDecoderImplTest, LargeBulkString) {
+  const std::string large(DecoderImpl::MinBufferedBulkStringLength + 100, 'x');
+  RespValue value;
+  value.type(RespType::Array);
+  value.asArray().resize(2);
+  value.asArray()[0].type(RespType::BulkString);
+  value.asArray()[0].asString() = "large";
+  value.asArray()[1].type(RespType::BulkString);
+  value.asArray()[1].asString() = large;
+  encoder_.encode(value, buffer_);
+  const std::string encoded = buffer_.toString();
+
+  // The value is split over several slices, and decoded in several calls.
+  for (uint64_t offset = 0; offset < encoded.size(); offset += 10000) {
+    Buffer::OwnedImpl input;
+    input.appendSliceForTest(encoded.substr(offset, 5000));
+    input.appendSliceForTest(encoded.substr(std::min(offset + 5000, encoded.size()), 5000));
+    decoder_.decode(input);
+    EXPECT_EQ(0UL, input.length());
+  }
+  ASSERT_EQ(1UL, decoded_values_.size());
+  const RespValue& decoded = decoded_values_[0]->asArray()[1];
+  EXPECT_EQ(nullptr, decoded_values_[0]->asArray()[0].bulkStringBuffer());
+  ASSERT_NE(nullptr, decoded.bulkStringBuffer());
+  EXPECT_EQ(large.size(), decoded.stringLength());
+  EXPECT_EQ(value, *decoded_values_[0]);
+
+  // Copies share the buffer.
+  RespValue copy = *decoded_values_[0];
+  EXPECT_EQ(decoded.bulkStringBuffer(), copy.asArray()[1].bulkStringBuffer());
+
+  Buffer::OwnedImpl output;
+  encoder_.encode(*decoded_values_[0], output);
+  EXPECT_EQ(encoded, output.toString());
+
+  // The buffer outlives the values, as long as the encoded output references it.
+  Buffer::OwnedImpl output2;
+  encoder_.encode(copy, output2);
+  decoded_values_.clear();
+  copy.asArray().clear();
+  EXPECT_EQ(encoded, output2.toString());
+
+  // The bytes are copied to the string when it is accessed.
+  RespValue copy2 = value;
+  copy2.asArray()[1].bulkStringBuffer(std::make_shared<Buffer::OwnedImpl>(large));
+  EXPECT_EQ(large, copy2.asArray()[1].asString());
+  EXPECT_EQ(nullptr, copy2.asArray()[1].bulkStringBuffer());
+}
+
+// Bulk strings below the threshold are still decoded into a string.
+TEST_F(RedisEncoderDecoderImplTest, BulkStringBelowBufferedLength) {
+  RespValue value;
+  value.type(RespType::BulkString);
+  value.asString() = std::string(DecoderImpl::MinBufferedBulkStringLength - 1, 'x');
+  encoder_.encode(value, buffer_);
+  decoder_.decode(buffer_);
+  ASSERT_EQ(1UL, decoded_values_.size());
+  EXPECT_EQ(nullptr, decoded_values_[0]->bulkStringBuffer());
+  EXPECT_EQ(value, *decoded_values_[0]);
+}
+
 TEST_F(RedisEncoderDecoderImplTest, Integer) {
   RespValue value;
   value.type(RespType::Integer);
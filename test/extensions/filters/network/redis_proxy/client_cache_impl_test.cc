@@ -0,0 +1,473 @@
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/filters/network/redis_proxy/v3/redis_proxy.pb.h"
+
+#include "common/buffer/buffer_impl.h"
+#include "common/network/utility.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/filters/network/redis_proxy/client_cache_impl.h"
+
+#include "test/mocks/event/mocks.h"
+#include "test/mocks/network/mocks.h"
+#include "test/mocks/upstream/host.h"
+#include "test/test_common/simulated_time_system.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::DoAll;
+using testing::Invoke;
+using testing::NiceMock;
+using testing::Return;
+using testing::SaveArg;
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace RedisProxy {
+
+class RedisClientCacheImplTest : public testing::Test {
+public:
+  // The state of the tracking connection to a host.
+  struct Tracking {
+    NiceMock<Network::MockClientConnection>* connection_{};
+    Network::ReadFilterSharedPtr read_filter_;
+    NiceMock<Event::MockTimer>* connect_timer_{};
+    NiceMock<Event::MockTimer>* reconnect_timer_{};
+    Event::TimerCb connect_timer_cb_;
+    Event::TimerCb reconnect_timer_cb_;
+  };
+
+  RedisClientCacheImplTest() {
+    ON_CALL(dispatcher_, approximateMonotonicTime()).WillByDefault(Invoke([this]() {
+      return time_system_.monotonicTime();
+    }));
+  }
+
+  ~RedisClientCacheImplTest() override {
+    cache_.reset();
+    EXPECT_EQ(0UL, stats_.entries_.value());
+    EXPECT_EQ(0UL, stats_.tracking_cx_ready_.value());
+  }
+
+  void setup(const std::vector<std::string>& prefixes = {}) {
+    envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::ClientSideCache config;
+    config.mutable_max_entries()->set_value(2);
+    config.mutable_max_ttl()->set_seconds(10);
+    config.mutable_max_value_bytes()->set_value(8);
+    for (const std::string& prefix : prefixes) {
+      config.add_prefixes(prefix);
+    }
+    cache_ = std::make_unique<ClientCacheImpl>(std::make_shared<ClientCacheConfig>(config),
+                                               dispatcher_, stats_);
+  }
+
+  std::shared_ptr<Upstream::MockHost> makeHost(const std::string& url) {
+    auto host = std::make_shared<NiceMock<Upstream::MockHost>>();
+    ON_CALL(*host, address()).WillByDefault(Return(Network::Utility::resolveUrl(url)));
+    return host;
+  }
+
+  void expectConnect(Upstream::MockHost& host, Tracking& tracking) {
+    tracking.connection_ = new NiceMock<Network::MockClientConnection>();
+    Upstream::MockHost::MockCreateConnectionData conn_info;
+    conn_info.connection_ = tracking.connection_;
+    EXPECT_CALL(host, createConnection_(_, _)).WillOnce(Return(conn_info));
+    EXPECT_CALL(*tracking.connection_, addReadFilter(_))
+        .WillOnce(SaveArg<0>(&tracking.read_filter_));
+    EXPECT_CALL(*tracking.connection_, connect());
+    EXPECT_CALL(*tracking.connection_, noDelay(true));
+    ON_CALL(*tracking.connection_, write(_, _))
+        .WillByDefault(Invoke([this](Buffer::Instance& data, bool) -> void {
+          written_ += data.toString();
+          data.drain(data.length());
+        }));
+  }
+
+  void addHost(std::shared_ptr<Upstream::MockHost> host, Tracking& tracking,
+               const std::string& auth_username = "", const std::string& auth_password = "") {
+    tracking.connect_timer_ = new NiceMock<Event::MockTimer>();
+    tracking.reconnect_timer_ = new NiceMock<Event::MockTimer>();
+    EXPECT_CALL(dispatcher_, createTimer_(_))
+        .WillOnce(DoAll(SaveArg<0>(&tracking.connect_timer_cb_), Return(tracking.connect_timer_)))
+        .WillOnce(
+            DoAll(SaveArg<0>(&tracking.reconnect_timer_cb_), Return(tracking.reconnect_timer_)))
+        .RetiresOnSaturation();
+    expectConnect(*host, tracking);
+    EXPECT_CALL(*tracking.connect_timer_, enableTimer(_, _));
+    cache_->addHost(host, auth_username, auth_password);
+  }
+
+  // Answers the commands turning on tracking.
+  void subscribe(Tracking& tracking, int64_t client_id = 5) {
+    written_.clear();
+    respond(tracking, integer(client_id));
+    EXPECT_EQ(command({"client", "tracking", "on", "redirect", std::to_string(client_id),
+                       "bcast"}) +
+                  command({"subscribe", "__redis__:invalidate"}),
+              written_);
+    written_.clear();
+    respond(tracking, simpleString("OK"));
+    EXPECT_CALL(*tracking.connect_timer_, disableTimer());
+    respond(tracking, array({bulkString("subscribe"), bulkString("__redis__:invalidate"),
+                             integer(1)}));
+  }
+
+  void setupReady() {
+    setup();
+    addHost(host_, tracking_);
+    subscribe(tracking_);
+  }
+
+  void respond(Tracking& tracking, const Common::Redis::RespValue& value) {
+    Buffer::OwnedImpl buffer;
+    encoder_.encode(value, buffer);
+    tracking.read_filter_->onData(buffer, false);
+  }
+
+  void invalidate(Tracking& tracking, Common::Redis::RespValue keys) {
+    respond(tracking, array({bulkString("message"), bulkString("__redis__:invalidate"), keys}));
+  }
+
+  std::string command(const std::vector<std::string>& args) {
+    std::vector<Common::Redis::RespValue> values;
+    for (const std::string& arg : args) {
+      values.push_back(bulkString(arg));
+    }
+    Buffer::OwnedImpl buffer;
+    encoder_.encode(array(values), buffer);
+    return buffer.toString();
+  }
+
+  static Common::Redis::RespValue bulkString(const std::string& string) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::BulkString);
+    value.asString() = string;
+    return value;
+  }
+
+  static Common::Redis::RespValue simpleString(const std::string& string) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::SimpleString);
+    value.asString() = string;
+    return value;
+  }
+
+  static Common::Redis::RespValue error(const std::string& string) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Error);
+    value.asString() = string;
+    return value;
+  }
+
+  static Common::Redis::RespValue integer(int64_t integer) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Integer);
+    value.asInteger() = integer;
+    return value;
+  }
+
+  static Common::Redis::RespValue array(const std::vector<Common::Redis::RespValue>& values) {
+    Common::Redis::RespValue value;
+    value.type(Common::Redis::RespType::Array);
+    value.asArray() = values;
+    return value;
+  }
+
+  void fill(const std::string& key, const Common::Redis::RespValue& value) {
+    const uint64_t fill_id = cache_->startFill(key);
+    EXPECT_NE(0UL, fill_id);
+    cache_->fill(key, fill_id, value);
+  }
+
+  bool cached(const std::string& key) { return cache_->lookup(key) != nullptr; }
+
+  Event::SimulatedTimeSystem time_system_;
+  NiceMock<Event::MockDispatcher> dispatcher_;
+  Stats::IsolatedStoreImpl store_;
+  ClientCacheStats stats_{ALL_CLIENT_CACHE_STATS(POOL_COUNTER_PREFIX(store_, "client_cache"),
+                                                 POOL_GAUGE_PREFIX(store_, "client_cache"))};
+  Common::Redis::EncoderImpl encoder_;
+  std::shared_ptr<Upstream::MockHost> host_{makeHost("tcp://127.0.0.1:6379")};
+  Tracking tracking_;
+  std::string written_;
+  ClientCacheImplPtr cache_;
+};
+
+TEST_F(RedisClientCacheImplTest, NoFillUntilTrackingReady) {
+  setup();
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+
+  addHost(host_, tracking_);
+  EXPECT_EQ(command({"client", "id"}), written_);
+  EXPECT_EQ(1UL, stats_.tracking_cx_total_.value());
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+
+  subscribe(tracking_);
+  EXPECT_EQ(1UL, stats_.tracking_cx_ready_.value());
+  EXPECT_NE(0UL, cache_->startFill("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, Auth) {
+  setup();
+  addHost(host_, tracking_, "", "password");
+  EXPECT_EQ(command({"auth", "password"}) + command({"client", "id"}), written_);
+  written_.clear();
+  respond(tracking_, simpleString("OK"));
+  subscribe(tracking_);
+  EXPECT_NE(0UL, cache_->startFill("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, AuthUsername) {
+  setup();
+  addHost(host_, tracking_, "user", "password");
+  EXPECT_EQ(command({"auth", "user", "password"}) + command({"client", "id"}), written_);
+}
+
+TEST_F(RedisClientCacheImplTest, AuthFailure) {
+  setup();
+  addHost(host_, tracking_, "", "password");
+
+  EXPECT_CALL(*tracking_.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*tracking_.reconnect_timer_,
+              enableTimer(TrackingClient::ReconnectInterval, nullptr));
+  respond(tracking_, error("ERR"));
+  EXPECT_EQ(1UL, stats_.tracking_cx_failure_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, Prefixes) {
+  setup({"user:", "session:"});
+  addHost(host_, tracking_);
+  written_.clear();
+  respond(tracking_, integer(3));
+  EXPECT_EQ(command({"client", "tracking", "on", "redirect", "3", "bcast", "prefix", "user:",
+                     "prefix", "session:"}) +
+                command({"subscribe", "__redis__:invalidate"}),
+            written_);
+  respond(tracking_, simpleString("OK"));
+  respond(tracking_,
+          array({bulkString("subscribe"), bulkString("__redis__:invalidate"), integer(1)}));
+
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+  EXPECT_NE(0UL, cache_->startFill("user:1"));
+  EXPECT_NE(0UL, cache_->startFill("session:1"));
+}
+
+TEST_F(RedisClientCacheImplTest, HandshakeFailure) {
+  setup();
+  addHost(host_, tracking_);
+
+  EXPECT_CALL(*tracking_.connection_, close(Network::ConnectionCloseType::NoFlush));
+  EXPECT_CALL(*tracking_.connect_timer_, disableTimer());
+  EXPECT_CALL(*tracking_.reconnect_timer_,
+              enableTimer(TrackingClient::ReconnectInterval, nullptr));
+  respond(tracking_, error("ERR"));
+  EXPECT_EQ(1UL, stats_.tracking_cx_failure_.value());
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+
+  // The connection is reopened, and tracking turned on again.
+  Tracking& tracking = tracking_;
+  expectConnect(*host_, tracking);
+  EXPECT_CALL(*tracking.connect_timer_, enableTimer(_, _));
+  written_.clear();
+  tracking.reconnect_timer_cb_();
+  EXPECT_EQ(2UL, stats_.tracking_cx_total_.value());
+  subscribe(tracking);
+  EXPECT_NE(0UL, cache_->startFill("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, ConnectTimeout) {
+  setup();
+  addHost(host_, tracking_);
+
+  EXPECT_CALL(*tracking_.connection_, close(Network::ConnectionCloseType::NoFlush));
+  tracking_.connect_timer_cb_();
+  EXPECT_EQ(1UL, stats_.tracking_cx_failure_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, ProtocolError) {
+  setup();
+  addHost(host_, tracking_);
+
+  EXPECT_CALL(*tracking_.connection_, close(Network::ConnectionCloseType::NoFlush));
+  Buffer::OwnedImpl data("?");
+  tracking_.read_filter_->onData(data, false);
+  EXPECT_EQ(1UL, stats_.tracking_cx_failure_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, FillAndLookup) {
+  setupReady();
+
+  EXPECT_EQ(nullptr, cache_->lookup("foo"));
+  fill("foo", bulkString("bar"));
+  const Common::Redis::RespValue* value = cache_->lookup("foo");
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(bulkString("bar"), *value);
+
+  fill("null", Common::Redis::RespValue());
+  value = cache_->lookup("null");
+  ASSERT_NE(nullptr, value);
+  EXPECT_EQ(Common::Redis::RespType::Null, value->type());
+
+  EXPECT_EQ(2UL, stats_.fill_.value());
+  EXPECT_EQ(2UL, stats_.hit_.value());
+  EXPECT_EQ(1UL, stats_.miss_.value());
+  EXPECT_EQ(2UL, stats_.entries_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, OnlyStringsAndNullsCached) {
+  setupReady();
+
+  fill("integer", integer(1));
+  fill("error", error("ERR"));
+  fill("large", bulkString("123456789"));
+  EXPECT_FALSE(cached("integer"));
+  EXPECT_FALSE(cached("error"));
+  EXPECT_FALSE(cached("large"));
+  EXPECT_EQ(0UL, stats_.fill_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, InvalidationDuringFill) {
+  setupReady();
+
+  const uint64_t fill_id = cache_->startFill("foo");
+  invalidate(tracking_, array({bulkString("foo")}));
+  cache_->fill("foo", fill_id, bulkString("stale"));
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(1UL, stats_.invalidation_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, LastFillWins) {
+  setupReady();
+
+  const uint64_t first_fill_id = cache_->startFill("foo");
+  const uint64_t second_fill_id = cache_->startFill("foo");
+  cache_->fill("foo", first_fill_id, bulkString("first"));
+  EXPECT_FALSE(cached("foo"));
+  cache_->fill("foo", second_fill_id, bulkString("second"));
+  EXPECT_EQ(bulkString("second"), *cache_->lookup("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, CancelFill) {
+  setupReady();
+
+  const uint64_t fill_id = cache_->startFill("foo");
+  cache_->cancelFill("foo", fill_id);
+  cache_->fill("foo", fill_id, bulkString("bar"));
+  EXPECT_FALSE(cached("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, Invalidation) {
+  setupReady();
+
+  fill("foo", bulkString("1"));
+  fill("bar", bulkString("2"));
+  invalidate(tracking_, array({bulkString("foo"), bulkString("other")}));
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_TRUE(cached("bar"));
+
+  invalidate(tracking_, bulkString("bar"));
+  EXPECT_FALSE(cached("bar"));
+  EXPECT_EQ(3UL, stats_.invalidation_.value());
+  EXPECT_EQ(0UL, stats_.entries_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, InvalidationOfAllKeys) {
+  setupReady();
+
+  fill("foo", bulkString("1"));
+  invalidate(tracking_, Common::Redis::RespValue());
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(1UL, stats_.flush_.value());
+
+  fill("foo", bulkString("1"));
+  respond(tracking_, bulkString("unexpected"));
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(2UL, stats_.flush_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, EvictLeastRecentlyUsed) {
+  setupReady();
+
+  fill("a", bulkString("1"));
+  fill("b", bulkString("2"));
+  EXPECT_TRUE(cached("a"));
+  fill("c", bulkString("3"));
+  EXPECT_TRUE(cached("a"));
+  EXPECT_FALSE(cached("b"));
+  EXPECT_TRUE(cached("c"));
+  EXPECT_EQ(1UL, stats_.eviction_.value());
+  EXPECT_EQ(2UL, stats_.entries_.value());
+
+  // Filling a cached key replaces its value.
+  fill("c", bulkString("4"));
+  EXPECT_EQ(bulkString("4"), *cache_->lookup("c"));
+  EXPECT_EQ(2UL, stats_.entries_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, Expiration) {
+  setupReady();
+
+  fill("foo", bulkString("1"));
+  time_system_.advanceTimeWait(std::chrono::seconds(9));
+  EXPECT_TRUE(cached("foo"));
+  time_system_.advanceTimeWait(std::chrono::seconds(1));
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(1UL, stats_.expiration_.value());
+  EXPECT_EQ(0UL, stats_.entries_.value());
+}
+
+TEST_F(RedisClientCacheImplTest, TrackingLost) {
+  setupReady();
+
+  fill("foo", bulkString("1"));
+  const uint64_t fill_id = cache_->startFill("bar");
+  EXPECT_CALL(*tracking_.reconnect_timer_,
+              enableTimer(TrackingClient::ReconnectInterval, nullptr));
+  tracking_.connection_->raiseEvent(Network::ConnectionEvent::RemoteClose);
+  EXPECT_EQ(0UL, stats_.tracking_cx_ready_.value());
+  EXPECT_FALSE(cached("foo"));
+  cache_->fill("bar", fill_id, bulkString("2"));
+  EXPECT_FALSE(cached("bar"));
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+}
+
+TEST_F(RedisClientCacheImplTest, Hosts) {
+  setupReady();
+  fill("foo", bulkString("1"));
+
+  // A new host may own cached keys, and isn't tracked yet.
+  Tracking tracking;
+  std::shared_ptr<Upstream::MockHost> host = makeHost("tcp://127.0.0.1:6380");
+  written_.clear();
+  addHost(host, tracking);
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+  subscribe(tracking, 6);
+  EXPECT_EQ(2UL, stats_.tracking_cx_ready_.value());
+  fill("foo", bulkString("1"));
+
+  // Adding a host again keeps its tracking connection.
+  cache_->addHost(host, "", "");
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_NE(0UL, cache_->startFill("foo"));
+
+  fill("foo", bulkString("1"));
+  cache_->removeHost(host);
+  EXPECT_FALSE(cached("foo"));
+  EXPECT_EQ(1UL, stats_.tracking_cx_ready_.value());
+  EXPECT_NE(0UL, cache_->startFill("foo"));
+
+  cache_->removeAllHosts();
+  EXPECT_EQ(0UL, stats_.tracking_cx_ready_.value());
+  EXPECT_EQ(0UL, cache_->startFill("foo"));
+}
+
+} // namespace RedisProxy
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
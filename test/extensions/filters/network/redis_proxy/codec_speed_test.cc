@@ -0,0 +1,73 @@
+// Note: this should be run with --compilation_mode=opt, and would benefit from a
+// quiescent system with disabled cstate power management.
+
+#include <algorithm>
+#include <string>
+
+#include "common/buffer/buffer_impl.h"
+
+#include "extensions/filters/network/common/redis/codec_impl.h"
+
+#include "benchmark/benchmark.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace NetworkFilters {
+namespace Common {
+namespace Redis {
+
+class CodecSpeedTest : public DecoderCallbacks {
+public:
+  CodecSpeedTest(uint64_t value_size) : decoder_(*this) {
+    RespValue request;
+    request.type(RespType::Array);
+    request.asArray().resize(3);
+    request.asArray()[0].type(RespType::BulkString);
+    request.asArray()[0].asString() = "set";
+    request.asArray()[1].type(RespType::BulkString);
+    request.asArray()[1].asString() = std::string(36, 'k');
+    request.asArray()[2].type(RespType::BulkString);
+    request.asArray()[2].asString() = std::string(value_size, 'v');
+    Buffer::OwnedImpl buffer;
+    encoder_.encode(request, buffer);
+    encoded_ = buffer.toString();
+  }
+
+  // DecoderCallbacks
+  void onRespValue(RespValuePtr&& value) override { value_ = std::move(value); }
+
+  // Decodes the request as read from a socket, in slices of 16KiB, and encodes it again as the
+  // proxy does when forwarding it upstream.
+  void decodeAndEncode() {
+    Buffer::OwnedImpl input;
+    for (uint64_t offset = 0; offset < encoded_.size(); offset += 16384) {
+      input.appendSliceForTest(encoded_.data() + offset,
+                               std::min<uint64_t>(16384, encoded_.size() - offset));
+    }
+    decoder_.decode(input);
+    Buffer::OwnedImpl output;
+    encoder_.encode(*value_, output);
+    benchmark::DoNotOptimize(output.length());
+  }
+
+private:
+  EncoderImpl encoder_;
+  DecoderImpl decoder_;
+  std::string encoded_;
+  RespValuePtr value_;
+};
+
+} // namespace Redis
+} // namespace Common
+} // namespace NetworkFilters
+} // namespace Extensions
+} // namespace Envoy
+
+static void BM_DecodeEncode_Set(benchmark::State& state) {
+  Envoy::Extensions::NetworkFilters::Common::Redis::CodecSpeedTest context(state.range(0));
+  for (auto _ : state) {
+    context.decodeAndEncode();
+  }
+  state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_DecodeEncode_Set)->Range(64, 8 << 20);
@@ -476,6 +476,105 @@ TEST_F(RedisSingleServerRequestTest, EvalNoUpstream) {
   EXPECT_EQ(1UL, store_.counter("redis.foo.command.eval.error").value());
 };
 
+TEST_F(RedisSingleServerRequestTest, GetCacheHit) {
+  NiceMock<MockClientCache> cache;
+  Common::Redis::RespValue cached;
+  cached.type(Common::Redis::RespType::BulkString);
+  cached.asString() = "world";
+
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, lookup("hello")).WillOnce(Return(&cached));
+  EXPECT_CALL(cache, startFill(_)).Times(0);
+  EXPECT_CALL(*conn_pool_, makeRequest_(_, _, _)).Times(0);
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&cached)));
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_);
+  EXPECT_EQ(nullptr, handle_);
+
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.total").value());
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.get.success").value());
+};
+
+TEST_F(RedisSingleServerRequestTest, GetCacheMissFills) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, lookup("hello")).WillOnce(Return(nullptr));
+  EXPECT_CALL(cache, startFill("hello")).WillOnce(Return(3));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"GET", "hello"});
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(cache, fill("hello", 3, _));
+  respond();
+};
+
+TEST_F(RedisSingleServerRequestTest, GetCacheFailCancelsFill) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, startFill("hello")).WillOnce(Return(3));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(cache, fill(_, _, _)).Times(0);
+  EXPECT_CALL(cache, cancelFill("hello", 3));
+  fail();
+};
+
+TEST_F(RedisSingleServerRequestTest, GetCacheCancelCancelsFill) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, startFill("hello")).WillOnce(Return(3));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(cache, cancelFill("hello", 3));
+  EXPECT_CALL(pool_request_, cancel());
+  handle_->cancel();
+};
+
+TEST_F(RedisSingleServerRequestTest, GetCacheNoUpstreamCancelsFill) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, startFill("hello")).WillOnce(Return(3));
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  EXPECT_CALL(*conn_pool_, makeRequest_("hello", _, _)).WillOnce(Return(nullptr));
+
+  Common::Redis::RespValue response;
+  response.type(Common::Redis::RespType::Error);
+  response.asString() = Response::get().NoUpstreamHost;
+  EXPECT_CALL(cache, cancelFill("hello", 3));
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&response)));
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"get", "hello"});
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_);
+  EXPECT_EQ(nullptr, handle_);
+};
+
+TEST_F(RedisSingleServerRequestTest, CacheOnlyUsedForGet) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).WillOnce(Return(&cache));
+  EXPECT_CALL(cache, lookup(_)).Times(0);
+  EXPECT_CALL(cache, startFill(_)).Times(0);
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"incr", "hello"});
+  makeRequest("hello", std::move(request));
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(cache, fill(_, _, _)).Times(0);
+  respond();
+};
+
 MATCHER_P(CompositeArrayEq, rhs, "CompositeArray should be equal") {
   const ConnPool::RespVariant& obj = arg;
   const auto& lhs = absl::get<const Common::Redis::RespValue>(obj);
@@ -744,6 +843,82 @@ TEST_F(RedisMGETCommandHandlerTest, Cancel) {
   handle_->cancel();
 };
 
+TEST_F(RedisMGETCommandHandlerTest, CacheHitForOne) {
+  NiceMock<MockClientCache> cache;
+  Common::Redis::RespValue cached;
+  cached.type(Common::Redis::RespType::BulkString);
+  cached.asString() = "cached";
+
+  EXPECT_CALL(*conn_pool_, clientCache()).Times(2).WillRepeatedly(Return(&cache));
+  EXPECT_CALL(cache, lookup("0")).WillOnce(Return(&cached));
+  EXPECT_CALL(cache, lookup("1")).WillOnce(Return(nullptr));
+  EXPECT_CALL(cache, startFill("1")).WillOnce(Return(7));
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  ConnPool::PoolCallbacks* pool_callbacks{};
+  Common::Redis::Client::MockPoolRequest pool_request;
+  EXPECT_CALL(*conn_pool_,
+              makeRequest_("1", CompositeArrayEq(std::vector<std::string>{"get", "1"}), _))
+      .WillOnce(DoAll(WithArg<2>(SaveArgAddress(&pool_callbacks)), Return(&pool_request)));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"mget", "0", "1"});
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_);
+  EXPECT_NE(nullptr, handle_);
+
+  Common::Redis::RespValue expected_response;
+  expected_response.type(Common::Redis::RespType::Array);
+  std::vector<Common::Redis::RespValue> elements(2);
+  elements[0].type(Common::Redis::RespType::BulkString);
+  elements[0].asString() = "cached";
+  elements[1].type(Common::Redis::RespType::BulkString);
+  elements[1].asString() = "5";
+  expected_response.asArray().swap(elements);
+
+  EXPECT_CALL(cache, fill("1", 7, _));
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+  pool_callbacks->onResponse(response("5"));
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.success").value());
+};
+
+TEST_F(RedisMGETCommandHandlerTest, CacheHitForAll) {
+  NiceMock<MockClientCache> cache;
+  Common::Redis::RespValue cached;
+  cached.type(Common::Redis::RespType::BulkString);
+  cached.asString() = "cached";
+
+  EXPECT_CALL(*conn_pool_, clientCache()).Times(2).WillRepeatedly(Return(&cache));
+  EXPECT_CALL(cache, lookup(_)).Times(2).WillRepeatedly(Return(&cached));
+  EXPECT_CALL(callbacks_, connectionAllowed()).WillOnce(Return(true));
+  EXPECT_CALL(*conn_pool_, makeRequest_(_, _, _)).Times(0);
+
+  Common::Redis::RespValue expected_response;
+  expected_response.type(Common::Redis::RespType::Array);
+  expected_response.asArray() = {cached, cached};
+  EXPECT_CALL(callbacks_, onResponse_(PointeesEq(&expected_response)));
+
+  Common::Redis::RespValuePtr request{new Common::Redis::RespValue()};
+  makeBulkStringArray(*request, {"mget", "0", "1"});
+  handle_ = splitter_.makeRequest(std::move(request), callbacks_, dispatcher_);
+  EXPECT_EQ(nullptr, handle_);
+  EXPECT_EQ(1UL, store_.counter("redis.foo.command.mget.success").value());
+};
+
+TEST_F(RedisMGETCommandHandlerTest, CacheCancelCancelsFills) {
+  NiceMock<MockClientCache> cache;
+  EXPECT_CALL(*conn_pool_, clientCache()).Times(2).WillRepeatedly(Return(&cache));
+  EXPECT_CALL(cache, startFill("0")).WillOnce(Return(1));
+  EXPECT_CALL(cache, startFill("1")).WillOnce(Return(2));
+
+  setup(2, {});
+  EXPECT_NE(nullptr, handle_);
+
+  EXPECT_CALL(cache, cancelFill("0", 1));
+  EXPECT_CALL(cache, cancelFill("1", 2));
+  EXPECT_CALL(pool_requests_[0], cancel());
+  EXPECT_CALL(pool_requests_[1], cancel());
+  handle_->cancel();
+};
+
 class RedisMSETCommandHandlerTest : public FragmentedRequestCommandHandlerTest {
 public:
   void setup(uint32_t num_sets, const std::list<uint64_t>& null_handle_indexes,
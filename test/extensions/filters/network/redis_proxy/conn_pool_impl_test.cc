@@ -85,11 +85,15 @@ public:
         std::make_shared<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>();
     auto redis_command_stats =
         Common::Redis::RedisCommandStats::createRedisCommandStats(store->symbolTable());
-    std::shared_ptr<InstanceImpl> conn_pool_impl = std::make_shared<InstanceImpl>(
-        cluster_name_, cm_, *this, tls_,
-        Common::Redis::Client::createConnPoolSettings(20, hashtagging, true, max_unknown_conns,
-                                                      read_policy_),
-        api_, std::move(store), redis_command_stats, cluster_refresh_manager_);
+    auto settings = Common::Redis::Client::createConnPoolSettings(20, hashtagging, true,
+                                                                  max_unknown_conns, read_policy_);
+    if (command_batching_.has_value()) {
+      settings.mutable_command_batching()->CopyFrom(command_batching_.value());
+    }
+    std::shared_ptr<InstanceImpl> conn_pool_impl =
+        std::make_shared<InstanceImpl>(cluster_name_, cm_, *this, tls_, settings, api_,
+                                       std::move(store), redis_command_stats,
+                                       cluster_refresh_manager_);
     conn_pool_impl->init();
     // Set the authentication password for this connection pool.
     conn_pool_impl->tls_->getTyped<InstanceImpl::ThreadLocalPool>().auth_username_ = auth_username_;
@@ -199,6 +203,27 @@ public:
     conn_pool_impl->tls_->getTyped<InstanceImpl::ThreadLocalPool>().drainClients();
   }
 
+  void setupBatching(uint32_t max_batch_size = 100) {
+    command_batching_.emplace();
+    command_batching_->mutable_max_batch_size()->set_value(max_batch_size);
+    setup();
+    EXPECT_CALL(*cm_.thread_local_cluster_.lb_.host_, address())
+        .WillRepeatedly(Return(test_address_));
+  }
+
+  Common::Redis::RespValueSharedPtr makeCommand(const std::vector<std::string>& arguments) {
+    Common::Redis::RespValueSharedPtr command = std::make_shared<Common::Redis::RespValue>();
+    command->type(Common::Redis::RespType::Array);
+    for (const std::string& argument : arguments) {
+      command->asArray().emplace_back();
+      command->asArray().back().type(Common::Redis::RespType::BulkString);
+      command->asArray().back().asString() = argument;
+    }
+    return command;
+  }
+
+  void sendBatches() { threadLocalPool().sendBatches(); }
+
   Stats::Counter& upstreamCxDrained() {
     InstanceImpl* conn_pool_impl = dynamic_cast<InstanceImpl*>(conn_pool_.get());
     return conn_pool_impl->redis_cluster_stats_.upstream_cx_drained_;
@@ -295,6 +320,8 @@ public:
   envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::ConnPoolSettings::ReadPolicy
       read_policy_ = envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::
           ConnPoolSettings::MASTER;
+  absl::optional<envoy::extensions::filters::network::redis_proxy::v3::RedisProxy::CommandBatching>
+      command_batching_;
   NiceMock<Stats::MockCounter> upstream_cx_drained_;
   NiceMock<Stats::MockCounter> max_upstream_unknown_connections_reached_;
   std::shared_ptr<NiceMock<Extensions::Common::Redis::MockClusterRefreshManager>>
@@ -1228,6 +1255,257 @@ TEST_F(RedisConnPoolImplTest, MakeRequestAndRedirectFollowedByDelete) {
   tls_.shutdownThread();
 }
 
+TEST_F(RedisConnPoolImplTest, BatchGets) {
+  InSequence s;
+
+  setupBatching();
+  EXPECT_FALSE(threadLocalPool().batch_timer_->enabled());
+
+  MockPoolCallbacks callbacks1, callbacks2;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("foo", makeCommand({"get", "foo"}), callbacks1));
+  EXPECT_TRUE(threadLocalPool().batch_timer_->enabled());
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("bar", makeCommand({"GET", "bar"}), callbacks2));
+
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "foo", "bar"})), _))
+      .WillOnce(Return(&active_request));
+  sendBatches();
+
+  Common::Redis::RespValuePtr response = std::make_unique<Common::Redis::RespValue>();
+  response->type(Common::Redis::RespType::Array);
+  response->asArray().resize(2);
+  response->asArray()[0].type(Common::Redis::RespType::BulkString);
+  response->asArray()[0].asString() = "foo_value";
+  EXPECT_CALL(callbacks1, onResponse_(_))
+      .WillOnce(Invoke([](Common::Redis::RespValuePtr& value) -> void {
+        EXPECT_EQ("foo_value", value->asString());
+      }));
+  EXPECT_CALL(callbacks2, onResponse_(_))
+      .WillOnce(Invoke([](Common::Redis::RespValuePtr& value) -> void {
+        EXPECT_EQ(Common::Redis::RespType::Null, value->type());
+      }));
+  client->client_callbacks_.back()->onResponse(std::move(response));
+  EXPECT_EQ(0, threadLocalPool().pending_requests_.size());
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchSetsWithCanceledRequest) {
+  InSequence s;
+
+  setupBatching();
+
+  MockPoolCallbacks callbacks1, callbacks2, callbacks3;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", makeCommand({"set", "a", "1"}), callbacks1));
+  Common::Redis::Client::PoolRequest* request2 =
+      conn_pool_->makeRequest("b", makeCommand({"set", "b", "2"}), callbacks2);
+  EXPECT_NE(nullptr, request2);
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("c", makeCommand({"set", "c", "3"}), callbacks3));
+  request2->cancel();
+
+  // The canceled SET is still sent.
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client,
+              makeRequest_(Eq(*makeCommand({"mset", "a", "1", "b", "2", "c", "3"})), _))
+      .WillOnce(Return(&active_request));
+  sendBatches();
+
+  Common::Redis::RespValuePtr response = std::make_unique<Common::Redis::RespValue>();
+  response->type(Common::Redis::RespType::SimpleString);
+  response->asString() = "OK";
+  EXPECT_CALL(callbacks1, onResponse_(_))
+      .WillOnce(Invoke(
+          [](Common::Redis::RespValuePtr& value) -> void { EXPECT_EQ("OK", value->asString()); }));
+  EXPECT_CALL(callbacks3, onResponse_(_))
+      .WillOnce(Invoke(
+          [](Common::Redis::RespValuePtr& value) -> void { EXPECT_EQ("OK", value->asString()); }));
+  client->client_callbacks_.back()->onResponse(std::move(response));
+  EXPECT_EQ(0, threadLocalPool().pending_requests_.size());
+
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchSentBeforeIncompatibleRequest) {
+  InSequence s;
+
+  setupBatching();
+
+  MockPoolCallbacks callbacks1, callbacks2, callbacks3;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2, active_request3;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", makeCommand({"get", "a"}), callbacks1));
+
+  // SETs with options aren't merged.
+  Common::Redis::RespValueSharedPtr set = makeCommand({"set", "a", "1", "ex", "10"});
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "a"})), _))
+      .WillOnce(Return(&active_request1));
+  EXPECT_CALL(*client, makeRequest_(Ref(*set), _)).WillOnce(Return(&active_request2));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", set, callbacks2));
+
+  // A SET isn't merged with GETs.
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", makeCommand({"get", "a"}), callbacks1));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "a"})), _))
+      .WillOnce(Return(&active_request3));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("b", makeCommand({"set", "b", "2"}), callbacks3));
+
+  // Canceling a merged request doesn't cancel its batch.
+  EXPECT_CALL(callbacks1, onFailure_());
+  EXPECT_CALL(active_request2, cancel());
+  EXPECT_CALL(callbacks2, onFailure_());
+  EXPECT_CALL(callbacks1, onFailure_());
+  EXPECT_CALL(callbacks3, onFailure_());
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchMaxSizeAndFailure) {
+  InSequence s;
+
+  setupBatching(2);
+
+  MockPoolCallbacks callbacks1, callbacks2, callbacks3;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", makeCommand({"get", "a"}), callbacks1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("b", makeCommand({"get", "b"}), callbacks2));
+
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "a", "b"})), _))
+      .WillOnce(Return(&active_request1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("c", makeCommand({"get", "c"}), callbacks3));
+
+  EXPECT_CALL(callbacks1, onFailure_());
+  EXPECT_CALL(callbacks2, onFailure_());
+  client->client_callbacks_.back()->onFailure();
+
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "c"})), _))
+      .WillOnce(Return(&active_request2));
+  sendBatches();
+  EXPECT_EQ(1, threadLocalPool().pending_requests_.size());
+
+  EXPECT_CALL(callbacks3, onResponse_(_));
+  client->client_callbacks_.back()->onResponse(std::make_unique<Common::Redis::RespValue>());
+  EXPECT_EQ(0, threadLocalPool().pending_requests_.size());
+
+  // A batch which fails to be sent by a new request fails its requests, but not the new one.
+  MockPoolCallbacks callbacks4, callbacks5, callbacks6;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("d", makeCommand({"get", "d"}), callbacks4));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("e", makeCommand({"get", "e"}), callbacks5));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "d", "e"})), _))
+      .WillOnce(Return(nullptr));
+  EXPECT_CALL(callbacks4, onFailure_());
+  EXPECT_CALL(callbacks5, onFailure_());
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("f", makeCommand({"get", "f"}), callbacks6));
+  EXPECT_EQ(1, threadLocalPool().pending_requests_.size());
+
+  EXPECT_CALL(callbacks6, onFailure_());
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchRedirection) {
+  InSequence s;
+
+  setupBatching();
+
+  MockPoolCallbacks callbacks1, callbacks2;
+  Common::Redis::RespValueSharedPtr get1 = makeCommand({"get", "a"});
+  Common::Redis::RespValueSharedPtr get2 = makeCommand({"get", "b"});
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", get1, callbacks1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("b", get2, callbacks2));
+
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"mget", "a", "b"})), _))
+      .WillOnce(Return(&active_request));
+  sendBatches();
+
+  // Each request is redirected on its own.
+  Common::Redis::Client::MockClient* client2 = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2;
+  Common::Redis::RespValuePtr moved_response{new Common::Redis::RespValue()};
+  moved_response->type(Common::Redis::RespType::Error);
+  moved_response->asString() = "MOVED 1111 10.1.2.3:4000";
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client2));
+  EXPECT_CALL(*client2, makeRequest_(Ref(*get1), _)).WillOnce(Return(&active_request1));
+  EXPECT_CALL(*client2, makeRequest_(Ref(*get2), _)).WillOnce(Return(&active_request2));
+  EXPECT_TRUE(client->client_callbacks_.back()->onRedirection(std::move(moved_response),
+                                                              "10.1.2.3:4000", false));
+
+  EXPECT_CALL(callbacks1, onResponse_(_));
+  client2->client_callbacks_.front()->onResponse(std::make_unique<Common::Redis::RespValue>());
+  EXPECT_CALL(callbacks2, onResponse_(_));
+  client2->client_callbacks_.back()->onResponse(std::make_unique<Common::Redis::RespValue>());
+  EXPECT_EQ(0, threadLocalPool().pending_requests_.size());
+
+  EXPECT_CALL(*client, close());
+  EXPECT_CALL(*client2, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchSentBeforeRedirectedRequest) {
+  InSequence s;
+
+  setupBatching();
+  hostAddressMap()[test_address_->asString()] = cm_.thread_local_cluster_.lb_.host_;
+
+  MockPoolCallbacks callbacks1, callbacks2;
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request1, active_request2, active_request3;
+  Common::Redis::RespValueSharedPtr set = makeCommand({"set", "a", "1", "ex", "10"});
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Ref(*set), _)).WillOnce(Return(&active_request1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", set, callbacks1));
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("b", makeCommand({"get", "b"}), callbacks2));
+
+  // The SET redirected to the host of the open batch is sent after it.
+  Common::Redis::RespValuePtr moved_response{new Common::Redis::RespValue()};
+  moved_response->type(Common::Redis::RespType::Error);
+  moved_response->asString() = "MOVED 1111 " + test_address_->asString();
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "b"})), _))
+      .WillOnce(Return(&active_request2));
+  EXPECT_CALL(*client, makeRequest_(Ref(*set), _)).WillOnce(Return(&active_request3));
+  EXPECT_TRUE(client->client_callbacks_.front()->onRedirection(std::move(moved_response),
+                                                               test_address_->asString(), false));
+  EXPECT_TRUE(threadLocalPool().open_batches_.empty());
+
+  EXPECT_CALL(active_request3, cancel());
+  EXPECT_CALL(callbacks1, onFailure_());
+  EXPECT_CALL(callbacks2, onFailure_());
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
+TEST_F(RedisConnPoolImplTest, BatchSentOnHostRemoval) {
+  InSequence s;
+
+  setupBatching();
+
+  MockPoolCallbacks callbacks;
+  EXPECT_NE(nullptr, conn_pool_->makeRequest("a", makeCommand({"get", "a"}), callbacks));
+
+  Common::Redis::Client::MockClient* client = new NiceMock<Common::Redis::Client::MockClient>();
+  Common::Redis::Client::MockPoolRequest active_request;
+  EXPECT_CALL(*this, create_(_)).WillOnce(Return(client));
+  EXPECT_CALL(*client, makeRequest_(Eq(*makeCommand({"get", "a"})), _))
+      .WillOnce(Return(&active_request));
+  EXPECT_CALL(*client, active()).WillOnce(Return(true));
+  cm_.thread_local_cluster_.cluster_.prioritySet().getMockHostSet(0)->runCallbacks(
+      {}, {cm_.thread_local_cluster_.lb_.host_});
+
+  EXPECT_CALL(callbacks, onFailure_());
+  EXPECT_CALL(*client, close());
+  tls_.shutdownThread();
+}
+
 } // namespace ConnPool
 } // namespace RedisProxy
 } // namespace NetworkFilters
@@ -30,6 +30,9 @@ MockFaultManager::MockFaultManager() = default;
 MockFaultManager::MockFaultManager(const MockFaultManager&) {}
 MockFaultManager::~MockFaultManager() = default;
 
+MockClientCache::MockClientCache() = default;
+MockClientCache::~MockClientCache() = default;
+
 namespace ConnPool {
 
 MockPoolCallbacks::MockPoolCallbacks() = default;
@@ -8,6 +8,7 @@
 #include "extensions/filters/network/common/redis/client.h"
 #include "extensions/filters/network/common/redis/codec_impl.h"
 #include "extensions/filters/network/common/redis/fault.h"
+#include "extensions/filters/network/redis_proxy/client_cache.h"
 #include "extensions/filters/network/redis_proxy/command_splitter.h"
 #include "extensions/filters/network/redis_proxy/conn_pool.h"
 #include "extensions/filters/network/redis_proxy/router.h"
@@ -61,6 +62,18 @@ public:
   MOCK_METHOD(const Common::Redis::Fault*, getFaultForCommand, (const std::string&), (const));
 };
 
+class MockClientCache : public ClientCache {
+public:
+  MockClientCache();
+  ~MockClientCache() override;
+
+  MOCK_METHOD(const Common::Redis::RespValue*, lookup, (const std::string& key));
+  MOCK_METHOD(uint64_t, startFill, (const std::string& key));
+  MOCK_METHOD(void, fill,
+              (const std::string& key, uint64_t fill_id, const Common::Redis::RespValue& value));
+  MOCK_METHOD(void, cancelFill, (const std::string& key, uint64_t fill_id));
+};
+
 namespace ConnPool {
 
 class MockPoolCallbacks : public PoolCallbacks {
@@ -89,6 +102,7 @@ public:
   MOCK_METHOD(Common::Redis::Client::PoolRequest*, makeRequest_,
               (const std::string& hash_key, RespVariant& request, PoolCallbacks& callbacks));
   MOCK_METHOD(bool, onRedirection, ());
+  MOCK_METHOD(ClientCache*, clientCache, ());
 };
 } // namespace ConnPool
 
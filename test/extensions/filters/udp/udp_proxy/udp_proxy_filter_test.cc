@@ -23,6 +23,7 @@ using testing::AtLeast;
 using testing::ByMove;
 using testing::DoAll;
 using testing::InSequence;
+using testing::Invoke;
 using testing::InvokeWithoutArgs;
 using testing::Return;
 using testing::ReturnNew;
@@ -387,6 +388,46 @@ cluster: fake_cluster
   EXPECT_EQ(1, config_->stats().downstream_sess_active_.value());
 }
 
+// Upstream writes are buffered and sent with a single sendmmsg() call at the end of the event loop
+// iteration.
+TEST_F(UdpProxyFilterTest, BatchUpstreamWrites) {
+  EXPECT_CALL(os_sys_calls_, supportsMmsg()).WillRepeatedly(Return(true));
+  auto* flush_cb = new Event::MockSchedulableCallback(&callbacks_.udp_listener_.dispatcher_);
+  setup(R"EOF(
+stat_prefix: foo
+cluster: fake_cluster
+batch_upstream_writes: true
+  )EOF");
+
+  expectSessionCreate(upstream_address_);
+  EXPECT_CALL(*test_sessions_[0].idle_timer_, enableTimer(config_->sessionTimeout(), nullptr))
+      .Times(2);
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, sendmsg(_, _, _, _, _)).Times(0);
+  EXPECT_CALL(*flush_cb, scheduleCallbackCurrentIteration());
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "hello");
+  recvDataFromDownstream("10.0.0.1:1000", "10.0.0.2:80", "world!");
+  EXPECT_EQ(2, config_->stats().downstream_sess_rx_datagrams_.value());
+
+  EXPECT_CALL(*test_sessions_[0].socket_->io_handle_, fdDoNotUse()).WillOnce(Return(42));
+  EXPECT_CALL(os_sys_calls_, sendmmsg(42, _, 2, 0))
+      .WillOnce(Invoke([this](os_fd_t, mmsghdr* messages, unsigned int count, int) {
+        const std::vector<std::string> expected{"hello", "world!"};
+        for (unsigned int i = 0; i < count; i++) {
+          const msghdr& message = messages[i].msg_hdr;
+          EXPECT_EQ(1, message.msg_iovlen);
+          EXPECT_EQ(expected[i], absl::string_view(static_cast<char*>(message.msg_iov[0].iov_base),
+                                                   message.msg_iov[0].iov_len));
+          EXPECT_EQ(Network::Address::addressFromSockAddr(
+                        *static_cast<sockaddr_storage*>(message.msg_name), message.msg_namelen)
+                        ->asString(),
+                    upstream_address_->asString());
+          messages[i].msg_len = message.msg_iov[0].iov_len;
+        }
+        return Api::SysCallIntResult{static_cast<int>(count), 0};
+      }));
+  flush_cb->invokeCallback();
+}
+
 // Verify downstream send and receive error handling.
 TEST_F(UdpProxyFilterTest, SendReceiveErrorHandling) {
   InSequence s;
@@ -0,0 +1,335 @@
+#include <string>
+#include <vector>
+
+#include "envoy/extensions/private_key_providers/offload/v3alpha/offload.pb.h"
+#include "envoy/extensions/transport_sockets/tls/v3/cert.pb.h"
+#include "envoy/registry/registry.h"
+#include "envoy/ssl/private_key/private_key_config.h"
+
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/private_key_providers/offload/offload_private_key_provider.h"
+
+#include "test/mocks/server/transport_socket_factory_context.h"
+#include "test/test_common/environment.h"
+#include "test/test_common/thread_factory_for_test.h"
+#include "test/test_common/utility.h"
+
+#include "absl/synchronization/notification.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "openssl/evp.h"
+#include "openssl/rsa.h"
+#include "openssl/ssl.h"
+
+using testing::Invoke;
+using testing::NiceMock;
+using testing::ReturnRef;
+using testing::StrictMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace PrivateKeyMethodProvider {
+namespace Offload {
+namespace {
+
+class MockPrivateKeyConnectionCallbacks : public Ssl::PrivateKeyConnectionCallbacks {
+public:
+  MOCK_METHOD(void, onPrivateKeyMethodComplete, ());
+};
+
+// Holds the routines of the created threads until released, so that operations stay queued.
+class PausedThreadFactory : public Thread::ThreadFactory {
+public:
+  Thread::ThreadPtr createThread(std::function<void()> thread_routine,
+                                 Thread::OptionsOptConstRef options) override {
+    return Thread::threadFactoryForTest().createThread(
+        [this, thread_routine]() -> void {
+          released_.WaitForNotification();
+          thread_routine();
+        },
+        options);
+  }
+  Thread::ThreadId currentThreadId() override {
+    return Thread::threadFactoryForTest().currentThreadId();
+  }
+
+  void release() {
+    if (!released_.HasBeenNotified()) {
+      released_.Notify();
+    }
+  }
+
+private:
+  absl::Notification released_;
+};
+
+class OffloadPrivateKeyProviderTest : public testing::Test {
+public:
+  OffloadPrivateKeyProviderTest()
+      : api_(Api::createApiForTest()), dispatcher_(api_->allocateDispatcher("test_thread")),
+        ssl_ctx_(SSL_CTX_new(TLS_method())) {
+    ON_CALL(factory_context_, scope()).WillByDefault(ReturnRef(store_));
+    ON_CALL(factory_context_.api_, threadFactory()).WillByDefault(ReturnRef(thread_factory_));
+  }
+
+  ~OffloadPrivateKeyProviderTest() override { thread_factory_.release(); }
+
+  static std::string readKey(const std::string& key_file) {
+    return TestEnvironment::readFileToStringForTest(TestEnvironment::substitute(
+        "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/" + key_file));
+  }
+
+  void createProvider(const std::string& key_file, bool paused = false,
+                      uint32_t max_queue_depth = 16) {
+    OffloadPrivateKeyMethodConfig config;
+    config.mutable_private_key()->set_inline_string(readKey(key_file));
+    config.mutable_thread_count()->set_value(1);
+    config.mutable_max_queue_depth()->set_value(max_queue_depth);
+    provider_ = std::make_shared<OffloadPrivateKeyMethodProvider>(config, factory_context_);
+    method_ = provider_->getBoringSslPrivateKeyMethod();
+    if (!paused) {
+      thread_factory_.release();
+    }
+  }
+
+  bssl::UniquePtr<SSL> createSsl(Ssl::PrivateKeyConnectionCallbacks& callbacks) {
+    bssl::UniquePtr<SSL> ssl(SSL_new(ssl_ctx_.get()));
+    provider_->registerPrivateKeyMethod(ssl.get(), callbacks, *dispatcher_);
+    return ssl;
+  }
+
+  // Runs the dispatcher until the handshake of the callbacks is resumed.
+  void waitForCompletion(MockPrivateKeyConnectionCallbacks& callbacks) {
+    EXPECT_CALL(callbacks, onPrivateKeyMethodComplete()).WillOnce(Invoke([this]() -> void {
+      dispatcher_->exit();
+    }));
+    dispatcher_->run(Event::Dispatcher::RunType::Block);
+  }
+
+  // Verifies a signature with the public half of the provider's key.
+  bool verify(uint16_t signature_algorithm, const std::vector<uint8_t>& signature) {
+    bssl::ScopedEVP_MD_CTX ctx;
+    EVP_PKEY_CTX* pkey_ctx;
+    if (!EVP_DigestVerifyInit(ctx.get(), &pkey_ctx,
+                              SSL_get_signature_algorithm_digest(signature_algorithm), nullptr,
+                              provider_->privateKey())) {
+      return false;
+    }
+    if (SSL_is_signature_algorithm_rsa_pss(signature_algorithm) &&
+        (!EVP_PKEY_CTX_set_rsa_padding(pkey_ctx, RSA_PKCS1_PSS_PADDING) ||
+         !EVP_PKEY_CTX_set_rsa_pss_saltlen(pkey_ctx, -1))) {
+      return false;
+    }
+    return EVP_DigestVerify(ctx.get(), signature.data(), signature.size(),
+                            reinterpret_cast<const uint8_t*>(input_.data()), input_.size());
+  }
+
+  ssl_private_key_result_t sign(SSL* ssl, uint16_t signature_algorithm) {
+    size_t out_len = 0;
+    output_.resize(max_out_);
+    const ssl_private_key_result_t result =
+        method_->sign(ssl, output_.data(), &out_len, output_.size(), signature_algorithm,
+                      reinterpret_cast<const uint8_t*>(input_.data()), input_.size());
+    output_.resize(result == ssl_private_key_success ? out_len : 0);
+    return result;
+  }
+
+  ssl_private_key_result_t complete(SSL* ssl) {
+    size_t out_len = 0;
+    output_.resize(max_out_);
+    const ssl_private_key_result_t result =
+        method_->complete(ssl, output_.data(), &out_len, output_.size());
+    output_.resize(result == ssl_private_key_success ? out_len : 0);
+    return result;
+  }
+
+  uint64_t queueDepth() {
+    return store_
+        .gaugeFromString("private_key_provider.offload.queue_depth",
+                         Stats::Gauge::ImportMode::Accumulate)
+        .value();
+  }
+
+  void testSign(const std::string& key_file, uint16_t signature_algorithm) {
+    createProvider(key_file);
+    StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+    bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+    EXPECT_EQ(ssl_private_key_retry, sign(ssl.get(), signature_algorithm));
+    // The handshake isn't resumed before the result is delivered on the dispatcher.
+    EXPECT_EQ(ssl_private_key_retry, complete(ssl.get()));
+    waitForCompletion(callbacks);
+    EXPECT_EQ(ssl_private_key_success, complete(ssl.get()));
+    EXPECT_TRUE(verify(signature_algorithm, output_));
+    EXPECT_EQ(1, store_.counterFromString("private_key_provider.offload.sign").value());
+    EXPECT_EQ(0, store_.counterFromString("private_key_provider.offload.failed").value());
+    EXPECT_EQ(0, queueDepth());
+    provider_->unregisterPrivateKeyMethod(ssl.get());
+  }
+
+  Api::ApiPtr api_;
+  Event::DispatcherPtr dispatcher_;
+  Stats::IsolatedStoreImpl store_;
+  PausedThreadFactory thread_factory_;
+  NiceMock<Server::Configuration::MockTransportSocketFactoryContext> factory_context_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  std::shared_ptr<OffloadPrivateKeyMethodProvider> provider_;
+  Ssl::BoringSslPrivateKeyMethodSharedPtr method_;
+  const std::string input_{"handshake transcript"};
+  const size_t max_out_{1024};
+  std::vector<uint8_t> output_;
+};
+
+TEST_F(OffloadPrivateKeyProviderTest, RsaPssSign) {
+  testSign("unittest_key.pem", SSL_SIGN_RSA_PSS_RSAE_SHA256);
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, RsaPkcs1Sign) {
+  testSign("unittest_key.pem", SSL_SIGN_RSA_PKCS1_SHA384);
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, EcdsaSign) {
+  testSign("selfsigned_ecdsa_p256_key.pem", SSL_SIGN_ECDSA_SECP256R1_SHA256);
+}
+
+// A signature algorithm of another key type fails the operation.
+TEST_F(OffloadPrivateKeyProviderTest, MismatchedSignatureAlgorithm) {
+  createProvider("unittest_key.pem");
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl.get(), SSL_SIGN_ECDSA_SECP256R1_SHA256));
+  waitForCompletion(callbacks);
+  EXPECT_EQ(ssl_private_key_failure, complete(ssl.get()));
+  EXPECT_EQ(1, store_.counterFromString("private_key_provider.offload.failed").value());
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, RsaDecrypt) {
+  createProvider("unittest_key.pem");
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+  // Encrypt a value smaller than the modulus with the public key.
+  RSA* rsa = EVP_PKEY_get0_RSA(provider_->privateKey());
+  std::vector<uint8_t> plaintext(RSA_size(rsa), 'a');
+  plaintext[0] = 0;
+  std::vector<uint8_t> ciphertext(RSA_size(rsa));
+  size_t ciphertext_len;
+  ASSERT_TRUE(RSA_encrypt(rsa, &ciphertext_len, ciphertext.data(), ciphertext.size(),
+                          plaintext.data(), plaintext.size(), RSA_NO_PADDING));
+
+  size_t out_len;
+  output_.resize(max_out_);
+  EXPECT_EQ(ssl_private_key_retry, method_->decrypt(ssl.get(), output_.data(), &out_len,
+                                                    output_.size(), ciphertext.data(),
+                                                    ciphertext_len));
+  waitForCompletion(callbacks);
+  EXPECT_EQ(ssl_private_key_success, complete(ssl.get()));
+  EXPECT_EQ(plaintext, output_);
+  EXPECT_EQ(1, store_.counterFromString("private_key_provider.offload.decrypt").value());
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, EcdsaDecrypt) {
+  createProvider("selfsigned_ecdsa_p256_key.pem");
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+  size_t out_len;
+  output_.resize(max_out_);
+  const uint8_t in[] = {1, 2, 3};
+  EXPECT_EQ(ssl_private_key_failure, method_->decrypt(ssl.get(), output_.data(), &out_len,
+                                                      output_.size(), in, sizeof(in)));
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+}
+
+// Once the queue is full, operations are performed synchronously.
+TEST_F(OffloadPrivateKeyProviderTest, QueueOverflow) {
+  createProvider("unittest_key.pem", true, 1);
+  StrictMock<MockPrivateKeyConnectionCallbacks> queued_callbacks;
+  bssl::UniquePtr<SSL> queued_ssl = createSsl(queued_callbacks);
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(queued_ssl.get(), SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_EQ(1, queueDepth());
+  EXPECT_EQ(ssl_private_key_success, sign(ssl.get(), SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, output_));
+  EXPECT_EQ(1, store_.counterFromString("private_key_provider.offload.queue_overflow").value());
+
+  thread_factory_.release();
+  waitForCompletion(queued_callbacks);
+  EXPECT_EQ(ssl_private_key_success, complete(queued_ssl.get()));
+  EXPECT_TRUE(verify(SSL_SIGN_RSA_PSS_RSAE_SHA256, output_));
+  EXPECT_EQ(0, queueDepth());
+  EXPECT_EQ(2, store_.counterFromString("private_key_provider.offload.sign").value());
+  provider_->unregisterPrivateKeyMethod(queued_ssl.get());
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+}
+
+// The result of an operation isn't delivered once its connection is gone.
+TEST_F(OffloadPrivateKeyProviderTest, UnregisterWithPendingOperation) {
+  createProvider("unittest_key.pem", true);
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+
+  EXPECT_EQ(ssl_private_key_retry, sign(ssl.get(), SSL_SIGN_RSA_PSS_RSAE_SHA256));
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+  thread_factory_.release();
+  // Joins the pool thread, which either skipped the operation or never took it from the queue.
+  provider_.reset();
+  EXPECT_EQ(0, queueDepth());
+  dispatcher_->run(Event::Dispatcher::RunType::NonBlock);
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, RegisterTwice) {
+  createProvider("unittest_key.pem");
+  StrictMock<MockPrivateKeyConnectionCallbacks> callbacks;
+  bssl::UniquePtr<SSL> ssl = createSsl(callbacks);
+  EXPECT_THROW_WITH_MESSAGE(
+      provider_->registerPrivateKeyMethod(ssl.get(), callbacks, *dispatcher_), EnvoyException,
+      "Can't distinguish between two registered providers for the same SSL object.");
+  provider_->unregisterPrivateKeyMethod(ssl.get());
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, CheckFips) {
+  createProvider("unittest_key.pem");
+  EXPECT_TRUE(provider_->checkFips());
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, InvalidKey) {
+  OffloadPrivateKeyMethodConfig config;
+  config.mutable_private_key()->set_inline_string("not a key");
+  EXPECT_THROW_WITH_MESSAGE(
+      OffloadPrivateKeyMethodProvider(config, factory_context_), EnvoyException,
+      "Failed to load private key of the offload private key provider.");
+}
+
+TEST_F(OffloadPrivateKeyProviderTest, Factory) {
+  thread_factory_.release();
+  auto* factory =
+      Registry::FactoryRegistry<Ssl::PrivateKeyMethodProviderInstanceFactory>::getFactory(
+          "envoy.tls.key_providers.offload");
+  ASSERT_NE(nullptr, factory);
+
+  OffloadPrivateKeyMethodConfig config;
+  config.mutable_private_key()->set_inline_string(readKey("selfsigned_ecdsa_p256_key.pem"));
+  envoy::extensions::transport_sockets::tls::v3::PrivateKeyProvider provider_config;
+  provider_config.set_provider_name("envoy.tls.key_providers.offload");
+  provider_config.mutable_typed_config()->PackFrom(config);
+  EXPECT_NE(nullptr, factory->createPrivateKeyMethodProviderInstance(provider_config,
+                                                                     factory_context_));
+
+  // The key is required.
+  provider_config.mutable_typed_config()->PackFrom(OffloadPrivateKeyMethodConfig());
+  EXPECT_THROW(factory->createPrivateKeyMethodProviderInstance(provider_config, factory_context_),
+               EnvoyException);
+}
+
+} // namespace
+} // namespace Offload
+} // namespace PrivateKeyMethodProvider
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,63 @@
+#include "envoy/extensions/stat_sinks/prometheus_remote_write/v3/prometheus_remote_write.pb.h"
+#include "envoy/registry/registry.h"
+
+#include "extensions/stat_sinks/prometheus_remote_write/config.h"
+#include "extensions/stat_sinks/prometheus_remote_write/remote_write_sink.h"
+#include "extensions/stat_sinks/well_known_names.h"
+
+#include "test/mocks/server/instance.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace {
+
+TEST(PrometheusRemoteWriteConfigTest, CreateSink) {
+  const std::string name = StatsSinkNames::get().PrometheusRemoteWrite;
+
+  const std::string yaml = R"EOF(
+http_uri:
+  uri: http://receiver/api/v1/write
+  cluster: receiver
+  timeout: 1s
+max_samples_per_request: 100
+resend_interval: 60s
+)EOF";
+  envoy::extensions::stat_sinks::prometheus_remote_write::v3::PrometheusRemoteWrite sink_config;
+  TestUtility::loadFromYaml(yaml, sink_config);
+
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(name);
+  ASSERT_NE(factory, nullptr);
+
+  ProtobufTypes::MessagePtr message = factory->createEmptyConfigProto();
+  TestUtility::jsonConvert(sink_config, *message);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> server;
+  Stats::SinkPtr sink = factory->createStatsSink(*message, server);
+  EXPECT_NE(dynamic_cast<PrometheusRemoteWriteSink*>(sink.get()), nullptr);
+}
+
+TEST(PrometheusRemoteWriteConfigTest, MissingHttpUri) {
+  Server::Configuration::StatsSinkFactory* factory =
+      Registry::FactoryRegistry<Server::Configuration::StatsSinkFactory>::getFactory(
+          StatsSinkNames::get().PrometheusRemoteWrite);
+  ASSERT_NE(factory, nullptr);
+
+  NiceMock<Server::Configuration::MockServerFactoryContext> server;
+  envoy::extensions::stat_sinks::prometheus_remote_write::v3::PrometheusRemoteWrite sink_config;
+  EXPECT_THROW(factory->createStatsSink(sink_config, server), ProtoValidationException);
+}
+
+} // namespace
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
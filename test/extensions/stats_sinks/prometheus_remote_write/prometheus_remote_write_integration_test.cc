@@ -0,0 +1,122 @@
+#include "envoy/config/bootstrap/v3/bootstrap.pb.h"
+#include "envoy/extensions/stat_sinks/prometheus_remote_write/v3/prometheus_remote_write.pb.h"
+
+#include "test/extensions/stats_sinks/prometheus_remote_write/remote_write_receiver.h"
+#include "test/integration/http_integration.h"
+#include "test/test_common/utility.h"
+
+#include "gtest/gtest.h"
+
+namespace Envoy {
+namespace {
+
+class PrometheusRemoteWriteIntegrationTest
+    : public testing::TestWithParam<Network::Address::IpVersion>,
+      public HttpIntegrationTest {
+public:
+  PrometheusRemoteWriteIntegrationTest()
+      : HttpIntegrationTest(Http::CodecClient::Type::HTTP1, GetParam()) {}
+
+  void createUpstreams() override {
+    HttpIntegrationTest::createUpstreams();
+    addFakeUpstream(FakeHttpConnection::Type::HTTP2);
+  }
+
+  void initialize() override {
+    config_helper_.addConfigModifier([](envoy::config::bootstrap::v3::Bootstrap& bootstrap) {
+      auto* receiver_cluster = bootstrap.mutable_static_resources()->add_clusters();
+      receiver_cluster->MergeFrom(bootstrap.static_resources().clusters()[0]);
+      receiver_cluster->set_name("remote_write");
+      // A flush may send a request before the response to the previous one is read, so HTTP/2
+      // keeps the requests on one connection.
+      ConfigHelper::setHttp2(*receiver_cluster);
+
+      auto* sink = bootstrap.add_stats_sinks();
+      sink->set_name("envoy.stat_sinks.prometheus_remote_write");
+      envoy::extensions::stat_sinks::prometheus_remote_write::v3::PrometheusRemoteWrite config;
+      config.mutable_http_uri()->set_uri("http://remote_write/api/v1/write");
+      config.mutable_http_uri()->set_cluster("remote_write");
+      config.mutable_http_uri()->mutable_timeout()->set_seconds(5);
+      sink->mutable_typed_config()->PackFrom(config);
+      bootstrap.mutable_stats_flush_interval()->CopyFrom(
+          Protobuf::util::TimeUtil::MillisecondsToDuration(100));
+    });
+    HttpIntegrationTest::initialize();
+  }
+
+  // Waits for a remote write request, responds with the given status and returns its samples.
+  std::vector<Extensions::StatSinks::PrometheusRemoteWrite::ReceivedSample>
+  waitForWriteRequest(const std::string& status) {
+    if (receiver_connection_ == nullptr) {
+      AssertionResult result =
+          fake_upstreams_[1]->waitForHttpConnection(*dispatcher_, receiver_connection_);
+      RELEASE_ASSERT(result, result.message());
+    }
+    FakeStreamPtr request;
+    AssertionResult result = receiver_connection_->waitForNewStream(*dispatcher_, request);
+    RELEASE_ASSERT(result, result.message());
+    result = request->waitForEndStream(*dispatcher_);
+    RELEASE_ASSERT(result, result.message());
+
+    EXPECT_EQ("POST", request->headers().getMethodValue());
+    EXPECT_EQ("/api/v1/write", request->headers().getPathValue());
+    EXPECT_EQ("application/x-protobuf", request->headers().getContentTypeValue());
+    request->encodeHeaders(Http::TestResponseHeaderMapImpl{{":status", status}}, true);
+    return Extensions::StatSinks::PrometheusRemoteWrite::decodeRequestBody(
+        request->body().toString());
+  }
+
+  void cleanup() {
+    if (receiver_connection_ != nullptr) {
+      AssertionResult result = receiver_connection_->close();
+      RELEASE_ASSERT(result, result.message());
+      result = receiver_connection_->waitForDisconnect();
+      RELEASE_ASSERT(result, result.message());
+    }
+  }
+
+  FakeHttpConnectionPtr receiver_connection_;
+};
+
+INSTANTIATE_TEST_SUITE_P(IpVersions, PrometheusRemoteWriteIntegrationTest,
+                         testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
+                         TestUtility::ipTestParamsToString);
+
+bool hasSample(const std::vector<Extensions::StatSinks::PrometheusRemoteWrite::ReceivedSample>&
+                   samples,
+               const std::string& name, const std::string& cluster_name) {
+  for (const auto& sample : samples) {
+    const auto name_it = sample.labels_.find("__name__");
+    const auto cluster_it = sample.labels_.find("envoy_cluster_name");
+    if (name_it != sample.labels_.end() && name_it->second == name &&
+        cluster_it != sample.labels_.end() && cluster_it->second == cluster_name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// The first request has all the used metrics, while later requests only have the changed ones,
+// unless the previous request failed.
+TEST_P(PrometheusRemoteWriteIntegrationTest, ChangedMetrics) {
+  initialize();
+
+  auto samples = waitForWriteRequest("200");
+  EXPECT_TRUE(hasSample(samples, "envoy_cluster_membership_change", "cluster_0"));
+  test_server_->waitForCounterGe("prometheus_remote_write.requests_sent", 1);
+
+  // The membership of cluster_0 doesn't change, so it isn't sent again, but the receiver's
+  // request stats are.
+  samples = waitForWriteRequest("503");
+  EXPECT_FALSE(hasSample(samples, "envoy_cluster_membership_change", "cluster_0"));
+  test_server_->waitForCounterGe("prometheus_remote_write.requests_failed", 1);
+
+  // Everything is sent again after the failure.
+  samples = waitForWriteRequest("200");
+  EXPECT_TRUE(hasSample(samples, "envoy_cluster_membership_change", "cluster_0"));
+
+  cleanup();
+}
+
+} // namespace
+} // namespace Envoy
@@ -0,0 +1,187 @@
+#include "test/extensions/stats_sinks/prometheus_remote_write/remote_write_receiver.h"
+
+#include <cstring>
+
+#include "envoy/common/exception.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace {
+
+class Reader {
+public:
+  explicit Reader(absl::string_view data) : data_(data) {}
+
+  bool done() const { return data_.empty(); }
+
+  uint8_t byte() {
+    if (data_.empty()) {
+      throw EnvoyException("truncated data");
+    }
+    const uint8_t value = data_[0];
+    data_.remove_prefix(1);
+    return value;
+  }
+
+  uint64_t varint() {
+    uint64_t value = 0;
+    for (uint32_t shift = 0; shift < 64; shift += 7) {
+      const uint8_t b = byte();
+      value |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if ((b & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw EnvoyException("invalid varint");
+  }
+
+  uint64_t littleEndian(uint32_t num_bytes) {
+    uint64_t value = 0;
+    for (uint32_t i = 0; i < num_bytes; ++i) {
+      value |= static_cast<uint64_t>(byte()) << (8 * i);
+    }
+    return value;
+  }
+
+  absl::string_view bytes(uint64_t size) {
+    if (size > data_.size()) {
+      throw EnvoyException("truncated data");
+    }
+    const absl::string_view value = data_.substr(0, size);
+    data_.remove_prefix(size);
+    return value;
+  }
+
+  // Reads the key of a protobuf field, returning the field number and setting the wire type.
+  uint32_t key(uint32_t& wire_type) {
+    const uint64_t key = varint();
+    wire_type = key & 7;
+    return key >> 3;
+  }
+
+private:
+  absl::string_view data_;
+};
+
+void expectWireType(uint32_t wire_type, uint32_t expected) {
+  if (wire_type != expected) {
+    throw EnvoyException("unexpected wire type");
+  }
+}
+
+void decodeLabel(absl::string_view data, ReceivedSample& sample) {
+  Reader reader(data);
+  std::string name;
+  std::string value;
+  while (!reader.done()) {
+    uint32_t wire_type;
+    const uint32_t field = reader.key(wire_type);
+    expectWireType(wire_type, 2);
+    const absl::string_view bytes = reader.bytes(reader.varint());
+    if (field == 1) {
+      name = std::string(bytes);
+    } else if (field == 2) {
+      value = std::string(bytes);
+    }
+  }
+  sample.label_order_.push_back(name);
+  sample.labels_[name] = value;
+}
+
+void decodeSample(absl::string_view data, ReceivedSample& sample) {
+  Reader reader(data);
+  while (!reader.done()) {
+    uint32_t wire_type;
+    const uint32_t field = reader.key(wire_type);
+    if (field == 1) {
+      expectWireType(wire_type, 1);
+      const uint64_t bits = reader.littleEndian(8);
+      memcpy(&sample.value_, &bits, sizeof(bits));
+    } else if (field == 2) {
+      expectWireType(wire_type, 0);
+      sample.timestamp_ms_ = static_cast<int64_t>(reader.varint());
+    } else {
+      throw EnvoyException("unexpected sample field");
+    }
+  }
+}
+
+} // namespace
+
+std::string snappyDecompress(absl::string_view compressed) {
+  Reader reader(compressed);
+  const uint64_t size = reader.varint();
+  std::string output;
+  while (!reader.done()) {
+    const uint8_t tag = reader.byte();
+    uint64_t length;
+    uint64_t offset;
+    switch (tag & 3) {
+    case 0:
+      length = tag >> 2;
+      if (length >= 60) {
+        length = reader.littleEndian(length - 59);
+      }
+      output.append(std::string(reader.bytes(length + 1)));
+      continue;
+    case 1:
+      length = ((tag >> 2) & 7) + 4;
+      offset = (static_cast<uint64_t>(tag >> 5) << 8) | reader.byte();
+      break;
+    case 2:
+      length = (tag >> 2) + 1;
+      offset = reader.littleEndian(2);
+      break;
+    default:
+      length = (tag >> 2) + 1;
+      offset = reader.littleEndian(4);
+      break;
+    }
+    if (offset == 0 || offset > output.size()) {
+      throw EnvoyException("invalid copy offset");
+    }
+    // Copies may overlap the bytes they produce, so they are copied one at a time.
+    for (uint64_t i = 0; i < length; ++i) {
+      output.push_back(output[output.size() - offset]);
+    }
+  }
+  if (output.size() != size) {
+    throw EnvoyException("unexpected decompressed size");
+  }
+  return output;
+}
+
+std::vector<ReceivedSample> decodeWriteRequest(absl::string_view data) {
+  std::vector<ReceivedSample> samples;
+  Reader reader(data);
+  while (!reader.done()) {
+    uint32_t wire_type;
+    if (reader.key(wire_type) != 1) {
+      throw EnvoyException("unexpected write request field");
+    }
+    expectWireType(wire_type, 2);
+    Reader series(reader.bytes(reader.varint()));
+    ReceivedSample sample;
+    while (!series.done()) {
+      const uint32_t field = series.key(wire_type);
+      expectWireType(wire_type, 2);
+      const absl::string_view bytes = series.bytes(series.varint());
+      if (field == 1) {
+        decodeLabel(bytes, sample);
+      } else if (field == 2) {
+        decodeSample(bytes, sample);
+      } else {
+        throw EnvoyException("unexpected time series field");
+      }
+    }
+    samples.push_back(std::move(sample));
+  }
+  return samples;
+}
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+
+// A sample of a remote write request, decoded as a receiver would.
+struct ReceivedSample {
+  std::map<std::string, std::string> labels_;
+  // The label names in the order they were encoded.
+  std::vector<std::string> label_order_;
+  double value_{};
+  int64_t timestamp_ms_{};
+};
+
+/**
+ * Decompresses data in the snappy block format. Throws EnvoyException if the data is invalid.
+ */
+std::string snappyDecompress(absl::string_view compressed);
+
+/**
+ * Decodes the samples of a serialized remote write WriteRequest. Throws EnvoyException if the
+ * data is invalid.
+ */
+std::vector<ReceivedSample> decodeWriteRequest(absl::string_view data);
+
+/**
+ * Decodes the samples of a remote write request body.
+ */
+inline std::vector<ReceivedSample> decodeRequestBody(absl::string_view body) {
+  return decodeWriteRequest(snappyDecompress(body));
+}
+
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,265 @@
+#include <chrono>
+#include <memory>
+
+#include "envoy/config/core/v3/http_uri.pb.h"
+
+#include "common/http/message_impl.h"
+#include "common/stats/isolated_store_impl.h"
+
+#include "extensions/stat_sinks/prometheus_remote_write/remote_write_sink.h"
+#include "extensions/stat_sinks/prometheus_remote_write/snappy.h"
+
+#include "test/extensions/stats_sinks/prometheus_remote_write/remote_write_receiver.h"
+#include "test/mocks/http/mocks.h"
+#include "test/mocks/stats/mocks.h"
+#include "test/mocks/upstream/cluster_manager.h"
+#include "test/test_common/utility.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+
+using testing::_;
+using testing::ElementsAre;
+using testing::Invoke;
+using testing::NiceMock;
+
+namespace Envoy {
+namespace Extensions {
+namespace StatSinks {
+namespace PrometheusRemoteWrite {
+namespace {
+
+TEST(SnappyTest, RoundTrip) {
+  std::string repetitive;
+  for (int i = 0; i < 20000; ++i) {
+    repetitive += absl::StrCat("cluster.cluster_", i % 100, ".upstream_rq_total");
+  }
+  std::string mixed;
+  for (uint32_t i = 0; i < 100000; ++i) {
+    mixed.push_back(static_cast<char>((i * 2654435761u) >> 24));
+    if (i % 1000 == 0) {
+      mixed += std::string(300, 'x');
+    }
+  }
+  for (const std::string& input : {std::string(), std::string("a"), std::string("abcd"),
+                                   std::string(100, 'z'), repetitive, mixed}) {
+    std::string compressed;
+    Snappy::compress(input, compressed);
+    EXPECT_EQ(input, snappyDecompress(compressed));
+  }
+
+  std::string compressed;
+  Snappy::compress(repetitive, compressed);
+  EXPECT_LT(compressed.size(), repetitive.size() / 10);
+}
+
+class PrometheusRemoteWriteSinkTest : public testing::Test {
+public:
+  PrometheusRemoteWriteSinkTest() {
+    http_uri_.set_uri("http://receiver/api/v1/write");
+    http_uri_.set_cluster("receiver");
+    http_uri_.mutable_timeout()->set_seconds(1);
+    cluster_manager_.initializeThreadLocalClusters({"receiver"});
+    ON_CALL(cluster_manager_.thread_local_cluster_.async_client_, send_(_, _, _))
+        .WillByDefault(Invoke([this](Http::RequestMessagePtr& message,
+                                     Http::AsyncClient::Callbacks& callbacks,
+                                     const Http::AsyncClient::RequestOptions&) {
+          requests_.push_back(std::move(message));
+          callbacks_ = &callbacks;
+          return &request_;
+        }));
+
+    counter_.name_ = "cluster.receiver.upstream_rq_total";
+    counter_.setTagExtractedName("cluster.upstream_rq_total");
+    counter_.setTags(Stats::TagVector{{"envoy.cluster_name", "receiver"}});
+    counter_.used_ = true;
+    counter_.value_ = 1;
+    gauge_.name_ = "server.live";
+    gauge_.used_ = true;
+    gauge_.value_ = 1;
+    snapshot_.counters_.push_back({1, counter_});
+    snapshot_.gauges_.push_back(gauge_);
+    snapshot_.snapshot_time_ = SystemTime(std::chrono::seconds(1000));
+  }
+
+  void createSink(uint32_t max_samples_per_request = 100) {
+    sink_ = std::make_unique<PrometheusRemoteWriteSink>(cluster_manager_, store_, http_uri_,
+                                                        max_samples_per_request,
+                                                        std::chrono::minutes(4));
+  }
+
+  // Flushes, returning the samples of the requests sent.
+  std::vector<ReceivedSample> flush() {
+    requests_.clear();
+    sink_->flush(snapshot_);
+    std::vector<ReceivedSample> samples;
+    for (const auto& request : requests_) {
+      for (ReceivedSample& sample : decodeRequestBody(request->bodyAsString())) {
+        samples.push_back(std::move(sample));
+      }
+    }
+    return samples;
+  }
+
+  void respond(const std::string& status) {
+    Http::ResponseMessagePtr response(new Http::ResponseMessageImpl(
+        Http::ResponseHeaderMapPtr{new Http::TestResponseHeaderMapImpl{{":status", status}}}));
+    callbacks_->onSuccess(request_, std::move(response));
+  }
+
+  uint64_t counter(const std::string& name) {
+    return TestUtility::findCounter(store_, "prometheus_remote_write." + name)->value();
+  }
+
+  NiceMock<Upstream::MockClusterManager> cluster_manager_;
+  Stats::IsolatedStoreImpl store_;
+  envoy::config::core::v3::HttpUri http_uri_;
+  NiceMock<Http::MockAsyncClientRequest> request_{
+      &cluster_manager_.thread_local_cluster_.async_client_};
+  std::vector<Http::RequestMessagePtr> requests_;
+  Http::AsyncClient::Callbacks* callbacks_{};
+  NiceMock<Stats::MockCounter> counter_;
+  NiceMock<Stats::MockGauge> gauge_;
+  NiceMock<Stats::MockMetricSnapshot> snapshot_;
+  std::unique_ptr<PrometheusRemoteWriteSink> sink_;
+};
+
+// The metrics are sent as a remote write request, named as in the admin Prometheus output.
+TEST_F(PrometheusRemoteWriteSinkTest, Request) {
+  createSink();
+  const std::vector<ReceivedSample> samples = flush();
+  ASSERT_EQ(1, requests_.size());
+  const Http::RequestHeaderMap& headers = requests_[0]->headers();
+  EXPECT_EQ("POST", headers.getMethodValue());
+  EXPECT_EQ("/api/v1/write", headers.getPathValue());
+  EXPECT_EQ("receiver", headers.getHostValue());
+  EXPECT_EQ("application/x-protobuf", headers.getContentTypeValue());
+  EXPECT_EQ("snappy", headers.get(Http::CustomHeaders::get().ContentEncoding)[0]->value()
+                          .getStringView());
+  EXPECT_EQ("0.1.0", headers.get(Http::LowerCaseString("x-prometheus-remote-write-version"))[0]
+                         ->value()
+                         .getStringView());
+
+  ASSERT_EQ(2, samples.size());
+  EXPECT_THAT(samples[0].label_order_, ElementsAre("__name__", "envoy_cluster_name"));
+  EXPECT_EQ("envoy_cluster_upstream_rq_total", samples[0].labels_.at("__name__"));
+  EXPECT_EQ("receiver", samples[0].labels_.at("envoy_cluster_name"));
+  EXPECT_EQ(1, samples[0].value_);
+  EXPECT_EQ(1000000, samples[0].timestamp_ms_);
+  EXPECT_THAT(samples[1].label_order_, ElementsAre("__name__"));
+  EXPECT_EQ("envoy_server_live", samples[1].labels_.at("__name__"));
+
+  respond("204");
+  EXPECT_EQ(1, counter("requests_sent"));
+  EXPECT_EQ(0, counter("requests_failed"));
+  EXPECT_EQ(2, counter("samples_sent"));
+}
+
+// Only the metrics whose value changed are sent again.
+TEST_F(PrometheusRemoteWriteSinkTest, OnlyChangedMetrics) {
+  createSink();
+  EXPECT_EQ(2, flush().size());
+  respond("200");
+
+  EXPECT_EQ(0, flush().size());
+  EXPECT_TRUE(requests_.empty());
+  EXPECT_EQ(2, counter("samples_unchanged"));
+
+  gauge_.value_ = 0;
+  std::vector<ReceivedSample> samples = flush();
+  ASSERT_EQ(1, samples.size());
+  EXPECT_EQ("envoy_server_live", samples[0].labels_.at("__name__"));
+  EXPECT_EQ(0, samples[0].value_);
+  respond("200");
+
+  counter_.value_ = 5;
+  samples = flush();
+  ASSERT_EQ(1, samples.size());
+  EXPECT_EQ("envoy_cluster_upstream_rq_total", samples[0].labels_.at("__name__"));
+  EXPECT_EQ(5, samples[0].value_);
+}
+
+// Unused metrics aren't sent, and are sent once used.
+TEST_F(PrometheusRemoteWriteSinkTest, UnusedMetrics) {
+  counter_.used_ = false;
+  createSink();
+  EXPECT_EQ(1, flush().size());
+  respond("200");
+  counter_.used_ = true;
+  EXPECT_EQ(1, flush().size());
+}
+
+// Unchanged metrics are sent again after the resend interval.
+TEST_F(PrometheusRemoteWriteSinkTest, ResendInterval) {
+  createSink();
+  EXPECT_EQ(2, flush().size());
+  respond("200");
+  snapshot_.snapshot_time_ += std::chrono::minutes(3);
+  EXPECT_EQ(0, flush().size());
+  snapshot_.snapshot_time_ += std::chrono::minutes(1);
+  EXPECT_EQ(2, flush().size());
+}
+
+// The samples of a flush are split over requests.
+TEST_F(PrometheusRemoteWriteSinkTest, MaxSamplesPerRequest) {
+  std::vector<std::unique_ptr<NiceMock<Stats::MockGauge>>> gauges;
+  for (int i = 0; i < 4; ++i) {
+    gauges.push_back(std::make_unique<NiceMock<Stats::MockGauge>>());
+    gauges.back()->name_ = absl::StrCat("gauge", i);
+    gauges.back()->used_ = true;
+    snapshot_.gauges_.push_back(*gauges.back());
+  }
+  createSink(2);
+  EXPECT_EQ(6, flush().size());
+  EXPECT_EQ(3, requests_.size());
+  EXPECT_EQ(3, counter("requests_sent"));
+  snapshot_.gauges_.clear();
+}
+
+// All the metrics are sent again after a failed request, as the receiver may have missed changes.
+TEST_F(PrometheusRemoteWriteSinkTest, ResendAllAfterFailure) {
+  createSink();
+  EXPECT_EQ(2, flush().size());
+  respond("503");
+  EXPECT_EQ(1, counter("requests_failed"));
+  EXPECT_EQ(2, flush().size());
+  callbacks_->onFailure(request_, Http::AsyncClient::FailureReason::Reset);
+  EXPECT_EQ(2, counter("requests_failed"));
+  EXPECT_EQ(2, flush().size());
+  respond("200");
+  EXPECT_EQ(0, flush().size());
+}
+
+// Metrics are forgotten once they're no longer in snapshots.
+TEST_F(PrometheusRemoteWriteSinkTest, RemovedMetrics) {
+  createSink();
+  EXPECT_EQ(2, flush().size());
+  respond("200");
+  snapshot_.gauges_.clear();
+  EXPECT_EQ(0, flush().size());
+  snapshot_.gauges_.push_back(gauge_);
+  EXPECT_EQ(1, flush().size());
+}
+
+// The request fails when the cluster doesn't exist.
+TEST_F(PrometheusRemoteWriteSinkTest, UnknownCluster) {
+  http_uri_.set_cluster("unknown");
+  createSink();
+  EXPECT_CALL(cluster_manager_.thread_local_cluster_.async_client_, send_(_, _, _)).Times(0);
+  sink_->flush(snapshot_);
+  EXPECT_EQ(1, counter("requests_failed"));
+}
+
+// Requests in flight are canceled when the sink is destroyed.
+TEST_F(PrometheusRemoteWriteSinkTest, CancelOnDestroy) {
+  createSink();
+  flush();
+  EXPECT_CALL(request_, cancel());
+  sink_.reset();
+}
+
+} // namespace
+} // namespace PrometheusRemoteWrite
+} // namespace StatSinks
+} // namespace Extensions
+} // namespace Envoy
@@ -0,0 +1,92 @@
+#include <string>
+
+#include "extensions/transport_sockets/tls/session_cache.h"
+
+#include "gtest/gtest.h"
+#include "openssl/ssl.h"
+
+namespace Envoy {
+namespace Extensions {
+namespace TransportSockets {
+namespace Tls {
+namespace {
+
+class SessionCacheTest : public testing::Test {
+public:
+  SessionCacheTest() : ctx_(SSL_CTX_new(TLS_method())) {}
+
+  bssl::UniquePtr<SSL_SESSION> newSession(uint64_t time = 1000, uint32_t timeout = 300,
+                                          uint16_t version = TLS1_2_VERSION) {
+    bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_new(ctx_.get()));
+    SSL_SESSION_set_protocol_version(session.get(), version);
+    SSL_SESSION_set_time(session.get(), time);
+    SSL_SESSION_set_timeout(session.get(), timeout);
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ctx_;
+};
+
+TEST_F(SessionCacheTest, InsertLookupRemove) {
+  SessionCache cache(16, 4);
+  EXPECT_EQ(nullptr, cache.lookup("a", 1000));
+
+  bssl::UniquePtr<SSL_SESSION> session = newSession();
+  SSL_SESSION* raw = session.get();
+  cache.insert("a", std::move(session));
+  cache.insert("b", newSession());
+  EXPECT_EQ(2, cache.size());
+
+  // Lookups return a new reference and keep the session cached.
+  EXPECT_EQ(raw, cache.lookup("a", 1000).get());
+  EXPECT_EQ(raw, cache.lookup("a", 1000).get());
+
+  // Inserting again replaces the session of the key.
+  bssl::UniquePtr<SSL_SESSION> replacement = newSession();
+  SSL_SESSION* raw_replacement = replacement.get();
+  cache.insert("a", std::move(replacement));
+  EXPECT_EQ(2, cache.size());
+  EXPECT_EQ(raw_replacement, cache.lookup("a", 1000).get());
+
+  cache.remove("a");
+  cache.remove("c");
+  EXPECT_EQ(nullptr, cache.lookup("a", 1000));
+  EXPECT_EQ(1, cache.size());
+}
+
+// The least recently used session is evicted once a shard is full.
+TEST_F(SessionCacheTest, LruEviction) {
+  SessionCache cache(2, 1);
+  cache.insert("a", newSession());
+  cache.insert("b", newSession());
+  EXPECT_NE(nullptr, cache.lookup("a", 1000));
+  cache.insert("c", newSession());
+
+  EXPECT_EQ(2, cache.size());
+  EXPECT_NE(nullptr, cache.lookup("a", 1000));
+  EXPECT_EQ(nullptr, cache.lookup("b", 1000));
+  EXPECT_NE(nullptr, cache.lookup("c", 1000));
+}
+
+TEST_F(SessionCacheTest, Expiry) {
+  SessionCache cache(16, 4);
+  cache.insert("a", newSession(1000, 300));
+  EXPECT_NE(nullptr, cache.lookup("a", 1299));
+  EXPECT_EQ(nullptr, cache.lookup("a", 1300));
+  EXPECT_EQ(0, cache.size());
+}
+
+// TLS 1.3 sessions are handed out only once.
+TEST_F(SessionCacheTest, SingleUse) {
+  SessionCache cache(16, 4);
+  cache.insert("a", newSession(1000, 300, TLS1_3_VERSION));
+  EXPECT_NE(nullptr, cache.lookup("a", 1000));
+  EXPECT_EQ(nullptr, cache.lookup("a", 1000));
+  EXPECT_EQ(0, cache.size());
+}
+
+} // namespace
+} // namespace Tls
+} // namespace TransportSockets
+} // namespace Extensions
+} // namespace Envoy
@@ -825,6 +825,9 @@ protected:
   void testClientSessionResumption(const std::string& server_ctx_yaml,
                                    const std::string& client_ctx_yaml, bool expect_reuse,
                                    const Network::Address::IpVersion version);
+  void testKernelTlsOffload(const std::string& tls_maximum_protocol_version,
+                            Stats::TestUtil::TestStore& server_stats_store,
+                            Stats::TestUtil::TestStore& client_stats_store);
 
   Event::DispatcherPtr dispatcher_;
   StreamInfo::StreamInfoImpl stream_info_;
@@ -2636,6 +2639,127 @@ TEST_P(SslSocketTest, ShutdownWithCloseNotify) {
   dispatcher_->run(Event::Dispatcher::RunType::Block);
 }
 
+// Exchanges data with kernel TLS offload configured on both sides and the given maximum TLS
+// version. The data must flow, and the connection must end with a close_notify, whether or not the
+// kernel supports the offload.
+void SslSocketTest::testKernelTlsOffload(const std::string& tls_maximum_protocol_version,
+                                         Stats::TestUtil::TestStore& server_stats_store,
+                                         Stats::TestUtil::TestStore& client_stats_store) {
+  const std::string server_ctx_yaml = absl::StrCat(R"EOF(
+  common_tls_context:
+    kernel_tls_offload: true
+    tls_params:
+      tls_maximum_protocol_version: )EOF",
+                                                   tls_maximum_protocol_version, R"EOF(
+      cipher_suites: [ECDHE-RSA-AES128-GCM-SHA256]
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+)EOF");
+
+  envoy::extensions::transport_sockets::tls::v3::DownstreamTlsContext server_tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(server_ctx_yaml), server_tls_context);
+  auto server_cfg = std::make_unique<ServerContextConfigImpl>(server_tls_context, factory_context_);
+  ContextManagerImpl manager(time_system_);
+  ServerSslSocketFactory server_ssl_socket_factory(std::move(server_cfg), manager,
+                                                   server_stats_store, std::vector<std::string>{});
+
+  auto socket = std::make_shared<Network::TcpListenSocket>(
+      Network::Test::getCanonicalLoopbackAddress(GetParam()), nullptr, true);
+  Network::MockTcpListenerCallbacks listener_callbacks;
+  Network::ListenerPtr listener =
+      dispatcher_->createListener(socket, listener_callbacks, true, ENVOY_TCP_BACKLOG_SIZE);
+  std::shared_ptr<Network::MockReadFilter> server_read_filter(new Network::MockReadFilter());
+  std::shared_ptr<Network::MockReadFilter> client_read_filter(new Network::MockReadFilter());
+
+  const std::string client_ctx_yaml = R"EOF(
+    common_tls_context:
+      kernel_tls_offload: true
+  )EOF";
+
+  envoy::extensions::transport_sockets::tls::v3::UpstreamTlsContext tls_context;
+  TestUtility::loadFromYaml(TestEnvironment::substitute(client_ctx_yaml), tls_context);
+  auto client_cfg = std::make_unique<ClientContextConfigImpl>(tls_context, factory_context_);
+  ClientSslSocketFactory client_ssl_socket_factory(std::move(client_cfg), manager,
+                                                   client_stats_store);
+  Network::ClientConnectionPtr client_connection = dispatcher_->createClientConnection(
+      socket->addressProvider().localAddress(), Network::Address::InstanceConstSharedPtr(),
+      client_ssl_socket_factory.createTransportSocket(nullptr), nullptr);
+  Network::MockConnectionCallbacks client_connection_callbacks;
+  client_connection->enableHalfClose(true);
+  client_connection->addReadFilter(client_read_filter);
+  client_connection->addConnectionCallbacks(client_connection_callbacks);
+  client_connection->connect();
+
+  Network::ConnectionPtr server_connection;
+  Network::MockConnectionCallbacks server_connection_callbacks;
+  EXPECT_CALL(listener_callbacks, onAccept_(_))
+      .WillOnce(Invoke([&](Network::ConnectionSocketPtr& socket) -> void {
+        server_connection = dispatcher_->createServerConnection(
+            std::move(socket), server_ssl_socket_factory.createTransportSocket(nullptr),
+            stream_info_);
+        server_connection->enableHalfClose(true);
+        server_connection->addReadFilter(server_read_filter);
+        server_connection->addConnectionCallbacks(server_connection_callbacks);
+      }));
+  EXPECT_CALL(*server_read_filter, onNewConnection());
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::Connected))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        Buffer::OwnedImpl data("hello");
+        server_connection->write(data, true);
+        EXPECT_EQ(data.length(), 0);
+      }));
+
+  EXPECT_CALL(*client_read_filter, onNewConnection())
+      .WillOnce(Return(Network::FilterStatus::Continue));
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::Connected));
+  EXPECT_CALL(*client_read_filter, onData(BufferStringEqual("hello"), true))
+      .WillOnce(Invoke([&](Buffer::Instance& read_buffer, bool) -> Network::FilterStatus {
+        read_buffer.drain(read_buffer.length());
+        client_connection->close(Network::ConnectionCloseType::NoFlush);
+        return Network::FilterStatus::StopIteration;
+      }));
+  EXPECT_CALL(*server_read_filter, onData(_, true));
+
+  EXPECT_CALL(client_connection_callbacks, onEvent(Network::ConnectionEvent::LocalClose));
+  EXPECT_CALL(server_connection_callbacks, onEvent(Network::ConnectionEvent::RemoteClose))
+      .WillOnce(Invoke([&](Network::ConnectionEvent) -> void {
+        server_connection->close(Network::ConnectionCloseType::NoFlush);
+        dispatcher_->exit();
+      }));
+
+  dispatcher_->run(Event::Dispatcher::RunType::Block);
+}
+
+TEST_P(SslSocketTest, KernelTlsOffload) {
+  Stats::TestUtil::TestStore server_stats_store;
+  Stats::TestUtil::TestStore client_stats_store;
+  testKernelTlsOffload("TLSv1_2", server_stats_store, client_stats_store);
+#ifdef __linux__
+  // Whether the kernel accepts the keys depends on the host, but the connection qualifies.
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.ktls_unsupported").value());
+  EXPECT_EQ(0UL, client_stats_store.counter("ssl.ktls_unsupported").value());
+#endif
+  // Receive offload is only ever enabled along with transmit offload.
+  EXPECT_LE(server_stats_store.counter("ssl.ktls_rx_offloaded").value(),
+            server_stats_store.counter("ssl.ktls_tx_offloaded").value());
+  EXPECT_LE(client_stats_store.counter("ssl.ktls_rx_offloaded").value(),
+            client_stats_store.counter("ssl.ktls_tx_offloaded").value());
+}
+
+// TLS 1.3 connections are handled by BoringSSL.
+TEST_P(SslSocketTest, KernelTlsOffloadTls13Unsupported) {
+  Stats::TestUtil::TestStore server_stats_store;
+  Stats::TestUtil::TestStore client_stats_store;
+  testKernelTlsOffload("TLSv1_3", server_stats_store, client_stats_store);
+  EXPECT_EQ(1UL, server_stats_store.counter("ssl.ktls_unsupported").value());
+  EXPECT_EQ(1UL, client_stats_store.counter("ssl.ktls_unsupported").value());
+  EXPECT_EQ(0UL, server_stats_store.counter("ssl.ktls_tx_offloaded").value());
+  EXPECT_EQ(0UL, client_stats_store.counter("ssl.ktls_tx_offloaded").value());
+}
+
 TEST_P(SslSocketTest, ShutdownWithoutCloseNotify) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
@@ -3679,6 +3803,15 @@ void SslSocketTest::testClientSessionResumption(const std::string& server_ctx_ya
 
   EXPECT_EQ(expect_reuse ? 1UL : 0UL, server_stats_store.counter("ssl.session_reused").value());
   EXPECT_EQ(expect_reuse ? 1UL : 0UL, client_stats_store.counter("ssl.session_reused").value());
+  if (client_ctx_proto.has_session_cache()) {
+    EXPECT_EQ(1UL, client_stats_store.counter("ssl.session_cache_miss").value());
+    EXPECT_EQ(expect_reuse ? 1UL : 0UL,
+              client_stats_store.counter("ssl.session_cache_hit").value());
+  }
+  if (server_ctx_proto.has_session_cache()) {
+    EXPECT_EQ(expect_reuse ? 1UL : 0UL,
+              server_stats_store.counter("ssl.session_cache_hit").value());
+  }
 }
 
 // Test client session resumption using default settings (should be enabled).
@@ -3796,6 +3929,84 @@ TEST_P(SslSocketTest, ClientSessionResumptionEnabledTls13) {
   testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
 }
 
+// Test client session resumption with sessions cached per upstream host with TLS 1.0-1.2.
+TEST_P(SslSocketTest, ClientSessionCacheTls12) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+  session_cache:
+    max_sessions: 8
+    shards: 2
+)EOF";
+
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
+}
+
+// Test client session resumption with sessions cached per upstream host with TLS 1.3.
+TEST_P(SslSocketTest, ClientSessionCacheTls13) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_3
+      tls_maximum_protocol_version: TLSv1_3
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_3
+      tls_maximum_protocol_version: TLSv1_3
+  session_cache: {}
+)EOF";
+
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
+}
+
+// Test stateful resumption from the server's shared session ID cache.
+TEST_P(SslSocketTest, ServerSessionCacheTls12) {
+  const std::string server_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+    tls_certificates:
+      certificate_chain:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_cert.pem"
+      private_key:
+        filename: "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/unittest_key.pem"
+  disable_stateless_session_resumption: true
+  session_cache: {}
+)EOF";
+
+  const std::string client_ctx_yaml = R"EOF(
+  common_tls_context:
+    tls_params:
+      tls_minimum_protocol_version: TLSv1_0
+      tls_maximum_protocol_version: TLSv1_2
+)EOF";
+
+  testClientSessionResumption(server_ctx_yaml, client_ctx_yaml, true, GetParam());
+}
+
 TEST_P(SslSocketTest, SslError) {
   const std::string server_ctx_yaml = R"EOF(
   common_tls_context:
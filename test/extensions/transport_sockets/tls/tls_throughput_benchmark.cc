@@ -1,4 +1,11 @@
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
 #include "common/buffer/buffer_impl.h"
+#include "common/network/io_socket_handle_impl.h"
+
+#include "extensions/transport_sockets/tls/kernel_tls.h"
 
 #include "test/test_common/environment.h"
 
@@ -64,17 +71,39 @@ static void addFullSlices(Buffer::Instance& output_buffer, unsigned num_slices,
   }
 }
 
-static void testThroughput(benchmark::State& state) {
+// Connects a pair of TCP sockets over the loopback interface, as kTLS doesn't support other socket
+// types.
+static void tcpSocketPair(int sockets[2]) {
+  int listener = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  socklen_t address_length = sizeof(address);
+  RELEASE_ASSERT(bind(listener, reinterpret_cast<sockaddr*>(&address), address_length) == 0 &&
+                     listen(listener, 1) == 0 &&
+                     getsockname(listener, reinterpret_cast<sockaddr*>(&address),
+                                 &address_length) == 0,
+                 "listen");
+  sockets[1] = socket(AF_INET, SOCK_STREAM, 0);
+  RELEASE_ASSERT(connect(sockets[1], reinterpret_cast<sockaddr*>(&address), address_length) == 0,
+                 "connect");
+  sockets[0] = accept4(listener, nullptr, nullptr, SOCK_NONBLOCK);
+  RELEASE_ASSERT(sockets[0] >= 0, "accept");
+  ::close(listener);
+  fcntl(sockets[1], F_SETFL, fcntl(sockets[1], F_GETFL) | O_NONBLOCK);
+}
+
+// Creates a client and a server SSL on the given sockets and completes their handshake.
+static void connectSsl(int sockets[2], uint16_t max_version, bssl::UniquePtr<SSL>& server_ssl,
+                       bssl::UniquePtr<SSL>& client_ssl) {
   std::string error;
   std::unique_ptr<bazel::tools::cpp::runfiles::Runfiles> runfiles(
       bazel::tools::cpp::runfiles::Runfiles::Create("tls_throughput_benchmark", &error));
   Envoy::TestEnvironment::setRunfiles(runfiles.get());
 
-  int sockets[2];
-  socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets);
-
   bssl::UniquePtr<SSL_CTX> server_ctx(SSL_CTX_new(TLS_method()));
   bssl::UniquePtr<SSL_CTX> client_ctx(SSL_CTX_new(TLS_method()));
+  SSL_CTX_set_max_proto_version(client_ctx.get(), max_version);
   std::string cert_path = TestEnvironment::substitute(
       "{{ test_rundir }}/test/extensions/transport_sockets/tls/test_data/san_dns_cert.pem");
   std::string key_path = TestEnvironment::substitute(
@@ -85,11 +114,11 @@ static void testThroughput(benchmark::State& state) {
   err = SSL_CTX_use_PrivateKey_file(server_ctx.get(), key_path.c_str(), SSL_FILETYPE_PEM);
   RELEASE_ASSERT(err > 0, "SSL_CTX_use_PrivateKey_file");
 
-  bssl::UniquePtr<SSL> server_ssl(SSL_new(server_ctx.get()));
+  server_ssl.reset(SSL_new(server_ctx.get()));
   SSL_set_fd(server_ssl.get(), sockets[0]);
   SSL_set_accept_state(server_ssl.get());
 
-  bssl::UniquePtr<SSL> client_ssl(SSL_new(client_ctx.get()));
+  client_ssl.reset(SSL_new(client_ctx.get()));
   SSL_set_fd(client_ssl.get(), sockets[1]);
   SSL_set_connect_state(client_ssl.get());
 
@@ -106,6 +135,14 @@ static void testThroughput(benchmark::State& state) {
   }
 
   RELEASE_ASSERT(handshake_success, "handshake completed successfully");
+}
+
+static void testThroughput(benchmark::State& state) {
+  int sockets[2];
+  socketpair(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK, 0, sockets);
+  bssl::UniquePtr<SSL> server_ssl;
+  bssl::UniquePtr<SSL> client_ssl;
+  connectSsl(sockets, TLS1_3_VERSION, server_ssl, client_ssl);
 
   static uint8_t read_buf[1024 * 1024];
 
@@ -158,7 +195,7 @@ static void testThroughput(benchmark::State& state) {
         ++num_times_linearize_did_something;
       }
 
-      err = SSL_write(client_ssl.get(), mem, len);
+      int err = SSL_write(client_ssl.get(), mem, len);
       RELEASE_ASSERT(err == static_cast<int>(len),
                      absl::StrCat("SSL_write got: ", err, " expected: ", len));
       write_buf.drain(len);
@@ -192,5 +229,72 @@ static void testParams(benchmark::internal::Benchmark* b) {
 
 BENCHMARK(testThroughput)->Unit(::benchmark::kMicrosecond)->Apply(testParams);
 
+// Measures the throughput of a TLS 1.2 connection whose transmit direction is offloaded to the
+// kernel. Buffers are written as they are, without linearizing them.
+static void testKernelTlsThroughput(benchmark::State& state) {
+  int sockets[2];
+  tcpSocketPair(sockets);
+  bssl::UniquePtr<SSL> server_ssl;
+  bssl::UniquePtr<SSL> client_ssl;
+  connectSsl(sockets, TLS1_2_VERSION, server_ssl, client_ssl);
+  // The handle closes the client socket.
+  Network::IoSocketHandleImpl client_handle(sockets[1]);
+  if (!KernelTls::isSupported(client_ssl.get()) ||
+      !KernelTls::enable(client_ssl.get(), client_handle, false).tx_) {
+    state.SkipWithError("kernel TLS is not supported");
+    ::close(sockets[0]);
+    return;
+  }
+
+  static uint8_t read_buf[1024 * 1024];
+
+  unsigned short_slice_size = state.range(0);
+  unsigned num_short_slices = state.range(1);
+  unsigned move_slices = state.range(2);
+
+  uint64_t bytes_written = 0;
+  for (auto _ : state) {
+    UNREFERENCED_PARAMETER(_);
+    state.PauseTiming();
+
+    // Empty out the read side to make space for the writes.
+    while (SSL_read(server_ssl.get(), read_buf, sizeof(read_buf)) > 0) {
+    }
+
+    Buffer::OwnedImpl write_buf;
+    for (unsigned i = 0; i < num_short_slices; i++) {
+      appendSlice(write_buf, short_slice_size);
+    }
+    addFullSlices(write_buf, 10, move_slices);
+    bytes_written += write_buf.length();
+
+    state.ResumeTiming();
+    uint32_t num_writes = 0;
+    while (write_buf.length() > 0) {
+      const Api::IoCallUint64Result result = client_handle.write(write_buf);
+      RELEASE_ASSERT(result.ok(), "write");
+      num_writes++;
+    }
+
+    state.counters["writes_per_iteration"] = num_writes;
+  }
+  state.counters["throughput"] = benchmark::Counter(bytes_written, benchmark::Counter::kIsRate);
+
+  ::close(sockets[0]);
+}
+
+static void testKernelTlsParams(benchmark::internal::Benchmark* b) {
+  for (auto move_slices : {false, true}) {
+    b->Args({0, 0, move_slices});
+    for (auto short_slice_size : {1, 128, 4095, 4096, 4097}) {
+      for (auto num_short_slices : {1, 2, 3}) {
+        b->Args({short_slice_size, num_short_slices, move_slices});
+      }
+    }
+  }
+}
+
+BENCHMARK(testKernelTlsThroughput)->Unit(::benchmark::kMicrosecond)->Apply(testKernelTlsParams);
+
 } // namespace Extensions::TransportSockets::Tls
 } // namespace Envoy
@@ -40,6 +40,7 @@ public:
   MOCK_METHOD(const std::string&, logPath, (), (const));
   MOCK_METHOD(uint64_t, restartEpoch, (), (const));
   MOCK_METHOD(std::chrono::milliseconds, fileFlushIntervalMsec, (), (const));
+  MOCK_METHOD(bool, fileFlushSharedThread, (), (const));
   MOCK_METHOD(Mode, mode, (), (const));
   MOCK_METHOD(const std::string&, serviceClusterName, (), (const));
   MOCK_METHOD(const std::string&, serviceNodeName, (), (const));
@@ -69,6 +70,7 @@ public:
   std::string log_path_;
   uint32_t concurrency_{1};
   uint64_t hot_restart_epoch_{};
+  bool file_flush_shared_thread_{};
   bool hot_restart_disabled_{};
   bool signal_handling_enabled_{true};
   bool mutex_tracing_enabled_{};
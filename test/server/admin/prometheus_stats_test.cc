@@ -1,6 +1,7 @@
 #include <regex>
 
 #include "server/admin/prometheus_stats.h"
+#include "server/admin/utils.h"
 
 #include "test/mocks/stats/mocks.h"
 #include "test/test_common/utility.h"
@@ -189,6 +190,29 @@ TEST_F(PrometheusStatsFormatterTest, UniqueMetricName) {
   EXPECT_EQ(4UL, size);
 }
 
+// Output larger than a page is written in full, with the tags shared by metrics formatted as they
+// are for each metric.
+TEST_F(PrometheusStatsFormatterTest, ManyMetricsWithSharedTags) {
+  std::string expected_output;
+  for (uint32_t i = 0; i < 3000; ++i) {
+    const std::string name = fmt::format("cluster.upstream_rq_{:04d}", i);
+    addCounter(name,
+               {{makeStat("envoy.cluster_name"), makeStat(fmt::format("cluster-{}", i % 3))}});
+    absl::StrAppend(&expected_output,
+                    fmt::format("# TYPE envoy_cluster_upstream_rq_{0:04d} counter\n"
+                                "envoy_cluster_upstream_rq_{0:04d}{{envoy_cluster_name="
+                                "\"cluster-{1}\"}} 0\n\n",
+                                i, i % 3));
+  }
+
+  Buffer::OwnedImpl response;
+  auto size = PrometheusStatsFormatter::statsAsPrometheus(counters_, gauges_, histograms_, response,
+                                                          false, absl::nullopt);
+  EXPECT_EQ(3000UL, size);
+  EXPECT_GT(response.length(), 2 * Utility::PagedResponseWriter::PageSize);
+  EXPECT_EQ(expected_output, response.toString());
+}
+
 TEST_F(PrometheusStatsFormatterTest, HistogramWithNoValuesAndNoTags) {
   HistogramWrapper h1_cumulative;
   h1_cumulative.setHistogramValues(std::vector<uint64_t>(0));
@@ -3,6 +3,7 @@
 #include "common/stats/thread_local_store.h"
 
 #include "server/admin/stats_handler.h"
+#include "server/admin/utils.h"
 
 #include "test/server/admin/admin_instance.h"
 #include "test/test_common/logging.h"
@@ -29,8 +30,13 @@ public:
                      std::map<std::string, std::string>& all_text_readouts,
                      const std::vector<Stats::ParentHistogramSharedPtr>& all_histograms,
                      const bool used_only, const absl::optional<std::regex> regex = absl::nullopt) {
-    return StatsHandler::statsAsJson(all_stats, all_text_readouts, all_histograms, used_only, regex,
-                                     true /*pretty_print*/);
+    Buffer::OwnedImpl response;
+    StatsHandler::statsAsJson(
+        std::vector<std::pair<std::string, uint64_t>>(all_stats.begin(), all_stats.end()),
+        std::vector<std::pair<std::string, std::string>>(all_text_readouts.begin(),
+                                                         all_text_readouts.end()),
+        all_histograms, used_only, regex, response);
+    return response.toString();
   }
 
   Stats::SymbolTableImpl symbol_table_;
@@ -505,6 +511,26 @@ TEST_P(AdminStatsTest, UsedOnlyStatsAsJsonFilterString) {
   store_->shutdownThreading();
 }
 
+// Output larger than a page is written in full, and strings are escaped.
+TEST_P(AdminStatsTest, StatsAsJsonLargeAndEscaped) {
+  std::map<std::string, uint64_t> all_stats;
+  std::string expected_stats;
+  for (uint32_t i = 0; i < 10000; ++i) {
+    const std::string name = fmt::format("cluster.cluster_{:05d}.upstream_rq_total", i);
+    all_stats.emplace(name, i);
+    absl::StrAppend(&expected_stats, ",{\"name\":\"", name, "\",\"value\":", i, "}");
+  }
+  std::map<std::string, std::string> all_text_readouts{{"t", "a \"quoted\" \\ value\n"}};
+  std::string actual_json =
+      statsAsJsonHandler(all_stats, all_text_readouts, store_->histograms(), false);
+
+  EXPECT_GT(actual_json.size(), 2 * Utility::PagedResponseWriter::PageSize);
+  EXPECT_THAT(absl::StrCat("{\"stats\":[{\"name\":\"t\",\"value\":\"a \\\"quoted\\\" \\\\ "
+                           "value\\n\"}",
+                           expected_stats, "]}"),
+              JsonStringEq(actual_json));
+}
+
 INSTANTIATE_TEST_SUITE_P(IpVersions, AdminInstanceTest,
                          testing::ValuesIn(TestEnvironment::getIpVersionsForTest()),
                          TestUtility::ipTestParamsToString);